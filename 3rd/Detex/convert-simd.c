@@ -0,0 +1,353 @@
+// SIMD kernels for the most frequent pixel conversions, selected at run-time. Each kernel converts as many
+// pixels as it can and returns the count, the scalar code in convert.c and half-float.c handles the remainder.
+
+#include <math.h>
+#include <string.h>
+
+#include "detex.h"
+#include "misc.h"
+
+// Atomics for the lazy initialization below, C11 <stdatomic.h> is not available with every compiler in use.
+// DETEX_COMPARE_EXCHANGE returns the previous value.
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DETEX_LOAD_ACQUIRE(p) ((uint32_t)_InterlockedOr((volatile long *)(p), 0))
+#define DETEX_STORE_RELEASE(p, v) _InterlockedExchange((volatile long *)(p), (long)(v))
+#define DETEX_COMPARE_EXCHANGE(p, expected, desired) ((uint32_t)_InterlockedCompareExchange((volatile long *)(p), (long)(desired), (long)(expected)))
+#else
+#define DETEX_LOAD_ACQUIRE(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define DETEX_STORE_RELEASE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define DETEX_COMPARE_EXCHANGE(p, expected, desired) __sync_val_compare_and_swap(p, expected, desired)
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DETEX_SIMD_X86
+#endif
+
+#ifdef DETEX_SIMD_X86
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DETEX_TARGET_SSE4
+#define DETEX_TARGET_AVX2
+#define DETEX_TARGET_F16C
+#else
+#include <cpuid.h>
+#define DETEX_TARGET_SSE4 __attribute__((target("ssse3,sse4.1")))
+#define DETEX_TARGET_AVX2 __attribute__((target("avx2")))
+#define DETEX_TARGET_F16C __attribute__((target("avx,f16c")))
+#endif
+
+#include <immintrin.h>
+
+static void detexCPUID(int leaf, int subleaf, uint32_t *regs) {
+#ifdef _MSC_VER
+	__cpuidex((int *)regs, leaf, subleaf);
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t detexXGETBV() {
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+static uint32_t detexDetectSIMDSupport() {
+	uint32_t regs[4];
+	detexCPUID(0, 0, regs);
+	uint32_t max_leaf = regs[0];
+	if (max_leaf < 1)
+		return 0;
+	detexCPUID(1, 0, regs);
+	uint32_t support = 0;
+	bool ssse3 = (regs[2] & (1u << 9)) != 0;
+	bool sse41 = (regs[2] & (1u << 19)) != 0;
+	if (ssse3 && sse41)
+		support |= DETEX_SIMD_SSE4;
+	// AVX state must be enabled by the OS.
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	bool avx = (regs[2] & (1u << 28)) != 0;
+	bool f16c = (regs[2] & (1u << 29)) != 0;
+	if (!osxsave || !avx || (detexXGETBV() & 0x6) != 0x6)
+		return support;
+	if (f16c)
+		support |= DETEX_SIMD_F16C;
+	if (max_leaf >= 7) {
+		detexCPUID(7, 0, regs);
+		if ((regs[1] & (1u << 5)) && (support & DETEX_SIMD_SSE4))
+			support |= DETEX_SIMD_AVX2;
+	}
+	return support;
+}
+
+#else
+
+static uint32_t detexDetectSIMDSupport() {
+	return 0;
+}
+
+#endif
+
+// Both are 0 until initialized, DETEX_SIMD_READY marks them as valid.
+#define DETEX_SIMD_READY 0x80000000u
+
+static uint32_t detex_simd_detected;
+static uint32_t detex_simd_enabled;
+
+static uint32_t detexGetDetectedSIMD() {
+	uint32_t detected = DETEX_LOAD_ACQUIRE(&detex_simd_detected);
+	if (!detected) {
+		// Racing threads store the same value.
+		detected = detexDetectSIMDSupport() | DETEX_SIMD_READY;
+		DETEX_STORE_RELEASE(&detex_simd_detected, detected);
+	}
+	return detected;
+}
+
+static DETEX_INLINE_ONLY uint32_t detexGetSIMD() {
+	uint32_t enabled = DETEX_LOAD_ACQUIRE(&detex_simd_enabled);
+	if (!enabled) {
+		// A concurrent detexSetSIMDSupport() wins.
+		uint32_t detected = detexGetDetectedSIMD();
+		uint32_t previous = DETEX_COMPARE_EXCHANGE(&detex_simd_enabled, 0, detected);
+		enabled = previous ? previous : detected;
+	}
+	return enabled & ~DETEX_SIMD_READY;
+}
+
+uint32_t detexGetSIMDSupport() {
+	return detexGetSIMD();
+}
+
+void detexSetSIMDSupport(uint32_t flags) {
+	DETEX_STORE_RELEASE(&detex_simd_enabled, (detexGetDetectedSIMD() & flags) | DETEX_SIMD_READY);
+}
+
+#ifdef DETEX_SIMD_X86
+
+// Byte shuffles, 4 pixels per 128-bit lane. 0x80 produces zero.
+enum {
+	DETEX_SHUFFLE_RGB8_TO_RGBX8,
+	DETEX_SHUFFLE_RGB8_TO_BGRX8,
+	DETEX_SHUFFLE_RGBX8_TO_RGB8,
+	DETEX_SHUFFLE_RGBA8_TO_BGRA8,
+};
+
+static const uint8_t detex_shuffle_table[][16] = {
+	{ 0, 1, 2, 0x80, 3, 4, 5, 0x80, 6, 7, 8, 0x80, 9, 10, 11, 0x80 },
+	{ 2, 1, 0, 0x80, 5, 4, 3, 0x80, 8, 7, 6, 0x80, 11, 10, 9, 0x80 },
+	{ 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 0x80, 0x80, 0x80, 0x80 },
+	{ 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15 },
+};
+
+// A 16-byte load of 4 RGB8 pixels reads 4 bytes past them, the loops stop early enough to stay inside the source.
+
+DETEX_TARGET_AVX2 static int Expand24To32AVX2(const uint8_t * DETEX_RESTRICT source, int n,
+uint8_t * DETEX_RESTRICT target, const uint8_t *shuffle) {
+	__m128i mask128 = _mm_loadu_si128((const __m128i *)shuffle);
+	__m256i mask = _mm256_broadcastsi128_si256(mask128);
+	__m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+	int i = 0;
+	for (; i + 10 <= n; i += 8) {
+		__m128i lo = _mm_loadu_si128((const __m128i *)(source + i * 3));
+		__m128i hi = _mm_loadu_si128((const __m128i *)(source + i * 3 + 12));
+		__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		v = _mm256_or_si256(_mm256_shuffle_epi8(v, mask), alpha);
+		_mm256_storeu_si256((__m256i *)(target + i * 4), v);
+	}
+	return i;
+}
+
+DETEX_TARGET_SSE4 static int Expand24To32SSE4(const uint8_t * DETEX_RESTRICT source, int n,
+uint8_t * DETEX_RESTRICT target, const uint8_t *shuffle, int i) {
+	__m128i mask = _mm_loadu_si128((const __m128i *)shuffle);
+	__m128i alpha = _mm_set1_epi32((int)0xFF000000);
+	for (; i + 6 <= n; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(source + i * 3));
+		v = _mm_or_si128(_mm_shuffle_epi8(v, mask), alpha);
+		_mm_storeu_si128((__m128i *)(target + i * 4), v);
+	}
+	return i;
+}
+
+DETEX_TARGET_SSE4 static int Compact32To24SSE4(const uint8_t * DETEX_RESTRICT source, int n,
+uint8_t * DETEX_RESTRICT target, const uint8_t *shuffle) {
+	__m128i mask = _mm_loadu_si128((const __m128i *)shuffle);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(source + i * 4)), mask);
+		uint32_t last = (uint32_t)_mm_extract_epi32(v, 2);
+		_mm_storel_epi64((__m128i *)(target + i * 3), v);
+		memcpy(target + i * 3 + 8, &last, 4);
+	}
+	return i;
+}
+
+DETEX_TARGET_AVX2 static int Shuffle32AVX2(uint8_t *buffer, int n, const uint8_t *shuffle) {
+	__m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)shuffle));
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(buffer + i * 4));
+		_mm256_storeu_si256((__m256i *)(buffer + i * 4), _mm256_shuffle_epi8(v, mask));
+	}
+	return i;
+}
+
+DETEX_TARGET_SSE4 static int Shuffle32SSE4(uint8_t *buffer, int n, const uint8_t *shuffle, int i) {
+	__m128i mask = _mm_loadu_si128((const __m128i *)shuffle);
+	for (; i + 4 <= n; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(buffer + i * 4));
+		_mm_storeu_si128((__m128i *)(buffer + i * 4), _mm_shuffle_epi8(v, mask));
+	}
+	return i;
+}
+
+DETEX_TARGET_F16C static int FloatToHalfFloatF16C(const float * DETEX_RESTRICT source, int n,
+uint16_t * DETEX_RESTRICT target) {
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128((__m128i *)(target + i), h);
+	}
+	return i;
+}
+
+DETEX_TARGET_F16C static int HalfFloatToFloatF16C(const uint16_t * DETEX_RESTRICT source, int n,
+float * DETEX_RESTRICT target) {
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 f = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(source + i)));
+		_mm256_storeu_ps(target + i, f);
+	}
+	return i;
+}
+
+static int Expand24To32(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target,
+int shuffle_index) {
+	uint32_t simd = detexGetSIMD();
+	const uint8_t *shuffle = detex_shuffle_table[shuffle_index];
+	int i = 0;
+	if (simd & DETEX_SIMD_AVX2)
+		i = Expand24To32AVX2(source, n, target, shuffle);
+	if (simd & DETEX_SIMD_SSE4)
+		i = Expand24To32SSE4(source, n, target, shuffle, i);
+	return i;
+}
+
+int detexConvertRGB8ToRGBX8SIMD(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target) {
+	return Expand24To32(source, n, target, DETEX_SHUFFLE_RGB8_TO_RGBX8);
+}
+
+int detexConvertRGB8ToBGRX8SIMD(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target) {
+	return Expand24To32(source, n, target, DETEX_SHUFFLE_RGB8_TO_BGRX8);
+}
+
+int detexConvertRGBX8ToRGB8SIMD(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target) {
+	if (!(detexGetSIMD() & DETEX_SIMD_SSE4))
+		return 0;
+	return Compact32To24SSE4(source, n, target, detex_shuffle_table[DETEX_SHUFFLE_RGBX8_TO_RGB8]);
+}
+
+int detexSwapRB32SIMD(uint8_t *buffer, int n) {
+	uint32_t simd = detexGetSIMD();
+	const uint8_t *shuffle = detex_shuffle_table[DETEX_SHUFFLE_RGBA8_TO_BGRA8];
+	int i = 0;
+	if (simd & DETEX_SIMD_AVX2)
+		i = Shuffle32AVX2(buffer, n, shuffle);
+	if (simd & DETEX_SIMD_SSE4)
+		i = Shuffle32SSE4(buffer, n, shuffle, i);
+	return i;
+}
+
+int detexConvertFloatToHalfFloatSIMD(const float * DETEX_RESTRICT source, int n, uint16_t * DETEX_RESTRICT target) {
+	if (!(detexGetSIMD() & DETEX_SIMD_F16C))
+		return 0;
+	return FloatToHalfFloatF16C(source, n, target);
+}
+
+int detexConvertHalfFloatToFloatSIMD(const uint16_t * DETEX_RESTRICT source, int n, float * DETEX_RESTRICT target) {
+	if (!(detexGetSIMD() & DETEX_SIMD_F16C))
+		return 0;
+	return HalfFloatToFloatF16C(source, n, target);
+}
+
+#else
+
+int detexConvertRGB8ToRGBX8SIMD(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target) {
+	return 0;
+}
+
+int detexConvertRGB8ToBGRX8SIMD(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target) {
+	return 0;
+}
+
+int detexConvertRGBX8ToRGB8SIMD(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target) {
+	return 0;
+}
+
+int detexSwapRB32SIMD(uint8_t *buffer, int n) {
+	return 0;
+}
+
+int detexConvertFloatToHalfFloatSIMD(const float * DETEX_RESTRICT source, int n, uint16_t * DETEX_RESTRICT target) {
+	return 0;
+}
+
+int detexConvertHalfFloatToFloatSIMD(const uint16_t * DETEX_RESTRICT source, int n, float * DETEX_RESTRICT target) {
+	return 0;
+}
+
+#endif
+
+// sRGB <-> linear conversions through lookup tables.
+
+#define DETEX_SRGB_ENCODE_TABLE_SIZE 4096
+
+static float detex_srgb_decode_table[256];
+static uint8_t detex_srgb_encode_table[DETEX_SRGB_ENCODE_TABLE_SIZE];
+// 0 - not initialized, 1 - being initialized, 2 - ready.
+static uint32_t detex_srgb_tables_state = 0;
+
+static void detexValidateSRGBTables() {
+	if (DETEX_LOAD_ACQUIRE(&detex_srgb_tables_state) == 2)
+		return;
+	if (DETEX_COMPARE_EXCHANGE(&detex_srgb_tables_state, 0, 1) != 0) {
+		// Another thread builds the tables, it takes microseconds.
+		while (DETEX_LOAD_ACQUIRE(&detex_srgb_tables_state) != 2)
+			;
+		return;
+	}
+	for (int i = 0; i < 256; i++) {
+		float c = (float)i / 255.0f;
+		detex_srgb_decode_table[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+	}
+	// 12-bit quantization of the linear value keeps the error within one 8-bit step.
+	for (int i = 0; i < DETEX_SRGB_ENCODE_TABLE_SIZE; i++) {
+		float c = (float)i / (float)(DETEX_SRGB_ENCODE_TABLE_SIZE - 1);
+		float s = c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+		detex_srgb_encode_table[i] = (uint8_t)(s * 255.0f + 0.5f);
+	}
+	DETEX_STORE_RELEASE(&detex_srgb_tables_state, 2);
+}
+
+void detexConvertSRGB8ToLinearFloat(const uint8_t * DETEX_RESTRICT source, int n, float * DETEX_RESTRICT target) {
+	detexValidateSRGBTables();
+	for (int i = 0; i < n; i++)
+		target[i] = detex_srgb_decode_table[source[i]];
+}
+
+void detexConvertLinearFloatToSRGB8(const float * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target) {
+	detexValidateSRGBTables();
+	for (int i = 0; i < n; i++) {
+		float c = source[i];
+		// Also maps NaN to 0.
+		c = c > 0.0f ? (c < 1.0f ? c : 1.0f) : 0.0f;
+		target[i] = detex_srgb_encode_table[(int)(c * (float)(DETEX_SRGB_ENCODE_TABLE_SIZE - 1) + 0.5f)];
+	}
+}
@@ -36,8 +36,9 @@ int nu_pixels, uint8_t * DETEX_RESTRICT target_pixel_buffer) {
 
 static void ConvertPixel32RGBA8ToPixel32BGRA8(uint8_t * DETEX_RESTRICT source_pixel_buffer, int nu_pixels,
 uint8_t * DETEX_RESTRICT target_pixel_buffer) {
-	uint32_t *source_pixel32_buffer = (uint32_t *)source_pixel_buffer;
-	for (int i = 0; i < nu_pixels; i++) {
+	int i = detexSwapRB32SIMD(source_pixel_buffer, nu_pixels);
+	uint32_t *source_pixel32_buffer = (uint32_t *)source_pixel_buffer + i;
+	for (; i < nu_pixels; i++) {
 		/* Swap R and B. */
 		uint32_t pixel = *source_pixel32_buffer;
 		pixel = detexPack32RGBA8(
@@ -72,8 +73,10 @@ uint8_t * DETEX_RESTRICT target_pixel_buffer) {
 
 static void ConvertPixel24RGB8ToPixel32BGRX8(uint8_t * DETEX_RESTRICT source_pixel_buffer, int nu_pixels,
 uint8_t * DETEX_RESTRICT target_pixel_buffer) {
-	uint32_t *target_pixel32_buffer = (uint32_t *)target_pixel_buffer;
-	for (int i = 0; i < nu_pixels; i++) {
+	int i = detexConvertRGB8ToBGRX8SIMD(source_pixel_buffer, nu_pixels, target_pixel_buffer);
+	uint32_t *target_pixel32_buffer = (uint32_t *)target_pixel_buffer + i;
+	source_pixel_buffer += i * 3;
+	for (; i < nu_pixels; i++) {
 		/* Swap R and B. */
 		uint32_t red = source_pixel_buffer[0];
 		uint32_t green = source_pixel_buffer[1];
@@ -657,8 +660,10 @@ int nu_pixels, uint8_t * DETEX_RESTRICT target_pixel_buffer) {
 
 static void ConvertPixel24RGB8ToPixel32RGBX8(uint8_t * DETEX_RESTRICT source_pixel_buffer, int nu_pixels,
 uint8_t * DETEX_RESTRICT target_pixel_buffer) {
-	uint32_t *target_pixel32_buffer = (uint32_t *)target_pixel_buffer;
-	for (int i = 0; i < nu_pixels; i++) {
+	int i = detexConvertRGB8ToRGBX8SIMD(source_pixel_buffer, nu_pixels, target_pixel_buffer);
+	uint32_t *target_pixel32_buffer = (uint32_t *)target_pixel_buffer + i;
+	source_pixel_buffer += i * 3;
+	for (; i < nu_pixels; i++) {
 		uint32_t red = source_pixel_buffer[0];
 		uint32_t green = source_pixel_buffer[1];
 		uint32_t blue = source_pixel_buffer[2];
@@ -670,8 +675,10 @@ uint8_t * DETEX_RESTRICT target_pixel_buffer) {
 
 static void ConvertPixel32RGBX8ToPixel24RGB8(uint8_t * DETEX_RESTRICT source_pixel_buffer, int nu_pixels,
 uint8_t * DETEX_RESTRICT target_pixel_buffer) {
-	uint32_t *source_pixel32_buffer = (uint32_t *)source_pixel_buffer;
-	for (int i = 0; i < nu_pixels; i++) {
+	int i = detexConvertRGBX8ToRGB8SIMD(source_pixel_buffer, nu_pixels, target_pixel_buffer);
+	uint32_t *source_pixel32_buffer = (uint32_t *)source_pixel_buffer + i;
+	target_pixel_buffer += i * 3;
+	for (; i < nu_pixels; i++) {
 		uint32_t pixel = *source_pixel32_buffer;
 		target_pixel_buffer[0] = detexPixel32GetR8(pixel);
 		target_pixel_buffer[1] = detexPixel32GetG8(pixel);
@@ -819,6 +819,25 @@ DETEX_API bool detexConvertPixels(uint8_t *source_pixel_buffer, uint32_t nu_pixe
 DETEX_API bool detexConvertPixelsInPlace(uint8_t * DETEX_RESTRICT source_pixel_buffer,
 	uint32_t nu_pixels, uint32_t source_pixel_format, uint32_t target_pixel_format);
 
+/* SIMD paths used by the pixel conversions, detected at run-time. */
+#define DETEX_SIMD_SSE4	0x1
+#define DETEX_SIMD_AVX2	0x2
+#define DETEX_SIMD_F16C	0x4
+
+/* Return the enabled SIMD paths (a combination of DETEX_SIMD_* flags). */
+DETEX_API uint32_t detexGetSIMDSupport();
+
+/* Restrict the SIMD paths to the given flags (0 = scalar only), for example to compare timings. */
+/* Paths not supported by the CPU are never enabled. */
+DETEX_API void detexSetSIMDSupport(uint32_t flags);
+
+/* Convert 8-bit sRGB components to linear floats and vice-versa, using lookup tables. */
+DETEX_API void detexConvertSRGB8ToLinearFloat(const uint8_t * DETEX_RESTRICT source, int n,
+	float * DETEX_RESTRICT target);
+
+DETEX_API void detexConvertLinearFloatToSRGB8(const float * DETEX_RESTRICT source, int n,
+	uint8_t * DETEX_RESTRICT target);
+
 /* Return the component bitfield masks for a pixel format (pixel size must be at most 64 bits). */
 /* Return true if succesful. */
 DETEX_API bool detexGetComponentMasks(uint32_t texture_format, uint64_t *red_mask, uint64_t *green_mask,
@@ -23,6 +23,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 #include "detex.h"
 #include "half-float.h"
+#include "misc.h"
 
 /******************************************************************************
  *
@@ -286,13 +287,18 @@ void detexValidateHalfFloatTable() {
 // Conversion functions.
 
 void detexConvertHalfFloatToFloat(uint16_t *source_buffer, int n, float *target_buffer) {
+	int i = detexConvertHalfFloatToFloatSIMD(source_buffer, n, target_buffer);
+	if (i == n)
+		return;
 	detexValidateHalfFloatTable();
-	for (int i = 0; i < n; i++)
+	for (; i < n; i++)
 		target_buffer[i] = detexGetFloatFromHalfFloat(source_buffer[i]);
 }
  
 void detexConvertFloatToHalfFloat(float *source_buffer, int n, uint16_t *target_buffer) {
-	singles2halfp(target_buffer, source_buffer, n);
+	// F16C rounds to nearest even, the scalar path rounds half away from zero.
+	int i = detexConvertFloatToHalfFloatSIMD(source_buffer, n, target_buffer);
+	singles2halfp(target_buffer + i, source_buffer + i, n - i);
 }
 
 // Convert normalized half floats to unsigned 16-bit integers in place.
@@ -19,3 +19,18 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 void detexSetErrorMessage(const char *format, ...);
 
+
+// SIMD kernels (convert-simd.c). Return the number of converted pixels/values, which can be less than n
+// (down to 0 if not supported), the caller converts the rest.
+
+int detexConvertRGB8ToRGBX8SIMD(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target);
+
+int detexConvertRGB8ToBGRX8SIMD(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target);
+
+int detexConvertRGBX8ToRGB8SIMD(const uint8_t * DETEX_RESTRICT source, int n, uint8_t * DETEX_RESTRICT target);
+
+int detexSwapRB32SIMD(uint8_t *buffer, int n);
+
+int detexConvertFloatToHalfFloatSIMD(const float * DETEX_RESTRICT source, int n, uint16_t * DETEX_RESTRICT target);
+
+int detexConvertHalfFloatToFloatSIMD(const uint16_t * DETEX_RESTRICT source, int n, float * DETEX_RESTRICT target);
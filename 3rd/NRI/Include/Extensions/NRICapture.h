@@ -0,0 +1,29 @@
+// © 2025 NVIDIA Corporation
+
+#pragma once
+
+NriNamespaceBegin
+
+NriForwardStruct(Capture);
+NriForwardStruct(Device);
+
+// Capture records "CoreInterface" command buffer calls, "QueueSubmit" and "StreamerInterface" update requests (with upload
+// payloads) into a binary file. Objects are recorded as identities with descs: buffers, textures, descriptors, descriptor pools,
+// query pools and streamers are recreated on replay, descriptor sets, pipeline layouts and pipelines are not. Calls using them
+// (and root constants, root descriptors and vertex buffers, which need them) are skipped. Replay is meant for the NONE device
+// (optionally with NRI validation): queues and fences are not recreated per type and memory locations are not recorded.
+// Files are tied to the NRI version and pointer size of the recording build
+
+NriStruct(CaptureInterface) {
+    // Recording, requires "DeviceCreationDesc::enableNRICapture". Call between frames
+    Nri(Result) (NRI_CALL *BeginCapture)                (NriRef(Device) device);
+    Nri(Result) (NRI_CALL *EndCapture)                  (NriRef(Device) device, const char* path); // writes the file
+
+    // Replaying (NONE device)
+    Nri(Result) (NRI_CALL *CreateCapture)               (NriRef(Device) device, const char* path, NriOut NriRef(Capture*) capture);
+    uint64_t    (NRI_CALL *ReplayCapture)               (NriRef(Capture) capture); // returns the number of replayed calls
+    uint64_t    (NRI_CALL *GetCaptureSkippedCallNum)    (const NriRef(Capture) capture); // per replay, not included above
+    void        (NRI_CALL *DestroyCapture)              (NriRef(Capture) capture);
+};
+
+NriNamespaceEnd
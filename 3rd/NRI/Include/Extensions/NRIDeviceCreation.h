@@ -64,10 +64,16 @@ NriStruct(DeviceCreationDesc) {
     Nri(VKBindingOffsets) vkBindingOffsets;
     NriOptional Nri(VKExtensions) vkExtensions;
 
+    // NRI validation tiers: off, full ("enableNRIValidation") and light ("enableNRIValidation" + "nriValidationSampleRate > 0").
+    // Light validation checks parameters of 1 of N command buffer recordings and reports state errors in "EndCommandBuffer"
+    NriOptional uint32_t nriValidationSampleRate;
+
     // Switches (disabled by default)
     bool enableNRIValidation;
     bool enableGraphicsAPIValidation;
     bool enableD3D11CommandBufferEmulation;     // enable? but why? (auto-enabled if deferred contexts are not supported)
+    bool enableNRIStats;                        // command buffer and frame counters, see "NRIStats.h"
+    bool enableNRICapture;                      // call stream recording, see "NRICapture.h"
 
     // Switches (enabled by default)
     bool disableVKRayTracing;                   // to save CPU memory in some implementations
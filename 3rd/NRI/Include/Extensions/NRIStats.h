@@ -0,0 +1,42 @@
+// © 2025 NVIDIA Corporation
+
+#pragma once
+
+NriNamespaceBegin
+
+NriForwardStruct(CommandBuffer);
+NriForwardStruct(Device);
+
+// Requires "DeviceCreationDesc::enableNRIStats". The stats layer wraps "CoreInterface" and "StreamerInterface" function
+// tables of any backend (validation included), i.e. only calls made via interfaces obtained after device creation are counted
+
+NriStruct(CommandBufferStats) {
+    uint64_t drawNum;               // direct and indirect ("drawNum" of indirect calls is the upper bound)
+    uint64_t dispatchNum;           // direct and indirect
+    uint64_t instanceNum;           // direct draws only
+    uint64_t triangleNum;           // direct draws with "TRIANGLE_LIST" and "TRIANGLE_STRIP" topologies only
+    uint64_t barrierNum;            // global, buffer and texture barriers
+    uint64_t descriptorSetNum;      // "CmdSetDescriptorSet" calls
+    uint64_t rootConstantSize;      // bytes
+    uint64_t pipelineNum;           // "CmdSetPipeline" calls, which change the bound pipeline
+};
+
+NriStruct(FrameStats) {
+    Nri(CommandBufferStats) commandBufferTotals; // command buffers ended in the frame
+    uint64_t commandBufferNum;      // ended in the frame
+    uint64_t submitNum;             // "QueueSubmit" calls
+    uint64_t streamerSize;          // bytes added to streamers (buffer, texture and constant buffer updates)
+};
+
+NriStruct(StatsInterface) {
+    // The last recording of the command buffer (complete after "EndCommandBuffer")
+    void (NRI_CALL *GetCommandBufferStats)  (const NriRef(CommandBuffer) commandBuffer, NriOut NriRef(CommandBufferStats) commandBufferStats);
+
+    // The last ended frame
+    void (NRI_CALL *GetFrameStats)          (const NriRef(Device) device, NriOut NriRef(FrameStats) frameStats);
+
+    // Call once per frame (for example, after "QueuePresent"), counting since the previous call
+    void (NRI_CALL *EndStatsFrame)          (NriRef(Device) device);
+};
+
+NriNamespaceEnd
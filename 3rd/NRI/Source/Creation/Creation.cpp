@@ -29,6 +29,16 @@ Result CreateDeviceD3D11(const DeviceCreationDesc& deviceCreationDesc, const Dev
 Result CreateDeviceD3D12(const DeviceCreationDesc& deviceCreationDesc, const DeviceCreationD3D12Desc& deviceCreationDescD3D12, DeviceBase*& device);
 Result CreateDeviceVK(const DeviceCreationDesc& deviceCreationDesc, const DeviceCreationVKDesc& deviceCreationDescVK, DeviceBase*& device);
 DeviceBase* CreateDeviceValidation(const DeviceCreationDesc& deviceCreationDesc, DeviceBase& device);
+Result CreateStatsLayer(Device& device);
+void DestroyStatsLayer(Device& device);
+bool WrapFunctionTableStats(const Device& device, CoreInterface& table);
+bool WrapFunctionTableStats(const Device& device, StreamerInterface& table);
+Result FillFunctionTableStats(const Device& device, StatsInterface& table);
+Result CreateCaptureLayer(Device& device);
+void DestroyCaptureLayer(Device& device);
+bool WrapFunctionTableCapture(const Device& device, CoreInterface& table);
+bool WrapFunctionTableCapture(const Device& device, StreamerInterface& table);
+Result FillFunctionTableCapture(const Device& device, CaptureInterface& table);
 
 constexpr uint64_t Hash(const char* name) {
     return *name != 0 ? *name ^ (33 * Hash(name + 1)) : 5381;
@@ -360,7 +370,7 @@ static Result EnumerateAdaptersVK(AdapterDesc* adapterDescs, uint32_t& adapterDe
 static Result FinalizeDeviceCreation(const DeviceCreationDesc& deviceCreationDesc, DeviceBase& deviceImpl, Device*& device) {
     MaybeUnused(deviceCreationDesc);
 #if NRI_ENABLE_VALIDATION_SUPPORT
-    if (deviceCreationDesc.enableNRIValidation && deviceCreationDesc.graphicsAPI != GraphicsAPI::NONE) {
+    if (deviceCreationDesc.enableNRIValidation) {
         Device* deviceVal = (Device*)CreateDeviceValidation(deviceCreationDesc, deviceImpl);
         if (!deviceVal) {
             nriDestroyDevice((Device&)deviceImpl);
@@ -372,6 +382,13 @@ static Result FinalizeDeviceCreation(const DeviceCreationDesc& deviceCreationDes
 #endif
         device = (Device*)&deviceImpl;
 
+    // Not fatal, the device works without counters
+    if (deviceCreationDesc.enableNRIStats)
+        CreateStatsLayer(*device);
+
+    if (deviceCreationDesc.enableNRICapture)
+        CreateCaptureLayer(*device);
+
 #if NRI_ENABLE_NVTX_SUPPORT
     nvtxInitialize(nullptr); // needed only to avoid stalls on the first use
 #endif
@@ -392,10 +409,19 @@ NRI_API Result NRI_CALL nriGetInterface(const Device& device, const char* interf
 
     memset(interfacePtr, 0, interfaceSize);
 
-    if (hash == Hash(NRI_STRINGIFY(CoreInterface))) {
-        realInterfaceSize = sizeof(CoreInterface);
+    if (hash == Hash(NRI_STRINGIFY(CaptureInterface))) {
+        realInterfaceSize = sizeof(CaptureInterface);
         if (realInterfaceSize == interfaceSize)
+            result = FillFunctionTableCapture(device, *(CaptureInterface*)interfacePtr);
+    } else if (hash == Hash(NRI_STRINGIFY(CoreInterface))) {
+        realInterfaceSize = sizeof(CoreInterface);
+        if (realInterfaceSize == interfaceSize) {
             result = deviceBase.FillFunctionTable(*(CoreInterface*)interfacePtr);
+            if (result == Result::SUCCESS) {
+                WrapFunctionTableStats(device, *(CoreInterface*)interfacePtr);
+                WrapFunctionTableCapture(device, *(CoreInterface*)interfacePtr); // records and forwards to stats
+            }
+        }
     } else if (hash == Hash(NRI_STRINGIFY(HelperInterface))) {
         realInterfaceSize = sizeof(HelperInterface);
         if (realInterfaceSize == interfaceSize)
@@ -416,10 +442,19 @@ NRI_API Result NRI_CALL nriGetInterface(const Device& device, const char* interf
         realInterfaceSize = sizeof(ResourceAllocatorInterface);
         if (realInterfaceSize == interfaceSize)
             result = deviceBase.FillFunctionTable(*(ResourceAllocatorInterface*)interfacePtr);
+    } else if (hash == Hash(NRI_STRINGIFY(StatsInterface))) {
+        realInterfaceSize = sizeof(StatsInterface);
+        if (realInterfaceSize == interfaceSize)
+            result = FillFunctionTableStats(device, *(StatsInterface*)interfacePtr);
     } else if (hash == Hash(NRI_STRINGIFY(StreamerInterface))) {
         realInterfaceSize = sizeof(StreamerInterface);
-        if (realInterfaceSize == interfaceSize)
+        if (realInterfaceSize == interfaceSize) {
             result = deviceBase.FillFunctionTable(*(StreamerInterface*)interfacePtr);
+            if (result == Result::SUCCESS) {
+                WrapFunctionTableStats(device, *(StreamerInterface*)interfacePtr);
+                WrapFunctionTableCapture(device, *(StreamerInterface*)interfacePtr); // records and forwards to stats
+            }
+        }
     } else if (hash == Hash(NRI_STRINGIFY(SwapChainInterface))) {
         realInterfaceSize = sizeof(SwapChainInterface);
         if (realInterfaceSize == interfaceSize)
@@ -771,6 +806,9 @@ NRI_API Result NRI_CALL nriCreateDeviceFromVkDevice(const DeviceCreationVKDesc&
 }
 
 NRI_API void NRI_CALL nriDestroyDevice(Device& device) {
+    DestroyCaptureLayer(device);
+    DestroyStatsLayer(device);
+
     ((DeviceBase&)device).Destruct();
 }
 
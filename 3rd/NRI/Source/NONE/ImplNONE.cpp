@@ -241,14 +241,18 @@ static const DeviceDesc& NRI_CALL GetDeviceDesc(const Device& device) {
     return ((DeviceNONE&)device).GetDesc();
 }
 
+// All usages, an unbounded size and a non-zero memory alignment are reported to let validation work on top of NONE
+constexpr BufferUsageBits BUFFER_USAGE_ALL = (BufferUsageBits)((uint32_t)BufferUsageBits::ACCELERATION_STRUCTURE_STORAGE * 2 - 1);
+constexpr TextureUsageBits TEXTURE_USAGE_ALL = (TextureUsageBits)((uint32_t)TextureUsageBits::SHADING_RATE_ATTACHMENT * 2 - 1);
+
 static const BufferDesc& NRI_CALL GetBufferDesc(const Buffer&) {
-    static const BufferDesc bufferDesc = {1};
+    static const BufferDesc bufferDesc = {UINT64_MAX, 0, BUFFER_USAGE_ALL};
 
     return bufferDesc;
 }
 
 static const TextureDesc& NRI_CALL GetTextureDesc(const Texture&) {
-    static const TextureDesc textureDesc = {TextureType::TEXTURE_1D, TextureUsageBits::NONE, Format::R8_UNORM, 1, 1, 1, 1, 1, 1};
+    static const TextureDesc textureDesc = {TextureType::TEXTURE_1D, TEXTURE_USAGE_ALL, Format::R8_UNORM, 1, 1, 1, 1, 1, 1};
 
     return textureDesc;
 }
@@ -262,19 +266,19 @@ static uint32_t NRI_CALL GetQuerySize(const QueryPool&) {
 }
 
 static void NRI_CALL GetBufferMemoryDesc(const Buffer&, MemoryLocation, MemoryDesc& memoryDesc) {
-    memoryDesc = {1};
+    memoryDesc = {1, 1};
 }
 
 static void NRI_CALL GetTextureMemoryDesc(const Texture&, MemoryLocation, MemoryDesc& memoryDesc) {
-    memoryDesc = {1};
+    memoryDesc = {1, 1};
 }
 
 static void NRI_CALL GetBufferMemoryDesc2(const Device&, const BufferDesc&, MemoryLocation, MemoryDesc& memoryDesc) {
-    memoryDesc = {1};
+    memoryDesc = {1, 1};
 }
 
 static void NRI_CALL GetTextureMemoryDesc2(const Device&, const TextureDesc&, MemoryLocation, MemoryDesc& memoryDesc) {
-    memoryDesc = {1};
+    memoryDesc = {1, 1};
 }
 
 static Result NRI_CALL GetQueue(Device&, QueueType, uint32_t, Queue*& queue) {
@@ -579,7 +583,10 @@ static void NRI_CALL UpdateDynamicConstantBuffers(DescriptorSet&, uint32_t, uint
 static void NRI_CALL CopyDescriptorSet(DescriptorSet&, const DescriptorSetCopyDesc&) {
 }
 
-static Result NRI_CALL AllocateDescriptorSets(DescriptorPool&, const PipelineLayout&, uint32_t, DescriptorSet**, uint32_t, uint32_t) {
+static Result NRI_CALL AllocateDescriptorSets(DescriptorPool&, const PipelineLayout&, uint32_t, DescriptorSet** descriptorSets, uint32_t instanceNum, uint32_t) {
+    for (uint32_t i = 0; i < instanceNum; i++)
+        descriptorSets[i] = DummyObject<DescriptorSet>();
+
     return Result::SUCCESS;
 }
 
@@ -1026,10 +1033,11 @@ static void NRI_CALL DestroySwapChain(SwapChain&) {
 }
 
 static Texture* const* NRI_CALL GetSwapChainTextures(const SwapChain&, uint32_t& textureNum) {
-    static const void* textures[1] = {};
+    // Not "nullptr", headless apps query descs and create views of back buffers as usual
+    static Texture* const textures[1] = {DummyObject<Texture>()};
     textureNum = 1;
 
-    return (Texture**)textures;
+    return textures;
 }
 
 static uint32_t NRI_CALL AcquireNextSwapChainTexture(SwapChain&) {
@@ -0,0 +1,304 @@
+// © 2025 NVIDIA Corporation
+
+#pragma once
+
+namespace nri {
+
+/*
+The capture layer patches function tables like the stats layer (see "Stats.h"):
+- while capturing, every recorded call appends a record to one stream under a lock (capturing is not free, forwarding is)
+- objects are written as 32-bit identities (0 - "nullptr"), types of identities go to a table preceding the stream
+- structs are written as is with identities in pointer slots, arrays are 8-byte aligned to be read in place
+- descs of identities go to a table after the types: buffers and textures via getters, descriptors, descriptor pools, query pools
+  and streamers are tracked all the time (no getters), descriptor sets, pipeline layouts and pipelines are not restorable
+Replay recreates objects from the descs at load, then decodes records and forwards them to the replay device interfaces
+(records are bounds and type checked by a dry decoding pass at load, a corrupted capture fails "CreateCapture").
+Calls using objects which are not restorable (and calls needing a pipeline layout or a pipeline) are skipped and counted
+*/
+
+constexpr uint32_t CAPTURE_MAGIC = 0x4349524E; // "NRIC"
+constexpr uint32_t CAPTURE_VERSION = 2;
+constexpr uint32_t CAPTURE_ALIGNMENT = 8;
+
+enum class CaptureObject : uint8_t {
+    BUFFER,
+    TEXTURE,
+    DESCRIPTOR,
+    DESCRIPTOR_SET,
+    DESCRIPTOR_POOL,
+    PIPELINE_LAYOUT,
+    PIPELINE,
+    QUERY_POOL,
+    COMMAND_BUFFER,
+    QUEUE,
+    FENCE,
+    STREAMER,
+
+    MAX_NUM
+};
+
+enum class CaptureCall : uint8_t {
+    // Core
+    BEGIN_COMMAND_BUFFER,
+    CMD_SET_DESCRIPTOR_POOL,
+    CMD_SET_PIPELINE_LAYOUT,
+    CMD_SET_PIPELINE,
+    CMD_SET_DESCRIPTOR_SET,
+    CMD_SET_ROOT_CONSTANTS,
+    CMD_SET_ROOT_DESCRIPTOR,
+    CMD_BARRIER,
+    CMD_SET_INDEX_BUFFER,
+    CMD_SET_VERTEX_BUFFERS,
+    CMD_SET_VIEWPORTS,
+    CMD_SET_SCISSORS,
+    CMD_SET_STENCIL_REFERENCE,
+    CMD_SET_DEPTH_BOUNDS,
+    CMD_SET_BLEND_CONSTANTS,
+    CMD_SET_SAMPLE_LOCATIONS,
+    CMD_SET_SHADING_RATE,
+    CMD_SET_DEPTH_BIAS,
+    CMD_BEGIN_RENDERING,
+    CMD_CLEAR_ATTACHMENTS,
+    CMD_DRAW,
+    CMD_DRAW_INDEXED,
+    CMD_DRAW_INDIRECT,
+    CMD_DRAW_INDEXED_INDIRECT,
+    CMD_END_RENDERING,
+    CMD_DISPATCH,
+    CMD_DISPATCH_INDIRECT,
+    CMD_COPY_BUFFER,
+    CMD_COPY_TEXTURE,
+    CMD_RESOLVE_TEXTURE,
+    CMD_UPLOAD_BUFFER_TO_TEXTURE,
+    CMD_READBACK_TEXTURE_TO_BUFFER,
+    CMD_CLEAR_STORAGE_BUFFER,
+    CMD_CLEAR_STORAGE_TEXTURE,
+    CMD_RESET_QUERIES,
+    CMD_BEGIN_QUERY,
+    CMD_END_QUERY,
+    CMD_COPY_QUERIES,
+    CMD_BEGIN_ANNOTATION,
+    CMD_END_ANNOTATION,
+    CMD_ANNOTATION,
+    END_COMMAND_BUFFER,
+    QUEUE_SUBMIT,
+
+    // Streamer
+    UPDATE_STREAMER_CONSTANT_BUFFER,
+    ADD_STREAMER_BUFFER_UPDATE_REQUEST,
+    ADD_STREAMER_TEXTURE_UPDATE_REQUEST,
+    COPY_STREAMER_UPDATE_REQUESTS,
+    CMD_UPLOAD_STREAMER_UPDATE_REQUESTS,
+
+    MAX_NUM
+};
+
+enum class CaptureDescriptor : uint8_t {
+    NONE,
+    BUFFER_VIEW,
+    TEXTURE_1D_VIEW,
+    TEXTURE_2D_VIEW,
+    TEXTURE_3D_VIEW,
+    SAMPLER
+};
+
+struct CaptureDescriptorDesc {
+    CaptureDescriptor type;
+    union {
+        BufferViewDesc bufferView;
+        Texture1DViewDesc texture1DView;
+        Texture2DViewDesc texture2DView;
+        Texture3DViewDesc texture3DView;
+        SamplerDesc sampler;
+    };
+};
+
+// Resources are written as identities in pointer slots
+struct CaptureObjectDesc {
+    bool isRestorable;
+    union {
+        BufferDesc buffer;
+        TextureDesc texture;
+        CaptureDescriptorDesc descriptor;
+        DescriptorPoolDesc descriptorPool;
+        QueryPoolDesc queryPool;
+        StreamerDesc streamer;
+    };
+};
+
+struct CaptureHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint16_t nriVersionMajor;
+    uint16_t nriVersionMinor;
+    uint32_t pointerSize;
+    uint32_t objectNum; // "CaptureObject" per identity follows the header, then "CaptureObjectDesc" per identity
+    uint64_t callNum;
+    uint64_t dataSize; // the stream follows the tables
+};
+
+struct CaptureLayer {
+    inline CaptureLayer(Device& device)
+        : m_Device(device)
+        , m_Stream(((DeviceBase&)device).GetStdAllocator())
+        , m_Objects(((DeviceBase&)device).GetStdAllocator())
+        , m_ObjectTypes(((DeviceBase&)device).GetStdAllocator())
+        , m_ObjectDescs(((DeviceBase&)device).GetStdAllocator())
+        , m_TrackedDescs(((DeviceBase&)device).GetStdAllocator())
+        , m_PipelineLayouts(((DeviceBase&)device).GetStdAllocator())
+        , m_DynamicConstantBufferNums(((DeviceBase&)device).GetStdAllocator())
+        , m_CommandBufferLayouts(((DeviceBase&)device).GetStdAllocator()) {
+    }
+
+    inline Device& GetDevice() {
+        return m_Device;
+    }
+
+    inline const CoreInterface& GetCoreInterface() const {
+        return m_CoreInterface;
+    }
+
+    inline const StreamerInterface& GetStreamerInterface() const {
+        return m_StreamerInterface;
+    }
+
+    inline bool IsCapturing() const {
+        return m_IsCapturing.load(std::memory_order_relaxed);
+    }
+
+    inline Lock& GetLock() {
+        return m_Lock;
+    }
+
+    void WrapFunctionTable(CoreInterface& table);
+    void WrapFunctionTable(StreamerInterface& table);
+
+    Result Begin();
+    Result End(const char* path);
+
+    // Pipeline layouts are tracked all the time, they are needed to know the number of dynamic constant buffer offsets
+    void AddPipelineLayout(const PipelineLayout& pipelineLayout, const PipelineLayoutDesc& pipelineLayoutDesc);
+    void ErasePipelineLayout(const PipelineLayout& pipelineLayout);
+
+    // Descs of objects without getters are tracked all the time too, they are restored on replay
+    void AddObjectDesc(const void* object, CaptureObject type, const CaptureObjectDesc& objectDesc);
+    void EraseObjectDesc(const void* object, CaptureObject type);
+
+    // Expect "GetLock"
+    uint32_t GetDynamicConstantBufferNum(const CommandBuffer& commandBuffer, uint32_t setIndex) const;
+    void SetPipelineLayout(const CommandBuffer& commandBuffer, const PipelineLayout& pipelineLayout);
+    uint32_t GetId(const void* object, CaptureObject type);
+    void BeginCall(CaptureCall call);
+    void AlignStream();
+    void WriteData(const void* data, size_t size);
+    void WriteArray(const void* data, size_t size);
+    void WriteString(const char* string);
+
+    // clang-format off
+    inline uint32_t GetId(const Buffer* object)         { return GetId(object, CaptureObject::BUFFER); }
+    inline uint32_t GetId(const Texture* object)        { return GetId(object, CaptureObject::TEXTURE); }
+    inline uint32_t GetId(const Descriptor* object)     { return GetId(object, CaptureObject::DESCRIPTOR); }
+    inline uint32_t GetId(const DescriptorSet* object)  { return GetId(object, CaptureObject::DESCRIPTOR_SET); }
+    inline uint32_t GetId(const DescriptorPool* object) { return GetId(object, CaptureObject::DESCRIPTOR_POOL); }
+    inline uint32_t GetId(const PipelineLayout* object) { return GetId(object, CaptureObject::PIPELINE_LAYOUT); }
+    inline uint32_t GetId(const Pipeline* object)       { return GetId(object, CaptureObject::PIPELINE); }
+    inline uint32_t GetId(const QueryPool* object)      { return GetId(object, CaptureObject::QUERY_POOL); }
+    inline uint32_t GetId(const CommandBuffer* object)  { return GetId(object, CaptureObject::COMMAND_BUFFER); }
+    inline uint32_t GetId(const Queue* object)          { return GetId(object, CaptureObject::QUEUE); }
+    inline uint32_t GetId(const Fence* object)          { return GetId(object, CaptureObject::FENCE); }
+    inline uint32_t GetId(const Streamer* object)       { return GetId(object, CaptureObject::STREAMER); }
+    // clang-format on
+
+    template <typename T>
+    inline T* GetIdAsPointer(T* object) {
+        return (T*)(size_t)GetId(object);
+    }
+
+    template <typename T>
+    inline void Write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "POD only");
+        WriteData(&value, sizeof(T));
+    }
+
+    template <typename T, typename... Args>
+    inline void Write(const T& value, const Args&... args) {
+        Write(value);
+        Write(args...);
+    }
+
+private:
+    Device& m_Device;
+    CoreInterface m_CoreInterface = {}; // originals
+    StreamerInterface m_StreamerInterface = {};
+    Vector<uint8_t> m_Stream;
+    UnorderedMap<uint64_t, uint32_t> m_Objects; // object + type => identity
+    Vector<CaptureObject> m_ObjectTypes; // identity - 1 => type
+    Vector<CaptureObjectDesc> m_ObjectDescs; // identity - 1 => desc
+    UnorderedMap<uint64_t, CaptureObjectDesc> m_TrackedDescs; // object + type => desc
+    UnorderedMap<const PipelineLayout*, uint32_t> m_PipelineLayouts; // descriptor set num
+    UnorderedMap<uint64_t, uint32_t> m_DynamicConstantBufferNums; // pipeline layout + set index => dynamic constant buffer num
+    UnorderedMap<const CommandBuffer*, const PipelineLayout*> m_CommandBufferLayouts; // while capturing
+    uint64_t m_CallNum = 0;
+    std::atomic_bool m_IsCapturing = false;
+    Lock m_Lock;
+};
+
+// Replay
+struct CaptureImpl {
+    inline CaptureImpl(Device& device)
+        : m_Device(device)
+        , m_Data(((DeviceBase&)device).GetStdAllocator())
+        , m_Objects(((DeviceBase&)device).GetStdAllocator())
+        , m_ObjectTypes(((DeviceBase&)device).GetStdAllocator())
+        , m_ObjectDescs(((DeviceBase&)device).GetStdAllocator())
+        , m_Buffers(((DeviceBase&)device).GetStdAllocator())
+        , m_Descriptors(((DeviceBase&)device).GetStdAllocator())
+        , m_CommandBuffers(((DeviceBase&)device).GetStdAllocator())
+        , m_WaitFences(((DeviceBase&)device).GetStdAllocator())
+        , m_SignalFences(((DeviceBase&)device).GetStdAllocator())
+        , m_BufferBarriers(((DeviceBase&)device).GetStdAllocator())
+        , m_TextureBarriers(((DeviceBase&)device).GetStdAllocator()) {
+    }
+
+    inline Device& GetDevice() {
+        return m_Device;
+    }
+
+    ~CaptureImpl();
+
+    inline uint64_t GetSkippedCallNum() const {
+        return m_SkippedCallNum;
+    }
+
+    Result Create(const char* path);
+    uint64_t Replay();
+
+private:
+    template <typename T>
+    T* GetCreatedObject(const T* id, uint32_t objectId) const;
+
+    Result CreateObject(uint32_t objectId);
+    bool Decode(bool isDryRun, uint64_t& callNum, uint64_t& skippedCallNum);
+
+private:
+    Device& m_Device;
+    CoreInterface m_CoreInterface = {};
+    StreamerInterface m_StreamerInterface = {};
+    ResourceAllocatorInterface m_ResourceAllocatorInterface = {};
+    Vector<uint64_t> m_Data; // 8-byte aligned
+    Vector<void*> m_Objects; // identity => object, "nullptr" for 0 and not restorable objects
+    Vector<CaptureObject> m_ObjectTypes; // identity - 1 => type
+    Vector<CaptureObjectDesc> m_ObjectDescs; // identity - 1 => desc
+    Vector<Buffer*> m_Buffers; // scratch for arrays with identities
+    Vector<Descriptor*> m_Descriptors;
+    Vector<CommandBuffer*> m_CommandBuffers;
+    Vector<FenceSubmitDesc> m_WaitFences;
+    Vector<FenceSubmitDesc> m_SignalFences;
+    Vector<BufferBarrierDesc> m_BufferBarriers;
+    Vector<TextureBarrierDesc> m_TextureBarriers;
+    CommandAllocator* m_CommandAllocator = nullptr;
+    uint64_t m_DataSize = 0;
+    uint64_t m_SkippedCallNum = 0;
+};
+
+} // namespace nri
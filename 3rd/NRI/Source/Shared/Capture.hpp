@@ -0,0 +1,1995 @@
+// © 2025 NVIDIA Corporation
+
+#include <cstdio>
+
+static CaptureLayer* g_CaptureLayer = nullptr;
+
+// Holds the lock, if capturing
+struct CaptureScope {
+    inline CaptureScope(CaptureLayer& layer) {
+        if (layer.IsCapturing()) {
+            layer.GetLock().Acquire();
+
+            if (layer.IsCapturing())
+                m_Layer = &layer;
+            else
+                layer.GetLock().Release();
+        }
+    }
+
+    inline ~CaptureScope() {
+        if (m_Layer)
+            m_Layer->GetLock().Release();
+    }
+
+    inline explicit operator bool() const {
+        return m_Layer != nullptr;
+    }
+
+    inline CaptureLayer* operator->() const {
+        return m_Layer;
+    }
+
+private:
+    CaptureLayer* m_Layer = nullptr;
+};
+
+// clang-format off
+constexpr CaptureObject GetCaptureObject(const Buffer*)         { return CaptureObject::BUFFER; }
+constexpr CaptureObject GetCaptureObject(const Texture*)        { return CaptureObject::TEXTURE; }
+constexpr CaptureObject GetCaptureObject(const Descriptor*)     { return CaptureObject::DESCRIPTOR; }
+constexpr CaptureObject GetCaptureObject(const DescriptorSet*)  { return CaptureObject::DESCRIPTOR_SET; }
+constexpr CaptureObject GetCaptureObject(const DescriptorPool*) { return CaptureObject::DESCRIPTOR_POOL; }
+constexpr CaptureObject GetCaptureObject(const PipelineLayout*) { return CaptureObject::PIPELINE_LAYOUT; }
+constexpr CaptureObject GetCaptureObject(const Pipeline*)       { return CaptureObject::PIPELINE; }
+constexpr CaptureObject GetCaptureObject(const QueryPool*)      { return CaptureObject::QUERY_POOL; }
+constexpr CaptureObject GetCaptureObject(const CommandBuffer*)  { return CaptureObject::COMMAND_BUFFER; }
+constexpr CaptureObject GetCaptureObject(const Queue*)          { return CaptureObject::QUEUE; }
+constexpr CaptureObject GetCaptureObject(const Fence*)          { return CaptureObject::FENCE; }
+constexpr CaptureObject GetCaptureObject(const Streamer*)       { return CaptureObject::STREAMER; }
+// clang-format on
+
+// Every read is bounds checked, every identity is range and type checked. A failure zeroes the output (arrays become
+// empty, objects point to a dummy) and invalidates the reader, the call being decoded must not be issued ("CanCall").
+// A not restorable object points to the dummy too, but only marks the call as skipped
+struct CaptureReader {
+    template <typename T>
+    inline T Read() {
+        T value = {};
+        if (size_t(end - cur) < sizeof(T)) {
+            Invalidate();
+            return value;
+        }
+
+        memcpy(&value, cur, sizeof(T));
+        cur += sizeof(T);
+
+        return value;
+    }
+
+    template <typename T, typename N>
+    inline const T* ReadArray(N& num) {
+        size_t offset = Align(size_t(cur - begin), CAPTURE_ALIGNMENT);
+        size_t size = size_t(end - begin);
+        if (offset > size || uint64_t(num) > (size - offset) / sizeof(T)) {
+            Invalidate();
+            num = 0;
+            return nullptr;
+        }
+
+        const T* array = (const T*)(begin + offset);
+        cur = begin + offset + size_t(num) * sizeof(T);
+
+        return array;
+    }
+
+    inline const char* ReadString() {
+        uint32_t size = Read<uint32_t>();
+        if (size_t(end - cur) < size || !size || cur[size - 1] != '\0') {
+            Invalidate();
+            return "";
+        }
+
+        const char* string = (const char*)cur;
+        cur += size;
+
+        return string;
+    }
+
+    // "id" - 0 for "nullptr", allowed only if "isOptional"
+    template <typename T>
+    inline T* GetObject(uint64_t id, bool isOptional) {
+        if (id == 0 && isOptional)
+            return nullptr;
+
+        if (id == 0 || id > objectNum || objectTypes[id - 1] != GetCaptureObject((const T*)nullptr)) {
+            Invalidate();
+            return (T*)&dummy;
+        }
+
+        if (!objects[id]) {
+            isSkipped = true;
+            return (T*)&dummy;
+        }
+
+        return (T*)objects[id];
+    }
+
+    template <typename T>
+    inline T* ReadObject(bool isOptional) {
+        return GetObject<T>(Read<uint32_t>(), isOptional);
+    }
+
+    inline bool CanCall() const {
+        return isValid && !isDryRun && !isSkipped;
+    }
+
+    inline void Invalidate() {
+        isValid = false;
+        cur = end;
+    }
+
+    const uint8_t* begin;
+    const uint8_t* cur;
+    const uint8_t* end;
+    void* const* objects; // identity => object
+    const CaptureObject* objectTypes; // identity - 1 => type
+    size_t objectNum;
+    uint64_t dummy;
+    bool isValid;
+    bool isSkipped; // per record
+    bool isDryRun; // validation only, no calls
+};
+
+static uint64_t GetTextureUpdateSize(const CoreInterface& core, const TextureUpdateRequestDesc& textureUpdateRequestDesc) {
+    const TextureRegionDesc& region = textureUpdateRequestDesc.dstRegionDesc;
+
+    uint64_t sliceNum = region.depth;
+    if (sliceNum == WHOLE_SIZE && textureUpdateRequestDesc.dstTexture) {
+        const TextureDesc& textureDesc = core.GetTextureDesc(*textureUpdateRequestDesc.dstTexture);
+        sliceNum = textureDesc.depth >> region.mipOffset;
+    }
+
+    return uint64_t(textureUpdateRequestDesc.dataSlicePitch) * (sliceNum ? sliceNum : 1);
+}
+
+//============================================================================================================================================================================================
+#pragma region[  Core  ]
+
+static Result NRI_CALL CreatePipelineLayoutCapture(Device& device, const PipelineLayoutDesc& pipelineLayoutDesc, PipelineLayout*& pipelineLayout) {
+    Result result = g_CaptureLayer->GetCoreInterface().CreatePipelineLayout(device, pipelineLayoutDesc, pipelineLayout);
+    if (result == Result::SUCCESS)
+        g_CaptureLayer->AddPipelineLayout(*pipelineLayout, pipelineLayoutDesc);
+
+    return result;
+}
+
+static void NRI_CALL DestroyPipelineLayoutCapture(PipelineLayout& pipelineLayout) {
+    g_CaptureLayer->ErasePipelineLayout(pipelineLayout);
+    g_CaptureLayer->GetCoreInterface().DestroyPipelineLayout(pipelineLayout);
+}
+
+static Result NRI_CALL CreateDescriptorPoolCapture(Device& device, const DescriptorPoolDesc& descriptorPoolDesc, DescriptorPool*& descriptorPool) {
+    Result result = g_CaptureLayer->GetCoreInterface().CreateDescriptorPool(device, descriptorPoolDesc, descriptorPool);
+    if (result == Result::SUCCESS) {
+        CaptureObjectDesc objectDesc = {};
+        objectDesc.descriptorPool = descriptorPoolDesc;
+
+        g_CaptureLayer->AddObjectDesc(descriptorPool, CaptureObject::DESCRIPTOR_POOL, objectDesc);
+    }
+
+    return result;
+}
+
+static Result NRI_CALL CreateQueryPoolCapture(Device& device, const QueryPoolDesc& queryPoolDesc, QueryPool*& queryPool) {
+    Result result = g_CaptureLayer->GetCoreInterface().CreateQueryPool(device, queryPoolDesc, queryPool);
+    if (result == Result::SUCCESS) {
+        CaptureObjectDesc objectDesc = {};
+        objectDesc.queryPool = queryPoolDesc;
+
+        g_CaptureLayer->AddObjectDesc(queryPool, CaptureObject::QUERY_POOL, objectDesc);
+    }
+
+    return result;
+}
+
+static Result NRI_CALL CreateSamplerCapture(Device& device, const SamplerDesc& samplerDesc, Descriptor*& sampler) {
+    Result result = g_CaptureLayer->GetCoreInterface().CreateSampler(device, samplerDesc, sampler);
+    if (result == Result::SUCCESS) {
+        CaptureObjectDesc objectDesc = {};
+        objectDesc.descriptor.type = CaptureDescriptor::SAMPLER;
+        objectDesc.descriptor.sampler = samplerDesc;
+
+        g_CaptureLayer->AddObjectDesc(sampler, CaptureObject::DESCRIPTOR, objectDesc);
+    }
+
+    return result;
+}
+
+static Result NRI_CALL CreateBufferViewCapture(const BufferViewDesc& bufferViewDesc, Descriptor*& bufferView) {
+    Result result = g_CaptureLayer->GetCoreInterface().CreateBufferView(bufferViewDesc, bufferView);
+    if (result == Result::SUCCESS) {
+        CaptureObjectDesc objectDesc = {};
+        objectDesc.descriptor.type = CaptureDescriptor::BUFFER_VIEW;
+        objectDesc.descriptor.bufferView = bufferViewDesc;
+
+        g_CaptureLayer->AddObjectDesc(bufferView, CaptureObject::DESCRIPTOR, objectDesc);
+    }
+
+    return result;
+}
+
+static Result NRI_CALL CreateTexture1DViewCapture(const Texture1DViewDesc& textureViewDesc, Descriptor*& textureView) {
+    Result result = g_CaptureLayer->GetCoreInterface().CreateTexture1DView(textureViewDesc, textureView);
+    if (result == Result::SUCCESS) {
+        CaptureObjectDesc objectDesc = {};
+        objectDesc.descriptor.type = CaptureDescriptor::TEXTURE_1D_VIEW;
+        objectDesc.descriptor.texture1DView = textureViewDesc;
+
+        g_CaptureLayer->AddObjectDesc(textureView, CaptureObject::DESCRIPTOR, objectDesc);
+    }
+
+    return result;
+}
+
+static Result NRI_CALL CreateTexture2DViewCapture(const Texture2DViewDesc& textureViewDesc, Descriptor*& textureView) {
+    Result result = g_CaptureLayer->GetCoreInterface().CreateTexture2DView(textureViewDesc, textureView);
+    if (result == Result::SUCCESS) {
+        CaptureObjectDesc objectDesc = {};
+        objectDesc.descriptor.type = CaptureDescriptor::TEXTURE_2D_VIEW;
+        objectDesc.descriptor.texture2DView = textureViewDesc;
+
+        g_CaptureLayer->AddObjectDesc(textureView, CaptureObject::DESCRIPTOR, objectDesc);
+    }
+
+    return result;
+}
+
+static Result NRI_CALL CreateTexture3DViewCapture(const Texture3DViewDesc& textureViewDesc, Descriptor*& textureView) {
+    Result result = g_CaptureLayer->GetCoreInterface().CreateTexture3DView(textureViewDesc, textureView);
+    if (result == Result::SUCCESS) {
+        CaptureObjectDesc objectDesc = {};
+        objectDesc.descriptor.type = CaptureDescriptor::TEXTURE_3D_VIEW;
+        objectDesc.descriptor.texture3DView = textureViewDesc;
+
+        g_CaptureLayer->AddObjectDesc(textureView, CaptureObject::DESCRIPTOR, objectDesc);
+    }
+
+    return result;
+}
+
+static void NRI_CALL DestroyDescriptorPoolCapture(DescriptorPool& descriptorPool) {
+    g_CaptureLayer->EraseObjectDesc(&descriptorPool, CaptureObject::DESCRIPTOR_POOL);
+    g_CaptureLayer->GetCoreInterface().DestroyDescriptorPool(descriptorPool);
+}
+
+static void NRI_CALL DestroyDescriptorCapture(Descriptor& descriptor) {
+    g_CaptureLayer->EraseObjectDesc(&descriptor, CaptureObject::DESCRIPTOR);
+    g_CaptureLayer->GetCoreInterface().DestroyDescriptor(descriptor);
+}
+
+static void NRI_CALL DestroyQueryPoolCapture(QueryPool& queryPool) {
+    g_CaptureLayer->EraseObjectDesc(&queryPool, CaptureObject::QUERY_POOL);
+    g_CaptureLayer->GetCoreInterface().DestroyQueryPool(queryPool);
+}
+
+static Result NRI_CALL BeginCommandBufferCapture(CommandBuffer& commandBuffer, const DescriptorPool* descriptorPool) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::BEGIN_COMMAND_BUFFER);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(descriptorPool));
+    }
+
+    return g_CaptureLayer->GetCoreInterface().BeginCommandBuffer(commandBuffer, descriptorPool);
+}
+
+static void NRI_CALL CmdSetDescriptorPoolCapture(CommandBuffer& commandBuffer, const DescriptorPool& descriptorPool) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_DESCRIPTOR_POOL);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&descriptorPool));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetDescriptorPool(commandBuffer, descriptorPool);
+}
+
+static void NRI_CALL CmdSetPipelineLayoutCapture(CommandBuffer& commandBuffer, const PipelineLayout& pipelineLayout) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->SetPipelineLayout(commandBuffer, pipelineLayout);
+        capture->BeginCall(CaptureCall::CMD_SET_PIPELINE_LAYOUT);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&pipelineLayout));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetPipelineLayout(commandBuffer, pipelineLayout);
+}
+
+static void NRI_CALL CmdSetPipelineCapture(CommandBuffer& commandBuffer, const Pipeline& pipeline) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_PIPELINE);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&pipeline));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetPipeline(commandBuffer, pipeline);
+}
+
+static void NRI_CALL CmdSetDescriptorSetCapture(CommandBuffer& commandBuffer, uint32_t setIndex, const DescriptorSet& descriptorSet, const uint32_t* dynamicConstantBufferOffsets) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        uint32_t offsetNum = dynamicConstantBufferOffsets ? capture->GetDynamicConstantBufferNum(commandBuffer, setIndex) : 0;
+
+        capture->BeginCall(CaptureCall::CMD_SET_DESCRIPTOR_SET);
+        capture->Write(capture->GetId(&commandBuffer), setIndex, capture->GetId(&descriptorSet), offsetNum);
+        capture->WriteArray(dynamicConstantBufferOffsets, offsetNum * sizeof(uint32_t));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetDescriptorSet(commandBuffer, setIndex, descriptorSet, dynamicConstantBufferOffsets);
+}
+
+static void NRI_CALL CmdSetRootConstantsCapture(CommandBuffer& commandBuffer, uint32_t rootConstantIndex, const void* data, uint32_t size) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_ROOT_CONSTANTS);
+        capture->Write(capture->GetId(&commandBuffer), rootConstantIndex, size);
+        capture->WriteArray(data, size);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetRootConstants(commandBuffer, rootConstantIndex, data, size);
+}
+
+static void NRI_CALL CmdSetRootDescriptorCapture(CommandBuffer& commandBuffer, uint32_t rootDescriptorIndex, Descriptor& descriptor) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_ROOT_DESCRIPTOR);
+        capture->Write(capture->GetId(&commandBuffer), rootDescriptorIndex, capture->GetId(&descriptor));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetRootDescriptor(commandBuffer, rootDescriptorIndex, descriptor);
+}
+
+static void NRI_CALL CmdBarrierCapture(CommandBuffer& commandBuffer, const BarrierGroupDesc& barrierGroupDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_BARRIER);
+        capture->Write(capture->GetId(&commandBuffer), barrierGroupDesc.globalNum, barrierGroupDesc.bufferNum, barrierGroupDesc.textureNum);
+        capture->WriteArray(barrierGroupDesc.globals, barrierGroupDesc.globalNum * sizeof(GlobalBarrierDesc));
+
+        capture->AlignStream();
+        for (uint32_t i = 0; i < barrierGroupDesc.bufferNum; i++) {
+            BufferBarrierDesc bufferBarrierDesc = barrierGroupDesc.buffers[i];
+            bufferBarrierDesc.buffer = capture->GetIdAsPointer(bufferBarrierDesc.buffer);
+            capture->Write(bufferBarrierDesc);
+        }
+
+        capture->AlignStream();
+        for (uint32_t i = 0; i < barrierGroupDesc.textureNum; i++) {
+            TextureBarrierDesc textureBarrierDesc = barrierGroupDesc.textures[i];
+            textureBarrierDesc.texture = capture->GetIdAsPointer(textureBarrierDesc.texture);
+            capture->Write(textureBarrierDesc);
+        }
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdBarrier(commandBuffer, barrierGroupDesc);
+}
+
+static void NRI_CALL CmdSetIndexBufferCapture(CommandBuffer& commandBuffer, const Buffer& buffer, uint64_t offset, IndexType indexType) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_INDEX_BUFFER);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&buffer), offset, indexType);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetIndexBuffer(commandBuffer, buffer, offset, indexType);
+}
+
+static void NRI_CALL CmdSetVertexBuffersCapture(CommandBuffer& commandBuffer, uint32_t baseSlot, uint32_t bufferNum, const Buffer* const* buffers, const uint64_t* offsets) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_VERTEX_BUFFERS);
+        capture->Write(capture->GetId(&commandBuffer), baseSlot, bufferNum, uint32_t(offsets ? 1 : 0));
+
+        capture->AlignStream();
+        for (uint32_t i = 0; i < bufferNum; i++)
+            capture->Write(capture->GetId(buffers[i]));
+
+        if (offsets)
+            capture->WriteArray(offsets, bufferNum * sizeof(uint64_t));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetVertexBuffers(commandBuffer, baseSlot, bufferNum, buffers, offsets);
+}
+
+static void NRI_CALL CmdSetViewportsCapture(CommandBuffer& commandBuffer, const Viewport* viewports, uint32_t viewportNum) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_VIEWPORTS);
+        capture->Write(capture->GetId(&commandBuffer), viewportNum);
+        capture->WriteArray(viewports, viewportNum * sizeof(Viewport));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetViewports(commandBuffer, viewports, viewportNum);
+}
+
+static void NRI_CALL CmdSetScissorsCapture(CommandBuffer& commandBuffer, const Rect* rects, uint32_t rectNum) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_SCISSORS);
+        capture->Write(capture->GetId(&commandBuffer), rectNum);
+        capture->WriteArray(rects, rectNum * sizeof(Rect));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetScissors(commandBuffer, rects, rectNum);
+}
+
+static void NRI_CALL CmdSetStencilReferenceCapture(CommandBuffer& commandBuffer, uint8_t frontRef, uint8_t backRef) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_STENCIL_REFERENCE);
+        capture->Write(capture->GetId(&commandBuffer), frontRef, backRef);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetStencilReference(commandBuffer, frontRef, backRef);
+}
+
+static void NRI_CALL CmdSetDepthBoundsCapture(CommandBuffer& commandBuffer, float boundsMin, float boundsMax) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_DEPTH_BOUNDS);
+        capture->Write(capture->GetId(&commandBuffer), boundsMin, boundsMax);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetDepthBounds(commandBuffer, boundsMin, boundsMax);
+}
+
+static void NRI_CALL CmdSetBlendConstantsCapture(CommandBuffer& commandBuffer, const Color32f& color) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_BLEND_CONSTANTS);
+        capture->Write(capture->GetId(&commandBuffer), color);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetBlendConstants(commandBuffer, color);
+}
+
+static void NRI_CALL CmdSetSampleLocationsCapture(CommandBuffer& commandBuffer, const SampleLocation* locations, Sample_t locationNum, Sample_t sampleNum) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_SAMPLE_LOCATIONS);
+        capture->Write(capture->GetId(&commandBuffer), locationNum, sampleNum);
+        capture->WriteArray(locations, locationNum * sizeof(SampleLocation));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetSampleLocations(commandBuffer, locations, locationNum, sampleNum);
+}
+
+static void NRI_CALL CmdSetShadingRateCapture(CommandBuffer& commandBuffer, const ShadingRateDesc& shadingRateDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_SHADING_RATE);
+        capture->Write(capture->GetId(&commandBuffer), shadingRateDesc);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetShadingRate(commandBuffer, shadingRateDesc);
+}
+
+static void NRI_CALL CmdSetDepthBiasCapture(CommandBuffer& commandBuffer, const DepthBiasDesc& depthBiasDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_SET_DEPTH_BIAS);
+        capture->Write(capture->GetId(&commandBuffer), depthBiasDesc);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdSetDepthBias(commandBuffer, depthBiasDesc);
+}
+
+static void NRI_CALL CmdBeginRenderingCapture(CommandBuffer& commandBuffer, const AttachmentsDesc& attachmentsDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        AttachmentsDesc attachmentsDescCapture = attachmentsDesc;
+        attachmentsDescCapture.depthStencil = capture->GetIdAsPointer(attachmentsDesc.depthStencil);
+        attachmentsDescCapture.shadingRate = capture->GetIdAsPointer(attachmentsDesc.shadingRate);
+        attachmentsDescCapture.colors = nullptr;
+
+        capture->BeginCall(CaptureCall::CMD_BEGIN_RENDERING);
+        capture->Write(capture->GetId(&commandBuffer), attachmentsDescCapture);
+
+        capture->AlignStream();
+        for (uint32_t i = 0; i < attachmentsDesc.colorNum; i++)
+            capture->Write(capture->GetId(attachmentsDesc.colors[i]));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdBeginRendering(commandBuffer, attachmentsDesc);
+}
+
+static void NRI_CALL CmdClearAttachmentsCapture(CommandBuffer& commandBuffer, const ClearDesc* clearDescs, uint32_t clearDescNum, const Rect* rects, uint32_t rectNum) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_CLEAR_ATTACHMENTS);
+        capture->Write(capture->GetId(&commandBuffer), clearDescNum, rectNum);
+        capture->WriteArray(clearDescs, clearDescNum * sizeof(ClearDesc));
+        capture->WriteArray(rects, rectNum * sizeof(Rect));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdClearAttachments(commandBuffer, clearDescs, clearDescNum, rects, rectNum);
+}
+
+static void NRI_CALL CmdDrawCapture(CommandBuffer& commandBuffer, const DrawDesc& drawDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_DRAW);
+        capture->Write(capture->GetId(&commandBuffer), drawDesc);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdDraw(commandBuffer, drawDesc);
+}
+
+static void NRI_CALL CmdDrawIndexedCapture(CommandBuffer& commandBuffer, const DrawIndexedDesc& drawIndexedDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_DRAW_INDEXED);
+        capture->Write(capture->GetId(&commandBuffer), drawIndexedDesc);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdDrawIndexed(commandBuffer, drawIndexedDesc);
+}
+
+static void NRI_CALL CmdDrawIndirectCapture(CommandBuffer& commandBuffer, const Buffer& buffer, uint64_t offset, uint32_t drawNum, uint32_t stride, const Buffer* countBuffer, uint64_t countBufferOffset) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_DRAW_INDIRECT);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&buffer), offset, drawNum, stride, capture->GetId(countBuffer), countBufferOffset);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdDrawIndirect(commandBuffer, buffer, offset, drawNum, stride, countBuffer, countBufferOffset);
+}
+
+static void NRI_CALL CmdDrawIndexedIndirectCapture(CommandBuffer& commandBuffer, const Buffer& buffer, uint64_t offset, uint32_t drawNum, uint32_t stride, const Buffer* countBuffer, uint64_t countBufferOffset) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_DRAW_INDEXED_INDIRECT);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&buffer), offset, drawNum, stride, capture->GetId(countBuffer), countBufferOffset);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdDrawIndexedIndirect(commandBuffer, buffer, offset, drawNum, stride, countBuffer, countBufferOffset);
+}
+
+static void NRI_CALL CmdEndRenderingCapture(CommandBuffer& commandBuffer) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_END_RENDERING);
+        capture->Write(capture->GetId(&commandBuffer));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdEndRendering(commandBuffer);
+}
+
+static void NRI_CALL CmdDispatchCapture(CommandBuffer& commandBuffer, const DispatchDesc& dispatchDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_DISPATCH);
+        capture->Write(capture->GetId(&commandBuffer), dispatchDesc);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdDispatch(commandBuffer, dispatchDesc);
+}
+
+static void NRI_CALL CmdDispatchIndirectCapture(CommandBuffer& commandBuffer, const Buffer& buffer, uint64_t offset) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_DISPATCH_INDIRECT);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&buffer), offset);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdDispatchIndirect(commandBuffer, buffer, offset);
+}
+
+static void NRI_CALL CmdCopyBufferCapture(CommandBuffer& commandBuffer, Buffer& dstBuffer, uint64_t dstOffset, const Buffer& srcBuffer, uint64_t srcOffset, uint64_t size) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_COPY_BUFFER);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&dstBuffer), dstOffset, capture->GetId(&srcBuffer), srcOffset, size);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdCopyBuffer(commandBuffer, dstBuffer, dstOffset, srcBuffer, srcOffset, size);
+}
+
+static void WriteTextureCopy(CaptureScope& capture, CaptureCall call, const CommandBuffer& commandBuffer, const Texture& dstTexture, const TextureRegionDesc* dstRegionDesc, const Texture& srcTexture, const TextureRegionDesc* srcRegionDesc) {
+    capture->BeginCall(call);
+    capture->Write(capture->GetId(&commandBuffer), capture->GetId(&dstTexture), capture->GetId(&srcTexture));
+    capture->Write(uint32_t(dstRegionDesc ? 1 : 0), dstRegionDesc ? *dstRegionDesc : TextureRegionDesc{});
+    capture->Write(uint32_t(srcRegionDesc ? 1 : 0), srcRegionDesc ? *srcRegionDesc : TextureRegionDesc{});
+}
+
+static void NRI_CALL CmdCopyTextureCapture(CommandBuffer& commandBuffer, Texture& dstTexture, const TextureRegionDesc* dstRegionDesc, const Texture& srcTexture, const TextureRegionDesc* srcRegionDesc) {
+    if (CaptureScope capture{*g_CaptureLayer})
+        WriteTextureCopy(capture, CaptureCall::CMD_COPY_TEXTURE, commandBuffer, dstTexture, dstRegionDesc, srcTexture, srcRegionDesc);
+
+    g_CaptureLayer->GetCoreInterface().CmdCopyTexture(commandBuffer, dstTexture, dstRegionDesc, srcTexture, srcRegionDesc);
+}
+
+static void NRI_CALL CmdResolveTextureCapture(CommandBuffer& commandBuffer, Texture& dstTexture, const TextureRegionDesc* dstRegionDesc, const Texture& srcTexture, const TextureRegionDesc* srcRegionDesc) {
+    if (CaptureScope capture{*g_CaptureLayer})
+        WriteTextureCopy(capture, CaptureCall::CMD_RESOLVE_TEXTURE, commandBuffer, dstTexture, dstRegionDesc, srcTexture, srcRegionDesc);
+
+    g_CaptureLayer->GetCoreInterface().CmdResolveTexture(commandBuffer, dstTexture, dstRegionDesc, srcTexture, srcRegionDesc);
+}
+
+static void NRI_CALL CmdUploadBufferToTextureCapture(CommandBuffer& commandBuffer, Texture& dstTexture, const TextureRegionDesc& dstRegionDesc, const Buffer& srcBuffer, const TextureDataLayoutDesc& srcDataLayoutDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_UPLOAD_BUFFER_TO_TEXTURE);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&dstTexture), dstRegionDesc, capture->GetId(&srcBuffer), srcDataLayoutDesc);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdUploadBufferToTexture(commandBuffer, dstTexture, dstRegionDesc, srcBuffer, srcDataLayoutDesc);
+}
+
+static void NRI_CALL CmdReadbackTextureToBufferCapture(CommandBuffer& commandBuffer, Buffer& dstBuffer, const TextureDataLayoutDesc& dstDataLayoutDesc, const Texture& srcTexture, const TextureRegionDesc& srcRegionDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_READBACK_TEXTURE_TO_BUFFER);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&dstBuffer), dstDataLayoutDesc, capture->GetId(&srcTexture), srcRegionDesc);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdReadbackTextureToBuffer(commandBuffer, dstBuffer, dstDataLayoutDesc, srcTexture, srcRegionDesc);
+}
+
+static void NRI_CALL CmdClearStorageBufferCapture(CommandBuffer& commandBuffer, const ClearStorageBufferDesc& clearDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        ClearStorageBufferDesc clearDescCapture = clearDesc;
+        clearDescCapture.storageBuffer = capture->GetIdAsPointer(clearDesc.storageBuffer);
+
+        capture->BeginCall(CaptureCall::CMD_CLEAR_STORAGE_BUFFER);
+        capture->Write(capture->GetId(&commandBuffer), clearDescCapture);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdClearStorageBuffer(commandBuffer, clearDesc);
+}
+
+static void NRI_CALL CmdClearStorageTextureCapture(CommandBuffer& commandBuffer, const ClearStorageTextureDesc& clearDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        ClearStorageTextureDesc clearDescCapture = clearDesc;
+        clearDescCapture.storageTexture = capture->GetIdAsPointer(clearDesc.storageTexture);
+
+        capture->BeginCall(CaptureCall::CMD_CLEAR_STORAGE_TEXTURE);
+        capture->Write(capture->GetId(&commandBuffer), clearDescCapture);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdClearStorageTexture(commandBuffer, clearDesc);
+}
+
+static void NRI_CALL CmdResetQueriesCapture(CommandBuffer& commandBuffer, QueryPool& queryPool, uint32_t offset, uint32_t num) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_RESET_QUERIES);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&queryPool), offset, num);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdResetQueries(commandBuffer, queryPool, offset, num);
+}
+
+static void NRI_CALL CmdBeginQueryCapture(CommandBuffer& commandBuffer, QueryPool& queryPool, uint32_t offset) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_BEGIN_QUERY);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&queryPool), offset);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdBeginQuery(commandBuffer, queryPool, offset);
+}
+
+static void NRI_CALL CmdEndQueryCapture(CommandBuffer& commandBuffer, QueryPool& queryPool, uint32_t offset) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_END_QUERY);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&queryPool), offset);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdEndQuery(commandBuffer, queryPool, offset);
+}
+
+static void NRI_CALL CmdCopyQueriesCapture(CommandBuffer& commandBuffer, const QueryPool& queryPool, uint32_t offset, uint32_t num, Buffer& dstBuffer, uint64_t dstOffset) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_COPY_QUERIES);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&queryPool), offset, num, capture->GetId(&dstBuffer), dstOffset);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdCopyQueries(commandBuffer, queryPool, offset, num, dstBuffer, dstOffset);
+}
+
+static void NRI_CALL CmdBeginAnnotationCapture(CommandBuffer& commandBuffer, const char* name, uint32_t bgra) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_BEGIN_ANNOTATION);
+        capture->Write(capture->GetId(&commandBuffer), bgra);
+        capture->WriteString(name);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdBeginAnnotation(commandBuffer, name, bgra);
+}
+
+static void NRI_CALL CmdEndAnnotationCapture(CommandBuffer& commandBuffer) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_END_ANNOTATION);
+        capture->Write(capture->GetId(&commandBuffer));
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdEndAnnotation(commandBuffer);
+}
+
+static void NRI_CALL CmdAnnotationCapture(CommandBuffer& commandBuffer, const char* name, uint32_t bgra) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_ANNOTATION);
+        capture->Write(capture->GetId(&commandBuffer), bgra);
+        capture->WriteString(name);
+    }
+
+    g_CaptureLayer->GetCoreInterface().CmdAnnotation(commandBuffer, name, bgra);
+}
+
+static Result NRI_CALL EndCommandBufferCapture(CommandBuffer& commandBuffer) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::END_COMMAND_BUFFER);
+        capture->Write(capture->GetId(&commandBuffer));
+    }
+
+    return g_CaptureLayer->GetCoreInterface().EndCommandBuffer(commandBuffer);
+}
+
+static void NRI_CALL QueueSubmitCapture(Queue& queue, const QueueSubmitDesc& queueSubmitDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::QUEUE_SUBMIT);
+        capture->Write(capture->GetId(&queue), queueSubmitDesc.waitFenceNum, queueSubmitDesc.commandBufferNum, queueSubmitDesc.signalFenceNum);
+
+        capture->AlignStream();
+        for (uint32_t i = 0; i < queueSubmitDesc.waitFenceNum; i++) {
+            FenceSubmitDesc fenceSubmitDesc = queueSubmitDesc.waitFences[i];
+            fenceSubmitDesc.fence = capture->GetIdAsPointer(fenceSubmitDesc.fence);
+            capture->Write(fenceSubmitDesc);
+        }
+
+        capture->AlignStream();
+        for (uint32_t i = 0; i < queueSubmitDesc.commandBufferNum; i++)
+            capture->Write(capture->GetId(queueSubmitDesc.commandBuffers[i]));
+
+        capture->AlignStream();
+        for (uint32_t i = 0; i < queueSubmitDesc.signalFenceNum; i++) {
+            FenceSubmitDesc fenceSubmitDesc = queueSubmitDesc.signalFences[i];
+            fenceSubmitDesc.fence = capture->GetIdAsPointer(fenceSubmitDesc.fence);
+            capture->Write(fenceSubmitDesc);
+        }
+    }
+
+    g_CaptureLayer->GetCoreInterface().QueueSubmit(queue, queueSubmitDesc);
+}
+
+#pragma endregion
+
+//============================================================================================================================================================================================
+#pragma region[  Streamer  ]
+
+static Result NRI_CALL CreateStreamerCapture(Device& device, const StreamerDesc& streamerDesc, Streamer*& streamer) {
+    Result result = g_CaptureLayer->GetStreamerInterface().CreateStreamer(device, streamerDesc, streamer);
+    if (result == Result::SUCCESS) {
+        CaptureObjectDesc objectDesc = {};
+        objectDesc.streamer = streamerDesc;
+
+        g_CaptureLayer->AddObjectDesc(streamer, CaptureObject::STREAMER, objectDesc);
+    }
+
+    return result;
+}
+
+static void NRI_CALL DestroyStreamerCapture(Streamer& streamer) {
+    g_CaptureLayer->EraseObjectDesc(&streamer, CaptureObject::STREAMER);
+    g_CaptureLayer->GetStreamerInterface().DestroyStreamer(streamer);
+}
+
+static uint32_t NRI_CALL UpdateStreamerConstantBufferCapture(Streamer& streamer, const void* data, uint32_t dataSize) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::UPDATE_STREAMER_CONSTANT_BUFFER);
+        capture->Write(capture->GetId(&streamer), dataSize);
+        capture->WriteArray(data, dataSize);
+    }
+
+    return g_CaptureLayer->GetStreamerInterface().UpdateStreamerConstantBuffer(streamer, data, dataSize);
+}
+
+static uint64_t NRI_CALL AddStreamerBufferUpdateRequestCapture(Streamer& streamer, const BufferUpdateRequestDesc& bufferUpdateRequestDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        BufferUpdateRequestDesc bufferUpdateRequestDescCapture = bufferUpdateRequestDesc;
+        bufferUpdateRequestDescCapture.data = nullptr;
+        bufferUpdateRequestDescCapture.dstBuffer = capture->GetIdAsPointer(bufferUpdateRequestDesc.dstBuffer);
+
+        capture->BeginCall(CaptureCall::ADD_STREAMER_BUFFER_UPDATE_REQUEST);
+        capture->Write(capture->GetId(&streamer), bufferUpdateRequestDescCapture);
+        capture->WriteArray(bufferUpdateRequestDesc.data, bufferUpdateRequestDesc.dataSize);
+    }
+
+    return g_CaptureLayer->GetStreamerInterface().AddStreamerBufferUpdateRequest(streamer, bufferUpdateRequestDesc);
+}
+
+static uint64_t NRI_CALL AddStreamerTextureUpdateRequestCapture(Streamer& streamer, const TextureUpdateRequestDesc& textureUpdateRequestDesc) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        uint64_t dataSize = GetTextureUpdateSize(g_CaptureLayer->GetCoreInterface(), textureUpdateRequestDesc);
+
+        TextureUpdateRequestDesc textureUpdateRequestDescCapture = textureUpdateRequestDesc;
+        textureUpdateRequestDescCapture.data = nullptr;
+        textureUpdateRequestDescCapture.dstTexture = capture->GetIdAsPointer(textureUpdateRequestDesc.dstTexture);
+
+        capture->BeginCall(CaptureCall::ADD_STREAMER_TEXTURE_UPDATE_REQUEST);
+        capture->Write(capture->GetId(&streamer), textureUpdateRequestDescCapture, dataSize);
+        capture->WriteArray(textureUpdateRequestDesc.data, dataSize);
+    }
+
+    return g_CaptureLayer->GetStreamerInterface().AddStreamerTextureUpdateRequest(streamer, textureUpdateRequestDesc);
+}
+
+static Result NRI_CALL CopyStreamerUpdateRequestsCapture(Streamer& streamer) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::COPY_STREAMER_UPDATE_REQUESTS);
+        capture->Write(capture->GetId(&streamer));
+    }
+
+    return g_CaptureLayer->GetStreamerInterface().CopyStreamerUpdateRequests(streamer);
+}
+
+static void NRI_CALL CmdUploadStreamerUpdateRequestsCapture(CommandBuffer& commandBuffer, Streamer& streamer) {
+    if (CaptureScope capture{*g_CaptureLayer}) {
+        capture->BeginCall(CaptureCall::CMD_UPLOAD_STREAMER_UPDATE_REQUESTS);
+        capture->Write(capture->GetId(&commandBuffer), capture->GetId(&streamer));
+    }
+
+    g_CaptureLayer->GetStreamerInterface().CmdUploadStreamerUpdateRequests(commandBuffer, streamer);
+}
+
+#pragma endregion
+
+//============================================================================================================================================================================================
+#pragma region[  CaptureLayer  ]
+
+void CaptureLayer::WrapFunctionTable(CoreInterface& table) {
+    m_CoreInterface = table;
+
+    table.CreatePipelineLayout = ::CreatePipelineLayoutCapture;
+    table.DestroyPipelineLayout = ::DestroyPipelineLayoutCapture;
+    table.CreateDescriptorPool = ::CreateDescriptorPoolCapture;
+    table.CreateQueryPool = ::CreateQueryPoolCapture;
+    table.CreateSampler = ::CreateSamplerCapture;
+    table.CreateBufferView = ::CreateBufferViewCapture;
+    table.CreateTexture1DView = ::CreateTexture1DViewCapture;
+    table.CreateTexture2DView = ::CreateTexture2DViewCapture;
+    table.CreateTexture3DView = ::CreateTexture3DViewCapture;
+    table.DestroyDescriptorPool = ::DestroyDescriptorPoolCapture;
+    table.DestroyDescriptor = ::DestroyDescriptorCapture;
+    table.DestroyQueryPool = ::DestroyQueryPoolCapture;
+    table.BeginCommandBuffer = ::BeginCommandBufferCapture;
+    table.CmdSetDescriptorPool = ::CmdSetDescriptorPoolCapture;
+    table.CmdSetPipelineLayout = ::CmdSetPipelineLayoutCapture;
+    table.CmdSetPipeline = ::CmdSetPipelineCapture;
+    table.CmdSetDescriptorSet = ::CmdSetDescriptorSetCapture;
+    table.CmdSetRootConstants = ::CmdSetRootConstantsCapture;
+    table.CmdSetRootDescriptor = ::CmdSetRootDescriptorCapture;
+    table.CmdBarrier = ::CmdBarrierCapture;
+    table.CmdSetIndexBuffer = ::CmdSetIndexBufferCapture;
+    table.CmdSetVertexBuffers = ::CmdSetVertexBuffersCapture;
+    table.CmdSetViewports = ::CmdSetViewportsCapture;
+    table.CmdSetScissors = ::CmdSetScissorsCapture;
+    table.CmdSetStencilReference = ::CmdSetStencilReferenceCapture;
+    table.CmdSetDepthBounds = ::CmdSetDepthBoundsCapture;
+    table.CmdSetBlendConstants = ::CmdSetBlendConstantsCapture;
+    table.CmdSetSampleLocations = ::CmdSetSampleLocationsCapture;
+    table.CmdSetShadingRate = ::CmdSetShadingRateCapture;
+    table.CmdSetDepthBias = ::CmdSetDepthBiasCapture;
+    table.CmdBeginRendering = ::CmdBeginRenderingCapture;
+    table.CmdClearAttachments = ::CmdClearAttachmentsCapture;
+    table.CmdDraw = ::CmdDrawCapture;
+    table.CmdDrawIndexed = ::CmdDrawIndexedCapture;
+    table.CmdDrawIndirect = ::CmdDrawIndirectCapture;
+    table.CmdDrawIndexedIndirect = ::CmdDrawIndexedIndirectCapture;
+    table.CmdEndRendering = ::CmdEndRenderingCapture;
+    table.CmdDispatch = ::CmdDispatchCapture;
+    table.CmdDispatchIndirect = ::CmdDispatchIndirectCapture;
+    table.CmdCopyBuffer = ::CmdCopyBufferCapture;
+    table.CmdCopyTexture = ::CmdCopyTextureCapture;
+    table.CmdResolveTexture = ::CmdResolveTextureCapture;
+    table.CmdUploadBufferToTexture = ::CmdUploadBufferToTextureCapture;
+    table.CmdReadbackTextureToBuffer = ::CmdReadbackTextureToBufferCapture;
+    table.CmdClearStorageBuffer = ::CmdClearStorageBufferCapture;
+    table.CmdClearStorageTexture = ::CmdClearStorageTextureCapture;
+    table.CmdResetQueries = ::CmdResetQueriesCapture;
+    table.CmdBeginQuery = ::CmdBeginQueryCapture;
+    table.CmdEndQuery = ::CmdEndQueryCapture;
+    table.CmdCopyQueries = ::CmdCopyQueriesCapture;
+    table.CmdBeginAnnotation = ::CmdBeginAnnotationCapture;
+    table.CmdEndAnnotation = ::CmdEndAnnotationCapture;
+    table.CmdAnnotation = ::CmdAnnotationCapture;
+    table.EndCommandBuffer = ::EndCommandBufferCapture;
+    table.QueueSubmit = ::QueueSubmitCapture;
+}
+
+void CaptureLayer::WrapFunctionTable(StreamerInterface& table) {
+    m_StreamerInterface = table;
+
+    table.CreateStreamer = ::CreateStreamerCapture;
+    table.DestroyStreamer = ::DestroyStreamerCapture;
+    table.UpdateStreamerConstantBuffer = ::UpdateStreamerConstantBufferCapture;
+    table.AddStreamerBufferUpdateRequest = ::AddStreamerBufferUpdateRequestCapture;
+    table.AddStreamerTextureUpdateRequest = ::AddStreamerTextureUpdateRequestCapture;
+    table.CopyStreamerUpdateRequests = ::CopyStreamerUpdateRequestsCapture;
+    table.CmdUploadStreamerUpdateRequests = ::CmdUploadStreamerUpdateRequestsCapture;
+}
+
+Result CaptureLayer::Begin() {
+    ExclusiveScope lock(m_Lock);
+
+    if (m_IsCapturing.load(std::memory_order_relaxed))
+        return Result::FAILURE;
+
+    m_Stream.clear();
+    m_Objects.clear();
+    m_ObjectTypes.clear();
+    m_ObjectDescs.clear();
+    m_CommandBufferLayouts.clear();
+    m_CallNum = 0;
+
+    m_IsCapturing.store(true, std::memory_order_relaxed);
+
+    return Result::SUCCESS;
+}
+
+Result CaptureLayer::End(const char* path) {
+    ExclusiveScope lock(m_Lock);
+
+    if (!m_IsCapturing.load(std::memory_order_relaxed))
+        return Result::FAILURE;
+
+    m_IsCapturing.store(false, std::memory_order_relaxed);
+
+    CaptureHeader header = {};
+    header.magic = CAPTURE_MAGIC;
+    header.version = CAPTURE_VERSION;
+    header.nriVersionMajor = NRI_VERSION_MAJOR;
+    header.nriVersionMinor = NRI_VERSION_MINOR;
+    header.pointerSize = sizeof(void*);
+    header.objectNum = (uint32_t)m_ObjectTypes.size();
+    header.callNum = m_CallNum;
+    header.dataSize = m_Stream.size();
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        REPORT_ERROR((DeviceBase*)&m_Device, "Can't open '%s'", path);
+        return Result::FAILURE;
+    }
+
+    bool isOk = fwrite(&header, sizeof(header), 1, file) == 1;
+    isOk = isOk && (m_ObjectTypes.empty() || fwrite(m_ObjectTypes.data(), m_ObjectTypes.size(), 1, file) == 1);
+    isOk = isOk && (m_ObjectDescs.empty() || fwrite(m_ObjectDescs.data(), m_ObjectDescs.size() * sizeof(CaptureObjectDesc), 1, file) == 1);
+    isOk = isOk && (m_Stream.empty() || fwrite(m_Stream.data(), m_Stream.size(), 1, file) == 1);
+    isOk = fclose(file) == 0 && isOk;
+
+    // Keep the memory for the next capture, but not the objects
+    m_Stream.clear();
+    m_Objects.clear();
+    m_ObjectTypes.clear();
+    m_ObjectDescs.clear();
+    m_CommandBufferLayouts.clear();
+
+    if (!isOk) {
+        REPORT_ERROR((DeviceBase*)&m_Device, "Can't write '%s'", path);
+        return Result::FAILURE;
+    }
+
+    return Result::SUCCESS;
+}
+
+void CaptureLayer::AddPipelineLayout(const PipelineLayout& pipelineLayout, const PipelineLayoutDesc& pipelineLayoutDesc) {
+    ExclusiveScope lock(m_Lock);
+
+    m_PipelineLayouts[&pipelineLayout] = pipelineLayoutDesc.descriptorSetNum;
+
+    for (uint32_t i = 0; i < pipelineLayoutDesc.descriptorSetNum; i++) {
+        uint32_t dynamicConstantBufferNum = pipelineLayoutDesc.descriptorSets[i].dynamicConstantBufferNum;
+        if (dynamicConstantBufferNum)
+            m_DynamicConstantBufferNums[size_t(&pipelineLayout) ^ (uint64_t(i) << 48)] = dynamicConstantBufferNum;
+    }
+}
+
+void CaptureLayer::ErasePipelineLayout(const PipelineLayout& pipelineLayout) {
+    ExclusiveScope lock(m_Lock);
+
+    const auto it = m_PipelineLayouts.find(&pipelineLayout);
+    if (it == m_PipelineLayouts.end())
+        return;
+
+    for (uint32_t i = 0; i < it->second; i++)
+        m_DynamicConstantBufferNums.erase(size_t(&pipelineLayout) ^ (uint64_t(i) << 48));
+
+    m_PipelineLayouts.erase(it);
+}
+
+void CaptureLayer::AddObjectDesc(const void* object, CaptureObject type, const CaptureObjectDesc& objectDesc) {
+    ExclusiveScope lock(m_Lock);
+
+    m_TrackedDescs[size_t(object) ^ (uint64_t(type) << 56)] = objectDesc;
+}
+
+void CaptureLayer::EraseObjectDesc(const void* object, CaptureObject type) {
+    ExclusiveScope lock(m_Lock);
+
+    // A new object at the same address must get a new identity
+    uint64_t key = size_t(object) ^ (uint64_t(type) << 56);
+    m_TrackedDescs.erase(key);
+    m_Objects.erase(key);
+}
+
+uint32_t CaptureLayer::GetDynamicConstantBufferNum(const CommandBuffer& commandBuffer, uint32_t setIndex) const {
+    // Unknown if the pipeline layout has been set before capturing
+    const auto layout = m_CommandBufferLayouts.find(&commandBuffer);
+    if (layout == m_CommandBufferLayouts.end())
+        return 0;
+
+    const auto it = m_DynamicConstantBufferNums.find(size_t(layout->second) ^ (uint64_t(setIndex) << 48));
+
+    return it != m_DynamicConstantBufferNums.end() ? it->second : 0;
+}
+
+void CaptureLayer::SetPipelineLayout(const CommandBuffer& commandBuffer, const PipelineLayout& pipelineLayout) {
+    m_CommandBufferLayouts[&commandBuffer] = &pipelineLayout;
+}
+
+uint32_t CaptureLayer::GetId(const void* object, CaptureObject type) {
+    if (!object)
+        return 0;
+
+    // User space pointers don't use the top byte
+    uint64_t key = size_t(object) ^ (uint64_t(type) << 56);
+
+    const auto it = m_Objects.find(key);
+    if (it != m_Objects.end())
+        return it->second;
+
+    CaptureObjectDesc objectDesc = {};
+    objectDesc.isRestorable = true;
+
+    switch (type) {
+        case CaptureObject::BUFFER:
+            objectDesc.buffer = m_CoreInterface.GetBufferDesc(*(const Buffer*)object);
+            break;
+        case CaptureObject::TEXTURE:
+            objectDesc.texture = m_CoreInterface.GetTextureDesc(*(const Texture*)object);
+            break;
+        case CaptureObject::DESCRIPTOR:
+        case CaptureObject::DESCRIPTOR_POOL:
+        case CaptureObject::QUERY_POOL:
+        case CaptureObject::STREAMER: {
+            // Unknown if created before "CreateCaptureLayer" or by another interface
+            const auto tracked = m_TrackedDescs.find(key);
+            if (tracked != m_TrackedDescs.end())
+                objectDesc = tracked->second;
+
+            objectDesc.isRestorable = tracked != m_TrackedDescs.end();
+        } break;
+        case CaptureObject::DESCRIPTOR_SET:
+        case CaptureObject::PIPELINE_LAYOUT:
+        case CaptureObject::PIPELINE:
+            objectDesc.isRestorable = false; // nested arrays and shader bytecode are not recorded
+            break;
+        default:
+            break;
+    }
+
+    // Resources of descriptors get identities first, to be created first on replay
+    if (type == CaptureObject::DESCRIPTOR) {
+        CaptureDescriptorDesc& descriptorDesc = objectDesc.descriptor;
+
+        switch (descriptorDesc.type) {
+            case CaptureDescriptor::BUFFER_VIEW:
+                descriptorDesc.bufferView.buffer = GetIdAsPointer(descriptorDesc.bufferView.buffer);
+                break;
+            case CaptureDescriptor::TEXTURE_1D_VIEW:
+                descriptorDesc.texture1DView.texture = GetIdAsPointer(descriptorDesc.texture1DView.texture);
+                break;
+            case CaptureDescriptor::TEXTURE_2D_VIEW:
+                descriptorDesc.texture2DView.texture = GetIdAsPointer(descriptorDesc.texture2DView.texture);
+                break;
+            case CaptureDescriptor::TEXTURE_3D_VIEW:
+                descriptorDesc.texture3DView.texture = GetIdAsPointer(descriptorDesc.texture3DView.texture);
+                break;
+            default:
+                break;
+        }
+    }
+
+    m_ObjectTypes.push_back(type);
+    m_ObjectDescs.push_back(objectDesc);
+
+    uint32_t id = (uint32_t)m_ObjectTypes.size();
+    m_Objects[key] = id;
+
+    return id;
+}
+
+void CaptureLayer::BeginCall(CaptureCall call) {
+    Write(call);
+    m_CallNum++;
+}
+
+void CaptureLayer::AlignStream() {
+    m_Stream.resize(Align(m_Stream.size(), CAPTURE_ALIGNMENT));
+}
+
+void CaptureLayer::WriteData(const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    m_Stream.insert(m_Stream.end(), bytes, bytes + size);
+}
+
+void CaptureLayer::WriteArray(const void* data, size_t size) {
+    AlignStream();
+
+    if (size)
+        WriteData(data, size);
+}
+
+void CaptureLayer::WriteString(const char* string) {
+    uint32_t size = uint32_t(strlen(string) + 1);
+
+    Write(size);
+    WriteData(string, size);
+}
+
+#pragma endregion
+
+//============================================================================================================================================================================================
+#pragma region[  CaptureImpl  ]
+
+CaptureImpl::~CaptureImpl() {
+    // Objects are created in order (views after resources), the rest is "nullptr" if "Create" failed
+    for (size_t id = m_Objects.size(); id > 1; id--) {
+        void* object = m_Objects[id - 1];
+        if (!object)
+            continue;
+
+        switch (m_ObjectTypes[id - 2]) {
+            case CaptureObject::BUFFER:
+                m_CoreInterface.DestroyBuffer(*(Buffer*)object);
+                break;
+            case CaptureObject::TEXTURE:
+                m_CoreInterface.DestroyTexture(*(Texture*)object);
+                break;
+            case CaptureObject::DESCRIPTOR:
+                m_CoreInterface.DestroyDescriptor(*(Descriptor*)object);
+                break;
+            case CaptureObject::DESCRIPTOR_POOL:
+                m_CoreInterface.DestroyDescriptorPool(*(DescriptorPool*)object);
+                break;
+            case CaptureObject::QUERY_POOL:
+                m_CoreInterface.DestroyQueryPool(*(QueryPool*)object);
+                break;
+            case CaptureObject::COMMAND_BUFFER:
+                m_CoreInterface.DestroyCommandBuffer(*(CommandBuffer*)object);
+                break;
+            case CaptureObject::FENCE:
+                m_CoreInterface.DestroyFence(*(Fence*)object);
+                break;
+            case CaptureObject::STREAMER:
+                m_StreamerInterface.DestroyStreamer(*(Streamer*)object);
+                break;
+            default: // queues belong to the device, the rest is not restorable
+                break;
+        }
+    }
+
+    if (m_CommandAllocator)
+        m_CoreInterface.DestroyCommandAllocator(*m_CommandAllocator);
+}
+
+template <typename T>
+T* CaptureImpl::GetCreatedObject(const T* id, uint32_t objectId) const {
+    // Objects referenced by a desc get identities before the object
+    size_t i = size_t(id);
+    if (i == 0 || i >= objectId || m_ObjectTypes[i - 1] != GetCaptureObject((const T*)nullptr))
+        return nullptr;
+
+    return (T*)m_Objects[i];
+}
+
+Result CaptureImpl::CreateObject(uint32_t objectId) {
+    CaptureObject type = m_ObjectTypes[objectId - 1];
+    const CaptureObjectDesc& objectDesc = m_ObjectDescs[objectId - 1];
+    void*& object = m_Objects[objectId];
+
+    // Calls using it are skipped
+    if (!objectDesc.isRestorable)
+        return Result::SUCCESS;
+
+    switch (type) {
+        case CaptureObject::BUFFER:
+            // Bound to memory, if possible (memory locations are not recorded)
+            if (m_ResourceAllocatorInterface.AllocateBuffer)
+                return m_ResourceAllocatorInterface.AllocateBuffer(m_Device, {objectDesc.buffer, MemoryLocation::DEVICE}, (Buffer*&)object);
+
+            return m_CoreInterface.CreateBuffer(m_Device, objectDesc.buffer, (Buffer*&)object);
+        case CaptureObject::TEXTURE:
+            if (m_ResourceAllocatorInterface.AllocateTexture)
+                return m_ResourceAllocatorInterface.AllocateTexture(m_Device, {objectDesc.texture, MemoryLocation::DEVICE}, (Texture*&)object);
+
+            return m_CoreInterface.CreateTexture(m_Device, objectDesc.texture, (Texture*&)object);
+        case CaptureObject::DESCRIPTOR: {
+            CaptureDescriptorDesc descriptorDesc = objectDesc.descriptor;
+
+            // "INVALID_ARGUMENT" if the resource is not restored
+            switch (descriptorDesc.type) {
+                case CaptureDescriptor::BUFFER_VIEW:
+                    descriptorDesc.bufferView.buffer = GetCreatedObject(descriptorDesc.bufferView.buffer, objectId);
+                    if (!descriptorDesc.bufferView.buffer)
+                        return Result::INVALID_ARGUMENT;
+
+                    return m_CoreInterface.CreateBufferView(descriptorDesc.bufferView, (Descriptor*&)object);
+                case CaptureDescriptor::TEXTURE_1D_VIEW:
+                    descriptorDesc.texture1DView.texture = GetCreatedObject(descriptorDesc.texture1DView.texture, objectId);
+                    if (!descriptorDesc.texture1DView.texture)
+                        return Result::INVALID_ARGUMENT;
+
+                    return m_CoreInterface.CreateTexture1DView(descriptorDesc.texture1DView, (Descriptor*&)object);
+                case CaptureDescriptor::TEXTURE_2D_VIEW:
+                    descriptorDesc.texture2DView.texture = GetCreatedObject(descriptorDesc.texture2DView.texture, objectId);
+                    if (!descriptorDesc.texture2DView.texture)
+                        return Result::INVALID_ARGUMENT;
+
+                    return m_CoreInterface.CreateTexture2DView(descriptorDesc.texture2DView, (Descriptor*&)object);
+                case CaptureDescriptor::TEXTURE_3D_VIEW:
+                    descriptorDesc.texture3DView.texture = GetCreatedObject(descriptorDesc.texture3DView.texture, objectId);
+                    if (!descriptorDesc.texture3DView.texture)
+                        return Result::INVALID_ARGUMENT;
+
+                    return m_CoreInterface.CreateTexture3DView(descriptorDesc.texture3DView, (Descriptor*&)object);
+                case CaptureDescriptor::SAMPLER:
+                    return m_CoreInterface.CreateSampler(m_Device, descriptorDesc.sampler, (Descriptor*&)object);
+                default:
+                    return Result::INVALID_ARGUMENT;
+            }
+        }
+        case CaptureObject::DESCRIPTOR_POOL:
+            return m_CoreInterface.CreateDescriptorPool(m_Device, objectDesc.descriptorPool, (DescriptorPool*&)object);
+        case CaptureObject::QUERY_POOL:
+            return m_CoreInterface.CreateQueryPool(m_Device, objectDesc.queryPool, (QueryPool*&)object);
+        case CaptureObject::COMMAND_BUFFER: {
+            if (!m_CommandAllocator) {
+                Queue* queue = nullptr;
+                Result result = m_CoreInterface.GetQueue(m_Device, QueueType::GRAPHICS, 0, queue);
+                if (result != Result::SUCCESS)
+                    return result;
+
+                result = m_CoreInterface.CreateCommandAllocator(*queue, m_CommandAllocator);
+                if (result != Result::SUCCESS)
+                    return result;
+            }
+
+            return m_CoreInterface.CreateCommandBuffer(*m_CommandAllocator, (CommandBuffer*&)object);
+        }
+        case CaptureObject::QUEUE:
+            return m_CoreInterface.GetQueue(m_Device, QueueType::GRAPHICS, 0, (Queue*&)object);
+        case CaptureObject::FENCE:
+            return m_CoreInterface.CreateFence(m_Device, 0, (Fence*&)object);
+        case CaptureObject::STREAMER:
+            if (!m_StreamerInterface.CreateStreamer)
+                return Result::UNSUPPORTED;
+
+            return m_StreamerInterface.CreateStreamer(m_Device, objectDesc.streamer, (Streamer*&)object);
+        default:
+            return Result::INVALID_ARGUMENT;
+    }
+}
+
+Result CaptureImpl::Create(const char* path) {
+    Result result = nriGetInterface(m_Device, NRI_INTERFACE(CoreInterface), &m_CoreInterface);
+    if (result != Result::SUCCESS)
+        return result;
+
+    // Optional, needed only if streamer calls are captured
+    if (nriGetInterface(m_Device, NRI_INTERFACE(StreamerInterface), &m_StreamerInterface) != Result::SUCCESS)
+        m_StreamerInterface = {};
+
+    // Optional, resources are not bound to memory without it
+    if (nriGetInterface(m_Device, NRI_INTERFACE(ResourceAllocatorInterface), &m_ResourceAllocatorInterface) != Result::SUCCESS)
+        m_ResourceAllocatorInterface = {};
+
+    FILE* file = fopen(path, "rb");
+    RETURN_ON_FAILURE((DeviceBase*)&m_Device, file, Result::FAILURE, "Can't open '%s'", path);
+
+    fseek(file, 0, SEEK_END);
+    uint64_t fileSize = (uint64_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    CaptureHeader header = {};
+    bool isOk = fread(&header, sizeof(header), 1, file) == 1;
+    isOk = isOk && header.magic == CAPTURE_MAGIC && header.version == CAPTURE_VERSION;
+    isOk = isOk && header.nriVersionMajor == NRI_VERSION_MAJOR && header.nriVersionMinor == NRI_VERSION_MINOR && header.pointerSize == sizeof(void*);
+
+    // Before allocating
+    uint64_t tableSize = uint64_t(header.objectNum) * (sizeof(CaptureObject) + sizeof(CaptureObjectDesc));
+    isOk = isOk && tableSize <= fileSize - sizeof(header) && header.dataSize <= fileSize - sizeof(header) - tableSize;
+
+    if (isOk) {
+        m_ObjectTypes.resize(header.objectNum);
+        m_ObjectDescs.resize(header.objectNum);
+        isOk = !header.objectNum || fread(m_ObjectTypes.data(), header.objectNum, 1, file) == 1;
+        isOk = isOk && (!header.objectNum || fread(m_ObjectDescs.data(), header.objectNum * sizeof(CaptureObjectDesc), 1, file) == 1);
+    }
+
+    if (isOk) {
+        m_Data.resize((header.dataSize + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        m_DataSize = header.dataSize;
+        isOk = !header.dataSize || fread(m_Data.data(), header.dataSize, 1, file) == 1;
+    }
+
+    fclose(file);
+
+    RETURN_ON_FAILURE((DeviceBase*)&m_Device, isOk, Result::FAILURE, "'%s' is not a capture of this NRI version or is truncated", path);
+
+    // Objects
+    m_Objects.resize(header.objectNum + 1, nullptr);
+
+    for (uint32_t i = 0; i < header.objectNum; i++) {
+        RETURN_ON_FAILURE((DeviceBase*)&m_Device, m_ObjectTypes[i] < CaptureObject::MAX_NUM, Result::FAILURE, "'%s' is corrupted", path);
+
+        // Descs are valid for the recording device, but not necessarily for the replay device
+        if (CreateObject(i + 1) != Result::SUCCESS) {
+            REPORT_WARNING((DeviceBase*)&m_Device, "Can't restore an object (type %u), calls using it are skipped", (uint32_t)m_ObjectTypes[i]);
+            m_Objects[i + 1] = nullptr;
+        }
+    }
+
+    // Records are checked once here, "Replay" doesn't forward anything past the first bad record either
+    uint64_t callNum = 0;
+    RETURN_ON_FAILURE((DeviceBase*)&m_Device, Decode(true, callNum, m_SkippedCallNum), Result::FAILURE, "'%s' is corrupted", path);
+
+    return Result::SUCCESS;
+}
+
+uint64_t CaptureImpl::Replay() {
+    uint64_t callNum = 0;
+    uint64_t skippedCallNum = 0;
+    Decode(false, callNum, skippedCallNum);
+
+    return callNum - skippedCallNum;
+}
+
+bool CaptureImpl::Decode(bool isDryRun, uint64_t& callNum, uint64_t& skippedCallNum) {
+    const CoreInterface& core = m_CoreInterface;
+    const StreamerInterface& streamer = m_StreamerInterface;
+
+    CaptureReader reader = {};
+    reader.begin = (const uint8_t*)m_Data.data();
+    reader.cur = reader.begin;
+    reader.end = reader.begin + m_DataSize;
+    reader.objects = m_Objects.data();
+    reader.objectTypes = m_ObjectTypes.data();
+    reader.objectNum = m_ObjectTypes.size();
+    reader.isValid = true;
+    reader.isDryRun = isDryRun;
+
+    callNum = 0;
+    skippedCallNum = 0;
+
+#define OBJECT(type) (*reader.ReadObject<type>(false))
+#define OBJECT_PTR(type) (reader.ReadObject<type>(true))
+#define PATCH(type, pointer) pointer = reader.GetObject<type>(size_t(pointer), true)
+
+    while (reader.cur < reader.end) {
+        const uint8_t* record = reader.cur;
+        CaptureCall call = reader.Read<CaptureCall>();
+        reader.isSkipped = false;
+
+        switch (call) {
+            case CaptureCall::BEGIN_COMMAND_BUFFER: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                const DescriptorPool* descriptorPool = OBJECT_PTR(DescriptorPool);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.BeginCommandBuffer(commandBuffer, descriptorPool);
+            } break;
+            case CaptureCall::CMD_SET_DESCRIPTOR_POOL: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                const DescriptorPool& descriptorPool = OBJECT(DescriptorPool);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetDescriptorPool(commandBuffer, descriptorPool);
+            } break;
+            case CaptureCall::CMD_SET_PIPELINE_LAYOUT: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                const PipelineLayout& pipelineLayout = OBJECT(PipelineLayout);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetPipelineLayout(commandBuffer, pipelineLayout);
+            } break;
+            case CaptureCall::CMD_SET_PIPELINE: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                const Pipeline& pipeline = OBJECT(Pipeline);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetPipeline(commandBuffer, pipeline);
+            } break;
+            case CaptureCall::CMD_SET_DESCRIPTOR_SET: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                uint32_t setIndex = reader.Read<uint32_t>();
+                const DescriptorSet& descriptorSet = OBJECT(DescriptorSet);
+                uint32_t offsetNum = reader.Read<uint32_t>();
+                const uint32_t* offsets = reader.ReadArray<uint32_t>(offsetNum);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetDescriptorSet(commandBuffer, setIndex, descriptorSet, offsetNum ? offsets : nullptr);
+            } break;
+            case CaptureCall::CMD_SET_ROOT_CONSTANTS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                uint32_t rootConstantIndex = reader.Read<uint32_t>();
+                uint32_t size = reader.Read<uint32_t>();
+                const uint8_t* data = reader.ReadArray<uint8_t>(size);
+                reader.isSkipped = true; // needs a pipeline layout
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetRootConstants(commandBuffer, rootConstantIndex, data, size);
+            } break;
+            case CaptureCall::CMD_SET_ROOT_DESCRIPTOR: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                uint32_t rootDescriptorIndex = reader.Read<uint32_t>();
+                Descriptor& descriptor = OBJECT(Descriptor);
+                reader.isSkipped = true; // needs a pipeline layout
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetRootDescriptor(commandBuffer, rootDescriptorIndex, descriptor);
+            } break;
+            case CaptureCall::CMD_BARRIER: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+
+                BarrierGroupDesc barrierGroupDesc = {};
+                barrierGroupDesc.globalNum = reader.Read<uint32_t>();
+                barrierGroupDesc.bufferNum = reader.Read<uint32_t>();
+                barrierGroupDesc.textureNum = reader.Read<uint32_t>();
+                barrierGroupDesc.globals = reader.ReadArray<GlobalBarrierDesc>(barrierGroupDesc.globalNum);
+
+                const BufferBarrierDesc* buffers = reader.ReadArray<BufferBarrierDesc>(barrierGroupDesc.bufferNum);
+                m_BufferBarriers.assign(buffers, buffers + barrierGroupDesc.bufferNum);
+                for (BufferBarrierDesc& bufferBarrierDesc : m_BufferBarriers)
+                    PATCH(Buffer, bufferBarrierDesc.buffer);
+                barrierGroupDesc.buffers = m_BufferBarriers.data();
+
+                const TextureBarrierDesc* textures = reader.ReadArray<TextureBarrierDesc>(barrierGroupDesc.textureNum);
+                m_TextureBarriers.assign(textures, textures + barrierGroupDesc.textureNum);
+                for (TextureBarrierDesc& textureBarrierDesc : m_TextureBarriers)
+                    PATCH(Texture, textureBarrierDesc.texture);
+                barrierGroupDesc.textures = m_TextureBarriers.data();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdBarrier(commandBuffer, barrierGroupDesc);
+            } break;
+            case CaptureCall::CMD_SET_INDEX_BUFFER: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                const Buffer& buffer = OBJECT(Buffer);
+                uint64_t offset = reader.Read<uint64_t>();
+                IndexType indexType = reader.Read<IndexType>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetIndexBuffer(commandBuffer, buffer, offset, indexType);
+            } break;
+            case CaptureCall::CMD_SET_VERTEX_BUFFERS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                uint32_t baseSlot = reader.Read<uint32_t>();
+                uint32_t bufferNum = reader.Read<uint32_t>();
+                uint32_t hasOffsets = reader.Read<uint32_t>();
+
+                const uint32_t* ids = reader.ReadArray<uint32_t>(bufferNum);
+                m_Buffers.resize(bufferNum);
+                for (uint32_t i = 0; i < bufferNum; i++)
+                    m_Buffers[i] = reader.GetObject<Buffer>(ids[i], true);
+
+                const uint64_t* offsets = hasOffsets ? reader.ReadArray<uint64_t>(bufferNum) : nullptr;
+                reader.isSkipped = true; // needs a pipeline
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetVertexBuffers(commandBuffer, baseSlot, bufferNum, m_Buffers.data(), offsets);
+            } break;
+            case CaptureCall::CMD_SET_VIEWPORTS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                uint32_t viewportNum = reader.Read<uint32_t>();
+                const Viewport* viewports = reader.ReadArray<Viewport>(viewportNum);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetViewports(commandBuffer, viewports, viewportNum);
+            } break;
+            case CaptureCall::CMD_SET_SCISSORS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                uint32_t rectNum = reader.Read<uint32_t>();
+                const Rect* rects = reader.ReadArray<Rect>(rectNum);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetScissors(commandBuffer, rects, rectNum);
+            } break;
+            case CaptureCall::CMD_SET_STENCIL_REFERENCE: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                uint8_t frontRef = reader.Read<uint8_t>();
+                uint8_t backRef = reader.Read<uint8_t>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetStencilReference(commandBuffer, frontRef, backRef);
+            } break;
+            case CaptureCall::CMD_SET_DEPTH_BOUNDS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                float boundsMin = reader.Read<float>();
+                float boundsMax = reader.Read<float>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetDepthBounds(commandBuffer, boundsMin, boundsMax);
+            } break;
+            case CaptureCall::CMD_SET_BLEND_CONSTANTS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                Color32f color = reader.Read<Color32f>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetBlendConstants(commandBuffer, color);
+            } break;
+            case CaptureCall::CMD_SET_SAMPLE_LOCATIONS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                Sample_t locationNum = reader.Read<Sample_t>();
+                Sample_t sampleNum = reader.Read<Sample_t>();
+                const SampleLocation* locations = reader.ReadArray<SampleLocation>(locationNum);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetSampleLocations(commandBuffer, locations, locationNum, sampleNum);
+            } break;
+            case CaptureCall::CMD_SET_SHADING_RATE: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                ShadingRateDesc shadingRateDesc = reader.Read<ShadingRateDesc>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetShadingRate(commandBuffer, shadingRateDesc);
+            } break;
+            case CaptureCall::CMD_SET_DEPTH_BIAS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                DepthBiasDesc depthBiasDesc = reader.Read<DepthBiasDesc>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdSetDepthBias(commandBuffer, depthBiasDesc);
+            } break;
+            case CaptureCall::CMD_BEGIN_RENDERING: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                AttachmentsDesc attachmentsDesc = reader.Read<AttachmentsDesc>();
+                PATCH(const Descriptor, attachmentsDesc.depthStencil);
+                PATCH(const Descriptor, attachmentsDesc.shadingRate);
+
+                const uint32_t* ids = reader.ReadArray<uint32_t>(attachmentsDesc.colorNum);
+                m_Descriptors.resize(attachmentsDesc.colorNum);
+                for (uint32_t i = 0; i < attachmentsDesc.colorNum; i++)
+                    m_Descriptors[i] = reader.GetObject<Descriptor>(ids[i], true);
+                attachmentsDesc.colors = m_Descriptors.data();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdBeginRendering(commandBuffer, attachmentsDesc);
+            } break;
+            case CaptureCall::CMD_CLEAR_ATTACHMENTS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                uint32_t clearDescNum = reader.Read<uint32_t>();
+                uint32_t rectNum = reader.Read<uint32_t>();
+                const ClearDesc* clearDescs = reader.ReadArray<ClearDesc>(clearDescNum);
+                const Rect* rects = reader.ReadArray<Rect>(rectNum);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdClearAttachments(commandBuffer, clearDescs, clearDescNum, rectNum ? rects : nullptr, rectNum);
+            } break;
+            case CaptureCall::CMD_DRAW: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                DrawDesc drawDesc = reader.Read<DrawDesc>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdDraw(commandBuffer, drawDesc);
+            } break;
+            case CaptureCall::CMD_DRAW_INDEXED: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                DrawIndexedDesc drawIndexedDesc = reader.Read<DrawIndexedDesc>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdDrawIndexed(commandBuffer, drawIndexedDesc);
+            } break;
+            case CaptureCall::CMD_DRAW_INDIRECT:
+            case CaptureCall::CMD_DRAW_INDEXED_INDIRECT: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                const Buffer& buffer = OBJECT(Buffer);
+                uint64_t offset = reader.Read<uint64_t>();
+                uint32_t drawNum = reader.Read<uint32_t>();
+                uint32_t stride = reader.Read<uint32_t>();
+                const Buffer* countBuffer = OBJECT_PTR(Buffer);
+                uint64_t countBufferOffset = reader.Read<uint64_t>();
+
+                if (!reader.CanCall())
+                    break;
+
+                if (call == CaptureCall::CMD_DRAW_INDIRECT)
+                    core.CmdDrawIndirect(commandBuffer, buffer, offset, drawNum, stride, countBuffer, countBufferOffset);
+                else
+                    core.CmdDrawIndexedIndirect(commandBuffer, buffer, offset, drawNum, stride, countBuffer, countBufferOffset);
+            } break;
+            case CaptureCall::CMD_END_RENDERING: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdEndRendering(commandBuffer);
+            } break;
+            case CaptureCall::CMD_DISPATCH: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                DispatchDesc dispatchDesc = reader.Read<DispatchDesc>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdDispatch(commandBuffer, dispatchDesc);
+            } break;
+            case CaptureCall::CMD_DISPATCH_INDIRECT: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                const Buffer& buffer = OBJECT(Buffer);
+                uint64_t offset = reader.Read<uint64_t>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdDispatchIndirect(commandBuffer, buffer, offset);
+            } break;
+            case CaptureCall::CMD_COPY_BUFFER: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                Buffer& dstBuffer = OBJECT(Buffer);
+                uint64_t dstOffset = reader.Read<uint64_t>();
+                const Buffer& srcBuffer = OBJECT(Buffer);
+                uint64_t srcOffset = reader.Read<uint64_t>();
+                uint64_t size = reader.Read<uint64_t>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdCopyBuffer(commandBuffer, dstBuffer, dstOffset, srcBuffer, srcOffset, size);
+            } break;
+            case CaptureCall::CMD_COPY_TEXTURE:
+            case CaptureCall::CMD_RESOLVE_TEXTURE: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                Texture& dstTexture = OBJECT(Texture);
+                const Texture& srcTexture = OBJECT(Texture);
+                uint32_t hasDstRegion = reader.Read<uint32_t>();
+                TextureRegionDesc dstRegionDesc = reader.Read<TextureRegionDesc>();
+                uint32_t hasSrcRegion = reader.Read<uint32_t>();
+                TextureRegionDesc srcRegionDesc = reader.Read<TextureRegionDesc>();
+
+                if (!reader.CanCall())
+                    break;
+
+                if (call == CaptureCall::CMD_COPY_TEXTURE)
+                    core.CmdCopyTexture(commandBuffer, dstTexture, hasDstRegion ? &dstRegionDesc : nullptr, srcTexture, hasSrcRegion ? &srcRegionDesc : nullptr);
+                else
+                    core.CmdResolveTexture(commandBuffer, dstTexture, hasDstRegion ? &dstRegionDesc : nullptr, srcTexture, hasSrcRegion ? &srcRegionDesc : nullptr);
+            } break;
+            case CaptureCall::CMD_UPLOAD_BUFFER_TO_TEXTURE: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                Texture& dstTexture = OBJECT(Texture);
+                TextureRegionDesc dstRegionDesc = reader.Read<TextureRegionDesc>();
+                const Buffer& srcBuffer = OBJECT(Buffer);
+                TextureDataLayoutDesc srcDataLayoutDesc = reader.Read<TextureDataLayoutDesc>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdUploadBufferToTexture(commandBuffer, dstTexture, dstRegionDesc, srcBuffer, srcDataLayoutDesc);
+            } break;
+            case CaptureCall::CMD_READBACK_TEXTURE_TO_BUFFER: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                Buffer& dstBuffer = OBJECT(Buffer);
+                TextureDataLayoutDesc dstDataLayoutDesc = reader.Read<TextureDataLayoutDesc>();
+                const Texture& srcTexture = OBJECT(Texture);
+                TextureRegionDesc srcRegionDesc = reader.Read<TextureRegionDesc>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdReadbackTextureToBuffer(commandBuffer, dstBuffer, dstDataLayoutDesc, srcTexture, srcRegionDesc);
+            } break;
+            case CaptureCall::CMD_CLEAR_STORAGE_BUFFER: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                ClearStorageBufferDesc clearDesc = reader.Read<ClearStorageBufferDesc>();
+                PATCH(const Descriptor, clearDesc.storageBuffer);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdClearStorageBuffer(commandBuffer, clearDesc);
+            } break;
+            case CaptureCall::CMD_CLEAR_STORAGE_TEXTURE: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                ClearStorageTextureDesc clearDesc = reader.Read<ClearStorageTextureDesc>();
+                PATCH(const Descriptor, clearDesc.storageTexture);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdClearStorageTexture(commandBuffer, clearDesc);
+            } break;
+            case CaptureCall::CMD_RESET_QUERIES: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                QueryPool& queryPool = OBJECT(QueryPool);
+                uint32_t offset = reader.Read<uint32_t>();
+                uint32_t num = reader.Read<uint32_t>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdResetQueries(commandBuffer, queryPool, offset, num);
+            } break;
+            case CaptureCall::CMD_BEGIN_QUERY:
+            case CaptureCall::CMD_END_QUERY: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                QueryPool& queryPool = OBJECT(QueryPool);
+                uint32_t offset = reader.Read<uint32_t>();
+
+                if (!reader.CanCall())
+                    break;
+
+                if (call == CaptureCall::CMD_BEGIN_QUERY)
+                    core.CmdBeginQuery(commandBuffer, queryPool, offset);
+                else
+                    core.CmdEndQuery(commandBuffer, queryPool, offset);
+            } break;
+            case CaptureCall::CMD_COPY_QUERIES: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                const QueryPool& queryPool = OBJECT(QueryPool);
+                uint32_t offset = reader.Read<uint32_t>();
+                uint32_t num = reader.Read<uint32_t>();
+                Buffer& dstBuffer = OBJECT(Buffer);
+                uint64_t dstOffset = reader.Read<uint64_t>();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdCopyQueries(commandBuffer, queryPool, offset, num, dstBuffer, dstOffset);
+            } break;
+            case CaptureCall::CMD_BEGIN_ANNOTATION:
+            case CaptureCall::CMD_ANNOTATION: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                uint32_t bgra = reader.Read<uint32_t>();
+                const char* name = reader.ReadString();
+
+                if (!reader.CanCall())
+                    break;
+
+                if (call == CaptureCall::CMD_BEGIN_ANNOTATION)
+                    core.CmdBeginAnnotation(commandBuffer, name, bgra);
+                else
+                    core.CmdAnnotation(commandBuffer, name, bgra);
+            } break;
+            case CaptureCall::CMD_END_ANNOTATION: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.CmdEndAnnotation(commandBuffer);
+            } break;
+            case CaptureCall::END_COMMAND_BUFFER: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+
+                if (!reader.CanCall())
+                    break;
+
+                core.EndCommandBuffer(commandBuffer);
+            } break;
+            case CaptureCall::QUEUE_SUBMIT: {
+                Queue& queue = OBJECT(Queue);
+
+                QueueSubmitDesc queueSubmitDesc = {};
+                queueSubmitDesc.waitFenceNum = reader.Read<uint32_t>();
+                queueSubmitDesc.commandBufferNum = reader.Read<uint32_t>();
+                queueSubmitDesc.signalFenceNum = reader.Read<uint32_t>();
+
+                const FenceSubmitDesc* waitFences = reader.ReadArray<FenceSubmitDesc>(queueSubmitDesc.waitFenceNum);
+                m_WaitFences.assign(waitFences, waitFences + queueSubmitDesc.waitFenceNum);
+                for (FenceSubmitDesc& fenceSubmitDesc : m_WaitFences)
+                    PATCH(Fence, fenceSubmitDesc.fence);
+                queueSubmitDesc.waitFences = m_WaitFences.data();
+
+                const uint32_t* ids = reader.ReadArray<uint32_t>(queueSubmitDesc.commandBufferNum);
+                m_CommandBuffers.resize(queueSubmitDesc.commandBufferNum);
+                for (uint32_t i = 0; i < queueSubmitDesc.commandBufferNum; i++)
+                    m_CommandBuffers[i] = reader.GetObject<CommandBuffer>(ids[i], false);
+                queueSubmitDesc.commandBuffers = m_CommandBuffers.data();
+
+                const FenceSubmitDesc* signalFences = reader.ReadArray<FenceSubmitDesc>(queueSubmitDesc.signalFenceNum);
+                m_SignalFences.assign(signalFences, signalFences + queueSubmitDesc.signalFenceNum);
+                for (FenceSubmitDesc& fenceSubmitDesc : m_SignalFences)
+                    PATCH(Fence, fenceSubmitDesc.fence);
+                queueSubmitDesc.signalFences = m_SignalFences.data();
+
+                if (!reader.CanCall())
+                    break;
+
+                core.QueueSubmit(queue, queueSubmitDesc);
+            } break;
+            case CaptureCall::UPDATE_STREAMER_CONSTANT_BUFFER: {
+                Streamer& streamerObject = OBJECT(Streamer);
+                uint32_t dataSize = reader.Read<uint32_t>();
+                const uint8_t* data = reader.ReadArray<uint8_t>(dataSize);
+
+                if (!reader.CanCall())
+                    break;
+
+                streamer.UpdateStreamerConstantBuffer(streamerObject, data, dataSize);
+            } break;
+            case CaptureCall::ADD_STREAMER_BUFFER_UPDATE_REQUEST: {
+                Streamer& streamerObject = OBJECT(Streamer);
+                BufferUpdateRequestDesc bufferUpdateRequestDesc = reader.Read<BufferUpdateRequestDesc>();
+                PATCH(Buffer, bufferUpdateRequestDesc.dstBuffer);
+                bufferUpdateRequestDesc.data = reader.ReadArray<uint8_t>(bufferUpdateRequestDesc.dataSize);
+
+                if (!reader.CanCall())
+                    break;
+
+                streamer.AddStreamerBufferUpdateRequest(streamerObject, bufferUpdateRequestDesc);
+            } break;
+            case CaptureCall::ADD_STREAMER_TEXTURE_UPDATE_REQUEST: {
+                Streamer& streamerObject = OBJECT(Streamer);
+                TextureUpdateRequestDesc textureUpdateRequestDesc = reader.Read<TextureUpdateRequestDesc>();
+                PATCH(Texture, textureUpdateRequestDesc.dstTexture);
+                uint64_t dataSize = reader.Read<uint64_t>();
+                textureUpdateRequestDesc.data = reader.ReadArray<uint8_t>(dataSize);
+
+                if (!reader.CanCall())
+                    break;
+
+                streamer.AddStreamerTextureUpdateRequest(streamerObject, textureUpdateRequestDesc);
+            } break;
+            case CaptureCall::COPY_STREAMER_UPDATE_REQUESTS: {
+                Streamer& streamerObject = OBJECT(Streamer);
+
+                if (!reader.CanCall())
+                    break;
+
+                streamer.CopyStreamerUpdateRequests(streamerObject);
+            } break;
+            case CaptureCall::CMD_UPLOAD_STREAMER_UPDATE_REQUESTS: {
+                CommandBuffer& commandBuffer = OBJECT(CommandBuffer);
+                Streamer& streamerObject = OBJECT(Streamer);
+
+                if (!reader.CanCall())
+                    break;
+
+                streamer.CmdUploadStreamerUpdateRequests(commandBuffer, streamerObject);
+            } break;
+            default:
+                reader.Invalidate();
+                break;
+        }
+
+        if (!reader.isValid) {
+            REPORT_ERROR((DeviceBase*)&m_Device, "The capture is corrupted: call #%llu (type %u) at offset %llu",
+                (unsigned long long)callNum, (uint32_t)call, (unsigned long long)(record - reader.begin));
+            return false;
+        }
+
+        if (reader.isSkipped)
+            skippedCallNum++;
+
+        callNum++;
+    }
+
+#undef OBJECT
+#undef OBJECT_PTR
+#undef PATCH
+
+    return true;
+}
+
+#pragma endregion
+
+//============================================================================================================================================================================================
+#pragma region[  Capture  ]
+
+static Result NRI_CALL BeginCapture(Device& device) {
+    if (!g_CaptureLayer || &g_CaptureLayer->GetDevice() != &device)
+        return Result::UNSUPPORTED;
+
+    return g_CaptureLayer->Begin();
+}
+
+static Result NRI_CALL EndCapture(Device& device, const char* path) {
+    if (!g_CaptureLayer || &g_CaptureLayer->GetDevice() != &device)
+        return Result::UNSUPPORTED;
+
+    return g_CaptureLayer->End(path);
+}
+
+static Result NRI_CALL CreateCapture(Device& device, const char* path, Capture*& capture) {
+    capture = nullptr;
+
+    CaptureImpl* impl = Allocate<CaptureImpl>(((DeviceBase&)device).GetAllocationCallbacks(), device);
+    if (!impl)
+        return Result::OUT_OF_MEMORY;
+
+    Result result = impl->Create(path);
+    if (result != Result::SUCCESS) {
+        Destroy(impl);
+        return result;
+    }
+
+    capture = (Capture*)impl;
+
+    return Result::SUCCESS;
+}
+
+static uint64_t NRI_CALL ReplayCapture(Capture& capture) {
+    return ((CaptureImpl&)capture).Replay();
+}
+
+static uint64_t NRI_CALL GetCaptureSkippedCallNum(const Capture& capture) {
+    return ((const CaptureImpl&)capture).GetSkippedCallNum();
+}
+
+static void NRI_CALL DestroyCapture(Capture& capture) {
+    Destroy((CaptureImpl*)&capture);
+}
+
+#pragma endregion
+
+Result CreateCaptureLayer(Device& device) {
+    if (g_CaptureLayer) {
+        REPORT_WARNING((DeviceBase*)&device, "Only one device per process can have capture enabled");
+        return Result::UNSUPPORTED;
+    }
+
+    g_CaptureLayer = Allocate<CaptureLayer>(((DeviceBase&)device).GetAllocationCallbacks(), device);
+
+    return g_CaptureLayer ? Result::SUCCESS : Result::OUT_OF_MEMORY;
+}
+
+void DestroyCaptureLayer(Device& device) {
+    if (!g_CaptureLayer || &g_CaptureLayer->GetDevice() != &device)
+        return;
+
+    Destroy(((DeviceBase&)device).GetAllocationCallbacks(), g_CaptureLayer);
+    g_CaptureLayer = nullptr;
+}
+
+bool WrapFunctionTableCapture(const Device& device, CoreInterface& table) {
+    if (!g_CaptureLayer || &g_CaptureLayer->GetDevice() != &device)
+        return false;
+
+    g_CaptureLayer->WrapFunctionTable(table);
+
+    return true;
+}
+
+bool WrapFunctionTableCapture(const Device& device, StreamerInterface& table) {
+    if (!g_CaptureLayer || &g_CaptureLayer->GetDevice() != &device)
+        return false;
+
+    g_CaptureLayer->WrapFunctionTable(table);
+
+    return true;
+}
+
+Result FillFunctionTableCapture(const Device&, CaptureInterface& table) {
+    table.BeginCapture = ::BeginCapture;
+    table.EndCapture = ::EndCapture;
+    table.CreateCapture = ::CreateCapture;
+    table.ReplayCapture = ::ReplayCapture;
+    table.GetCaptureSkippedCallNum = ::GetCaptureSkippedCallNum;
+    table.DestroyCapture = ::DestroyCapture;
+
+    return Result::SUCCESS;
+}
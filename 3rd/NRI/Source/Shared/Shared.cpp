@@ -7,17 +7,21 @@
 
 #include "SharedExternal.h"
 
+#include "Capture.h"
 #include "HelperDataUpload.h"
 #include "HelperDeviceMemoryAllocator.h"
 #include "HelperWaitIdle.h"
+#include "Stats.h"
 #include "Streamer.h"
 #include "Upscaler.h"
 
 using namespace nri;
 
+#include "Capture.hpp"
 #include "HelperDataUpload.hpp"
 #include "HelperDeviceMemoryAllocator.hpp"
 #include "HelperWaitIdle.hpp"
+#include "Stats.hpp"
 #include "Streamer.hpp"
 #include "Upscaler.hpp"
 
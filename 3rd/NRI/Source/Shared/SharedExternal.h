@@ -17,12 +17,14 @@ typedef uint32_t DXGI_FORMAT;
 // IMPORTANT: "SharedExternal.h" must be included after inclusion of "windows.h" (can be implicit) because ERROR gets undef-ed below
 #include "NRI.h"
 
+#include "Extensions/NRICapture.h"
 #include "Extensions/NRIDeviceCreation.h"
 #include "Extensions/NRIHelper.h"
 #include "Extensions/NRILowLatency.h"
 #include "Extensions/NRIMeshShader.h"
 #include "Extensions/NRIRayTracing.h"
 #include "Extensions/NRIResourceAllocator.h"
+#include "Extensions/NRIStats.h"
 #include "Extensions/NRIStreamer.h"
 #include "Extensions/NRISwapChain.h"
 #include "Extensions/NRIUpscaler.h"
@@ -0,0 +1,108 @@
+// © 2025 NVIDIA Corporation
+
+#pragma once
+
+namespace nri {
+
+/*
+The stats layer doesn't wrap objects (unlike validation), it patches function tables returned by "nriGetInterface":
+- a patched function counts and forwards the call to the original table of the device (validation or implementation)
+- counters of a command buffer are written only by the recording thread without atomics
+- "EndCommandBuffer" folds them into the frame totals (a few atomics per command buffer)
+- function pointers don't carry a context, so there is only one stats device per process
+*/
+
+enum StatsCounter : uint32_t {
+    STATS_DRAW_NUM,
+    STATS_DISPATCH_NUM,
+    STATS_INSTANCE_NUM,
+    STATS_TRIANGLE_NUM,
+    STATS_BARRIER_NUM,
+    STATS_DESCRIPTOR_SET_NUM,
+    STATS_ROOT_CONSTANT_SIZE,
+    STATS_PIPELINE_NUM,
+    STATS_COMMAND_BUFFER_NUM,
+    STATS_SUBMIT_NUM,
+    STATS_STREAMER_SIZE,
+
+    STATS_COUNTER_NUM
+};
+
+static_assert(sizeof(CommandBufferStats) == STATS_COMMAND_BUFFER_NUM * sizeof(uint64_t), "Keep in sync with 'CommandBufferStats'");
+static_assert(sizeof(FrameStats) == STATS_COUNTER_NUM * sizeof(uint64_t), "Keep in sync with 'FrameStats'");
+
+constexpr uint32_t STATS_PIPELINE_CACHE_SIZE = 8; // per command buffer, direct mapped
+
+struct StatsPipelineCacheEntry {
+    const Pipeline* pipeline;
+    Topology topology;
+};
+
+struct CommandBufferStatsRecord {
+    CommandBufferStats stats;
+    const Pipeline* pipeline;
+    Topology topology;
+    std::array<StatsPipelineCacheEntry, STATS_PIPELINE_CACHE_SIZE> pipelineCache; // reset by "BeginCommandBuffer", pipelines in use can't be destroyed
+};
+
+struct StatsLayer {
+    inline StatsLayer(Device& device, uint32_t generation)
+        : m_Device(device)
+        , m_Generation(generation)
+        , m_CommandBuffers(((DeviceBase&)device).GetStdAllocator())
+        , m_Pipelines(((DeviceBase&)device).GetStdAllocator()) {
+        for (std::atomic_uint64_t& counter : m_Counters)
+            counter.store(0, std::memory_order_relaxed);
+    }
+
+    inline Device& GetDevice() {
+        return m_Device;
+    }
+
+    inline uint32_t GetGeneration() const {
+        return m_Generation;
+    }
+
+    inline const CoreInterface& GetCoreInterface() const {
+        return m_CoreInterface;
+    }
+
+    inline const StreamerInterface& GetStreamerInterface() const {
+        return m_StreamerInterface;
+    }
+
+    inline void Add(StatsCounter counter, uint64_t value) {
+        m_Counters[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void WrapFunctionTable(CoreInterface& table);
+    void WrapFunctionTable(StreamerInterface& table);
+    void FillFunctionTable(StatsInterface& table) const;
+
+    CommandBufferStatsRecord& GetCommandBufferRecord(const CommandBuffer& commandBuffer);
+    void EraseCommandBufferRecord(const CommandBuffer& commandBuffer);
+    void GetCommandBufferStats(const CommandBuffer& commandBuffer, CommandBufferStats& commandBufferStats);
+    void FoldCommandBufferStats(const CommandBufferStats& commandBufferStats);
+
+    void AddPipeline(const Pipeline& pipeline, Topology topology);
+    void ErasePipeline(const Pipeline& pipeline);
+    Topology GetPipelineTopology(const Pipeline& pipeline);
+
+    void GetFrameStats(FrameStats& frameStats);
+    void EndFrame();
+
+private:
+    Device& m_Device;
+    uint32_t m_Generation; // unique per process, a recreated layer must not match thread-local record caches of the previous one
+    CoreInterface m_CoreInterface = {}; // originals
+    StreamerInterface m_StreamerInterface = {};
+    UnorderedMap<const CommandBuffer*, CommandBufferStatsRecord> m_CommandBuffers; // references are stable
+    UnorderedMap<const Pipeline*, Topology> m_Pipelines;
+    std::array<std::atomic_uint64_t, STATS_COUNTER_NUM> m_Counters;
+    FrameStats m_LastFrame = {};
+    std::atomic_uint32_t m_Epoch = 0; // invalidates thread-local record caches on erase
+    Lock m_Lock;
+    Lock m_LastFrameLock;
+};
+
+} // namespace nri
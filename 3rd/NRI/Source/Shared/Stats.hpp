@@ -0,0 +1,350 @@
+// © 2025 NVIDIA Corporation
+
+struct StatsRecordCache {
+    const CommandBuffer* commandBuffer;
+    CommandBufferStatsRecord* record;
+    uint32_t generation;
+    uint32_t epoch;
+};
+
+static StatsLayer* g_StatsLayer = nullptr;
+static std::atomic_uint32_t g_StatsLayerGeneration = 0;
+static thread_local StatsRecordCache t_StatsRecordCache = {};
+
+static inline uint64_t GetTriangleNum(Topology topology, uint64_t vertexNum) {
+    if (topology == Topology::TRIANGLE_LIST)
+        return vertexNum / 3;
+    if (topology == Topology::TRIANGLE_STRIP)
+        return vertexNum > 2 ? vertexNum - 2 : 0;
+
+    return 0;
+}
+
+//============================================================================================================================================================================================
+#pragma region[  Core  ]
+
+static Result NRI_CALL CreateGraphicsPipelineStats(Device& device, const GraphicsPipelineDesc& graphicsPipelineDesc, Pipeline*& pipeline) {
+    Result result = g_StatsLayer->GetCoreInterface().CreateGraphicsPipeline(device, graphicsPipelineDesc, pipeline);
+    if (result == Result::SUCCESS)
+        g_StatsLayer->AddPipeline(*pipeline, graphicsPipelineDesc.inputAssembly.topology);
+
+    return result;
+}
+
+static void NRI_CALL DestroyCommandBufferStats(CommandBuffer& commandBuffer) {
+    g_StatsLayer->EraseCommandBufferRecord(commandBuffer);
+    g_StatsLayer->GetCoreInterface().DestroyCommandBuffer(commandBuffer);
+}
+
+static void NRI_CALL DestroyPipelineStats(Pipeline& pipeline) {
+    g_StatsLayer->ErasePipeline(pipeline);
+    g_StatsLayer->GetCoreInterface().DestroyPipeline(pipeline);
+}
+
+static Result NRI_CALL BeginCommandBufferStats(CommandBuffer& commandBuffer, const DescriptorPool* descriptorPool) {
+    CommandBufferStatsRecord& record = g_StatsLayer->GetCommandBufferRecord(commandBuffer);
+    record = {};
+
+    return g_StatsLayer->GetCoreInterface().BeginCommandBuffer(commandBuffer, descriptorPool);
+}
+
+static void NRI_CALL CmdSetPipelineStats(CommandBuffer& commandBuffer, const Pipeline& pipeline) {
+    CommandBufferStatsRecord& record = g_StatsLayer->GetCommandBufferRecord(commandBuffer);
+    if (record.pipeline != &pipeline) {
+        record.stats.pipelineNum++;
+        record.pipeline = &pipeline;
+
+        // The topology lookup locks, the cache makes it once per pipeline per recording (unless evicted)
+        StatsPipelineCacheEntry& entry = record.pipelineCache[((size_t)&pipeline >> 4) % STATS_PIPELINE_CACHE_SIZE];
+        if (entry.pipeline != &pipeline)
+            entry = {&pipeline, g_StatsLayer->GetPipelineTopology(pipeline)};
+
+        record.topology = entry.topology;
+    }
+
+    g_StatsLayer->GetCoreInterface().CmdSetPipeline(commandBuffer, pipeline);
+}
+
+static void NRI_CALL CmdSetDescriptorSetStats(CommandBuffer& commandBuffer, uint32_t setIndex, const DescriptorSet& descriptorSet, const uint32_t* dynamicConstantBufferOffsets) {
+    g_StatsLayer->GetCommandBufferRecord(commandBuffer).stats.descriptorSetNum++;
+    g_StatsLayer->GetCoreInterface().CmdSetDescriptorSet(commandBuffer, setIndex, descriptorSet, dynamicConstantBufferOffsets);
+}
+
+static void NRI_CALL CmdSetRootConstantsStats(CommandBuffer& commandBuffer, uint32_t rootConstantIndex, const void* data, uint32_t size) {
+    g_StatsLayer->GetCommandBufferRecord(commandBuffer).stats.rootConstantSize += size;
+    g_StatsLayer->GetCoreInterface().CmdSetRootConstants(commandBuffer, rootConstantIndex, data, size);
+}
+
+static void NRI_CALL CmdBarrierStats(CommandBuffer& commandBuffer, const BarrierGroupDesc& barrierGroupDesc) {
+    g_StatsLayer->GetCommandBufferRecord(commandBuffer).stats.barrierNum += barrierGroupDesc.globalNum + barrierGroupDesc.bufferNum + barrierGroupDesc.textureNum;
+    g_StatsLayer->GetCoreInterface().CmdBarrier(commandBuffer, barrierGroupDesc);
+}
+
+static void NRI_CALL CmdDrawStats(CommandBuffer& commandBuffer, const DrawDesc& drawDesc) {
+    CommandBufferStatsRecord& record = g_StatsLayer->GetCommandBufferRecord(commandBuffer);
+    record.stats.drawNum++;
+    record.stats.instanceNum += drawDesc.instanceNum;
+    record.stats.triangleNum += GetTriangleNum(record.topology, drawDesc.vertexNum) * drawDesc.instanceNum;
+
+    g_StatsLayer->GetCoreInterface().CmdDraw(commandBuffer, drawDesc);
+}
+
+static void NRI_CALL CmdDrawIndexedStats(CommandBuffer& commandBuffer, const DrawIndexedDesc& drawIndexedDesc) {
+    CommandBufferStatsRecord& record = g_StatsLayer->GetCommandBufferRecord(commandBuffer);
+    record.stats.drawNum++;
+    record.stats.instanceNum += drawIndexedDesc.instanceNum;
+    record.stats.triangleNum += GetTriangleNum(record.topology, drawIndexedDesc.indexNum) * drawIndexedDesc.instanceNum;
+
+    g_StatsLayer->GetCoreInterface().CmdDrawIndexed(commandBuffer, drawIndexedDesc);
+}
+
+static void NRI_CALL CmdDrawIndirectStats(CommandBuffer& commandBuffer, const Buffer& buffer, uint64_t offset, uint32_t drawNum, uint32_t stride, const Buffer* countBuffer, uint64_t countBufferOffset) {
+    g_StatsLayer->GetCommandBufferRecord(commandBuffer).stats.drawNum += drawNum;
+    g_StatsLayer->GetCoreInterface().CmdDrawIndirect(commandBuffer, buffer, offset, drawNum, stride, countBuffer, countBufferOffset);
+}
+
+static void NRI_CALL CmdDrawIndexedIndirectStats(CommandBuffer& commandBuffer, const Buffer& buffer, uint64_t offset, uint32_t drawNum, uint32_t stride, const Buffer* countBuffer, uint64_t countBufferOffset) {
+    g_StatsLayer->GetCommandBufferRecord(commandBuffer).stats.drawNum += drawNum;
+    g_StatsLayer->GetCoreInterface().CmdDrawIndexedIndirect(commandBuffer, buffer, offset, drawNum, stride, countBuffer, countBufferOffset);
+}
+
+static void NRI_CALL CmdDispatchStats(CommandBuffer& commandBuffer, const DispatchDesc& dispatchDesc) {
+    g_StatsLayer->GetCommandBufferRecord(commandBuffer).stats.dispatchNum++;
+    g_StatsLayer->GetCoreInterface().CmdDispatch(commandBuffer, dispatchDesc);
+}
+
+static void NRI_CALL CmdDispatchIndirectStats(CommandBuffer& commandBuffer, const Buffer& buffer, uint64_t offset) {
+    g_StatsLayer->GetCommandBufferRecord(commandBuffer).stats.dispatchNum++;
+    g_StatsLayer->GetCoreInterface().CmdDispatchIndirect(commandBuffer, buffer, offset);
+}
+
+static Result NRI_CALL EndCommandBufferStats(CommandBuffer& commandBuffer) {
+    g_StatsLayer->FoldCommandBufferStats(g_StatsLayer->GetCommandBufferRecord(commandBuffer).stats);
+
+    return g_StatsLayer->GetCoreInterface().EndCommandBuffer(commandBuffer);
+}
+
+static void NRI_CALL QueueSubmitStats(Queue& queue, const QueueSubmitDesc& queueSubmitDesc) {
+    g_StatsLayer->Add(STATS_SUBMIT_NUM, 1);
+    g_StatsLayer->GetCoreInterface().QueueSubmit(queue, queueSubmitDesc);
+}
+
+#pragma endregion
+
+//============================================================================================================================================================================================
+#pragma region[  Streamer  ]
+
+static uint32_t NRI_CALL UpdateStreamerConstantBufferStats(Streamer& streamer, const void* data, uint32_t dataSize) {
+    g_StatsLayer->Add(STATS_STREAMER_SIZE, dataSize);
+
+    return g_StatsLayer->GetStreamerInterface().UpdateStreamerConstantBuffer(streamer, data, dataSize);
+}
+
+static uint64_t NRI_CALL AddStreamerBufferUpdateRequestStats(Streamer& streamer, const BufferUpdateRequestDesc& bufferUpdateRequestDesc) {
+    g_StatsLayer->Add(STATS_STREAMER_SIZE, bufferUpdateRequestDesc.dataSize);
+
+    return g_StatsLayer->GetStreamerInterface().AddStreamerBufferUpdateRequest(streamer, bufferUpdateRequestDesc);
+}
+
+static uint64_t NRI_CALL AddStreamerTextureUpdateRequestStats(Streamer& streamer, const TextureUpdateRequestDesc& textureUpdateRequestDesc) {
+    const TextureRegionDesc& region = textureUpdateRequestDesc.dstRegionDesc;
+
+    uint64_t sliceNum = region.depth;
+    if (sliceNum == WHOLE_SIZE && textureUpdateRequestDesc.dstTexture) {
+        const TextureDesc& textureDesc = g_StatsLayer->GetCoreInterface().GetTextureDesc(*textureUpdateRequestDesc.dstTexture);
+        sliceNum = textureDesc.depth >> region.mipOffset;
+    }
+
+    g_StatsLayer->Add(STATS_STREAMER_SIZE, uint64_t(textureUpdateRequestDesc.dataSlicePitch) * (sliceNum ? sliceNum : 1));
+
+    return g_StatsLayer->GetStreamerInterface().AddStreamerTextureUpdateRequest(streamer, textureUpdateRequestDesc);
+}
+
+#pragma endregion
+
+//============================================================================================================================================================================================
+#pragma region[  Stats  ]
+
+static void NRI_CALL GetCommandBufferStats(const CommandBuffer& commandBuffer, CommandBufferStats& commandBufferStats) {
+    g_StatsLayer->GetCommandBufferStats(commandBuffer, commandBufferStats);
+}
+
+static void NRI_CALL GetFrameStats(const Device& device, FrameStats& frameStats) {
+    MaybeUnused(device);
+
+    g_StatsLayer->GetFrameStats(frameStats);
+}
+
+static void NRI_CALL EndStatsFrame(Device& device) {
+    MaybeUnused(device);
+
+    g_StatsLayer->EndFrame();
+}
+
+#pragma endregion
+
+//============================================================================================================================================================================================
+#pragma region[  StatsLayer  ]
+
+void StatsLayer::WrapFunctionTable(CoreInterface& table) {
+    m_CoreInterface = table;
+
+    table.CreateGraphicsPipeline = ::CreateGraphicsPipelineStats;
+    table.DestroyCommandBuffer = ::DestroyCommandBufferStats;
+    table.DestroyPipeline = ::DestroyPipelineStats;
+    table.BeginCommandBuffer = ::BeginCommandBufferStats;
+    table.CmdSetPipeline = ::CmdSetPipelineStats;
+    table.CmdSetDescriptorSet = ::CmdSetDescriptorSetStats;
+    table.CmdSetRootConstants = ::CmdSetRootConstantsStats;
+    table.CmdBarrier = ::CmdBarrierStats;
+    table.CmdDraw = ::CmdDrawStats;
+    table.CmdDrawIndexed = ::CmdDrawIndexedStats;
+    table.CmdDrawIndirect = ::CmdDrawIndirectStats;
+    table.CmdDrawIndexedIndirect = ::CmdDrawIndexedIndirectStats;
+    table.CmdDispatch = ::CmdDispatchStats;
+    table.CmdDispatchIndirect = ::CmdDispatchIndirectStats;
+    table.EndCommandBuffer = ::EndCommandBufferStats;
+    table.QueueSubmit = ::QueueSubmitStats;
+}
+
+void StatsLayer::WrapFunctionTable(StreamerInterface& table) {
+    m_StreamerInterface = table;
+
+    table.UpdateStreamerConstantBuffer = ::UpdateStreamerConstantBufferStats;
+    table.AddStreamerBufferUpdateRequest = ::AddStreamerBufferUpdateRequestStats;
+    table.AddStreamerTextureUpdateRequest = ::AddStreamerTextureUpdateRequestStats;
+}
+
+void StatsLayer::FillFunctionTable(StatsInterface& table) const {
+    table.GetCommandBufferStats = ::GetCommandBufferStats;
+    table.GetFrameStats = ::GetFrameStats;
+    table.EndStatsFrame = ::EndStatsFrame;
+}
+
+CommandBufferStatsRecord& StatsLayer::GetCommandBufferRecord(const CommandBuffer& commandBuffer) {
+    StatsRecordCache& cache = t_StatsRecordCache;
+    uint32_t epoch = m_Epoch.load(std::memory_order_acquire);
+
+    if (cache.commandBuffer == &commandBuffer && cache.generation == m_Generation && cache.epoch == epoch)
+        return *cache.record;
+
+    ExclusiveScope lock(m_Lock);
+
+    CommandBufferStatsRecord& record = m_CommandBuffers[&commandBuffer];
+    cache = {&commandBuffer, &record, m_Generation, epoch};
+
+    return record;
+}
+
+void StatsLayer::EraseCommandBufferRecord(const CommandBuffer& commandBuffer) {
+    ExclusiveScope lock(m_Lock);
+
+    m_CommandBuffers.erase(&commandBuffer);
+    m_Epoch.fetch_add(1, std::memory_order_release);
+}
+
+void StatsLayer::GetCommandBufferStats(const CommandBuffer& commandBuffer, CommandBufferStats& commandBufferStats) {
+    ExclusiveScope lock(m_Lock);
+
+    const auto it = m_CommandBuffers.find(&commandBuffer);
+    commandBufferStats = it != m_CommandBuffers.end() ? it->second.stats : CommandBufferStats{};
+}
+
+void StatsLayer::FoldCommandBufferStats(const CommandBufferStats& commandBufferStats) {
+    const uint64_t* counters = (const uint64_t*)&commandBufferStats;
+    for (uint32_t i = 0; i < STATS_COMMAND_BUFFER_NUM; i++) {
+        if (counters[i])
+            m_Counters[i].fetch_add(counters[i], std::memory_order_relaxed);
+    }
+
+    Add(STATS_COMMAND_BUFFER_NUM, 1);
+}
+
+void StatsLayer::AddPipeline(const Pipeline& pipeline, Topology topology) {
+    ExclusiveScope lock(m_Lock);
+
+    m_Pipelines[&pipeline] = topology;
+}
+
+void StatsLayer::ErasePipeline(const Pipeline& pipeline) {
+    ExclusiveScope lock(m_Lock);
+
+    m_Pipelines.erase(&pipeline);
+}
+
+Topology StatsLayer::GetPipelineTopology(const Pipeline& pipeline) {
+    ExclusiveScope lock(m_Lock);
+
+    // Not found for compute and ray tracing pipelines
+    const auto it = m_Pipelines.find(&pipeline);
+
+    return it != m_Pipelines.end() ? it->second : Topology::MAX_NUM;
+}
+
+void StatsLayer::GetFrameStats(FrameStats& frameStats) {
+    ExclusiveScope lock(m_LastFrameLock);
+
+    frameStats = m_LastFrame;
+}
+
+void StatsLayer::EndFrame() {
+    // Commands recorded concurrently with this call go to either frame
+    FrameStats frameStats = {};
+    uint64_t* counters = (uint64_t*)&frameStats;
+    for (uint32_t i = 0; i < STATS_COUNTER_NUM; i++)
+        counters[i] = m_Counters[i].exchange(0, std::memory_order_relaxed);
+
+    ExclusiveScope lock(m_LastFrameLock);
+
+    m_LastFrame = frameStats;
+}
+
+#pragma endregion
+
+Result CreateStatsLayer(Device& device) {
+    if (g_StatsLayer) {
+        REPORT_WARNING((DeviceBase*)&device, "Only one device per process can have stats enabled");
+        return Result::UNSUPPORTED;
+    }
+
+    // Starts from 1, zero-initialized caches of threads never match
+    const uint32_t generation = g_StatsLayerGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+    g_StatsLayer = Allocate<StatsLayer>(((DeviceBase&)device).GetAllocationCallbacks(), device, generation);
+
+    return g_StatsLayer ? Result::SUCCESS : Result::OUT_OF_MEMORY;
+}
+
+void DestroyStatsLayer(Device& device) {
+    if (!g_StatsLayer || &g_StatsLayer->GetDevice() != &device)
+        return;
+
+    Destroy(((DeviceBase&)device).GetAllocationCallbacks(), g_StatsLayer);
+    g_StatsLayer = nullptr;
+}
+
+bool WrapFunctionTableStats(const Device& device, CoreInterface& table) {
+    if (!g_StatsLayer || &g_StatsLayer->GetDevice() != &device)
+        return false;
+
+    g_StatsLayer->WrapFunctionTable(table);
+
+    return true;
+}
+
+bool WrapFunctionTableStats(const Device& device, StreamerInterface& table) {
+    if (!g_StatsLayer || &g_StatsLayer->GetDevice() != &device)
+        return false;
+
+    g_StatsLayer->WrapFunctionTable(table);
+
+    return true;
+}
+
+Result FillFunctionTableStats(const Device& device, StatsInterface& table) {
+    if (!g_StatsLayer || &g_StatsLayer->GetDevice() != &device)
+        return Result::UNSUPPORTED;
+
+    g_StatsLayer->FillFunctionTable(table);
+
+    return Result::SUCCESS;
+}
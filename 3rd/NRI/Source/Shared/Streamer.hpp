@@ -8,11 +8,18 @@ StreamerImpl::~StreamerImpl() {
         m_NRI.FreeMemory(*garbageInFlight.memory);
     }
 
-    m_NRI.DestroyBuffer(*m_ConstantBuffer);
-    m_NRI.DestroyBuffer(*m_DynamicBuffer);
+    // Optional or created on demand
+    if (m_ConstantBuffer)
+        m_NRI.DestroyBuffer(*m_ConstantBuffer);
 
-    m_NRI.FreeMemory(*m_ConstantBufferMemory);
-    m_NRI.FreeMemory(*m_DynamicBufferMemory);
+    if (m_DynamicBuffer)
+        m_NRI.DestroyBuffer(*m_DynamicBuffer);
+
+    if (m_ConstantBufferMemory)
+        m_NRI.FreeMemory(*m_ConstantBufferMemory);
+
+    if (m_DynamicBufferMemory)
+        m_NRI.FreeMemory(*m_DynamicBufferMemory);
 }
 
 Result StreamerImpl::Create(const StreamerDesc& desc) {
@@ -9,9 +9,11 @@ NRI_INLINE void* BufferVal::Map(uint64_t offset, uint64_t size) {
     RETURN_ON_FAILURE(&m_Device, m_IsBoundToMemory, nullptr, "the buffer is not bound to memory");
     RETURN_ON_FAILURE(&m_Device, !m_IsMapped, nullptr, "the buffer is already mapped (D3D11 doesn't support nested calls)");
 
-    m_IsMapped = true;
+    // NULL is not mapped (NONE)
+    void* data = GetCoreInterface().MapBuffer(*GetImpl(), offset, size);
+    m_IsMapped = data != nullptr;
 
-    return GetCoreInterface().MapBuffer(*GetImpl(), offset, size);
+    return data;
 }
 
 NRI_INLINE void BufferVal::Unmap() {
@@ -8,6 +8,16 @@ struct DescriptorVal;
 struct PipelineVal;
 struct PipelineLayoutVal;
 
+// Recording state expected by a command (see "RETURN_ON_BAD_STATE")
+enum class StateCheck : uint8_t {
+    INSIDE_RENDERING,
+    OUTSIDE_RENDERING,
+    PIPELINE_LAYOUT,
+    PIPELINE,
+
+    MAX_NUM
+};
+
 struct CommandBufferVal final : public ObjectVal {
     CommandBufferVal(DeviceVal& device, CommandBuffer* commandBuffer, bool isWrapped)
         : ObjectVal(device, commandBuffer)
@@ -23,6 +33,15 @@ struct CommandBufferVal final : public ObjectVal {
         return GetCoreInterface().GetCommandBufferNativeObject(*GetImpl());
     }
 
+    // Light validation: the first failing command per check is remembered, failures are reported in "End"
+    inline void AddFailedStateCheck(StateCheck stateCheck, const char* function) {
+        uint32_t bit = 1u << (uint32_t)stateCheck;
+        if (!(m_FailedStateChecks & bit)) {
+            m_FailedStateChecks |= bit;
+            m_FailedStateFunctions[(size_t)stateCheck] = function;
+        }
+    }
+
     inline void ResetAttachments() {
         m_RenderTargetNum = 0;
         for (size_t i = 0; i < m_RenderTargets.size(); i++)
@@ -93,13 +112,17 @@ private:
 
     std::array<DescriptorVal*, 16> m_RenderTargets = {};
     DescriptorVal* m_DepthStencil = nullptr;
+    std::array<const char*, (size_t)StateCheck::MAX_NUM> m_FailedStateFunctions = {};
     PipelineLayoutVal* m_PipelineLayout = nullptr;
     PipelineVal* m_Pipeline = nullptr;
     uint32_t m_RenderTargetNum = 0;
     int32_t m_AnnotationStack = 0;
+    uint32_t m_FailedStateChecks = 0; // light validation
     bool m_IsRecordingStarted = false;
     bool m_IsWrapped = false;
     bool m_IsRenderPass = false;
+    bool m_IsLight = false; // set in "Begin", wrapped command buffers are always fully validated
+    bool m_IsSampled = true; // parameters are validated (always "true" if not light)
 };
 
 } // namespace nri
@@ -2,6 +2,24 @@
 
 void ConvertGeometryObjectsVal(GeometryObject* destObjects, const GeometryObject* sourceObjects, uint32_t objectNum);
 
+constexpr std::array<const char*, (size_t)StateCheck::MAX_NUM> STATE_CHECK_MESSAGES = {
+    "must be called inside 'CmdBeginRendering/CmdEndRendering'", // INSIDE_RENDERING
+    "must be called outside of 'CmdBeginRendering/CmdEndRendering'", // OUTSIDE_RENDERING
+    "'SetPipelineLayout' has not been called", // PIPELINE_LAYOUT
+    "'SetPipeline' has not been called", // PIPELINE
+};
+
+// The command is skipped in both modes (backends dereference the missing pipeline or layout). Full validation reports
+// immediately, light validation reports the first failure of each kind in "End"
+#define RETURN_ON_BAD_STATE(stateCheck, condition) \
+    if (!(condition)) { \
+        if (m_IsLight) \
+            AddFailedStateCheck(stateCheck, __FUNCTION__); \
+        else \
+            m_Device.ReportMessage(Message::ERROR, __FILE__, __LINE__, "%s: %s", __FUNCTION__, STATE_CHECK_MESSAGES[(size_t)(stateCheck)]); \
+        return; \
+    }
+
 static bool ValidateBufferBarrierDesc(const DeviceVal& device, uint32_t i, const BufferBarrierDesc& bufferBarrierDesc) {
     const BufferVal& bufferVal = *(const BufferVal*)bufferBarrierDesc.buffer;
 
@@ -41,6 +59,9 @@ NRI_INLINE Result CommandBufferVal::Begin(const DescriptorPool* descriptorPool)
 
     m_Pipeline = nullptr;
     m_PipelineLayout = nullptr;
+    m_FailedStateChecks = 0;
+    m_IsLight = m_Device.IsLightValidation();
+    m_IsSampled = !m_IsLight || m_Device.SampleRecording();
 
     ResetAttachments();
 
@@ -55,6 +76,12 @@ NRI_INLINE Result CommandBufferVal::End() {
     else if (m_AnnotationStack < 0)
         REPORT_ERROR(&m_Device, "'CmdEndAnnotation' is called more times than 'CmdBeginAnnotation'");
 
+    // Light validation
+    for (uint32_t i = 0; m_FailedStateChecks && i < (uint32_t)StateCheck::MAX_NUM; i++) {
+        if (m_FailedStateChecks & (1u << i))
+            REPORT_ERROR(&m_Device, "'%s': %s (the first failure of this kind in the command buffer)", m_FailedStateFunctions[i], STATE_CHECK_MESSAGES[i]);
+    }
+
     Result result = GetCoreInterface().EndCommandBuffer(*GetImpl());
     if (result == Result::SUCCESS)
         m_IsRecordingStarted = m_IsWrapped;
@@ -71,7 +98,7 @@ NRI_INLINE void CommandBufferVal::SetViewports(const Viewport* viewports, uint32
     RETURN_ON_FAILURE(&m_Device, viewports, ReturnVoid(), "'viewports' is NULL");
 
     const DeviceDesc& deviceDesc = m_Device.GetDesc();
-    if (!deviceDesc.isViewportOriginBottomLeftSupported) {
+    if (m_IsSampled && !deviceDesc.isViewportOriginBottomLeftSupported) {
         for (uint32_t i = 0; i < viewportNum; i++) {
             RETURN_ON_FAILURE(&m_Device, !viewports[i].originBottomLeft, ReturnVoid(), "'isViewportOriginBottomLeftSupported' is false");
         }
@@ -137,10 +164,10 @@ NRI_INLINE void CommandBufferVal::SetDepthBias(const DepthBiasDesc& depthBiasDes
 
 NRI_INLINE void CommandBufferVal::ClearAttachments(const ClearDesc* clearDescs, uint32_t clearDescNum, const Rect* rects, uint32_t rectNum) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_IsRenderPass, ReturnVoid(), "must be called inside 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::INSIDE_RENDERING, m_IsRenderPass);
 
     const DeviceDesc& deviceDesc = m_Device.GetDesc();
-    for (uint32_t i = 0; i < clearDescNum; i++) {
+    for (uint32_t i = 0; i < clearDescNum && m_IsSampled; i++) {
         RETURN_ON_FAILURE(&m_Device, (clearDescs[i].planes & (PlaneBits::COLOR | PlaneBits::DEPTH | PlaneBits::STENCIL)) != 0, ReturnVoid(), "'[%u].planes' is not COLOR, DEPTH or STENCIL", i);
 
         if (clearDescs[i].planes & PlaneBits::COLOR) {
@@ -160,7 +187,7 @@ NRI_INLINE void CommandBufferVal::ClearAttachments(const ClearDesc* clearDescs,
 
 NRI_INLINE void CommandBufferVal::ClearStorageBuffer(const ClearStorageBufferDesc& clearDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, clearDesc.storageBuffer, ReturnVoid(), "'.storageBuffer' is NULL");
 
     auto clearDescImpl = clearDesc;
@@ -171,7 +198,7 @@ NRI_INLINE void CommandBufferVal::ClearStorageBuffer(const ClearStorageBufferDes
 
 NRI_INLINE void CommandBufferVal::ClearStorageTexture(const ClearStorageTextureDesc& clearDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, clearDesc.storageTexture, ReturnVoid(), "'.storageTexture' is NULL");
 
     auto clearDescImpl = clearDesc;
@@ -230,7 +257,7 @@ NRI_INLINE void CommandBufferVal::EndRendering() {
 
 NRI_INLINE void CommandBufferVal::SetVertexBuffers(uint32_t baseSlot, uint32_t bufferNum, const Buffer* const* buffers, const uint64_t* offsets) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_Pipeline, ReturnVoid(), "'SetPipeline' has not been called");
+    RETURN_ON_BAD_STATE(StateCheck::PIPELINE, m_Pipeline);
 
     Scratch<Buffer*> buffersImpl = AllocateScratch(m_Device, Buffer*, bufferNum);
     for (uint32_t i = 0; i < bufferNum; i++)
@@ -279,7 +306,7 @@ NRI_INLINE void CommandBufferVal::SetDescriptorPool(const DescriptorPool& descri
 
 NRI_INLINE void CommandBufferVal::SetDescriptorSet(uint32_t setIndex, const DescriptorSet& descriptorSet, const uint32_t* dynamicConstantBufferOffsets) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_PipelineLayout, ReturnVoid(), "'SetPipelineLayout' has not been called");
+    RETURN_ON_BAD_STATE(StateCheck::PIPELINE_LAYOUT, m_PipelineLayout);
 
     DescriptorSet* descriptorSetImpl = NRI_GET_IMPL(DescriptorSet, &descriptorSet);
 
@@ -288,17 +315,17 @@ NRI_INLINE void CommandBufferVal::SetDescriptorSet(uint32_t setIndex, const Desc
 
 NRI_INLINE void CommandBufferVal::SetRootConstants(uint32_t rootConstantIndex, const void* data, uint32_t size) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_PipelineLayout, ReturnVoid(), "'SetPipelineLayout' has not been called");
+    RETURN_ON_BAD_STATE(StateCheck::PIPELINE_LAYOUT, m_PipelineLayout);
 
     GetCoreInterface().CmdSetRootConstants(*GetImpl(), rootConstantIndex, data, size);
 }
 
 NRI_INLINE void CommandBufferVal::SetRootDescriptor(uint32_t rootDescriptorIndex, Descriptor& descriptor) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_PipelineLayout, ReturnVoid(), "'SetPipelineLayout' has not been called");
+    RETURN_ON_BAD_STATE(StateCheck::PIPELINE_LAYOUT, m_PipelineLayout);
 
     const DescriptorVal& descriptorVal = (DescriptorVal&)descriptor;
-    RETURN_ON_FAILURE(&m_Device, descriptorVal.IsBufferView(), ReturnVoid(), "'descriptor' must be a buffer view");
+    RETURN_ON_FAILURE(&m_Device, !m_IsSampled || descriptorVal.IsBufferView(), ReturnVoid(), "'descriptor' must be a buffer view");
 
     Descriptor* descriptorImpl = NRI_GET_IMPL(Descriptor, &descriptor);
 
@@ -307,14 +334,14 @@ NRI_INLINE void CommandBufferVal::SetRootDescriptor(uint32_t rootDescriptorIndex
 
 NRI_INLINE void CommandBufferVal::Draw(const DrawDesc& drawDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_IsRenderPass, ReturnVoid(), "must be called inside 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::INSIDE_RENDERING, m_IsRenderPass);
 
     GetCoreInterface().CmdDraw(*GetImpl(), drawDesc);
 }
 
 NRI_INLINE void CommandBufferVal::DrawIndexed(const DrawIndexedDesc& drawIndexedDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_IsRenderPass, ReturnVoid(), "must be called inside 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::INSIDE_RENDERING, m_IsRenderPass);
 
     GetCoreInterface().CmdDrawIndexed(*GetImpl(), drawIndexedDesc);
 }
@@ -322,7 +349,7 @@ NRI_INLINE void CommandBufferVal::DrawIndexed(const DrawIndexedDesc& drawIndexed
 NRI_INLINE void CommandBufferVal::DrawIndirect(const Buffer& buffer, uint64_t offset, uint32_t drawNum, uint32_t stride, const Buffer* countBuffer, uint64_t countBufferOffset) {
     const DeviceDesc& deviceDesc = m_Device.GetDesc();
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_IsRenderPass, ReturnVoid(), "must be called inside 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::INSIDE_RENDERING, m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, !countBuffer || deviceDesc.isDrawIndirectCountSupported, ReturnVoid(), "'countBuffer' is not supported");
 
     Buffer* bufferImpl = NRI_GET_IMPL(Buffer, &buffer);
@@ -334,7 +361,7 @@ NRI_INLINE void CommandBufferVal::DrawIndirect(const Buffer& buffer, uint64_t of
 NRI_INLINE void CommandBufferVal::DrawIndexedIndirect(const Buffer& buffer, uint64_t offset, uint32_t drawNum, uint32_t stride, const Buffer* countBuffer, uint64_t countBufferOffset) {
     const DeviceDesc& deviceDesc = m_Device.GetDesc();
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_IsRenderPass, ReturnVoid(), "must be called inside 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::INSIDE_RENDERING, m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, !countBuffer || deviceDesc.isDrawIndirectCountSupported, ReturnVoid(), "'countBuffer' is not supported");
 
     Buffer* bufferImpl = NRI_GET_IMPL(Buffer, &buffer);
@@ -346,7 +373,7 @@ NRI_INLINE void CommandBufferVal::DrawIndexedIndirect(const Buffer& buffer, uint
 NRI_INLINE void CommandBufferVal::CopyBuffer(Buffer& dstBuffer, uint64_t dstOffset, const Buffer& srcBuffer, uint64_t srcOffset, uint64_t size) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
 
-    if (size == WHOLE_SIZE) {
+    if (m_IsSampled && size == WHOLE_SIZE) {
         const BufferDesc& dstDesc = ((BufferVal&)dstBuffer).GetDesc();
         const BufferDesc& srcDesc = ((BufferVal&)srcBuffer).GetDesc();
 
@@ -362,7 +389,7 @@ NRI_INLINE void CommandBufferVal::CopyBuffer(Buffer& dstBuffer, uint64_t dstOffs
 
 NRI_INLINE void CommandBufferVal::CopyTexture(Texture& dstTexture, const TextureRegionDesc* dstRegionDesc, const Texture& srcTexture, const TextureRegionDesc* srcRegionDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     Texture* dstTextureImpl = NRI_GET_IMPL(Texture, &dstTexture);
     Texture* srcTextureImpl = NRI_GET_IMPL(Texture, &srcTexture);
@@ -372,7 +399,7 @@ NRI_INLINE void CommandBufferVal::CopyTexture(Texture& dstTexture, const Texture
 
 NRI_INLINE void CommandBufferVal::ResolveTexture(Texture& dstTexture, const TextureRegionDesc* dstRegionDesc, const Texture& srcTexture, const TextureRegionDesc* srcRegionDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     Texture* dstTextureImpl = NRI_GET_IMPL(Texture, &dstTexture);
     Texture* srcTextureImpl = NRI_GET_IMPL(Texture, &srcTexture);
@@ -382,7 +409,7 @@ NRI_INLINE void CommandBufferVal::ResolveTexture(Texture& dstTexture, const Text
 
 NRI_INLINE void CommandBufferVal::UploadBufferToTexture(Texture& dstTexture, const TextureRegionDesc& dstRegionDesc, const Buffer& srcBuffer, const TextureDataLayoutDesc& srcDataLayoutDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     Texture* dstTextureImpl = NRI_GET_IMPL(Texture, &dstTexture);
     Buffer* srcBufferImpl = NRI_GET_IMPL(Buffer, &srcBuffer);
@@ -392,7 +419,7 @@ NRI_INLINE void CommandBufferVal::UploadBufferToTexture(Texture& dstTexture, con
 
 NRI_INLINE void CommandBufferVal::ReadbackTextureToBuffer(Buffer& dstBuffer, const TextureDataLayoutDesc& dstDataLayoutDesc, const Texture& srcTexture, const TextureRegionDesc& srcRegionDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     Buffer* dstBufferImpl = NRI_GET_IMPL(Buffer, &dstBuffer);
     Texture* srcTextureImpl = NRI_GET_IMPL(Texture, &srcTexture);
@@ -402,17 +429,17 @@ NRI_INLINE void CommandBufferVal::ReadbackTextureToBuffer(Buffer& dstBuffer, con
 
 NRI_INLINE void CommandBufferVal::Dispatch(const DispatchDesc& dispatchDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     GetCoreInterface().CmdDispatch(*GetImpl(), dispatchDesc);
 }
 
 NRI_INLINE void CommandBufferVal::DispatchIndirect(const Buffer& buffer, uint64_t offset) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     const BufferDesc& bufferDesc = ((BufferVal&)buffer).GetDesc();
-    RETURN_ON_FAILURE(&m_Device, offset < bufferDesc.size, ReturnVoid(), "offset is greater than the buffer size");
+    RETURN_ON_FAILURE(&m_Device, !m_IsSampled || offset < bufferDesc.size, ReturnVoid(), "offset is greater than the buffer size");
 
     Buffer* bufferImpl = NRI_GET_IMPL(Buffer, &buffer);
     GetCoreInterface().CmdDispatchIndirect(*GetImpl(), *bufferImpl, offset);
@@ -420,16 +447,18 @@ NRI_INLINE void CommandBufferVal::DispatchIndirect(const Buffer& buffer, uint64_
 
 NRI_INLINE void CommandBufferVal::Barrier(const BarrierGroupDesc& barrierGroupDesc) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
-    for (uint32_t i = 0; i < barrierGroupDesc.bufferNum; i++) {
-        if (!ValidateBufferBarrierDesc(m_Device, i, barrierGroupDesc.buffers[i]))
-            return;
-    }
+    if (m_IsSampled) {
+        for (uint32_t i = 0; i < barrierGroupDesc.bufferNum; i++) {
+            if (!ValidateBufferBarrierDesc(m_Device, i, barrierGroupDesc.buffers[i]))
+                return;
+        }
 
-    for (uint32_t i = 0; i < barrierGroupDesc.textureNum; i++) {
-        if (!ValidateTextureBarrierDesc(m_Device, i, barrierGroupDesc.textures[i]))
-            return;
+        for (uint32_t i = 0; i < barrierGroupDesc.textureNum; i++) {
+            if (!ValidateTextureBarrierDesc(m_Device, i, barrierGroupDesc.textures[i]))
+                return;
+        }
     }
 
     Scratch<BufferBarrierDesc> buffers = AllocateScratch(m_Device, BufferBarrierDesc, barrierGroupDesc.bufferNum);
@@ -455,7 +484,7 @@ NRI_INLINE void CommandBufferVal::BeginQuery(QueryPool& queryPool, uint32_t offs
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
     RETURN_ON_FAILURE(&m_Device, queryPoolVal.GetQueryType() != QueryType::TIMESTAMP, ReturnVoid(), "'BeginQuery' is not supported for timestamp queries");
 
-    if (!queryPoolVal.IsImported())
+    if (m_IsSampled && !queryPoolVal.IsImported())
         RETURN_ON_FAILURE(&m_Device, offset < queryPoolVal.GetQueryNum(), ReturnVoid(), "'offset = %u' is out of range", offset);
 
     QueryPool* queryPoolImpl = NRI_GET_IMPL(QueryPool, &queryPool);
@@ -467,7 +496,7 @@ NRI_INLINE void CommandBufferVal::EndQuery(QueryPool& queryPool, uint32_t offset
 
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
 
-    if (!queryPoolVal.IsImported())
+    if (m_IsSampled && !queryPoolVal.IsImported())
         RETURN_ON_FAILURE(&m_Device, offset < queryPoolVal.GetQueryNum(), ReturnVoid(), "'offset = %u' is out of range", offset);
 
     QueryPool* queryPoolImpl = NRI_GET_IMPL(QueryPool, &queryPool);
@@ -476,10 +505,10 @@ NRI_INLINE void CommandBufferVal::EndQuery(QueryPool& queryPool, uint32_t offset
 
 NRI_INLINE void CommandBufferVal::CopyQueries(const QueryPool& queryPool, uint32_t offset, uint32_t num, Buffer& dstBuffer, uint64_t dstOffset) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     const QueryPoolVal& queryPoolVal = (const QueryPoolVal&)queryPool;
-    if (!queryPoolVal.IsImported())
+    if (m_IsSampled && !queryPoolVal.IsImported())
         RETURN_ON_FAILURE(&m_Device, offset + num <= queryPoolVal.GetQueryNum(), ReturnVoid(), "'offset + num =  %u' is out of range", offset + num);
 
     QueryPool* queryPoolImpl = NRI_GET_IMPL(QueryPool, &queryPool);
@@ -490,10 +519,10 @@ NRI_INLINE void CommandBufferVal::CopyQueries(const QueryPool& queryPool, uint32
 
 NRI_INLINE void CommandBufferVal::ResetQueries(QueryPool& queryPool, uint32_t offset, uint32_t num) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     QueryPoolVal& queryPoolVal = (QueryPoolVal&)queryPool;
-    if (!queryPoolVal.IsImported())
+    if (m_IsSampled && !queryPoolVal.IsImported())
         RETURN_ON_FAILURE(&m_Device, offset + num <= queryPoolVal.GetQueryNum(), ReturnVoid(), "'offset + num = %u' is out of range", offset + num);
 
     QueryPool* queryPoolImpl = NRI_GET_IMPL(QueryPool, &queryPool);
@@ -522,7 +551,7 @@ NRI_INLINE void CommandBufferVal::Annotation(const char* name, uint32_t bgra) {
 
 NRI_INLINE void CommandBufferVal::BuildTopLevelAccelerationStructure(uint32_t instanceNum, const Buffer& buffer, uint64_t bufferOffset, AccelerationStructureBuildBits flags, AccelerationStructure& dst, Buffer& scratch, uint64_t scratchOffset) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     BufferVal& bufferVal = (BufferVal&)buffer;
     BufferVal& scratchVal = (BufferVal&)scratch;
@@ -541,7 +570,7 @@ NRI_INLINE void CommandBufferVal::BuildBottomLevelAccelerationStructure(uint32_t
     BufferVal& scratchVal = (BufferVal&)scratch;
 
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, geometryObjects, ReturnVoid(), "'geometryObjects' is NULL");
     RETURN_ON_FAILURE(&m_Device, scratchOffset < scratchVal.GetDesc().size, ReturnVoid(), "'scratchOffset = %llu' is out of bounds", scratchOffset);
 
@@ -557,7 +586,7 @@ NRI_INLINE void CommandBufferVal::BuildBottomLevelAccelerationStructure(uint32_t
 NRI_INLINE void CommandBufferVal::UpdateTopLevelAccelerationStructure(uint32_t instanceNum, const Buffer& buffer, uint64_t bufferOffset, AccelerationStructureBuildBits flags,
     AccelerationStructure& dst, const AccelerationStructure& src, Buffer& scratch, uint64_t scratchOffset) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
 
     BufferVal& bufferVal = (BufferVal&)buffer;
     BufferVal& scratchVal = (BufferVal&)scratch;
@@ -576,7 +605,7 @@ NRI_INLINE void CommandBufferVal::UpdateTopLevelAccelerationStructure(uint32_t i
 NRI_INLINE void CommandBufferVal::UpdateBottomLevelAccelerationStructure(uint32_t geometryObjectNum, const GeometryObject* geometryObjects, AccelerationStructureBuildBits flags,
     AccelerationStructure& dst, const AccelerationStructure& src, Buffer& scratch, uint64_t scratchOffset) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, geometryObjects, ReturnVoid(), "'geometryObjects' is NULL");
 
     BufferVal& scratchVal = (BufferVal&)scratch;
@@ -595,7 +624,7 @@ NRI_INLINE void CommandBufferVal::UpdateBottomLevelAccelerationStructure(uint32_
 
 NRI_INLINE void CommandBufferVal::CopyAccelerationStructure(AccelerationStructure& dst, const AccelerationStructure& src, CopyMode copyMode) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, copyMode < CopyMode::MAX_NUM, ReturnVoid(), "'copyMode' is invalid");
 
     AccelerationStructure& dstImpl = *NRI_GET_IMPL(AccelerationStructure, &dst);
@@ -606,7 +635,7 @@ NRI_INLINE void CommandBufferVal::CopyAccelerationStructure(AccelerationStructur
 
 NRI_INLINE void CommandBufferVal::WriteAccelerationStructureSize(const AccelerationStructure* const* accelerationStructures, uint32_t accelerationStructureNum, QueryPool& queryPool, uint32_t queryOffset) {
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, accelerationStructures, ReturnVoid(), "'accelerationStructures' is NULL");
 
     Scratch<AccelerationStructure*> accelerationStructureArray = AllocateScratch(m_Device, AccelerationStructure*, accelerationStructureNum);
@@ -625,7 +654,7 @@ NRI_INLINE void CommandBufferVal::DispatchRays(const DispatchRaysDesc& dispatchR
     const DeviceDesc& deviceDesc = m_Device.GetDesc();
     uint64_t align = deviceDesc.shaderBindingTableAlignment;
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, !m_IsRenderPass, ReturnVoid(), "must be called outside of 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::OUTSIDE_RENDERING, !m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, dispatchRaysDesc.raygenShader.buffer, ReturnVoid(), "'raygenShader.buffer' is NULL");
     RETURN_ON_FAILURE(&m_Device, dispatchRaysDesc.raygenShader.size != 0, ReturnVoid(), "'raygenShader.size' is 0");
     RETURN_ON_FAILURE(&m_Device, dispatchRaysDesc.raygenShader.offset % align == 0, ReturnVoid(), "'raygenShader.offset' is misaligned");
@@ -655,7 +684,7 @@ NRI_INLINE void CommandBufferVal::DispatchRaysIndirect(const Buffer& buffer, uin
 NRI_INLINE void CommandBufferVal::DrawMeshTasks(const DrawMeshTasksDesc& drawMeshTasksDesc) {
     const DeviceDesc& deviceDesc = m_Device.GetDesc();
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_IsRenderPass, ReturnVoid(), "must be called inside 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::INSIDE_RENDERING, m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, deviceDesc.isMeshShaderSupported, ReturnVoid(), "'isMeshShaderSupported' is false");
 
     GetMeshShaderInterface().CmdDrawMeshTasks(*GetImpl(), drawMeshTasksDesc);
@@ -664,7 +693,7 @@ NRI_INLINE void CommandBufferVal::DrawMeshTasks(const DrawMeshTasksDesc& drawMes
 NRI_INLINE void CommandBufferVal::DrawMeshTasksIndirect(const Buffer& buffer, uint64_t offset, uint32_t drawNum, uint32_t stride, const Buffer* countBuffer, uint64_t countBufferOffset) {
     const DeviceDesc& deviceDesc = m_Device.GetDesc();
     RETURN_ON_FAILURE(&m_Device, m_IsRecordingStarted, ReturnVoid(), "the command buffer must be in the recording state");
-    RETURN_ON_FAILURE(&m_Device, m_IsRenderPass, ReturnVoid(), "must be called inside 'CmdBeginRendering/CmdEndRendering'");
+    RETURN_ON_BAD_STATE(StateCheck::INSIDE_RENDERING, m_IsRenderPass);
     RETURN_ON_FAILURE(&m_Device, deviceDesc.isMeshShaderSupported, ReturnVoid(), "'isMeshShaderSupported' is false");
     RETURN_ON_FAILURE(&m_Device, !countBuffer || deviceDesc.isDrawIndirectCountSupported, ReturnVoid(), "'countBuffer' is not supported");
 
@@ -678,6 +707,9 @@ NRI_INLINE void CommandBufferVal::DrawMeshTasksIndirect(const Buffer& buffer, ui
 }
 
 NRI_INLINE void CommandBufferVal::ValidateReadonlyDepthStencil() {
+    if (!m_IsSampled)
+        return;
+
     if (m_Pipeline && m_DepthStencil) {
         if (m_DepthStencil->IsDepthReadonly() && m_Pipeline->WritesToDepth())
             REPORT_WARNING(&m_Device, "Depth is read-only, but the pipeline writes to depth. Writing happens only in VK!");
@@ -16,8 +16,11 @@ struct IsExtSupported {
     uint32_t wrapperVK : 1;
 };
 
+// Memory types are registered by "Get[Resource]MemoryDesc" and looked up by "AllocateMemory" from any thread
+constexpr uint32_t MEMORY_TYPE_SLOT_NUM = 256; // power of 2
+
 struct DeviceVal final : public DeviceBase {
-    DeviceVal(const CallbackInterface& callbacks, const AllocationCallbacks& allocationCallbacks, DeviceBase& device);
+    DeviceVal(const CallbackInterface& callbacks, const AllocationCallbacks& allocationCallbacks, DeviceBase& device, uint32_t sampleRate);
     ~DeviceVal();
 
     inline Device& GetImpl() const {
@@ -68,12 +71,18 @@ struct DeviceVal final : public DeviceBase {
         return m_iCore.GetDeviceNativeObject(m_Impl);
     }
 
-    inline Lock& GetLock() {
-        return m_Lock;
+    inline bool IsLightValidation() const {
+        return m_SampleRate != 0;
+    }
+
+    // Light validation: "true" for 1 of "sampleRate" command buffer recordings
+    inline bool SampleRecording() {
+        return m_RecordingIndex.fetch_add(1, std::memory_order_relaxed) % m_SampleRate == 0;
     }
 
     bool Create();
     void RegisterMemoryType(MemoryType memoryType, MemoryLocation memoryLocation);
+    bool GetMemoryLocation(MemoryType memoryType, MemoryLocation& memoryLocation) const;
 
     //================================================================================================================
     // DebugNameBase
@@ -183,7 +192,9 @@ private:
     DeviceDesc m_Desc = {}; // .natvis
     Device& m_Impl;
     std::array<QueueVal*, (size_t)QueueType::MAX_NUM> m_Queues = {};
-    UnorderedMap<MemoryType, MemoryLocation> m_MemoryTypeMap;
+    std::array<std::atomic_uint64_t, MEMORY_TYPE_SLOT_NUM> m_MemoryTypes; // open addressing: "type << 32 | (location + 1)", 0 - empty
+    std::atomic_uint32_t m_RecordingIndex = 0;
+    uint32_t m_SampleRate = 0;
 
     // Validation interfaces
     CoreInterface m_iCoreVal = {};
@@ -204,8 +215,6 @@ private:
         uint32_t m_IsExtSupportedStorage = 0;
         IsExtSupported m_IsExtSupported;
     };
-
-    Lock m_Lock;
 };
 
 } // namespace nri
@@ -37,10 +37,18 @@ static inline Mip_t GetMaxMipNum(uint16_t w, uint16_t h, uint16_t d) {
 void ConvertGeometryObjectsVal(GeometryObject* destObjects, const GeometryObject* sourceObjects, uint32_t objectNum);
 QueryType GetQueryTypeVK(uint32_t queryTypeVK);
 
-DeviceVal::DeviceVal(const CallbackInterface& callbacks, const AllocationCallbacks& allocationCallbacks, DeviceBase& device)
+static inline uint32_t GetMemoryTypeSlot(MemoryType memoryType) {
+    return (memoryType * 0x9E3779B1u) >> 24; // Fibonacci hashing, top 8 bits
+}
+
+static_assert(MEMORY_TYPE_SLOT_NUM == 256, "Keep in sync with 'GetMemoryTypeSlot'");
+
+DeviceVal::DeviceVal(const CallbackInterface& callbacks, const AllocationCallbacks& allocationCallbacks, DeviceBase& device, uint32_t sampleRate)
     : DeviceBase(callbacks, allocationCallbacks, NRI_OBJECT_SIGNATURE)
     , m_Impl(*(Device*)&device)
-    , m_MemoryTypeMap(GetStdAllocator()) {
+    , m_SampleRate(sampleRate) {
+    for (std::atomic_uint64_t& slot : m_MemoryTypes)
+        slot.store(0, std::memory_order_relaxed);
 }
 
 DeviceVal::~DeviceVal() {
@@ -87,8 +95,42 @@ bool DeviceVal::Create() {
 }
 
 void DeviceVal::RegisterMemoryType(MemoryType memoryType, MemoryLocation memoryLocation) {
-    ExclusiveScope lockScope(m_Lock);
-    m_MemoryTypeMap[memoryType] = memoryLocation;
+    const uint64_t entry = ((uint64_t)memoryType << 32) | ((uint32_t)memoryLocation + 1);
+
+    uint32_t slot = GetMemoryTypeSlot(memoryType);
+    for (uint32_t i = 0; i < MEMORY_TYPE_SLOT_NUM; i++) {
+        std::atomic_uint64_t& value = m_MemoryTypes[slot];
+
+        uint64_t expected = value.load(std::memory_order_acquire);
+        if (expected == 0 && value.compare_exchange_strong(expected, entry, std::memory_order_release, std::memory_order_acquire))
+            return;
+
+        // A memory type always maps to the same location
+        if ((expected >> 32) == memoryType)
+            return;
+
+        slot = (slot + 1) & (MEMORY_TYPE_SLOT_NUM - 1);
+    }
+
+    REPORT_WARNING(this, "Too many memory types, 'AllocateMemory' will fail for memory type %u", memoryType);
+}
+
+bool DeviceVal::GetMemoryLocation(MemoryType memoryType, MemoryLocation& memoryLocation) const {
+    uint32_t slot = GetMemoryTypeSlot(memoryType);
+    for (uint32_t i = 0; i < MEMORY_TYPE_SLOT_NUM; i++) {
+        uint64_t value = m_MemoryTypes[slot].load(std::memory_order_acquire);
+        if (value == 0)
+            return false;
+
+        if ((value >> 32) == memoryType) {
+            memoryLocation = (MemoryLocation)((value & 0xFFFFFFFF) - 1);
+            return true;
+        }
+
+        slot = (slot + 1) & (MEMORY_TYPE_SLOT_NUM - 1);
+    }
+
+    return false;
 }
 
 void DeviceVal::Destruct() {
@@ -580,21 +622,14 @@ NRI_INLINE Result DeviceVal::AllocateMemory(const AllocateMemoryDesc& allocateMe
     RETURN_ON_FAILURE(this, allocateMemoryDesc.size > 0, Result::INVALID_ARGUMENT, "'size' is 0");
     RETURN_ON_FAILURE(this, allocateMemoryDesc.priority >= -1.0f && allocateMemoryDesc.priority <= 1.0f, Result::INVALID_ARGUMENT, "'priority' outside of [-1; 1] range");
 
-    std::unordered_map<MemoryType, MemoryLocation>::iterator it;
-    std::unordered_map<MemoryType, MemoryLocation>::iterator end;
-    {
-        ExclusiveScope lockScope(m_Lock);
-        it = m_MemoryTypeMap.find(allocateMemoryDesc.type);
-        end = m_MemoryTypeMap.end();
-    }
-
-    RETURN_ON_FAILURE(this, it != end, Result::FAILURE, "'memoryType' is invalid");
+    MemoryLocation memoryLocation = MemoryLocation::MAX_NUM;
+    RETURN_ON_FAILURE(this, GetMemoryLocation(allocateMemoryDesc.type, memoryLocation), Result::FAILURE, "'memoryType' is invalid");
 
     Memory* memoryImpl;
     Result result = m_iCore.AllocateMemory(m_Impl, allocateMemoryDesc, memoryImpl);
 
     if (result == Result::SUCCESS)
-        memory = (Memory*)Allocate<MemoryVal>(GetAllocationCallbacks(), *this, memoryImpl, allocateMemoryDesc.size, it->second);
+        memory = (Memory*)Allocate<MemoryVal>(GetAllocationCallbacks(), *this, memoryImpl, allocateMemoryDesc.size, memoryLocation);
 
     return result;
 }
@@ -46,7 +46,7 @@ using namespace nri;
 #include "TextureVal.hpp"
 
 DeviceBase* CreateDeviceValidation(const DeviceCreationDesc& desc, DeviceBase& device) {
-    DeviceVal* deviceVal = Allocate<DeviceVal>(desc.allocationCallbacks, desc.callbackInterface, desc.allocationCallbacks, device);
+    DeviceVal* deviceVal = Allocate<DeviceVal>(desc.allocationCallbacks, desc.callbackInterface, desc.allocationCallbacks, device, desc.nriValidationSampleRate);
 
     if (!deviceVal->Create()) {
         Destroy(desc.allocationCallbacks, deviceVal);
@@ -0,0 +1,85 @@
+#pragma once
+
+// Keyframe sampling of an "Animation" into a "TransformHierarchy". Tracks are copied into flat per-channel streams (keys,
+// values padded to 4 floats, per-track offsets and cursors). Every track remembers the last used key, so monotonic
+// playback finds keys in O(1), jumps fall back to a binary search. Values of 4 tracks are interpolated at once with SSE
+// (lerp, polynomial slerp, cubic Hermite). Morph weights are stored densely and evaluated into preallocated arrays
+
+namespace utils {
+
+// Accumulated over calls
+struct AnimationSamplerStats {
+    uint64_t trackNum; // sampled tracks, including weight tracks
+    uint64_t searchNum; // cursor misses (binary search)
+    double time; // ms
+
+    inline double GetTracksPerSecond() const {
+        return time > 0.0 ? trackNum * 1000.0 / time : 0.0;
+    }
+
+    inline double GetSearchFraction() const {
+        return trackNum ? double(searchNum) / double(trackNum) : 0.0;
+    }
+};
+
+class AnimationSampler {
+public:
+    // Tracks of nodes not present in "hierarchy" are skipped. "CubicSpline" tracks must store glTF triplets (in-tangent,
+    // value, out-tangent) per key, otherwise they are sampled as "Linear" (always for weight tracks)
+    void Build(const Animation& animation, const TransformHierarchy& hierarchy);
+
+    // "time" - seconds, clamped to the keys of each track. Writes TRS of animated nodes into "hierarchy" (marking them dirty)
+    void Sample(float time, TransformHierarchy& hierarchy, AnimationSamplerStats& stats);
+
+    // Non-zero weights of a weight track evaluated by the last "Sample", sorted by weight (descending) and normalized
+    inline const MorphTargetIndexWeight* GetMorphWeights(uint32_t weightTrack, uint32_t& num) const {
+        const MorphTrack& track = m_MorphTracks[weightTrack];
+        num = track.activeNum;
+
+        return m_ActiveWeights.data() + track.activeOffset;
+    }
+
+    inline uint32_t GetTrackNum() const {
+        return (uint32_t)(m_Channels[0].nodes.size() + m_Channels[1].nodes.size() + m_Channels[2].nodes.size() + m_MorphTracks.size());
+    }
+
+private:
+    // Per-track arrays. Tracks are sorted by interpolation: "[0, cubicBegin)" - step and linear, the rest - cubic
+    struct Channel {
+        std::vector<float> keys;
+        std::vector<vec4> values;
+        std::vector<uint32_t> keyOffsets; // track "i" - "[keyOffsets[i], keyOffsets[i + 1])"
+        std::vector<uint32_t> valueOffsets;
+        std::vector<uint32_t> nodes;
+        std::vector<uint32_t> cursors;
+        std::vector<uint8_t> isStep;
+        std::vector<vec4> sampled;
+        uint32_t cubicBegin = 0;
+    };
+
+    struct MorphTrack {
+        uint32_t keyOffset;
+        uint32_t keyNum;
+        uint32_t weightOffset; // "keyNum * targetNum" weights
+        uint32_t targetNum;
+        uint32_t activeOffset; // "targetNum" entries
+        uint32_t activeNum;
+        uint32_t cursor;
+        bool isStep;
+    };
+
+    void SampleChannel(Channel& channel, bool isRotation, float time, uint64_t& searchNum);
+
+private:
+    Channel m_Channels[3]; // translation, rotation, scale
+    std::vector<MorphTrack> m_MorphTracks;
+    std::vector<float> m_MorphKeys;
+    std::vector<float> m_MorphWeights;
+    std::vector<MorphTargetIndexWeight> m_ActiveWeights;
+};
+
+// The original "Scene::Animate" sampling (the reference): reverse linear key search per track, sparse morph weight merge,
+// "CubicSpline" as "Linear". Writes TRS into the track nodes and "activeValues" of weight tracks
+void SampleAnimationReference(Animation& animation, float time);
+
+} // namespace utils
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Asynchronous asset loading: files are read by a small I/O pool, the bytes are decoded on the shared job system
+// ("utils::JobSystem::GetShared", no extra CPU bound threads) and finished jobs are queued for the thread calling
+// "ProcessCompletions", "Wait" or "WaitAll" (the one recording GPU uploads). Everything can be issued up front, blocking
+// is needed only when a resource is actually used
+
+struct AssetLoaderDesc {
+    uint32_t ioThreadNum = 2; // reads are bandwidth bound, more threads mostly add seeks (mostly blocked in reads)
+    bool isSerial = false; // jobs run on the issuing thread inside "Load*" (reference for timings)
+};
+
+// Gets file contents (empty for "Run" jobs), called on a job system worker
+typedef std::function<bool(std::vector<uint8_t>& fileData)> AssetDecodeFunc;
+
+// Called on the thread calling "ProcessCompletions" or "Wait"
+typedef std::function<void(bool isLoaded)> AssetCompletionFunc;
+
+struct AssetJob;
+
+class AssetHandle {
+public:
+    inline bool IsValid() const {
+        return m_Job != nullptr;
+    }
+
+    // Decoding is done (completion can still be pending)
+    bool IsReady() const;
+
+private:
+    std::shared_ptr<AssetJob> m_Job;
+
+    friend class AssetLoader;
+};
+
+class AssetLoader {
+public:
+    ~AssetLoader();
+
+    void Initialize(const AssetLoaderDesc& desc);
+    void Shutdown(); // waits for all issued jobs
+
+    // "path" is read on an I/O thread, then "decode" gets the contents on a job system worker
+    AssetHandle Load(const std::string& path, const AssetDecodeFunc& decode, const AssetCompletionFunc& onComplete = nullptr);
+
+    // No file reading, for loaders which need to open files on their own (for example, with dependencies)
+    AssetHandle Run(const std::function<bool()>& run, const AssetCompletionFunc& onComplete = nullptr);
+
+    // "texture" must stay alive until the job is done
+    AssetHandle LoadTexture(const std::string& path, utils::Texture& texture, bool computeAvgColorAndAlphaMode = false, const AssetCompletionFunc& onComplete = nullptr);
+
+    // Blocks until decoded, then runs the completion of this job if still pending, other completions stay queued.
+    // Can be called from completions. Returns "true" on success
+    bool Wait(const AssetHandle& handle);
+    void WaitAll();
+
+    // Returns the number of processed completions
+    uint32_t ProcessCompletions();
+
+    // Issued, but not decoded yet
+    inline uint32_t GetPendingJobNum() const {
+        return m_PendingJobNum.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct WorkerPool {
+        std::vector<std::thread> threads;
+        std::deque<std::shared_ptr<AssetJob>> jobs;
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool isStopping = false;
+    };
+
+    void Issue(const std::shared_ptr<AssetJob>& job);
+    void Decode(const std::shared_ptr<AssetJob>& job);
+    void SubmitDecode(const std::shared_ptr<AssetJob>& job);
+    void IoThread();
+
+private:
+    WorkerPool m_IoPool;
+    std::vector<std::shared_ptr<AssetJob>> m_Completed;
+    std::mutex m_CompletedMutex;
+    std::condition_variable m_CompletedCondition;
+    std::atomic<uint32_t> m_PendingJobNum = 0;
+    bool m_IsSerial = true;
+};
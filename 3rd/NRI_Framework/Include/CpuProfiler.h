@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    define CPU_PROFILER_RDTSC // invariant TSC is assumed, ticks are calibrated against "steady_clock"
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#    else
+#        include <x86intrin.h>
+#    endif
+#endif
+
+// Hierarchical CPU profiler. "PROFILE_SCOPE" pushes begin / end events into a ring buffer owned by the calling thread:
+// no locks, no allocations (besides the first event of a thread), just a timestamp and two stores per event. Timestamps
+// are raw "rdtsc" ticks on x86, "steady_clock" ("CLOCK_MONOTONIC", "QueryPerformanceCounter") elsewhere. Frame markers
+// come from "SampleBase::RenderLoop". Events are exported as Chrome trace JSON (opens in "chrome://tracing" and Perfetto
+// UI) and drawn as a per-thread flame graph of the last frame with ImGui
+
+#define _PROFILE_CONCAT(a, b) a##b
+#define PROFILE_CONCAT(a, b) _PROFILE_CONCAT(a, b)
+
+// "name" must be a string literal (only the pointer is stored)
+#define PROFILE_SCOPE(name) utils::CpuProfilerScope PROFILE_CONCAT(_cpuProfilerScope, __LINE__)(name)
+
+namespace utils {
+
+constexpr uint32_t CPU_PROFILER_EVENT_NUM = 64 * 1024; // per thread, power of 2, the oldest events get overwritten
+constexpr uint32_t CPU_PROFILER_FRAME_NUM = 256; // frame markers
+constexpr uint32_t CPU_PROFILER_DEPTH_MAX = 64; // deeper scopes are not exported
+
+static_assert((CPU_PROFILER_EVENT_NUM & (CPU_PROFILER_EVENT_NUM - 1)) == 0, "Must be a power of 2");
+
+struct CpuProfilerEvent {
+    const char* name; // "nullptr" - the end of the innermost open scope
+    uint64_t ticks;
+};
+
+// Written only by the owning thread. Readers take "head" and copy "[head - CPU_PROFILER_EVENT_NUM, head)"
+struct CpuProfilerThread {
+    CpuProfilerEvent events[CPU_PROFILER_EVENT_NUM];
+    std::atomic<uint64_t> head;
+    uint32_t index; // "tid" in traces
+    char name[32];
+
+    inline void Push(const char* eventName, uint64_t ticks) {
+        uint64_t i = head.load(std::memory_order_relaxed);
+
+        CpuProfilerEvent& event = events[i & (CPU_PROFILER_EVENT_NUM - 1)];
+        event.name = eventName;
+        event.ticks = ticks;
+
+        head.store(i + 1, std::memory_order_release);
+    }
+};
+
+inline std::atomic<bool> g_IsCpuProfilerEnabled = false;
+
+inline uint64_t GetCpuProfilerTicks() {
+#ifdef CPU_PROFILER_RDTSC
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// Slow path, once per thread (buffers of finished threads are reused)
+CpuProfilerThread* RegisterCpuProfilerThread();
+
+// A lane not bound to a thread (e.g. GPU time). Events must be pushed in time order, by one thread at a time
+CpuProfilerThread* RegisterCpuProfilerLane(const char* name);
+
+inline CpuProfilerThread& GetCpuProfilerThread() {
+    static thread_local CpuProfilerThread* thread = nullptr;
+    if (!thread)
+        thread = RegisterCpuProfilerThread();
+
+    return *thread;
+}
+
+class CpuProfilerScope {
+public:
+    inline CpuProfilerScope(const char* name) {
+        if (g_IsCpuProfilerEnabled.load(std::memory_order_relaxed)) {
+            m_Thread = &GetCpuProfilerThread();
+            m_Thread->Push(name, GetCpuProfilerTicks());
+        }
+    }
+
+    // Closes the scope even if the profiler has been disabled in between
+    inline ~CpuProfilerScope() {
+        if (m_Thread)
+            m_Thread->Push(nullptr, GetCpuProfilerTicks());
+    }
+
+private:
+    CpuProfilerThread* m_Thread = nullptr;
+};
+
+inline bool IsCpuProfilerEnabled() {
+    return g_IsCpuProfilerEnabled.load(std::memory_order_relaxed);
+}
+
+void EnableCpuProfiler(bool enable);
+
+// Can be called before the first event (the thread is named "Thread N" otherwise)
+void SetCpuProfilerThreadName(const char* name);
+
+// Called by one thread (the frame loop)
+void MarkCpuProfilerFrame(uint32_t frameIndex);
+
+// Calibrated against "steady_clock" since the profiler has been enabled for the first time (0 if never enabled)
+double GetCpuProfilerTicksPerSecond();
+
+// Chrome trace event format: complete ("X") events per thread, frame markers as global instant events
+bool WriteCpuProfilerTrace(const char* path);
+
+// Flame graph of the last complete frame, one lane per thread
+void ShowCpuProfilerWindow(bool* isOpen = nullptr);
+
+} // namespace utils
@@ -0,0 +1,91 @@
+#pragma once
+
+// Debug allocator for "nri::AllocationCallbacks": counts allocations and bytes, validates frees and reports leaks at
+// destruction. The profiling mode additionally attributes allocations to subsystems (the innermost "ALLOCATION_SCOPE" of
+// the allocating thread), counts them per frame ("MarkAllocationFrame"), flags subsystems which allocate every frame in
+// the steady state and samples call stacks of every N-th allocation of a thread. The fast path is a thread-local tag
+// read, a countdown and plain stores into per-thread counters (no RMW atomics), call stacks are captured only for sampled
+// allocations
+
+// "tag" - "utils::AllocationTag" member name
+#define ALLOCATION_SCOPE(tag) utils::AllocationTagScope PROFILE_CONCAT(_allocationScope, __LINE__)(utils::AllocationTag::tag)
+
+namespace utils {
+
+constexpr uint32_t ALLOCATION_PROFILER_SAMPLE_INTERVAL = 256; // default, every N-th allocation of a thread (~2 us per sample)
+constexpr uint32_t ALLOCATION_PROFILER_STACK_DEPTH = 16; // frames per sampled call stack
+constexpr uint32_t ALLOCATION_PROFILER_CALL_SITE_MAX_NUM = 4096; // unique call stacks, the rest is not sampled
+constexpr uint32_t ALLOCATION_PROFILER_STEADY_FRAME_NUM = 32; // allocating in so many frames in a row is "steady state"
+constexpr uint32_t ALLOCATION_TAG_DEPTH_MAX = 16; // deeper scopes keep the tag of the deepest tracked one
+
+enum class AllocationTag : uint8_t {
+    UNKNOWN,
+    DEVICE,
+    SWAP_CHAIN,
+    STREAMER,
+    DESCRIPTOR_POOL,
+    PIPELINE,
+    RESOURCE,
+    COMMAND_BUFFER,
+    UI,
+
+    MAX_NUM
+};
+
+struct AllocationTagStats {
+    uint64_t allocationNum; // total, reallocations included
+    uint64_t allocatedSize; // bytes
+    uint64_t liveNum;
+    uint64_t liveSize;
+    uint64_t peakLiveSize; // sampled at frame marks and stats queries
+    uint64_t frameAllocationNum; // the last marked frame
+    uint64_t frameAllocatedSize;
+    uint64_t frameNum; // frames with at least one allocation
+    uint32_t steadyFrameNum; // consecutive frames with allocations, up to the last marked one
+};
+
+struct AllocationTagStack {
+    AllocationTag tags[ALLOCATION_TAG_DEPTH_MAX];
+    uint32_t depth;
+};
+
+inline thread_local AllocationTagStack t_AllocationTagStack = {};
+
+inline AllocationTag GetAllocationTag() {
+    uint32_t depth = t_AllocationTagStack.depth;
+
+    return depth ? t_AllocationTagStack.tags[(depth < ALLOCATION_TAG_DEPTH_MAX ? depth : ALLOCATION_TAG_DEPTH_MAX) - 1] : AllocationTag::UNKNOWN;
+}
+
+class AllocationTagScope {
+public:
+    inline AllocationTagScope(AllocationTag tag) {
+        uint32_t depth = t_AllocationTagStack.depth++;
+        if (depth < ALLOCATION_TAG_DEPTH_MAX)
+            t_AllocationTagStack.tags[depth] = tag;
+    }
+
+    inline ~AllocationTagScope() {
+        t_AllocationTagStack.depth--;
+    }
+};
+
+const char* GetAllocationTagName(AllocationTag tag);
+
+// All functions below expect callbacks created by "CreateDebugAllocator" and do nothing (or return zeroes) otherwise.
+// "sampleInterval" - 0 disables profiling, allocations made before enabling are not attributed
+void EnableAllocationProfiler(const nri::AllocationCallbacks& allocationCallbacks, uint32_t sampleInterval = ALLOCATION_PROFILER_SAMPLE_INTERVAL);
+bool IsAllocationProfilerEnabled(const nri::AllocationCallbacks& allocationCallbacks);
+
+// Called by one thread (the frame loop)
+void MarkAllocationFrame(const nri::AllocationCallbacks& allocationCallbacks);
+
+AllocationTagStats GetAllocationTagStats(const nri::AllocationCallbacks& allocationCallbacks, AllocationTag tag);
+
+// Subsystems, steady state offenders and the top sampled call sites (symbolized if possible). "path" - "nullptr" for stdout
+bool WriteAllocationReport(const nri::AllocationCallbacks& allocationCallbacks, const char* path);
+
+} // namespace utils
+
+void CreateDebugAllocator(nri::AllocationCallbacks& allocationCallbacks);
+void DestroyDebugAllocator(nri::AllocationCallbacks& allocationCallbacks);
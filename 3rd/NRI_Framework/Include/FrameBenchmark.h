@@ -0,0 +1,75 @@
+#pragma once
+
+// Per-frame CPU timings of the sample frame loop ("--benchmark"). "SampleBase::RenderLoop" records "PrepareFrame" and
+// "RenderFrame", "EndUI" records itself, samples add other stages (the streamer copy). Percentiles (nearest rank) skip
+// warm-up frames, the report (settings, statistics and raw per-frame timings) is written as JSON for regression tracking
+
+namespace utils {
+
+constexpr double BENCHMARK_TIME_STEP = 1.0 / 60.0; // s, the fixed time step of "headless" and "benchmark" modes
+constexpr uint32_t BENCHMARK_FRAME_NUM = 1000; // if "frameNum" is not set
+
+// Stages overlap: "UI" and "STREAMER_COPY" are parts of "PREPARE" or "RENDER" (wherever the sample calls them), "FRAME"
+// covers the whole iteration of the frame loop
+enum class FrameStage : uint8_t {
+    FRAME,
+    PREPARE,
+    UI,
+    RENDER,
+    STREAMER_COPY,
+
+    MAX_NUM
+};
+
+struct FrameStageStats {
+    double p50; // ms
+    double p95;
+    double p99;
+    double mean;
+    double min;
+    double max;
+};
+
+struct FrameBenchmarkDesc {
+    const char* name;
+    const char* graphicsAPI;
+    uint32_t width;
+    uint32_t height;
+    uint32_t warmupFrameNum; // excluded from statistics
+    bool isHeadless;
+};
+
+class FrameBenchmark {
+public:
+    inline bool IsRecording() const {
+        return m_IsRecording;
+    }
+
+    inline uint32_t GetFrameNum() const {
+        return (uint32_t)m_Frames.size();
+    }
+
+    // "frameNum" - expected number of frames (preallocation only)
+    void Begin(uint32_t frameNum);
+
+    inline void BeginFrame() {
+        if (m_IsRecording)
+            m_Frames.push_back({});
+    }
+
+    // Accumulates, a stage can be measured several times per frame. Ignored if not recording
+    inline void Add(FrameStage stage, double ms) {
+        if (m_IsRecording && !m_Frames.empty())
+            m_Frames.back()[(size_t)stage] += ms;
+    }
+
+    FrameStageStats GetStats(FrameStage stage, uint32_t warmupFrameNum) const;
+    void Print(uint32_t warmupFrameNum) const;
+    bool WriteJson(const char* path, const FrameBenchmarkDesc& desc) const;
+
+private:
+    std::vector<std::array<double, (size_t)FrameStage::MAX_NUM>> m_Frames;
+    bool m_IsRecording = false;
+};
+
+} // namespace utils
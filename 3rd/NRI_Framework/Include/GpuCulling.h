@@ -0,0 +1,56 @@
+#pragma once
+
+// C++ reference of the GPU instance culling kernel ("instanceGenBuffer.cs.hlsl") and of the Hi-Z pyramid downsampling
+// ("depthPyramid.cs.hlsl"). Both run over the same data as the GPU and use the same operation order, so the frustum
+// path matches bit for bit. Occlusion uses a perspective divide, which D3D only requires to be accurate to 2.5 ULP:
+// instances touching a Hi-Z texel edge can differ. Groups append their visible instances in dispatch order here, on
+// the GPU the order of groups is arbitrary (compare visible lists as sets). Visible instances also get a LOD by the
+// squared camera distance, each LOD has its own region of "instanceNum" visible instances and its own indirect arguments
+
+namespace utils {
+
+constexpr uint32_t GPU_CULLING_GROUP_SIZE = 64;
+constexpr uint32_t GPU_CULLING_ARGS_NUM = 6; // per LOD: "DrawIndexedDesc" + draw count
+constexpr uint32_t GPU_CULLING_LOD_MAX_NUM = MESH_LOD_MAX_NUM;
+constexpr uint32_t HIZ_GROUP_SIZE = 8;
+
+enum GpuCullingBits : uint32_t {
+    GPU_CULLING_FRUSTUM = 0x1,
+    GPU_CULLING_OCCLUSION = 0x2, // previous frame Hi-Z
+};
+
+// Mirrors "CullingConstants"
+struct GpuCullingConstants {
+    float planes[6][4]; // normalized, pointing inside
+    mat4 prevClipFromWorld; // Hi-Z camera
+    float hiZScale[2]; // depth size / 2
+    uint32_t hiZSize[2]; // mip 0
+    uint32_t hiZMipNum;
+    uint32_t instanceNum;
+    float meshRadius;
+    uint32_t flags; // GpuCullingBits
+    float cameraPosition[3];
+    uint32_t lodNum; // 0 is treated as 1
+    float lodDistancesSq[GPU_CULLING_LOD_MAX_NUM]; // see "GetMeshLodDistancesSq"
+};
+
+static_assert(sizeof(GpuCullingConstants) == 240, "Must match the HLSL constant buffer layout");
+
+// Max-reduced depth, mip 0 is half resolution (odd dimensions fold the last row / column into the previous texel)
+struct HiZPyramid {
+    std::vector<std::vector<float>> mips;
+    std::vector<uint32_t> widths;
+    std::vector<uint32_t> heights;
+};
+
+uint32_t GetHiZMipNum(uint32_t depthWidth, uint32_t depthHeight);
+void BuildHiZPyramid(const float* depth, uint32_t depthWidth, uint32_t depthHeight, HiZPyramid& pyramid);
+
+// "transforms" - instance transforms as uploaded to the GPU, only the translation is used.
+// "visibleInstances" - "lodNum * instanceNum" entries.
+// "indirectArgs" - "lodNum * GPU_CULLING_ARGS_NUM" entries initialized as the GPU buffer ("instanceNum" and draw count = 0).
+// "hiZ" is needed only for "GPU_CULLING_OCCLUSION"
+void CullInstancesReference(const GpuCullingConstants& constants, const InstanceTransform* transforms, const HiZPyramid* hiZ, uint32_t* visibleInstances,
+    uint32_t* indirectArgs);
+
+} // namespace utils
@@ -0,0 +1,107 @@
+#pragma once
+
+// GPU timestamp profiler. Every frame in flight owns a timestamp query pool and a slot in a readback buffer. Ranges
+// (annotation + 2 timestamps) are recorded between "BeginFrame" and "EndFrame", the queries are copied into the slot at
+// the end of the frame and read back when the slot is reused, i.e. after the frame fence has already been waited: no
+// stalls. Resolved ranges feed per-range statistics and a "GPU" lane of the CPU profiler. NRI doesn't expose calibrated
+// CPU / GPU timestamps, so GPU time is placed on the CPU timeline using "the GPU can't start a frame before its
+// submission" (the tightest such offset over all frames). A profiler serves one queue: timestamps of different queues
+// are not comparable, and the queries of a frame are reset, written and copied on the same queue. Use a profiler per queue
+
+namespace utils {
+
+constexpr uint32_t GPU_PROFILER_RANGE_MAX_NUM = 128; // per frame, ranges above the limit are not measured
+constexpr uint32_t GPU_PROFILER_HISTORY_NUM = 64; // frames in statistics
+
+struct GpuRangeStats {
+    const char* name;
+    uint32_t depth;
+    double time; // ms, the last resolved frame
+    double average; // ms, over the last "GPU_PROFILER_HISTORY_NUM" frames the range was seen in
+    double max;
+
+    // Private
+    double history[GPU_PROFILER_HISTORY_NUM];
+    uint32_t historyNum;
+};
+
+class GpuProfiler {
+public:
+    // "laneName" - of the CPU profiler lane, must stay alive
+    bool Initialize(const nri::CoreInterface& NRI, const nri::HelperInterface& helperInterface, nri::Device& device, uint32_t frameInFlightNum, const char* laneName = "GPU");
+    void Destroy(const nri::CoreInterface& NRI);
+
+    // "commandBuffer" - the first command buffer of the frame on the queue. Resolves the frame which used the same slot, its fence must
+    // have been waited for
+    void BeginFrame(const nri::CoreInterface& NRI, nri::CommandBuffer& commandBuffer, uint32_t frameIndex);
+
+    // "commandBuffer" - the last command buffer of the frame on the queue (submitted after all others)
+    void EndFrame(const nri::CoreInterface& NRI, nri::CommandBuffer& commandBuffer);
+
+    // Ranges can span several command buffers of the queue, but must be properly nested. Returns "range" for "EndRange"
+    uint32_t BeginRange(const nri::CoreInterface& NRI, nri::CommandBuffer& commandBuffer, const char* name);
+    void EndRange(const nri::CoreInterface& NRI, nri::CommandBuffer& commandBuffer, uint32_t range);
+
+    // The CPU part of the resolve, public to be fed with synthetic timestamps (the NONE backend has no readback).
+    // "timestamps" - 2 per range (begin, end) in recording order of "frameIndex" ranges, in GPU ticks
+    void ResolveFrame(uint32_t frameIndex, const uint64_t* timestamps, double timestampFrequencyHz);
+
+    // Sorted by the first appearance
+    inline const std::vector<GpuRangeStats>& GetStats() const {
+        return m_Stats;
+    }
+
+    inline uint32_t GetResolvedFrameNum() const {
+        return m_ResolvedFrameNum;
+    }
+
+private:
+    struct Range {
+        const char* name;
+        uint32_t depth;
+    };
+
+    struct Frame {
+        nri::QueryPool* queryPool;
+        std::vector<Range> ranges;
+        uint64_t submitTicks; // CPU profiler ticks at "EndFrame"
+        uint32_t frameIndex;
+        bool isPending; // recorded, not resolved yet
+    };
+
+    std::vector<Frame> m_Frames;
+    std::vector<GpuRangeStats> m_Stats;
+    nri::Buffer* m_ReadbackBuffer = nullptr;
+    nri::Memory* m_ReadbackMemory = nullptr;
+    CpuProfilerThread* m_Lane = nullptr;
+    const char* m_LaneName = nullptr;
+    double m_TimestampFrequencyHz = 0.0;
+    double m_Offset = 0.0; // CPU profiler ticks = GPU ticks * ratio + offset
+    uint32_t m_CurrentFrame = 0;
+    uint32_t m_Depth = 0;
+    uint32_t m_ResolvedFrameNum = 0;
+    bool m_HasOffset = false;
+};
+
+// "helper::Annotation" with timestamps
+class GpuProfilerScope {
+public:
+    inline GpuProfilerScope(const nri::CoreInterface& NRI, nri::CommandBuffer& commandBuffer, GpuProfiler& profiler, const char* name)
+        : m_NRI(NRI), m_CommandBuffer(commandBuffer), m_Profiler(profiler) {
+        m_NRI.CmdBeginAnnotation(m_CommandBuffer, name, nri::BGRA_UNUSED);
+        m_Range = m_Profiler.BeginRange(m_NRI, m_CommandBuffer, name);
+    }
+
+    inline ~GpuProfilerScope() {
+        m_Profiler.EndRange(m_NRI, m_CommandBuffer, m_Range);
+        m_NRI.CmdEndAnnotation(m_CommandBuffer);
+    }
+
+private:
+    const nri::CoreInterface& m_NRI;
+    nri::CommandBuffer& m_CommandBuffer;
+    GpuProfiler& m_Profiler;
+    uint32_t m_Range;
+};
+
+} // namespace utils
@@ -0,0 +1,70 @@
+#pragma once
+
+// CPU frustum culling of instances. Bounds are stored as SoA, 8 instances are tested per AVX2 iteration (selected at
+// run-time, scalar otherwise) and visible indices are compacted with a permutation table. Large arrays are split into
+// blocks culled in parallel on the shared "JobSystem"
+
+namespace utils {
+
+constexpr uint32_t INSTANCE_CULLING_BLOCK_SIZE = 16 * 1024; // multiple of 8
+constexpr uint32_t INSTANCE_CULLING_PARALLEL_MIN_NUM = 64 * 1024; // ~150 us with AVX2, smaller arrays are culled on the calling thread
+
+// Spheres or boxes (center + half extents), arrays are padded to a multiple of 8
+struct InstanceBounds {
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius; // sphere radius or the box bounding sphere radius
+    std::vector<float> extentX; // empty if there are no boxes
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+    uint32_t instanceNum = 0;
+
+    void Resize(uint32_t num, bool hasBoxes);
+
+    inline void SetSphere(uint32_t i, const float center[3], float r) {
+        centerX[i] = center[0];
+        centerY[i] = center[1];
+        centerZ[i] = center[2];
+        radius[i] = r;
+    }
+
+    inline void SetBox(uint32_t i, const float center[3], const float extent[3]) {
+        SetSphere(i, center, sqrtf(extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]));
+        extentX[i] = extent[0];
+        extentY[i] = extent[1];
+        extentZ[i] = extent[2];
+    }
+};
+
+struct InstanceCullingDesc {
+    const InstanceBounds* bounds;
+    mat4 clipFromWorld;
+    uint32_t* visibleInstances; // "bounds->instanceNum" entries, gets ascending indices of visible instances
+    nri::DrawIndexedDesc* drawArgs; // optional, only "instanceNum" is overwritten. The layout matches indirect arguments
+    bool useBoxes; // requires extents
+    bool disableSimd; // scalar reference
+    uint32_t threadNum; // 0 - all "JobSystem" threads, 1 - no worker threads
+};
+
+// Accumulated over calls
+struct InstanceCullingStats {
+    uint64_t testedNum;
+    uint64_t visibleNum;
+    double time; // ms
+
+    inline double GetInstancesPerSecond() const {
+        return time > 0.0 ? testedNum * 1000.0 / time : 0.0;
+    }
+
+    inline double GetVisibleFraction() const {
+        return testedNum ? double(visibleNum) / double(testedNum) : 0.0;
+    }
+};
+
+// Returns the number of visible instances
+uint32_t CullInstances(const InstanceCullingDesc& desc, InstanceCullingStats& stats);
+
+bool IsInstanceCullingSimd();
+
+} // namespace utils
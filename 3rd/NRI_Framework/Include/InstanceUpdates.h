@@ -0,0 +1,80 @@
+#pragma once
+
+// Dirty instance tracking: the CPU keeps instance transforms as compact 3x4 matrices, changes are marked in a bit set and
+// gathered into a list of (transform, index) updates, which "instanceScatter.cs.hlsl" writes into the GPU copy. Static
+// instances cost nothing per frame. Gathering only visits 64-instance words which got dirty, not the whole bit set
+
+namespace utils {
+
+constexpr uint32_t INSTANCE_SCATTER_GROUP_SIZE = 64;
+
+// Row-major affine transform, "rows[i][3]" - translation. Mirrors "InstanceTransform"
+struct InstanceTransform {
+    float rows[3][4];
+};
+
+// Mirrors "InstanceUpdate"
+struct InstanceUpdate {
+    InstanceTransform transform;
+    uint32_t index;
+};
+
+static_assert(sizeof(InstanceTransform) == 48, "Must match the HLSL structure");
+static_assert(sizeof(InstanceUpdate) == 52, "Must match the HLSL structure");
+
+// Accumulated over "GatherUpdates" calls
+struct InstanceUpdateStats {
+    uint64_t updateNum;
+    uint64_t uploadedBytes; // updates passed to the GPU
+    uint64_t writtenBytes; // transforms written by the scatter shader
+    double time; // ms, gathering only
+    uint32_t gatherNum;
+
+    inline double GetBytesPerFrame() const {
+        return gatherNum ? double(uploadedBytes + writtenBytes) / gatherNum : 0.0;
+    }
+
+    inline double GetTimePerFrame() const {
+        return gatherNum ? time / gatherNum : 0.0;
+    }
+};
+
+class DirtyInstanceTracker {
+public:
+    // All instances get identity transforms and are clean, i.e. the initial GPU copy is uploaded separately
+    void Initialize(uint32_t instanceNum);
+
+    void SetTransform(uint32_t index, const InstanceTransform& transform);
+    void SetTranslation(uint32_t index, float x, float y, float z);
+
+    // Marks "[first, first + num)" as changed
+    void MarkDirty(uint32_t first, uint32_t num = 1);
+
+    // Writes up to "maxNum" updates in ascending index order and clears their dirty bits, the rest stays dirty for the
+    // next call. Returns the number of updates
+    uint32_t GatherUpdates(InstanceUpdate* updates, uint32_t maxNum, InstanceUpdateStats& stats);
+
+    inline const InstanceTransform& GetTransform(uint32_t index) const {
+        return m_Transforms[index];
+    }
+
+    inline const InstanceTransform* GetTransforms() const {
+        return m_Transforms.data();
+    }
+
+    inline uint32_t GetInstanceNum() const {
+        return (uint32_t)m_Transforms.size();
+    }
+
+    inline uint32_t GetDirtyNum() const {
+        return m_DirtyNum;
+    }
+
+private:
+    std::vector<InstanceTransform> m_Transforms;
+    std::vector<uint64_t> m_DirtyBits; // bit per instance
+    std::vector<uint32_t> m_DirtyWords; // indices of non-zero words in "m_DirtyBits", unordered
+    uint32_t m_DirtyNum = 0;
+};
+
+} // namespace utils
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Persistent worker pool for data parallel loops (culling, transform levels, UI geometry, meshlets, LODs). Workers are
+// created once and sleep on a condition variable between loops, the calling thread takes tasks too. A loop issued from
+// a worker or while another loop is in flight runs serially on the calling thread, i.e. loops never wait for each other.
+// Waking workers costs ~10-50 us per loop, callers keep small inputs serial (see "*_PARALLEL_MIN_NUM" constants).
+// Asynchronous tasks ("Submit", asset decoding) share the same workers, loops are picked up first
+
+namespace utils {
+
+struct JobSystemDesc {
+    uint32_t workerNum = 0; // 0 - "hardware_concurrency - 1"
+};
+
+// Gets a task index in [0; taskNum)
+typedef std::function<void(uint32_t taskIndex)> ParallelForFunc;
+
+typedef std::function<void()> TaskFunc;
+
+class JobSystem {
+public:
+    ~JobSystem();
+
+    void Initialize(const JobSystemDesc& desc);
+    void Shutdown();
+
+    // Returns when all tasks are done. "threadNum" - 0 for all threads, 1 - serial (the calling thread included)
+    void ParallelFor(uint32_t taskNum, uint32_t threadNum, const ParallelForFunc& func);
+
+    // Returns immediately, "task" runs on a worker (FIFO). A worker busy with a task doesn't join loops until it's done.
+    // Without workers the task runs on the calling thread. "Shutdown" runs the queued tasks first
+    void Submit(TaskFunc&& task);
+
+    // On a worker of any job system: waiting there for submitted tasks can deadlock (all workers may be waiting), such
+    // work should run inline
+    static bool IsWorkerThread();
+
+    // Workers + the calling thread
+    inline uint32_t GetThreadNum() const {
+        return (uint32_t)m_Workers.size() + 1;
+    }
+
+    // Initialized with defaults on the first call, if not initialized explicitly before
+    static JobSystem& GetShared();
+
+private:
+    struct Loop;
+
+    void WorkerThread();
+    static void Execute(Loop& loop);
+
+private:
+    std::vector<std::thread> m_Workers;
+    std::deque<TaskFunc> m_Tasks; // submitted, not started yet
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkerCondition;
+    std::condition_variable m_DoneCondition;
+    Loop* m_Loop = nullptr; // in flight
+    bool m_IsStopping = false;
+    bool m_IsInitialized = false;
+};
+
+} // namespace utils
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <memory>
+
+namespace utils {
+
+// KTX2 container without transcoding (Basis payloads are not supported): "Open" parses only the header and the
+// level index, mips are read on demand by file offset into a single arena allocated for the whole mip chain.
+// Zstd-supercompressed levels are decompressed on "AssetLoader" threads (if provided)
+class Ktx2Texture {
+public:
+    Ktx2Texture() = default;
+    Ktx2Texture(const Ktx2Texture&) = delete;
+    Ktx2Texture& operator=(const Ktx2Texture&) = delete;
+    ~Ktx2Texture();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    // Loaded mips stay, further reads fail
+    void CloseFile();
+
+    // Reads mips "[mipOffset; mipOffset + mipNum)", already loaded mips are skipped. The file stays open for further reads.
+    // "assetLoader" is ignored on job system workers (levels are decompressed inline), waiting there can deadlock
+    bool ReadMips(uint32_t mipOffset, uint32_t mipNum, AssetLoader* assetLoader = nullptr);
+
+    inline bool Read(AssetLoader* assetLoader = nullptr) {
+        return ReadMips(0, m_MipNum, assetLoader);
+    }
+
+    // "layerIndex" enumerates faces within layers ("layer * faceNum + face")
+    void GetSubresource(nri::TextureSubresourceUploadDesc& subresource, uint32_t mipIndex, uint32_t layerIndex = 0) const;
+
+    inline bool IsMipLoaded(uint32_t mipIndex) const {
+        return m_Levels[mipIndex].isLoaded;
+    }
+
+    inline nri::Format GetFormat() const {
+        return m_Format;
+    }
+
+    inline uint32_t GetWidth() const {
+        return m_Width;
+    }
+
+    inline uint32_t GetHeight() const {
+        return m_Height;
+    }
+
+    inline uint32_t GetDepth() const {
+        return m_Depth;
+    }
+
+    inline uint32_t GetLayerNum() const {
+        return m_LayerNum * m_FaceNum;
+    }
+
+    inline uint32_t GetFaceNum() const {
+        return m_FaceNum;
+    }
+
+    inline uint32_t GetMipNum() const {
+        return m_MipNum;
+    }
+
+    inline const std::string& GetName() const {
+        return m_Name;
+    }
+
+private:
+    struct Level {
+        uint64_t fileOffset;
+        uint64_t fileSize; // compressed, if supercompressed
+        uint64_t arenaOffset;
+        uint64_t size;
+        uint32_t rowPitch;
+        uint32_t slicePitch;
+        bool isLoaded;
+    };
+
+    std::string m_Name;
+    std::vector<Level> m_Levels;
+    std::unique_ptr<uint8_t[]> m_Arena;
+    uint64_t m_ArenaSize = 0;
+    FILE* m_File = nullptr;
+    nri::Format m_Format = nri::Format::UNKNOWN;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    uint32_t m_Depth = 0;
+    uint32_t m_LayerNum = 0;
+    uint32_t m_FaceNum = 0;
+    uint32_t m_MipNum = 0;
+    uint32_t m_Supercompression = 0;
+};
+
+} // namespace utils
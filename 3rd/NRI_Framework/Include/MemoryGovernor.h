@@ -0,0 +1,134 @@
+#pragma once
+
+// Memory governor: tracks "nri::Memory" by segment and category, polls "QueryVideoMemoryInfo" on a cadence (the query
+// is not free, DXGI creates a factory per call) and fires pressure callbacks in priority order when the estimated usage
+// crosses "targetUsage" of the budget, i.e. before going over it. Between polls usage is estimated as "polled usage +
+// tracked delta since the poll", tracked memory is a lower bound. The NONE backend reports a zero budget (= unknown, no
+// pressure), "simulatedBudget" replaces the OS budget to exercise callbacks without a GPU. Not thread safe
+
+namespace utils {
+
+constexpr uint32_t MEMORY_GOVERNOR_POLL_INTERVAL = 30; // frames, default
+
+// As in "QueryVideoMemoryInfo": "DEVICE" and "DEVICE_UPLOAD" are local, "HOST_UPLOAD" and "HOST_READBACK" are system
+enum class MemorySegment : uint8_t {
+    LOCAL,
+    SYSTEM,
+
+    MAX_NUM
+};
+
+enum class MemoryCategory : uint8_t {
+    TEXTURES,
+    GEOMETRY,
+    STREAMER,
+    TRANSIENT, // render targets, per frame buffers, readback
+    OTHER,
+
+    MAX_NUM
+};
+
+struct MemoryGovernorDesc {
+    uint64_t simulatedBudget[(size_t)MemorySegment::MAX_NUM] = {}; // 0 - the OS budget
+    uint32_t pollInterval = MEMORY_GOVERNOR_POLL_INTERVAL;
+    float targetUsage = 0.9f; // callbacks release memory above "budget * targetUsage"
+    float restoreUsage = 0.75f; // callbacks are told to revert downgrades below "budget * restoreUsage"
+};
+
+struct MemoryPressure {
+    MemorySegment segment;
+    uint64_t releaseSize; // bytes to release to get under the target, 0 - the pressure is gone, downgrades can be reverted
+    uint64_t budgetSize;
+    uint64_t usageSize; // estimated, including the size of the pending allocation
+};
+
+// Returns released bytes (or bytes which will be released in a frame or two, like evicted mips). Promised bytes are not
+// subtracted from the usage, callbacks don't fire again until "Resize" or "Untrack" delivers them (or frames in flight end)
+typedef uint64_t (*MemoryPressureCallback)(const MemoryPressure& pressure, void* userArg);
+
+struct MemorySegmentStats {
+    uint64_t budgetSize; // simulated or the last polled, 0 - unknown
+    uint64_t polledUsageSize; // the last poll
+    uint64_t usageSize; // estimated
+    uint64_t trackedSize;
+    uint64_t categorySizes[(size_t)MemoryCategory::MAX_NUM];
+    uint64_t releasedSize; // reported by callbacks, total
+    uint64_t pendingReleaseSize; // reported by callbacks, but not untracked yet (forgotten after "BUFFERED_FRAME_MAX_NUM + 1" frames)
+    uint32_t pressureNum; // checks which fired callbacks
+    bool isUnderPressure; // callbacks fired, usage has not dropped below "restoreUsage" yet
+    bool isOverBudget; // callbacks couldn't release enough at the last check
+};
+
+class MemoryGovernor {
+public:
+    void Initialize(const nri::CoreInterface& NRI, const nri::HelperInterface& helperInterface, nri::Device& device, const MemoryGovernorDesc& desc);
+
+    // Lower "priority" fires first: invisible releases (caches) before visible downgrades (top mips). Restoring goes in
+    // the reverse order. "name" must outlive the governor
+    void AddPressureCallback(MemorySegment segment, uint32_t priority, MemoryPressureCallback callback, void* userArg, const char* name);
+
+    // Returns a handle for "Resize" and "Untrack"
+    uint32_t Track(nri::MemoryLocation memoryLocation, MemoryCategory category, uint64_t size);
+    void Resize(uint32_t allocation, uint64_t size);
+    void Untrack(uint32_t allocation);
+
+    // Fires callbacks if "size" more bytes would cross the target. Returns "false" if the budget would still be exceeded
+    bool MakeRoom(nri::MemoryLocation memoryLocation, uint64_t size);
+
+    // "HelperInterface::AllocateAndBindMemory" preceded by "MakeRoom" and followed by "Track" (the sum of memory descs,
+    // i.e. not including the padding of the underlying allocator). "memories" - "CalculateAllocationNumber" entries
+    nri::Result AllocateAndBindMemory(const nri::ResourceGroupDesc& resourceGroupDesc, MemoryCategory category, nri::Memory** memories);
+
+    // Call once per frame: polls every "pollInterval" frames (the first call included) and checks the budget of polled
+    // segments, i.e. callbacks fire at most once per poll (unless "MakeRoom" is called)
+    void Update();
+
+    // Overrides "MemoryGovernorDesc::simulatedBudget" (0 - the OS budget), applied at the next poll
+    inline void SetSimulatedBudget(MemorySegment segment, uint64_t budgetSize) {
+        m_Desc.simulatedBudget[(size_t)segment] = budgetSize;
+    }
+
+    inline const MemorySegmentStats& GetStats(MemorySegment segment) const {
+        return m_Stats[(size_t)segment];
+    }
+
+    inline static MemorySegment GetSegment(nri::MemoryLocation memoryLocation) {
+        return memoryLocation == nri::MemoryLocation::DEVICE || memoryLocation == nri::MemoryLocation::DEVICE_UPLOAD ? MemorySegment::LOCAL : MemorySegment::SYSTEM;
+    }
+
+    static const char* GetCategoryName(MemoryCategory category);
+
+private:
+    struct Allocation {
+        uint64_t size;
+        MemorySegment segment;
+        MemoryCategory category;
+    };
+
+    struct Callback {
+        MemoryPressureCallback callback;
+        void* userArg;
+        const char* name;
+        uint32_t priority;
+        MemorySegment segment;
+    };
+
+    void Poll();
+    void UpdateUsage(MemorySegment segment);
+    bool Check(MemorySegment segment, uint64_t size);
+
+private:
+    std::vector<Allocation> m_Allocations;
+    std::vector<uint32_t> m_FreeAllocations;
+    std::vector<Callback> m_Callbacks; // sorted by priority
+    std::array<MemorySegmentStats, (size_t)MemorySegment::MAX_NUM> m_Stats = {};
+    std::array<uint64_t, (size_t)MemorySegment::MAX_NUM> m_TrackedSizeAtPoll = {};
+    std::array<uint32_t, (size_t)MemorySegment::MAX_NUM> m_PendingReleaseFrames = {}; // until "pendingReleaseSize" is forgotten
+    MemoryGovernorDesc m_Desc = {};
+    const nri::CoreInterface* m_NRI = nullptr;
+    const nri::HelperInterface* m_HelperInterface = nullptr;
+    nri::Device* m_Device = nullptr;
+    uint32_t m_FramesSincePoll = 0;
+};
+
+} // namespace utils
@@ -0,0 +1,73 @@
+#pragma once
+
+// Mesh optimization for imported meshes: welding, degenerate triangle removal, post-transform cache order (Forsyth),
+// overdraw-aware cluster order (Tipsify-style: cache-friendly clusters sorted front to back by an outward facing
+// heuristic) and vertex fetch order. Indices are mesh-local
+
+namespace utils {
+
+constexpr uint32_t VERTEX_CACHE_ANALYSIS_SIZE = 16; // FIFO
+constexpr float OVERDRAW_THRESHOLD = 1.05f; // max ACMR degradation allowed by cluster splitting
+
+struct VertexCacheStats {
+    float acmr; // transformed vertices per triangle (0.5 - 3)
+    float atvr; // transformed vertices per vertex (1 - ideal)
+    uint32_t transformedVertexNum;
+};
+
+// Accumulated over meshes. "Before" and "after" are measured on the same triangles and vertices (welded, without
+// degenerate triangles), in the original and in the optimized order
+struct MeshOptimizerStats {
+    uint64_t triangleNum; // without degenerate triangles
+    uint64_t degenerateTriangleNum; // removed
+    uint64_t vertexNum; // after welding
+    uint64_t weldedVertexNum; // removed duplicates and unreferenced vertices
+    uint64_t transformedVertexNumBefore;
+    uint64_t transformedVertexNumAfter;
+    uint32_t meshNum;
+    uint32_t index16MeshNum; // meshes fitting "IndexType::UINT16"
+    double time; // ms
+
+    inline VertexCacheStats GetBefore() const {
+        return {float(transformedVertexNumBefore) / float(triangleNum), float(transformedVertexNumBefore) / float(vertexNum), (uint32_t)transformedVertexNumBefore};
+    }
+
+    inline VertexCacheStats GetAfter() const {
+        return {float(transformedVertexNumAfter) / float(triangleNum), float(transformedVertexNumAfter) / float(vertexNum), (uint32_t)transformedVertexNumAfter};
+    }
+
+    inline double GetTrianglesPerSecond() const {
+        return time > 0.0 ? triangleNum * 1000.0 / time : 0.0;
+    }
+};
+
+VertexCacheStats AnalyzeVertexCache(const Index* indices, uint32_t indexNum, uint32_t vertexNum, uint32_t cacheSize = VERTEX_CACHE_ANALYSIS_SIZE);
+
+// Bitwise identical vertices are merged, returns the new vertex count
+uint32_t WeldVertices(UnpackedVertex* vertices, uint32_t vertexNum, Index* indices, uint32_t indexNum);
+
+// Triangles with repeated indices (for example, after welding) or zero area are removed, the order is kept. Returns the
+// new index count
+uint32_t RemoveDegenerateTriangles(Index* indices, uint32_t indexNum, const UnpackedVertex* vertices);
+
+void OptimizeVertexCache(Index* indices, uint32_t indexNum, uint32_t vertexNum);
+void OptimizeOverdraw(Index* indices, uint32_t indexNum, const UnpackedVertex* vertices, uint32_t vertexNum, float threshold = OVERDRAW_THRESHOLD);
+
+// Vertices are reordered by first use, unreferenced vertices are dropped. Returns the new vertex count
+uint32_t OptimizeVertexFetch(UnpackedVertex* vertices, uint32_t vertexNum, Index* indices, uint32_t indexNum);
+
+// All of the above, "vertices" is shrunk. Returns the new index count. Stats are accumulated
+uint32_t OptimizeMesh(std::vector<UnpackedVertex>& vertices, Index* indices, uint32_t indexNum, MeshOptimizerStats& stats);
+
+inline nri::IndexType GetIndexType(uint32_t vertexNum) {
+    return vertexNum <= 65536 ? nri::IndexType::UINT16 : nri::IndexType::UINT32;
+}
+
+inline uint32_t GetIndexSize(nri::IndexType indexType) {
+    return indexType == nri::IndexType::UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+// "dst" must have "indexNum * GetIndexSize(indexType)" bytes
+void ConvertIndices(const Index* indices, uint32_t indexNum, nri::IndexType indexType, void* dst);
+
+} // namespace utils
@@ -0,0 +1,46 @@
+#pragma once
+
+// Quadric error metric simplification (Garland-Heckbert) with attribute weights. Only half-edge collapses are used,
+// so all LODs of a mesh index the same vertices. Vertices sharing a position with another vertex (UV / normal seams)
+// are locked, borders are preserved by boundary quadrics
+
+namespace utils {
+
+constexpr uint32_t MESH_LOD_MAX_NUM = 8;
+
+struct MeshSimplifierDesc {
+    uint32_t lodNum = 4; // including LOD 0
+    float reductionPerLod = 0.5f; // triangle count ratio between neighboring LODs
+    float maxError = 0.05f; // relative to the mesh radius
+    float normalWeight = 0.5f;
+    float uvWeight = 0.5f;
+};
+
+// Accumulated over meshes
+struct MeshSimplifierStats {
+    uint64_t triangleNum[MESH_LOD_MAX_NUM];
+    float maxError[MESH_LOD_MAX_NUM]; // relative to the mesh radius
+    uint32_t meshNum;
+    double time; // ms
+
+    inline double GetTrianglesPerSecond() const {
+        return time > 0.0 ? triangleNum[0] * 1000.0 / time : 0.0;
+    }
+};
+
+// Returns the number of indices written to "dst" (can be "indexNum" long). "error" gets the object space deviation
+uint32_t SimplifyMesh(const UnpackedVertex* vertices, uint32_t vertexNum, const Index* indices, uint32_t indexNum, uint32_t targetIndexNum, float maxError,
+    const MeshSimplifierDesc& desc, Index* dst, float& error);
+
+// Fills "Mesh::lodOffset / lodNum", LOD indices are appended to "Scene::indices". Meshes are processed in parallel,
+// 0 - all "JobSystem" threads
+void BuildSceneLods(Scene& scene, const MeshSimplifierDesc& desc, MeshSimplifierStats& stats, uint32_t threadNum = 0);
+
+// The coarsest LOD with a projected error below "maxPixelError" for an instance at "position"
+uint32_t SelectMeshLod(const Scene& scene, const Mesh& mesh, const vec3& position, const CameraState& camera, float viewportHeight, float maxPixelError = 1.0f);
+
+// The same selection as distance thresholds for the GPU (see "GpuCullingConstants::lodDistancesSq"): LOD "i" is used
+// from "distancesSq[i]" on. "maxPixelError = 0" disables LODs
+void GetMeshLodDistancesSq(const MeshLod* lods, uint32_t lodNum, float viewToClip11, float viewportHeight, float maxPixelError, float* distancesSq);
+
+} // namespace utils
@@ -0,0 +1,43 @@
+#pragma once
+
+// Meshlet building and cluster culling. Meshlets are grown greedily over shared vertices (the next triangle adds the
+// fewest vertices and is the closest to the meshlet centroid), which keeps them spatially coherent. Each meshlet gets
+// a bounding sphere and a normal cone: the cluster is back-facing if "dot(center - camera, coneAxis) >=
+// coneCutoff * length(center - camera) + radius"
+
+namespace utils {
+
+constexpr uint32_t MESHLET_MAX_VERTEX_NUM = 64;
+constexpr uint32_t MESHLET_MAX_PRIMITIVE_NUM = 124;
+
+struct MeshletCullingStats {
+    uint64_t testedNum; // meshlets x instances x frames
+    uint64_t frustumCulledNum;
+    uint64_t coneCulledNum;
+    double time; // ms
+
+    inline double GetCulledFraction() const {
+        return testedNum ? double(frustumCulledNum + coneCulledNum) / double(testedNum) : 0.0;
+    }
+};
+
+// Appends meshlets of one mesh, "meshletVertices" get mesh-local vertex indices
+void BuildMeshlets(const UnpackedVertex* vertices, const Index* indices, uint32_t indexNum, std::vector<Meshlet>& meshlets, std::vector<MeshletBounds>& meshletBounds,
+    std::vector<uint32_t>& meshletVertices, std::vector<uint32_t>& meshletPrimitives);
+
+// All meshes of "scene" ("Mesh::meshletOffset / meshletNum" are filled), large meshes are split into chunks built in parallel.
+// 0 - all "JobSystem" threads
+void BuildSceneMeshlets(Scene& scene, uint32_t threadNum = 0);
+
+// "planes" - normalized, pointing inside
+void ExtractFrustumPlanes(const mat4& clipFromWorld, float planes[6][4]);
+
+// Meshlets of a translated-only instance. Returns the number of visible meshlets written to "visibleMeshlets" (optional)
+uint32_t CullMeshlets(const MeshletBounds* meshletBounds, uint32_t meshletNum, const float instancePosition[3], const float planes[6][4], const float cameraPosition[3],
+    MeshletCullingStats& stats, uint32_t* visibleMeshlets = nullptr);
+
+// Headless: "frameNum" frames of a camera path over "instanceNum" instances of "meshIndex" (see "tools/Benchmarks.cpp")
+MeshletCullingStats SimulateMeshletCulling(const Scene& scene, uint32_t meshIndex, const vec4* instancePositions, uint32_t instanceNum,
+    const mat4* clipFromWorld, const vec3* cameraPositions, uint32_t frameNum);
+
+} // namespace utils
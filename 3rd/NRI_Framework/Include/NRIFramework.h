@@ -9,6 +9,7 @@
 #define NRI_FRAMEWORK 1
 
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -22,12 +23,14 @@
 // NRI: core & common extensions
 #include "NRI.h"
 
+#include "Extensions/NRICapture.h"
 #include "Extensions/NRIDeviceCreation.h"
 #include "Extensions/NRIHelper.h"
 #include "Extensions/NRILowLatency.h"
 #include "Extensions/NRIMeshShader.h"
 #include "Extensions/NRIRayTracing.h"
 #include "Extensions/NRIResourceAllocator.h"
+#include "Extensions/NRIStats.h"
 #include "Extensions/NRIStreamer.h"
 #include "Extensions/NRISwapChain.h"
 #include "Extensions/NRIUpscaler.h"
@@ -44,6 +47,27 @@
 #include "Helper.h"
 #include "Timer.h"
 #include "Utils.h"
+#include "TextureResidency.h"
+#include "AssetLoader.h"
+#include "JobSystem.h"
+#include "Ktx2.h"
+#include "TextureTable.h"
+#include "SceneCache.h"
+#include "VertexPacking.h"
+#include "MeshOptimizer.h"
+#include "Meshlets.h"
+#include "MeshSimplifier.h"
+#include "InstanceCulling.h"
+#include "InstanceUpdates.h"
+#include "GpuCulling.h"
+#include "TransformHierarchy.h"
+#include "AnimationSampler.h"
+#include "UiGeometry.h"
+#include "FrameBenchmark.h"
+#include "CpuProfiler.h"
+#include "GpuProfiler.h"
+#include "DebugAllocator.h"
+#include "MemoryGovernor.h"
 
 // Settings
 constexpr nri::VKBindingOffsets VK_BINDING_OFFSETS = { 100, 200, 300, 400 }; // just ShaderMake defaults for simplicity
@@ -52,8 +76,10 @@ constexpr uint32_t DEFAULT_MEMORY_ALIGNMENT = 16;
 constexpr uint32_t BUFFERED_FRAME_MAX_NUM = 2;
 constexpr uint32_t SWAP_CHAIN_TEXTURE_NUM = 2;
 
-struct NRIInterface : public nri::CoreInterface,
+struct NRIInterface : public nri::CaptureInterface,
+					  public nri::CoreInterface,
 					  public nri::HelperInterface,
+					  public nri::StatsInterface,
 					  public nri::StreamerInterface,
 					  public nri::SwapChainInterface {};
 
@@ -79,9 +105,11 @@ public:
 	virtual bool Initialize(nri::GraphicsAPI graphicsAPI) = 0;
 	bool InitUI(const nri::CoreInterface &NRI, const nri::HelperInterface &helperInterface, nri::Device &device, nri::Format renderTargetFormat);
 
-	// Wait before input (wait for latency and/or queued frames)
+	// Wait before input (wait for latency and/or queued frames). Overrides should call it to keep "--fpsLimit" working
 	virtual void LatencySleep(uint32_t frameIndex) {
 		(void)frameIndex;
+
+		m_Timer.WaitForFrameLimit();
 	}
 
 	// Prepare
@@ -90,6 +118,9 @@ public:
 	//      Imgui::
 	void EndUI(const nri::StreamerInterface &streamerInterface, nri::Streamer &streamer);
 
+	// Counters of the last ended stats frame ("DeviceCreationDesc::enableNRIStats"), call between "BeginUI" and "EndUI"
+	void ShowFrameStatsUI(const nri::StatsInterface &statsInterface, const nri::Device &device);
+
 	// Render
 	virtual void RenderFrame(uint32_t frameIndex) = 0;
 	void RenderUI(const nri::CoreInterface &NRI, const nri::StreamerInterface &streamerInterface, nri::Streamer &streamer, nri::CommandBuffer &commandBuffer, float sdrScale, bool isSrgb);
@@ -138,6 +169,19 @@ public:
 		return m_NRIWindow;
 	}
 
+	// No window, NONE graphics API
+	inline bool IsHeadless() const {
+		return m_IsHeadless;
+	}
+
+	// Fixed time step, scripted camera path, per-frame timings
+	inline bool IsBenchmark() const {
+		return m_IsBenchmark;
+	}
+
+	// In seconds. Advances by "BENCHMARK_TIME_STEP" per frame in "headless" and "benchmark" modes
+	double GetTime() const;
+
 	void GetCameraDescFromInputDevices(CameraDesc &cameraDesc);
 
 	static void EnableMemoryLeakDetection(uint32_t breakOnAllocationIndex);
@@ -148,23 +192,37 @@ protected:
 	GLFWwindow *m_Window = nullptr;
 	Camera m_Camera;
 	Timer m_Timer;
+	utils::FrameBenchmark m_FrameBenchmark;
 	std::pair<uint32_t, uint32_t> m_OutputResolution = { 900, 600 };
 	std::pair<uint32_t, uint32_t> m_WindowResolution = {};
 	uint8_t m_VsyncInterval = 0;
 	uint32_t m_DpiMode = 0;
+	uint32_t m_DebugNRISampleRate = 0; // 0 - full NRI validation
+	float m_FpsLimit = 0.0f;
 	uint32_t m_RngState = 0;
 	float m_MouseSensitivity = 1.0f;
 	bool m_DebugAPI = false;
 	bool m_DebugNRI = false;
 	bool m_IsActive = true;
+	bool m_IsHeadless = false;
+	bool m_IsBenchmark = false;
 
 	// Private
 private:
 	void CursorMode(int32_t mode);
+	bool CreateMainWindow(const char *windowTitle);
+
+	inline bool IsFixedTimeStep() const {
+		return m_IsHeadless || m_IsBenchmark;
+	}
 
 public:
 	inline bool HasUserInterface() const {
-		return m_TimePrev != 0.0;
+		return m_HasUserInterface;
+	}
+
+	inline const utils::UiRepackStats &GetUiRepackStats() const {
+		return m_UiRepackStats;
 	}
 
 	void InitCmdLineDefault(cmdline::parser &cmdLine);
@@ -185,6 +243,7 @@ public:
 private:
 	// UI
 	std::vector<uint8_t> m_UiData;
+	utils::UiRepackStats m_UiRepackStats = {};
 	nri::DescriptorPool *m_DescriptorPool = nullptr;
 	nri::DescriptorSet *m_DescriptorSet = nullptr;
 	nri::Descriptor *m_FontShaderResource = nullptr;
@@ -195,11 +254,21 @@ private:
 	nri::Memory *m_FontTextureMemory = nullptr;
 	GLFWcursor *m_MouseCursors[ImGuiMouseCursor_COUNT] = {};
 	double m_TimePrev = 0.0;
+	bool m_HasUserInterface = false;
 	uint64_t m_IbOffset = 0;
 	uint64_t m_VbOffset = 0;
 
 	nri::Window m_NRIWindow = {};
 
+	// Benchmark
+	std::string m_Title;
+	std::string m_GraphicsAPIName;
+	std::string m_BenchmarkFile = "Benchmark.json";
+	std::string m_CpuTraceFile;
+	std::string m_AllocationReportFile;
+	uint32_t m_BenchmarkWarmupFrameNum = 10;
+	uint32_t m_FixedFrameIndex = 0;
+
 	// Rendering
 	uint32_t m_FrameNum = uint32_t(-1);
 	uint32_t m_StreamBufferSize = 0;
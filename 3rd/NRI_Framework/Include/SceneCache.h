@@ -0,0 +1,69 @@
+#pragma once
+
+namespace utils {
+
+// Binary scene cache written by "LoadScene" on the first import. All arrays are 64-byte aligned in the file and the file is
+// memory mapped on reload, so "GetArray" pointers can be passed to "BufferUploadDesc" as is (no parsing, no copies)
+
+constexpr uint32_t SCENE_CACHE_VERSION = 5;
+constexpr uint64_t SCENE_CACHE_ALIGNMENT = 64;
+
+enum class SceneCacheArray : uint32_t {
+    VERTICES,
+    UNPACKED_VERTICES,
+    INDICES,
+    MESHES,
+    MESH_INSTANCES,
+    INSTANCES,
+    MATERIALS,
+    MESHLETS,
+    MESHLET_BOUNDS,
+    MESHLET_VERTICES,
+    MESHLET_PRIMITIVES,
+    MESH_LODS,
+
+    MAX_NUM
+};
+
+class SceneCache {
+public:
+    SceneCache() = default;
+    SceneCache(const SceneCache&) = delete;
+    SceneCache& operator=(const SceneCache&) = delete;
+    ~SceneCache();
+
+    // Fails if the cache is missing or stale (other version, struct sizes or source file size / time)
+    bool Open(const std::string& path, const std::string& sourcePath);
+    void Close();
+
+    static bool Write(const std::string& path, const std::string& sourcePath, const Scene& scene);
+
+    // Valid until "Close"
+    const void* GetArray(SceneCacheArray array, uint64_t& size, uint32_t& num) const;
+
+    // Fills "scene" arrays with one copy per array. "copyGeometry = false" - "vertices", "unpackedVertices" and "indices"
+    // stay empty, they are read from the mapping
+    void CopyTo(Scene& scene, bool copyGeometry = true) const;
+
+    inline bool IsOpen() const {
+        return m_Data != nullptr;
+    }
+
+private:
+    const uint8_t* m_Data = nullptr;
+    uint64_t m_Size = 0;
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+};
+
+// Geometry arrays of a scene loaded with a "SceneCache": the mapped file, or "Scene" vectors if the cache is not open
+// (for example, it can't be written)
+struct SceneGeometry {
+    const Vertex* vertices;
+    const UnpackedVertex* unpackedVertices;
+    const Index* indices;
+};
+
+SceneGeometry GetSceneGeometry(const Scene& scene, const SceneCache& cache);
+
+} // namespace utils
@@ -0,0 +1,163 @@
+#pragma once
+
+// Texture streaming: mip tails are uploaded on registration, higher mips are streamed through "nri::Streamer"
+// on demand, driven by the screen coverage of the instances referencing a texture. Only CPU-side data
+// ("utils::Texture" mips and instance bounds) is used to make decisions, so it works on any backend, including NONE.
+// A texture owns memory for its resident mips only: when the resident range changes (streaming or eviction), the texture
+// is recreated with the new mip chain, resident mips are re-uploaded from the CPU copy and the previous texture is
+// released once frames in flight are done with it. Views get replaced too, the app re-binds them ("GetReplacedTextures")
+
+struct TextureResidencyDesc {
+    uint64_t memoryBudget = 256 * 1024 * 1024; // resident mips above this size get evicted (LRU)
+    uint64_t uploadBudgetPerFrame = 4 * 1024 * 1024; // max bytes passed to the streamer per "Update" (eviction excluded)
+    uint32_t mipTailDim = 128; // mips with "max(width, height) <= mipTailDim" are always resident
+    float lodBias = 0.0f; // added to the requested mip level
+};
+
+struct TextureResidencyStats {
+    uint64_t residentSize; // texel data of resident mips, including mips queued this frame
+    uint64_t allocatedSize; // device memory of textures, including replaced ones waiting for release
+    uint64_t releasingSize; // device memory of replaced textures, freed "BUFFERED_FRAME_MAX_NUM" frames later
+    uint64_t uploadedSize; // this frame, including re-uploaded resident mips
+    uint64_t evictedSize; // this frame
+    uint64_t releasedSize; // this frame, device memory
+    uint32_t uploadedMipNum; // this frame, newly resident mips
+    uint32_t evictedMipNum; // this frame
+    uint32_t replacedTextureNum; // this frame
+    uint32_t pendingMipNum; // requested, but not resident yet
+};
+
+class TextureResidencyManager {
+public:
+    void Initialize(const nri::CoreInterface& NRI, const nri::HelperInterface& helperInterface, const nri::StreamerInterface& streamerInterface,
+        nri::Device& device, nri::Streamer& streamer, const TextureResidencyDesc& desc);
+
+    // All frames must be complete
+    void Destroy();
+
+    // "texture" must stay alive while registered: streamed mips are read from it. Creates the GPU texture with the mip
+    // tail and queues the upload (outside of the per frame budget). Returns "utils::InvalidIndex" on failure
+    uint32_t AddTexture(const utils::Texture& texture);
+
+    // Bounds of an object sampling the texture (world space)
+    uint32_t AddInstance(uint32_t textureIndex, const vec3& center, float radius);
+    void UpdateInstance(uint32_t instanceIndex, const vec3& center, float radius);
+
+    // Computes requested mips, evicts, queues streamer requests within the budgets and recreates textures, which
+    // resident mips have changed. Must be called once per frame before "CopyStreamerUpdateRequests", frames older than
+    // "frameIndex - BUFFERED_FRAME_MAX_NUM" must be complete (as in "PrepareFrame"). Queued mips are considered resident
+    // immediately, i.e. "CmdUploadStreamerUpdateRequests" must be recorded before any rendering in the same frame.
+    // "viewToClip" must be the projection used for drawing (its vertical scale gives the screen coverage)
+    void Update(const vec3& cameraPosition, const mat4& viewToClip, uint32_t viewportHeight, uint32_t frameIndex);
+
+    // Textures created since the last call: UNDEFINED => COPY_DESTINATION and COPY_DESTINATION => SHADER_RESOURCE
+    void GatherUploadBarriers(std::vector<nri::TextureBarrierDesc>& toCopyDestination, std::vector<nri::TextureBarrierDesc>& toShaderResource);
+
+    // Textures recreated by the last "Update": "GetTexture" and "GetDescriptor" return new objects, the previous ones
+    // stay valid for frames in flight
+    inline const std::vector<uint32_t>& GetReplacedTextures() const {
+        return m_ReplacedTextures;
+    }
+
+    // Holds resident mips only, i.e. mip 0 is "GetResidentMip"
+    inline nri::Texture* GetTexture(uint32_t textureIndex) const {
+        return m_Textures[textureIndex].gpuTexture;
+    }
+
+    inline nri::Descriptor* GetDescriptor(uint32_t textureIndex) const {
+        return m_Textures[textureIndex].descriptor;
+    }
+
+    // Most detailed mip of the source texture, which is resident
+    inline uint32_t GetResidentMip(uint32_t textureIndex) const {
+        return m_Textures[textureIndex].residentMip;
+    }
+
+    inline uint32_t GetRequestedMip(uint32_t textureIndex) const {
+        return m_Textures[textureIndex].requestedMip;
+    }
+
+    // Lowering evicts least recently used mips in the next "Update", including the ones in use (the mip tail stays)
+    inline void SetMemoryBudget(uint64_t memoryBudget) {
+        m_Desc.memoryBudget = memoryBudget;
+    }
+
+    inline uint64_t GetMemoryBudget() const {
+        return m_Desc.memoryBudget;
+    }
+
+    inline const TextureResidencyStats& GetStats() const {
+        return m_Stats;
+    }
+
+    inline uint32_t GetTextureNum() const {
+        return (uint32_t)m_Textures.size();
+    }
+
+private:
+    struct ResidentTexture {
+        const utils::Texture* texture;
+        nri::Texture* gpuTexture; // mips [residentMip; mipNum)
+        nri::Descriptor* descriptor;
+        nri::Memory* memory;
+        uint64_t allocationSize;
+        uint32_t chainSizeOffset; // in "m_ChainSizes"
+        uint32_t lastUsedFrame;
+        uint32_t lruPrev;
+        uint32_t lruNext;
+        uint8_t mipNum;
+        uint8_t tailMip; // first mip of the tail
+        uint8_t residentMip;
+        uint8_t targetMip; // "residentMip" after the current "Update"
+        uint8_t requestedMip;
+        bool isUploadPending; // created since the last "GatherUploadBarriers"
+    };
+
+    struct ResidentInstance {
+        vec3 center;
+        float radius;
+        uint32_t textureIndex;
+    };
+
+    struct ReleasedTexture {
+        nri::Texture* gpuTexture;
+        nri::Descriptor* descriptor;
+        nri::Memory* memory;
+        uint64_t allocationSize;
+        uint32_t frameIndex; // replaced in
+    };
+
+    bool CreateChain(uint32_t textureIndex, uint32_t mip, uint32_t frameIndex);
+    void ReleaseCompleted(uint32_t frameIndex);
+    void UploadMip(const ResidentTexture& residentTexture, uint32_t mip);
+    bool MakeRoom(uint64_t size, uint32_t frameIndex, uint32_t exceptTextureIndex);
+    void LruRemove(uint32_t textureIndex);
+    void LruPushFront(uint32_t textureIndex);
+
+    // Mips [mip; mipNum)
+    inline uint64_t GetChainSize(const ResidentTexture& residentTexture, uint32_t mip) const {
+        return m_ChainSizes[residentTexture.chainSizeOffset + mip];
+    }
+
+    inline uint64_t GetMipSize(const ResidentTexture& residentTexture, uint32_t mip) const {
+        return GetChainSize(residentTexture, mip) - GetChainSize(residentTexture, mip + 1);
+    }
+
+private:
+    std::vector<ResidentTexture> m_Textures;
+    std::vector<ResidentInstance> m_Instances;
+    std::vector<uint64_t> m_ChainSizes; // "mipNum + 1" per texture, CPU data
+    std::vector<ReleasedTexture> m_ReleasedTextures;
+    std::vector<uint32_t> m_UploadQueue;
+    std::vector<uint32_t> m_TexturesWithUploads;
+    std::vector<uint32_t> m_ReplacedTextures;
+    TextureResidencyDesc m_Desc = {};
+    TextureResidencyStats m_Stats = {};
+    const nri::CoreInterface* m_NRI = nullptr;
+    const nri::HelperInterface* m_HelperInterface = nullptr;
+    const nri::StreamerInterface* m_StreamerInterface = nullptr;
+    nri::Device* m_Device = nullptr;
+    nri::Streamer* m_Streamer = nullptr;
+    uint32_t m_LruHead = utils::InvalidIndex; // most recently used
+    uint32_t m_LruTail = utils::InvalidIndex; // least recently used
+};
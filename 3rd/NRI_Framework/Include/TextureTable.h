@@ -0,0 +1,123 @@
+#pragma once
+
+// Bindless texture table: one variable-sized, partially bound texture range in a dedicated descriptor set. Textures get
+// a stable index for their lifetime (pass it to shaders via root constants or material data), slots are handed out
+// in pages, descriptor writes are batched into one "UpdateDescriptorRanges" call per contiguous run of dirty slots
+
+struct BindlessTextureTableDesc {
+    uint32_t maxTextureNum = 4096; // range size, must be accounted in "DescriptorPoolDesc::textureMaxNum"
+    uint32_t pageSize = 256; // slot allocation granularity
+    uint32_t baseRegisterIndex = 0;
+    nri::StageBits shaderStages = nri::StageBits::FRAGMENT_SHADER;
+};
+
+struct BindlessTextureTableStats {
+    uint32_t textureNum;
+    uint32_t slotNum; // allocated pages * page size
+    uint32_t pageNum;
+    uint32_t writtenDescriptorNum; // last "Update"
+    uint32_t updateCallNum; // last "Update"
+};
+
+class BindlessTextureTable {
+public:
+    void Initialize(const BindlessTextureTableDesc& desc);
+
+    // Must be the only (or the last) range of its descriptor set
+    nri::DescriptorRangeDesc GetDescriptorRangeDesc() const;
+
+    // "nullDescriptor" (optional) is written into freed slots, otherwise they keep stale descriptors (but are never referenced)
+    bool CreateDescriptorSet(const nri::CoreInterface& NRI, nri::DescriptorPool& descriptorPool, const nri::PipelineLayout& pipelineLayout, uint32_t setIndex, nri::Descriptor* nullDescriptor = nullptr);
+
+    // Returns "utils::InvalidIndex" if the table is full. The descriptor becomes visible after the next "Update"
+    uint32_t Add(nri::Descriptor& descriptor);
+
+    // The slot must not be in use by in-flight frames. Returns "false" if "index" is not an added texture
+    bool Replace(uint32_t index, nri::Descriptor& descriptor);
+
+    // The slot gets reused after "BUFFERED_FRAME_MAX_NUM" frames. Returns "false" if "index" is not an added texture
+    // (out of range, never added or already removed)
+    bool Remove(uint32_t index, uint32_t frameIndex);
+
+    // Writes pending descriptors and recycles freed slots. Must be called once per frame before recording
+    void Update(uint32_t frameIndex);
+
+    inline nri::DescriptorSet* GetDescriptorSet() const {
+        return m_DescriptorSet;
+    }
+
+    inline const BindlessTextureTableStats& GetStats() const {
+        return m_Stats;
+    }
+
+private:
+    struct RemovedSlot {
+        uint32_t index;
+        uint32_t frameIndex;
+    };
+
+    void AllocatePage();
+
+private:
+    std::vector<nri::Descriptor*> m_Descriptors; // per slot, "nullptr" for free slots without "m_NullDescriptor"
+    std::vector<uint8_t> m_IsAdded; // per slot, cleared by "Remove" (the slot is recycled later)
+    std::vector<uint32_t> m_FreeSlots;
+    std::vector<RemovedSlot> m_RemovedSlots;
+    std::vector<uint32_t> m_DirtySlots;
+    BindlessTextureTableDesc m_Desc = {};
+    BindlessTextureTableStats m_Stats = {};
+    const nri::CoreInterface* m_NRI = nullptr;
+    nri::DescriptorSet* m_DescriptorSet = nullptr;
+    nri::Descriptor* m_NullDescriptor = nullptr;
+};
+
+// CPU-side skyline (bottom-left) packer for atlasing small textures. It doesn't touch texels, the caller copies
+// them into the returned rectangles (and adjusts UVs)
+
+struct AtlasRect {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+class SkylineAtlasPacker {
+public:
+    // "padding" is added to the right and bottom of each rectangle (for filtering and mips)
+    void Initialize(uint32_t width, uint32_t height, uint32_t padding = 0);
+    void Reset();
+
+    // Returns "false" if there is no space left
+    bool Pack(uint32_t width, uint32_t height, AtlasRect& rect);
+
+    // Packed area / used area ("width * GetUsedHeight()"), padding counts as waste
+    inline float GetEfficiency() const {
+        return m_UsedHeight ? float(m_PackedArea) / float(uint64_t(m_Width) * m_UsedHeight) : 0.0f;
+    }
+
+    inline uint32_t GetUsedHeight() const {
+        return m_UsedHeight;
+    }
+
+    inline uint32_t GetRectNum() const {
+        return m_RectNum;
+    }
+
+private:
+    struct SkylineNode {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+    };
+
+    bool Fit(size_t nodeIndex, uint32_t width, uint32_t height, uint32_t& y) const;
+
+private:
+    std::vector<SkylineNode> m_Skyline;
+    uint64_t m_PackedArea = 0;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    uint32_t m_Padding = 0;
+    uint32_t m_UsedHeight = 0;
+    uint32_t m_RectNum = 0;
+};
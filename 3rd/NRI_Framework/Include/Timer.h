@@ -1,16 +1,66 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
+// Monotonic clock ("QueryPerformanceCounter", "CLOCK_MONOTONIC"). Frame times are kept as raw values in a ring (single
+// writer, readable from any thread) and in a log-linear (HDR-style) histogram of microseconds, which gives percentiles
+// over the whole run with a bounded relative error and constant memory
+
+constexpr uint32_t TIMER_FRAME_TIME_NUM = 1024; // raw frame times in the ring, power of 2
+constexpr uint32_t TIMER_HISTOGRAM_SUB_BITS = 5; // 32 sub-buckets per power of 2, i.e. < 3% error
+constexpr uint32_t TIMER_HISTOGRAM_MAX_BITS = 26; // up to 67 s, longer frames are clamped
+constexpr uint32_t TIMER_HISTOGRAM_BUCKET_NUM = (TIMER_HISTOGRAM_MAX_BITS - TIMER_HISTOGRAM_SUB_BITS + 1) << TIMER_HISTOGRAM_SUB_BITS;
+constexpr float TIMER_STUTTER_RATIO = 2.0f; // a stutter - a frame longer than the smoothed frame time x ratio
+
+static_assert((TIMER_FRAME_TIME_NUM & (TIMER_FRAME_TIME_NUM - 1)) == 0, "Must be a power of 2");
+
+struct FrameTimeStats {
+    double p50; // ms
+    double p90;
+    double p99;
+    double p999;
+    double mean;
+    double min;
+    double max;
+    double jitter; // ms, the mean absolute difference of consecutive frame times
+    uint64_t frameNum;
+    uint64_t stutterNum;
+};
+
 class Timer {
 public:
     Timer();
+    ~Timer();
 
     void UpdateFrameTime();
 
+    // Feeds the smoothed values and statistics ("UpdateFrameTime" does it), public for synthetic frame times
+    void AddFrameTime(float ms);
+
+    // Statistics since the first frame or the last reset. Owning thread only
+    FrameTimeStats GetFrameTimeStats() const;
+    void ResetFrameTimeStats();
+
+    // The latest raw frame times, the oldest first. Any thread. Returns the number of copied values
+    uint32_t GetFrameTimes(float* frameTimes, uint32_t maxNum) const;
+
     // In milliseconds
     double GetTimeStamp() const;
 
+    // Sleeps until "timeStamp" ("GetTimeStamp" units). The OS sleep wakes up earlier by the worst recently observed
+    // oversleep, the rest is spun
+    void SleepUntil(double timeStamp);
+
+    // 0 - no limit
+    inline void SetFrameLimit(float fps) {
+        m_FramePeriod = fps > 0.0f ? 1000.0 / fps : 0.0;
+        m_NextFrameTimeStamp = 0.0;
+    }
+
+    // Paces frames to the limit (if any), once per frame. A late frame starts a new schedule instead of a catch-up burst
+    void WaitForFrameLimit();
+
     inline double GetLastFrameTimeStamp() const {
         return m_Time * m_InvTicksPerMs;
     }
@@ -28,9 +78,22 @@ public:
     }
 
 private:
+    std::atomic<float> m_FrameTimes[TIMER_FRAME_TIME_NUM] = {};
+    std::atomic<uint64_t> m_FrameTimeHead = 0;
+    uint32_t m_Histogram[TIMER_HISTOGRAM_BUCKET_NUM] = {};
     uint64_t m_Time = 0;
+    uint64_t m_FrameNum = 0;
+    uint64_t m_StutterNum = 0;
+    void* m_WaitableTimer = nullptr; // high resolution, Windows only
     double m_InvTicksPerMs = 0.0;
+    double m_FrameTimeSum = 0.0;
+    double m_JitterSum = 0.0;
+    double m_SleepMargin = 1.0; // ms
+    double m_FramePeriod = 0.0;
+    double m_NextFrameTimeStamp = 0.0;
+    float m_FrameTimeMin = 0.0f;
+    float m_FrameTimeMax = 0.0f;
     float m_Delta = 1.0f;
     float m_SmoothedDelta = 1.0f;
     float m_VerySmoothedDelta = 1.0f;
-};
\ No newline at end of file
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+// Flattened "SceneNode" hierarchy: nodes are sorted by depth (parents always precede children), TRS is stored as separate
+// streams and world matrices are computed level by level with SSE. Nodes of a level don't depend on each other, so large
+// levels are split between "JobSystem" threads. Changes are tracked per node and propagated down: static subtrees keep cached
+// matrices and only pay for a flag check
+
+namespace utils {
+
+constexpr uint32_t TRANSFORM_HIERARCHY_BLOCK_SIZE = 8 * 1024;
+constexpr uint32_t TRANSFORM_HIERARCHY_PARALLEL_MIN_NUM = 32 * 1024; // nodes per level, ~130 us even if nothing changed, smaller levels stay on the calling thread
+
+// Accumulated over calls
+struct TransformHierarchyStats {
+    uint64_t visitedNum;
+    uint64_t updatedNum; // world matrices recomputed
+    double time; // ms
+
+    inline double GetNodesPerSecond() const {
+        return time > 0.0 ? visitedNum * 1000.0 / time : 0.0;
+    }
+
+    inline double GetUpdatedFraction() const {
+        return visitedNum ? double(updatedNum) / double(visitedNum) : 0.0;
+    }
+};
+
+class TransformHierarchy {
+public:
+    // Flattens the subtrees of "roots" (breadth first). TRS are taken from the nodes, everything is dirty
+    void Build(SceneNode* const* roots, uint32_t rootNum);
+
+    // Linear search, use at load time
+    uint32_t FindNode(const SceneNode* node) const;
+
+    void SetTranslation(uint32_t node, const vec3& translation);
+    void SetRotation(uint32_t node, const vec4& rotation); // quaternion (x, y, z, w)
+    void SetScale(uint32_t node, const vec3& scale);
+
+    // "sceneToWorld" is applied to roots, a change marks everything dirty. 0 - all "JobSystem" threads
+    void Update(const mat4& sceneToWorld, TransformHierarchyStats& stats, uint32_t threadNum = 0);
+
+    // Copies local and world matrices of nodes updated by the last "Update" to the source "SceneNode"s
+    void WriteBack() const;
+
+    inline const mat4& GetWorldTransform(uint32_t node) const {
+        return m_WorldTransforms[node];
+    }
+
+    inline uint32_t GetParent(uint32_t node) const {
+        return m_Parents[node];
+    }
+
+    inline SceneNode* GetSceneNode(uint32_t node) const {
+        return m_SceneNodes[node];
+    }
+
+    inline uint32_t GetNodeNum() const {
+        return (uint32_t)m_Parents.size();
+    }
+
+    inline uint32_t GetLevelNum() const {
+        return m_LevelOffsets.empty() ? 0 : (uint32_t)m_LevelOffsets.size() - 1;
+    }
+
+private:
+    void UpdateRange(uint32_t begin, uint32_t end);
+
+private:
+    std::vector<uint32_t> m_Parents; // "InvalidIndex" for roots
+    std::vector<vec3> m_Translations;
+    std::vector<vec4> m_Rotations;
+    std::vector<vec3> m_Scales;
+    std::vector<mat4> m_LocalTransforms;
+    std::vector<mat4> m_WorldTransforms;
+    std::vector<uint8_t> m_IsDirty; // TRS changed since the last "Update"
+    std::vector<uint8_t> m_IsUpdated; // world matrix changed in the last "Update"
+    std::vector<uint32_t> m_LevelOffsets; // level "i" - "[m_LevelOffsets[i], m_LevelOffsets[i + 1])"
+    std::vector<SceneNode*> m_SceneNodes;
+    mat4 m_SceneToWorld = mat4(1.0f);
+};
+
+// Recursive pointer tree walk (the reference): local = T * R * S, world = parent world * local
+void UpdateSceneNodeTransforms(SceneNode& node, const mat4& parentTransform);
+
+} // namespace utils
@@ -0,0 +1,42 @@
+#pragma once
+
+// ImGui geometry repacking for "SampleBase::RenderUI": "ImDrawVert" (20 bytes) becomes "UiVertex" (16 bytes, UV as
+// UNORM16x2). Vertices are converted 4 at a time with SSE2, large UIs repack draw lists in parallel on the shared
+// "JobSystem". Only the bytes used by the current frame are written (and uploaded)
+
+namespace utils {
+
+constexpr uint32_t UI_REPACK_PARALLEL_VERTEX_NUM = 64 * 1024; // ~250 us with SSE, smaller UIs are repacked on the calling thread
+
+// Matches the vertex layout of the UI pipeline
+struct UiVertex {
+    float pos[2];
+    uint32_t uv; // UNORM16x2
+    uint32_t col; // RGBA8
+};
+
+static_assert(sizeof(UiVertex) == 16, "Must match the UI pipeline vertex layout");
+
+// Accumulated over calls
+struct UiRepackStats {
+    uint64_t vertexNum;
+    uint64_t byteNum; // uploaded
+    double time; // ms
+    uint32_t frameNum;
+
+    inline double GetMicrosecondsPerFrame() const {
+        return frameNum ? time * 1000.0 / frameNum : 0.0;
+    }
+
+    inline double GetBytesPerFrame() const {
+        return frameNum ? double(byteNum) / frameNum : 0.0;
+    }
+};
+
+// Indices go first, then vertices. Both sizes are 16-byte aligned
+void GetUiGeometrySize(const ImDrawData& drawData, uint32_t& indexDataSize, uint32_t& vertexDataSize);
+
+// Writes "indexDataSize + vertexDataSize" bytes (see "GetUiGeometrySize") to "dst". 0 - all "JobSystem" threads
+void RepackUiGeometry(const ImDrawData& drawData, uint8_t* dst, UiRepackStats& stats, bool disableSimd = false, uint32_t threadNum = 0);
+
+} // namespace utils
@@ -8,6 +8,8 @@
 namespace utils {
 struct Texture;
 struct Scene;
+class SceneCache;
+class Ktx2Texture;
 
 typedef std::vector<std::vector<uint8_t>> ShaderCodeStorage;
 typedef void *Mip;
@@ -48,18 +50,24 @@ bool LoadFile(const std::string &path, std::vector<uint8_t> &data);
 nri::ShaderDesc LoadShader(nri::GraphicsAPI graphicsAPI,
 		const std::string &path, ShaderCodeStorage &storage,
 		const char *entryPointName = nullptr);
+// ".ktx2" files are read by "Ktx2Texture" (no transcoding, "computeAvgColorAndAlphaMode" is ignored), others - by Detex
 bool LoadTexture(const std::string &path, Texture &texture,
 		bool computeAvgColorAndAlphaMode = false);
 void LoadTextureFromMemory(nri::Format format, uint32_t width, uint32_t height,
 		const uint8_t *pixels, Texture &texture);
+// Box filtered mips for an RGBA8 texture loaded without them (e.g. PNG). Returns "false" for other textures
+bool GenerateMips(Texture &texture);
 bool LoadTextureFromMemory(const std::string &name, const uint8_t *data,
 		int dataSize, Texture &texture,
 		bool computeAvgColorAndAlphaMode);
-bool LoadScene(const std::string &path, Scene &scene, bool allowUpdate);
+// "cache" (optional) stays mapped: "vertices", "unpackedVertices" and "indices" are not copied into "scene", see
+// "GetSceneGeometry". The cache must stay open until uploads reading them are done
+bool LoadScene(const std::string &path, Scene &scene, bool allowUpdate, SceneCache *cache = nullptr);
 
 struct Texture {
 	std::string name;
 	Mip *mips = nullptr;
+	std::shared_ptr<Ktx2Texture> ktx2; // KTX2 files: mips live in its arena, "mips" is not used
 	AlphaMode alphaMode = AlphaMode::OPAQUE;
 	nri::Format format = nri::Format::UNKNOWN;
 	uint16_t width = 0;
@@ -136,6 +144,37 @@ struct Instance {
 							  // BLAS together with other static geometry
 };
 
+// Cluster of a mesh (mesh shaders, cluster culling), see "Meshlets.h"
+struct Meshlet {
+	uint32_t vertexOffset = 0; // in "Scene::meshletVertices" (mesh-local vertex indices)
+	uint32_t primitiveOffset = 0; // in "Scene::meshletPrimitives" (3 x 8-bit meshlet-local indices per triangle)
+	uint32_t vertexNum = 0;
+	uint32_t primitiveNum = 0;
+};
+
+struct MeshletBounds {
+	float center[3];
+	float radius;
+	float coneAxis[3];
+	float coneCutoff; // sine of the normal cone spread, 1 - no cone culling
+};
+
+// Index range of a simplified version of a mesh (same vertices), see "MeshSimplifier.h"
+struct MeshLod {
+	uint32_t indexOffset = 0;
+	uint32_t indexNum = 0;
+	float error = 0.0f; // object space deviation from LOD 0
+};
+
+// GPU vertex layout of a mesh, see "VertexPacking.h"
+enum class VertexFormat : uint8_t {
+	UNPACKED, // "UnpackedVertex" - 48 bytes
+	STANDARD, // "Vertex": float3 position, float2 uv, 10:10:10:2 N and T - 28 bytes
+	COMPACT, // "CompactVertex": unorm16x4 position (mesh AABB), half2 uv, octahedral snorm16x2 N, 10:10:10:2 T - 20 bytes
+
+	MAX_NUM
+};
+
 // static mesh data shared across mesh instances
 struct Mesh {
 	//   cBoxf aabb; // must be manually adjusted by instance.rotation.GetScale()
@@ -143,10 +182,15 @@ struct Mesh {
 	uint32_t indexOffset = 0;
 	uint32_t indexNum = 0;
 	uint32_t vertexNum = 0;
+	uint32_t meshletOffset = 0;
+	uint32_t meshletNum = 0;
+	uint32_t lodOffset = 0; // in "Scene::meshLods", LOD 0 is the mesh itself
+	uint32_t lodNum = 0;
 
 	uint32_t morphMeshIndexOffset = InvalidIndex;
 	uint32_t morphTargetVertexOffset = InvalidIndex;
 	uint32_t morphTargetNum = 0;
+	VertexFormat vertexFormat = VertexFormat::STANDARD; // the smallest lossless enough one, see "SelectVertexFormat"
 
 	inline bool HasMorphTargets() const { return morphTargetNum != 0; }
 };
@@ -256,12 +300,17 @@ struct Scene {
 	std::vector<Index> indices;
 	std::vector<Primitive> primitives;
 	std::vector<MorphVertex> morphVertices;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint32_t> meshletPrimitives;
 
 	// Other resources
 	std::vector<Material> materials;
 	std::vector<Instance> instances;
 	std::vector<Mesh> meshes;
 	std::vector<MeshInstance> meshInstances;
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshletBounds> meshletBounds;
+	std::vector<MeshLod> meshLods;
 	std::vector<Animation> animations;
 	std::vector<uint32_t> morphMeshes;
 	mat4 mSceneToWorld = mat4(1.0);
@@ -297,6 +346,12 @@ struct Scene {
 		primitives.resize(0);
 		primitives.shrink_to_fit();
 
+		meshletVertices.resize(0);
+		meshletVertices.shrink_to_fit();
+
+		meshletPrimitives.resize(0);
+		meshletPrimitives.shrink_to_fit();
+
 		morphVertices.resize(0);
 		morphVertices.shrink_to_fit();
 	}
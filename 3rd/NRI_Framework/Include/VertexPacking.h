@@ -0,0 +1,57 @@
+#pragma once
+
+// Vertex packing: "utils::UnpackedVertex" => GPU vertex formats, SSE2 (4 vertices at a time) with a scalar reference.
+// Decoding matches "shaders/VertexPacking.hlsli": the input assembler expands UNORM / SNORM / FLOAT16 attributes,
+// shaders only apply "VertexDecodeParams" and decode normals. The format is per mesh ("Mesh::vertexFormat"), pipelines
+// are created per format with "GetVertexAttributes"
+
+namespace utils {
+
+// Must match "VERTEX_NORMAL_*" in "VertexPacking.hlsli"
+enum class VertexNormalEncoding : uint32_t {
+    FLOAT,
+    UNORM_10_10_10_2,
+    OCTAHEDRAL
+};
+
+struct CompactVertex {
+    uint16_t pos[4]; // .w - unused
+    uint16_t uv[2];
+    int16_t N[2];
+    uint32_t T; // .w - handedness
+};
+
+// Per mesh: "position = fetchedPosition * positionScale + positionBias" ("fetchedPosition" is already normalized by the IA)
+struct VertexDecodeParams {
+    float positionScale[3];
+    VertexNormalEncoding normalEncoding;
+    float positionBias[3];
+    uint32_t stride;
+};
+
+struct VertexFetchStats {
+    uint64_t fetchedBytes; // memory traffic
+    uint32_t vertexCacheMissNum;
+    uint32_t lineMissNum;
+};
+
+// "COMPACT" if quantized positions and half UVs stay within the errors (object / UV space), "STANDARD" otherwise
+VertexFormat SelectVertexFormat(const UnpackedVertex* src, uint32_t vertexNum, float maxPositionError = 0.0005f, float maxUvError = 1.0f / 2048.0f);
+
+const char* GetVertexFormatName(VertexFormat format);
+uint32_t GetVertexStride(VertexFormat format);
+
+// POSITION, TEXCOORD, NORMAL, TANGENT (stream 0, "vk.location" = index). Returns attribute count
+uint32_t GetVertexAttributes(VertexFormat format, nri::VertexAttributeDesc* attributes, bool withTangent = false);
+
+// "dst" must have "vertexNum * GetVertexStride(format)" bytes
+VertexDecodeParams PackVertices(VertexFormat format, const UnpackedVertex* src, uint32_t vertexNum, void* dst);
+VertexDecodeParams PackVerticesScalar(VertexFormat format, const UnpackedVertex* src, uint32_t vertexNum, void* dst);
+
+// The params "PackVertices" returns, for vertices packed before (for example, "Scene::vertices" are "STANDARD")
+VertexDecodeParams GetVertexDecodeParams(VertexFormat format, const UnpackedVertex* src, uint32_t vertexNum);
+
+// CPU emulation of vertex fetch: 32 entry FIFO post-transform cache in front of a 16 Kb direct mapped cache (64 byte lines)
+VertexFetchStats EstimateVertexFetch(const Index* indices, uint32_t indexNum, uint32_t vertexStride);
+
+} // namespace utils
@@ -0,0 +1,531 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <functional>
+#include <math.h>
+#include <unordered_map>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    define ANIMATION_SAMPLER_SSE // SSE2 is the baseline
+#    include <emmintrin.h>
+#endif
+
+enum ChannelIndex : uint32_t {
+    TRANSLATION,
+    ROTATION,
+    SCALE
+};
+
+// Polynomial slerp ("A Fast and Accurate Algorithm for Computing SLERP", D. Eberly): no "acos" / "sin", max error ~3e-5
+constexpr float SLERP_MU = 1.85298109240830f;
+constexpr float SLERP_U[8] = {1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9), 1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), SLERP_MU / (8 * 17)};
+constexpr float SLERP_V[8] = {1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9, 5.0f / 11, 6.0f / 13, 7.0f / 15, SLERP_MU * 8 / 17};
+
+struct KeyPair {
+    uint32_t from;
+    uint32_t to;
+    float factor;
+    float delta; // seconds between the keys
+};
+
+static inline vec4 ToVec4(const vec3& v) {
+    return vec4(v.x, v.y, v.z, 0.0f);
+}
+
+static inline vec4 ToVec4(const vec4& v) {
+    return v;
+}
+
+static inline uint32_t FindKey(const float* keys, uint32_t keyNum, float time, uint32_t& cursor, uint64_t& searchNum) {
+    if (time <= keys[0])
+        return cursor = 0;
+
+    if (time >= keys[keyNum - 1])
+        return cursor = keyNum - 1;
+
+    // "keys[cursor] <= time < keys[cursor + 1]": playback stays on the same key or moves to the next one
+    uint32_t key = cursor;
+    if (keys[key] <= time) {
+        if (time < keys[key + 1])
+            return key;
+
+        if (time < keys[key + 2])
+            return cursor = key + 1;
+    }
+
+    searchNum++;
+
+    return cursor = uint32_t(std::upper_bound(keys, keys + keyNum, time) - keys) - 1;
+}
+
+static inline KeyPair FindKeyPair(const float* keys, uint32_t keyNum, float time, bool isStep, uint32_t& cursor, uint64_t& searchNum) {
+    KeyPair pair = {};
+    pair.from = FindKey(keys, keyNum, time, cursor, searchNum);
+    pair.to = isStep ? pair.from : std::min(pair.from + 1, keyNum - 1);
+
+    if (pair.to != pair.from) {
+        pair.delta = keys[pair.to] - keys[pair.from];
+        pair.factor = std::max(time - keys[pair.from], 0.0f) / pair.delta; // before the first key
+    }
+
+    return pair;
+}
+
+static inline void GetHermiteWeights(float t, float delta, float weights[4]) {
+    float t2 = t * t;
+    float t3 = t2 * t;
+
+    weights[0] = 2.0f * t3 - 3.0f * t2 + 1.0f; // value "from"
+    weights[1] = (t3 - 2.0f * t2 + t) * delta; // out-tangent "from"
+    weights[2] = -2.0f * t3 + 3.0f * t2; // value "to"
+    weights[3] = (t3 - t2) * delta; // in-tangent "to"
+}
+
+#ifdef ANIMATION_SAMPLER_SSE
+
+// 4 quaternions, a register per component
+struct QuatLanes {
+    __m128 x, y, z, w;
+};
+
+static inline QuatLanes LoadLanes(const vec4* const v[4]) {
+    QuatLanes lanes = {_mm_loadu_ps(&v[0]->x), _mm_loadu_ps(&v[1]->x), _mm_loadu_ps(&v[2]->x), _mm_loadu_ps(&v[3]->x)};
+    _MM_TRANSPOSE4_PS(lanes.x, lanes.y, lanes.z, lanes.w);
+
+    return lanes;
+}
+
+static inline void StoreLanes(QuatLanes lanes, vec4* dst, uint32_t num) {
+    _MM_TRANSPOSE4_PS(lanes.x, lanes.y, lanes.z, lanes.w);
+
+    const __m128 rows[4] = {lanes.x, lanes.y, lanes.z, lanes.w};
+    for (uint32_t i = 0; i < num; i++)
+        _mm_storeu_ps(&dst[i].x, rows[i]);
+}
+
+static inline __m128 Dot(const QuatLanes& a, const QuatLanes& b) {
+    __m128 d = _mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y));
+
+    return _mm_add_ps(d, _mm_add_ps(_mm_mul_ps(a.z, b.z), _mm_mul_ps(a.w, b.w)));
+}
+
+static inline QuatLanes MulAdd(const QuatLanes& a, __m128 wa, const QuatLanes& b, __m128 wb) {
+    return {
+        _mm_add_ps(_mm_mul_ps(a.x, wa), _mm_mul_ps(b.x, wb)),
+        _mm_add_ps(_mm_mul_ps(a.y, wa), _mm_mul_ps(b.y, wb)),
+        _mm_add_ps(_mm_mul_ps(a.z, wa), _mm_mul_ps(b.z, wb)),
+        _mm_add_ps(_mm_mul_ps(a.w, wa), _mm_mul_ps(b.w, wb)),
+    };
+}
+
+static inline QuatLanes Slerp(const QuatLanes& a, const QuatLanes& b, __m128 t) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    // Shortest path: "b" is negated if "dot < 0"
+    __m128 x = Dot(a, b);
+    __m128 sign = _mm_and_ps(x, signBit);
+    x = _mm_xor_ps(x, sign);
+
+    __m128 xm1 = _mm_sub_ps(x, one);
+    __m128 d = _mm_sub_ps(one, t);
+    __m128 sqrT = _mm_mul_ps(t, t);
+    __m128 sqrD = _mm_mul_ps(d, d);
+
+    __m128 cT = one;
+    __m128 cD = one;
+    for (int32_t i = 7; i >= 0; i--) {
+        __m128 u = _mm_set1_ps(SLERP_U[i]);
+        __m128 v = _mm_set1_ps(SLERP_V[i]);
+        __m128 bT = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, sqrT), v), xm1);
+        __m128 bD = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, sqrD), v), xm1);
+        cT = _mm_add_ps(one, _mm_mul_ps(bT, cT));
+        cD = _mm_add_ps(one, _mm_mul_ps(bD, cD));
+    }
+
+    cT = _mm_xor_ps(_mm_mul_ps(t, cT), sign);
+    cD = _mm_mul_ps(d, cD);
+
+    return MulAdd(a, cD, b, cT);
+}
+
+#else
+
+static inline void Slerp(const float* a, const float* b, float t, float* result) {
+    float x = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    float sign = x < 0.0f ? -1.0f : 1.0f;
+    x *= sign;
+
+    float xm1 = x - 1.0f;
+    float d = 1.0f - t;
+    float sqrT = t * t;
+    float sqrD = d * d;
+
+    float cT = 1.0f;
+    float cD = 1.0f;
+    for (int32_t i = 7; i >= 0; i--) {
+        cT = 1.0f + (SLERP_U[i] * sqrT - SLERP_V[i]) * xm1 * cT;
+        cD = 1.0f + (SLERP_U[i] * sqrD - SLERP_V[i]) * xm1 * cD;
+    }
+
+    cT = sign * t * cT;
+    cD = d * cD;
+
+    for (uint32_t i = 0; i < 4; i++)
+        result[i] = a[i] * cD + b[i] * cT;
+}
+
+#endif
+
+void utils::AnimationSampler::Build(const Animation& animation, const TransformHierarchy& hierarchy) {
+    std::unordered_map<const SceneNode*, uint32_t> nodeIndices;
+    for (uint32_t i = 0; i < hierarchy.GetNodeNum(); i++)
+        nodeIndices[hierarchy.GetSceneNode(i)] = i;
+
+    auto AddTracks = [&](Channel& channel, const auto& tracks, bool cubic) {
+        for (const auto& track : tracks) {
+            auto it = nodeIndices.find(track.node);
+            if (it == nodeIndices.end() || track.keys.empty())
+                continue;
+
+            bool isCubic = track.type == AnimationTrackType::CubicSpline && track.values.size() == track.keys.size() * 3;
+            if (isCubic != cubic)
+                continue;
+
+            channel.keyOffsets.push_back((uint32_t)channel.keys.size());
+            channel.valueOffsets.push_back((uint32_t)channel.values.size());
+            channel.nodes.push_back(it->second);
+            channel.isStep.push_back(track.type == AnimationTrackType::Step);
+
+            channel.keys.insert(channel.keys.end(), track.keys.begin(), track.keys.end());
+            for (const auto& value : track.values)
+                channel.values.push_back(ToVec4(value));
+        }
+    };
+
+    auto BuildChannel = [&](Channel& channel, const auto& tracks) {
+        channel = {};
+
+        AddTracks(channel, tracks, false);
+        channel.cubicBegin = (uint32_t)channel.nodes.size();
+        AddTracks(channel, tracks, true);
+
+        channel.keyOffsets.push_back((uint32_t)channel.keys.size());
+        channel.cursors.assign(channel.nodes.size(), 0);
+        channel.sampled.resize(channel.nodes.size());
+    };
+
+    BuildChannel(m_Channels[TRANSLATION], animation.positionTracks);
+    BuildChannel(m_Channels[ROTATION], animation.rotationTracks);
+    BuildChannel(m_Channels[SCALE], animation.scaleTracks);
+
+    // Dense weights: "targetNum" per key, absent targets are 0
+    m_MorphTracks.clear();
+    m_MorphKeys.clear();
+    m_MorphWeights.clear();
+
+    uint32_t activeNum = 0;
+    for (const WeightsAnimationTrack& track : animation.weightTracks) {
+        if (track.keys.empty())
+            continue;
+
+        uint32_t targetNum = 0;
+        for (const auto& values : track.values) {
+            for (const MorphTargetIndexWeight& value : values)
+                targetNum = std::max(targetNum, value.first + 1);
+        }
+
+        MorphTrack& morphTrack = m_MorphTracks.emplace_back();
+        morphTrack.keyOffset = (uint32_t)m_MorphKeys.size();
+        morphTrack.keyNum = (uint32_t)track.keys.size();
+        morphTrack.weightOffset = (uint32_t)m_MorphWeights.size();
+        morphTrack.targetNum = targetNum;
+        morphTrack.activeOffset = activeNum;
+        morphTrack.activeNum = 0;
+        morphTrack.cursor = 0;
+        morphTrack.isStep = track.type == AnimationTrackType::Step;
+
+        m_MorphKeys.insert(m_MorphKeys.end(), track.keys.begin(), track.keys.end());
+        m_MorphWeights.resize(m_MorphWeights.size() + morphTrack.keyNum * targetNum, 0.0f);
+
+        for (uint32_t key = 0; key < morphTrack.keyNum && key < track.values.size(); key++) {
+            float* weights = m_MorphWeights.data() + morphTrack.weightOffset + key * targetNum;
+            for (const MorphTargetIndexWeight& value : track.values[key])
+                weights[value.first] = value.second;
+        }
+
+        activeNum += targetNum;
+    }
+
+    m_ActiveWeights.resize(activeNum);
+}
+
+void utils::AnimationSampler::SampleChannel(Channel& channel, bool isRotation, float time, uint64_t& searchNum) {
+    uint32_t trackNum = (uint32_t)channel.nodes.size();
+
+    // Step and linear
+#ifdef ANIMATION_SAMPLER_SSE
+    if (isRotation) {
+        for (uint32_t i = 0; i < channel.cubicBegin; i += 4) {
+            const vec4* from[4];
+            const vec4* to[4];
+            float factors[4];
+            uint32_t num = std::min(channel.cubicBegin - i, 4u);
+
+            for (uint32_t j = 0; j < 4; j++) {
+                uint32_t track = i + std::min(j, num - 1);
+                uint32_t keyOffset = channel.keyOffsets[track];
+                const vec4* values = channel.values.data() + channel.valueOffsets[track];
+
+                KeyPair pair = FindKeyPair(channel.keys.data() + keyOffset, channel.keyOffsets[track + 1] - keyOffset, time, channel.isStep[track], channel.cursors[track], searchNum);
+                from[j] = values + pair.from;
+                to[j] = values + pair.to;
+                factors[j] = pair.factor;
+            }
+
+            QuatLanes result = Slerp(LoadLanes(from), LoadLanes(to), _mm_loadu_ps(factors));
+            StoreLanes(result, channel.sampled.data() + i, num);
+        }
+    } else {
+        for (uint32_t i = 0; i < channel.cubicBegin; i++) {
+            uint32_t keyOffset = channel.keyOffsets[i];
+            const vec4* values = channel.values.data() + channel.valueOffsets[i];
+
+            KeyPair pair = FindKeyPair(channel.keys.data() + keyOffset, channel.keyOffsets[i + 1] - keyOffset, time, channel.isStep[i], channel.cursors[i], searchNum);
+            __m128 a = _mm_loadu_ps(&values[pair.from].x);
+            __m128 b = _mm_loadu_ps(&values[pair.to].x);
+            __m128 result = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(pair.factor)));
+            _mm_storeu_ps(&channel.sampled[i].x, result);
+        }
+    }
+#else
+    for (uint32_t i = 0; i < channel.cubicBegin; i++) {
+        uint32_t keyOffset = channel.keyOffsets[i];
+        const vec4* values = channel.values.data() + channel.valueOffsets[i];
+
+        KeyPair pair = FindKeyPair(channel.keys.data() + keyOffset, channel.keyOffsets[i + 1] - keyOffset, time, channel.isStep[i], channel.cursors[i], searchNum);
+        const float* a = &values[pair.from].x;
+        const float* b = &values[pair.to].x;
+        float* result = &channel.sampled[i].x;
+
+        if (isRotation)
+            Slerp(a, b, pair.factor, result);
+        else {
+            for (uint32_t j = 0; j < 4; j++)
+                result[j] = a[j] + (b[j] - a[j]) * pair.factor;
+        }
+    }
+#endif
+
+    // Cubic Hermite: values are "in-tangent, value, out-tangent" triplets, rotations get normalized
+    for (uint32_t i = channel.cubicBegin; i < trackNum; i++) {
+        uint32_t keyOffset = channel.keyOffsets[i];
+        const vec4* values = channel.values.data() + channel.valueOffsets[i];
+
+        KeyPair pair = FindKeyPair(channel.keys.data() + keyOffset, channel.keyOffsets[i + 1] - keyOffset, time, false, channel.cursors[i], searchNum);
+        float weights[4];
+        GetHermiteWeights(pair.factor, pair.delta, weights);
+
+        const vec4* from = values + pair.from * 3;
+        const vec4* to = values + pair.to * 3;
+
+#ifdef ANIMATION_SAMPLER_SSE
+        __m128 result = _mm_mul_ps(_mm_loadu_ps(&from[1].x), _mm_set1_ps(weights[0]));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(&from[2].x), _mm_set1_ps(weights[1])));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(&to[1].x), _mm_set1_ps(weights[2])));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(&to[0].x), _mm_set1_ps(weights[3])));
+
+        if (isRotation) {
+            __m128 sqr = _mm_mul_ps(result, result);
+            sqr = _mm_add_ps(sqr, _mm_shuffle_ps(sqr, sqr, _MM_SHUFFLE(2, 3, 0, 1)));
+            sqr = _mm_add_ps(sqr, _mm_shuffle_ps(sqr, sqr, _MM_SHUFFLE(1, 0, 3, 2)));
+            result = _mm_div_ps(result, _mm_sqrt_ps(sqr));
+        }
+
+        _mm_storeu_ps(&channel.sampled[i].x, result);
+#else
+        float* result = &channel.sampled[i].x;
+        for (uint32_t j = 0; j < 4; j++)
+            result[j] = (&from[1].x)[j] * weights[0] + (&from[2].x)[j] * weights[1] + (&to[1].x)[j] * weights[2] + (&to[0].x)[j] * weights[3];
+
+        if (isRotation) {
+            float invLength = 1.0f / sqrtf(result[0] * result[0] + result[1] * result[1] + result[2] * result[2] + result[3] * result[3]);
+            for (uint32_t j = 0; j < 4; j++)
+                result[j] *= invLength;
+        }
+#endif
+    }
+}
+
+void utils::AnimationSampler::Sample(float time, TransformHierarchy& hierarchy, AnimationSamplerStats& stats) {
+    Timer timer;
+    double begin = timer.GetTimeStamp();
+
+    uint64_t searchNum = 0;
+    for (uint32_t i = 0; i < 3; i++)
+        SampleChannel(m_Channels[i], i == ROTATION, time, searchNum);
+
+    const Channel& translations = m_Channels[TRANSLATION];
+    for (size_t i = 0; i < translations.nodes.size(); i++) {
+        const vec4& v = translations.sampled[i];
+        hierarchy.SetTranslation(translations.nodes[i], vec3(v.x, v.y, v.z));
+    }
+
+    const Channel& rotations = m_Channels[ROTATION];
+    for (size_t i = 0; i < rotations.nodes.size(); i++)
+        hierarchy.SetRotation(rotations.nodes[i], rotations.sampled[i]);
+
+    const Channel& scales = m_Channels[SCALE];
+    for (size_t i = 0; i < scales.nodes.size(); i++) {
+        const vec4& v = scales.sampled[i];
+        hierarchy.SetScale(scales.nodes[i], vec3(v.x, v.y, v.z));
+    }
+
+    // Morph weights: dense lerp, non-zero weights are compacted into the preallocated range of the track
+    for (MorphTrack& track : m_MorphTracks) {
+        KeyPair pair = FindKeyPair(m_MorphKeys.data() + track.keyOffset, track.keyNum, time, track.isStep, track.cursor, searchNum);
+        const float* from = m_MorphWeights.data() + track.weightOffset + pair.from * track.targetNum;
+        const float* to = m_MorphWeights.data() + track.weightOffset + pair.to * track.targetNum;
+        MorphTargetIndexWeight* active = m_ActiveWeights.data() + track.activeOffset;
+
+        uint32_t activeNum = 0;
+        float totalWeight = 0.0f;
+        for (uint32_t i = 0; i < track.targetNum; i++) {
+            float weight = from[i] + (to[i] - from[i]) * pair.factor;
+            if (weight > 0.0f) {
+                active[activeNum++] = {i, weight};
+                totalWeight += weight;
+            }
+        }
+
+        std::sort(active, active + activeNum, [](const MorphTargetIndexWeight& a, const MorphTargetIndexWeight& b) { return a.second > b.second; });
+
+        if (totalWeight > 0.0f && totalWeight != 1.0f) {
+            float totalWeightRcp = 1.0f / totalWeight;
+            for (uint32_t i = 0; i < activeNum; i++)
+                active[i].second *= totalWeightRcp;
+        }
+
+        track.activeNum = activeNum;
+    }
+
+    stats.trackNum += GetTrackNum();
+    stats.searchNum += searchNum;
+    stats.time += timer.GetTimeStamp() - begin;
+}
+
+static vec4 SlerpReference(vec4 a, const vec4& b, float t) {
+    float cosTheta = dot(a, b);
+    if (cosTheta < 0.0f) {
+        a = -a;
+        cosTheta = -cosTheta;
+    }
+
+    if (cosTheta > 0.9995f)
+        return normalize(mix(a, b, t));
+
+    float theta = acosf(cosTheta);
+    float sinThetaRcp = 1.0f / sinf(theta);
+
+    return a * (sinf((1.0f - t) * theta) * sinThetaRcp) + b * (sinf(t * theta) * sinThetaRcp);
+}
+
+void utils::SampleAnimationReference(Animation& animation, float time) {
+    std::function<uint32_t(const std::vector<float>&, float)> findKeyIndex = [](const std::vector<float>& keys, float time) {
+        if (time <= keys[0])
+            return (uint32_t)0;
+
+        if (time >= keys.back())
+            return (uint32_t)(keys.size() - 1);
+
+        for (int32_t index = (int32_t)keys.size() - 1; index >= 1; --index) {
+            if (time >= keys[index])
+                return (uint32_t)index;
+        }
+
+        return (uint32_t)0;
+    };
+
+    auto getFactor = [&](const std::vector<float>& keys, uint32_t from, uint32_t to) {
+        float keyFrom = keys[from];
+        float keyTo = keys[to];
+        float t = time < keyFrom ? keyFrom : (time > keyTo ? keyTo : time);
+
+        return to != from ? (t - keyFrom) / (keyTo - keyFrom) : 0.0f;
+    };
+
+    for (WeightsAnimationTrack& track : animation.weightTracks) {
+        track.activeValues.clear();
+
+        uint32_t from = findKeyIndex(track.keys, time);
+        uint32_t to = std::min((uint32_t)track.keys.size() - 1, from + 1);
+        float factor = getFactor(track.keys, from, to);
+
+        if (track.type == AnimationTrackType::Step) {
+            track.activeValues = track.values[from];
+            continue;
+        }
+
+        // Both lists are sorted by target id, a missing target has weight 0
+        const auto& morphsFrom = track.values[from];
+        const auto& morphsTo = track.values[to];
+        size_t fromIndex = 0;
+        size_t toIndex = 0;
+        float totalWeight = 0.0f;
+
+        while (fromIndex < morphsFrom.size() || toIndex < morphsTo.size()) {
+            uint32_t fromTargetId = fromIndex < morphsFrom.size() ? morphsFrom[fromIndex].first : ~0u;
+            uint32_t toTargetId = toIndex < morphsTo.size() ? morphsTo[toIndex].first : ~0u;
+            float fromWeight = fromTargetId <= toTargetId ? morphsFrom[fromIndex].second : 0.0f;
+            float toWeight = toTargetId <= fromTargetId ? morphsTo[toIndex].second : 0.0f;
+
+            float weight = fromWeight + (toWeight - fromWeight) * factor;
+            totalWeight += weight;
+            track.activeValues.emplace_back(std::min(fromTargetId, toTargetId), weight);
+
+            if (fromTargetId <= toTargetId)
+                fromIndex++;
+            if (toTargetId <= fromTargetId)
+                toIndex++;
+        }
+
+        std::sort(track.activeValues.begin(), track.activeValues.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        if (totalWeight > 0.0f && totalWeight != 1.0f) {
+            float totalWeightRcp = 1.0f / totalWeight;
+            for (auto& activeValue : track.activeValues)
+                activeValue.second *= totalWeightRcp;
+        }
+    }
+
+    auto sampleVectors = [&](std::vector<VectorAnimationTrack>& tracks, bool isTranslation) {
+        for (VectorAnimationTrack& track : tracks) {
+            uint32_t from = findKeyIndex(track.keys, time);
+            uint32_t to = std::min((uint32_t)track.keys.size() - 1, from + 1);
+            float factor = track.type == AnimationTrackType::Step ? 0.0f : getFactor(track.keys, from, to);
+
+            // "CubicSpline" is sampled as "Linear"
+            uint32_t stride = track.type == AnimationTrackType::CubicSpline && track.values.size() == track.keys.size() * 3 ? 3 : 1;
+            uint32_t offset = stride == 3 ? 1 : 0;
+            vec3 value = mix(track.values[from * stride + offset], track.values[to * stride + offset], factor);
+
+            if (isTranslation)
+                track.node->translation = value;
+            else
+                track.node->scale = value;
+        }
+    };
+
+    sampleVectors(animation.positionTracks, true);
+    sampleVectors(animation.scaleTracks, false);
+
+    for (QuatAnimationTrack& track : animation.rotationTracks) {
+        uint32_t from = findKeyIndex(track.keys, time);
+        uint32_t to = std::min((uint32_t)track.keys.size() - 1, from + 1);
+        float factor = track.type == AnimationTrackType::Step ? 0.0f : getFactor(track.keys, from, to);
+
+        uint32_t stride = track.type == AnimationTrackType::CubicSpline && track.values.size() == track.keys.size() * 3 ? 3 : 1;
+        uint32_t offset = stride == 3 ? 1 : 0;
+        track.node->rotation = SlerpReference(track.values[from * stride + offset], track.values[to * stride + offset], factor);
+    }
+}
@@ -0,0 +1,208 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <string.h>
+
+struct AssetJob {
+    std::string path; // empty for "Run" jobs
+    AssetDecodeFunc decode;
+    std::function<bool()> run;
+    AssetCompletionFunc onComplete;
+    std::vector<uint8_t> fileData;
+    std::promise<bool> promise;
+    std::shared_future<bool> future;
+};
+
+bool AssetHandle::IsReady() const {
+    return m_Job && m_Job->future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+AssetLoader::~AssetLoader() {
+    Shutdown();
+}
+
+void AssetLoader::Initialize(const AssetLoaderDesc& desc) {
+    m_IsSerial = desc.isSerial;
+    if (m_IsSerial)
+        return;
+
+    uint32_t ioThreadNum = std::max(desc.ioThreadNum, 1u);
+    for (uint32_t i = 0; i < ioThreadNum; i++)
+        m_IoPool.threads.emplace_back(&AssetLoader::IoThread, this);
+}
+
+void AssetLoader::Shutdown() {
+    WaitAll();
+
+    {
+        std::lock_guard<std::mutex> lock(m_IoPool.mutex);
+        m_IoPool.isStopping = true;
+    }
+
+    m_IoPool.condition.notify_all();
+
+    for (std::thread& thread : m_IoPool.threads)
+        thread.join();
+
+    m_IoPool.threads.clear();
+    m_IoPool.isStopping = false;
+}
+
+AssetHandle AssetLoader::Load(const std::string& path, const AssetDecodeFunc& decode, const AssetCompletionFunc& onComplete) {
+    std::shared_ptr<AssetJob> job = std::make_shared<AssetJob>();
+    job->path = path;
+    job->decode = decode;
+    job->onComplete = onComplete;
+
+    Issue(job);
+
+    AssetHandle handle;
+    handle.m_Job = job;
+
+    return handle;
+}
+
+AssetHandle AssetLoader::Run(const std::function<bool()>& run, const AssetCompletionFunc& onComplete) {
+    std::shared_ptr<AssetJob> job = std::make_shared<AssetJob>();
+    job->run = run;
+    job->onComplete = onComplete;
+
+    Issue(job);
+
+    AssetHandle handle;
+    handle.m_Job = job;
+
+    return handle;
+}
+
+AssetHandle AssetLoader::LoadTexture(const std::string& path, utils::Texture& texture, bool computeAvgColorAndAlphaMode, const AssetCompletionFunc& onComplete) {
+    // Detex can load KTX and DDS only from files, KTX2 levels are read by file offset
+    const char* ext = strrchr(path.c_str(), '.');
+    bool isContainer = ext && (!strcmp(ext, ".dds") || !strcmp(ext, ".DDS") || !strcmp(ext, ".ktx") || !strcmp(ext, ".KTX") || !strcmp(ext, ".ktx2") || !strcmp(ext, ".KTX2"));
+
+    if (isContainer) {
+        return Run([path, &texture, computeAvgColorAndAlphaMode]() {
+            return utils::LoadTexture(path, texture, computeAvgColorAndAlphaMode);
+        }, onComplete);
+    }
+
+    return Load(path, [path, &texture, computeAvgColorAndAlphaMode](std::vector<uint8_t>& fileData) {
+        return utils::LoadTextureFromMemory(path, fileData.data(), (int)fileData.size(), texture, computeAvgColorAndAlphaMode);
+    }, onComplete);
+}
+
+bool AssetLoader::Wait(const AssetHandle& handle) {
+    if (!handle.m_Job)
+        return false;
+
+    const std::shared_ptr<AssetJob>& job = handle.m_Job;
+    bool isLoaded = job->future.get();
+
+    // Only the completion of this job: processing all completions here would make a "Wait" inside a callback run
+    // other callbacks (and their "Wait"s) reentrantly, down to the callback already on the stack
+    bool isPending = false;
+    {
+        std::lock_guard<std::mutex> lock(m_CompletedMutex);
+        auto it = std::find(m_Completed.begin(), m_Completed.end(), job);
+        if (it != m_Completed.end()) {
+            m_Completed.erase(it);
+            isPending = true;
+        }
+    }
+
+    if (isPending && job->onComplete)
+        job->onComplete(isLoaded);
+
+    return isLoaded;
+}
+
+void AssetLoader::WaitAll() {
+    {
+        std::unique_lock<std::mutex> lock(m_CompletedMutex);
+        m_CompletedCondition.wait(lock, [this]() { return m_PendingJobNum.load() == 0; });
+    }
+
+    ProcessCompletions();
+}
+
+uint32_t AssetLoader::ProcessCompletions() {
+    std::vector<std::shared_ptr<AssetJob>> completed;
+    {
+        std::lock_guard<std::mutex> lock(m_CompletedMutex);
+        completed.swap(m_Completed);
+    }
+
+    for (const std::shared_ptr<AssetJob>& job : completed) {
+        if (job->onComplete)
+            job->onComplete(job->future.get());
+    }
+
+    return (uint32_t)completed.size();
+}
+
+void AssetLoader::Issue(const std::shared_ptr<AssetJob>& job) {
+    job->future = job->promise.get_future().share();
+    m_PendingJobNum++;
+
+    if (m_IsSerial) {
+        if (!job->path.empty() && !utils::LoadFile(job->path, job->fileData))
+            job->decode = nullptr;
+
+        Decode(job);
+    } else if (job->path.empty())
+        SubmitDecode(job);
+    else {
+        {
+            std::lock_guard<std::mutex> lock(m_IoPool.mutex);
+            m_IoPool.jobs.push_back(job);
+        }
+
+        m_IoPool.condition.notify_one();
+    }
+}
+
+void AssetLoader::Decode(const std::shared_ptr<AssetJob>& job) {
+    bool isLoaded = false;
+    if (job->run)
+        isLoaded = job->run();
+    else if (job->decode)
+        isLoaded = job->decode(job->fileData);
+
+    // File contents are not needed anymore
+    job->fileData.clear();
+    job->fileData.shrink_to_fit();
+
+    // The completion must be visible once the future is ready. Workers are not joined by "Shutdown", so nothing touches
+    // the loader after the unlock (it can be destroyed by then)
+    std::lock_guard<std::mutex> lock(m_CompletedMutex);
+    m_Completed.push_back(job);
+    job->promise.set_value(isLoaded);
+    m_PendingJobNum--;
+    m_CompletedCondition.notify_all();
+}
+
+void AssetLoader::SubmitDecode(const std::shared_ptr<AssetJob>& job) {
+    utils::JobSystem::GetShared().Submit([this, job]() { Decode(job); });
+}
+
+void AssetLoader::IoThread() {
+    while (true) {
+        std::shared_ptr<AssetJob> job;
+        {
+            std::unique_lock<std::mutex> lock(m_IoPool.mutex);
+            m_IoPool.condition.wait(lock, [this]() { return m_IoPool.isStopping || !m_IoPool.jobs.empty(); });
+
+            if (m_IoPool.jobs.empty())
+                return;
+
+            job = std::move(m_IoPool.jobs.front());
+            m_IoPool.jobs.pop_front();
+        }
+
+        // A failed read still goes through decoding to finish the job
+        if (!utils::LoadFile(job->path, job->fileData))
+            job->decode = nullptr;
+
+        SubmitDecode(job);
+    }
+}
@@ -0,0 +1,388 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+struct ProfilerScope {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+    uint32_t depth;
+};
+
+struct ProfilerLane {
+    std::string name;
+    std::vector<ProfilerScope> scopes;
+    uint32_t depthNum;
+};
+
+struct ProfilerFrame {
+    uint64_t ticks;
+    uint32_t index;
+};
+
+struct Profiler {
+    std::mutex lock; // registration and readers
+    std::vector<std::unique_ptr<utils::CpuProfilerThread>> threads;
+    std::vector<utils::CpuProfilerThread*> freeThreads;
+    std::array<ProfilerFrame, utils::CPU_PROFILER_FRAME_NUM> frames = {};
+    std::atomic<uint64_t> frameHead = 0;
+
+    // Calibration
+    uint64_t originTicks = 0;
+    std::chrono::steady_clock::time_point originTime;
+
+    // Flame graph
+    std::vector<ProfilerLane> lanes;
+    uint64_t frameBegin = 0;
+    uint64_t frameEnd = 0;
+    uint32_t frameIndex = 0;
+    bool isPaused = false;
+};
+
+// Returns the buffer for reuse when the thread exits
+struct ProfilerThreadOwner {
+    utils::CpuProfilerThread* thread = nullptr;
+    char name[32] = {};
+
+    ~ProfilerThreadOwner();
+};
+
+static Profiler& GetProfiler() {
+    static Profiler profiler;
+
+    return profiler;
+}
+
+static thread_local ProfilerThreadOwner t_ThreadOwner;
+
+ProfilerThreadOwner::~ProfilerThreadOwner() {
+    if (!thread)
+        return;
+
+    Profiler& profiler = GetProfiler();
+    std::lock_guard<std::mutex> lock(profiler.lock);
+
+    profiler.freeThreads.push_back(thread);
+}
+
+static double GetMicrosecondsPerTick(Profiler& profiler) {
+    // Wait a bit if just enabled, short intervals give imprecise ratios
+    uint64_t ticks = 0;
+    std::chrono::steady_clock::duration duration;
+    do {
+        ticks = utils::GetCpuProfilerTicks();
+        duration = std::chrono::steady_clock::now() - profiler.originTime;
+    } while (duration < std::chrono::milliseconds(1));
+
+    double us = std::chrono::duration<double, std::micro>(duration).count();
+
+    return ticks > profiler.originTicks ? us / double(ticks - profiler.originTicks) : 0.0;
+}
+
+// Lock-free with respect to the owner. Events overwritten during the copy can be torn, they are dropped
+static void ReadEvents(const utils::CpuProfilerThread& thread, std::vector<utils::CpuProfilerEvent>& events) {
+    uint64_t head = thread.head.load(std::memory_order_acquire);
+    uint64_t begin = head > utils::CPU_PROFILER_EVENT_NUM ? head - utils::CPU_PROFILER_EVENT_NUM : 0;
+
+    events.clear();
+    for (uint64_t i = begin; i < head; i++)
+        events.push_back(thread.events[i & (utils::CPU_PROFILER_EVENT_NUM - 1)]);
+
+    uint64_t headAfter = thread.head.load(std::memory_order_acquire);
+    uint64_t validBegin = headAfter > utils::CPU_PROFILER_EVENT_NUM ? headAfter - utils::CPU_PROFILER_EVENT_NUM : 0;
+    if (validBegin > begin)
+        events.erase(events.begin(), events.begin() + (size_t)std::min(validBegin - begin, (uint64_t)events.size()));
+}
+
+// Ends without begins (lost in the ring) are skipped, open scopes are not complete yet
+static uint32_t BuildScopes(const std::vector<utils::CpuProfilerEvent>& events, std::vector<ProfilerScope>& scopes) {
+    utils::CpuProfilerEvent stack[utils::CPU_PROFILER_DEPTH_MAX];
+    uint32_t depth = 0;
+    uint32_t depthNum = 0;
+
+    scopes.clear();
+    for (const utils::CpuProfilerEvent& event : events) {
+        if (event.name) {
+            if (depth < utils::CPU_PROFILER_DEPTH_MAX)
+                stack[depth] = event;
+            depth++;
+        } else if (depth) {
+            depth--;
+            if (depth < utils::CPU_PROFILER_DEPTH_MAX) {
+                scopes.push_back({stack[depth].name, stack[depth].ticks, event.ticks, depth});
+                depthNum = std::max(depthNum, depth + 1);
+            }
+        }
+    }
+
+    return depthNum;
+}
+
+static void WriteJsonString(FILE* file, const char* s) {
+    fputc('"', file);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fputc('\\', file);
+        if ((uint8_t)*s >= 0x20)
+            fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+utils::CpuProfilerThread* utils::RegisterCpuProfilerThread() {
+    Profiler& profiler = GetProfiler();
+    std::lock_guard<std::mutex> lock(profiler.lock);
+
+    CpuProfilerThread* thread = nullptr;
+    if (!profiler.freeThreads.empty()) {
+        thread = profiler.freeThreads.back();
+        profiler.freeThreads.pop_back();
+    } else {
+        profiler.threads.emplace_back(std::make_unique<CpuProfilerThread>());
+
+        thread = profiler.threads.back().get();
+        thread->index = (uint32_t)profiler.threads.size() - 1;
+    }
+
+    thread->head.store(0, std::memory_order_relaxed);
+    if (t_ThreadOwner.name[0])
+        memcpy(thread->name, t_ThreadOwner.name, sizeof(thread->name));
+    else
+        snprintf(thread->name, sizeof(thread->name), "Thread %u", thread->index);
+
+    t_ThreadOwner.thread = thread;
+
+    return thread;
+}
+
+utils::CpuProfilerThread* utils::RegisterCpuProfilerLane(const char* name) {
+    Profiler& profiler = GetProfiler();
+    std::lock_guard<std::mutex> lock(profiler.lock);
+
+    profiler.threads.emplace_back(std::make_unique<CpuProfilerThread>());
+
+    CpuProfilerThread* lane = profiler.threads.back().get();
+    lane->head.store(0, std::memory_order_relaxed);
+    lane->index = (uint32_t)profiler.threads.size() - 1;
+    snprintf(lane->name, sizeof(lane->name), "%s", name);
+
+    return lane;
+}
+
+void utils::EnableCpuProfiler(bool enable) {
+    Profiler& profiler = GetProfiler();
+
+    if (enable && !profiler.originTicks) {
+        profiler.originTicks = GetCpuProfilerTicks();
+        profiler.originTime = std::chrono::steady_clock::now();
+    }
+
+    g_IsCpuProfilerEnabled.store(enable, std::memory_order_relaxed);
+}
+
+void utils::SetCpuProfilerThreadName(const char* name) {
+    snprintf(t_ThreadOwner.name, sizeof(t_ThreadOwner.name), "%s", name);
+
+    if (t_ThreadOwner.thread) {
+        std::lock_guard<std::mutex> lock(GetProfiler().lock);
+        memcpy(t_ThreadOwner.thread->name, t_ThreadOwner.name, sizeof(t_ThreadOwner.name));
+    }
+}
+
+void utils::MarkCpuProfilerFrame(uint32_t frameIndex) {
+    if (!IsCpuProfilerEnabled())
+        return;
+
+    Profiler& profiler = GetProfiler();
+    uint64_t i = profiler.frameHead.load(std::memory_order_relaxed);
+
+    profiler.frames[i % CPU_PROFILER_FRAME_NUM] = {GetCpuProfilerTicks(), frameIndex};
+    profiler.frameHead.store(i + 1, std::memory_order_release);
+}
+
+double utils::GetCpuProfilerTicksPerSecond() {
+    Profiler& profiler = GetProfiler();
+    if (!profiler.originTicks)
+        return 0.0;
+
+    double usPerTick = GetMicrosecondsPerTick(profiler);
+
+    return usPerTick > 0.0 ? 1e6 / usPerTick : 0.0;
+}
+
+bool utils::WriteCpuProfilerTrace(const char* path) {
+    Profiler& profiler = GetProfiler();
+    if (!profiler.originTicks) {
+        printf("ERROR: the CPU profiler has never been enabled, nothing to write\n");
+        return false;
+    }
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("ERROR: can't write the CPU trace to '%s'\n", path);
+        return false;
+    }
+
+    double usPerTick = GetMicrosecondsPerTick(profiler);
+    auto ToMicroseconds = [&](uint64_t ticks) {
+        return ticks > profiler.originTicks ? double(ticks - profiler.originTicks) * usPerTick : 0.0;
+    };
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    std::vector<CpuProfilerEvent> events;
+    std::vector<ProfilerScope> scopes;
+    events.reserve(CPU_PROFILER_EVENT_NUM);
+
+    size_t eventNum = 0;
+    {
+        std::lock_guard<std::mutex> lock(profiler.lock);
+
+        for (const std::unique_ptr<CpuProfilerThread>& thread : profiler.threads) {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", eventNum++ ? ",\n" : "", thread->index);
+            WriteJsonString(file, thread->name);
+            fprintf(file, "}}");
+
+            ReadEvents(*thread, events);
+            BuildScopes(events, scopes);
+
+            for (const ProfilerScope& scope : scopes) {
+                fprintf(file, ",\n{\"name\":");
+                WriteJsonString(file, scope.name);
+                fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", thread->index, ToMicroseconds(scope.begin), double(scope.end - scope.begin) * usPerTick);
+                eventNum++;
+            }
+        }
+    }
+
+    uint64_t frameHead = profiler.frameHead.load(std::memory_order_acquire);
+    uint64_t frameBegin = frameHead > CPU_PROFILER_FRAME_NUM ? frameHead - CPU_PROFILER_FRAME_NUM : 0;
+    for (uint64_t i = frameBegin; i < frameHead; i++) {
+        const ProfilerFrame& frame = profiler.frames[i % CPU_PROFILER_FRAME_NUM];
+        fprintf(file, "%s{\"name\":\"Frame %u\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}", eventNum++ ? ",\n" : "", frame.index, ToMicroseconds(frame.ticks));
+    }
+
+    fprintf(file, "\n]}\n");
+
+    bool result = ferror(file) == 0;
+    fclose(file);
+
+    if (result)
+        printf("CPU trace written to '%s' (%zu events)\n", path, eventNum);
+
+    return result;
+}
+
+static void UpdateFlameGraph(Profiler& profiler) {
+    uint64_t frameHead = profiler.frameHead.load(std::memory_order_acquire);
+    if (frameHead < 2)
+        return;
+
+    const ProfilerFrame& frameBegin = profiler.frames[(frameHead - 2) % utils::CPU_PROFILER_FRAME_NUM];
+    const ProfilerFrame& frameEnd = profiler.frames[(frameHead - 1) % utils::CPU_PROFILER_FRAME_NUM];
+    profiler.frameBegin = frameBegin.ticks;
+    profiler.frameEnd = frameEnd.ticks;
+    profiler.frameIndex = frameBegin.index;
+
+    std::vector<utils::CpuProfilerEvent> events;
+    std::vector<ProfilerScope> scopes;
+
+    std::lock_guard<std::mutex> lock(profiler.lock);
+
+    profiler.lanes.resize(profiler.threads.size());
+    for (size_t i = 0; i < profiler.threads.size(); i++) {
+        const utils::CpuProfilerThread& thread = *profiler.threads[i];
+        ProfilerLane& lane = profiler.lanes[i];
+
+        ReadEvents(thread, events);
+        BuildScopes(events, scopes);
+
+        lane.name = thread.name;
+        lane.scopes.clear();
+        lane.depthNum = 0;
+        for (const ProfilerScope& scope : scopes) {
+            if (scope.end > profiler.frameBegin && scope.begin < profiler.frameEnd) {
+                lane.scopes.push_back(scope);
+                lane.depthNum = std::max(lane.depthNum, scope.depth + 1);
+            }
+        }
+    }
+}
+
+void utils::ShowCpuProfilerWindow(bool* isOpen) {
+    ImGui::SetNextWindowSize(ImVec2(640.0f, 320.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("CPU profiler", isOpen)) {
+        ImGui::End();
+        return;
+    }
+
+    Profiler& profiler = GetProfiler();
+
+    bool isEnabled = IsCpuProfilerEnabled();
+    if (ImGui::Checkbox("Enabled", &isEnabled))
+        EnableCpuProfiler(isEnabled);
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause", &profiler.isPaused);
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace"))
+        WriteCpuProfilerTrace("CpuTrace.json");
+
+    if (!profiler.isPaused && isEnabled)
+        UpdateFlameGraph(profiler);
+
+    if (profiler.frameEnd <= profiler.frameBegin) {
+        ImGui::TextUnformatted("No complete frames");
+        ImGui::End();
+        return;
+    }
+
+    double msPerTick = GetMicrosecondsPerTick(profiler) * 0.001;
+    ImGui::Text("Frame %u: %.3f ms", profiler.frameIndex, double(profiler.frameEnd - profiler.frameBegin) * msPerTick);
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    const double pixelsPerTick = width / double(profiler.frameEnd - profiler.frameBegin);
+
+    for (const ProfilerLane& lane : profiler.lanes) {
+        if (lane.scopes.empty())
+            continue;
+
+        ImGui::TextUnformatted(lane.name.c_str());
+
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float height = lane.depthNum * rowHeight;
+        drawList->PushClipRect(origin, ImVec2(origin.x + width, origin.y + height), true);
+
+        for (const ProfilerScope& scope : lane.scopes) {
+            float x0 = origin.x + float((int64_t)(scope.begin - profiler.frameBegin) * pixelsPerTick);
+            float x1 = origin.x + float((int64_t)(scope.end - profiler.frameBegin) * pixelsPerTick);
+            x0 = std::max(x0, origin.x);
+            x1 = std::min(std::max(x1, x0 + 1.0f), origin.x + width);
+
+            const ImVec2 min = ImVec2(x0, origin.y + scope.depth * rowHeight);
+            const ImVec2 max = ImVec2(x1, min.y + rowHeight - 1.0f);
+
+            // The same name - the same color
+            uint32_t hash = (uint32_t)(((uintptr_t)scope.name >> 3) * 2654435761u);
+            drawList->AddRectFilled(min, max, (ImU32)ImColor::HSV((hash >> 8) / 16777216.0f, 0.45f, 0.75f));
+
+            const float textWidth = ImGui::CalcTextSize(scope.name).x;
+            if (textWidth + 4.0f < x1 - x0)
+                drawList->AddText(ImVec2(x0 + 2.0f, min.y + 2.0f), IM_COL32_BLACK, scope.name);
+
+            if (ImGui::IsMouseHoveringRect(min, max))
+                ImGui::SetTooltip("%s\n%.3f ms", scope.name, double(scope.end - scope.begin) * msPerTick);
+        }
+
+        drawList->PopClipRect();
+        ImGui::Dummy(ImVec2(width, height));
+    }
+
+    ImGui::End();
+}
@@ -1,22 +1,109 @@
 #if _WIN32
 #    include <windows.h>
+#    include <dbghelp.h>
+#    pragma comment(lib, "dbghelp.lib")
+#elif __has_include(<execinfo.h>)
+#    include <execinfo.h>
+#    define ALLOCATION_PROFILER_BACKTRACE
 #endif
 
+#include <algorithm>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include "NRIFramework.h"
 
+constexpr uint32_t CALL_SITE_NONE = uint32_t(-1);
+constexpr uint32_t REPORT_CALL_SITE_NUM = 32;
+
+// Written only by the owning thread (no RMW atomics), readers sum all threads. Frees are counted by the freeing thread
+struct AllocationTagCounters {
+    std::atomic_uint64_t allocationNum = 0;
+    std::atomic_uint64_t allocatedSize = 0;
+    std::atomic_uint64_t freeNum = 0;
+    std::atomic_uint64_t freedSize = 0;
+};
+
+struct alignas(64) AllocationThreadCounters {
+    std::array<AllocationTagCounters, (size_t)utils::AllocationTag::MAX_NUM> tags;
+};
+
+// Frame loop thread only
+struct AllocationTagFrame {
+    uint64_t allocationNum; // totals at the last mark
+    uint64_t allocatedSize;
+    uint64_t frameAllocationNum; // the last frame
+    uint64_t frameAllocatedSize;
+    uint64_t peakLiveSize; // sampled at marks
+    uint64_t frameNum;
+    uint32_t steadyFrameNum;
+};
+
+struct AllocationThreadCache {
+    uint64_t allocatorId;
+    AllocationThreadCounters* counters;
+};
+
+struct CallSite {
+    void* frames[utils::ALLOCATION_PROFILER_STACK_DEPTH];
+    uint64_t hash;
+    uint64_t sampleNum;
+    uint64_t sampledSize;
+    uint64_t frameSampleNum; // sampled inside the frame loop (after the first "MarkAllocationFrame")
+    uint64_t liveSampleNum;
+    uint32_t depth;
+    utils::AllocationTag tag;
+};
+
 struct DebugAllocator {
     std::atomic_uint64_t allocationNum = 0;
     std::atomic_size_t allocatedSize = 0;
+
+    // Profiling
+    std::mutex lock; // threads and call sites
+    std::vector<std::unique_ptr<AllocationThreadCounters>> threads;
+    std::unordered_map<std::thread::id, AllocationThreadCounters*> threadMap;
+    std::vector<CallSite> callSites;
+    std::unordered_map<uint64_t, uint32_t> callSiteMap;
+    std::array<AllocationTagFrame, (size_t)utils::AllocationTag::MAX_NUM> frames = {};
+    std::atomic_uint32_t sampleInterval = 0;
+    std::atomic_uint64_t markedFrameNum = 0;
+    uint64_t id;
 };
 
 struct DebugAllocatorHeader {
     size_t size;
     uint32_t alignment;
     uint32_t offset;
+    uint32_t callSite;
+    utils::AllocationTag tag;
+    bool isProfiled;
+};
+
+// Shared by all allocators, the interval restarts if it changes
+static thread_local uint32_t t_SampleCountdown = 0;
+
+// The last used allocator (ids are never reused, unlike addresses)
+static thread_local AllocationThreadCache t_ThreadCache = {};
+static std::atomic_uint64_t g_AllocatorId = 0;
+
+static const char* g_AllocationTagNames[] = {
+    "Unknown",
+    "Device",
+    "SwapChain",
+    "Streamer",
+    "DescriptorPool",
+    "Pipeline",
+    "Resource",
+    "CommandBuffer",
+    "UI",
 };
 
+static_assert(helper::GetCountOf(g_AllocationTagNames) == (size_t)utils::AllocationTag::MAX_NUM, "Unexpected number of tags");
+
 inline void ReportAllocatorError(const char* message) {
 #if _WIN32
     OutputDebugStringA(message);
@@ -29,6 +116,138 @@ inline DebugAllocatorHeader* GetAllocationHeader(void* memory) {
     return (DebugAllocatorHeader*)memory - 1;
 }
 
+inline void AddCounter(std::atomic_uint64_t& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static AllocationThreadCounters& GetThreadCounters(DebugAllocator& allocator) {
+    if (t_ThreadCache.allocatorId == allocator.id)
+        return *t_ThreadCache.counters;
+
+    // Slow path, once per thread (or allocator switch)
+    std::lock_guard<std::mutex> lock(allocator.lock);
+
+    AllocationThreadCounters*& counters = allocator.threadMap[std::this_thread::get_id()];
+    if (!counters)
+        counters = allocator.threads.emplace_back(std::make_unique<AllocationThreadCounters>()).get();
+
+    t_ThreadCache = {allocator.id, counters};
+
+    return *counters;
+}
+
+static utils::AllocationTagStats SumTagCounters(DebugAllocator& allocator, utils::AllocationTag tag) {
+    utils::AllocationTagStats stats = {};
+    uint64_t freeNum = 0;
+    uint64_t freedSize = 0;
+
+    std::lock_guard<std::mutex> lock(allocator.lock);
+    for (const std::unique_ptr<AllocationThreadCounters>& thread : allocator.threads) {
+        const AllocationTagCounters& counters = thread->tags[(size_t)tag];
+        stats.allocationNum += counters.allocationNum.load(std::memory_order_relaxed);
+        stats.allocatedSize += counters.allocatedSize.load(std::memory_order_relaxed);
+        freeNum += counters.freeNum.load(std::memory_order_relaxed);
+        freedSize += counters.freedSize.load(std::memory_order_relaxed);
+    }
+
+    // Racy snapshot, frees may be seen before their allocations
+    stats.liveNum = stats.allocationNum > freeNum ? stats.allocationNum - freeNum : 0;
+    stats.liveSize = stats.allocatedSize > freedSize ? stats.allocatedSize - freedSize : 0;
+
+    return stats;
+}
+
+static uint32_t CaptureCallSite(DebugAllocator& allocator, utils::AllocationTag tag, size_t size) {
+    void* frames[utils::ALLOCATION_PROFILER_STACK_DEPTH] = {};
+
+    // Skip this function and the allocation callback
+#if _WIN32
+    uint32_t frameNum = CaptureStackBackTrace(2, utils::ALLOCATION_PROFILER_STACK_DEPTH, frames, nullptr);
+#elif defined(ALLOCATION_PROFILER_BACKTRACE)
+    void* rawFrames[utils::ALLOCATION_PROFILER_STACK_DEPTH + 2];
+    int rawFrameNum = backtrace(rawFrames, utils::ALLOCATION_PROFILER_STACK_DEPTH + 2);
+
+    uint32_t frameNum = rawFrameNum > 2 ? uint32_t(rawFrameNum - 2) : 0;
+    for (uint32_t i = 0; i < frameNum; i++)
+        frames[i] = rawFrames[i + 2];
+#else
+    uint32_t frameNum = 0;
+#endif
+
+    // FNV-1a, the tag is a part of the key
+    uint64_t hash = 14695981039346656037ull ^ (uint64_t)tag;
+    for (uint32_t i = 0; i < frameNum; i++)
+        hash = (hash ^ (uint64_t)frames[i]) * 1099511628211ull;
+
+    bool isFrame = allocator.markedFrameNum.load(std::memory_order_relaxed) != 0;
+
+    std::lock_guard<std::mutex> lock(allocator.lock);
+
+    uint32_t index;
+    auto it = allocator.callSiteMap.find(hash);
+    if (it != allocator.callSiteMap.end())
+        index = it->second;
+    else {
+        if (allocator.callSites.size() >= utils::ALLOCATION_PROFILER_CALL_SITE_MAX_NUM)
+            return CALL_SITE_NONE;
+
+        index = (uint32_t)allocator.callSites.size();
+        allocator.callSiteMap.emplace(hash, index);
+
+        CallSite& callSite = allocator.callSites.emplace_back();
+        callSite = {};
+        memcpy(callSite.frames, frames, sizeof(frames));
+        callSite.hash = hash;
+        callSite.depth = frameNum;
+        callSite.tag = tag;
+    }
+
+    CallSite& callSite = allocator.callSites[index];
+    callSite.sampleNum++;
+    callSite.sampledSize += size;
+    callSite.liveSampleNum++;
+    if (isFrame)
+        callSite.frameSampleNum++;
+
+    return index;
+}
+
+static void RecordAllocation(DebugAllocator& allocator, DebugAllocatorHeader& header) {
+    uint32_t sampleInterval = allocator.sampleInterval.load(std::memory_order_relaxed);
+    if (!sampleInterval)
+        return;
+
+    utils::AllocationTag tag = utils::GetAllocationTag();
+    AllocationTagCounters& counters = GetThreadCounters(allocator).tags[(size_t)tag];
+
+    AddCounter(counters.allocationNum, 1);
+    AddCounter(counters.allocatedSize, header.size);
+
+    header.tag = tag;
+    header.isProfiled = true;
+    header.callSite = CALL_SITE_NONE;
+
+    if (t_SampleCountdown == 0 || t_SampleCountdown > sampleInterval)
+        t_SampleCountdown = sampleInterval;
+
+    if (--t_SampleCountdown == 0)
+        header.callSite = CaptureCallSite(allocator, tag, header.size);
+}
+
+static void RecordFree(DebugAllocator& allocator, const DebugAllocatorHeader& header) {
+    if (!header.isProfiled)
+        return;
+
+    AllocationTagCounters& counters = GetThreadCounters(allocator).tags[(size_t)header.tag];
+    AddCounter(counters.freeNum, 1);
+    AddCounter(counters.freedSize, header.size);
+
+    if (header.callSite != CALL_SITE_NONE) {
+        std::lock_guard<std::mutex> lock(allocator.lock);
+        allocator.callSites[header.callSite].liveSampleNum--;
+    }
+}
+
 static void* DebugAlignedMalloc(void* userArg, size_t size, size_t alignment) {
     DebugAllocator* allocator = (DebugAllocator*)userArg;
 
@@ -54,6 +273,8 @@ static void* DebugAlignedMalloc(void* userArg, size_t size, size_t alignment) {
     allocator->allocatedSize.fetch_add(allocationSize, std::memory_order_relaxed);
     allocator->allocationNum.fetch_add(1, std::memory_order_relaxed);
 
+    RecordAllocation(*allocator, *header);
+
     return alignedMemory;
 }
 
@@ -91,6 +312,10 @@ static void* DebugAlignedRealloc(void* userArg, void* memory, size_t size, size_
     newHeader->alignment = (uint32_t)alignment;
     newHeader->offset = (uint32_t)(alignedMemory - newMemory);
 
+    // A free and an allocation in the current scope
+    RecordFree(*allocator, prevHeader);
+    RecordAllocation(*allocator, *newHeader);
+
     return alignedMemory;
 }
 
@@ -109,12 +334,186 @@ static void DebugAlignedFree(void* userArg, void* memory) {
     if (allocationNum == 0)
         ReportAllocatorError("DebugAlignedFree() failed: invalid allocation number.\n");
 
+    RecordFree(*allocator, *header);
+
     free((uint8_t*)memory - header->offset);
 }
 
+static DebugAllocator* GetDebugAllocator(const nri::AllocationCallbacks& allocationCallbacks) {
+    if (allocationCallbacks.Allocate != DebugAlignedMalloc)
+        return nullptr;
+
+    return (DebugAllocator*)allocationCallbacks.userArg;
+}
+
+static void PrintCallSite(FILE* file, const CallSite& callSite) {
+#if _WIN32
+    static bool isSymbolHandlerInitialized = false;
+    if (!isSymbolHandlerInitialized) {
+        SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+        SymInitialize(GetCurrentProcess(), nullptr, TRUE);
+        isSymbolHandlerInitialized = true;
+    }
+
+    for (uint32_t i = 0; i < callSite.depth; i++) {
+        DWORD64 address = (DWORD64)callSite.frames[i];
+
+        alignas(SYMBOL_INFO) char buffer[sizeof(SYMBOL_INFO) + 256];
+        SYMBOL_INFO* symbol = (SYMBOL_INFO*)buffer;
+        symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+        symbol->MaxNameLen = 255;
+
+        IMAGEHLP_LINE64 line = {};
+        line.SizeOfStruct = sizeof(line);
+        DWORD displacement = 0;
+
+        if (!SymFromAddr(GetCurrentProcess(), address, nullptr, symbol))
+            fprintf(file, "        0x%llx\n", (unsigned long long)address);
+        else if (SymGetLineFromAddr64(GetCurrentProcess(), address, &displacement, &line))
+            fprintf(file, "        %s (%s:%lu)\n", symbol->Name, line.FileName, line.LineNumber);
+        else
+            fprintf(file, "        %s\n", symbol->Name);
+    }
+#elif defined(ALLOCATION_PROFILER_BACKTRACE)
+    char** symbols = backtrace_symbols(callSite.frames, (int)callSite.depth);
+    for (uint32_t i = 0; i < callSite.depth; i++)
+        fprintf(file, "        %s\n", symbols ? symbols[i] : "?");
+
+    free(symbols);
+#else
+    (void)file;
+    (void)callSite;
+#endif
+}
+
+const char* utils::GetAllocationTagName(AllocationTag tag) {
+    return g_AllocationTagNames[(size_t)tag];
+}
+
+void utils::EnableAllocationProfiler(const nri::AllocationCallbacks& allocationCallbacks, uint32_t sampleInterval) {
+    DebugAllocator* allocator = GetDebugAllocator(allocationCallbacks);
+    if (allocator)
+        allocator->sampleInterval.store(sampleInterval, std::memory_order_relaxed);
+}
+
+bool utils::IsAllocationProfilerEnabled(const nri::AllocationCallbacks& allocationCallbacks) {
+    DebugAllocator* allocator = GetDebugAllocator(allocationCallbacks);
+
+    return allocator && allocator->sampleInterval.load(std::memory_order_relaxed) != 0;
+}
+
+void utils::MarkAllocationFrame(const nri::AllocationCallbacks& allocationCallbacks) {
+    DebugAllocator* allocator = GetDebugAllocator(allocationCallbacks);
+    if (!allocator || !allocator->sampleInterval.load(std::memory_order_relaxed))
+        return;
+
+    // The first mark opens the first frame, there is nothing to close
+    bool isFirst = allocator->markedFrameNum.fetch_add(1, std::memory_order_relaxed) == 0;
+
+    for (uint32_t i = 0; i < (uint32_t)AllocationTag::MAX_NUM; i++) {
+        AllocationTagStats stats = SumTagCounters(*allocator, (AllocationTag)i);
+        AllocationTagFrame& frame = allocator->frames[i];
+
+        if (!isFirst) {
+            frame.frameAllocationNum = stats.allocationNum - frame.allocationNum;
+            frame.frameAllocatedSize = stats.allocatedSize - frame.allocatedSize;
+
+            if (frame.frameAllocationNum) {
+                frame.frameNum++;
+                frame.steadyFrameNum++;
+            } else
+                frame.steadyFrameNum = 0;
+        }
+
+        frame.allocationNum = stats.allocationNum;
+        frame.allocatedSize = stats.allocatedSize;
+        frame.peakLiveSize = std::max(frame.peakLiveSize, stats.liveSize);
+    }
+}
+
+utils::AllocationTagStats utils::GetAllocationTagStats(const nri::AllocationCallbacks& allocationCallbacks, AllocationTag tag) {
+    AllocationTagStats stats = {};
+
+    DebugAllocator* allocator = GetDebugAllocator(allocationCallbacks);
+    if (!allocator)
+        return stats;
+
+    const AllocationTagFrame& frame = allocator->frames[(size_t)tag];
+
+    stats = SumTagCounters(*allocator, tag);
+    stats.peakLiveSize = std::max(frame.peakLiveSize, stats.liveSize);
+    stats.frameAllocationNum = frame.frameAllocationNum;
+    stats.frameAllocatedSize = frame.frameAllocatedSize;
+    stats.frameNum = frame.frameNum;
+    stats.steadyFrameNum = frame.steadyFrameNum;
+
+    return stats;
+}
+
+bool utils::WriteAllocationReport(const nri::AllocationCallbacks& allocationCallbacks, const char* path) {
+    DebugAllocator* allocator = GetDebugAllocator(allocationCallbacks);
+    if (!allocator || !allocator->sampleInterval.load(std::memory_order_relaxed))
+        return false;
+
+    FILE* file = path ? fopen(path, "w") : stdout;
+    if (!file) {
+        printf("Can't write allocation report to '%s'\n", path);
+        return false;
+    }
+
+    uint64_t markedFrameNum = allocator->markedFrameNum.load(std::memory_order_relaxed);
+    uint32_t sampleInterval = allocator->sampleInterval.load(std::memory_order_relaxed);
+
+    fprintf(file, "Allocations (%llu frames, call stacks of every %u-th allocation):\n", (unsigned long long)(markedFrameNum ? markedFrameNum - 1 : 0), sampleInterval);
+    fprintf(file, "  %-16s %12s %12s %12s %12s %12s %14s\n", "Subsystem", "Allocations", "Total Kb", "Live", "Live Kb", "Peak Kb", "Last frame");
+
+    for (uint32_t i = 0; i < (uint32_t)AllocationTag::MAX_NUM; i++) {
+        AllocationTagStats stats = GetAllocationTagStats(allocationCallbacks, (AllocationTag)i);
+        if (!stats.allocationNum)
+            continue;
+
+        fprintf(file, "  %-16s %12llu %12.1f %12llu %12.1f %12.1f %7llu (%4.1f Kb)%s\n", GetAllocationTagName((AllocationTag)i), (unsigned long long)stats.allocationNum,
+            stats.allocatedSize / 1024.0, (unsigned long long)stats.liveNum, stats.liveSize / 1024.0, stats.peakLiveSize / 1024.0, (unsigned long long)stats.frameAllocationNum,
+            stats.frameAllocatedSize / 1024.0, stats.steadyFrameNum >= ALLOCATION_PROFILER_STEADY_FRAME_NUM ? " STEADY STATE" : "");
+    }
+
+    // Call sites: allocating inside the frame loop first
+    std::vector<CallSite> callSites;
+    {
+        std::lock_guard<std::mutex> lock(allocator->lock);
+        callSites = allocator->callSites;
+    }
+
+    std::sort(callSites.begin(), callSites.end(), [](const CallSite& a, const CallSite& b) {
+        return a.frameSampleNum != b.frameSampleNum ? a.frameSampleNum > b.frameSampleNum : a.sampleNum > b.sampleNum;
+    });
+
+    uint32_t callSiteNum = std::min((uint32_t)callSites.size(), REPORT_CALL_SITE_NUM);
+    fprintf(file, "\nTop %u of %u sampled call sites (estimated as samples x %u):\n", callSiteNum, (uint32_t)callSites.size(), sampleInterval);
+
+    for (uint32_t i = 0; i < callSiteNum; i++) {
+        const CallSite& callSite = callSites[i];
+        fprintf(file, "  #%u %s: ~%llu allocations (~%.1f Kb), ~%llu in frames, ~%llu live\n", i, GetAllocationTagName(callSite.tag),
+            (unsigned long long)(callSite.sampleNum * sampleInterval), callSite.sampledSize * sampleInterval / 1024.0,
+            (unsigned long long)(callSite.frameSampleNum * sampleInterval), (unsigned long long)(callSite.liveSampleNum * sampleInterval));
+
+        PrintCallSite(file, callSite);
+    }
+
+    if (path) {
+        fclose(file);
+        printf("Allocation report written to '%s'\n", path);
+    }
+
+    return true;
+}
+
 void CreateDebugAllocator(nri::AllocationCallbacks& allocationCallbacks) {
+    DebugAllocator* debugAllocator = new DebugAllocator();
+    debugAllocator->id = ++g_AllocatorId;
+
     allocationCallbacks = {};
-    allocationCallbacks.userArg = new DebugAllocator();
+    allocationCallbacks.userArg = debugAllocator;
     allocationCallbacks.Allocate = DebugAlignedMalloc;
     allocationCallbacks.Reallocate = DebugAlignedRealloc;
     allocationCallbacks.Free = DebugAlignedFree;
@@ -0,0 +1,111 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+static const char* g_StageNames[] = {
+    "frame",
+    "prepare",
+    "ui",
+    "render",
+    "streamerCopy",
+};
+
+static_assert(helper::GetCountOf(g_StageNames) == (size_t)utils::FrameStage::MAX_NUM, "Unexpected number of stage names");
+
+// Nearest rank
+static double GetPercentile(const std::vector<double>& sorted, double percentile) {
+    size_t rank = (size_t)ceil(percentile * 0.01 * sorted.size());
+    rank = std::clamp(rank, (size_t)1, sorted.size());
+
+    return sorted[rank - 1];
+}
+
+void utils::FrameBenchmark::Begin(uint32_t frameNum) {
+    m_Frames.clear();
+    m_Frames.reserve(std::min(frameNum, 1u << 20)); // "frameNum" is "unlimited" by default
+    m_IsRecording = true;
+}
+
+utils::FrameStageStats utils::FrameBenchmark::GetStats(FrameStage stage, uint32_t warmupFrameNum) const {
+    FrameStageStats stats = {};
+    if (m_Frames.size() <= warmupFrameNum)
+        return stats;
+
+    std::vector<double> sorted;
+    sorted.reserve(m_Frames.size() - warmupFrameNum);
+    for (size_t i = warmupFrameNum; i < m_Frames.size(); i++)
+        sorted.push_back(m_Frames[i][(size_t)stage]);
+
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (double ms : sorted)
+        sum += ms;
+
+    stats.p50 = GetPercentile(sorted, 50.0);
+    stats.p95 = GetPercentile(sorted, 95.0);
+    stats.p99 = GetPercentile(sorted, 99.0);
+    stats.mean = sum / sorted.size();
+    stats.min = sorted.front();
+    stats.max = sorted.back();
+
+    return stats;
+}
+
+void utils::FrameBenchmark::Print(uint32_t warmupFrameNum) const {
+    printf("Benchmark (%u frames, %u warm-up):\n", GetFrameNum(), std::min(warmupFrameNum, GetFrameNum()));
+    printf("  %-14s %9s %9s %9s %9s %9s\n", "Stage, ms", "p50", "p95", "p99", "mean", "max");
+
+    for (size_t i = 0; i < (size_t)FrameStage::MAX_NUM; i++) {
+        FrameStageStats stats = GetStats((FrameStage)i, warmupFrameNum);
+        printf("  %-14s %9.3f %9.3f %9.3f %9.3f %9.3f\n", g_StageNames[i], stats.p50, stats.p95, stats.p99, stats.mean, stats.max);
+    }
+}
+
+bool utils::FrameBenchmark::WriteJson(const char* path, const FrameBenchmarkDesc& desc) const {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("ERROR: can't write benchmark results to '%s'\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"name\": \"%s\",\n", desc.name);
+    fprintf(file, "  \"api\": \"%s\",\n", desc.graphicsAPI);
+    fprintf(file, "  \"headless\": %s,\n", desc.isHeadless ? "true" : "false");
+    fprintf(file, "  \"width\": %u,\n", desc.width);
+    fprintf(file, "  \"height\": %u,\n", desc.height);
+    fprintf(file, "  \"timeStep\": %.6f,\n", BENCHMARK_TIME_STEP);
+    fprintf(file, "  \"frameNum\": %u,\n", GetFrameNum());
+    fprintf(file, "  \"warmupFrameNum\": %u,\n", desc.warmupFrameNum);
+
+    // Statistics, ms
+    fprintf(file, "  \"stats\": {\n");
+    for (size_t i = 0; i < (size_t)FrameStage::MAX_NUM; i++) {
+        FrameStageStats stats = GetStats((FrameStage)i, desc.warmupFrameNum);
+        fprintf(file, "    \"%s\": { \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"mean\": %.4f, \"min\": %.4f, \"max\": %.4f }%s\n",
+            g_StageNames[i], stats.p50, stats.p95, stats.p99, stats.mean, stats.min, stats.max, i + 1 < (size_t)FrameStage::MAX_NUM ? "," : "");
+    }
+    fprintf(file, "  },\n");
+
+    // Per-frame timings (including warm-up), ms
+    fprintf(file, "  \"frames\": {\n");
+    for (size_t i = 0; i < (size_t)FrameStage::MAX_NUM; i++) {
+        fprintf(file, "    \"%s\": [", g_StageNames[i]);
+        for (size_t j = 0; j < m_Frames.size(); j++)
+            fprintf(file, "%s%.4f", j ? ", " : "", m_Frames[j][i]);
+        fprintf(file, "]%s\n", i + 1 < (size_t)FrameStage::MAX_NUM ? "," : "");
+    }
+    fprintf(file, "  }\n");
+    fprintf(file, "}\n");
+
+    bool result = ferror(file) == 0;
+    fclose(file);
+
+    if (result)
+        printf("Benchmark results written to '%s'\n", path);
+
+    return result;
+}
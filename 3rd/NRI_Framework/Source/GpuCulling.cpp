@@ -0,0 +1,192 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <math.h>
+
+#ifdef _MSC_VER
+#    include <intrin.h>
+#endif
+
+// Keep in sync with "instanceGenBuffer.cs.hlsl" and "depthPyramid.cs.hlsl", the operation order matters
+
+static inline uint32_t CountBits(uint32_t x) {
+#ifdef _MSC_VER
+    return __popcnt(x);
+#else
+    return __builtin_popcount(x);
+#endif
+}
+
+static bool IsInsideFrustum(const utils::GpuCullingConstants& constants, const float center[3], float radius) {
+    bool isInside = true;
+    for (uint32_t i = 0; i < 6; i++) {
+        const float* plane = constants.planes[i];
+        float d = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+        isInside = isInside && d >= -radius;
+    }
+
+    return isInside;
+}
+
+static bool IsOccluded(const utils::GpuCullingConstants& constants, const utils::HiZPyramid& hiZ, const float center[3], float radius) {
+    const float* m = &constants.prevClipFromWorld[0].x; // column-major
+
+    float uvMin[2] = {1.0f, 1.0f};
+    float uvMax[2] = {0.0f, 0.0f};
+    float zMin = 1.0f;
+    for (uint32_t i = 0; i < 8; i++) {
+        float corner[3] = {
+            center[0] + ((i & 1) ? radius : -radius),
+            center[1] + ((i & 2) ? radius : -radius),
+            center[2] + ((i & 4) ? radius : -radius),
+        };
+
+        float clip[4];
+        for (uint32_t j = 0; j < 4; j++)
+            clip[j] = m[j] * corner[0] + m[4 + j] * corner[1] + m[8 + j] * corner[2] + m[12 + j];
+
+        if (clip[2] < 0.0f) // crosses the near plane
+            return false;
+
+        float ndc[3] = {clip[0] / clip[3], clip[1] / clip[3], clip[2] / clip[3]};
+        float uv[2] = {ndc[0] * 0.5f + 0.5f, ndc[1] * -0.5f + 0.5f};
+        for (uint32_t j = 0; j < 2; j++) {
+            uvMin[j] = std::min(uvMin[j], uv[j]);
+            uvMax[j] = std::max(uvMax[j], uv[j]);
+        }
+        zMin = std::min(zMin, ndc[2]);
+    }
+
+    uint32_t texelMin[2];
+    uint32_t texelMax[2];
+    for (uint32_t j = 0; j < 2; j++) {
+        texelMin[j] = std::min((uint32_t)(std::clamp(uvMin[j], 0.0f, 1.0f) * constants.hiZScale[j]), constants.hiZSize[j] - 1);
+        texelMax[j] = std::min((uint32_t)(std::clamp(uvMax[j], 0.0f, 1.0f) * constants.hiZScale[j]), constants.hiZSize[j] - 1);
+    }
+
+    // The finest mip where the footprint fits into 2x2 texels
+    uint32_t mip = 0;
+    while (mip + 1 < constants.hiZMipNum && ((texelMax[0] >> mip) - (texelMin[0] >> mip) > 1 || (texelMax[1] >> mip) - (texelMin[1] >> mip) > 1))
+        mip++;
+
+    uint32_t mipWidth = std::max(constants.hiZSize[0] >> mip, 1u);
+    uint32_t mipHeight = std::max(constants.hiZSize[1] >> mip, 1u);
+    uint32_t x0 = std::min(texelMin[0] >> mip, mipWidth - 1);
+    uint32_t y0 = std::min(texelMin[1] >> mip, mipHeight - 1);
+    uint32_t x1 = std::min(texelMax[0] >> mip, mipWidth - 1);
+    uint32_t y1 = std::min(texelMax[1] >> mip, mipHeight - 1);
+
+    const float* texels = hiZ.mips[mip].data();
+    float depth = std::max(std::max(texels[y0 * mipWidth + x0], texels[y0 * mipWidth + x1]), std::max(texels[y1 * mipWidth + x0], texels[y1 * mipWidth + x1]));
+
+    return zMin > depth;
+}
+
+// Squared distances avoid "sqrt", which is not exact on the GPU
+static uint32_t SelectLod(const utils::GpuCullingConstants& constants, uint32_t lodNum, const float center[3]) {
+    float d[3] = {center[0] - constants.cameraPosition[0], center[1] - constants.cameraPosition[1], center[2] - constants.cameraPosition[2]};
+    float distanceSq = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+
+    uint32_t lod = 0;
+    for (uint32_t i = 1; i < lodNum; i++) {
+        if (distanceSq >= constants.lodDistancesSq[i])
+            lod = i;
+    }
+
+    return lod;
+}
+
+uint32_t utils::GetHiZMipNum(uint32_t depthWidth, uint32_t depthHeight) {
+    uint32_t size = std::max(std::max(depthWidth >> 1, depthHeight >> 1), 1u);
+
+    uint32_t mipNum = 1;
+    while (size >>= 1)
+        mipNum++;
+
+    return mipNum;
+}
+
+void utils::BuildHiZPyramid(const float* depth, uint32_t depthWidth, uint32_t depthHeight, HiZPyramid& pyramid) {
+    uint32_t mipNum = GetHiZMipNum(depthWidth, depthHeight);
+    pyramid.mips.resize(mipNum);
+    pyramid.widths.resize(mipNum);
+    pyramid.heights.resize(mipNum);
+
+    const float* src = depth;
+    uint32_t srcWidth = depthWidth;
+    uint32_t srcHeight = depthHeight;
+    for (uint32_t mip = 0; mip < mipNum; mip++) {
+        uint32_t dstWidth = std::max(srcWidth >> 1, 1u);
+        uint32_t dstHeight = std::max(srcHeight >> 1, 1u);
+
+        std::vector<float>& dst = pyramid.mips[mip];
+        dst.resize(dstWidth * dstHeight);
+        pyramid.widths[mip] = dstWidth;
+        pyramid.heights[mip] = dstHeight;
+
+        for (uint32_t y = 0; y < dstHeight; y++) {
+            for (uint32_t x = 0; x < dstWidth; x++) {
+                // Odd dimensions: the last texel also covers the remaining row / column
+                uint32_t endX = x == dstWidth - 1 ? srcWidth - 1 : x * 2 + 1;
+                uint32_t endY = y == dstHeight - 1 ? srcHeight - 1 : y * 2 + 1;
+
+                float value = 0.0f;
+                for (uint32_t i = y * 2; i <= endY; i++) {
+                    for (uint32_t j = x * 2; j <= endX; j++)
+                        value = std::max(value, src[i * srcWidth + j]);
+                }
+
+                dst[y * dstWidth + x] = value;
+            }
+        }
+
+        src = dst.data();
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+}
+
+void utils::CullInstancesReference(const GpuCullingConstants& constants, const InstanceTransform* transforms, const HiZPyramid* hiZ, uint32_t* visibleInstances,
+    uint32_t* indirectArgs) {
+    uint32_t lodNum = std::min(std::max(constants.lodNum, 1u), GPU_CULLING_LOD_MAX_NUM);
+    uint32_t groupNum = (constants.instanceNum + GPU_CULLING_GROUP_SIZE - 1) / GPU_CULLING_GROUP_SIZE;
+    for (uint32_t group = 0; group < groupNum; group++) {
+        uint32_t visibleMask[GPU_CULLING_LOD_MAX_NUM][2] = {};
+        for (uint32_t groupIndex = 0; groupIndex < GPU_CULLING_GROUP_SIZE; groupIndex++) {
+            uint32_t idx = group * GPU_CULLING_GROUP_SIZE + groupIndex;
+            if (idx >= constants.instanceNum)
+                break;
+
+            const InstanceTransform& transform = transforms[idx];
+            float position[3] = {transform.rows[0][3], transform.rows[1][3], transform.rows[2][3]};
+
+            bool isVisible = true;
+            if (constants.flags & GPU_CULLING_FRUSTUM)
+                isVisible = IsInsideFrustum(constants, position, constants.meshRadius);
+            if (isVisible && (constants.flags & GPU_CULLING_OCCLUSION) && hiZ)
+                isVisible = !IsOccluded(constants, *hiZ, position, constants.meshRadius);
+
+            if (isVisible) {
+                uint32_t lod = SelectLod(constants, lodNum, position);
+                visibleMask[lod][groupIndex >> 5] |= 1u << (groupIndex & 31);
+            }
+        }
+
+        for (uint32_t lod = 0; lod < lodNum; lod++) {
+            uint32_t* lodArgs = indirectArgs + lod * GPU_CULLING_ARGS_NUM;
+            uint32_t* lodVisibleInstances = visibleInstances + lod * constants.instanceNum;
+
+            uint32_t visibleNum = CountBits(visibleMask[lod][0]) + CountBits(visibleMask[lod][1]);
+            uint32_t visibleOffset = lodArgs[1];
+            if (visibleNum) {
+                lodArgs[1] += visibleNum;
+                lodArgs[5] |= 1;
+            }
+
+            for (uint32_t groupIndex = 0; groupIndex < GPU_CULLING_GROUP_SIZE; groupIndex++) {
+                if (visibleMask[lod][groupIndex >> 5] & (1u << (groupIndex & 31)))
+                    lodVisibleInstances[visibleOffset++] = group * GPU_CULLING_GROUP_SIZE + groupIndex;
+            }
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+
+constexpr uint32_t QUERY_NUM = utils::GPU_PROFILER_RANGE_MAX_NUM * 2;
+constexpr uint64_t SLOT_SIZE = QUERY_NUM * sizeof(uint64_t);
+
+bool utils::GpuProfiler::Initialize(const nri::CoreInterface& NRI, const nri::HelperInterface& helperInterface, nri::Device& device, uint32_t frameInFlightNum, const char* laneName) {
+    m_LaneName = laneName;
+    m_TimestampFrequencyHz = (double)NRI.GetDeviceDesc(device).timestampFrequencyHz;
+
+    m_Frames.resize(frameInFlightNum);
+    for (Frame& frame : m_Frames) {
+        nri::QueryPoolDesc queryPoolDesc = {};
+        queryPoolDesc.queryType = nri::QueryType::TIMESTAMP;
+        queryPoolDesc.capacity = QUERY_NUM;
+
+        if (NRI.CreateQueryPool(device, queryPoolDesc, frame.queryPool) != nri::Result::SUCCESS)
+            return false;
+
+        frame.ranges.reserve(GPU_PROFILER_RANGE_MAX_NUM);
+    }
+
+    // Readback, a slot per frame in flight
+    nri::BufferDesc bufferDesc = {};
+    bufferDesc.size = SLOT_SIZE * frameInFlightNum;
+
+    if (NRI.CreateBuffer(device, bufferDesc, m_ReadbackBuffer) != nri::Result::SUCCESS)
+        return false;
+
+    nri::ResourceGroupDesc resourceGroupDesc = {};
+    resourceGroupDesc.memoryLocation = nri::MemoryLocation::HOST_READBACK;
+    resourceGroupDesc.bufferNum = 1;
+    resourceGroupDesc.buffers = &m_ReadbackBuffer;
+
+    return helperInterface.AllocateAndBindMemory(device, resourceGroupDesc, &m_ReadbackMemory) == nri::Result::SUCCESS;
+}
+
+void utils::GpuProfiler::Destroy(const nri::CoreInterface& NRI) {
+    for (Frame& frame : m_Frames) {
+        if (frame.queryPool)
+            NRI.DestroyQueryPool(*frame.queryPool);
+    }
+
+    if (m_ReadbackBuffer)
+        NRI.DestroyBuffer(*m_ReadbackBuffer);
+
+    if (m_ReadbackMemory)
+        NRI.FreeMemory(*m_ReadbackMemory);
+
+    m_Frames.clear();
+    m_ReadbackBuffer = nullptr;
+    m_ReadbackMemory = nullptr;
+}
+
+void utils::GpuProfiler::BeginFrame(const nri::CoreInterface& NRI, nri::CommandBuffer& commandBuffer, uint32_t frameIndex) {
+    m_CurrentFrame = frameIndex % (uint32_t)m_Frames.size();
+    m_Depth = 0;
+
+    // The previous user of the slot is complete
+    Frame& frame = m_Frames[m_CurrentFrame];
+    if (frame.isPending) {
+        const uint64_t* timestamps = (uint64_t*)NRI.MapBuffer(*m_ReadbackBuffer, m_CurrentFrame * SLOT_SIZE, frame.ranges.size() * 2 * sizeof(uint64_t));
+        if (timestamps) {
+            ResolveFrame(frame.frameIndex, timestamps, m_TimestampFrequencyHz);
+            NRI.UnmapBuffer(*m_ReadbackBuffer);
+        }
+    }
+
+    frame.ranges.clear();
+    frame.frameIndex = frameIndex;
+    frame.isPending = false;
+
+    NRI.CmdResetQueries(commandBuffer, *frame.queryPool, 0, QUERY_NUM);
+}
+
+void utils::GpuProfiler::EndFrame(const nri::CoreInterface& NRI, nri::CommandBuffer& commandBuffer) {
+    Frame& frame = m_Frames[m_CurrentFrame];
+    if (!frame.ranges.empty())
+        NRI.CmdCopyQueries(commandBuffer, *frame.queryPool, 0, (uint32_t)frame.ranges.size() * 2, *m_ReadbackBuffer, m_CurrentFrame * SLOT_SIZE);
+
+    // Submission follows, the GPU can't start earlier
+    frame.submitTicks = GetCpuProfilerTicks();
+    frame.isPending = !frame.ranges.empty();
+}
+
+uint32_t utils::GpuProfiler::BeginRange(const nri::CoreInterface& NRI, nri::CommandBuffer& commandBuffer, const char* name) {
+    Frame& frame = m_Frames[m_CurrentFrame];
+    uint32_t range = (uint32_t)frame.ranges.size();
+    uint32_t depth = m_Depth++;
+
+    if (range >= GPU_PROFILER_RANGE_MAX_NUM)
+        return uint32_t(-1);
+
+    frame.ranges.push_back({name, depth});
+    NRI.CmdEndQuery(commandBuffer, *frame.queryPool, range * 2);
+
+    return range;
+}
+
+void utils::GpuProfiler::EndRange(const nri::CoreInterface& NRI, nri::CommandBuffer& commandBuffer, uint32_t range) {
+    m_Depth--;
+
+    if (range != uint32_t(-1))
+        NRI.CmdEndQuery(commandBuffer, *m_Frames[m_CurrentFrame].queryPool, range * 2 + 1);
+}
+
+void utils::GpuProfiler::ResolveFrame(uint32_t frameIndex, const uint64_t* timestamps, double timestampFrequencyHz) {
+    Frame& frame = m_Frames[frameIndex % (uint32_t)m_Frames.size()];
+    if (!frame.isPending || frame.frameIndex != frameIndex || timestampFrequencyHz <= 0.0)
+        return;
+
+    frame.isPending = false;
+    m_ResolvedFrameNum++;
+
+    // Statistics
+    double msPerTick = 1000.0 / timestampFrequencyHz;
+    uint64_t firstTimestamp = uint64_t(-1);
+
+    for (size_t i = 0; i < frame.ranges.size(); i++) {
+        const Range& range = frame.ranges[i];
+        uint64_t begin = timestamps[i * 2];
+        uint64_t end = timestamps[i * 2 + 1];
+
+        // Not written (e.g. a skipped command buffer) or reordered
+        double time = 0.0;
+        if (begin && end > begin) {
+            time = double(end - begin) * msPerTick;
+            firstTimestamp = std::min(firstTimestamp, begin);
+        }
+
+        auto it = std::find_if(m_Stats.begin(), m_Stats.end(), [&range](const GpuRangeStats& stats) {
+            return stats.name == range.name && stats.depth == range.depth;
+        });
+
+        if (it == m_Stats.end()) {
+            m_Stats.push_back({});
+            it = m_Stats.end() - 1;
+            it->name = range.name;
+            it->depth = range.depth;
+        }
+
+        GpuRangeStats& stats = *it;
+        stats.time = time;
+        stats.history[stats.historyNum++ % GPU_PROFILER_HISTORY_NUM] = time;
+
+        uint32_t historyNum = std::min(stats.historyNum, GPU_PROFILER_HISTORY_NUM);
+        double sum = 0.0;
+        stats.max = 0.0;
+        for (uint32_t j = 0; j < historyNum; j++) {
+            sum += stats.history[j];
+            stats.max = std::max(stats.max, stats.history[j]);
+        }
+        stats.average = sum / historyNum;
+    }
+
+    // CPU profiler timeline
+    double ticksPerSecond = IsCpuProfilerEnabled() ? GetCpuProfilerTicksPerSecond() : 0.0;
+    if (ticksPerSecond <= 0.0 || firstTimestamp == uint64_t(-1))
+        return;
+
+    double ratio = ticksPerSecond / timestampFrequencyHz;
+    double offset = double(frame.submitTicks) - double(firstTimestamp) * ratio;
+    if (!m_HasOffset || offset > m_Offset) {
+        m_Offset = offset;
+        m_HasOffset = true;
+    }
+
+    if (!m_Lane)
+        m_Lane = RegisterCpuProfilerLane(m_LaneName);
+
+    // Ranges are in recording order, depths restore the begin / end sequence
+    uint64_t stack[CPU_PROFILER_DEPTH_MAX];
+    uint32_t stackSize = 0;
+
+    for (size_t i = 0; i <= frame.ranges.size(); i++) {
+        uint32_t depth = i < frame.ranges.size() ? std::min(frame.ranges[i].depth, CPU_PROFILER_DEPTH_MAX - 1) : 0;
+        while (stackSize > depth)
+            m_Lane->Push(nullptr, stack[--stackSize]);
+
+        if (i == frame.ranges.size())
+            break;
+
+        uint64_t begin = timestamps[i * 2] ? timestamps[i * 2] : firstTimestamp;
+        uint64_t end = std::max(timestamps[i * 2 + 1], begin);
+        uint64_t beginTicks = (uint64_t)std::max(double(begin) * ratio + m_Offset, 0.0);
+        uint64_t endTicks = (uint64_t)std::max(double(end) * ratio + m_Offset, 0.0);
+
+        m_Lane->Push(frame.ranges[i].name, beginTicks);
+        stack[stackSize++] = endTicks;
+    }
+}
@@ -0,0 +1,254 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    define INSTANCE_CULLING_X86
+#endif
+
+#ifdef INSTANCE_CULLING_X86
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#        define INSTANCE_CULLING_TARGET_AVX2
+#    else
+#        include <cpuid.h>
+#        define INSTANCE_CULLING_TARGET_AVX2 __attribute__((target("avx2")))
+#    endif
+#    include <immintrin.h>
+#endif
+
+struct CullingPlanes {
+    float planes[6][4];
+    float absNormals[6][3]; // for boxes
+};
+
+// Bit exact with the AVX2 version (same operation order, no FMA)
+static uint32_t CullRangeScalar(const utils::InstanceBounds& bounds, const CullingPlanes& cullingPlanes, bool useBoxes, uint32_t begin, uint32_t end, uint32_t* dst) {
+    uint32_t visibleNum = 0;
+
+    for (uint32_t i = begin; i < end; i++) {
+        bool isVisible = true;
+        for (uint32_t j = 0; j < 6; j++) {
+            const float* plane = cullingPlanes.planes[j];
+            float d = plane[0] * bounds.centerX[i] + plane[1] * bounds.centerY[i] + plane[2] * bounds.centerZ[i] + plane[3];
+
+            float r = bounds.radius[i];
+            if (useBoxes) {
+                const float* absNormal = cullingPlanes.absNormals[j];
+                r = absNormal[0] * bounds.extentX[i] + absNormal[1] * bounds.extentY[i] + absNormal[2] * bounds.extentZ[i];
+            }
+
+            isVisible &= d >= -r;
+        }
+
+        dst[visibleNum] = i;
+        visibleNum += isVisible ? 1 : 0;
+    }
+
+    return visibleNum;
+}
+
+#ifdef INSTANCE_CULLING_X86
+
+static void CPUID(int leaf, int subleaf, uint32_t* regs) {
+#    ifdef _MSC_VER
+    __cpuidex((int*)regs, leaf, subleaf);
+#    else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#    endif
+}
+
+static uint64_t XGETBV() {
+#    ifdef _MSC_VER
+    return _xgetbv(0);
+#    else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#    endif
+}
+
+static bool IsAvx2Supported() {
+    uint32_t regs[4];
+    CPUID(0, 0, regs);
+    uint32_t maxLeaf = regs[0];
+    if (maxLeaf < 7)
+        return false;
+
+    // AVX state must be enabled by the OS
+    CPUID(1, 0, regs);
+    bool osxsave = (regs[2] & (1u << 27)) != 0;
+    bool avx = (regs[2] & (1u << 28)) != 0;
+    if (!osxsave || !avx || (XGETBV() & 0x6) != 0x6)
+        return false;
+
+    CPUID(7, 0, regs);
+    return (regs[1] & (1u << 5)) != 0;
+}
+
+// Lane permutations moving set mask bits to the front
+struct CompactionTable {
+    alignas(32) uint32_t permutations[256][8];
+
+    CompactionTable() {
+        for (uint32_t mask = 0; mask < 256; mask++) {
+            uint32_t n = 0;
+            for (uint32_t lane = 0; lane < 8; lane++) {
+                if (mask & (1 << lane))
+                    permutations[mask][n++] = lane;
+            }
+
+            for (; n < 8; n++)
+                permutations[mask][n] = 0;
+        }
+    }
+};
+
+static const CompactionTable g_CompactionTable;
+
+// Stores are 8 wide, but never go beyond the current group: "visibleNum <= i - begin"
+INSTANCE_CULLING_TARGET_AVX2 static uint32_t CullRangeAvx2(const utils::InstanceBounds& bounds, const CullingPlanes& cullingPlanes, bool useBoxes, uint32_t begin,
+    uint32_t end, uint32_t* dst) {
+    __m256 nx[6], ny[6], nz[6], w[6], ax[6], ay[6], az[6];
+    for (uint32_t j = 0; j < 6; j++) {
+        nx[j] = _mm256_set1_ps(cullingPlanes.planes[j][0]);
+        ny[j] = _mm256_set1_ps(cullingPlanes.planes[j][1]);
+        nz[j] = _mm256_set1_ps(cullingPlanes.planes[j][2]);
+        w[j] = _mm256_set1_ps(cullingPlanes.planes[j][3]);
+        ax[j] = _mm256_set1_ps(cullingPlanes.absNormals[j][0]);
+        ay[j] = _mm256_set1_ps(cullingPlanes.absNormals[j][1]);
+        az[j] = _mm256_set1_ps(cullingPlanes.absNormals[j][2]);
+    }
+
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    uint32_t visibleNum = 0;
+    uint32_t i = begin;
+
+    for (; i + 8 <= end; i += 8) {
+        __m256 cx = _mm256_loadu_ps(&bounds.centerX[i]);
+        __m256 cy = _mm256_loadu_ps(&bounds.centerY[i]);
+        __m256 cz = _mm256_loadu_ps(&bounds.centerZ[i]);
+
+        __m256 negR[6];
+        if (useBoxes) {
+            __m256 ex = _mm256_loadu_ps(&bounds.extentX[i]);
+            __m256 ey = _mm256_loadu_ps(&bounds.extentY[i]);
+            __m256 ez = _mm256_loadu_ps(&bounds.extentZ[i]);
+            for (uint32_t j = 0; j < 6; j++) {
+                __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax[j], ex), _mm256_mul_ps(ay[j], ey)), _mm256_mul_ps(az[j], ez));
+                negR[j] = _mm256_xor_ps(r, signMask);
+            }
+        } else {
+            __m256 r = _mm256_xor_ps(_mm256_loadu_ps(&bounds.radius[i]), signMask);
+            for (uint32_t j = 0; j < 6; j++)
+                negR[j] = r;
+        }
+
+        __m256 isVisible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (uint32_t j = 0; j < 6; j++) {
+            __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx[j], cx), _mm256_mul_ps(ny[j], cy)), _mm256_mul_ps(nz[j], cz)), w[j]);
+            isVisible = _mm256_and_ps(isVisible, _mm256_cmp_ps(d, negR[j], _CMP_GE_OQ));
+        }
+
+        uint32_t mask = (uint32_t)_mm256_movemask_ps(isVisible);
+        __m256i permutation = _mm256_load_si256((const __m256i*)g_CompactionTable.permutations[mask]);
+        __m256i indices = _mm256_add_epi32(_mm256_set1_epi32((int32_t)i), laneOffsets);
+        _mm256_storeu_si256((__m256i*)(dst + visibleNum), _mm256_permutevar8x32_epi32(indices, permutation));
+
+#    ifdef _MSC_VER
+        visibleNum += __popcnt(mask);
+#    else
+        visibleNum += __builtin_popcount(mask);
+#    endif
+    }
+
+    return visibleNum + CullRangeScalar(bounds, cullingPlanes, useBoxes, i, end, dst + visibleNum);
+}
+
+#else
+
+static bool IsAvx2Supported() {
+    return false;
+}
+
+#endif
+
+static const bool g_IsAvx2Supported = IsAvx2Supported();
+
+bool utils::IsInstanceCullingSimd() {
+    return g_IsAvx2Supported;
+}
+
+void utils::InstanceBounds::Resize(uint32_t num, bool hasBoxes) {
+    size_t paddedNum = (num + 7) & ~7;
+    instanceNum = num;
+
+    centerX.resize(paddedNum, 0.0f);
+    centerY.resize(paddedNum, 0.0f);
+    centerZ.resize(paddedNum, 0.0f);
+    radius.resize(paddedNum, 0.0f);
+    extentX.resize(hasBoxes ? paddedNum : 0, 0.0f);
+    extentY.resize(hasBoxes ? paddedNum : 0, 0.0f);
+    extentZ.resize(hasBoxes ? paddedNum : 0, 0.0f);
+}
+
+uint32_t utils::CullInstances(const InstanceCullingDesc& desc, InstanceCullingStats& stats) {
+    Timer timer;
+    double begin = timer.GetTimeStamp();
+
+    const InstanceBounds& bounds = *desc.bounds;
+    const bool useBoxes = desc.useBoxes && !bounds.extentX.empty();
+
+    CullingPlanes cullingPlanes;
+    ExtractFrustumPlanes(desc.clipFromWorld, cullingPlanes.planes);
+    for (uint32_t j = 0; j < 6; j++) {
+        for (uint32_t k = 0; k < 3; k++)
+            cullingPlanes.absNormals[j][k] = fabsf(cullingPlanes.planes[j][k]);
+    }
+
+    auto CullRange = CullRangeScalar;
+#ifdef INSTANCE_CULLING_X86
+    if (g_IsAvx2Supported && !desc.disableSimd)
+        CullRange = CullRangeAvx2;
+#endif
+
+    // Small arrays are culled faster than workers wake up
+    uint32_t blockNum = (bounds.instanceNum + INSTANCE_CULLING_BLOCK_SIZE - 1) / INSTANCE_CULLING_BLOCK_SIZE;
+    uint32_t threadNum = desc.threadNum;
+    if (bounds.instanceNum < INSTANCE_CULLING_PARALLEL_MIN_NUM)
+        threadNum = 1;
+
+    uint32_t visibleNum = 0;
+    if (threadNum == 1 || blockNum == 1)
+        visibleNum = CullRange(bounds, cullingPlanes, useBoxes, 0, bounds.instanceNum, desc.visibleInstances);
+    else {
+        // Each block is compacted in place, then blocks are moved together
+        std::vector<uint32_t> blockVisibleNum(blockNum);
+        JobSystem::GetShared().ParallelFor(blockNum, threadNum, [&](uint32_t i) {
+            uint32_t blockBegin = i * INSTANCE_CULLING_BLOCK_SIZE;
+            uint32_t blockEnd = std::min(blockBegin + INSTANCE_CULLING_BLOCK_SIZE, bounds.instanceNum);
+            blockVisibleNum[i] = CullRange(bounds, cullingPlanes, useBoxes, blockBegin, blockEnd, desc.visibleInstances + blockBegin);
+        });
+
+        for (uint32_t i = 0; i < blockNum; i++) {
+            uint32_t* blockVisibleInstances = desc.visibleInstances + i * INSTANCE_CULLING_BLOCK_SIZE;
+            if (blockVisibleInstances != desc.visibleInstances + visibleNum)
+                memmove(desc.visibleInstances + visibleNum, blockVisibleInstances, blockVisibleNum[i] * sizeof(uint32_t));
+
+            visibleNum += blockVisibleNum[i];
+        }
+    }
+
+    if (desc.drawArgs)
+        desc.drawArgs->instanceNum = visibleNum;
+
+    stats.testedNum += bounds.instanceNum;
+    stats.visibleNum += visibleNum;
+    stats.time += timer.GetTimeStamp() - begin;
+
+    return visibleNum;
+}
@@ -0,0 +1,110 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#    include <intrin.h>
+#endif
+
+static inline uint32_t CountBits(uint64_t x) {
+#ifdef _MSC_VER
+    return (uint32_t)__popcnt64(x);
+#else
+    return (uint32_t)__builtin_popcountll(x);
+#endif
+}
+
+static inline uint32_t FindLowestBit(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctzll(x);
+#endif
+}
+
+void utils::DirtyInstanceTracker::Initialize(uint32_t instanceNum) {
+    const InstanceTransform identity = {{
+        {1.0f, 0.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f, 0.0f},
+    }};
+
+    m_Transforms.assign(instanceNum, identity);
+    m_DirtyBits.assign((instanceNum + 63) / 64, 0);
+    m_DirtyWords.clear();
+    m_DirtyNum = 0;
+}
+
+void utils::DirtyInstanceTracker::SetTransform(uint32_t index, const InstanceTransform& transform) {
+    m_Transforms[index] = transform;
+    MarkDirty(index);
+}
+
+void utils::DirtyInstanceTracker::SetTranslation(uint32_t index, float x, float y, float z) {
+    InstanceTransform& transform = m_Transforms[index];
+    transform.rows[0][3] = x;
+    transform.rows[1][3] = y;
+    transform.rows[2][3] = z;
+    MarkDirty(index);
+}
+
+void utils::DirtyInstanceTracker::MarkDirty(uint32_t first, uint32_t num) {
+    uint32_t end = std::min(first + num, GetInstanceNum());
+
+    while (first < end) {
+        uint32_t wordIndex = first / 64;
+        uint32_t bitBegin = first % 64;
+        uint32_t bitEnd = std::min(end - wordIndex * 64, 64u);
+
+        uint64_t mask = bitEnd - bitBegin == 64 ? ~0ull : ((1ull << (bitEnd - bitBegin)) - 1) << bitBegin;
+        uint64_t& word = m_DirtyBits[wordIndex];
+        if (!word)
+            m_DirtyWords.push_back(wordIndex);
+
+        m_DirtyNum += CountBits(mask & ~word);
+        word |= mask;
+
+        first = wordIndex * 64 + bitEnd;
+    }
+}
+
+uint32_t utils::DirtyInstanceTracker::GatherUpdates(InstanceUpdate* updates, uint32_t maxNum, InstanceUpdateStats& stats) {
+    Timer timer;
+    double begin = timer.GetTimeStamp();
+
+    // Ascending order keeps scattered writes as coherent as possible
+    std::sort(m_DirtyWords.begin(), m_DirtyWords.end());
+
+    uint32_t updateNum = 0;
+    size_t i = 0;
+    for (; i < m_DirtyWords.size() && updateNum < maxNum; i++) {
+        uint32_t wordIndex = m_DirtyWords[i];
+        uint64_t& word = m_DirtyBits[wordIndex];
+
+        while (word && updateNum < maxNum) {
+            uint32_t index = wordIndex * 64 + FindLowestBit(word);
+            word &= word - 1;
+
+            InstanceUpdate& update = updates[updateNum++];
+            update.transform = m_Transforms[index];
+            update.index = index;
+        }
+
+        // Partially gathered, stays in the list
+        if (word)
+            break;
+    }
+
+    m_DirtyWords.erase(m_DirtyWords.begin(), m_DirtyWords.begin() + i);
+    m_DirtyNum -= updateNum;
+
+    stats.updateNum += updateNum;
+    stats.uploadedBytes += updateNum * sizeof(InstanceUpdate);
+    stats.writtenBytes += updateNum * sizeof(InstanceTransform);
+    stats.time += timer.GetTimeStamp() - begin;
+    stats.gatherNum++;
+
+    return updateNum;
+}
@@ -0,0 +1,154 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <atomic>
+
+struct utils::JobSystem::Loop {
+    const ParallelForFunc* func = nullptr;
+    uint32_t taskNum = 0;
+    uint32_t helperNum = 0; // workers allowed to join
+    uint32_t joinedNum = 0; // under the mutex
+    uint32_t activeNum = 0; // under the mutex
+    std::atomic<uint32_t> nextTask = 0;
+};
+
+static thread_local bool t_IsWorker = false;
+
+utils::JobSystem::~JobSystem() {
+    Shutdown();
+}
+
+void utils::JobSystem::Initialize(const JobSystemDesc& desc) {
+    Shutdown();
+
+    uint32_t workerNum = desc.workerNum;
+    if (!workerNum)
+        workerNum = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+    for (uint32_t i = 0; i < workerNum; i++)
+        m_Workers.emplace_back(&JobSystem::WorkerThread, this);
+
+    m_IsInitialized = true;
+}
+
+void utils::JobSystem::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_IsStopping = true;
+    }
+
+    m_WorkerCondition.notify_all();
+
+    for (std::thread& worker : m_Workers)
+        worker.join();
+
+    m_Workers.clear();
+    m_IsStopping = false;
+    m_IsInitialized = false;
+}
+
+void utils::JobSystem::ParallelFor(uint32_t taskNum, uint32_t threadNum, const ParallelForFunc& func) {
+    if (!taskNum)
+        return;
+
+    if (!threadNum)
+        threadNum = GetThreadNum();
+
+    Loop loop;
+    loop.func = &func;
+    loop.taskNum = taskNum;
+    loop.helperNum = std::min({threadNum, taskNum, GetThreadNum()}) - 1;
+
+    // Nested or concurrent loops run serially, waiting for workers busy with another loop can deadlock
+    bool isIssued = false;
+    if (loop.helperNum && !t_IsWorker) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Loop) {
+            m_Loop = &loop;
+            isIssued = true;
+        }
+    }
+
+    if (isIssued)
+        m_WorkerCondition.notify_all();
+
+    Execute(loop);
+
+    // "loop" lives on this stack: no joins after this point, then wait for the joined workers
+    if (isIssued) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Loop = nullptr;
+        m_DoneCondition.wait(lock, [&loop]() { return loop.activeNum == 0; });
+    }
+}
+
+void utils::JobSystem::Submit(TaskFunc&& task) {
+    if (m_Workers.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Tasks.push_back(std::move(task));
+    }
+
+    m_WorkerCondition.notify_one();
+}
+
+bool utils::JobSystem::IsWorkerThread() {
+    return t_IsWorker;
+}
+
+utils::JobSystem& utils::JobSystem::GetShared() {
+    static JobSystem s_JobSystem;
+    static std::once_flag s_IsInitialized;
+
+    std::call_once(s_IsInitialized, []() {
+        if (!s_JobSystem.m_IsInitialized)
+            s_JobSystem.Initialize({});
+    });
+
+    return s_JobSystem;
+}
+
+void utils::JobSystem::WorkerThread() {
+    t_IsWorker = true;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true) {
+        auto IsLoopOpen = [this]() {
+            return m_Loop && m_Loop->joinedNum < m_Loop->helperNum && m_Loop->nextTask.load(std::memory_order_relaxed) < m_Loop->taskNum;
+        };
+
+        m_WorkerCondition.wait(lock, [this, &IsLoopOpen]() { return m_IsStopping || IsLoopOpen() || !m_Tasks.empty(); });
+
+        // Loops first: the issuing thread is waiting for them
+        if (IsLoopOpen()) {
+            Loop& loop = *m_Loop;
+            loop.joinedNum++;
+            loop.activeNum++;
+
+            lock.unlock();
+            Execute(loop);
+            lock.lock();
+
+            if (--loop.activeNum == 0)
+                m_DoneCondition.notify_one();
+        } else if (!m_Tasks.empty()) {
+            TaskFunc task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+
+            lock.unlock();
+            task();
+            task = nullptr; // captures are released outside of the lock too
+            lock.lock();
+        } else if (m_IsStopping)
+            return;
+    }
+}
+
+void utils::JobSystem::Execute(Loop& loop) {
+    for (uint32_t i = loop.nextTask++; i < loop.taskNum; i = loop.nextTask++)
+        (*loop.func)(i);
+}
@@ -0,0 +1,289 @@
+#include "NRIFramework.h"
+
+#include <string.h>
+
+#ifdef NRI_FRAMEWORK_ZSTD
+#    include <zstd.h>
+#endif
+
+constexpr uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr uint32_t KTX2_SUPERCOMPRESSION_NONE = 0;
+constexpr uint32_t KTX2_SUPERCOMPRESSION_ZSTD = 2;
+constexpr uint64_t KTX2_ARENA_ALIGNMENT = 16;
+constexpr uint32_t KTX2_LEVEL_MAX_NUM = 32; // 32-bit dimensions
+
+struct Ktx2Header {
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+static_assert(sizeof(Ktx2Header) == 80, "KTX2 header layout mismatch");
+
+struct Ktx2LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+static bool Seek(FILE* file, uint64_t offset) {
+#if defined(_WIN32)
+    return _fseeki64(file, (int64_t)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+static bool ReadAt(FILE* file, uint64_t offset, void* dst, uint64_t size) {
+    return Seek(file, offset) && fread(dst, 1, (size_t)size, file) == size;
+}
+
+static uint64_t GetFileSize(FILE* file) {
+#if defined(_WIN32)
+    bool isOk = _fseeki64(file, 0, SEEK_END) == 0;
+    int64_t size = _ftelli64(file);
+#else
+    bool isOk = fseeko(file, 0, SEEK_END) == 0;
+    int64_t size = (int64_t)ftello(file);
+#endif
+
+    return isOk && size > 0 && Seek(file, 0) ? (uint64_t)size : 0;
+}
+
+// "a *= b", returns "false" on overflow
+static bool Multiply(uint64_t& a, uint64_t b) {
+    if (b && a > UINT64_MAX / b)
+        return false;
+
+    a *= b;
+
+    return true;
+}
+
+utils::Ktx2Texture::~Ktx2Texture() {
+    Close();
+}
+
+bool utils::Ktx2Texture::Open(const std::string& path) {
+    Close();
+
+    m_File = fopen(path.c_str(), "rb");
+    if (!m_File) {
+        printf("ERROR: File '%s' is not found!\n", path.c_str());
+        return false;
+    }
+
+    m_Name = path;
+
+    const uint64_t fileSize = GetFileSize(m_File);
+
+    Ktx2Header header = {};
+    if (fread(&header, sizeof(header), 1, m_File) != 1 || memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER))) {
+        printf("ERROR: '%s' is not a KTX2 file!\n", GetFileName(path));
+        Close();
+        return false;
+    }
+
+    m_Format = nri::nriConvertVKFormatToNRI(header.vkFormat);
+    if (m_Format == nri::Format::UNKNOWN) {
+        printf("ERROR: '%s' has unsupported VkFormat %u (Basis payloads need transcoding)!\n", GetFileName(path), header.vkFormat);
+        Close();
+        return false;
+    }
+
+    m_Supercompression = header.supercompressionScheme;
+    bool isZstdSupported = false;
+#ifdef NRI_FRAMEWORK_ZSTD
+    isZstdSupported = true;
+#endif
+    if (m_Supercompression != KTX2_SUPERCOMPRESSION_NONE && !(m_Supercompression == KTX2_SUPERCOMPRESSION_ZSTD && isZstdSupported)) {
+        printf("ERROR: '%s' has unsupported supercompression scheme %u!\n", GetFileName(path), m_Supercompression);
+        Close();
+        return false;
+    }
+
+    // Sizes below come from the file: malformed ones must not lead to huge allocations or reads out of the file
+    if (!header.pixelWidth || header.levelCount > KTX2_LEVEL_MAX_NUM || (header.faceCount != 1 && header.faceCount != 6)) {
+        printf("ERROR: '%s' has invalid dimensions, level or face count!\n", GetFileName(path));
+        Close();
+        return false;
+    }
+
+    m_Width = header.pixelWidth;
+    m_Height = std::max(header.pixelHeight, 1u);
+    m_Depth = std::max(header.pixelDepth, 1u);
+    m_LayerNum = std::max(header.layerCount, 1u);
+    m_FaceNum = std::max(header.faceCount, 1u);
+    m_MipNum = std::max(header.levelCount, 1u); // 0 means "generate mips at runtime", only the base level is stored
+
+    Ktx2LevelIndex levelIndex[KTX2_LEVEL_MAX_NUM];
+    if (fread(levelIndex, sizeof(Ktx2LevelIndex), m_MipNum, m_File) != m_MipNum) {
+        printf("ERROR: '%s' has truncated level index!\n", GetFileName(path));
+        Close();
+        return false;
+    }
+
+    // Arena layout: mips are tightly packed (as in the file), each mip is aligned
+    const nri::FormatProps& formatProps = nri::nriGetFormatProps(m_Format);
+    m_Levels.resize(m_MipNum);
+    m_ArenaSize = 0;
+
+    for (uint32_t mip = 0; mip < m_MipNum; mip++) {
+        uint32_t w = std::max(m_Width >> mip, 1u);
+        uint32_t h = std::max(m_Height >> mip, 1u);
+        uint32_t d = std::max(m_Depth >> mip, 1u);
+
+        uint64_t rowBlocks = (uint64_t(w) + formatProps.blockWidth - 1) / formatProps.blockWidth;
+        uint64_t rows = (uint64_t(h) + formatProps.blockHeight - 1) / formatProps.blockHeight;
+
+        uint64_t rowPitch = rowBlocks;
+        uint64_t slicePitch = rows;
+        uint64_t size = d;
+        bool isValid = Multiply(rowPitch, formatProps.stride) && rowPitch <= UINT32_MAX;
+        isValid = isValid && Multiply(slicePitch, rowPitch) && slicePitch <= UINT32_MAX;
+        isValid = isValid && Multiply(size, slicePitch) && Multiply(size, m_LayerNum) && Multiply(size, m_FaceNum);
+
+        Level& level = m_Levels[mip];
+        level.rowPitch = (uint32_t)rowPitch;
+        level.slicePitch = (uint32_t)slicePitch;
+        level.size = size;
+        level.fileOffset = levelIndex[mip].byteOffset;
+        level.fileSize = levelIndex[mip].byteLength;
+        level.arenaOffset = m_ArenaSize;
+        level.isLoaded = false;
+
+        // The level must be within the file ("offset + length" can't overflow this way), the uncompressed size must
+        // match the mip size
+        isValid = isValid && level.fileOffset <= fileSize && level.fileSize <= fileSize - level.fileOffset;
+
+        uint64_t uncompressedSize = m_Supercompression == KTX2_SUPERCOMPRESSION_NONE ? level.fileSize : levelIndex[mip].uncompressedByteLength;
+        isValid = isValid && uncompressedSize == level.size && level.size <= UINT64_MAX - KTX2_ARENA_ALIGNMENT - m_ArenaSize;
+
+        if (!isValid) {
+            printf("ERROR: '%s' mip %u has invalid offset or size!\n", GetFileName(path), mip);
+            Close();
+            return false;
+        }
+
+        m_ArenaSize = helper::Align(m_ArenaSize + level.size, KTX2_ARENA_ALIGNMENT);
+    }
+
+    return true;
+}
+
+void utils::Ktx2Texture::Close() {
+    CloseFile();
+
+    m_Levels.clear();
+    m_Arena.reset();
+    m_ArenaSize = 0;
+}
+
+void utils::Ktx2Texture::CloseFile() {
+    if (m_File)
+        fclose(m_File);
+
+    m_File = nullptr;
+}
+
+bool utils::Ktx2Texture::ReadMips(uint32_t mipOffset, uint32_t mipNum, AssetLoader* assetLoader) {
+    if (!m_File || mipOffset + mipNum > m_MipNum)
+        return false;
+
+    // On a worker (e.g. inside an asset loader job) waiting for decode jobs can deadlock: they are queued behind this one
+    // and all workers may be waiting the same way
+    if (utils::JobSystem::IsWorkerThread())
+        assetLoader = nullptr;
+
+    // Not initialized on purpose, every byte gets overwritten
+    if (!m_Arena)
+        m_Arena.reset(new uint8_t[m_ArenaSize]);
+
+    // Compressed levels share one scratch allocation
+    uint64_t scratchSize = 0;
+    if (m_Supercompression == KTX2_SUPERCOMPRESSION_ZSTD) {
+        for (uint32_t mip = mipOffset; mip < mipOffset + mipNum; mip++) {
+            if (!m_Levels[mip].isLoaded)
+                scratchSize += m_Levels[mip].fileSize;
+        }
+    }
+
+    std::unique_ptr<uint8_t[]> scratch(scratchSize ? new uint8_t[scratchSize] : nullptr);
+    std::vector<AssetHandle> jobs;
+    uint64_t scratchOffset = 0;
+    bool isOk = true;
+
+    // Smaller mips are stored first in the file, so reading from the last mip is a sequential read
+    for (uint32_t i = mipOffset + mipNum; i > mipOffset && isOk; i--) {
+        Level& level = m_Levels[i - 1];
+        if (level.isLoaded)
+            continue;
+
+        uint8_t* dst = m_Arena.get() + level.arenaOffset;
+
+        if (m_Supercompression == KTX2_SUPERCOMPRESSION_NONE) {
+            isOk = ReadAt(m_File, level.fileOffset, dst, level.size);
+            continue;
+        }
+
+        uint8_t* src = scratch.get() + scratchOffset;
+        scratchOffset += level.fileSize;
+
+        isOk = ReadAt(m_File, level.fileOffset, src, level.fileSize);
+        if (!isOk)
+            break;
+
+#ifdef NRI_FRAMEWORK_ZSTD
+        uint64_t srcSize = level.fileSize;
+        uint64_t dstSize = level.size;
+        auto decompress = [src, srcSize, dst, dstSize]() {
+            size_t result = ZSTD_decompress(dst, (size_t)dstSize, src, (size_t)srcSize);
+            return !ZSTD_isError(result) && result == dstSize;
+        };
+
+        if (assetLoader)
+            jobs.push_back(assetLoader->Run(decompress));
+        else
+            isOk = decompress();
+#endif
+    }
+
+    // "scratch" must outlive the jobs
+    for (const AssetHandle& job : jobs)
+        isOk = assetLoader->Wait(job) && isOk;
+
+    if (!isOk) {
+        printf("ERROR: Can't read mips of '%s'!\n", GetFileName(m_Name));
+        return false;
+    }
+
+    for (uint32_t mip = mipOffset; mip < mipOffset + mipNum; mip++)
+        m_Levels[mip].isLoaded = true;
+
+    return true;
+}
+
+void utils::Ktx2Texture::GetSubresource(nri::TextureSubresourceUploadDesc& subresource, uint32_t mipIndex, uint32_t layerIndex) const {
+    const Level& level = m_Levels[mipIndex];
+    assert(level.isLoaded);
+
+    uint32_t sliceNum = std::max(m_Depth >> mipIndex, 1u);
+
+    subresource.slices = m_Arena.get() + level.arenaOffset + uint64_t(layerIndex) * sliceNum * level.slicePitch;
+    subresource.sliceNum = sliceNum;
+    subresource.rowPitch = level.rowPitch;
+    subresource.slicePitch = level.slicePitch;
+}
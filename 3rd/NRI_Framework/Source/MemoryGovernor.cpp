@@ -0,0 +1,212 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+
+static const char* g_MemoryCategoryNames[] = {
+    "Textures",
+    "Geometry",
+    "Streamer",
+    "Transient",
+    "Other",
+};
+
+static_assert(helper::GetCountOf(g_MemoryCategoryNames) == (size_t)utils::MemoryCategory::MAX_NUM, "Unexpected number of categories");
+
+void utils::MemoryGovernor::Initialize(const nri::CoreInterface& NRI, const nri::HelperInterface& helperInterface, nri::Device& device, const MemoryGovernorDesc& desc) {
+    m_NRI = &NRI;
+    m_HelperInterface = &helperInterface;
+    m_Device = &device;
+    m_Desc = desc;
+    m_Desc.pollInterval = std::max(m_Desc.pollInterval, 1u);
+
+    Poll();
+}
+
+void utils::MemoryGovernor::AddPressureCallback(MemorySegment segment, uint32_t priority, MemoryPressureCallback callback, void* userArg, const char* name) {
+    auto it = std::upper_bound(m_Callbacks.begin(), m_Callbacks.end(), priority, [](uint32_t priority, const Callback& callback) {
+        return priority < callback.priority;
+    });
+
+    m_Callbacks.insert(it, {callback, userArg, name, priority, segment});
+}
+
+uint32_t utils::MemoryGovernor::Track(nri::MemoryLocation memoryLocation, MemoryCategory category, uint64_t size) {
+    uint32_t allocation;
+    if (!m_FreeAllocations.empty()) {
+        allocation = m_FreeAllocations.back();
+        m_FreeAllocations.pop_back();
+    } else {
+        allocation = (uint32_t)m_Allocations.size();
+        m_Allocations.push_back({});
+    }
+
+    m_Allocations[allocation] = {0, GetSegment(memoryLocation), category};
+    Resize(allocation, size);
+
+    return allocation;
+}
+
+void utils::MemoryGovernor::Resize(uint32_t allocation, uint64_t size) {
+    Allocation& entry = m_Allocations[allocation];
+    MemorySegmentStats& stats = m_Stats[(size_t)entry.segment];
+
+    // Shrinking delivers releases promised by callbacks
+    if (size < entry.size && stats.pendingReleaseSize) {
+        stats.pendingReleaseSize -= std::min(stats.pendingReleaseSize, entry.size - size);
+        if (!stats.pendingReleaseSize)
+            m_PendingReleaseFrames[(size_t)entry.segment] = 0;
+    }
+
+    stats.trackedSize = stats.trackedSize - entry.size + size;
+    stats.categorySizes[(size_t)entry.category] = stats.categorySizes[(size_t)entry.category] - entry.size + size;
+    entry.size = size;
+
+    UpdateUsage(entry.segment);
+}
+
+void utils::MemoryGovernor::Untrack(uint32_t allocation) {
+    Resize(allocation, 0);
+    m_FreeAllocations.push_back(allocation);
+}
+
+bool utils::MemoryGovernor::MakeRoom(nri::MemoryLocation memoryLocation, uint64_t size) {
+    return Check(GetSegment(memoryLocation), size);
+}
+
+nri::Result utils::MemoryGovernor::AllocateAndBindMemory(const nri::ResourceGroupDesc& resourceGroupDesc, MemoryCategory category, nri::Memory** memories) {
+    uint64_t size = 0;
+    for (uint32_t i = 0; i < resourceGroupDesc.bufferNum; i++) {
+        nri::MemoryDesc memoryDesc = {};
+        m_NRI->GetBufferMemoryDesc(*resourceGroupDesc.buffers[i], resourceGroupDesc.memoryLocation, memoryDesc);
+        size += memoryDesc.size;
+    }
+
+    for (uint32_t i = 0; i < resourceGroupDesc.textureNum; i++) {
+        nri::MemoryDesc memoryDesc = {};
+        m_NRI->GetTextureMemoryDesc(*resourceGroupDesc.textures[i], resourceGroupDesc.memoryLocation, memoryDesc);
+        size += memoryDesc.size;
+    }
+
+    // Over budget is not a failure: the OS pages memory out, it's slow, but works
+    MakeRoom(resourceGroupDesc.memoryLocation, size);
+
+    nri::Result result = m_HelperInterface->AllocateAndBindMemory(*m_Device, resourceGroupDesc, memories);
+    if (result == nri::Result::SUCCESS)
+        Track(resourceGroupDesc.memoryLocation, category, size);
+
+    return result;
+}
+
+void utils::MemoryGovernor::Update() {
+    // Undelivered promises are not expected anymore, the pressure gets re-evaluated
+    for (size_t i = 0; i < m_Stats.size(); i++) {
+        if (m_PendingReleaseFrames[i] && --m_PendingReleaseFrames[i] == 0)
+            m_Stats[i].pendingReleaseSize = 0;
+    }
+
+    if (++m_FramesSincePoll < m_Desc.pollInterval)
+        return;
+
+    Poll();
+
+    for (size_t i = 0; i < m_Stats.size(); i++)
+        Check((MemorySegment)i, 0);
+}
+
+const char* utils::MemoryGovernor::GetCategoryName(MemoryCategory category) {
+    return g_MemoryCategoryNames[(size_t)category];
+}
+
+void utils::MemoryGovernor::Poll() {
+    m_FramesSincePoll = 0;
+
+    for (size_t i = 0; i < m_Stats.size(); i++) {
+        MemorySegmentStats& stats = m_Stats[i];
+
+        nri::MemoryLocation memoryLocation = (MemorySegment)i == MemorySegment::LOCAL ? nri::MemoryLocation::DEVICE : nri::MemoryLocation::HOST_UPLOAD;
+        nri::VideoMemoryInfo videoMemoryInfo = {};
+        if (m_HelperInterface->QueryVideoMemoryInfo(*m_Device, memoryLocation, videoMemoryInfo) == nri::Result::SUCCESS) {
+            stats.budgetSize = videoMemoryInfo.budgetSize;
+            stats.polledUsageSize = videoMemoryInfo.usageSize;
+            m_TrackedSizeAtPoll[i] = stats.trackedSize;
+        }
+
+        if (m_Desc.simulatedBudget[i])
+            stats.budgetSize = m_Desc.simulatedBudget[i];
+
+        UpdateUsage((MemorySegment)i);
+    }
+}
+
+void utils::MemoryGovernor::UpdateUsage(MemorySegment segment) {
+    MemorySegmentStats& stats = m_Stats[(size_t)segment];
+
+    // Tracked memory allocated or freed since the poll is not reflected in the polled usage yet
+    int64_t delta = int64_t(stats.trackedSize) - int64_t(m_TrackedSizeAtPoll[(size_t)segment]);
+    int64_t usageSize = std::max(int64_t(stats.polledUsageSize) + delta, int64_t(0));
+
+    stats.usageSize = std::max(uint64_t(usageSize), stats.trackedSize);
+}
+
+bool utils::MemoryGovernor::Check(MemorySegment segment, uint64_t size) {
+    MemorySegmentStats& stats = m_Stats[(size_t)segment];
+    if (!stats.budgetSize)
+        return true;
+
+    uint64_t usageSize = stats.usageSize + size;
+    uint64_t targetSize = uint64_t(double(stats.budgetSize) * m_Desc.targetUsage);
+    uint64_t restoreSize = uint64_t(double(stats.budgetSize) * m_Desc.restoreUsage);
+
+    MemoryPressure pressure = {};
+    pressure.segment = segment;
+    pressure.budgetSize = stats.budgetSize;
+    pressure.usageSize = usageSize;
+
+    if (usageSize <= targetSize) {
+        // Hysteresis: reverting downgrades right under the target would bring the pressure back
+        if (stats.isUnderPressure && usageSize < restoreSize) {
+            for (auto it = m_Callbacks.rbegin(); it != m_Callbacks.rend(); it++) {
+                if (it->segment == segment)
+                    it->callback(pressure, it->userArg);
+            }
+
+            stats.isUnderPressure = false;
+            stats.isOverBudget = false;
+        }
+
+        return true;
+    }
+
+    // Releases promised by callbacks are not delivered yet (e.g. evicted mips waiting for frames in flight, replacements
+    // may even grow the usage meanwhile): firing again would release the same bytes twice
+    if (stats.pendingReleaseSize)
+        return usageSize <= stats.budgetSize + stats.pendingReleaseSize;
+
+    // Callbacks may "Untrack" or "Resize" while releasing, so the decision is based on the usage and the reported sizes
+    // before the calls
+    uint64_t requiredSize = usageSize - targetSize;
+    uint64_t releasedSize = 0;
+    uint64_t trackedSize = stats.trackedSize;
+    for (const Callback& callback : m_Callbacks) {
+        if (releasedSize >= requiredSize)
+            break;
+
+        if (callback.segment != segment)
+            continue;
+
+        pressure.releaseSize = requiredSize - releasedSize;
+        releasedSize += callback.callback(pressure, callback.userArg);
+    }
+
+    // Memory untracked by the callbacks is delivered, the rest is promised
+    uint64_t deliveredSize = trackedSize - std::min(stats.trackedSize, trackedSize);
+    stats.pendingReleaseSize = releasedSize - std::min(deliveredSize, releasedSize);
+    m_PendingReleaseFrames[(size_t)segment] = stats.pendingReleaseSize ? BUFFERED_FRAME_MAX_NUM + 1 : 0;
+
+    stats.releasedSize += releasedSize;
+    stats.pressureNum++;
+    stats.isUnderPressure = true;
+    stats.isOverBudget = releasedSize < requiredSize;
+
+    return usageSize <= stats.budgetSize + releasedSize;
+}
@@ -0,0 +1,452 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+constexpr uint32_t FORSYTH_CACHE_SIZE = 32; // LRU
+constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+constexpr uint32_t FORSYTH_VALENCE_TABLE_SIZE = 32;
+
+struct ForsythTables {
+    float cache[FORSYTH_CACHE_SIZE];
+    float valence[FORSYTH_VALENCE_TABLE_SIZE];
+
+    ForsythTables() {
+        for (uint32_t i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+            // The last triangle's vertices get a fixed score to avoid "stripping" through the cache
+            if (i < 3)
+                cache[i] = FORSYTH_LAST_TRIANGLE_SCORE;
+            else
+                cache[i] = powf(1.0f - float(i - 3) / float(FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+        }
+
+        // Vertices with few triangles left are preferred to get rid of lone triangles
+        valence[0] = 0.0f;
+        for (uint32_t i = 1; i < FORSYTH_VALENCE_TABLE_SIZE; i++)
+            valence[i] = FORSYTH_VALENCE_BOOST_SCALE * powf(float(i), -FORSYTH_VALENCE_BOOST_POWER);
+    }
+};
+
+static const ForsythTables g_ForsythTables;
+
+static float GetVertexScore(uint32_t cachePosition, uint32_t remainingTriangleNum) {
+    if (!remainingTriangleNum)
+        return -1.0f;
+
+    float score = cachePosition < FORSYTH_CACHE_SIZE ? g_ForsythTables.cache[cachePosition] : 0.0f;
+    if (remainingTriangleNum < FORSYTH_VALENCE_TABLE_SIZE)
+        score += g_ForsythTables.valence[remainingTriangleNum];
+    else
+        score += FORSYTH_VALENCE_BOOST_SCALE * powf(float(remainingTriangleNum), -FORSYTH_VALENCE_BOOST_POWER);
+
+    return score;
+}
+
+static uint32_t HashVertex(const utils::UnpackedVertex& vertex) {
+    static_assert(sizeof(utils::UnpackedVertex) % sizeof(uint32_t) == 0, "Unexpected padding");
+
+    uint32_t words[sizeof(utils::UnpackedVertex) / sizeof(uint32_t)];
+    memcpy(words, &vertex, sizeof(vertex));
+
+    // FNV-1a over dwords with a final avalanche
+    uint32_t hash = 2166136261u;
+    for (uint32_t word : words)
+        hash = (hash ^ word) * 16777619u;
+
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+utils::VertexCacheStats utils::AnalyzeVertexCache(const Index* indices, uint32_t indexNum, uint32_t vertexNum, uint32_t cacheSize) {
+    // FIFO: a vertex is in the cache if fewer than "cacheSize" misses happened since it was loaded
+    std::vector<uint32_t> timestamps(vertexNum, 0);
+    uint32_t timestamp = cacheSize + 1;
+    uint32_t transformedVertexNum = 0;
+
+    for (uint32_t i = 0; i < indexNum; i++) {
+        uint32_t vertex = indices[i];
+        if (timestamp - timestamps[vertex] > cacheSize) {
+            timestamps[vertex] = timestamp++;
+            transformedVertexNum++;
+        }
+    }
+
+    VertexCacheStats stats = {};
+    stats.transformedVertexNum = transformedVertexNum;
+    stats.acmr = indexNum ? float(transformedVertexNum) / float(indexNum / 3) : 0.0f;
+    stats.atvr = vertexNum ? float(transformedVertexNum) / float(vertexNum) : 0.0f;
+
+    return stats;
+}
+
+uint32_t utils::WeldVertices(UnpackedVertex* vertices, uint32_t vertexNum, Index* indices, uint32_t indexNum) {
+    uint32_t tableSize = 1;
+    while (tableSize < vertexNum + vertexNum / 4)
+        tableSize <<= 1;
+
+    // Open addressing, slots store indices of already compacted vertices
+    std::vector<uint32_t> table(tableSize, InvalidIndex);
+    std::vector<uint32_t> remap(vertexNum);
+    uint32_t mask = tableSize - 1;
+    uint32_t uniqueVertexNum = 0;
+
+    for (uint32_t i = 0; i < vertexNum; i++) {
+        uint32_t slot = HashVertex(vertices[i]) & mask;
+
+        for (uint32_t probe = 1;; probe++) {
+            uint32_t index = table[slot];
+            if (index == InvalidIndex) {
+                table[slot] = uniqueVertexNum;
+                vertices[uniqueVertexNum] = vertices[i];
+                remap[i] = uniqueVertexNum++;
+                break;
+            }
+
+            if (!memcmp(vertices + index, vertices + i, sizeof(UnpackedVertex))) {
+                remap[i] = index;
+                break;
+            }
+
+            slot = (slot + probe) & mask; // triangular probing visits all slots of a power of 2 table
+        }
+    }
+
+    for (uint32_t i = 0; i < indexNum; i++)
+        indices[i] = remap[indices[i]];
+
+    return uniqueVertexNum;
+}
+
+uint32_t utils::RemoveDegenerateTriangles(Index* indices, uint32_t indexNum, const UnpackedVertex* vertices) {
+    uint32_t keptIndexNum = 0;
+    for (uint32_t i = 0; i + 3 <= indexNum; i += 3) {
+        Index i0 = indices[i];
+        Index i1 = indices[i + 1];
+        Index i2 = indices[i + 2];
+        if (i0 == i1 || i1 == i2 || i2 == i0)
+            continue;
+
+        // Coincident or collinear positions (vertices differing only in attributes survive welding)
+        const float* p0 = vertices[i0].pos;
+        const float* p1 = vertices[i1].pos;
+        const float* p2 = vertices[i2].pos;
+
+        float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        if (n[0] == 0.0f && n[1] == 0.0f && n[2] == 0.0f)
+            continue;
+
+        indices[keptIndexNum++] = i0;
+        indices[keptIndexNum++] = i1;
+        indices[keptIndexNum++] = i2;
+    }
+
+    return keptIndexNum;
+}
+
+void utils::OptimizeVertexCache(Index* indices, uint32_t indexNum, uint32_t vertexNum) {
+    uint32_t triangleNum = indexNum / 3;
+    if (!triangleNum)
+        return;
+
+    // Vertex => triangles adjacency, the first "remainingTriangleNums[v]" entries are not emitted yet
+    std::vector<uint32_t> remainingTriangleNums(vertexNum, 0);
+    for (uint32_t i = 0; i < triangleNum * 3; i++)
+        remainingTriangleNums[indices[i]]++;
+
+    std::vector<uint32_t> adjacencyOffsets(vertexNum + 1, 0);
+    for (uint32_t i = 0; i < vertexNum; i++)
+        adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingTriangleNums[i];
+
+    std::vector<uint32_t> adjacency(triangleNum * 3);
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (uint32_t i = 0; i < triangleNum * 3; i++)
+            adjacency[fill[indices[i]]++] = i / 3;
+    }
+
+    std::vector<uint32_t> cachePositions(vertexNum, InvalidIndex);
+    std::vector<float> vertexScores(vertexNum);
+    for (uint32_t i = 0; i < vertexNum; i++)
+        vertexScores[i] = GetVertexScore(InvalidIndex, remainingTriangleNums[i]);
+
+    std::vector<float> triangleScores(triangleNum);
+    std::vector<uint8_t> isEmitted(triangleNum, 0);
+    uint32_t bestTriangle = 0;
+    for (uint32_t i = 0; i < triangleNum; i++) {
+        const Index* tri = indices + i * 3;
+        triangleScores[i] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+        if (triangleScores[i] > triangleScores[bestTriangle])
+            bestTriangle = i;
+    }
+
+    std::vector<Index> result(triangleNum * 3);
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t cacheNum = 0;
+    uint32_t inputCursor = 0;
+
+    for (uint32_t i = 0; i < triangleNum; i++) {
+        // No candidates in the cache - continue with the next triangle in the input order
+        if (bestTriangle == InvalidIndex) {
+            while (isEmitted[inputCursor])
+                inputCursor++;
+
+            bestTriangle = inputCursor;
+        }
+
+        const Index* tri = indices + bestTriangle * 3;
+        memcpy(&result[i * 3], tri, 3 * sizeof(Index));
+        isEmitted[bestTriangle] = 1;
+
+        // Emitted triangle goes to the front of the LRU cache
+        uint32_t newCacheNum = 0;
+        for (uint32_t j = 0; j < 3; j++) {
+            uint32_t vertex = tri[j];
+            newCache[newCacheNum++] = vertex;
+
+            uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+            uint32_t* end = begin + remainingTriangleNums[vertex];
+            uint32_t* it = std::find(begin, end, bestTriangle);
+            *it = *(end - 1);
+            remainingTriangleNums[vertex]--;
+        }
+
+        for (uint32_t j = 0; j < cacheNum; j++) {
+            uint32_t vertex = cache[j];
+            if (vertex != tri[0] && vertex != tri[1] && vertex != tri[2])
+                newCache[newCacheNum++] = vertex;
+        }
+
+        for (uint32_t j = 0; j < newCacheNum; j++) {
+            uint32_t vertex = newCache[j];
+            cachePositions[vertex] = j < FORSYTH_CACHE_SIZE ? j : InvalidIndex;
+            vertexScores[vertex] = GetVertexScore(cachePositions[vertex], remainingTriangleNums[vertex]);
+        }
+
+        // Only triangles touching the cache change their scores
+        bestTriangle = InvalidIndex;
+        float bestScore = -1.0f;
+        for (uint32_t j = 0; j < newCacheNum; j++) {
+            uint32_t vertex = newCache[j];
+            const uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+
+            for (uint32_t k = 0; k < remainingTriangleNums[vertex]; k++) {
+                uint32_t triangle = begin[k];
+                const Index* t = indices + triangle * 3;
+
+                float score = vertexScores[t[0]] + vertexScores[t[1]] + vertexScores[t[2]];
+                triangleScores[triangle] = score;
+
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTriangle = triangle;
+                }
+            }
+        }
+
+        cacheNum = std::min(newCacheNum, FORSYTH_CACHE_SIZE);
+        memcpy(cache, newCache, cacheNum * sizeof(uint32_t));
+    }
+
+    memcpy(indices, result.data(), result.size() * sizeof(Index));
+}
+
+struct TriangleCluster {
+    uint32_t triangleOffset;
+    uint32_t triangleNum;
+    float sortKey;
+};
+
+void utils::OptimizeOverdraw(Index* indices, uint32_t indexNum, const UnpackedVertex* vertices, uint32_t vertexNum, float threshold) {
+    uint32_t triangleNum = indexNum / 3;
+    if (triangleNum < 2)
+        return;
+
+    const uint32_t cacheSize = VERTEX_CACHE_ANALYSIS_SIZE;
+    std::vector<uint32_t> timestamps(vertexNum, 0);
+    uint32_t timestamp = cacheSize + 1;
+
+    auto SimulateTriangle = [&](uint32_t triangle) {
+        uint32_t missNum = 0;
+        for (uint32_t j = 0; j < 3; j++) {
+            uint32_t vertex = indices[triangle * 3 + j];
+            if (timestamp - timestamps[vertex] > cacheSize) {
+                timestamps[vertex] = timestamp++;
+                missNum++;
+            }
+        }
+
+        return missNum;
+    };
+
+    // Hard boundaries: the cache is fully flushed, reordering clusters costs nothing
+    std::vector<uint32_t> hardBoundaries;
+    for (uint32_t i = 0; i < triangleNum; i++) {
+        if (SimulateTriangle(i) == 3 || i == 0)
+            hardBoundaries.push_back(i);
+    }
+    hardBoundaries.push_back(triangleNum);
+
+    // Soft boundaries: a hard cluster is split once its running ACMR is within "threshold" of the whole cluster ACMR
+    std::vector<TriangleCluster> clusters;
+    for (size_t i = 0; i + 1 < hardBoundaries.size(); i++) {
+        uint32_t begin = hardBoundaries[i];
+        uint32_t end = hardBoundaries[i + 1];
+
+        timestamp += cacheSize + 1;
+        uint32_t clusterMissNum = 0;
+        for (uint32_t j = begin; j < end; j++)
+            clusterMissNum += SimulateTriangle(j);
+
+        float targetAcmr = threshold * float(clusterMissNum) / float(end - begin);
+
+        timestamp += cacheSize + 1;
+        uint32_t start = begin;
+        uint32_t missNum = 0;
+        for (uint32_t j = begin; j < end; j++) {
+            missNum += SimulateTriangle(j);
+
+            if (j + 1 == end || float(missNum) / float(j + 1 - start) <= targetAcmr) {
+                clusters.push_back({start, j + 1 - start, 0.0f});
+
+                timestamp += cacheSize + 1;
+                start = j + 1;
+                missNum = 0;
+            }
+        }
+    }
+
+    if (clusters.size() < 2)
+        return;
+
+    // Outward facing clusters are drawn first: "dot(clusterCentroid - meshCentroid, clusterNormal)"
+    float meshCentroid[3] = {};
+    for (uint32_t i = 0; i < vertexNum; i++) {
+        for (uint32_t j = 0; j < 3; j++)
+            meshCentroid[j] += vertices[i].pos[j];
+    }
+
+    for (uint32_t j = 0; j < 3; j++)
+        meshCentroid[j] /= float(std::max(vertexNum, 1u));
+
+    for (TriangleCluster& cluster : clusters) {
+        float centroid[3] = {};
+        float normal[3] = {};
+        float areaSum = 0.0f;
+
+        for (uint32_t i = cluster.triangleOffset; i < cluster.triangleOffset + cluster.triangleNum; i++) {
+            const float* p0 = vertices[indices[i * 3]].pos;
+            const float* p1 = vertices[indices[i * 3 + 1]].pos;
+            const float* p2 = vertices[indices[i * 3 + 2]].pos;
+
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+
+            // Both are area weighted ("n" length is 2x area)
+            float area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (uint32_t j = 0; j < 3; j++) {
+                centroid[j] += (p0[j] + p1[j] + p2[j]) * area;
+                normal[j] += n[j];
+            }
+            areaSum += area;
+        }
+
+        float normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float invArea = areaSum > 0.0f ? 1.0f / (3.0f * areaSum) : 0.0f;
+        float invNormalLength = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+
+        cluster.sortKey = 0.0f;
+        for (uint32_t j = 0; j < 3; j++)
+            cluster.sortKey += (centroid[j] * invArea - meshCentroid[j]) * normal[j] * invNormalLength;
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const TriangleCluster& a, const TriangleCluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<Index> result;
+    result.reserve(triangleNum * 3);
+    for (const TriangleCluster& cluster : clusters)
+        result.insert(result.end(), indices + cluster.triangleOffset * 3, indices + (cluster.triangleOffset + cluster.triangleNum) * 3);
+
+    memcpy(indices, result.data(), result.size() * sizeof(Index));
+}
+
+uint32_t utils::OptimizeVertexFetch(UnpackedVertex* vertices, uint32_t vertexNum, Index* indices, uint32_t indexNum) {
+    std::vector<uint32_t> remap(vertexNum, InvalidIndex);
+    uint32_t usedVertexNum = 0;
+
+    for (uint32_t i = 0; i < indexNum; i++) {
+        uint32_t& index = remap[indices[i]];
+        if (index == InvalidIndex)
+            index = usedVertexNum++;
+
+        indices[i] = index;
+    }
+
+    std::vector<UnpackedVertex> reordered(usedVertexNum);
+    for (uint32_t i = 0; i < vertexNum; i++) {
+        if (remap[i] != InvalidIndex)
+            reordered[remap[i]] = vertices[i];
+    }
+
+    memcpy(vertices, reordered.data(), reordered.size() * sizeof(UnpackedVertex));
+
+    return usedVertexNum;
+}
+
+uint32_t utils::OptimizeMesh(std::vector<UnpackedVertex>& vertices, Index* indices, uint32_t indexNum, MeshOptimizerStats& stats) {
+    Timer timer;
+    double begin = timer.GetTimeStamp();
+
+    uint32_t vertexNum = (uint32_t)vertices.size();
+    uint32_t weldedVertexNum = WeldVertices(vertices.data(), vertexNum, indices, indexNum);
+    uint32_t triangleNum = indexNum / 3;
+    indexNum = RemoveDegenerateTriangles(indices, indexNum, vertices.data());
+
+    // The input order of the cleaned up mesh, the reordering below doesn't change the triangle and vertex sets
+    VertexCacheStats before = AnalyzeVertexCache(indices, indexNum, weldedVertexNum);
+
+    OptimizeVertexCache(indices, indexNum, weldedVertexNum);
+    OptimizeOverdraw(indices, indexNum, vertices.data(), weldedVertexNum);
+    uint32_t usedVertexNum = OptimizeVertexFetch(vertices.data(), weldedVertexNum, indices, indexNum);
+    vertices.resize(usedVertexNum);
+
+    VertexCacheStats after = AnalyzeVertexCache(indices, indexNum, usedVertexNum);
+
+    stats.triangleNum += indexNum / 3;
+    stats.degenerateTriangleNum += triangleNum - indexNum / 3;
+    stats.vertexNum += usedVertexNum;
+    stats.weldedVertexNum += vertexNum - usedVertexNum;
+    stats.transformedVertexNumBefore += before.transformedVertexNum;
+    stats.transformedVertexNumAfter += after.transformedVertexNum;
+    stats.meshNum++;
+    if (GetIndexType(usedVertexNum) == nri::IndexType::UINT16)
+        stats.index16MeshNum++;
+    stats.time += timer.GetTimeStamp() - begin;
+
+    return indexNum;
+}
+
+void utils::ConvertIndices(const Index* indices, uint32_t indexNum, nri::IndexType indexType, void* dst) {
+    if (indexType == nri::IndexType::UINT32) {
+        memcpy(dst, indices, indexNum * sizeof(Index));
+        return;
+    }
+
+    uint16_t* dst16 = (uint16_t*)dst;
+    for (uint32_t i = 0; i < indexNum; i++)
+        dst16[i] = (uint16_t)indices[i];
+}
@@ -0,0 +1,440 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+constexpr double BORDER_QUADRIC_WEIGHT = 10.0; // borders are much more expensive to move than interior vertices
+constexpr float LOD_MIN_REDUCTION = 0.9f; // a LOD must remove at least 10% of the previous one
+
+struct Quadric {
+    double a2, b2, c2, d2;
+    double ab, ac, ad;
+    double bc, bd;
+    double cd;
+    double weight;
+
+    void AddPlane(const double* plane, double w) {
+        double a = plane[0], b = plane[1], c = plane[2], d = plane[3];
+
+        a2 += a * a * w;
+        b2 += b * b * w;
+        c2 += c * c * w;
+        d2 += d * d * w;
+        ab += a * b * w;
+        ac += a * c * w;
+        ad += a * d * w;
+        bc += b * c * w;
+        bd += b * d * w;
+        cd += c * d * w;
+        weight += w;
+    }
+
+    void Add(const Quadric& q) {
+        const double* src = &q.a2;
+        double* dst = &a2;
+        for (uint32_t i = 0; i < 11; i++)
+            dst[i] += src[i];
+    }
+
+    // Sum of weighted squared distances to the planes
+    double Evaluate(const float* p) const {
+        double x = p[0], y = p[1], z = p[2];
+
+        return a2 * x * x + b2 * y * y + c2 * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) + 2.0 * (ad * x + bd * y + cd * z) + d2;
+    }
+};
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    float cost; // squared distance + attribute penalty, for ordering
+    float distanceSq;
+};
+
+static inline void Cross(const float* a, const float* b, float* r) {
+    r[0] = a[1] * b[2] - a[2] * b[1];
+    r[1] = a[2] * b[0] - a[0] * b[2];
+    r[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static inline float Dot(const float* a, const float* b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void GetTriangleNormal(const float* p0, const float* p1, const float* p2, float* n) {
+    float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    Cross(e1, e2, n);
+}
+
+static float GetMeshRadius(const utils::UnpackedVertex* vertices, uint32_t vertexNum) {
+    float aabbMin[3] = {INFINITY, INFINITY, INFINITY};
+    float aabbMax[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (uint32_t i = 0; i < vertexNum; i++) {
+        for (uint32_t j = 0; j < 3; j++) {
+            aabbMin[j] = std::min(aabbMin[j], vertices[i].pos[j]);
+            aabbMax[j] = std::max(aabbMax[j], vertices[i].pos[j]);
+        }
+    }
+
+    float extent[3] = {aabbMax[0] - aabbMin[0], aabbMax[1] - aabbMin[1], aabbMax[2] - aabbMin[2]};
+
+    return vertexNum ? 0.5f * sqrtf(Dot(extent, extent)) : 0.0f;
+}
+
+uint32_t utils::SimplifyMesh(const UnpackedVertex* vertices, uint32_t vertexNum, const Index* indices, uint32_t indexNum, uint32_t targetIndexNum, float maxError,
+    const MeshSimplifierDesc& desc, Index* dst, float& error) {
+    std::vector<Index> current(indices, indices + indexNum);
+    error = 0.0f;
+
+    float radius = GetMeshRadius(vertices, vertexNum);
+    float maxDistanceSq = maxError * radius * maxError * radius;
+    float attributeScale = radius * radius; // attribute differences are in [0; 4] (normals) and UV units
+
+    // Seams: vertices sharing a position with another vertex are locked, moving them would open cracks
+    std::vector<uint8_t> isLocked(vertexNum, 0);
+    {
+        std::vector<uint32_t> order(vertexNum);
+        for (uint32_t i = 0; i < vertexNum; i++)
+            order[i] = i;
+
+        std::sort(order.begin(), order.end(), [vertices](uint32_t a, uint32_t b) {
+            return memcmp(vertices[a].pos, vertices[b].pos, sizeof(vertices[a].pos)) < 0;
+        });
+
+        for (uint32_t i = 1; i < vertexNum; i++) {
+            if (!memcmp(vertices[order[i - 1]].pos, vertices[order[i]].pos, sizeof(vertices[0].pos)))
+                isLocked[order[i - 1]] = isLocked[order[i]] = 1;
+        }
+    }
+
+    // Quadrics: area weighted face planes + planes perpendicular to border edges
+    std::vector<Quadric> quadrics(vertexNum, Quadric{});
+    {
+        std::vector<uint64_t> edges;
+        edges.reserve(indexNum);
+
+        for (uint32_t i = 0; i + 2 < indexNum; i += 3) {
+            const float* p[3] = {vertices[current[i]].pos, vertices[current[i + 1]].pos, vertices[current[i + 2]].pos};
+
+            float n[3];
+            GetTriangleNormal(p[0], p[1], p[2], n);
+
+            float length = sqrtf(Dot(n, n));
+            if (length == 0.0f)
+                continue;
+
+            double plane[4] = {n[0] / length, n[1] / length, n[2] / length, 0.0};
+            plane[3] = -(plane[0] * p[0][0] + plane[1] * p[0][1] + plane[2] * p[0][2]);
+
+            for (uint32_t j = 0; j < 3; j++) {
+                quadrics[current[i + j]].AddPlane(plane, length * 0.5);
+
+                uint32_t a = current[i + j];
+                uint32_t b = current[i + (j + 1) % 3];
+                edges.push_back((uint64_t(std::min(a, b)) << 32) | std::max(a, b));
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+
+        for (uint32_t i = 0; i + 2 < indexNum; i += 3) {
+            const float* p[3] = {vertices[current[i]].pos, vertices[current[i + 1]].pos, vertices[current[i + 2]].pos};
+
+            float n[3];
+            GetTriangleNormal(p[0], p[1], p[2], n);
+
+            for (uint32_t j = 0; j < 3; j++) {
+                uint32_t a = current[i + j];
+                uint32_t b = current[i + (j + 1) % 3];
+                uint64_t key = (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+
+                auto range = std::equal_range(edges.begin(), edges.end(), key);
+                if (range.second - range.first != 1)
+                    continue;
+
+                const float* pa = p[j];
+                const float* pb = p[(j + 1) % 3];
+                float e[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+
+                float bn[3];
+                Cross(e, n, bn);
+
+                float length = sqrtf(Dot(bn, bn));
+                if (length == 0.0f)
+                    continue;
+
+                double plane[4] = {bn[0] / length, bn[1] / length, bn[2] / length, 0.0};
+                plane[3] = -(plane[0] * pa[0] + plane[1] * pa[1] + plane[2] * pa[2]);
+
+                double w = Dot(e, e) * BORDER_QUADRIC_WEIGHT;
+                quadrics[a].AddPlane(plane, w);
+                quadrics[b].AddPlane(plane, w);
+            }
+        }
+    }
+
+    auto GetCollapse = [&](uint32_t from, uint32_t to) {
+        Quadric q = quadrics[from];
+        q.Add(quadrics[to]);
+
+        const UnpackedVertex& a = vertices[from];
+        const UnpackedVertex& b = vertices[to];
+
+        double distanceSq = q.weight > 0.0 ? std::max(q.Evaluate(b.pos), 0.0) / q.weight : 0.0;
+
+        float dn[3] = {a.N[0] - b.N[0], a.N[1] - b.N[1], a.N[2] - b.N[2]};
+        float du[2] = {a.uv[0] - b.uv[0], a.uv[1] - b.uv[1]};
+        float attributeCost = (desc.normalWeight * Dot(dn, dn) + desc.uvWeight * (du[0] * du[0] + du[1] * du[1])) * attributeScale;
+
+        return Collapse{from, to, float(distanceSq) + attributeCost, float(distanceSq)};
+    };
+
+    std::vector<uint32_t> remainingTriangleNums(vertexNum);
+    std::vector<uint32_t> adjacencyOffsets(vertexNum + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint64_t> edges;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapseTargets(vertexNum);
+    std::vector<uint8_t> isTouched(vertexNum);
+
+    // Passes of independent collapses (a collapse touches no vertex around another collapse of the same pass)
+    while (current.size() > targetIndexNum) {
+        uint32_t triangleNum = (uint32_t)current.size() / 3;
+
+        std::fill(remainingTriangleNums.begin(), remainingTriangleNums.end(), 0);
+        for (Index index : current)
+            remainingTriangleNums[index]++;
+
+        adjacencyOffsets[0] = 0;
+        for (uint32_t i = 0; i < vertexNum; i++)
+            adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingTriangleNums[i];
+
+        adjacency.resize(current.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (uint32_t i = 0; i < (uint32_t)current.size(); i++)
+                adjacency[fill[current[i]]++] = i / 3;
+        }
+
+        edges.clear();
+        for (uint32_t i = 0; i < (uint32_t)current.size(); i += 3) {
+            for (uint32_t j = 0; j < 3; j++) {
+                uint32_t a = current[i + j];
+                uint32_t b = current[i + (j + 1) % 3];
+                edges.push_back((uint64_t(std::min(a, b)) << 32) | std::max(a, b));
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+        for (uint64_t edge : edges) {
+            uint32_t a = uint32_t(edge >> 32);
+            uint32_t b = uint32_t(edge);
+
+            // The error limit is geometric, attributes only affect the order
+            Collapse ab = isLocked[a] ? Collapse{a, b, INFINITY, INFINITY} : GetCollapse(a, b);
+            Collapse ba = isLocked[b] ? Collapse{b, a, INFINITY, INFINITY} : GetCollapse(b, a);
+
+            if (ab.distanceSq > maxDistanceSq)
+                ab.cost = INFINITY;
+            if (ba.distanceSq > maxDistanceSq)
+                ba.cost = INFINITY;
+
+            const Collapse& best = ab.cost <= ba.cost ? ab : ba;
+            if (best.cost != INFINITY)
+                collapses.push_back(best);
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.cost < y.cost;
+        });
+
+        for (uint32_t i = 0; i < vertexNum; i++)
+            collapseTargets[i] = i;
+
+        std::fill(isTouched.begin(), isTouched.end(), 0);
+
+        uint32_t targetTriangleNum = targetIndexNum / 3;
+        uint32_t removedTriangleNum = 0;
+        uint32_t collapseNum = 0;
+
+        for (const Collapse& collapse : collapses) {
+            if (triangleNum - removedTriangleNum <= targetTriangleNum)
+                break;
+
+            if (isTouched[collapse.from] || isTouched[collapse.to])
+                continue;
+
+            // Triangles around "from" must not flip
+            const uint32_t* triangles = &adjacency[adjacencyOffsets[collapse.from]];
+            uint32_t sharedNum = 0;
+            bool isFlipped = false;
+
+            for (uint32_t j = 0; j < remainingTriangleNums[collapse.from] && !isFlipped; j++) {
+                const Index* tri = &current[triangles[j] * 3];
+                if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) {
+                    sharedNum++;
+                    continue;
+                }
+
+                const float* p[3];
+                const float* q[3];
+                for (uint32_t k = 0; k < 3; k++) {
+                    p[k] = vertices[tri[k]].pos;
+                    q[k] = tri[k] == collapse.from ? vertices[collapse.to].pos : p[k];
+                }
+
+                float n0[3], n1[3];
+                GetTriangleNormal(p[0], p[1], p[2], n0);
+                GetTriangleNormal(q[0], q[1], q[2], n1);
+                isFlipped = Dot(n0, n1) <= 0.0f;
+            }
+
+            if (isFlipped)
+                continue;
+
+            collapseTargets[collapse.from] = collapse.to;
+            quadrics[collapse.to].Add(quadrics[collapse.from]);
+            error = std::max(error, sqrtf(collapse.distanceSq));
+
+            isTouched[collapse.from] = 1;
+            isTouched[collapse.to] = 1;
+            for (uint32_t j = 0; j < remainingTriangleNums[collapse.from]; j++) {
+                const Index* tri = &current[triangles[j] * 3];
+                isTouched[tri[0]] = isTouched[tri[1]] = isTouched[tri[2]] = 1;
+            }
+
+            removedTriangleNum += sharedNum;
+            collapseNum++;
+        }
+
+        if (!collapseNum)
+            break;
+
+        // Apply, dropping degenerate triangles
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < (uint32_t)current.size(); i += 3) {
+            Index a = collapseTargets[current[i]];
+            Index b = collapseTargets[current[i + 1]];
+            Index c = collapseTargets[current[i + 2]];
+
+            if (a != b && b != c && c != a) {
+                current[n++] = a;
+                current[n++] = b;
+                current[n++] = c;
+            }
+        }
+        current.resize(n);
+    }
+
+    memcpy(dst, current.data(), current.size() * sizeof(Index));
+
+    return (uint32_t)current.size();
+}
+
+struct MeshLodTask {
+    std::vector<utils::Index> lodIndices[utils::MESH_LOD_MAX_NUM];
+    float lodErrors[utils::MESH_LOD_MAX_NUM];
+    uint32_t lodNum;
+    float radius;
+};
+
+void utils::BuildSceneLods(Scene& scene, const MeshSimplifierDesc& desc, MeshSimplifierStats& stats, uint32_t threadNum) {
+    Timer timer;
+    double begin = timer.GetTimeStamp();
+
+    uint32_t lodNum = std::min(std::max(desc.lodNum, 1u), MESH_LOD_MAX_NUM);
+    std::vector<MeshLodTask> tasks(scene.meshes.size());
+
+    // LODs are simplified from the previous LOD, errors accumulate. A mesh takes milliseconds, no need for a cutoff
+    JobSystem::GetShared().ParallelFor((uint32_t)tasks.size(), threadNum, [&](uint32_t i) {
+        const Mesh& mesh = scene.meshes[i];
+        const UnpackedVertex* vertices = scene.unpackedVertices.data() + mesh.vertexOffset;
+        MeshLodTask& task = tasks[i];
+
+        task.radius = GetMeshRadius(vertices, mesh.vertexNum);
+        task.lodIndices[0].assign(scene.indices.begin() + mesh.indexOffset, scene.indices.begin() + mesh.indexOffset + mesh.indexNum);
+        task.lodErrors[0] = 0.0f;
+        task.lodNum = 1;
+
+        while (task.lodNum < lodNum) {
+            const std::vector<Index>& prev = task.lodIndices[task.lodNum - 1];
+            uint32_t targetIndexNum = uint32_t(prev.size() / 3 * desc.reductionPerLod) * 3;
+
+            std::vector<Index>& lod = task.lodIndices[task.lodNum];
+            lod.resize(prev.size());
+
+            float error = 0.0f;
+            uint32_t indexNum = SimplifyMesh(vertices, mesh.vertexNum, prev.data(), (uint32_t)prev.size(), targetIndexNum, desc.maxError, desc, lod.data(), error);
+            lod.resize(indexNum);
+
+            if (!indexNum || indexNum > prev.size() * LOD_MIN_REDUCTION)
+                break;
+
+            task.lodErrors[task.lodNum] = task.lodErrors[task.lodNum - 1] + error;
+            task.lodNum++;
+        }
+    });
+
+    // LOD 0 is the original range, others go to the end of "indices"
+    scene.meshLods.clear();
+    for (uint32_t i = 0; i < (uint32_t)tasks.size(); i++) {
+        Mesh& mesh = scene.meshes[i];
+        const MeshLodTask& task = tasks[i];
+
+        mesh.lodOffset = (uint32_t)scene.meshLods.size();
+        mesh.lodNum = task.lodNum;
+
+        for (uint32_t j = 0; j < task.lodNum; j++) {
+            MeshLod& lod = scene.meshLods.emplace_back();
+            lod.error = task.lodErrors[j];
+
+            if (j == 0) {
+                lod.indexOffset = mesh.indexOffset;
+                lod.indexNum = mesh.indexNum;
+            } else {
+                lod.indexOffset = (uint32_t)scene.indices.size();
+                lod.indexNum = (uint32_t)task.lodIndices[j].size();
+                scene.indices.insert(scene.indices.end(), task.lodIndices[j].begin(), task.lodIndices[j].end());
+            }
+
+            stats.triangleNum[j] += lod.indexNum / 3;
+            if (task.radius > 0.0f)
+                stats.maxError[j] = std::max(stats.maxError[j], lod.error / task.radius);
+        }
+    }
+
+    stats.meshNum += (uint32_t)tasks.size();
+    stats.time += timer.GetTimeStamp() - begin;
+}
+
+uint32_t utils::SelectMeshLod(const Scene& scene, const Mesh& mesh, const vec3& position, const CameraState& camera, float viewportHeight, float maxPixelError) {
+    float d[3] = {position.x - camera.globalPosition.x, position.y - camera.globalPosition.y, position.z - camera.globalPosition.z};
+    float distance = std::max(sqrtf(Dot(d, d)), 1e-4f);
+
+    // Object space error => pixels ("mViewToClip[1][1]" - 1 / tan(fovY / 2))
+    float pixelsPerUnit = camera.mViewToClip[1][1] * 0.5f * viewportHeight / distance;
+
+    for (uint32_t i = mesh.lodNum; i > 1; i--) {
+        const MeshLod& lod = scene.meshLods[mesh.lodOffset + i - 1];
+        if (lod.error * pixelsPerUnit <= maxPixelError)
+            return i - 1;
+    }
+
+    return 0;
+}
+
+void utils::GetMeshLodDistancesSq(const MeshLod* lods, uint32_t lodNum, float viewToClip11, float viewportHeight, float maxPixelError, float* distancesSq) {
+    // "SelectMeshLod" inverted: "error * pixelsPerUnit <= maxPixelError" holds from this distance on
+    float scale = maxPixelError > 0.0f ? viewToClip11 * 0.5f * viewportHeight / maxPixelError : 0.0f;
+
+    for (uint32_t i = 0; i < lodNum; i++) {
+        float distance = lods[i].error * scale;
+        distancesSq[i] = (i && scale == 0.0f) ? FLT_MAX : distance * distance;
+    }
+}
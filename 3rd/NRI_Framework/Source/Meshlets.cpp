@@ -0,0 +1,356 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr uint32_t MESHLET_CHUNK_PRIMITIVE_NUM = 16 * 1024; // large meshes are split for parallel building
+constexpr uint8_t MESHLET_NO_LOCAL_INDEX = 0xFF;
+
+static inline float Dot(const float* a, const float* b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void ComputeMeshletBounds(const utils::UnpackedVertex* vertices, const uint32_t* meshletVertices, uint32_t vertexNum, const uint32_t* meshletPrimitives,
+    uint32_t primitiveNum, utils::MeshletBounds& bounds) {
+    // Sphere: AABB center, max distance
+    float aabbMin[3] = {INFINITY, INFINITY, INFINITY};
+    float aabbMax[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (uint32_t i = 0; i < vertexNum; i++) {
+        const float* pos = vertices[meshletVertices[i]].pos;
+        for (uint32_t j = 0; j < 3; j++) {
+            aabbMin[j] = std::min(aabbMin[j], pos[j]);
+            aabbMax[j] = std::max(aabbMax[j], pos[j]);
+        }
+    }
+
+    float radiusSq = 0.0f;
+    for (uint32_t j = 0; j < 3; j++)
+        bounds.center[j] = (aabbMin[j] + aabbMax[j]) * 0.5f;
+
+    for (uint32_t i = 0; i < vertexNum; i++) {
+        const float* pos = vertices[meshletVertices[i]].pos;
+        float d[3] = {pos[0] - bounds.center[0], pos[1] - bounds.center[1], pos[2] - bounds.center[2]};
+        radiusSq = std::max(radiusSq, Dot(d, d));
+    }
+    bounds.radius = sqrtf(radiusSq);
+
+    // Cone: face normals are oriented by vertex normals, so the result doesn't depend on the winding convention
+    float normals[utils::MESHLET_MAX_PRIMITIVE_NUM][3];
+    uint32_t normalNum = 0;
+    float axis[3] = {};
+
+    for (uint32_t i = 0; i < primitiveNum; i++) {
+        uint32_t primitive = meshletPrimitives[i];
+        const utils::UnpackedVertex& v0 = vertices[meshletVertices[primitive & 0xFF]];
+        const utils::UnpackedVertex& v1 = vertices[meshletVertices[(primitive >> 8) & 0xFF]];
+        const utils::UnpackedVertex& v2 = vertices[meshletVertices[(primitive >> 16) & 0xFF]];
+
+        float e1[3] = {v1.pos[0] - v0.pos[0], v1.pos[1] - v0.pos[1], v1.pos[2] - v0.pos[2]};
+        float e2[3] = {v2.pos[0] - v0.pos[0], v2.pos[1] - v0.pos[1], v2.pos[2] - v0.pos[2]};
+        float* n = normals[normalNum];
+        n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+        float length = sqrtf(Dot(n, n));
+        if (length == 0.0f)
+            continue;
+
+        float vertexNormal[3] = {v0.N[0] + v1.N[0] + v2.N[0], v0.N[1] + v1.N[1] + v2.N[1], v0.N[2] + v1.N[2] + v2.N[2]};
+        float invLength = Dot(n, vertexNormal) < 0.0f ? -1.0f / length : 1.0f / length;
+
+        for (uint32_t j = 0; j < 3; j++) {
+            n[j] *= invLength;
+            axis[j] += n[j];
+        }
+
+        normalNum++;
+    }
+
+    float axisLength = sqrtf(Dot(axis, axis));
+    float invAxisLength = axisLength > 0.0f ? 1.0f / axisLength : 0.0f;
+    for (uint32_t j = 0; j < 3; j++)
+        bounds.coneAxis[j] = axis[j] * invAxisLength;
+
+    float minDot = normalNum ? 1.0f : -1.0f;
+    for (uint32_t i = 0; i < normalNum; i++)
+        minDot = std::min(minDot, Dot(bounds.coneAxis, normals[i]));
+
+    // Wide cones (> ~84 degrees) never pass the test, no culling
+    bounds.coneCutoff = minDot <= 0.1f ? 1.0f : sqrtf(1.0f - minDot * minDot);
+}
+
+void utils::BuildMeshlets(const UnpackedVertex* vertices, const Index* indices, uint32_t indexNum, std::vector<Meshlet>& meshlets, std::vector<MeshletBounds>& meshletBounds,
+    std::vector<uint32_t>& meshletVertices, std::vector<uint32_t>& meshletPrimitives) {
+    uint32_t primitiveNum = indexNum / 3;
+    if (!primitiveNum)
+        return;
+
+    uint32_t vertexNum = *std::max_element(indices, indices + primitiveNum * 3) + 1;
+
+    // Vertex => triangles adjacency, the first "remainingPrimitiveNums[v]" entries are not emitted yet
+    std::vector<uint32_t> remainingPrimitiveNums(vertexNum, 0);
+    for (uint32_t i = 0; i < primitiveNum * 3; i++)
+        remainingPrimitiveNums[indices[i]]++;
+
+    std::vector<uint32_t> adjacencyOffsets(vertexNum + 1, 0);
+    for (uint32_t i = 0; i < vertexNum; i++)
+        adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingPrimitiveNums[i];
+
+    std::vector<uint32_t> adjacency(primitiveNum * 3);
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (uint32_t i = 0; i < primitiveNum * 3; i++)
+            adjacency[fill[indices[i]]++] = i / 3;
+    }
+
+    std::vector<float> centroids(primitiveNum * 3);
+    for (uint32_t i = 0; i < primitiveNum; i++) {
+        for (uint32_t j = 0; j < 3; j++)
+            centroids[i * 3 + j] = (vertices[indices[i * 3]].pos[j] + vertices[indices[i * 3 + 1]].pos[j] + vertices[indices[i * 3 + 2]].pos[j]) / 3.0f;
+    }
+
+    std::vector<uint8_t> localIndices(vertexNum, MESHLET_NO_LOCAL_INDEX);
+    std::vector<uint8_t> isEmitted(primitiveNum, 0);
+    uint32_t cursor = 0;
+
+    Meshlet meshlet = {};
+    meshlet.vertexOffset = (uint32_t)meshletVertices.size();
+    meshlet.primitiveOffset = (uint32_t)meshletPrimitives.size();
+    float centroidSum[3] = {};
+
+    auto Flush = [&]() {
+        MeshletBounds& bounds = meshletBounds.emplace_back();
+        ComputeMeshletBounds(vertices, meshletVertices.data() + meshlet.vertexOffset, meshlet.vertexNum, meshletPrimitives.data() + meshlet.primitiveOffset, meshlet.primitiveNum, bounds);
+
+        for (uint32_t i = 0; i < meshlet.vertexNum; i++)
+            localIndices[meshletVertices[meshlet.vertexOffset + i]] = MESHLET_NO_LOCAL_INDEX;
+
+        meshlets.push_back(meshlet);
+
+        meshlet = {};
+        meshlet.vertexOffset = (uint32_t)meshletVertices.size();
+        meshlet.primitiveOffset = (uint32_t)meshletPrimitives.size();
+        centroidSum[0] = centroidSum[1] = centroidSum[2] = 0.0f;
+    };
+
+    for (uint32_t n = 0; n < primitiveNum; n++) {
+        // The best neighbor: the fewest new vertices, then the closest to the meshlet centroid
+        uint32_t bestPrimitive = InvalidIndex;
+        uint32_t bestNewVertexNum = 4;
+        float bestDistanceSq = INFINITY;
+
+        if (meshlet.primitiveNum) {
+            float invNum = 1.0f / float(meshlet.primitiveNum);
+            float centroid[3] = {centroidSum[0] * invNum, centroidSum[1] * invNum, centroidSum[2] * invNum};
+
+            for (uint32_t i = 0; i < meshlet.vertexNum; i++) {
+                uint32_t vertex = meshletVertices[meshlet.vertexOffset + i];
+                const uint32_t* candidates = &adjacency[adjacencyOffsets[vertex]];
+
+                for (uint32_t j = 0; j < remainingPrimitiveNums[vertex]; j++) {
+                    uint32_t primitive = candidates[j];
+                    const Index* tri = indices + primitive * 3;
+
+                    uint32_t newVertexNum = (localIndices[tri[0]] == MESHLET_NO_LOCAL_INDEX) + (localIndices[tri[1]] == MESHLET_NO_LOCAL_INDEX) + (localIndices[tri[2]] == MESHLET_NO_LOCAL_INDEX);
+                    if (meshlet.vertexNum + newVertexNum > MESHLET_MAX_VERTEX_NUM || newVertexNum > bestNewVertexNum)
+                        continue;
+
+                    const float* c = &centroids[primitive * 3];
+                    float d[3] = {c[0] - centroid[0], c[1] - centroid[1], c[2] - centroid[2]};
+                    float distanceSq = Dot(d, d);
+
+                    if (newVertexNum < bestNewVertexNum || distanceSq < bestDistanceSq) {
+                        bestPrimitive = primitive;
+                        bestNewVertexNum = newVertexNum;
+                        bestDistanceSq = distanceSq;
+                    }
+                }
+            }
+
+            if (bestPrimitive == InvalidIndex)
+                Flush();
+        }
+
+        // A new meshlet starts from the next triangle in the input order (coherent after "OptimizeVertexCache")
+        if (bestPrimitive == InvalidIndex) {
+            while (isEmitted[cursor])
+                cursor++;
+
+            bestPrimitive = cursor;
+        }
+
+        const Index* tri = indices + bestPrimitive * 3;
+        uint32_t packed = 0;
+        for (uint32_t j = 0; j < 3; j++) {
+            uint32_t vertex = tri[j];
+            if (localIndices[vertex] == MESHLET_NO_LOCAL_INDEX) {
+                localIndices[vertex] = (uint8_t)meshlet.vertexNum++;
+                meshletVertices.push_back(vertex);
+            }
+
+            packed |= uint32_t(localIndices[vertex]) << (j * 8);
+
+            uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+            uint32_t* end = begin + remainingPrimitiveNums[vertex];
+            *std::find(begin, end, bestPrimitive) = *(end - 1);
+            remainingPrimitiveNums[vertex]--;
+        }
+
+        meshletPrimitives.push_back(packed);
+        meshlet.primitiveNum++;
+        isEmitted[bestPrimitive] = 1;
+
+        for (uint32_t j = 0; j < 3; j++)
+            centroidSum[j] += centroids[bestPrimitive * 3 + j];
+
+        if (meshlet.primitiveNum == MESHLET_MAX_PRIMITIVE_NUM)
+            Flush();
+    }
+
+    if (meshlet.primitiveNum)
+        Flush();
+}
+
+struct MeshletChunk {
+    std::vector<utils::Meshlet> meshlets;
+    std::vector<utils::MeshletBounds> meshletBounds;
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint32_t> meshletPrimitives;
+    uint32_t meshIndex;
+    uint32_t indexOffset;
+    uint32_t indexNum;
+};
+
+void utils::BuildSceneMeshlets(Scene& scene, uint32_t threadNum) {
+    std::vector<MeshletChunk> chunks;
+    for (uint32_t i = 0; i < (uint32_t)scene.meshes.size(); i++) {
+        const Mesh& mesh = scene.meshes[i];
+
+        for (uint32_t offset = 0; offset < mesh.indexNum; offset += MESHLET_CHUNK_PRIMITIVE_NUM * 3) {
+            MeshletChunk& chunk = chunks.emplace_back();
+            chunk.meshIndex = i;
+            chunk.indexOffset = mesh.indexOffset + offset;
+            chunk.indexNum = std::min(mesh.indexNum - offset, MESHLET_CHUNK_PRIMITIVE_NUM * 3);
+        }
+    }
+
+    // Chunks are large (a chunk takes milliseconds), no need for a cutoff
+    JobSystem::GetShared().ParallelFor((uint32_t)chunks.size(), threadNum, [&](uint32_t i) {
+        MeshletChunk& chunk = chunks[i];
+        const Mesh& mesh = scene.meshes[chunk.meshIndex];
+
+        BuildMeshlets(scene.unpackedVertices.data() + mesh.vertexOffset, scene.indices.data() + chunk.indexOffset, chunk.indexNum, chunk.meshlets, chunk.meshletBounds,
+            chunk.meshletVertices, chunk.meshletPrimitives);
+    });
+
+    // Chunks are ordered by mesh
+    scene.meshlets.clear();
+    scene.meshletBounds.clear();
+    scene.meshletVertices.clear();
+    scene.meshletPrimitives.clear();
+
+    for (Mesh& mesh : scene.meshes) {
+        mesh.meshletOffset = 0;
+        mesh.meshletNum = 0;
+    }
+
+    for (const MeshletChunk& chunk : chunks) {
+        Mesh& mesh = scene.meshes[chunk.meshIndex];
+        if (!mesh.meshletNum)
+            mesh.meshletOffset = (uint32_t)scene.meshlets.size();
+        mesh.meshletNum += (uint32_t)chunk.meshlets.size();
+
+        uint32_t vertexBase = (uint32_t)scene.meshletVertices.size();
+        uint32_t primitiveBase = (uint32_t)scene.meshletPrimitives.size();
+        for (Meshlet meshlet : chunk.meshlets) {
+            meshlet.vertexOffset += vertexBase;
+            meshlet.primitiveOffset += primitiveBase;
+            scene.meshlets.push_back(meshlet);
+        }
+
+        scene.meshletBounds.insert(scene.meshletBounds.end(), chunk.meshletBounds.begin(), chunk.meshletBounds.end());
+        scene.meshletVertices.insert(scene.meshletVertices.end(), chunk.meshletVertices.begin(), chunk.meshletVertices.end());
+        scene.meshletPrimitives.insert(scene.meshletPrimitives.end(), chunk.meshletPrimitives.begin(), chunk.meshletPrimitives.end());
+    }
+}
+
+void utils::ExtractFrustumPlanes(const mat4& clipFromWorld, float planes[6][4]) {
+    // Gribb-Hartmann (rows of a column-major matrix), "ZO" depth range
+    for (uint32_t j = 0; j < 4; j++) {
+        const vec4& column = clipFromWorld[j];
+
+        planes[0][j] = column[3] + column[0]; // left
+        planes[1][j] = column[3] - column[0]; // right
+        planes[2][j] = column[3] + column[1]; // bottom
+        planes[3][j] = column[3] - column[1]; // top
+        planes[4][j] = column[2]; // near
+        planes[5][j] = column[3] - column[2]; // far
+    }
+
+    for (uint32_t i = 0; i < 6; i++) {
+        float invLength = 1.0f / sqrtf(Dot(planes[i], planes[i]));
+        for (uint32_t j = 0; j < 4; j++)
+            planes[i][j] *= invLength;
+    }
+}
+
+uint32_t utils::CullMeshlets(const MeshletBounds* meshletBounds, uint32_t meshletNum, const float instancePosition[3], const float planes[6][4], const float cameraPosition[3],
+    MeshletCullingStats& stats, uint32_t* visibleMeshlets) {
+    uint32_t visibleNum = 0;
+
+    for (uint32_t i = 0; i < meshletNum; i++) {
+        const MeshletBounds& bounds = meshletBounds[i];
+        float center[3] = {bounds.center[0] + instancePosition[0], bounds.center[1] + instancePosition[1], bounds.center[2] + instancePosition[2]};
+
+        bool isOutside = false;
+        for (uint32_t j = 0; j < 6 && !isOutside; j++)
+            isOutside = Dot(planes[j], center) + planes[j][3] < -bounds.radius;
+
+        if (isOutside) {
+            stats.frustumCulledNum++;
+            continue;
+        }
+
+        if (bounds.coneCutoff < 1.0f) {
+            float d[3] = {center[0] - cameraPosition[0], center[1] - cameraPosition[1], center[2] - cameraPosition[2]};
+            if (Dot(d, bounds.coneAxis) >= bounds.coneCutoff * sqrtf(Dot(d, d)) + bounds.radius) {
+                stats.coneCulledNum++;
+                continue;
+            }
+        }
+
+        if (visibleMeshlets)
+            visibleMeshlets[visibleNum] = i;
+        visibleNum++;
+    }
+
+    stats.testedNum += meshletNum;
+
+    return visibleNum;
+}
+
+utils::MeshletCullingStats utils::SimulateMeshletCulling(const Scene& scene, uint32_t meshIndex, const vec4* instancePositions, uint32_t instanceNum,
+    const mat4* clipFromWorld, const vec3* cameraPositions, uint32_t frameNum) {
+    const Mesh& mesh = scene.meshes[meshIndex];
+    const MeshletBounds* meshletBounds = scene.meshletBounds.data() + mesh.meshletOffset;
+
+    MeshletCullingStats stats = {};
+    Timer timer;
+    double begin = timer.GetTimeStamp();
+
+    for (uint32_t i = 0; i < frameNum; i++) {
+        float planes[6][4];
+        ExtractFrustumPlanes(clipFromWorld[i], planes);
+
+        float cameraPosition[3] = {cameraPositions[i].x, cameraPositions[i].y, cameraPositions[i].z};
+        for (uint32_t j = 0; j < instanceNum; j++) {
+            float instancePosition[3] = {instancePositions[j].x, instancePositions[j].y, instancePositions[j].z};
+            CullMeshlets(meshletBounds, mesh.meshletNum, instancePosition, planes, cameraPosition, stats);
+        }
+    }
+
+    stats.time = timer.GetTimeStamp() - begin;
+
+    return stats;
+}
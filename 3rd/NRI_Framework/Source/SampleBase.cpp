@@ -28,9 +28,6 @@
 template <typename T>
 constexpr void MaybeUnused([[maybe_unused]] const T &arg) {}
 
-void CreateDebugAllocator(nri::AllocationCallbacks &allocationCallbacks);
-void DestroyDebugAllocator(nri::AllocationCallbacks &allocationCallbacks);
-
 //==================================================================================================================================================
 // MEMORY
 //==================================================================================================================================================
@@ -354,13 +351,31 @@ SampleBase::SampleBase() {
 SampleBase::~SampleBase() {
   glfwTerminate();
 
-#if _DEBUG
+  // Debug builds or "--allocationReport"
   if (m_AllocationCallbacks.userArg != nullptr)
     DestroyDebugAllocator(m_AllocationCallbacks);
-#endif
+}
+
+double SampleBase::GetTime() const {
+  if (IsFixedTimeStep())
+    return m_FixedFrameIndex * utils::BENCHMARK_TIME_STEP;
+
+  return glfwGetTime();
 }
 
 void SampleBase::GetCameraDescFromInputDevices(CameraDesc &cameraDesc) {
+  if (IsFixedTimeStep()) {
+    // Scripted path (a slow turn and a dolly back and forth), depends only on
+    // the frame index
+    float time = (float)GetTime();
+
+    cameraDesc.timeScale = 0.025f * float(utils::BENCHMARK_TIME_STEP * 1000.0);
+    cameraDesc.dYaw = 20.0f;
+    cameraDesc.dLocal.z = m_Camera.state.motionScale * sinf(time * 0.5f);
+
+    return;
+  }
+
   cameraDesc.timeScale = 0.025f * m_Timer.GetSmoothedFrameTime();
 
   if (!IsButtonPressed(Button::Right)) {
@@ -405,22 +420,18 @@ void SampleBase::GetCameraDescFromInputDevices(CameraDesc &cameraDesc) {
     cameraDesc.dLocal.y -= motionScale;
 }
 
-struct ImDrawVertOpt {
-  float pos[2];
-  uint32_t uv;
-  uint32_t col;
-};
-
 bool SampleBase::InitUI(const nri::CoreInterface &NRI,
                         const nri::HelperInterface &helperInterface,
                         nri::Device &device, nri::Format renderTargetFormat) {
+  ALLOCATION_SCOPE(UI);
+
   // ImGui setup
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
   ImGui::StyleColorsDark();
 
   float contentScale = 1.0f;
-  if (m_DpiMode != 0) {
+  if (m_DpiMode != 0 && m_Window) {
     GLFWmonitor *monitor = glfwGetPrimaryMonitor();
 
     float unused;
@@ -441,22 +452,24 @@ bool SampleBase::InitUI(const nri::CoreInterface &NRI,
                                         // requests (optional, rarely used)
   io.IniFilename = nullptr;
 
-  m_MouseCursors[ImGuiMouseCursor_Arrow] =
-      glfwCreateStandardCursor(GLFW_ARROW_CURSOR);
-  m_MouseCursors[ImGuiMouseCursor_TextInput] =
-      glfwCreateStandardCursor(GLFW_IBEAM_CURSOR);
-  m_MouseCursors[ImGuiMouseCursor_ResizeAll] = glfwCreateStandardCursor(
-      GLFW_ARROW_CURSOR); // FIXME: GLFW doesn't have this.
-  m_MouseCursors[ImGuiMouseCursor_ResizeNS] =
-      glfwCreateStandardCursor(GLFW_VRESIZE_CURSOR);
-  m_MouseCursors[ImGuiMouseCursor_ResizeEW] =
-      glfwCreateStandardCursor(GLFW_HRESIZE_CURSOR);
-  m_MouseCursors[ImGuiMouseCursor_ResizeNESW] = glfwCreateStandardCursor(
-      GLFW_ARROW_CURSOR); // FIXME: GLFW doesn't have this.
-  m_MouseCursors[ImGuiMouseCursor_ResizeNWSE] = glfwCreateStandardCursor(
-      GLFW_ARROW_CURSOR); // FIXME: GLFW doesn't have this.
-  m_MouseCursors[ImGuiMouseCursor_Hand] =
-      glfwCreateStandardCursor(GLFW_HAND_CURSOR);
+  if (m_Window) {
+    m_MouseCursors[ImGuiMouseCursor_Arrow] =
+        glfwCreateStandardCursor(GLFW_ARROW_CURSOR);
+    m_MouseCursors[ImGuiMouseCursor_TextInput] =
+        glfwCreateStandardCursor(GLFW_IBEAM_CURSOR);
+    m_MouseCursors[ImGuiMouseCursor_ResizeAll] = glfwCreateStandardCursor(
+        GLFW_ARROW_CURSOR); // FIXME: GLFW doesn't have this.
+    m_MouseCursors[ImGuiMouseCursor_ResizeNS] =
+        glfwCreateStandardCursor(GLFW_VRESIZE_CURSOR);
+    m_MouseCursors[ImGuiMouseCursor_ResizeEW] =
+        glfwCreateStandardCursor(GLFW_HRESIZE_CURSOR);
+    m_MouseCursors[ImGuiMouseCursor_ResizeNESW] = glfwCreateStandardCursor(
+        GLFW_ARROW_CURSOR); // FIXME: GLFW doesn't have this.
+    m_MouseCursors[ImGuiMouseCursor_ResizeNWSE] = glfwCreateStandardCursor(
+        GLFW_ARROW_CURSOR); // FIXME: GLFW doesn't have this.
+    m_MouseCursors[ImGuiMouseCursor_Hand] =
+        glfwCreateStandardCursor(GLFW_HAND_CURSOR);
+  }
 
   const nri::DeviceDesc &deviceDesc = NRI.GetDeviceDesc(device);
 
@@ -495,25 +508,25 @@ bool SampleBase::InitUI(const nri::CoreInterface &NRI,
 
     nri::VertexStreamDesc vertexStreamDesc = {};
     vertexStreamDesc.bindingSlot = 0;
-    vertexStreamDesc.stride = sizeof(ImDrawVertOpt);
+    vertexStreamDesc.stride = sizeof(utils::UiVertex);
 
     nri::VertexAttributeDesc vertexAttributeDesc[3] = {};
     {
       vertexAttributeDesc[0].format = nri::Format::RG32_SFLOAT;
       vertexAttributeDesc[0].streamIndex = 0;
-      vertexAttributeDesc[0].offset = helper::GetOffsetOf(&ImDrawVertOpt::pos);
+      vertexAttributeDesc[0].offset = helper::GetOffsetOf(&utils::UiVertex::pos);
       vertexAttributeDesc[0].d3d = {"POSITION", 0};
       vertexAttributeDesc[0].vk = {0};
 
       vertexAttributeDesc[1].format = nri::Format::RG16_UNORM;
       vertexAttributeDesc[1].streamIndex = 0;
-      vertexAttributeDesc[1].offset = helper::GetOffsetOf(&ImDrawVertOpt::uv);
+      vertexAttributeDesc[1].offset = helper::GetOffsetOf(&utils::UiVertex::uv);
       vertexAttributeDesc[1].d3d = {"TEXCOORD", 0};
       vertexAttributeDesc[1].vk = {1};
 
       vertexAttributeDesc[2].format = nri::Format::RGBA8_UNORM;
       vertexAttributeDesc[2].streamIndex = 0;
-      vertexAttributeDesc[2].offset = helper::GetOffsetOf(&ImDrawVertOpt::col);
+      vertexAttributeDesc[2].offset = helper::GetOffsetOf(&utils::UiVertex::col);
       vertexAttributeDesc[2].d3d = {"COLOR", 0};
       vertexAttributeDesc[2].vk = {2};
     }
@@ -665,7 +678,8 @@ bool SampleBase::InitUI(const nri::CoreInterface &NRI,
                                descriptorRangeUpdateDesc);
   }
 
-  m_TimePrev = glfwGetTime();
+  m_TimePrev = GetTime();
+  m_HasUserInterface = true;
 
   return true;
 }
@@ -692,8 +706,9 @@ void SampleBase::BeginUI() {
   ImGuiIO &io = ImGui::GetIO();
 
   // Setup time step
-  double timeCur = glfwGetTime();
-  io.DeltaTime = (float)(timeCur - m_TimePrev);
+  double timeCur = GetTime();
+  io.DeltaTime = IsFixedTimeStep() ? (float)utils::BENCHMARK_TIME_STEP
+                                   : (float)(timeCur - m_TimePrev);
   io.DisplaySize =
       ImVec2((float)m_WindowResolution.first, (float)m_WindowResolution.second);
   m_TimePrev = timeCur;
@@ -706,39 +721,43 @@ void SampleBase::BeginUI() {
   io.AddKeyEvent(ImGuiMod_Alt,
                  IsKeyPressed(Key::LAlt) || IsKeyPressed(Key::RAlt));
 
-  // Update buttons
-  for (int32_t i = 0; i < IM_ARRAYSIZE(io.MouseDown); i++) {
-    // If a mouse press event came, always pass it as "mouse held this frame",
-    // so we don't miss click-release events that are shorter than 1 frame.
-    io.MouseDown[i] =
-        m_ButtonJustPressed[i] || glfwGetMouseButton(m_Window, i) != 0;
-    m_ButtonJustPressed[i] = false;
-  }
+  // Mouse (no mouse without a window)
+  if (m_Window) {
+    // Buttons
+    for (int32_t i = 0; i < IM_ARRAYSIZE(io.MouseDown); i++) {
+      // If a mouse press event came, always pass it as "mouse held this frame",
+      // so we don't miss click-release events that are shorter than 1 frame.
+      io.MouseDown[i] =
+          m_ButtonJustPressed[i] || glfwGetMouseButton(m_Window, i) != 0;
+      m_ButtonJustPressed[i] = false;
+    }
 
-  // Update mouse position
-  if (glfwGetWindowAttrib(m_Window, GLFW_FOCUSED) != 0) {
-    if (io.WantSetMousePos)
-      glfwSetCursorPos(m_Window, (double)io.MousePos.x, (double)io.MousePos.y);
-    else {
-      double mouse_x, mouse_y;
-      glfwGetCursorPos(m_Window, &mouse_x, &mouse_y);
-      io.MousePos = ImVec2((float)mouse_x, (float)mouse_y);
+    // Position
+    if (glfwGetWindowAttrib(m_Window, GLFW_FOCUSED) != 0) {
+      if (io.WantSetMousePos)
+        glfwSetCursorPos(m_Window, (double)io.MousePos.x,
+                         (double)io.MousePos.y);
+      else {
+        double mouse_x, mouse_y;
+        glfwGetCursorPos(m_Window, &mouse_x, &mouse_y);
+        io.MousePos = ImVec2((float)mouse_x, (float)mouse_y);
+      }
     }
-  }
 
-  // Update mouse cursor
-  if ((io.ConfigFlags & ImGuiConfigFlags_NoMouseCursorChange) == 0 &&
-      glfwGetInputMode(m_Window, GLFW_CURSOR) == GLFW_CURSOR_NORMAL) {
-    ImGuiMouseCursor cursor = ImGui::GetMouseCursor();
-    if (cursor == ImGuiMouseCursor_None || io.MouseDrawCursor) {
-      // Hide OS mouse cursor if imgui is drawing it or if it wants no cursor
-      CursorMode(GLFW_CURSOR_HIDDEN);
-    } else {
-      // Show OS mouse cursor
-      glfwSetCursor(m_Window, m_MouseCursors[cursor]
-                                  ? m_MouseCursors[cursor]
-                                  : m_MouseCursors[ImGuiMouseCursor_Arrow]);
-      CursorMode(GLFW_CURSOR_NORMAL);
+    // Cursor
+    if ((io.ConfigFlags & ImGuiConfigFlags_NoMouseCursorChange) == 0 &&
+        glfwGetInputMode(m_Window, GLFW_CURSOR) == GLFW_CURSOR_NORMAL) {
+      ImGuiMouseCursor cursor = ImGui::GetMouseCursor();
+      if (cursor == ImGuiMouseCursor_None || io.MouseDrawCursor) {
+        // Hide OS mouse cursor if imgui is drawing it or if it wants no cursor
+        CursorMode(GLFW_CURSOR_HIDDEN);
+      } else {
+        // Show OS mouse cursor
+        glfwSetCursor(m_Window, m_MouseCursors[cursor]
+                                    ? m_MouseCursors[cursor]
+                                    : m_MouseCursors[ImGuiMouseCursor_Arrow]);
+        CursorMode(GLFW_CURSOR_NORMAL);
+      }
     }
   }
 
@@ -753,75 +772,67 @@ void SampleBase::EndUI(const nri::StreamerInterface &streamerInterface,
   if (!HasUserInterface())
     return;
 
+  PROFILE_SCOPE("EndUI");
+  ALLOCATION_SCOPE(UI);
+
+  double begin = m_Timer.GetTimeStamp();
+
   ImGui::EndFrame();
   ImGui::Render();
 
   const ImDrawData &drawData = *ImGui::GetDrawData();
 
   // Prepare
-  uint32_t vertexDataSize = drawData.TotalVtxCount * sizeof(ImDrawVertOpt);
-  vertexDataSize = helper::Align(vertexDataSize, 16);
-  uint32_t indexDataSize = drawData.TotalIdxCount * sizeof(ImDrawIdx);
-  indexDataSize = helper::Align(indexDataSize, 16);
-  uint32_t totalDataSize = vertexDataSize + indexDataSize;
-  if (!totalDataSize)
+  uint32_t indexDataSize = 0;
+  uint32_t vertexDataSize = 0;
+  utils::GetUiGeometrySize(drawData, indexDataSize, vertexDataSize);
+  uint32_t totalDataSize = indexDataSize + vertexDataSize;
+  if (!totalDataSize) {
+    m_FrameBenchmark.Add(utils::FrameStage::UI,
+                         m_Timer.GetTimeStamp() - begin);
     return;
+  }
 
   if (m_UiData.size() < totalDataSize)
     m_UiData.resize(totalDataSize);
 
   // Repack geometry
-  uint8_t *indexData = m_UiData.data();
-  ImDrawVertOpt *vertexData = (ImDrawVertOpt *)(indexData + indexDataSize);
-
-  auto float2_to_unorm_16_16 = [](const vec2 &v) -> uint32_t {
-    // Clamp input values to [0.0f, 1.0f] range
-    float x = std::clamp(v.x, 0.0f, 1.0f);
-    float y = std::clamp(v.y, 0.0f, 1.0f);
+  utils::RepackUiGeometry(drawData, m_UiData.data(), m_UiRepackStats);
 
-    // Convert to 16-bit unsigned normalized integers
-    uint16_t ux = static_cast<uint16_t>(x * 65535.0f + 0.5f);
-    uint16_t uy = static_cast<uint16_t>(y * 65535.0f + 0.5f);
-
-    // Pack the two 16-bit values into a single 32-bit value
-    return (static_cast<uint32_t>(uy) << 16) | static_cast<uint32_t>(ux);
-  };
-
-  for (int32_t n = 0; n < drawData.CmdListsCount; n++) {
-    const ImDrawList &drawList = *drawData.CmdLists[n];
-
-    for (int32_t i = 0; i < drawList.VtxBuffer.Size; i++) {
-      const ImDrawVert *v = drawList.VtxBuffer.Data + i;
-
-      ImDrawVertOpt opt;
-      opt.pos[0] = v->pos.x;
-      opt.pos[1] = v->pos.y;
-      //   opt.uv = vec2(v->uv.x, v->uv.y);
-      //   ImVec4 col = ImGui::ColorConvertU32ToFloat4(v->col);
-      //   opt.col = vec4(col.x, col.y, col.z, col.w);
-
-      opt.uv = float2_to_unorm_16_16(vec2(v->uv.x, v->uv.y));
-      //   opt.col = v->col;
-
-      //   opt.uv = vec2(v->uv.x, v->uv.y);
-      opt.col = v->col;
-
-      memcpy(vertexData++, &opt, sizeof(opt));
-    }
-
-    size_t size = drawList.IdxBuffer.Size * sizeof(ImDrawIdx);
-    memcpy(indexData, drawList.IdxBuffer.Data, size);
-    indexData += size;
-  }
-
-  // Add update request
+  // Add update request ("m_UiData" only grows, upload just this frame's bytes)
   nri::BufferUpdateRequestDesc bufferUpdateRequestDesc = {};
   bufferUpdateRequestDesc.data = m_UiData.data();
-  bufferUpdateRequestDesc.dataSize = m_UiData.size();
+  bufferUpdateRequestDesc.dataSize = totalDataSize;
 
   m_IbOffset = streamerInterface.AddStreamerBufferUpdateRequest(
       streamer, bufferUpdateRequestDesc);
   m_VbOffset = m_IbOffset + indexDataSize;
+
+  m_FrameBenchmark.Add(utils::FrameStage::UI, m_Timer.GetTimeStamp() - begin);
+}
+
+void SampleBase::ShowFrameStatsUI(const nri::StatsInterface &statsInterface,
+                                  const nri::Device &device) {
+  nri::FrameStats frameStats = {};
+  statsInterface.GetFrameStats(device, frameStats);
+
+  const nri::CommandBufferStats &totals = frameStats.commandBufferTotals;
+  ImGui::Text("Draws: %llu (%llu instances, %llu triangles)",
+              (unsigned long long)totals.drawNum,
+              (unsigned long long)totals.instanceNum,
+              (unsigned long long)totals.triangleNum);
+  ImGui::Text("Dispatches: %llu", (unsigned long long)totals.dispatchNum);
+  ImGui::Text("Barriers: %llu", (unsigned long long)totals.barrierNum);
+  ImGui::Text("Pipeline switches: %llu",
+              (unsigned long long)totals.pipelineNum);
+  ImGui::Text("Descriptor set binds: %llu",
+              (unsigned long long)totals.descriptorSetNum);
+  ImGui::Text("Root constants: %llu bytes",
+              (unsigned long long)totals.rootConstantSize);
+  ImGui::Text("Command buffers: %llu, submits: %llu",
+              (unsigned long long)frameStats.commandBufferNum,
+              (unsigned long long)frameStats.submitNum);
+  ImGui::Text("Streamer: %.1f Kb", frameStats.streamerSize / 1024.0);
 }
 
 void SampleBase::RenderUI(const nri::CoreInterface &NRI,
@@ -832,6 +843,9 @@ void SampleBase::RenderUI(const nri::CoreInterface &NRI,
   if (!HasUserInterface() || m_VbOffset == m_IbOffset)
     return;
 
+  PROFILE_SCOPE("RenderUI");
+  ALLOCATION_SCOPE(UI);
+
   float consts[4];
   consts[0] = 1.0f / ImGui::GetIO().DisplaySize.x;
   consts[1] = 1.0f / ImGui::GetIO().DisplaySize.y;
@@ -907,6 +921,57 @@ bool SampleBase::Create(int32_t argc, char **argv, const char *windowTitle) {
   ReadCmdLineDefault(cmdLine);
   ReadCmdLine(cmdLine);
 
+  // Profiling
+  utils::SetCpuProfilerThreadName("Main");
+  if (!m_CpuTraceFile.empty())
+    utils::EnableCpuProfiler(true);
+
+  if (!m_AllocationReportFile.empty()) {
+    if (m_AllocationCallbacks.userArg == nullptr)
+      CreateDebugAllocator(m_AllocationCallbacks);
+
+    utils::EnableAllocationProfiler(m_AllocationCallbacks);
+  }
+
+  // Window
+  m_Title = windowTitle;
+  m_GraphicsAPIName = m_IsHeadless ? "NONE" : cmdLine.get<std::string>("api");
+
+  if (m_IsHeadless) {
+    m_WindowResolution = m_OutputResolution;
+    printf("Running headless (%u, %u)\n", m_WindowResolution.first,
+           m_WindowResolution.second);
+  } else if (!CreateMainWindow(windowTitle))
+    return false;
+
+  // Main initialization
+  printf("Loading...\n");
+
+  nri::GraphicsAPI graphicsAPI = nri::GraphicsAPI::VK;
+  if (m_IsHeadless)
+    graphicsAPI = nri::GraphicsAPI::NONE;
+  else if (cmdLine.get<std::string>("api") == "D3D11")
+    graphicsAPI = nri::GraphicsAPI::D3D11;
+  else if (cmdLine.get<std::string>("api") == "D3D12")
+    graphicsAPI = nri::GraphicsAPI::D3D12;
+
+  bool result = Initialize(graphicsAPI);
+
+  // Set callbacks and show window
+  if (m_Window) {
+    glfwSetWindowUserPointer(m_Window, this);
+    glfwSetKeyCallback(m_Window, GLFW_KeyCallback);
+    glfwSetCharCallback(m_Window, GLFW_CharCallback);
+    glfwSetMouseButtonCallback(m_Window, GLFW_ButtonCallback);
+    glfwSetCursorPosCallback(m_Window, GLFW_CursorPosCallback);
+    glfwSetScrollCallback(m_Window, GLFW_ScrollCallback);
+    glfwShowWindow(m_Window);
+  }
+
+  return result;
+}
+
+bool SampleBase::CreateMainWindow(const char *windowTitle) {
   // Init GLFW
   glfwSetErrorCallback(GLFW_ErrorCallback);
 
@@ -960,7 +1025,7 @@ bool SampleBase::Create(int32_t argc, char **argv, const char *windowTitle) {
 
   char windowName[256];
   snprintf(windowName, sizeof(windowName), "%s [%s]", windowTitle,
-           cmdLine.get<std::string>("api").c_str());
+           m_GraphicsAPIName.c_str());
 
   m_Window =
       glfwCreateWindow(m_WindowResolution.first, m_WindowResolution.second,
@@ -983,70 +1048,121 @@ bool SampleBase::Create(int32_t argc, char **argv, const char *windowTitle) {
   m_NRIWindow.metal.caMetalLayer = GetMetalLayer(m_Window);
 #endif
 
-  // Main initialization
-  printf("Loading...\n");
-
-  nri::GraphicsAPI graphicsAPI = nri::GraphicsAPI::VK;
-  if (cmdLine.get<std::string>("api") == "D3D11")
-    graphicsAPI = nri::GraphicsAPI::D3D11;
-  else if (cmdLine.get<std::string>("api") == "D3D12")
-    graphicsAPI = nri::GraphicsAPI::D3D12;
-
-  bool result = Initialize(graphicsAPI);
-
-  // Set callbacks and show window
-  glfwSetWindowUserPointer(m_Window, this);
-  glfwSetKeyCallback(m_Window, GLFW_KeyCallback);
-  glfwSetCharCallback(m_Window, GLFW_CharCallback);
-  glfwSetMouseButtonCallback(m_Window, GLFW_ButtonCallback);
-  glfwSetCursorPosCallback(m_Window, GLFW_CursorPosCallback);
-  glfwSetScrollCallback(m_Window, GLFW_ScrollCallback);
-  glfwShowWindow(m_Window);
-
-  return result;
+  return true;
 }
 
 void SampleBase::RenderLoop() {
+  if (m_IsBenchmark)
+    m_FrameBenchmark.Begin(m_FrameNum);
+
   for (uint32_t i = 0; i < m_FrameNum; i++) {
+    double frameBegin = m_Timer.GetTimeStamp();
+
     LatencySleep(i);
 
     // Events
-    glfwPollEvents();
+    if (m_Window) {
+      glfwPollEvents();
+
+      // Benchmarking doesn't wait for focus
+      m_IsActive = glfwGetWindowAttrib(m_Window, GLFW_FOCUSED) != 0;
+      if (!m_IsActive && !m_IsBenchmark) {
+        i--;
+        continue;
+      }
 
-    m_IsActive = glfwGetWindowAttrib(m_Window, GLFW_FOCUSED) != 0;
-    if (!m_IsActive) {
-      i--;
-      continue;
+      if (glfwWindowShouldClose(m_Window))
+        break;
     }
 
-    if (glfwWindowShouldClose(m_Window) || this->AppShouldClose())
+    if (this->AppShouldClose())
       break;
 
-    PrepareFrame(i);
-    RenderFrame(i);
+    utils::MarkCpuProfilerFrame(i);
+    utils::MarkAllocationFrame(m_AllocationCallbacks);
+    m_FrameBenchmark.BeginFrame();
+
+    double prepareBegin = m_Timer.GetTimeStamp();
+    {
+      PROFILE_SCOPE("PrepareFrame");
+      PrepareFrame(i);
+    }
+
+    double renderBegin = m_Timer.GetTimeStamp();
+    {
+      PROFILE_SCOPE("RenderFrame");
+      RenderFrame(i);
+    }
 
-    double cursorPosx, cursorPosy;
-    glfwGetCursorPos(m_Window, &cursorPosx, &cursorPosy);
-    m_MousePosPrev = vec2(float(cursorPosx), float(cursorPosy));
+    double renderEnd = m_Timer.GetTimeStamp();
+    m_FrameBenchmark.Add(utils::FrameStage::PREPARE,
+                         renderBegin - prepareBegin);
+    m_FrameBenchmark.Add(utils::FrameStage::RENDER, renderEnd - renderBegin);
+
+    if (m_Window) {
+      double cursorPosx, cursorPosy;
+      glfwGetCursorPos(m_Window, &cursorPosx, &cursorPosy);
+      m_MousePosPrev = vec2(float(cursorPosx), float(cursorPosy));
+    }
     m_MouseWheel = 0.0f;
     m_MouseDelta = vec2(0.0f);
 
+    m_FrameBenchmark.Add(utils::FrameStage::FRAME,
+                         m_Timer.GetTimeStamp() - frameBegin);
+    m_FixedFrameIndex++;
+
     m_Timer.UpdateFrameTime();
   }
 
   printf("FPS:\n"
          "  Last frame : %.2f fps (%.3f ms)\n"
          "  Average    : %.2f fps (%.3f ms)\n"
-         "  Smoothed   : %.2f fps (%.3f ms)\n"
-         "Shutting down...\n",
+         "  Smoothed   : %.2f fps (%.3f ms)\n",
          1000.0f / m_Timer.GetFrameTime(), m_Timer.GetFrameTime(),
          1000.0f / m_Timer.GetSmoothedFrameTime(),
          m_Timer.GetSmoothedFrameTime(),
          1000.0f / m_Timer.GetVerySmoothedFrameTime(),
          m_Timer.GetVerySmoothedFrameTime());
+
+  FrameTimeStats frameTimeStats = m_Timer.GetFrameTimeStats();
+  printf("Frame time:\n"
+         "  p50 / p90 / p99 / p99.9 : %.3f / %.3f / %.3f / %.3f ms\n"
+         "  Min / max               : %.3f / %.3f ms\n"
+         "  Jitter                  : %.3f ms\n"
+         "  Stutters                : %llu of %llu frames\n"
+         "Shutting down...\n",
+         frameTimeStats.p50, frameTimeStats.p90, frameTimeStats.p99,
+         frameTimeStats.p999, frameTimeStats.min, frameTimeStats.max,
+         frameTimeStats.jitter,
+         (unsigned long long)frameTimeStats.stutterNum,
+         (unsigned long long)frameTimeStats.frameNum);
+
+  if (m_IsBenchmark) {
+    m_FrameBenchmark.Print(m_BenchmarkWarmupFrameNum);
+
+    utils::FrameBenchmarkDesc frameBenchmarkDesc = {};
+    frameBenchmarkDesc.name = m_Title.c_str();
+    frameBenchmarkDesc.graphicsAPI = m_GraphicsAPIName.c_str();
+    frameBenchmarkDesc.width = m_OutputResolution.first;
+    frameBenchmarkDesc.height = m_OutputResolution.second;
+    frameBenchmarkDesc.warmupFrameNum = m_BenchmarkWarmupFrameNum;
+    frameBenchmarkDesc.isHeadless = m_IsHeadless;
+
+    m_FrameBenchmark.WriteJson(m_BenchmarkFile.c_str(), frameBenchmarkDesc);
+  }
+
+  if (!m_CpuTraceFile.empty())
+    utils::WriteCpuProfilerTrace(m_CpuTraceFile.c_str());
+
+  if (!m_AllocationReportFile.empty())
+    utils::WriteAllocationReport(m_AllocationCallbacks,
+                                 m_AllocationReportFile.c_str());
 }
 
 void SampleBase::CursorMode(int32_t mode) {
+  if (!m_Window)
+    return;
+
   if (mode == GLFW_CURSOR_NORMAL) {
     glfwSetInputMode(m_Window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 #if defined(_WIN32)
@@ -1085,8 +1201,31 @@ void SampleBase::InitCmdLineDefault(cmdline::parser &cmdLine) {
   cmdLine.add<uint32_t>("vsyncInterval", 'v', "vsync interval", false,
                         m_VsyncInterval);
   cmdLine.add<uint32_t>("dpiMode", 0, "DPI mode", false, m_DpiMode);
+  cmdLine.add<float>("fpsLimit", 0, "frame limiter, 0 - off", false,
+                     m_FpsLimit);
   cmdLine.add("debugAPI", 0, "enable graphics API validation layer");
   cmdLine.add("debugNRI", 0, "enable NRI validation layer");
+  cmdLine.add<uint32_t>("debugNRISampleRate", 0,
+                        "light NRI validation: check parameters of 1 of N "
+                        "command buffers (implies debugNRI), 0 - full",
+                        false, m_DebugNRISampleRate);
+  cmdLine.add("headless", 0,
+              "no window, NONE graphics API, fixed time step");
+  cmdLine.add("benchmark", 0,
+              "fixed time step and camera path, per-frame CPU timings");
+  cmdLine.add<std::string>("benchmarkFile", 0, "benchmark JSON output", false,
+                           m_BenchmarkFile);
+  cmdLine.add<uint32_t>("benchmarkWarmup", 0,
+                        "frames excluded from benchmark statistics", false,
+                        m_BenchmarkWarmupFrameNum);
+  cmdLine.add<std::string>(
+      "cpuTrace", 0,
+      "enable the CPU profiler, write a Chrome trace to this file at exit",
+      false, m_CpuTraceFile);
+  cmdLine.add<std::string>("allocationReport", 0,
+                           "profile NRI allocations (subsystems, per frame, "
+                           "sampled call stacks), write a report at exit",
+                           false, m_AllocationReportFile);
 }
 
 void SampleBase::ReadCmdLineDefault(cmdline::parser &cmdLine) {
@@ -1096,8 +1235,21 @@ void SampleBase::ReadCmdLineDefault(cmdline::parser &cmdLine) {
   m_FrameNum = cmdLine.get<uint32_t>("frameNum");
   m_VsyncInterval = (uint8_t)cmdLine.get<uint32_t>("vsyncInterval");
   m_DebugAPI = cmdLine.exist("debugAPI");
-  m_DebugNRI = cmdLine.exist("debugNRI");
+  m_DebugNRISampleRate = cmdLine.get<uint32_t>("debugNRISampleRate");
+  m_DebugNRI = cmdLine.exist("debugNRI") || m_DebugNRISampleRate != 0;
   m_DpiMode = cmdLine.get<uint32_t>("dpiMode");
+  m_FpsLimit = cmdLine.get<float>("fpsLimit");
+  m_Timer.SetFrameLimit(m_FpsLimit);
+  m_IsHeadless = cmdLine.exist("headless");
+  m_IsBenchmark = cmdLine.exist("benchmark");
+  m_BenchmarkFile = cmdLine.get<std::string>("benchmarkFile");
+  m_BenchmarkWarmupFrameNum = cmdLine.get<uint32_t>("benchmarkWarmup");
+  m_CpuTraceFile = cmdLine.get<std::string>("cpuTrace");
+  m_AllocationReportFile = cmdLine.get<std::string>("allocationReport");
+
+  // Headless runs can't be closed, benchmarks need a fixed length
+  if (IsFixedTimeStep() && m_FrameNum == uint32_t(-1))
+    m_FrameNum = utils::BENCHMARK_FRAME_NUM;
 }
 
 void SampleBase::EnableMemoryLeakDetection(
@@ -0,0 +1,538 @@
+#include "NRIFramework.h"
+
+#include <filesystem>
+
+#include <assimp/cimport.h>
+#include <assimp/material.h>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#if defined(_WIN32)
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+constexpr uint32_t SCENE_CACHE_MAGIC = 0x4353524E; // "NRSC"
+
+struct SceneCacheArrayDesc {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t num;
+    uint32_t stride;
+};
+
+struct SceneCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint32_t arrayNum;
+    uint32_t reserved;
+    SceneCacheArrayDesc arrays[(uint32_t)utils::SceneCacheArray::MAX_NUM];
+};
+
+// Any layout change of these structs invalidates existing caches
+constexpr uint32_t g_SceneCacheStrides[] = {
+    sizeof(utils::Vertex),
+    sizeof(utils::UnpackedVertex),
+    sizeof(utils::Index),
+    sizeof(utils::Mesh),
+    sizeof(utils::MeshInstance),
+    sizeof(utils::Instance),
+    sizeof(utils::Material),
+    sizeof(utils::Meshlet),
+    sizeof(utils::MeshletBounds),
+    sizeof(uint32_t),
+    sizeof(uint32_t),
+    sizeof(utils::MeshLod),
+};
+
+static_assert(helper::GetCountOf(g_SceneCacheStrides) == (uint32_t)utils::SceneCacheArray::MAX_NUM, "Strides mismatch");
+
+static bool GetSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time) {
+    std::error_code error;
+    size = std::filesystem::file_size(sourcePath, error);
+    if (error)
+        return false;
+
+    time = std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+
+    return !error;
+}
+
+static void Normalize(float* v) {
+    float len = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (len > 1e-9f) {
+        v[0] /= len;
+        v[1] /= len;
+        v[2] /= len;
+    }
+}
+
+//==================================================================================================================
+// Cache
+//==================================================================================================================
+
+utils::SceneCache::~SceneCache() {
+    Close();
+}
+
+bool utils::SceneCache::Open(const std::string& path, const std::string& sourcePath) {
+    Close();
+
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!GetSourceStamp(sourcePath, sourceSize, sourceTime))
+        return false;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize = {};
+    GetFileSizeEx(file, &fileSize);
+
+    HANDLE mapping = fileSize.QuadPart ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+    m_File = file;
+    m_Mapping = mapping;
+    m_Size = (uint64_t)fileSize.QuadPart;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat fileStat = {};
+    fstat(file, &fileStat);
+
+    void* data = fileStat.st_size ? mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+    close(file);
+
+    if (data == MAP_FAILED)
+        data = nullptr;
+
+    m_Size = (uint64_t)fileStat.st_size;
+#endif
+
+    m_Data = (const uint8_t*)data;
+    if (!m_Data || m_Size < sizeof(SceneCacheHeader)) {
+        Close();
+        return false;
+    }
+
+    const SceneCacheHeader& header = *(const SceneCacheHeader*)m_Data;
+    bool isValid = header.magic == SCENE_CACHE_MAGIC && header.version == SCENE_CACHE_VERSION && header.arrayNum == (uint32_t)SceneCacheArray::MAX_NUM;
+    isValid = isValid && header.sourceSize == sourceSize && header.sourceTime == sourceTime;
+
+    for (uint32_t i = 0; i < (uint32_t)SceneCacheArray::MAX_NUM && isValid; i++) {
+        const SceneCacheArrayDesc& arrayDesc = header.arrays[i];
+        isValid = arrayDesc.stride == g_SceneCacheStrides[i] && arrayDesc.size == uint64_t(arrayDesc.num) * arrayDesc.stride;
+        isValid = isValid && arrayDesc.offset % SCENE_CACHE_ALIGNMENT == 0 && arrayDesc.offset + arrayDesc.size <= m_Size;
+    }
+
+    if (!isValid) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void utils::SceneCache::Close() {
+#if defined(_WIN32)
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+
+    if (m_Mapping)
+        CloseHandle((HANDLE)m_Mapping);
+
+    if (m_File)
+        CloseHandle((HANDLE)m_File);
+#else
+    if (m_Data)
+        munmap((void*)m_Data, (size_t)m_Size);
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_File = nullptr;
+    m_Mapping = nullptr;
+}
+
+bool utils::SceneCache::Write(const std::string& path, const std::string& sourcePath, const Scene& scene) {
+    SceneCacheHeader header = {};
+    header.magic = SCENE_CACHE_MAGIC;
+    header.version = SCENE_CACHE_VERSION;
+    header.arrayNum = (uint32_t)SceneCacheArray::MAX_NUM;
+
+    if (!GetSourceStamp(sourcePath, header.sourceSize, header.sourceTime))
+        return false;
+
+    const void* arrays[] = {
+        scene.vertices.data(),
+        scene.unpackedVertices.data(),
+        scene.indices.data(),
+        scene.meshes.data(),
+        scene.meshInstances.data(),
+        scene.instances.data(),
+        scene.materials.data(),
+        scene.meshlets.data(),
+        scene.meshletBounds.data(),
+        scene.meshletVertices.data(),
+        scene.meshletPrimitives.data(),
+        scene.meshLods.data(),
+    };
+
+    const size_t nums[] = {
+        scene.vertices.size(),
+        scene.unpackedVertices.size(),
+        scene.indices.size(),
+        scene.meshes.size(),
+        scene.meshInstances.size(),
+        scene.instances.size(),
+        scene.materials.size(),
+        scene.meshlets.size(),
+        scene.meshletBounds.size(),
+        scene.meshletVertices.size(),
+        scene.meshletPrimitives.size(),
+        scene.meshLods.size(),
+    };
+
+    uint64_t offset = helper::Align((uint64_t)sizeof(header), SCENE_CACHE_ALIGNMENT);
+    for (uint32_t i = 0; i < (uint32_t)SceneCacheArray::MAX_NUM; i++) {
+        SceneCacheArrayDesc& arrayDesc = header.arrays[i];
+        arrayDesc.offset = offset;
+        arrayDesc.num = (uint32_t)nums[i];
+        arrayDesc.stride = g_SceneCacheStrides[i];
+        arrayDesc.size = uint64_t(arrayDesc.num) * arrayDesc.stride;
+
+        offset = helper::Align(offset + arrayDesc.size, SCENE_CACHE_ALIGNMENT);
+    }
+
+    // Written to a temporary file first, a partially written cache must never be picked up
+    std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        printf("WARNING: Can't write scene cache '%s'\n", path.c_str());
+        return false;
+    }
+
+    const uint8_t padding[SCENE_CACHE_ALIGNMENT] = {};
+    bool isOk = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t written = sizeof(header);
+
+    for (uint32_t i = 0; i < (uint32_t)SceneCacheArray::MAX_NUM && isOk; i++) {
+        const SceneCacheArrayDesc& arrayDesc = header.arrays[i];
+
+        isOk = fwrite(padding, 1, (size_t)(arrayDesc.offset - written), file) == arrayDesc.offset - written;
+        isOk = isOk && (!arrayDesc.size || fwrite(arrays[i], 1, (size_t)arrayDesc.size, file) == arrayDesc.size);
+
+        written = arrayDesc.offset + arrayDesc.size;
+    }
+
+    isOk = fclose(file) == 0 && isOk;
+
+    std::error_code error;
+    if (isOk)
+        std::filesystem::rename(tempPath, path, error);
+
+    if (!isOk || error) {
+        std::filesystem::remove(tempPath, error);
+        printf("WARNING: Can't write scene cache '%s'\n", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+const void* utils::SceneCache::GetArray(SceneCacheArray array, uint64_t& size, uint32_t& num) const {
+    const SceneCacheHeader& header = *(const SceneCacheHeader*)m_Data;
+    const SceneCacheArrayDesc& arrayDesc = header.arrays[(uint32_t)array];
+
+    size = arrayDesc.size;
+    num = arrayDesc.num;
+
+    return m_Data + arrayDesc.offset;
+}
+
+template <typename T>
+static void CopyArray(const utils::SceneCache& cache, utils::SceneCacheArray array, std::vector<T>& dst) {
+    uint64_t size;
+    uint32_t num;
+    const void* src = cache.GetArray(array, size, num);
+
+    dst.resize(num);
+    if (size)
+        memcpy(dst.data(), src, (size_t)size);
+}
+
+void utils::SceneCache::CopyTo(Scene& scene, bool copyGeometry) const {
+    if (copyGeometry) {
+        CopyArray(*this, SceneCacheArray::VERTICES, scene.vertices);
+        CopyArray(*this, SceneCacheArray::UNPACKED_VERTICES, scene.unpackedVertices);
+        CopyArray(*this, SceneCacheArray::INDICES, scene.indices);
+    }
+
+    CopyArray(*this, SceneCacheArray::MESHES, scene.meshes);
+    CopyArray(*this, SceneCacheArray::MESH_INSTANCES, scene.meshInstances);
+    CopyArray(*this, SceneCacheArray::INSTANCES, scene.instances);
+    CopyArray(*this, SceneCacheArray::MATERIALS, scene.materials);
+    CopyArray(*this, SceneCacheArray::MESHLETS, scene.meshlets);
+    CopyArray(*this, SceneCacheArray::MESHLET_BOUNDS, scene.meshletBounds);
+    CopyArray(*this, SceneCacheArray::MESHLET_VERTICES, scene.meshletVertices);
+    CopyArray(*this, SceneCacheArray::MESHLET_PRIMITIVES, scene.meshletPrimitives);
+    CopyArray(*this, SceneCacheArray::MESH_LODS, scene.meshLods);
+
+    scene.totalInstancedPrimitivesNum = 0;
+    for (const Instance& instance : scene.instances) {
+        const MeshInstance& meshInstance = scene.meshInstances[instance.meshInstanceIndex];
+        scene.totalInstancedPrimitivesNum += scene.meshes[meshInstance.meshIndex].indexNum / 3;
+    }
+}
+
+utils::SceneGeometry utils::GetSceneGeometry(const Scene& scene, const SceneCache& cache) {
+    if (!cache.IsOpen())
+        return {scene.vertices.data(), scene.unpackedVertices.data(), scene.indices.data()};
+
+    uint64_t size;
+    uint32_t num;
+    SceneGeometry geometry = {};
+    geometry.vertices = (const Vertex*)cache.GetArray(SceneCacheArray::VERTICES, size, num);
+    geometry.unpackedVertices = (const UnpackedVertex*)cache.GetArray(SceneCacheArray::UNPACKED_VERTICES, size, num);
+    geometry.indices = (const Index*)cache.GetArray(SceneCacheArray::INDICES, size, num);
+
+    return geometry;
+}
+
+//==================================================================================================================
+// Import
+//==================================================================================================================
+
+static void ImportNode(const aiNode* node, const aiMatrix4x4& parentTransform, utils::Scene& scene, uint32_t meshOffset, uint32_t materialOffset, bool allowUpdate, const aiScene* imported) {
+    aiMatrix4x4 transform = parentTransform * node->mTransformation;
+
+    // Row-major, translation in the 4th column
+    float col0[3] = {transform.a1, transform.b1, transform.c1};
+    float col1[3] = {transform.a2, transform.b2, transform.c2};
+    float col2[3] = {transform.a3, transform.b3, transform.c3};
+
+    vec3 scale = vec3(sqrtf(col0[0] * col0[0] + col0[1] * col0[1] + col0[2] * col0[2]),
+        sqrtf(col1[0] * col1[0] + col1[1] * col1[1] + col1[2] * col1[2]),
+        sqrtf(col2[0] * col2[0] + col2[1] * col2[1] + col2[2] * col2[2]));
+
+    Normalize(col0);
+    Normalize(col1);
+    Normalize(col2);
+
+    mat4 rotation = mat4(vec4(col0[0], col0[1], col0[2], 0.0f), vec4(col1[0], col1[1], col1[2], 0.0f), vec4(col2[0], col2[1], col2[2], 0.0f), vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    vec3 position = vec3(transform.a4, transform.b4, transform.c4);
+
+    for (uint32_t i = 0; i < node->mNumMeshes; i++) {
+        uint32_t meshIndex = meshOffset + node->mMeshes[i];
+        const utils::Mesh& mesh = scene.meshes[meshIndex];
+        if (!mesh.indexNum)
+            continue;
+
+        utils::Instance& instance = scene.instances.emplace_back();
+        instance.rotation = rotation;
+        instance.rotationPrev = rotation;
+        instance.position = position;
+        instance.positionPrev = position;
+        instance.scale = scale;
+        instance.meshInstanceIndex = meshIndex; // one mesh instance per mesh
+        instance.materialIndex = materialOffset + imported->mMeshes[node->mMeshes[i]]->mMaterialIndex;
+        instance.allowUpdate = allowUpdate;
+
+        scene.totalInstancedPrimitivesNum += mesh.indexNum / 3;
+    }
+
+    for (uint32_t i = 0; i < node->mNumChildren; i++)
+        ImportNode(node->mChildren[i], transform, scene, meshOffset, materialOffset, allowUpdate, imported);
+}
+
+static bool ImportScene(const std::string& path, utils::Scene& scene, bool allowUpdate) {
+    const aiScene* imported = aiImportFile(path.c_str(), aiProcess_Triangulate | aiProcess_MakeLeftHanded | aiProcess_CalcTangentSpace);
+    if (!imported || !imported->mRootNode) {
+        printf("ERROR: Can't import scene '%s'!\n", path.c_str());
+        return false;
+    }
+
+    uint32_t meshOffset = (uint32_t)scene.meshes.size();
+    uint32_t materialOffset = (uint32_t)scene.materials.size();
+
+    // Materials (textures are not loaded, texture indices stay "StaticTexture" defaults)
+    for (uint32_t i = 0; i < imported->mNumMaterials; i++) {
+        const aiMaterial* srcMaterial = imported->mMaterials[i];
+
+        aiColor4D baseColor(1.0f, 1.0f, 1.0f, 1.0f);
+        if (aiGetMaterialColor(srcMaterial, AI_MATKEY_BASE_COLOR, &baseColor) != aiReturn_SUCCESS)
+            aiGetMaterialColor(srcMaterial, AI_MATKEY_COLOR_DIFFUSE, &baseColor);
+
+        aiColor4D emissive(0.0f, 0.0f, 0.0f, 0.0f);
+        aiGetMaterialColor(srcMaterial, AI_MATKEY_COLOR_EMISSIVE, &emissive);
+
+        float metalness = 1.0f;
+        aiGetMaterialFloat(srcMaterial, AI_MATKEY_METALLIC_FACTOR, &metalness);
+
+        float roughness = 1.0f;
+        aiGetMaterialFloat(srcMaterial, AI_MATKEY_ROUGHNESS_FACTOR, &roughness);
+
+        float opacity = 1.0f;
+        aiGetMaterialFloat(srcMaterial, AI_MATKEY_OPACITY, &opacity);
+
+        utils::Material& material = scene.materials.emplace_back();
+        material.baseColorAndMetalnessScale = vec4(baseColor.r, baseColor.g, baseColor.b, metalness);
+        material.emissiveAndRoughnessScale = vec4(emissive.r, emissive.g, emissive.b, roughness);
+        material.alphaMode = (opacity < 1.0f || baseColor.a < 1.0f) ? utils::AlphaMode::TRANSPARENT : utils::AlphaMode::OPAQUE;
+        material.isHair = false;
+        material.isLeaf = false;
+    }
+
+    // Meshes (indices are mesh-local, "vertexOffset" is the base vertex)
+    utils::MeshOptimizerStats optimizerStats = {};
+    std::vector<utils::UnpackedVertex> unpackedVertices;
+
+    for (uint32_t i = 0; i < imported->mNumMeshes; i++) {
+        const aiMesh* srcMesh = imported->mMeshes[i];
+
+        utils::Mesh& mesh = scene.meshes.emplace_back();
+        mesh.vertexOffset = (uint32_t)scene.vertices.size();
+        mesh.indexOffset = (uint32_t)scene.indices.size();
+
+        utils::MeshInstance& meshInstance = scene.meshInstances.emplace_back();
+        meshInstance.meshIndex = meshOffset + i;
+        meshInstance.primitiveOffset = mesh.indexOffset / 3;
+
+        // Points and lines survive triangulation
+        for (uint32_t j = 0; j < srcMesh->mNumFaces; j++) {
+            const aiFace& face = srcMesh->mFaces[j];
+            if (face.mNumIndices == 3)
+                scene.indices.insert(scene.indices.end(), face.mIndices, face.mIndices + 3);
+        }
+
+        mesh.indexNum = (uint32_t)scene.indices.size() - mesh.indexOffset;
+
+        unpackedVertices.resize(srcMesh->mNumVertices);
+        for (uint32_t j = 0; j < srcMesh->mNumVertices; j++) {
+            utils::UnpackedVertex& unpackedVertex = unpackedVertices[j];
+
+            const aiVector3D& pos = srcMesh->mVertices[j];
+            unpackedVertex.pos[0] = pos.x;
+            unpackedVertex.pos[1] = pos.y;
+            unpackedVertex.pos[2] = pos.z;
+
+            unpackedVertex.uv[0] = srcMesh->mTextureCoords[0] ? std::min(srcMesh->mTextureCoords[0][j].x, 65504.0f) : 0.0f;
+            unpackedVertex.uv[1] = srcMesh->mTextureCoords[0] ? std::min(srcMesh->mTextureCoords[0][j].y, 65504.0f) : 0.0f;
+
+            unpackedVertex.N[0] = srcMesh->mNormals ? srcMesh->mNormals[j].x : 0.0f;
+            unpackedVertex.N[1] = srcMesh->mNormals ? srcMesh->mNormals[j].y : 0.0f;
+            unpackedVertex.N[2] = srcMesh->mNormals ? srcMesh->mNormals[j].z : 1.0f;
+            Normalize(unpackedVertex.N);
+
+            if (srcMesh->mTangents && srcMesh->mBitangents) {
+                const aiVector3D& t = srcMesh->mTangents[j];
+                const aiVector3D& b = srcMesh->mBitangents[j];
+                const float* n = unpackedVertex.N;
+
+                float nxt[3] = {n[1] * t.z - n[2] * t.y, n[2] * t.x - n[0] * t.z, n[0] * t.y - n[1] * t.x};
+                float handedness = nxt[0] * b.x + nxt[1] * b.y + nxt[2] * b.z < 0.0f ? -1.0f : 1.0f;
+
+                unpackedVertex.T[0] = t.x;
+                unpackedVertex.T[1] = t.y;
+                unpackedVertex.T[2] = t.z;
+                unpackedVertex.T[3] = handedness;
+                Normalize(unpackedVertex.T);
+            } else {
+                unpackedVertex.T[0] = 1.0f;
+                unpackedVertex.T[1] = 0.0f;
+                unpackedVertex.T[2] = 0.0f;
+                unpackedVertex.T[3] = 1.0f;
+            }
+        }
+
+        mesh.indexNum = utils::OptimizeMesh(unpackedVertices, scene.indices.data() + mesh.indexOffset, mesh.indexNum, optimizerStats);
+        scene.indices.resize(mesh.indexOffset + mesh.indexNum);
+
+        mesh.vertexNum = (uint32_t)unpackedVertices.size();
+        mesh.vertexFormat = utils::SelectVertexFormat(unpackedVertices.data(), mesh.vertexNum);
+        scene.unpackedVertices.insert(scene.unpackedVertices.end(), unpackedVertices.begin(), unpackedVertices.end());
+        scene.vertices.resize(mesh.vertexOffset + mesh.vertexNum);
+
+        utils::PackVertices(utils::VertexFormat::STANDARD, scene.unpackedVertices.data() + mesh.vertexOffset, mesh.vertexNum, scene.vertices.data() + mesh.vertexOffset);
+    }
+
+    if (optimizerStats.triangleNum) {
+        utils::VertexCacheStats before = optimizerStats.GetBefore();
+        utils::VertexCacheStats after = optimizerStats.GetAfter();
+
+        printf("Mesh optimization: %llu triangles (%llu degenerate removed), %llu vertices welded, ACMR %.3f => %.3f, ATVR %.3f => %.3f, %u / %u meshes with 16-bit indices, %.2f Mtri/s\n",
+            (unsigned long long)optimizerStats.triangleNum, (unsigned long long)optimizerStats.degenerateTriangleNum, (unsigned long long)optimizerStats.weldedVertexNum, before.acmr, after.acmr, before.atvr, after.atvr,
+            optimizerStats.index16MeshNum, optimizerStats.meshNum, optimizerStats.GetTrianglesPerSecond() / 1e6);
+    }
+
+    // Instances
+    ImportNode(imported->mRootNode, aiMatrix4x4(), scene, meshOffset, materialOffset, allowUpdate, imported);
+
+    aiReleaseImport(imported);
+
+    return true;
+}
+
+bool utils::LoadScene(const std::string& path, Scene& scene, bool allowUpdate, SceneCache* cache) {
+    // The cache describes a whole scene, it's used only if nothing has been loaded into "scene" yet
+    std::string cachePath = path + ".cache";
+    bool isEmpty = scene.meshes.empty() && scene.materials.empty() && scene.instances.empty();
+
+    SceneCache localCache;
+    SceneCache& sceneCache = cache ? *cache : localCache;
+
+    if (isEmpty) {
+        if (sceneCache.Open(cachePath, path)) {
+            printf("Loading scene '%s' (cached)...\n", GetFileName(path));
+
+            sceneCache.CopyTo(scene, !cache);
+            for (Instance& instance : scene.instances)
+                instance.allowUpdate = allowUpdate;
+
+            return true;
+        }
+    }
+
+    printf("Loading scene '%s'...\n", GetFileName(path));
+
+    if (!ImportScene(path, scene, allowUpdate))
+        return false;
+
+    Timer timer;
+    double meshletBegin = timer.GetTimeStamp();
+    BuildSceneMeshlets(scene);
+    printf("Meshlets: %zu (%.1f ms)\n", scene.meshlets.size(), timer.GetTimeStamp() - meshletBegin);
+
+    MeshSimplifierStats lodStats = {};
+    BuildSceneLods(scene, {}, lodStats);
+
+    printf("LODs: %.2f Mtri/s\n", lodStats.GetTrianglesPerSecond() / 1e6);
+    for (uint32_t i = 0; i < MESH_LOD_MAX_NUM && lodStats.triangleNum[i]; i++)
+        printf("  LOD %u: %llu triangles (%.1f%%), max error %.4f\n", i, (unsigned long long)lodStats.triangleNum[i], 100.0 * lodStats.triangleNum[i] / lodStats.triangleNum[0], lodStats.maxError[i]);
+
+    // A mapped cache is requested: the new cache is mapped too, the geometry source is the same on every run
+    if (isEmpty && SceneCache::Write(cachePath, path, scene) && cache && cache->Open(cachePath, path)) {
+        std::vector<Vertex>().swap(scene.vertices);
+        std::vector<UnpackedVertex>().swap(scene.unpackedVertices);
+        std::vector<Index>().swap(scene.indices);
+    }
+
+    return true;
+}
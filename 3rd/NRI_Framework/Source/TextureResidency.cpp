@@ -0,0 +1,415 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+
+void TextureResidencyManager::Initialize(const nri::CoreInterface& NRI, const nri::HelperInterface& helperInterface, const nri::StreamerInterface& streamerInterface,
+    nri::Device& device, nri::Streamer& streamer, const TextureResidencyDesc& desc) {
+    m_NRI = &NRI;
+    m_HelperInterface = &helperInterface;
+    m_StreamerInterface = &streamerInterface;
+    m_Device = &device;
+    m_Streamer = &streamer;
+    m_Desc = desc;
+}
+
+void TextureResidencyManager::Destroy() {
+    ReleaseCompleted(uint32_t(-1));
+
+    for (ResidentTexture& residentTexture : m_Textures) {
+        m_NRI->DestroyDescriptor(*residentTexture.descriptor);
+        m_NRI->DestroyTexture(*residentTexture.gpuTexture);
+        m_NRI->FreeMemory(*residentTexture.memory);
+    }
+
+    m_Textures.clear();
+    m_Instances.clear();
+    m_ChainSizes.clear();
+    m_TexturesWithUploads.clear();
+    m_ReplacedTextures.clear();
+    m_Stats = {};
+    m_LruHead = utils::InvalidIndex;
+    m_LruTail = utils::InvalidIndex;
+}
+
+uint32_t TextureResidencyManager::AddTexture(const utils::Texture& texture) {
+    const uint32_t textureIndex = (uint32_t)m_Textures.size();
+    const uint32_t mipNum = texture.GetMipNum();
+    const uint32_t maxDim = std::max(texture.GetWidth(), texture.GetHeight());
+
+    // The tail starts from the first mip fitting into "mipTailDim", but at least the last mip is always resident
+    uint32_t tailMip = 0;
+    while (tailMip + 1 < mipNum && (maxDim >> tailMip) > m_Desc.mipTailDim)
+        tailMip++;
+
+    ResidentTexture residentTexture = {};
+    residentTexture.texture = &texture;
+    residentTexture.chainSizeOffset = (uint32_t)m_ChainSizes.size();
+    residentTexture.lruPrev = utils::InvalidIndex;
+    residentTexture.lruNext = utils::InvalidIndex;
+    residentTexture.mipNum = (uint8_t)mipNum;
+    residentTexture.tailMip = (uint8_t)tailMip;
+    residentTexture.residentMip = (uint8_t)mipNum;
+    residentTexture.targetMip = (uint8_t)tailMip;
+    residentTexture.requestedMip = (uint8_t)tailMip;
+    m_Textures.push_back(residentTexture);
+
+    m_ChainSizes.resize(m_ChainSizes.size() + mipNum + 1);
+    for (uint32_t mip = mipNum; mip > 0; mip--) {
+        nri::TextureSubresourceUploadDesc subresource = {};
+        texture.GetSubresource(subresource, mip - 1);
+
+        const uint64_t mipSize = uint64_t(subresource.slicePitch) * std::max(subresource.sliceNum, 1u);
+        m_ChainSizes[residentTexture.chainSizeOffset + mip - 1] = m_ChainSizes[residentTexture.chainSizeOffset + mip] + mipSize;
+    }
+
+    // Mip tail: small, so it doesn't count against the per frame budget
+    if (!CreateChain(textureIndex, tailMip, 0)) {
+        m_Textures.pop_back();
+        m_ChainSizes.resize(residentTexture.chainSizeOffset);
+
+        return utils::InvalidIndex;
+    }
+
+    m_Stats.residentSize += GetChainSize(residentTexture, tailMip);
+    m_Stats.uploadedMipNum += mipNum - tailMip;
+
+    LruPushFront(textureIndex);
+
+    return textureIndex;
+}
+
+uint32_t TextureResidencyManager::AddInstance(uint32_t textureIndex, const vec3& center, float radius) {
+    m_Instances.push_back({center, radius, textureIndex});
+
+    return (uint32_t)m_Instances.size() - 1;
+}
+
+void TextureResidencyManager::UpdateInstance(uint32_t instanceIndex, const vec3& center, float radius) {
+    ResidentInstance& instance = m_Instances[instanceIndex];
+    instance.center = center;
+    instance.radius = radius;
+}
+
+void TextureResidencyManager::Update(const vec3& cameraPosition, const mat4& viewToClip, uint32_t viewportHeight, uint32_t frameIndex) {
+    m_Stats.uploadedSize = 0;
+    m_Stats.evictedSize = 0;
+    m_Stats.releasedSize = 0;
+    m_Stats.uploadedMipNum = 0;
+    m_Stats.evictedMipNum = 0;
+    m_Stats.replacedTextureNum = 0;
+    m_Stats.pendingMipNum = 0;
+
+    m_ReplacedTextures.clear();
+    ReleaseCompleted(frameIndex);
+
+    // The budget has been lowered: nothing is marked as used in this frame yet, so any mip above the tail can go
+    if (m_Stats.residentSize > m_Desc.memoryBudget)
+        MakeRoom(0, frameIndex, utils::InvalidIndex);
+
+    // Feedback: the most detailed mip needed by any instance. Distance (not depth) is used to estimate the screen
+    // coverage, because it doesn't depend on the view direction, i.e. turning around doesn't cause re-streaming
+    for (ResidentTexture& residentTexture : m_Textures)
+        residentTexture.requestedMip = residentTexture.tailMip;
+
+    const float pixelsPerUnit = 0.5f * viewToClip[1][1] * float(viewportHeight);
+
+    for (const ResidentInstance& instance : m_Instances) {
+        ResidentTexture& residentTexture = m_Textures[instance.textureIndex];
+
+        float distance = std::max(length(instance.center - cameraPosition) - instance.radius, 1e-3f);
+        float coverage = std::max(2.0f * instance.radius * pixelsPerUnit / distance, 1.0f); // diameter in pixels
+
+        const utils::Texture& texture = *residentTexture.texture;
+        float maxDim = (float)std::max(texture.GetWidth(), texture.GetHeight());
+        float mip = std::log2(maxDim / coverage) + m_Desc.lodBias;
+
+        uint32_t requestedMip = (uint32_t)std::clamp(mip, 0.0f, (float)residentTexture.tailMip);
+        residentTexture.requestedMip = (uint8_t)std::min<uint32_t>(residentTexture.requestedMip, requestedMip);
+    }
+
+    m_UploadQueue.clear();
+    for (uint32_t i = 0; i < (uint32_t)m_Textures.size(); i++) {
+        ResidentTexture& residentTexture = m_Textures[i];
+
+        if (residentTexture.requestedMip < residentTexture.tailMip) {
+            residentTexture.lastUsedFrame = frameIndex;
+
+            LruRemove(i);
+            LruPushFront(i);
+        }
+
+        if (residentTexture.targetMip > residentTexture.requestedMip)
+            m_UploadQueue.push_back(i);
+    }
+
+    // Largest deficit first
+    std::sort(m_UploadQueue.begin(), m_UploadQueue.end(), [this](uint32_t a, uint32_t b) {
+        const ResidentTexture& ta = m_Textures[a];
+        const ResidentTexture& tb = m_Textures[b];
+
+        uint32_t deficitA = ta.targetMip - ta.requestedMip;
+        uint32_t deficitB = tb.targetMip - tb.requestedMip;
+
+        return deficitA != deficitB ? deficitA > deficitB : a < b;
+    });
+
+    // Stream one mip per texture per pass (coarse to fine), so a single big texture can't starve the others. The first
+    // new mip of a texture also pays for re-uploading the resident ones into the recreated texture
+    uint64_t budget = m_Desc.uploadBudgetPerFrame;
+    uint64_t queuedSize = 0;
+    bool isProgress = true;
+    while (isProgress) {
+        isProgress = false;
+
+        for (uint32_t textureIndex : m_UploadQueue) {
+            ResidentTexture& residentTexture = m_Textures[textureIndex];
+            if (residentTexture.targetMip <= residentTexture.requestedMip)
+                continue;
+
+            uint32_t mip = residentTexture.targetMip - 1;
+            uint64_t size = GetMipSize(residentTexture, mip);
+            uint64_t uploadSize = size + (residentTexture.targetMip == residentTexture.residentMip ? GetChainSize(residentTexture, residentTexture.residentMip) : 0);
+
+            // A mip bigger than the whole budget still gets streamed, but alone
+            bool isFirst = queuedSize == 0;
+            if (uploadSize > budget && !isFirst)
+                continue;
+
+            if (!MakeRoom(size, frameIndex, textureIndex))
+                continue;
+
+            residentTexture.targetMip = (uint8_t)mip;
+            m_Stats.residentSize += size;
+            m_Stats.uploadedMipNum++;
+
+            queuedSize += uploadSize;
+            budget -= std::min(uploadSize, budget);
+            isProgress = true;
+        }
+    }
+
+    // Recreate textures with the new mip chains. Evicted textures re-upload what is left (outside of the budget)
+    for (uint32_t i = 0; i < (uint32_t)m_Textures.size(); i++) {
+        ResidentTexture& residentTexture = m_Textures[i];
+        if (residentTexture.targetMip == residentTexture.residentMip)
+            continue;
+
+        if (!CreateChain(i, residentTexture.targetMip, frameIndex)) {
+            // Out of memory: keep the current texture
+            if (residentTexture.targetMip < residentTexture.residentMip)
+                m_Stats.uploadedMipNum -= residentTexture.residentMip - residentTexture.targetMip;
+
+            m_Stats.residentSize = m_Stats.residentSize + GetChainSize(residentTexture, residentTexture.residentMip) - GetChainSize(residentTexture, residentTexture.targetMip);
+            residentTexture.targetMip = residentTexture.residentMip;
+        }
+    }
+
+    for (const ResidentTexture& residentTexture : m_Textures) {
+        if (residentTexture.residentMip > residentTexture.requestedMip)
+            m_Stats.pendingMipNum += residentTexture.residentMip - residentTexture.requestedMip;
+    }
+}
+
+void TextureResidencyManager::GatherUploadBarriers(std::vector<nri::TextureBarrierDesc>& toCopyDestination, std::vector<nri::TextureBarrierDesc>& toShaderResource) {
+    const nri::AccessLayoutStage undefined = {nri::AccessBits::UNKNOWN, nri::Layout::UNKNOWN, nri::StageBits::NONE};
+    const nri::AccessLayoutStage shaderResource = {nri::AccessBits::SHADER_RESOURCE, nri::Layout::SHADER_RESOURCE, nri::StageBits::ALL};
+    const nri::AccessLayoutStage copyDestination = {nri::AccessBits::COPY_DESTINATION, nri::Layout::COPY_DESTINATION, nri::StageBits::COPY};
+
+    for (uint32_t textureIndex : m_TexturesWithUploads) {
+        ResidentTexture& residentTexture = m_Textures[textureIndex];
+
+        nri::TextureBarrierDesc barrier = {};
+        barrier.texture = residentTexture.gpuTexture;
+        barrier.mipNum = nri::REMAINING_MIPS;
+        barrier.layerNum = 1;
+        barrier.planes = nri::PlaneBits::ALL;
+
+        barrier.before = undefined;
+        barrier.after = copyDestination;
+        toCopyDestination.push_back(barrier);
+
+        barrier.before = copyDestination;
+        barrier.after = shaderResource;
+        toShaderResource.push_back(barrier);
+
+        residentTexture.isUploadPending = false;
+    }
+
+    m_TexturesWithUploads.clear();
+}
+
+bool TextureResidencyManager::CreateChain(uint32_t textureIndex, uint32_t mip, uint32_t frameIndex) {
+    ResidentTexture& residentTexture = m_Textures[textureIndex];
+    const utils::Texture& texture = *residentTexture.texture;
+
+    nri::TextureDesc textureDesc = {};
+    textureDesc.type = nri::TextureType::TEXTURE_2D;
+    textureDesc.usage = nri::TextureUsageBits::SHADER_RESOURCE;
+    textureDesc.format = texture.GetFormat();
+    textureDesc.width = (nri::Dim_t)std::max(texture.GetWidth() >> mip, 1);
+    textureDesc.height = (nri::Dim_t)std::max(texture.GetHeight() >> mip, 1);
+    textureDesc.mipNum = (nri::Mip_t)(residentTexture.mipNum - mip);
+
+    nri::Texture* gpuTexture = nullptr;
+    if (m_NRI->CreateTexture(*m_Device, textureDesc, gpuTexture) != nri::Result::SUCCESS) {
+        printf("ERROR: Can't create a texture for '%s' (mip %u)\n", texture.name.c_str(), mip);
+        return false;
+    }
+
+    // A single texture takes a single allocation
+    nri::ResourceGroupDesc resourceGroupDesc = {};
+    resourceGroupDesc.memoryLocation = nri::MemoryLocation::DEVICE;
+    resourceGroupDesc.textureNum = 1;
+    resourceGroupDesc.textures = &gpuTexture;
+
+    nri::Memory* memory = nullptr;
+    nri::Descriptor* descriptor = nullptr;
+    nri::Texture2DViewDesc texture2DViewDesc = {gpuTexture, nri::Texture2DViewType::SHADER_RESOURCE_2D, texture.GetFormat()};
+
+    if (m_HelperInterface->AllocateAndBindMemory(*m_Device, resourceGroupDesc, &memory) != nri::Result::SUCCESS
+        || m_NRI->CreateTexture2DView(texture2DViewDesc, descriptor) != nri::Result::SUCCESS) {
+        printf("ERROR: Can't allocate a texture for '%s' (mip %u)\n", texture.name.c_str(), mip);
+
+        if (memory)
+            m_NRI->FreeMemory(*memory);
+        m_NRI->DestroyTexture(*gpuTexture);
+
+        return false;
+    }
+
+    // Not less than the texel data (NONE reports 1 byte)
+    nri::MemoryDesc memoryDesc = {};
+    m_NRI->GetTextureMemoryDesc(*gpuTexture, nri::MemoryLocation::DEVICE, memoryDesc);
+
+    const uint64_t allocationSize = std::max(memoryDesc.size, GetChainSize(residentTexture, mip));
+
+    // The previous texture can still be in use by frames in flight
+    if (residentTexture.gpuTexture) {
+        m_ReleasedTextures.push_back({residentTexture.gpuTexture, residentTexture.descriptor, residentTexture.memory, residentTexture.allocationSize, frameIndex});
+        m_ReplacedTextures.push_back(textureIndex);
+
+        m_Stats.releasingSize += residentTexture.allocationSize;
+        m_Stats.replacedTextureNum++;
+    }
+
+    residentTexture.gpuTexture = gpuTexture;
+    residentTexture.descriptor = descriptor;
+    residentTexture.memory = memory;
+    residentTexture.allocationSize = allocationSize;
+    residentTexture.residentMip = (uint8_t)mip;
+    residentTexture.targetMip = (uint8_t)mip;
+
+    m_Stats.allocatedSize += allocationSize;
+
+    for (uint32_t i = mip; i < residentTexture.mipNum; i++)
+        UploadMip(residentTexture, i);
+
+    if (!residentTexture.isUploadPending) {
+        residentTexture.isUploadPending = true;
+        m_TexturesWithUploads.push_back(textureIndex);
+    }
+
+    return true;
+}
+
+void TextureResidencyManager::ReleaseCompleted(uint32_t frameIndex) {
+    size_t n = 0;
+    for (const ReleasedTexture& releasedTexture : m_ReleasedTextures) {
+        if (frameIndex < releasedTexture.frameIndex + BUFFERED_FRAME_MAX_NUM) {
+            m_ReleasedTextures[n++] = releasedTexture;
+            continue;
+        }
+
+        m_NRI->DestroyDescriptor(*releasedTexture.descriptor);
+        m_NRI->DestroyTexture(*releasedTexture.gpuTexture);
+        m_NRI->FreeMemory(*releasedTexture.memory);
+
+        m_Stats.allocatedSize -= releasedTexture.allocationSize;
+        m_Stats.releasingSize -= releasedTexture.allocationSize;
+        m_Stats.releasedSize += releasedTexture.allocationSize;
+    }
+
+    m_ReleasedTextures.resize(n);
+}
+
+void TextureResidencyManager::UploadMip(const ResidentTexture& residentTexture, uint32_t mip) {
+    nri::TextureSubresourceUploadDesc subresource = {};
+    residentTexture.texture->GetSubresource(subresource, mip);
+
+    nri::TextureUpdateRequestDesc textureUpdateRequestDesc = {};
+    textureUpdateRequestDesc.data = subresource.slices;
+    textureUpdateRequestDesc.dataRowPitch = subresource.rowPitch;
+    textureUpdateRequestDesc.dataSlicePitch = subresource.slicePitch;
+    textureUpdateRequestDesc.dstTexture = residentTexture.gpuTexture;
+    textureUpdateRequestDesc.dstRegionDesc.width = nri::WHOLE_SIZE;
+    textureUpdateRequestDesc.dstRegionDesc.height = nri::WHOLE_SIZE;
+    textureUpdateRequestDesc.dstRegionDesc.depth = nri::WHOLE_SIZE;
+    textureUpdateRequestDesc.dstRegionDesc.mipOffset = (nri::Mip_t)(mip - residentTexture.residentMip);
+
+    m_StreamerInterface->AddStreamerTextureUpdateRequest(*m_Streamer, textureUpdateRequestDesc);
+
+    m_Stats.uploadedSize += GetMipSize(residentTexture, mip);
+}
+
+bool TextureResidencyManager::MakeRoom(uint64_t size, uint32_t frameIndex, uint32_t exceptTextureIndex) {
+    uint32_t victimIndex = m_LruTail;
+
+    while (m_Stats.residentSize + size > m_Desc.memoryBudget) {
+        // Least recently used first. Mips needed this frame are never evicted
+        while (victimIndex != utils::InvalidIndex) {
+            const ResidentTexture& victim = m_Textures[victimIndex];
+
+            bool isUnused = victim.lastUsedFrame != frameIndex || victim.targetMip < victim.requestedMip;
+            if (victimIndex != exceptTextureIndex && isUnused && victim.targetMip < victim.tailMip)
+                break;
+
+            victimIndex = victim.lruPrev;
+        }
+
+        if (victimIndex == utils::InvalidIndex)
+            return false;
+
+        // Drop the most detailed mip, the victim stays a candidate until it reaches the tail. Memory is released when
+        // the texture gets recreated without the mip at the end of "Update"
+        ResidentTexture& victim = m_Textures[victimIndex];
+        uint64_t victimSize = GetMipSize(victim, victim.targetMip);
+
+        victim.targetMip++;
+
+        m_Stats.residentSize -= victimSize;
+        m_Stats.evictedSize += victimSize;
+        m_Stats.evictedMipNum++;
+    }
+
+    return true;
+}
+
+void TextureResidencyManager::LruRemove(uint32_t textureIndex) {
+    ResidentTexture& residentTexture = m_Textures[textureIndex];
+
+    if (residentTexture.lruPrev != utils::InvalidIndex)
+        m_Textures[residentTexture.lruPrev].lruNext = residentTexture.lruNext;
+    else
+        m_LruHead = residentTexture.lruNext;
+
+    if (residentTexture.lruNext != utils::InvalidIndex)
+        m_Textures[residentTexture.lruNext].lruPrev = residentTexture.lruPrev;
+    else
+        m_LruTail = residentTexture.lruPrev;
+
+    residentTexture.lruPrev = utils::InvalidIndex;
+    residentTexture.lruNext = utils::InvalidIndex;
+}
+
+void TextureResidencyManager::LruPushFront(uint32_t textureIndex) {
+    ResidentTexture& residentTexture = m_Textures[textureIndex];
+    residentTexture.lruPrev = utils::InvalidIndex;
+    residentTexture.lruNext = m_LruHead;
+
+    if (m_LruHead != utils::InvalidIndex)
+        m_Textures[m_LruHead].lruPrev = textureIndex;
+    else
+        m_LruTail = textureIndex;
+
+    m_LruHead = textureIndex;
+}
@@ -0,0 +1,263 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+
+void BindlessTextureTable::Initialize(const BindlessTextureTableDesc& desc) {
+    m_Desc = desc;
+    m_Desc.pageSize = std::max(std::min(desc.pageSize, desc.maxTextureNum), 1u);
+}
+
+nri::DescriptorRangeDesc BindlessTextureTable::GetDescriptorRangeDesc() const {
+    nri::DescriptorRangeDesc descriptorRangeDesc = {};
+    descriptorRangeDesc.baseRegisterIndex = m_Desc.baseRegisterIndex;
+    descriptorRangeDesc.descriptorNum = m_Desc.maxTextureNum;
+    descriptorRangeDesc.descriptorType = nri::DescriptorType::TEXTURE;
+    descriptorRangeDesc.shaderStages = m_Desc.shaderStages;
+    descriptorRangeDesc.flags = nri::DescriptorRangeBits::PARTIALLY_BOUND | nri::DescriptorRangeBits::ARRAY | nri::DescriptorRangeBits::VARIABLE_SIZED_ARRAY;
+
+    return descriptorRangeDesc;
+}
+
+bool BindlessTextureTable::CreateDescriptorSet(const nri::CoreInterface& NRI, nri::DescriptorPool& descriptorPool, const nri::PipelineLayout& pipelineLayout, uint32_t setIndex, nri::Descriptor* nullDescriptor) {
+    if (NRI.AllocateDescriptorSets(descriptorPool, pipelineLayout, setIndex, &m_DescriptorSet, 1, m_Desc.maxTextureNum) != nri::Result::SUCCESS) {
+        printf("ERROR: Can't allocate a descriptor set for %u bindless textures!\n", m_Desc.maxTextureNum);
+        return false;
+    }
+
+    m_NRI = &NRI;
+    m_NullDescriptor = nullDescriptor;
+
+    // Textures added before the set existed (and free slots, if there is a null descriptor)
+    m_DirtySlots.clear();
+    for (uint32_t i = 0; i < (uint32_t)m_Descriptors.size(); i++) {
+        if (!m_Descriptors[i])
+            m_Descriptors[i] = m_NullDescriptor;
+
+        if (m_Descriptors[i])
+            m_DirtySlots.push_back(i);
+    }
+
+    return true;
+}
+
+uint32_t BindlessTextureTable::Add(nri::Descriptor& descriptor) {
+    if (m_FreeSlots.empty()) {
+        if (m_Descriptors.size() == m_Desc.maxTextureNum)
+            return utils::InvalidIndex;
+
+        AllocatePage();
+    }
+
+    uint32_t index = m_FreeSlots.back();
+    m_FreeSlots.pop_back();
+
+    m_Descriptors[index] = &descriptor;
+    m_IsAdded[index] = 1;
+    m_DirtySlots.push_back(index);
+    m_Stats.textureNum++;
+
+    return index;
+}
+
+bool BindlessTextureTable::Replace(uint32_t index, nri::Descriptor& descriptor) {
+    if (index >= m_IsAdded.size() || !m_IsAdded[index])
+        return false;
+
+    m_Descriptors[index] = &descriptor;
+    m_DirtySlots.push_back(index);
+
+    return true;
+}
+
+bool BindlessTextureTable::Remove(uint32_t index, uint32_t frameIndex) {
+    // A second "Remove" would put the slot into the free list twice, handing it out to two textures
+    if (index >= m_IsAdded.size() || !m_IsAdded[index])
+        return false;
+
+    // Descriptor stays in place while in-flight frames can reference it
+    m_IsAdded[index] = 0;
+    m_RemovedSlots.push_back({index, frameIndex});
+    m_Stats.textureNum--;
+
+    return true;
+}
+
+void BindlessTextureTable::Update(uint32_t frameIndex) {
+    m_Stats.writtenDescriptorNum = 0;
+    m_Stats.updateCallNum = 0;
+
+    // Recycle slots not referenced by in-flight frames anymore
+    size_t n = 0;
+    for (const RemovedSlot& removedSlot : m_RemovedSlots) {
+        if (frameIndex - removedSlot.frameIndex >= BUFFERED_FRAME_MAX_NUM) {
+            m_Descriptors[removedSlot.index] = m_NullDescriptor;
+            if (m_NullDescriptor)
+                m_DirtySlots.push_back(removedSlot.index);
+
+            m_FreeSlots.push_back(removedSlot.index);
+        } else
+            m_RemovedSlots[n++] = removedSlot;
+    }
+    m_RemovedSlots.resize(n);
+
+    if (!m_DescriptorSet || m_DirtySlots.empty())
+        return;
+
+    std::sort(m_DirtySlots.begin(), m_DirtySlots.end());
+    m_DirtySlots.erase(std::unique(m_DirtySlots.begin(), m_DirtySlots.end()), m_DirtySlots.end());
+
+    // One update per contiguous run, "m_Descriptors" is already laid out as the range
+    size_t i = 0;
+    while (i < m_DirtySlots.size()) {
+        uint32_t baseSlot = m_DirtySlots[i];
+        uint32_t slotNum = 0;
+
+        while (i < m_DirtySlots.size() && m_DirtySlots[i] == baseSlot + slotNum && m_Descriptors[m_DirtySlots[i]]) {
+            slotNum++;
+            i++;
+        }
+
+        if (!slotNum) { // free slot without a null descriptor
+            i++;
+            continue;
+        }
+
+        nri::DescriptorRangeUpdateDesc descriptorRangeUpdateDesc = {};
+        descriptorRangeUpdateDesc.descriptors = m_Descriptors.data() + baseSlot;
+        descriptorRangeUpdateDesc.descriptorNum = slotNum;
+        descriptorRangeUpdateDesc.baseDescriptor = baseSlot;
+
+        m_NRI->UpdateDescriptorRanges(*m_DescriptorSet, 0, 1, &descriptorRangeUpdateDesc);
+
+        m_Stats.writtenDescriptorNum += slotNum;
+        m_Stats.updateCallNum++;
+    }
+
+    m_DirtySlots.clear();
+}
+
+void BindlessTextureTable::AllocatePage() {
+    uint32_t baseSlot = (uint32_t)m_Descriptors.size();
+    uint32_t slotNum = std::min(m_Desc.pageSize, m_Desc.maxTextureNum - baseSlot);
+
+    m_Descriptors.resize(baseSlot + slotNum, m_NullDescriptor);
+    m_IsAdded.resize(baseSlot + slotNum, 0);
+
+    // Reversed to hand out lower slots first, keeping writes contiguous
+    for (uint32_t i = baseSlot + slotNum; i > baseSlot; i--)
+        m_FreeSlots.push_back(i - 1);
+
+    if (m_NullDescriptor) {
+        for (uint32_t i = baseSlot; i < baseSlot + slotNum; i++)
+            m_DirtySlots.push_back(i);
+    }
+
+    m_Stats.slotNum = baseSlot + slotNum;
+    m_Stats.pageNum++;
+}
+
+//==================================================================================================================
+
+void SkylineAtlasPacker::Initialize(uint32_t width, uint32_t height, uint32_t padding) {
+    m_Width = width;
+    m_Height = height;
+    m_Padding = padding;
+
+    Reset();
+}
+
+void SkylineAtlasPacker::Reset() {
+    m_Skyline.clear();
+    m_Skyline.push_back({0, 0, m_Width});
+
+    m_PackedArea = 0;
+    m_UsedHeight = 0;
+    m_RectNum = 0;
+}
+
+bool SkylineAtlasPacker::Fit(size_t nodeIndex, uint32_t width, uint32_t height, uint32_t& y) const {
+    uint32_t x = m_Skyline[nodeIndex].x;
+    if (x + width > m_Width)
+        return false;
+
+    // The rectangle rests on the highest node under it
+    y = 0;
+    int64_t widthLeft = width;
+    for (size_t i = nodeIndex; widthLeft > 0; i++) {
+        y = std::max(y, m_Skyline[i].y);
+        if (y + height > m_Height)
+            return false;
+
+        widthLeft -= m_Skyline[i].width;
+    }
+
+    return true;
+}
+
+bool SkylineAtlasPacker::Pack(uint32_t width, uint32_t height, AtlasRect& rect) {
+    uint32_t paddedWidth = width + m_Padding;
+    uint32_t paddedHeight = height + m_Padding;
+
+    // Bottom-left: the lowest top edge, ties are broken by the narrowest node
+    size_t bestIndex = m_Skyline.size();
+    uint32_t bestTop = UINT32_MAX;
+    uint32_t bestWidth = UINT32_MAX;
+    uint32_t bestY = 0;
+
+    for (size_t i = 0; i < m_Skyline.size(); i++) {
+        uint32_t y;
+        if (!Fit(i, paddedWidth, paddedHeight, y))
+            continue;
+
+        uint32_t top = y + paddedHeight;
+        if (top < bestTop || (top == bestTop && m_Skyline[i].width < bestWidth)) {
+            bestIndex = i;
+            bestTop = top;
+            bestWidth = m_Skyline[i].width;
+            bestY = y;
+        }
+    }
+
+    if (bestIndex == m_Skyline.size())
+        return false;
+
+    uint32_t x = m_Skyline[bestIndex].x;
+    m_Skyline.insert(m_Skyline.begin() + bestIndex, {x, bestTop, paddedWidth});
+
+    // Cut nodes covered by the new one
+    for (size_t i = bestIndex + 1; i < m_Skyline.size(); i++) {
+        const SkylineNode& prev = m_Skyline[i - 1];
+        SkylineNode& node = m_Skyline[i];
+
+        uint32_t prevEnd = prev.x + prev.width;
+        if (node.x >= prevEnd)
+            break;
+
+        uint32_t shrink = prevEnd - node.x;
+        if (node.width > shrink) {
+            node.x += shrink;
+            node.width -= shrink;
+            break;
+        }
+
+        m_Skyline.erase(m_Skyline.begin() + i);
+        i--;
+    }
+
+    // Merge neighbors at the same height
+    for (size_t i = 0; i + 1 < m_Skyline.size(); i++) {
+        if (m_Skyline[i].y == m_Skyline[i + 1].y) {
+            m_Skyline[i].width += m_Skyline[i + 1].width;
+            m_Skyline.erase(m_Skyline.begin() + i + 1);
+            i--;
+        }
+    }
+
+    rect = {x, bestY, width, height};
+
+    m_PackedArea += uint64_t(width) * height;
+    m_UsedHeight = std::max(m_UsedHeight, bestTop);
+    m_RectNum++;
+
+    return true;
+}
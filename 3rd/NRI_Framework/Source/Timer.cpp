@@ -4,32 +4,88 @@
 
 #if defined(_WIN32)
 #    include <windows.h>
+#    ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#        define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#    endif
 #elif defined(__linux__) || defined(__SCE__) || defined(__APPLE__)
 #    include <time.h>
-#    ifdef USE_MONOTONIC_TIMER
-constexpr clockid_t CLOCKID = CLOCK_MONOTONIC;
-#    else
-constexpr clockid_t CLOCKID = CLOCK_REALTIME;
-#    endif
 #else
 #    error "Undefined platform"
 #endif
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    include <immintrin.h>
+#    define SPIN_PAUSE() _mm_pause()
+#else
+#    define SPIN_PAUSE()
+#endif
+
 #define MY_MIN(a, b) (a < b ? a : b)
 #define MY_MAX(a, b) (a > b ? a : b)
 
+constexpr uint32_t SUB_BUCKET_NUM = 1 << TIMER_HISTOGRAM_SUB_BITS;
+constexpr double SLEEP_MARGIN_MIN = 0.02; // ms
+constexpr double SLEEP_MARGIN_MAX = 16.0; // ms, "Sleep" granularity if there is no high resolution timer
+
 inline uint64_t _GetTicks() {
 #if defined(_WIN32)
     uint64_t ticks;
     QueryPerformanceCounter((LARGE_INTEGER*)&ticks);
     return ticks;
 #elif defined(__linux__) || defined(__SCE__) || defined(__APPLE__)
+    // "CLOCK_REALTIME" jumps and slews with NTP adjustments
     struct timespec spec;
-    clock_gettime(CLOCKID, &spec);
+    clock_gettime(CLOCK_MONOTONIC, &spec);
     return uint64_t(spec.tv_sec) * 1000000000ull + spec.tv_nsec;
 #endif
 }
 
+static void _Sleep(double ms, void*& waitableTimer) {
+#if defined(_WIN32)
+    // "Sleep" has the granularity of the system timer (up to 15.6 ms)
+    if (!waitableTimer)
+        waitableTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -LONGLONG(ms * 10000.0); // relative, 100 ns units
+
+    if (waitableTimer && SetWaitableTimerEx((HANDLE)waitableTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0))
+        WaitForSingleObject((HANDLE)waitableTimer, INFINITE);
+    else
+        Sleep(DWORD(ms));
+#else
+    (void)waitableTimer;
+
+    uint64_t ns = uint64_t(ms * 1000000.0);
+
+    struct timespec spec;
+    spec.tv_sec = time_t(ns / 1000000000ull);
+    spec.tv_nsec = long(ns % 1000000000ull);
+    nanosleep(&spec, nullptr);
+#endif
+}
+
+// Log-linear: values below "2 * SUB_BUCKET_NUM" us are exact, above - "SUB_BUCKET_NUM" buckets per power of 2
+static inline uint32_t _GetBucket(float ms) {
+    uint32_t us = uint32_t(MY_MIN(MY_MAX(ms, 0.0f) * 1000.0f, float((1u << TIMER_HISTOGRAM_MAX_BITS) - 1)));
+
+    uint32_t shift = 0;
+    while ((us >> shift) >= 2 * SUB_BUCKET_NUM)
+        shift++;
+
+    return shift * SUB_BUCKET_NUM + (us >> shift);
+}
+
+static inline double _GetBucketMiddle(uint32_t bucket) {
+    if (bucket < 2 * SUB_BUCKET_NUM)
+        return (bucket + 0.5) / 1000.0;
+
+    uint32_t shift = bucket / SUB_BUCKET_NUM - 1;
+    uint32_t mantissa = bucket - shift * SUB_BUCKET_NUM;
+
+    return (mantissa + 0.5) * double(1u << shift) / 1000.0;
+}
+
 Timer::Timer() {
 #if defined(_WIN32)
     uint64_t ticksPerSecond = 1;
@@ -41,21 +97,140 @@ Timer::Timer() {
 #endif
 }
 
+Timer::~Timer() {
+#if defined(_WIN32)
+    if (m_WaitableTimer)
+        CloseHandle((HANDLE)m_WaitableTimer);
+#endif
+}
+
 void Timer::UpdateFrameTime() {
-    if (m_Time != 0) {
-        double ms = (_GetTicks() - m_Time) * m_InvTicksPerMs;
-        m_Delta = float(ms);
+    // One read, the time between frames is not lost
+    uint64_t time = _GetTicks();
+    if (m_Time != 0)
+        AddFrameTime(float((time - m_Time) * m_InvTicksPerMs));
 
-        float relativeDelta = fabsf(m_Delta - m_SmoothedDelta) / (MY_MIN(m_Delta, m_SmoothedDelta) + 1e-7f);
-        float f = relativeDelta / (1.0f + relativeDelta);
+    m_Time = time;
+}
+
+void Timer::AddFrameTime(float ms) {
+    if (m_FrameNum != 0) {
+        if (ms > m_SmoothedDelta * TIMER_STUTTER_RATIO)
+            m_StutterNum++;
 
-        m_SmoothedDelta = m_SmoothedDelta + (m_Delta - m_SmoothedDelta) * MY_MAX(f, 1.0f / 32.0f);
-        m_VerySmoothedDelta = m_VerySmoothedDelta + (m_Delta - m_VerySmoothedDelta) * MY_MAX(f, 1.0f / 64.0f);
+        m_JitterSum += fabsf(ms - m_Delta);
+        m_FrameTimeMin = MY_MIN(m_FrameTimeMin, ms);
+        m_FrameTimeMax = MY_MAX(m_FrameTimeMax, ms);
+    } else {
+        m_FrameTimeMin = ms;
+        m_FrameTimeMax = ms;
     }
 
-    m_Time = _GetTicks();
+    m_Delta = ms;
+
+    float relativeDelta = fabsf(m_Delta - m_SmoothedDelta) / (MY_MIN(m_Delta, m_SmoothedDelta) + 1e-7f);
+    float f = relativeDelta / (1.0f + relativeDelta);
+
+    m_SmoothedDelta = m_SmoothedDelta + (m_Delta - m_SmoothedDelta) * MY_MAX(f, 1.0f / 32.0f);
+    m_VerySmoothedDelta = m_VerySmoothedDelta + (m_Delta - m_VerySmoothedDelta) * MY_MAX(f, 1.0f / 64.0f);
+
+    // Ring
+    uint64_t head = m_FrameTimeHead.load(std::memory_order_relaxed);
+    m_FrameTimes[head & (TIMER_FRAME_TIME_NUM - 1)].store(ms, std::memory_order_relaxed);
+    m_FrameTimeHead.store(head + 1, std::memory_order_release);
+
+    // Statistics
+    m_Histogram[_GetBucket(ms)]++;
+    m_FrameTimeSum += ms;
+    m_FrameNum++;
+}
+
+FrameTimeStats Timer::GetFrameTimeStats() const {
+    FrameTimeStats stats = {};
+    stats.frameNum = m_FrameNum;
+    stats.stutterNum = m_StutterNum;
+
+    if (!m_FrameNum)
+        return stats;
+
+    stats.mean = m_FrameTimeSum / m_FrameNum;
+    stats.min = m_FrameTimeMin;
+    stats.max = m_FrameTimeMax;
+    stats.jitter = m_FrameNum > 1 ? m_JitterSum / (m_FrameNum - 1) : 0.0;
+
+    // Nearest rank, bucket middles are clamped to the exact extremes
+    const double percentiles[] = {0.5, 0.9, 0.99, 0.999};
+    double* values[] = {&stats.p50, &stats.p90, &stats.p99, &stats.p999};
+
+    uint64_t count = 0;
+    uint32_t bucket = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        uint64_t rank = MY_MAX((uint64_t)ceil(percentiles[i] * m_FrameNum), 1ull);
+        for (; bucket < TIMER_HISTOGRAM_BUCKET_NUM; bucket++) {
+            if (count + m_Histogram[bucket] >= rank)
+                break;
+
+            count += m_Histogram[bucket];
+        }
+
+        double value = _GetBucketMiddle(bucket);
+        *values[i] = MY_MIN(MY_MAX(value, stats.min), stats.max);
+    }
+
+    return stats;
+}
+
+void Timer::ResetFrameTimeStats() {
+    for (uint32_t& bucket : m_Histogram)
+        bucket = 0;
+
+    m_FrameNum = 0;
+    m_StutterNum = 0;
+    m_FrameTimeSum = 0.0;
+    m_JitterSum = 0.0;
+}
+
+uint32_t Timer::GetFrameTimes(float* frameTimes, uint32_t maxNum) const {
+    uint64_t head = m_FrameTimeHead.load(std::memory_order_acquire);
+    uint32_t num = (uint32_t)MY_MIN(head, (uint64_t)MY_MIN(maxNum, TIMER_FRAME_TIME_NUM));
+
+    // The writer may overwrite the oldest values meanwhile, it's still a valid frame time
+    for (uint32_t i = 0; i < num; i++)
+        frameTimes[i] = m_FrameTimes[(head - num + i) & (TIMER_FRAME_TIME_NUM - 1)].load(std::memory_order_relaxed);
+
+    return num;
 }
 
 double Timer::GetTimeStamp() const {
     return _GetTicks() * m_InvTicksPerMs;
 }
+
+void Timer::SleepUntil(double timeStamp) {
+    double now = GetTimeStamp();
+    double sleepTime = timeStamp - now - m_SleepMargin;
+
+    if (sleepTime > 0.0) {
+        _Sleep(sleepTime, m_WaitableTimer);
+
+        // The margin follows the worst oversleep immediately and decays slowly
+        double oversleep = GetTimeStamp() - (now + sleepTime);
+        double margin = oversleep > m_SleepMargin ? oversleep : m_SleepMargin + (oversleep - m_SleepMargin) / 64.0;
+        m_SleepMargin = MY_MIN(MY_MAX(margin, SLEEP_MARGIN_MIN), SLEEP_MARGIN_MAX);
+    }
+
+    while (GetTimeStamp() < timeStamp)
+        SPIN_PAUSE();
+}
+
+void Timer::WaitForFrameLimit() {
+    if (m_FramePeriod == 0.0)
+        return;
+
+    double now = GetTimeStamp();
+    if (m_NextFrameTimeStamp == 0.0 || now > m_NextFrameTimeStamp + m_FramePeriod)
+        m_NextFrameTimeStamp = now;
+    else
+        SleepUntil(m_NextFrameTimeStamp);
+
+    m_NextFrameTimeStamp += m_FramePeriod;
+}
@@ -0,0 +1,204 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    define TRANSFORM_HIERARCHY_SSE // SSE2 is the baseline
+#    include <emmintrin.h>
+#endif
+
+// Column-major, same operation order as "glm::operator*" (no FMA)
+static inline void MultiplyMatrices(const mat4& a, const mat4& b, mat4& result) {
+    const float* pa = &a[0].x;
+    const float* pb = &b[0].x;
+    float* pr = &result[0].x;
+
+#ifdef TRANSFORM_HIERARCHY_SSE
+    __m128 a0 = _mm_loadu_ps(pa);
+    __m128 a1 = _mm_loadu_ps(pa + 4);
+    __m128 a2 = _mm_loadu_ps(pa + 8);
+    __m128 a3 = _mm_loadu_ps(pa + 12);
+
+    for (uint32_t j = 0; j < 4; j++) {
+        const float* column = pb + j * 4;
+        __m128 r = _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(column[0])), _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(column[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(column[3])));
+        _mm_storeu_ps(pr + j * 4, r);
+    }
+#else
+    float r[16];
+    for (uint32_t j = 0; j < 4; j++) {
+        const float* column = pb + j * 4;
+        for (uint32_t i = 0; i < 4; i++)
+            r[j * 4 + i] = pa[i] * column[0] + pa[4 + i] * column[1] + pa[8 + i] * column[2] + pa[12 + i] * column[3];
+    }
+
+    memcpy(pr, r, sizeof(r));
+#endif
+}
+
+// T * R * S
+static inline void ComposeTransform(const vec3& t, const vec4& q, const vec3& s, mat4& result) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    float* m = &result[0].x;
+    m[0] = (1.0f - 2.0f * (yy + zz)) * s.x;
+    m[1] = 2.0f * (xy + wz) * s.x;
+    m[2] = 2.0f * (xz - wy) * s.x;
+    m[3] = 0.0f;
+    m[4] = 2.0f * (xy - wz) * s.y;
+    m[5] = (1.0f - 2.0f * (xx + zz)) * s.y;
+    m[6] = 2.0f * (yz + wx) * s.y;
+    m[7] = 0.0f;
+    m[8] = 2.0f * (xz + wy) * s.z;
+    m[9] = 2.0f * (yz - wx) * s.z;
+    m[10] = (1.0f - 2.0f * (xx + yy)) * s.z;
+    m[11] = 0.0f;
+    m[12] = t.x;
+    m[13] = t.y;
+    m[14] = t.z;
+    m[15] = 1.0f;
+}
+
+void utils::TransformHierarchy::Build(SceneNode* const* roots, uint32_t rootNum) {
+    m_Parents.clear();
+    m_SceneNodes.clear();
+    m_LevelOffsets.clear();
+
+    // Breadth first: children of a node are adjacent, levels are contiguous
+    for (uint32_t i = 0; i < rootNum; i++) {
+        m_SceneNodes.push_back(roots[i]);
+        m_Parents.push_back(InvalidIndex);
+    }
+
+    uint32_t levelBegin = 0;
+    while (levelBegin < (uint32_t)m_SceneNodes.size()) {
+        uint32_t levelEnd = (uint32_t)m_SceneNodes.size();
+        m_LevelOffsets.push_back(levelBegin);
+
+        for (uint32_t i = levelBegin; i < levelEnd; i++) {
+            for (SceneNode* child : m_SceneNodes[i]->children) {
+                m_SceneNodes.push_back(child);
+                m_Parents.push_back(i);
+            }
+        }
+
+        levelBegin = levelEnd;
+    }
+    m_LevelOffsets.push_back(levelBegin);
+
+    size_t nodeNum = m_SceneNodes.size();
+    m_Translations.resize(nodeNum);
+    m_Rotations.resize(nodeNum);
+    m_Scales.resize(nodeNum);
+    m_LocalTransforms.resize(nodeNum);
+    m_WorldTransforms.resize(nodeNum);
+    m_IsDirty.assign(nodeNum, 1);
+    m_IsUpdated.assign(nodeNum, 0);
+
+    for (size_t i = 0; i < nodeNum; i++) {
+        const SceneNode& node = *m_SceneNodes[i];
+        m_Translations[i] = node.translation;
+        m_Rotations[i] = node.rotation;
+        m_Scales[i] = node.scale;
+    }
+}
+
+uint32_t utils::TransformHierarchy::FindNode(const SceneNode* node) const {
+    auto it = std::find(m_SceneNodes.begin(), m_SceneNodes.end(), node);
+
+    return it == m_SceneNodes.end() ? InvalidIndex : (uint32_t)(it - m_SceneNodes.begin());
+}
+
+void utils::TransformHierarchy::SetTranslation(uint32_t node, const vec3& translation) {
+    m_Translations[node] = translation;
+    m_IsDirty[node] = 1;
+}
+
+void utils::TransformHierarchy::SetRotation(uint32_t node, const vec4& rotation) {
+    m_Rotations[node] = rotation;
+    m_IsDirty[node] = 1;
+}
+
+void utils::TransformHierarchy::SetScale(uint32_t node, const vec3& scale) {
+    m_Scales[node] = scale;
+    m_IsDirty[node] = 1;
+}
+
+void utils::TransformHierarchy::UpdateRange(uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t parent = m_Parents[i];
+        bool isParentUpdated = parent != InvalidIndex && m_IsUpdated[parent];
+        bool isDirty = m_IsDirty[i] != 0;
+
+        m_IsUpdated[i] = isDirty || isParentUpdated;
+        if (!m_IsUpdated[i])
+            continue;
+
+        if (isDirty) {
+            ComposeTransform(m_Translations[i], m_Rotations[i], m_Scales[i], m_LocalTransforms[i]);
+            m_IsDirty[i] = 0;
+        }
+
+        MultiplyMatrices(parent == InvalidIndex ? m_SceneToWorld : m_WorldTransforms[parent], m_LocalTransforms[i], m_WorldTransforms[i]);
+    }
+}
+
+void utils::TransformHierarchy::Update(const mat4& sceneToWorld, TransformHierarchyStats& stats, uint32_t threadNum) {
+    Timer timer;
+    double begin = timer.GetTimeStamp();
+
+    uint32_t levelNum = GetLevelNum();
+    if (memcmp(&sceneToWorld, &m_SceneToWorld, sizeof(mat4)) != 0) {
+        m_SceneToWorld = sceneToWorld;
+
+        for (uint32_t i = 0; levelNum && i < m_LevelOffsets[1]; i++)
+            m_IsDirty[i] = 1;
+    }
+
+    for (uint32_t level = 0; level < levelNum; level++) {
+        uint32_t levelBegin = m_LevelOffsets[level];
+        uint32_t levelEnd = m_LevelOffsets[level + 1];
+
+        // Small levels (most of them in typical scenes) are updated faster than workers wake up
+        if (threadNum == 1 || levelEnd - levelBegin < TRANSFORM_HIERARCHY_PARALLEL_MIN_NUM) {
+            UpdateRange(levelBegin, levelEnd);
+            continue;
+        }
+
+        uint32_t blockNum = (levelEnd - levelBegin + TRANSFORM_HIERARCHY_BLOCK_SIZE - 1) / TRANSFORM_HIERARCHY_BLOCK_SIZE;
+        JobSystem::GetShared().ParallelFor(blockNum, threadNum, [&](uint32_t i) {
+            uint32_t blockBegin = levelBegin + i * TRANSFORM_HIERARCHY_BLOCK_SIZE;
+            UpdateRange(blockBegin, std::min(blockBegin + TRANSFORM_HIERARCHY_BLOCK_SIZE, levelEnd));
+        });
+    }
+
+    uint32_t updatedNum = 0;
+    for (uint8_t isUpdated : m_IsUpdated)
+        updatedNum += isUpdated;
+
+    stats.visitedNum += GetNodeNum();
+    stats.updatedNum += updatedNum;
+    stats.time += timer.GetTimeStamp() - begin;
+}
+
+void utils::TransformHierarchy::WriteBack() const {
+    for (size_t i = 0; i < m_SceneNodes.size(); i++) {
+        if (m_IsUpdated[i]) {
+            m_SceneNodes[i]->localTransform = m_LocalTransforms[i];
+            m_SceneNodes[i]->worldTransform = m_WorldTransforms[i];
+        }
+    }
+}
+
+void utils::UpdateSceneNodeTransforms(SceneNode& node, const mat4& parentTransform) {
+    ComposeTransform(node.translation, node.rotation, node.scale, node.localTransform);
+    node.worldTransform = parentTransform * node.localTransform;
+
+    for (SceneNode* child : node.children)
+        UpdateSceneNodeTransforms(*child, node.worldTransform);
+}
@@ -0,0 +1,133 @@
+#include "NRIFramework.h"
+
+#include <algorithm>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    define UI_GEOMETRY_SSE // SSE2 is the baseline
+#    include <emmintrin.h>
+#endif
+
+static_assert(sizeof(ImDrawVert) == 20, "Custom ImDrawVert layouts are not supported");
+
+// Bit exact with the SSE version
+static void RepackVerticesScalar(const ImDrawVert* src, utils::UiVertex* dst, uint32_t num) {
+    for (uint32_t i = 0; i < num; i++) {
+        const ImDrawVert& v = src[i];
+
+        uint16_t u = (uint16_t)(std::clamp(v.uv.x, 0.0f, 1.0f) * 65535.0f + 0.5f);
+        uint16_t w = (uint16_t)(std::clamp(v.uv.y, 0.0f, 1.0f) * 65535.0f + 0.5f);
+
+        utils::UiVertex& vertex = dst[i];
+        vertex.pos[0] = v.pos.x;
+        vertex.pos[1] = v.pos.y;
+        vertex.uv = ((uint32_t)w << 16) | u;
+        vertex.col = v.col;
+    }
+}
+
+#ifdef UI_GEOMETRY_SSE
+
+static void RepackVerticesSse(const ImDrawVert* src, utils::UiVertex* dst, uint32_t num) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(65535.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i bias = _mm_set1_epi32(32768);
+    const __m128i signFlip = _mm_set1_epi16((short)0x8000);
+
+    uint32_t i = 0;
+    for (; i + 4 <= num; i += 4) {
+        const ImDrawVert* v = src + i;
+
+        // "pos, uv" of each vertex, "col" is the last 4 bytes
+        __m128 v0 = _mm_loadu_ps(&v[0].pos.x);
+        __m128 v1 = _mm_loadu_ps(&v[1].pos.x);
+        __m128 v2 = _mm_loadu_ps(&v[2].pos.x);
+        __m128 v3 = _mm_loadu_ps(&v[3].pos.x);
+
+        __m128 uv01 = _mm_movehl_ps(v1, v0);
+        __m128 uv23 = _mm_movehl_ps(v3, v2);
+        uv01 = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(uv01, zero), one), scale), half);
+        uv23 = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(uv23, zero), one), scale), half);
+
+        // No unsigned saturation in SSE2: shift to the signed range, pack, shift back
+        __m128i uv = _mm_packs_epi32(_mm_sub_epi32(_mm_cvttps_epi32(uv01), bias), _mm_sub_epi32(_mm_cvttps_epi32(uv23), bias));
+        uv = _mm_xor_si128(uv, signFlip);
+
+        __m128i col = _mm_set_epi32((int32_t)v[3].col, (int32_t)v[2].col, (int32_t)v[1].col, (int32_t)v[0].col);
+        __m128i uvCol01 = _mm_unpacklo_epi32(uv, col);
+        __m128i uvCol23 = _mm_unpackhi_epi32(uv, col);
+
+        __m128i* out = (__m128i*)(dst + i);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi64(_mm_castps_si128(v0), uvCol01));
+        _mm_storeu_si128(out + 1, _mm_castpd_si128(_mm_shuffle_pd(_mm_castps_pd(v1), _mm_castsi128_pd(uvCol01), 2)));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi64(_mm_castps_si128(v2), uvCol23));
+        _mm_storeu_si128(out + 3, _mm_castpd_si128(_mm_shuffle_pd(_mm_castps_pd(v3), _mm_castsi128_pd(uvCol23), 2)));
+    }
+
+    RepackVerticesScalar(src + i, dst + i, num - i);
+}
+
+#endif
+
+void utils::GetUiGeometrySize(const ImDrawData& drawData, uint32_t& indexDataSize, uint32_t& vertexDataSize) {
+    indexDataSize = helper::Align(drawData.TotalIdxCount * (uint32_t)sizeof(ImDrawIdx), 16);
+    vertexDataSize = helper::Align(drawData.TotalVtxCount * (uint32_t)sizeof(UiVertex), 16);
+}
+
+void utils::RepackUiGeometry(const ImDrawData& drawData, uint8_t* dst, UiRepackStats& stats, bool disableSimd, uint32_t threadNum) {
+    Timer timer;
+    double begin = timer.GetTimeStamp();
+
+    uint32_t indexDataSize = 0;
+    uint32_t vertexDataSize = 0;
+    GetUiGeometrySize(drawData, indexDataSize, vertexDataSize);
+
+    ImDrawIdx* indices = (ImDrawIdx*)dst;
+    UiVertex* vertices = (UiVertex*)(dst + indexDataSize);
+
+    auto RepackVertices = RepackVerticesScalar;
+#ifdef UI_GEOMETRY_SSE
+    if (!disableSimd)
+        RepackVertices = RepackVerticesSse;
+#else
+    (void)disableSimd;
+#endif
+
+    uint32_t listNum = (uint32_t)drawData.CmdListsCount;
+    if (drawData.TotalVtxCount < (int32_t)UI_REPACK_PARALLEL_VERTEX_NUM || threadNum == 1 || listNum == 1) {
+        for (uint32_t n = 0; n < listNum; n++) {
+            const ImDrawList& drawList = *drawData.CmdLists[n];
+
+            RepackVertices(drawList.VtxBuffer.Data, vertices, (uint32_t)drawList.VtxBuffer.Size);
+            memcpy(indices, drawList.IdxBuffer.Data, drawList.IdxBuffer.Size * sizeof(ImDrawIdx));
+
+            vertices += drawList.VtxBuffer.Size;
+            indices += drawList.IdxBuffer.Size;
+        }
+    } else {
+        // Destinations of draw lists are known upfront, the lists are independent
+        std::vector<uint32_t> offsets(listNum * 2);
+        uint32_t vertexOffset = 0;
+        uint32_t indexOffset = 0;
+        for (uint32_t n = 0; n < listNum; n++) {
+            offsets[n * 2] = vertexOffset;
+            offsets[n * 2 + 1] = indexOffset;
+            vertexOffset += drawData.CmdLists[n]->VtxBuffer.Size;
+            indexOffset += drawData.CmdLists[n]->IdxBuffer.Size;
+        }
+
+        JobSystem::GetShared().ParallelFor(listNum, threadNum, [&](uint32_t n) {
+            const ImDrawList& drawList = *drawData.CmdLists[n];
+
+            RepackVertices(drawList.VtxBuffer.Data, vertices + offsets[n * 2], (uint32_t)drawList.VtxBuffer.Size);
+            memcpy(indices + offsets[n * 2 + 1], drawList.IdxBuffer.Data, drawList.IdxBuffer.Size * sizeof(ImDrawIdx));
+        });
+    }
+
+    stats.vertexNum += drawData.TotalVtxCount;
+    stats.byteNum += indexDataSize + vertexDataSize;
+    stats.time += timer.GetTimeStamp() - begin;
+    stats.frameNum++;
+}
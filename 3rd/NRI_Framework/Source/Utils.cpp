@@ -4,6 +4,7 @@
 
 #include <filesystem>
 #include <functional>
+#include <string.h>
 
 #include "Detex/detex.h"
 
@@ -326,6 +327,11 @@ utils::Texture::~Texture() {
 }
 
 void utils::Texture::GetSubresource(nri::TextureSubresourceUploadDesc& subresource, uint32_t mipIndex, uint32_t arrayIndex) const {
+    if (ktx2) {
+        ktx2->GetSubresource(subresource, mipIndex, arrayIndex);
+        return;
+    }
+
     // TODO: 3D images are not supported, "subresource.slices" needs to be allocated to store pointers to all slices of the current mipmap
     assert(GetDepth() == 1);
     (void)(arrayIndex); // TODO: unused
@@ -342,9 +348,62 @@ void utils::Texture::GetSubresource(nri::TextureSubresourceUploadDesc& subresour
 }
 
 bool utils::Texture::IsBlockCompressed() const {
+    if (ktx2)
+        return nri::nriGetFormatProps(format).blockWidth > 1;
+
     return detexFormatIsCompressed(ToMip(mips[0])->format);
 }
 
+bool utils::GenerateMips(Texture& texture) {
+    if (!texture.mips || texture.mipNum != 1 || texture.layerNum > 1 || (texture.format != nri::Format::RGBA8_UNORM && texture.format != nri::Format::RGBA8_SRGB))
+        return false;
+
+    uint32_t mipNum = 1;
+    while ((std::max(texture.width, texture.height) >> mipNum) != 0)
+        mipNum++;
+
+    // Allocated the detex way, "~Texture" frees them
+    detexTexture** chain = (detexTexture**)malloc(sizeof(detexTexture*) * mipNum);
+    chain[0] = ToMip(texture.mips[0]);
+    free(texture.mips);
+
+    // 2x2 box filter, the last row / column is repeated for odd sizes. sRGB is averaged as is (good enough for streaming)
+    for (uint32_t mip = 1; mip < mipNum; mip++) {
+        const detexTexture& src = *chain[mip - 1];
+        const int width = std::max(src.width >> 1, 1);
+        const int height = std::max(src.height >> 1, 1);
+
+        detexTexture* dst = (detexTexture*)malloc(sizeof(detexTexture));
+        dst->format = src.format;
+        dst->width = width;
+        dst->height = height;
+        dst->width_in_blocks = width;
+        dst->height_in_blocks = height;
+        dst->data = (uint8_t*)malloc(size_t(width) * height * 4);
+
+        for (int y = 0; y < height; y++) {
+            const uint8_t* row0 = src.data + size_t(std::min(y * 2, src.height - 1)) * src.width * 4;
+            const uint8_t* row1 = src.data + size_t(std::min(y * 2 + 1, src.height - 1)) * src.width * 4;
+            uint8_t* out = dst->data + size_t(y) * width * 4;
+
+            for (int x = 0; x < width; x++) {
+                const int x0 = std::min(x * 2, src.width - 1) * 4;
+                const int x1 = std::min(x * 2 + 1, src.width - 1) * 4;
+
+                for (int c = 0; c < 4; c++)
+                    out[x * 4 + c] = uint8_t((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+
+        chain[mip] = dst;
+    }
+
+    texture.mips = (Mip*)chain;
+    texture.mipNum = (uint8_t)mipNum;
+
+    return true;
+}
+
 const char* utils::GetFileName(const std::string& path) {
     const size_t slashPos = path.find_last_of("\\/");
     if (slashPos != std::string::npos)
@@ -515,13 +574,39 @@ bool utils::LoadTextureFromMemory(const std::string& name, const uint8_t* data,
     stbi_image_free(image);
 
     const int kMipNum = 1;
-    // PostProcessTexture(name, texture, computeAvgColorAndAlphaMode, dTexture, kMipNum);
+    PostProcessTexture(name, texture, computeAvgColorAndAlphaMode, dTexture, kMipNum);
     return true;
 }
 
 bool utils::LoadTexture(const std::string& path, Texture& texture, bool computeAvgColorAndAlphaMode) {
     printf("Loading texture '%s'...\n", GetFileName(path));
 
+    // The whole chain is read into one arena shared with "texture", the file is not needed after that
+    const char* ext = strrchr(path.c_str(), '.');
+    if (ext && (!strcmp(ext, ".ktx2") || !strcmp(ext, ".KTX2"))) {
+        std::shared_ptr<Ktx2Texture> ktx2 = std::make_shared<Ktx2Texture>();
+        if (!ktx2->Open(path) || !ktx2->Read())
+            return false;
+
+        if (ktx2->GetWidth() > UINT16_MAX || ktx2->GetHeight() > UINT16_MAX || ktx2->GetDepth() > UINT16_MAX || ktx2->GetLayerNum() > UINT16_MAX) {
+            printf("ERROR: Texture '%s' is too large!\n", GetFileName(path));
+            return false;
+        }
+
+        ktx2->CloseFile();
+
+        texture.ktx2 = ktx2;
+        texture.name = path;
+        texture.format = ktx2->GetFormat();
+        texture.width = (uint16_t)ktx2->GetWidth();
+        texture.height = (uint16_t)ktx2->GetHeight();
+        texture.depth = (uint16_t)ktx2->GetDepth();
+        texture.mipNum = (uint8_t)ktx2->GetMipNum();
+        texture.layerNum = (uint16_t)ktx2->GetLayerNum();
+
+        return true;
+    }
+
     detexTexture** dTexture = nullptr;
     int mipNum = 0;
 
@@ -0,0 +1,465 @@
+#include "NRIFramework.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#    define VERTEX_PACKING_SSE2
+#    include <emmintrin.h>
+#endif
+
+static_assert(sizeof(utils::UnpackedVertex) == 48, "SIMD path relies on the layout");
+static_assert(sizeof(utils::Vertex) == 28, "Unexpected packed vertex size");
+static_assert(sizeof(utils::CompactVertex) == 20, "Unexpected compact vertex size");
+
+constexpr float HALF_MAX = 65504.0f;
+
+struct VertexFormatInfo {
+    const char* name;
+    uint32_t stride;
+    utils::VertexNormalEncoding normalEncoding;
+    nri::Format positionFormat;
+    nri::Format uvFormat;
+    nri::Format normalFormat;
+    nri::Format tangentFormat;
+    uint32_t positionOffset;
+    uint32_t uvOffset;
+    uint32_t normalOffset;
+    uint32_t tangentOffset;
+};
+
+static const VertexFormatInfo g_VertexFormatInfos[] = {
+    {"unpacked", sizeof(utils::UnpackedVertex), utils::VertexNormalEncoding::FLOAT, nri::Format::RGB32_SFLOAT, nri::Format::RG32_SFLOAT, nri::Format::RGB32_SFLOAT, nri::Format::RGBA32_SFLOAT,
+        helper::GetOffsetOf(&utils::UnpackedVertex::pos), helper::GetOffsetOf(&utils::UnpackedVertex::uv), helper::GetOffsetOf(&utils::UnpackedVertex::N), helper::GetOffsetOf(&utils::UnpackedVertex::T)},
+    {"standard", sizeof(utils::Vertex), utils::VertexNormalEncoding::UNORM_10_10_10_2, nri::Format::RGB32_SFLOAT, nri::Format::RG32_SFLOAT, nri::Format::R10_G10_B10_A2_UNORM, nri::Format::R10_G10_B10_A2_UNORM,
+        helper::GetOffsetOf(&utils::Vertex::pos), helper::GetOffsetOf(&utils::Vertex::uv), helper::GetOffsetOf(&utils::Vertex::N), helper::GetOffsetOf(&utils::Vertex::T)},
+    {"compact", sizeof(utils::CompactVertex), utils::VertexNormalEncoding::OCTAHEDRAL, nri::Format::RGBA16_UNORM, nri::Format::RG16_SFLOAT, nri::Format::RG16_SNORM, nri::Format::R10_G10_B10_A2_UNORM,
+        helper::GetOffsetOf(&utils::CompactVertex::pos), helper::GetOffsetOf(&utils::CompactVertex::uv), helper::GetOffsetOf(&utils::CompactVertex::N), helper::GetOffsetOf(&utils::CompactVertex::T)},
+};
+
+static_assert(helper::GetCountOf(g_VertexFormatInfos) == (uint32_t)utils::VertexFormat::MAX_NUM, "Vertex format info mismatch");
+
+//==================================================================================================================
+// Scalar (reference)
+//==================================================================================================================
+
+// Round-to-nearest-even, bit exact with the SSE2 version (F. Giesen, "float_to_half_fast3_rtne")
+static uint16_t FloatToHalf(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+
+    uint32_t sign = x & 0x80000000u;
+    x ^= sign;
+
+    uint32_t h;
+    if (x >= ((127 + 16) << 23)) // overflow, Inf or NaN
+        h = x > 0x7F800000u ? 0x7E00 : 0x7C00;
+    else if (x < ((127 - 14) << 23)) { // subnormal or zero
+        const uint32_t magicBits = ((127 - 15) + (23 - 10) + 1) << 23;
+
+        float magic, t;
+        memcpy(&magic, &magicBits, sizeof(magic));
+        memcpy(&t, &x, sizeof(t));
+
+        t += magic;
+        memcpy(&h, &t, sizeof(h));
+        h -= magicBits;
+    } else {
+        uint32_t mantissaOdd = (x >> 13) & 1;
+        x += (uint32_t(15 - 127) << 23) + 0xFFF;
+        x += mantissaOdd;
+        h = x >> 13;
+    }
+
+    return uint16_t(h | (sign >> 16));
+}
+
+static inline float Saturate(float x) {
+    return std::min(std::max(x, 0.0f), 1.0f);
+}
+
+static uint32_t PackUnorm10_10_10_2(float x, float y, float z, float w) {
+    uint32_t r = (uint32_t)lrintf(Saturate(x) * 1023.0f);
+    uint32_t g = (uint32_t)lrintf(Saturate(y) * 1023.0f);
+    uint32_t b = (uint32_t)lrintf(Saturate(z) * 1023.0f);
+    uint32_t a = (uint32_t)lrintf(Saturate(w) * 3.0f);
+
+    return r | (g << 10) | (b << 20) | (a << 30);
+}
+
+static void EncodeOctahedral(const float* n, int16_t* oct) {
+    float invL1 = 1.0f / std::max(fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]), 1e-20f);
+    float x = n[0] * invL1;
+    float y = n[1] * invL1;
+
+    // Lower hemisphere is folded over the diagonals
+    if (n[2] < 0.0f) {
+        float wx = (1.0f - fabsf(y)) * copysignf(1.0f, x);
+        float wy = (1.0f - fabsf(x)) * copysignf(1.0f, y);
+        x = wx;
+        y = wy;
+    }
+
+    oct[0] = (int16_t)lrintf(std::min(std::max(x, -1.0f), 1.0f) * 32767.0f);
+    oct[1] = (int16_t)lrintf(std::min(std::max(y, -1.0f), 1.0f) * 32767.0f);
+}
+
+static void ComputeDecodeParams(utils::VertexFormat format, const utils::UnpackedVertex* src, uint32_t vertexNum, utils::VertexDecodeParams& params, float* invExtent) {
+    const VertexFormatInfo& info = g_VertexFormatInfos[(uint32_t)format];
+    params.normalEncoding = info.normalEncoding;
+    params.stride = info.stride;
+
+    for (uint32_t i = 0; i < 3; i++) {
+        params.positionScale[i] = 1.0f;
+        params.positionBias[i] = 0.0f;
+        invExtent[i] = 0.0f;
+    }
+
+    if (format != utils::VertexFormat::COMPACT || !vertexNum)
+        return;
+
+    // Positions are quantized relative to the mesh AABB
+    float aabbMin[3] = {src[0].pos[0], src[0].pos[1], src[0].pos[2]};
+    float aabbMax[3] = {src[0].pos[0], src[0].pos[1], src[0].pos[2]};
+    for (uint32_t i = 1; i < vertexNum; i++) {
+        for (uint32_t j = 0; j < 3; j++) {
+            aabbMin[j] = std::min(aabbMin[j], src[i].pos[j]);
+            aabbMax[j] = std::max(aabbMax[j], src[i].pos[j]);
+        }
+    }
+
+    for (uint32_t i = 0; i < 3; i++) {
+        float extent = aabbMax[i] - aabbMin[i];
+        params.positionScale[i] = extent; // UNORM16 is expanded to [0; 1] by the input assembler
+        params.positionBias[i] = aabbMin[i];
+        invExtent[i] = extent > 0.0f ? 1.0f / extent : 0.0f;
+    }
+}
+
+static void PackVertexScalar(utils::VertexFormat format, const utils::UnpackedVertex& v, const float* bias, const float* invExtent, uint8_t* dst) {
+    if (format == utils::VertexFormat::UNPACKED) {
+        memcpy(dst, &v, sizeof(v));
+        return;
+    }
+
+    uint32_t T = PackUnorm10_10_10_2(v.T[0] * 0.5f + 0.5f, v.T[1] * 0.5f + 0.5f, v.T[2] * 0.5f + 0.5f, v.T[3] * 0.5f + 0.5f);
+
+    if (format == utils::VertexFormat::STANDARD) {
+        utils::Vertex& out = *(utils::Vertex*)dst;
+        memcpy(out.pos, v.pos, sizeof(out.pos));
+        out.uv = vec2(v.uv[0], v.uv[1]);
+        out.N = PackUnorm10_10_10_2(v.N[0] * 0.5f + 0.5f, v.N[1] * 0.5f + 0.5f, v.N[2] * 0.5f + 0.5f, 0.0f);
+        out.T = T;
+    } else {
+        utils::CompactVertex& out = *(utils::CompactVertex*)dst;
+        for (uint32_t i = 0; i < 3; i++)
+            out.pos[i] = (uint16_t)lrintf(Saturate((v.pos[i] - bias[i]) * invExtent[i]) * 65535.0f);
+        out.pos[3] = 0;
+        out.uv[0] = FloatToHalf(std::min(std::max(v.uv[0], -HALF_MAX), HALF_MAX));
+        out.uv[1] = FloatToHalf(std::min(std::max(v.uv[1], -HALF_MAX), HALF_MAX));
+        EncodeOctahedral(v.N, out.N);
+        out.T = T;
+    }
+}
+
+utils::VertexDecodeParams utils::PackVerticesScalar(VertexFormat format, const UnpackedVertex* src, uint32_t vertexNum, void* dst) {
+    VertexDecodeParams params = {};
+    float invExtent[3];
+    ComputeDecodeParams(format, src, vertexNum, params, invExtent);
+
+    uint8_t* out = (uint8_t*)dst;
+    for (uint32_t i = 0; i < vertexNum; i++)
+        PackVertexScalar(format, src[i], params.positionBias, invExtent, out + i * params.stride);
+
+    return params;
+}
+
+//==================================================================================================================
+// SSE2
+//==================================================================================================================
+
+#ifdef VERTEX_PACKING_SSE2
+
+static inline __m128 Saturate4(__m128 x) {
+    return _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+static inline __m128i PackUnorm10_10_10_2(__m128 x, __m128 y, __m128 z, __m128 w) {
+    const __m128 scale10 = _mm_set1_ps(1023.0f);
+
+    __m128i r = _mm_cvtps_epi32(_mm_mul_ps(Saturate4(x), scale10));
+    __m128i g = _mm_cvtps_epi32(_mm_mul_ps(Saturate4(y), scale10));
+    __m128i b = _mm_cvtps_epi32(_mm_mul_ps(Saturate4(z), scale10));
+    __m128i a = _mm_cvtps_epi32(_mm_mul_ps(Saturate4(w), _mm_set1_ps(3.0f)));
+
+    return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 10)), _mm_or_si128(_mm_slli_epi32(b, 20), _mm_slli_epi32(a, 30)));
+}
+
+// See scalar "FloatToHalf", results are in the low 16 bits of each lane
+static inline __m128i FloatToHalf(__m128 f) {
+    const __m128i f16max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i subnormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+
+    __m128 sign = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32((int32_t)0x80000000)));
+    __m128 absf = _mm_xor_ps(f, sign);
+    __m128i absi = _mm_castps_si128(absf);
+
+    __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+    __m128i isRegular = _mm_cmpgt_epi32(f16max, absi);
+    __m128i infOrNan = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+
+    __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absi);
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absf, _mm_castsi128_ps(subnormMagic))), subnormMagic);
+
+    __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absi, 31 - 13), 31);
+    __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absi, normalBias), mantissaOdd), 13);
+
+    __m128i nonSpecial = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+    __m128i result = _mm_or_si128(_mm_and_si128(isRegular, nonSpecial), _mm_andnot_si128(isRegular, infOrNan));
+
+    return _mm_or_si128(result, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+static inline __m128 ClampSigned(__m128 x) {
+    return _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+}
+
+static inline __m128 Abs(__m128 x) {
+    return _mm_andnot_ps(_mm_castsi128_ps(_mm_set1_epi32((int32_t)0x80000000)), x);
+}
+
+static inline __m128 SignOrOne(__m128 x) { // copysign(1, x)
+    __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int32_t)0x80000000));
+    return _mm_or_ps(_mm_and_ps(x, signMask), _mm_set1_ps(1.0f));
+}
+
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// "dst" gets 4 vertices, "src" must have 4 readable vertices
+static void PackVertices4(utils::VertexFormat format, const utils::UnpackedVertex* src, const float* bias, const float* invExtent, uint8_t* dst) {
+    if (format == utils::VertexFormat::UNPACKED) {
+        memcpy(dst, src, 4 * sizeof(utils::UnpackedVertex));
+        return;
+    }
+
+    // AoS => SoA: {x y z u}, {v nx ny nz}, {tx ty tz tw}
+    const float* s = src[0].pos;
+    __m128 X = _mm_loadu_ps(s), Y = _mm_loadu_ps(s + 12), Z = _mm_loadu_ps(s + 24), U = _mm_loadu_ps(s + 36);
+    __m128 V = _mm_loadu_ps(s + 4), NX = _mm_loadu_ps(s + 16), NY = _mm_loadu_ps(s + 28), NZ = _mm_loadu_ps(s + 40);
+    __m128 TX = _mm_loadu_ps(s + 8), TY = _mm_loadu_ps(s + 20), TZ = _mm_loadu_ps(s + 32), TW = _mm_loadu_ps(s + 44);
+    _MM_TRANSPOSE4_PS(X, Y, Z, U);
+    _MM_TRANSPOSE4_PS(V, NX, NY, NZ);
+    _MM_TRANSPOSE4_PS(TX, TY, TZ, TW);
+
+    const __m128 half = _mm_set1_ps(0.5f);
+    __m128i T = PackUnorm10_10_10_2(_mm_add_ps(_mm_mul_ps(TX, half), half), _mm_add_ps(_mm_mul_ps(TY, half), half),
+        _mm_add_ps(_mm_mul_ps(TZ, half), half), _mm_add_ps(_mm_mul_ps(TW, half), half));
+
+    if (format == utils::VertexFormat::STANDARD) {
+        __m128i N = PackUnorm10_10_10_2(_mm_add_ps(_mm_mul_ps(NX, half), half), _mm_add_ps(_mm_mul_ps(NY, half), half),
+            _mm_add_ps(_mm_mul_ps(NZ, half), half), _mm_setzero_ps());
+
+        alignas(16) uint32_t n[4], t[4];
+        _mm_store_si128((__m128i*)n, N);
+        _mm_store_si128((__m128i*)t, T);
+
+        for (uint32_t i = 0; i < 4; i++) {
+            utils::Vertex& out = ((utils::Vertex*)dst)[i];
+            memcpy(out.pos, src[i].pos, sizeof(float) * 5); // pos + uv
+            out.N = n[i];
+            out.T = t[i];
+        }
+
+        return;
+    }
+
+    // Positions
+    const __m128 scale16 = _mm_set1_ps(65535.0f);
+    __m128i qx = _mm_cvtps_epi32(_mm_mul_ps(Saturate4(_mm_mul_ps(_mm_sub_ps(X, _mm_set1_ps(bias[0])), _mm_set1_ps(invExtent[0]))), scale16));
+    __m128i qy = _mm_cvtps_epi32(_mm_mul_ps(Saturate4(_mm_mul_ps(_mm_sub_ps(Y, _mm_set1_ps(bias[1])), _mm_set1_ps(invExtent[1]))), scale16));
+    __m128i qz = _mm_cvtps_epi32(_mm_mul_ps(Saturate4(_mm_mul_ps(_mm_sub_ps(Z, _mm_set1_ps(bias[2])), _mm_set1_ps(invExtent[2]))), scale16));
+
+    // UVs
+    const __m128 halfMax = _mm_set1_ps(HALF_MAX);
+    __m128i hu = FloatToHalf(_mm_min_ps(_mm_max_ps(U, _mm_sub_ps(_mm_setzero_ps(), halfMax)), halfMax));
+    __m128i hv = FloatToHalf(_mm_min_ps(_mm_max_ps(V, _mm_sub_ps(_mm_setzero_ps(), halfMax)), halfMax));
+
+    // Octahedral normals
+    __m128 invL1 = _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(_mm_add_ps(_mm_add_ps(Abs(NX), Abs(NY)), Abs(NZ)), _mm_set1_ps(1e-20f)));
+    __m128 ox = _mm_mul_ps(NX, invL1);
+    __m128 oy = _mm_mul_ps(NY, invL1);
+    __m128 isLower = _mm_cmplt_ps(NZ, _mm_setzero_ps());
+    __m128 wx = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), Abs(oy)), SignOrOne(ox));
+    __m128 wy = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), Abs(ox)), SignOrOne(oy));
+    ox = Select(isLower, wx, ox);
+    oy = Select(isLower, wy, oy);
+
+    __m128i nx = _mm_cvtps_epi32(_mm_mul_ps(ClampSigned(ox), _mm_set1_ps(32767.0f)));
+    __m128i ny = _mm_cvtps_epi32(_mm_mul_ps(ClampSigned(oy), _mm_set1_ps(32767.0f)));
+
+    // 5 dwords per vertex
+    const __m128i low16 = _mm_set1_epi32(0xFFFF);
+    __m128 d0 = _mm_castsi128_ps(_mm_or_si128(qx, _mm_slli_epi32(qy, 16)));
+    __m128 d1 = _mm_castsi128_ps(qz);
+    __m128 d2 = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(hu, low16), _mm_slli_epi32(hv, 16)));
+    __m128 d3 = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(nx, low16), _mm_slli_epi32(ny, 16)));
+    _MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+
+    alignas(16) uint32_t t[4];
+    _mm_store_si128((__m128i*)t, T);
+
+    _mm_storeu_ps((float*)(dst + 0 * sizeof(utils::CompactVertex)), d0);
+    _mm_storeu_ps((float*)(dst + 1 * sizeof(utils::CompactVertex)), d1);
+    _mm_storeu_ps((float*)(dst + 2 * sizeof(utils::CompactVertex)), d2);
+    _mm_storeu_ps((float*)(dst + 3 * sizeof(utils::CompactVertex)), d3);
+
+    for (uint32_t i = 0; i < 4; i++)
+        ((utils::CompactVertex*)dst)[i].T = t[i];
+}
+
+#endif
+
+utils::VertexDecodeParams utils::PackVertices(VertexFormat format, const UnpackedVertex* src, uint32_t vertexNum, void* dst) {
+#ifdef VERTEX_PACKING_SSE2
+    VertexDecodeParams params = {};
+    float invExtent[3];
+    ComputeDecodeParams(format, src, vertexNum, params, invExtent);
+
+    uint8_t* out = (uint8_t*)dst;
+    uint32_t i = 0;
+    for (; i + 4 <= vertexNum; i += 4)
+        PackVertices4(format, src + i, params.positionBias, invExtent, out + i * params.stride);
+
+    // Tail goes through a padded copy to keep results identical
+    if (i < vertexNum) {
+        UnpackedVertex tail[4] = {};
+        uint8_t packed[4 * sizeof(UnpackedVertex)];
+        uint32_t tailNum = vertexNum - i;
+
+        memcpy(tail, src + i, tailNum * sizeof(UnpackedVertex));
+        PackVertices4(format, tail, params.positionBias, invExtent, packed);
+        memcpy(out + i * params.stride, packed, tailNum * params.stride);
+    }
+
+    return params;
+#else
+    return PackVerticesScalar(format, src, vertexNum, dst);
+#endif
+}
+
+//==================================================================================================================
+// Misc
+//==================================================================================================================
+
+utils::VertexDecodeParams utils::GetVertexDecodeParams(VertexFormat format, const UnpackedVertex* src, uint32_t vertexNum) {
+    VertexDecodeParams params = {};
+    float invExtent[3];
+    ComputeDecodeParams(format, src, vertexNum, params, invExtent);
+
+    return params;
+}
+
+utils::VertexFormat utils::SelectVertexFormat(const UnpackedVertex* src, uint32_t vertexNum, float maxPositionError, float maxUvError) {
+    if (!vertexNum)
+        return VertexFormat::COMPACT;
+
+    float aabbMin[3] = {src[0].pos[0], src[0].pos[1], src[0].pos[2]};
+    float aabbMax[3] = {src[0].pos[0], src[0].pos[1], src[0].pos[2]};
+    float uvMax = 0.0f;
+    for (uint32_t i = 0; i < vertexNum; i++) {
+        for (uint32_t j = 0; j < 3; j++) {
+            aabbMin[j] = std::min(aabbMin[j], src[i].pos[j]);
+            aabbMax[j] = std::max(aabbMax[j], src[i].pos[j]);
+        }
+
+        uvMax = std::max(uvMax, std::max(fabsf(src[i].uv[0]), fabsf(src[i].uv[1])));
+    }
+
+    // UNORM16 rounding: half a step of the extent
+    float positionError = 0.0f;
+    for (uint32_t i = 0; i < 3; i++)
+        positionError = std::max(positionError, (aabbMax[i] - aabbMin[i]) * (0.5f / 65535.0f));
+
+    // FLOAT16 rounding: half an ULP at the largest magnitude (10 mantissa bits, subnormals below 2^-14)
+    int exponent = 0;
+    frexpf(std::max(uvMax, 1.0f / 16384.0f), &exponent);
+    float uvError = ldexpf(0.5f, exponent - 1 - 10);
+
+    return positionError <= maxPositionError && uvError <= maxUvError ? VertexFormat::COMPACT : VertexFormat::STANDARD;
+}
+
+const char* utils::GetVertexFormatName(VertexFormat format) {
+    return g_VertexFormatInfos[(uint32_t)format].name;
+}
+
+uint32_t utils::GetVertexStride(VertexFormat format) {
+    return g_VertexFormatInfos[(uint32_t)format].stride;
+}
+
+uint32_t utils::GetVertexAttributes(VertexFormat format, nri::VertexAttributeDesc* attributes, bool withTangent) {
+    const VertexFormatInfo& info = g_VertexFormatInfos[(uint32_t)format];
+
+    const char* semantics[] = {"POSITION", "TEXCOORD", "NORMAL", "TANGENT"};
+    const nri::Format formats[] = {info.positionFormat, info.uvFormat, info.normalFormat, info.tangentFormat};
+    const uint32_t offsets[] = {info.positionOffset, info.uvOffset, info.normalOffset, info.tangentOffset};
+
+    uint32_t attributeNum = withTangent ? 4 : 3;
+    for (uint32_t i = 0; i < attributeNum; i++) {
+        nri::VertexAttributeDesc& attribute = attributes[i];
+        attribute = {};
+        attribute.d3d = {semantics[i], 0};
+        attribute.vk.location = {i};
+        attribute.offset = offsets[i];
+        attribute.format = formats[i];
+        attribute.streamIndex = 0;
+    }
+
+    return attributeNum;
+}
+
+utils::VertexFetchStats utils::EstimateVertexFetch(const Index* indices, uint32_t indexNum, uint32_t vertexStride) {
+    constexpr uint32_t VERTEX_CACHE_SIZE = 32;
+    constexpr uint32_t LINE_SIZE = 64;
+    constexpr uint32_t LINE_NUM = 16 * 1024 / LINE_SIZE;
+
+    VertexFetchStats stats = {};
+
+    uint32_t vertexCache[VERTEX_CACHE_SIZE];
+    uint32_t vertexCachePos = 0;
+    for (uint32_t& entry : vertexCache)
+        entry = InvalidIndex;
+
+    std::vector<uint64_t> lines(LINE_NUM, uint64_t(-1));
+
+    for (uint32_t i = 0; i < indexNum; i++) {
+        uint32_t index = indices[i];
+
+        bool isHit = false;
+        for (uint32_t entry : vertexCache)
+            isHit |= entry == index;
+
+        if (isHit)
+            continue;
+
+        vertexCache[vertexCachePos] = index;
+        vertexCachePos = (vertexCachePos + 1) % VERTEX_CACHE_SIZE;
+        stats.vertexCacheMissNum++;
+
+        uint64_t begin = uint64_t(index) * vertexStride / LINE_SIZE;
+        uint64_t end = (uint64_t(index) * vertexStride + vertexStride - 1) / LINE_SIZE;
+        for (uint64_t line = begin; line <= end; line++) {
+            uint64_t& slot = lines[line % LINE_NUM];
+            if (slot != line) {
+                slot = line;
+                stats.lineMissNum++;
+                stats.fetchedBytes += LINE_SIZE;
+            }
+        }
+    }
+
+    return stats;
+}
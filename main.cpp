@@ -10,11 +10,6 @@
 // STB
 #include "stb_image.h"
 
-// ASSIMP
-#include <assimp/cimport.h>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-#include <assimp/version.h>
 #include <vector>
 
 #define TINYDDSLOADER_IMPLEMENTATION
@@ -25,22 +20,54 @@
 constexpr uint32_t VIEW_MASK = 0b11;
 constexpr nri::Color32f COLOR_0 = { 1.0f, 1.0f, 0.0f, 1.0f };
 constexpr nri::Color32f COLOR_1 = { 0.46f, 0.72f, 0.0f, 1.0f };
+constexpr uint32_t TEXTURE_TABLE_SIZE = 256; // bindless material textures
 struct ConstantBufferLayout {
 	glm::mat4 modelMat;
 	glm::mat4 viewMat;
 	glm::mat4 projectMat;
+	glm::mat4 normalMat;
+	glm::vec4 positionScale; // .w - normal encoding
+	glm::vec4 positionBias;
 };
 
-struct Vertex {
-	vec3 position;
-	vec2 uv;
-	vec3 normal;
-	Vertex(vec3 pos, vec2 uv, vec3 nor) :
-			position(pos), uv(uv), normal(nor) {}
+struct MeshRootConstants {
+	glm::vec4 cameraPos; // .w - unused
+	uint32_t visibleOffset; // LOD region in the visible instance buffer
+	uint32_t baseColorTexture; // in the bindless texture table
 };
 
 static uint32_t g_indexCount = 0;
 
+// Indirect arguments of the LODs before culling: "DrawIndexedDesc" with "instanceNum = 0" + draw count = 0
+static std::vector<uint32_t> GetIndirectArgs(const std::vector<utils::MeshLod> &lods) {
+	std::vector<uint32_t> indirectArgs(lods.size() * utils::GPU_CULLING_ARGS_NUM, 0);
+	for (size_t i = 0; i < lods.size(); i++) {
+		indirectArgs[i * utils::GPU_CULLING_ARGS_NUM] = lods[i].indexNum;
+		indirectArgs[i * utils::GPU_CULLING_ARGS_NUM + 2] = lods[i].indexOffset; // "baseIndex"
+	}
+
+	return indirectArgs;
+}
+
+// Memory pressure: the texture residency budget shrinks to the resident size minus the requested size, i.e. the least
+// recently used top mips go in the next "Update". Their textures get recreated without them, the memory is freed
+// "BUFFERED_FRAME_MAX_NUM" frames later and only then "Resize(allocatedSize)" lowers the tracked usage (the returned
+// size is a promise). The budget is restored once the pressure is gone
+static uint64_t ReleaseTextureMips(const utils::MemoryPressure &pressure, void *userArg) {
+	TextureResidencyManager &textureResidency = *(TextureResidencyManager *)userArg;
+
+	if (!pressure.releaseSize) {
+		textureResidency.SetMemoryBudget(TextureResidencyDesc().memoryBudget);
+		return 0;
+	}
+
+	const uint64_t residentSize = std::min(textureResidency.GetStats().residentSize, textureResidency.GetMemoryBudget());
+	const uint64_t releaseSize = std::min(pressure.releaseSize, residentSize);
+	textureResidency.SetMemoryBudget(residentSize - releaseSize);
+
+	return releaseSize;
+}
+
 struct Frame {
 	nri::CommandAllocator *commandAllocator;
 	nri::CommandBuffer *commandBuffer;
@@ -49,6 +76,11 @@ struct Frame {
 	nri::Descriptor *constantBufferView;
 	nri::DescriptorSet *constantBufferDescriptorSet;
 	uint64_t constantBufferViewOffset;
+	nri::Descriptor *cullingConstantBufferView;
+	uint64_t cullingConstantBufferViewOffset;
+	nri::Descriptor *instanceUpdateView;
+	nri::DescriptorSet *instanceUpdateDescriptorSet;
+	uint64_t instanceUpdateViewOffset;
 };
 
 class Sample : public SampleBase {
@@ -57,11 +89,18 @@ public:
 
 	~Sample();
 
+	void InitCmdLine(cmdline::parser &cmdLine) override;
+	void ReadCmdLine(cmdline::parser &cmdLine) override;
 	bool Initialize(nri::GraphicsAPI graphicsAPI) override;
 	void PrepareFrame(uint32_t frameIndex) override;
 	void RenderFrame(uint32_t frameIndex) override;
 
 private:
+	// Used for drawing, texture streaming must see the same FOV
+	glm::mat4 GetViewToClip() const {
+		return glm::perspectiveLH_ZO(glm::radians(m_Fov), 900.f / 600.f, 0.1f, 100.0f);
+	}
+
 	NRIInterface NRI = {};
 	nri::Device *m_Device = nullptr;
 	nri::Streamer *m_Streamer = nullptr;
@@ -72,35 +111,61 @@ private:
 	nri::Fence *m_ComputeFence = nullptr;
 	nri::DescriptorPool *m_DescriptorPool = nullptr;
 	nri::PipelineLayout *m_PipelineLayout = nullptr;
-	nri::Pipeline *m_Pipeline = nullptr;
+	std::array<nri::Pipeline *, (size_t)utils::VertexFormat::MAX_NUM> m_Pipelines = {}; // per vertex format
 	nri::PipelineLayout *m_SkyPipelineLayout = nullptr;
 	nri::PipelineLayout *m_GridPipelineLayout = nullptr;
 	nri::PipelineLayout *m_ComputePipelineLayout = nullptr;
+	nri::PipelineLayout *m_HiZPipelineLayout = nullptr;
+	nri::PipelineLayout *m_ScatterPipelineLayout = nullptr;
 	nri::Pipeline *m_SkyPipeline = nullptr;
 	nri::Pipeline *m_GridPipeline = nullptr;
 	nri::Pipeline *m_ComputePipeline = nullptr;
+	nri::Pipeline *m_HiZPipeline = nullptr;
+	nri::Pipeline *m_ScatterPipeline = nullptr;
 	nri::Pipeline *m_PipelineMultiview = nullptr;
 	nri::DescriptorSet *m_TextureDescriptorSet = nullptr;
 	nri::DescriptorSet *m_BufferDescriptorSet = nullptr;
 	nri::DescriptorSet *m_SkyTextureDescriptorSet = nullptr;
 	nri::DescriptorSet *m_ComputeBufferDescriptorSet = nullptr;
-	nri::Descriptor *m_TextureShaderResource = nullptr;
+	std::vector<nri::DescriptorSet *> m_HiZDescriptorSets;
+	BindlessTextureTable m_TextureTable;
+	uint32_t m_BaseColorTexture = utils::InvalidIndex; // in "m_TextureTable"
 	nri::Descriptor *m_HDRTextureShaderResource = nullptr;
 	nri::Descriptor *m_CubemapTextureShaderResource = nullptr;
 	nri::Descriptor *m_DepthAttachment = nullptr;
 	nri::Descriptor *m_Sampler = nullptr;
 	nri::Descriptor *m_CubeSampler = nullptr;
-	nri::Descriptor *m_PosStorageShaderResource = nullptr;
 	nri::Descriptor *m_MatrixStorageShaderResource = nullptr;
 	nri::Descriptor *m_MatrixStorageBufferSRV = nullptr;
+	nri::Descriptor *m_VisibleInstanceStorage = nullptr;
+	nri::Descriptor *m_VisibleInstanceShaderResource = nullptr;
+	nri::Descriptor *m_IndirectArgsStorage = nullptr;
+	nri::Descriptor *m_DepthShaderResource = nullptr;
+	nri::Descriptor *m_HiZShaderResource = nullptr;
+	std::vector<nri::Descriptor *> m_HiZMipShaderResources;
+	std::vector<nri::Descriptor *> m_HiZMipStorages;
 	nri::Buffer *m_ConstantBuffer = nullptr;
 	nri::Buffer *m_GeometryBuffer = nullptr;
-	nri::Buffer *m_PositionStorageBuffer = nullptr;
 	nri::Buffer *m_MatrixStorageBuffer = nullptr;
-	nri::Texture *m_Texture = nullptr;
+	nri::Buffer *m_VisibleInstanceBuffer = nullptr;
+	nri::Buffer *m_IndirectBuffer = nullptr;
+	nri::Buffer *m_IndirectResetBuffer = nullptr;
+	nri::Buffer *m_ReadbackBuffer = nullptr;
+	nri::Buffer *m_InstanceUpdateBuffer = nullptr;
 	nri::Texture *m_HDRTexture = nullptr;
 	nri::Texture *m_CubemapTexture = nullptr;
 	nri::Texture *m_DepthTexture = nullptr;
+	nri::Texture *m_HiZTexture = nullptr;
+
+	utils::Texture m_TextureData; // kept alive for streaming
+	TextureResidencyManager m_TextureResidency; // owns the GPU texture
+	uint32_t m_TextureResidencyIndex = 0;
+
+	utils::MemoryGovernor m_MemoryGovernor;
+	uint32_t m_TextureMemory = 0; // governor handles
+	uint32_t m_StreamerMemory = 0;
+	uint64_t m_StreamerPeakFrameSize = 0;
+	uint32_t m_MemoryBudget = 0; // MB
 
 	std::array<Frame, BUFFERED_FRAME_MAX_NUM> m_Frames = {};
 	std::vector<BackBuffer> m_SwapChainBuffers;
@@ -114,6 +179,30 @@ private:
 	vec4 skyParams;
 
 	Renderer *testRenderPtr;
+	bool m_SerialLoading = false;
+	utils::VertexFormat m_ForcedVertexFormat = utils::VertexFormat::MAX_NUM; // "auto" - meshes use "Mesh::vertexFormat"
+	utils::VertexFormat m_MeshVertexFormat = utils::VertexFormat::STANDARD; // of the drawn mesh
+	utils::VertexDecodeParams m_VertexDecodeParams = {};
+	nri::IndexType m_IndexType = nri::IndexType::UINT32;
+	bool m_VerifyCulling = false;
+	bool m_FrustumCulling = true;
+	bool m_OcclusionCulling = true;
+	bool m_ShowCpuProfiler = false;
+	utils::GpuProfiler m_GpuProfiler; // graphics queue
+	utils::GpuProfiler m_GpuProfilerCompute; // compute queue
+	float m_MovingInstancePercent = 0.0f;
+	utils::DirtyInstanceTracker m_InstanceTracker;
+	utils::InstanceUpdateStats m_InstanceUpdateStats = {};
+	float m_MeshRadius = 0.0f;
+	utils::SceneCache m_SceneCache; // mapped until the streamer copies the geometry
+	std::vector<uint8_t> m_GeometryStaging; // converted geometry, the same lifetime
+	bool m_IsGeometryUploadPending = false;
+	std::vector<utils::MeshLod> m_MeshLods; // offsets in the geometry buffer
+	float m_LodPixelError = 1.0f;
+	uint32_t m_HiZMipNum = 0;
+	glm::mat4 m_PrevClipFromWorld = glm::mat4(1.0f);
+	std::string m_CapturePath;
+	uint32_t m_CaptureFrame = 0;
 };
 
 Sample::~Sample() {
@@ -126,29 +215,54 @@ Sample::~Sample() {
 		NRI.DestroyCommandBuffer(*frame.commandBufferCompute);
 		NRI.DestroyCommandAllocator(*frame.commandAllocatorCompute);
 		NRI.DestroyDescriptor(*frame.constantBufferView);
+		NRI.DestroyDescriptor(*frame.cullingConstantBufferView);
+		NRI.DestroyDescriptor(*frame.instanceUpdateView);
+	}
+
+	for (uint32_t i = 0; i < m_HiZMipNum; i++) {
+		NRI.DestroyDescriptor(*m_HiZMipShaderResources[i]);
+		NRI.DestroyDescriptor(*m_HiZMipStorages[i]);
 	}
 
 	for (BackBuffer &backBuffer : m_SwapChainBuffers) {
 		NRI.DestroyDescriptor(*backBuffer.colorAttachment);
 	}
 
-	NRI.DestroyPipeline(*m_Pipeline);
+	for (nri::Pipeline *pipeline : m_Pipelines)
+		NRI.DestroyPipeline(*pipeline);
 	NRI.DestroyPipeline(*m_SkyPipeline);
 	NRI.DestroyPipeline(*m_GridPipeline);
 	NRI.DestroyPipeline(*m_ComputePipeline);
+	NRI.DestroyPipeline(*m_HiZPipeline);
+	NRI.DestroyPipeline(*m_ScatterPipeline);
 	NRI.DestroyPipeline(*m_PipelineMultiview);
 	NRI.DestroyPipelineLayout(*m_PipelineLayout);
 	NRI.DestroyPipelineLayout(*m_SkyPipelineLayout);
 	NRI.DestroyPipelineLayout(*m_GridPipelineLayout);
 	NRI.DestroyPipelineLayout(*m_ComputePipelineLayout);
-	NRI.DestroyDescriptor(*m_TextureShaderResource);
+	NRI.DestroyPipelineLayout(*m_HiZPipelineLayout);
+	NRI.DestroyPipelineLayout(*m_ScatterPipelineLayout);
 	NRI.DestroyDescriptor(*m_DepthAttachment);
+	NRI.DestroyDescriptor(*m_DepthShaderResource);
+	NRI.DestroyDescriptor(*m_HiZShaderResource);
+	NRI.DestroyDescriptor(*m_VisibleInstanceStorage);
+	NRI.DestroyDescriptor(*m_VisibleInstanceShaderResource);
+	NRI.DestroyDescriptor(*m_IndirectArgsStorage);
 	NRI.DestroyDescriptor(*m_Sampler);
 	NRI.DestroyDescriptor(*m_CubeSampler);
 	NRI.DestroyBuffer(*m_ConstantBuffer);
 	NRI.DestroyBuffer(*m_GeometryBuffer);
-	NRI.DestroyTexture(*m_Texture);
+	NRI.DestroyBuffer(*m_VisibleInstanceBuffer);
+	NRI.DestroyBuffer(*m_IndirectBuffer);
+	NRI.DestroyBuffer(*m_IndirectResetBuffer);
+	NRI.DestroyBuffer(*m_InstanceUpdateBuffer);
+	if (m_ReadbackBuffer)
+		NRI.DestroyBuffer(*m_ReadbackBuffer);
+	m_GpuProfiler.Destroy(NRI);
+	m_GpuProfilerCompute.Destroy(NRI);
+	m_TextureResidency.Destroy();
 	NRI.DestroyTexture(*m_DepthTexture);
+	NRI.DestroyTexture(*m_HiZTexture);
 	NRI.DestroyDescriptorPool(*m_DescriptorPool);
 	NRI.DestroyFence(*m_FrameFence);
 	NRI.DestroySwapChain(*m_SwapChain);
@@ -163,11 +277,83 @@ Sample::~Sample() {
 	nri::nriDestroyDevice(*m_Device);
 }
 
+void Sample::InitCmdLine(cmdline::parser &cmdLine) {
+	cmdLine.add("serialLoading", 0, "load assets on the main thread (startup time reference)");
+	cmdLine.add("verifyCulling", 0, "compare the first frame of GPU culling against the C++ reference");
+	cmdLine.add<std::string>("capture", 0, "record the NRI calls of one frame into a file (replay with NRIReplay)", false, "");
+	cmdLine.add<uint32_t>("captureFrame", 0, "index of the frame to capture", false, 100);
+	cmdLine.add<uint32_t>("memoryBudget", 0, "simulated video memory budget in MB (works with NONE), 0 - OS budget", false, 0);
+	cmdLine.add<std::string>("vertexFormat", 0, "vertex format of all meshes, auto - chosen per mesh at import", false, "auto",
+			cmdline::oneof<std::string>("auto", "unpacked", "standard", "compact"));
+}
+
+void Sample::ReadCmdLine(cmdline::parser &cmdLine) {
+	m_SerialLoading = cmdLine.exist("serialLoading");
+	m_VerifyCulling = cmdLine.exist("verifyCulling");
+	m_CapturePath = cmdLine.get<std::string>("capture");
+	m_CaptureFrame = cmdLine.get<uint32_t>("captureFrame");
+	m_MemoryBudget = cmdLine.get<uint32_t>("memoryBudget");
+
+	const std::string vertexFormat = cmdLine.get<std::string>("vertexFormat");
+	for (uint32_t i = 0; i < (uint32_t)utils::VertexFormat::MAX_NUM; i++) {
+		if (vertexFormat == utils::GetVertexFormatName((utils::VertexFormat)i))
+			m_ForcedVertexFormat = (utils::VertexFormat)i;
+	}
+}
+
 bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
+	// Assets: everything is issued up front (overlapping with device creation) and waited on right before use
+	const double loadingBegin = m_Timer.GetTimeStamp();
+
+	// Destinations must outlive the loader
+	utils::Scene scene;
+	utils::Texture &texture = m_TextureData;
+	utils::Texture cubemapHDRTex;
+	const float *imgHDR = nullptr;
+	tinyddsloader::DDSFile ddsImage;
+
+	AssetLoaderDesc assetLoaderDesc = {};
+	assetLoaderDesc.isSerial = m_SerialLoading;
+
+	AssetLoader assetLoader;
+	assetLoader.Initialize(assetLoaderDesc);
+
+	// Load Scene Mesh (imported once, then reloaded from the binary cache next to the file, the geometry stays mapped)
+	AssetHandle sceneHandle = assetLoader.Run([this, &scene]() {
+		return utils::LoadScene("data/rubber_duck/scene.gltf", scene, false, &m_SceneCache) && !scene.meshes.empty();
+	});
+
+	// Load textures
+	AssetHandle textureHandle = assetLoader.LoadTexture(
+			utils::GetFullPath("Duck_baseColor.png", utils::DataFolder::TEXTURES), texture);
+
+	// utils::GetFullPath("piazza_bologni_1k.hdr", utils::DataFolder::TEXTURES)
+	AssetHandle hdrHandle = assetLoader.Load(utils::GetFullPath("barcelona.hdr", utils::DataFolder::TEXTURES),
+			[&cubemapHDRTex, &imgHDR](std::vector<uint8_t> &fileData) {
+				int comp;
+				int w, h;
+				imgHDR = stbi_loadf_from_memory(fileData.data(), (int)fileData.size(), &w, &h, &comp, 4);
+				cubemapHDRTex.width = w;
+				cubemapHDRTex.height = h;
+				cubemapHDRTex.format = nri::Format::RGBA32_SFLOAT;
+				cubemapHDRTex.mipNum = 1;
+				return imgHDR != nullptr;
+			});
+
+	AssetHandle ddsHandle = assetLoader.Load(utils::GetFullPath("test.dds", utils::DataFolder::TEXTURES),
+			[&ddsImage](std::vector<uint8_t> &fileData) {
+				return ddsImage.Load(std::move(fileData)) == tinyddsloader::Result::Success;
+			});
+
 	nri::AdapterDesc bestAdapterDesc = {};
 	uint32_t adapterDescsNum = 1;
-	NRI_ABORT_ON_FAILURE(
-			nri::nriEnumerateAdapters(&bestAdapterDesc, adapterDescsNum));
+	if (graphicsAPI == nri::GraphicsAPI::NONE) {
+		// Headless: no GPU needed, only queue numbers are taken from the adapter
+		for (uint32_t &queueNum : bestAdapterDesc.queueNum)
+			queueNum = 1;
+	} else
+		NRI_ABORT_ON_FAILURE(
+				nri::nriEnumerateAdapters(&bestAdapterDesc, adapterDescsNum));
 
 	nri::QueueFamilyDesc queueFamilies[2] = {};
 	queueFamilies[0].queueNum = 1;
@@ -182,20 +368,32 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 	deviceCreationDesc.queueFamilyNum = helper::GetCountOf(queueFamilies);
 	deviceCreationDesc.enableGraphicsAPIValidation = true;
 	deviceCreationDesc.enableNRIValidation = m_DebugNRI;
+	deviceCreationDesc.nriValidationSampleRate = m_DebugNRISampleRate;
+	deviceCreationDesc.enableNRIStats = true;
+	deviceCreationDesc.enableNRICapture = !m_CapturePath.empty();
 	deviceCreationDesc.enableD3D11CommandBufferEmulation =
 			D3D11_COMMANDBUFFER_EMULATION;
 	deviceCreationDesc.vkBindingOffsets = VK_BINDING_OFFSETS;
 	deviceCreationDesc.adapterDesc = &bestAdapterDesc;
 	deviceCreationDesc.allocationCallbacks = m_AllocationCallbacks;
-	NRI_ABORT_ON_FAILURE(nri::nriCreateDevice(deviceCreationDesc, m_Device));
+	{
+		ALLOCATION_SCOPE(DEVICE);
+		NRI_ABORT_ON_FAILURE(nri::nriCreateDevice(deviceCreationDesc, m_Device));
+	}
 
 	// NRI
+	NRI_ABORT_ON_FAILURE(nri::nriGetInterface(*m_Device,
+			NRI_INTERFACE(nri::CaptureInterface),
+			(nri::CaptureInterface *)&NRI));
 	NRI_ABORT_ON_FAILURE(nri::nriGetInterface(*m_Device,
 			NRI_INTERFACE(nri::CoreInterface),
 			(nri::CoreInterface *)&NRI));
 	NRI_ABORT_ON_FAILURE(nri::nriGetInterface(*m_Device,
 			NRI_INTERFACE(nri::HelperInterface),
 			(nri::HelperInterface *)&NRI));
+	NRI_ABORT_ON_FAILURE(
+			nri::nriGetInterface(*m_Device, NRI_INTERFACE(nri::StatsInterface),
+					(nri::StatsInterface *)&NRI));
 	NRI_ABORT_ON_FAILURE(
 			nri::nriGetInterface(*m_Device, NRI_INTERFACE(nri::StreamerInterface),
 					(nri::StreamerInterface *)&NRI));
@@ -210,7 +408,16 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 			nri::BufferUsageBits::VERTEX_BUFFER | nri::BufferUsageBits::INDEX_BUFFER;
 	streamerDesc.constantBufferMemoryLocation = nri::MemoryLocation::HOST_UPLOAD;
 	streamerDesc.frameInFlightNum = BUFFERED_FRAME_MAX_NUM;
-	NRI_ABORT_ON_FAILURE(NRI.CreateStreamer(*m_Device, streamerDesc, m_Streamer));
+	{
+		ALLOCATION_SCOPE(STREAMER);
+		NRI_ABORT_ON_FAILURE(NRI.CreateStreamer(*m_Device, streamerDesc, m_Streamer));
+	}
+
+	// Memory governor: the streamer allocates internally, its ring is estimated from the uploaded size (see "PrepareFrame")
+	utils::MemoryGovernorDesc memoryGovernorDesc = {};
+	memoryGovernorDesc.simulatedBudget[(size_t)utils::MemorySegment::LOCAL] = uint64_t(m_MemoryBudget) * 1024 * 1024;
+	m_MemoryGovernor.Initialize(NRI, NRI, *m_Device, memoryGovernorDesc);
+	m_StreamerMemory = m_MemoryGovernor.Track(streamerDesc.dynamicBufferMemoryLocation, utils::MemoryCategory::STREAMER, 0);
 
 	// Command queue
 	NRI_ABORT_ON_FAILURE(NRI.GetQueue(*m_Device, nri::QueueType::GRAPHICS, 0, m_GraphicsQueue));
@@ -227,6 +434,8 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 	// Swap chain
 	nri::Format swapChainFormat;
 	{
+		ALLOCATION_SCOPE(SWAP_CHAIN);
+
 		nri::SwapChainDesc swapChainDesc = {};
 		swapChainDesc.window = GetWindow();
 		swapChainDesc.queue = m_GraphicsQueue;
@@ -260,6 +469,8 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 
 	// Buffered resources
 	for (Frame &frame : m_Frames) {
+		ALLOCATION_SCOPE(COMMAND_BUFFER);
+
 		NRI_ABORT_ON_FAILURE(
 				NRI.CreateCommandAllocator(*m_GraphicsQueue, frame.commandAllocator));
 		NRI_ABORT_ON_FAILURE(
@@ -277,25 +488,32 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 	const nri::DeviceDesc &deviceDesc = NRI.GetDeviceDesc(*m_Device);
 	utils::ShaderCodeStorage shaderCodeStorage;
 	{
+		ALLOCATION_SCOPE(PIPELINE);
+
 		nri::DescriptorRangeDesc descriptorRangeConstant[1];
 		descriptorRangeConstant[0] = { 0, 1, nri::DescriptorType::CONSTANT_BUFFER,
 			nri::StageBits::ALL };
 
 		nri::DescriptorRangeDesc descriptorRangeTexture[3];
-		descriptorRangeTexture[0] = { 0, 2, nri::DescriptorType::TEXTURE,
-			nri::StageBits::FRAGMENT_SHADER };
+		descriptorRangeTexture[0] = { 0, 1, nri::DescriptorType::TEXTURE,
+			nri::StageBits::FRAGMENT_SHADER }; // cubemap
 		descriptorRangeTexture[1] = { 0, 1, nri::DescriptorType::SAMPLER,
 			nri::StageBits::FRAGMENT_SHADER };
-		descriptorRangeTexture[2] = { 0, 1, nri::DescriptorType::STRUCTURED_BUFFER, nri::StageBits::VERTEX_SHADER };
+		descriptorRangeTexture[2] = { 0, 2, nri::DescriptorType::STRUCTURED_BUFFER, nri::StageBits::VERTEX_SHADER }; // instances, visible instances
+
+		// Material textures are bindless, the mesh gets its index via root constants
+		m_TextureTable.Initialize({ TEXTURE_TABLE_SIZE });
+		const nri::DescriptorRangeDesc descriptorRangeTextureTable = m_TextureTable.GetDescriptorRangeDesc();
 
 		nri::DescriptorSetDesc descriptorSetDescs[] = {
 			{ 0, descriptorRangeConstant,
 					helper::GetCountOf(descriptorRangeConstant) },
 			{ 1, descriptorRangeTexture, helper::GetCountOf(descriptorRangeTexture) },
+			{ 2, &descriptorRangeTextureTable, 1 },
 		};
 
-		nri::RootConstantDesc rootConstant = { 1, sizeof(glm::vec4),
-			nri::StageBits::FRAGMENT_SHADER };
+		nri::RootConstantDesc rootConstant = { 1, sizeof(MeshRootConstants),
+			nri::StageBits::VERTEX_SHADER | nri::StageBits::FRAGMENT_SHADER };
 
 		nri::PipelineLayoutDesc pipelineLayoutDesc = {};
 		pipelineLayoutDesc.descriptorSetNum =
@@ -309,38 +527,6 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 		NRI_ABORT_ON_FAILURE(NRI.CreatePipelineLayout(*m_Device, pipelineLayoutDesc,
 				m_PipelineLayout));
 
-		nri::VertexStreamDesc vertexStreamDesc = {};
-		vertexStreamDesc.bindingSlot = 0;
-		vertexStreamDesc.stride = sizeof(Vertex);
-
-		nri::VertexAttributeDesc vertexAttributeDesc[3] = {};
-		{
-			vertexAttributeDesc[0].format = nri::Format::RGB32_SFLOAT;
-			vertexAttributeDesc[0].streamIndex = 0;
-			vertexAttributeDesc[0].offset = helper::GetOffsetOf(&Vertex::position);
-			vertexAttributeDesc[0].d3d = { "POSITION", 0 };
-			vertexAttributeDesc[0].vk.location = { 0 };
-
-			vertexAttributeDesc[1].format = nri::Format::RG32_SFLOAT;
-			vertexAttributeDesc[1].streamIndex = 0;
-			vertexAttributeDesc[1].offset = helper::GetOffsetOf(&Vertex::uv);
-			vertexAttributeDesc[1].d3d = { "TEXCOORD", 0 };
-			vertexAttributeDesc[1].vk.location = { 1 };
-
-			vertexAttributeDesc[2].format = nri::Format::RGB32_SFLOAT;
-			vertexAttributeDesc[2].streamIndex = 0;
-			vertexAttributeDesc[2].offset = helper::GetOffsetOf(&Vertex::normal);
-			vertexAttributeDesc[2].d3d = { "NORMAL", 0 };
-			vertexAttributeDesc[2].vk.location = { 2 };
-		}
-
-		nri::VertexInputDesc vertexInputDesc = {};
-		vertexInputDesc.attributes = vertexAttributeDesc;
-		vertexInputDesc.attributeNum =
-				(uint8_t)helper::GetCountOf(vertexAttributeDesc);
-		vertexInputDesc.streams = &vertexStreamDesc;
-		vertexInputDesc.streamNum = 1;
-
 		nri::InputAssemblyDesc inputAssemblyDesc = {};
 		inputAssemblyDesc.topology = nri::Topology::TRIANGLE_LIST;
 
@@ -374,21 +560,42 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 					shaderCodeStorage),
 		};
 
-		nri::GraphicsPipelineDesc graphicsPipelineDesc = {};
-		graphicsPipelineDesc.pipelineLayout = m_PipelineLayout;
-		graphicsPipelineDesc.vertexInput = &vertexInputDesc;
-		graphicsPipelineDesc.inputAssembly = inputAssemblyDesc;
-		graphicsPipelineDesc.rasterization = rasterizationDesc;
-		graphicsPipelineDesc.outputMerger = outputMergerDesc;
-		graphicsPipelineDesc.shaders = shaderStages;
-		graphicsPipelineDesc.shaderNum = helper::GetCountOf(shaderStages);
-
-		NRI_ABORT_ON_FAILURE(NRI.CreateGraphicsPipeline(
-				*m_Device, graphicsPipelineDesc, m_Pipeline));
+		// A pipeline per vertex format (only the input layout differs, the shader decodes with "VertexDecodeParams"). They
+		// are created while the scene is still loading, a mesh picks the one of "Mesh::vertexFormat"
+		for (uint32_t i = 0; i < (uint32_t)utils::VertexFormat::MAX_NUM; i++) {
+			const utils::VertexFormat vertexFormat = (utils::VertexFormat)i;
+
+			nri::VertexStreamDesc vertexStreamDesc = {};
+			vertexStreamDesc.bindingSlot = 0;
+			vertexStreamDesc.stride = utils::GetVertexStride(vertexFormat);
+
+			nri::VertexAttributeDesc vertexAttributeDesc[3] = {};
+			const uint32_t vertexAttributeNum = utils::GetVertexAttributes(vertexFormat, vertexAttributeDesc);
+
+			nri::VertexInputDesc vertexInputDesc = {};
+			vertexInputDesc.attributes = vertexAttributeDesc;
+			vertexInputDesc.attributeNum = (uint8_t)vertexAttributeNum;
+			vertexInputDesc.streams = &vertexStreamDesc;
+			vertexInputDesc.streamNum = 1;
+
+			nri::GraphicsPipelineDesc graphicsPipelineDesc = {};
+			graphicsPipelineDesc.pipelineLayout = m_PipelineLayout;
+			graphicsPipelineDesc.vertexInput = &vertexInputDesc;
+			graphicsPipelineDesc.inputAssembly = inputAssemblyDesc;
+			graphicsPipelineDesc.rasterization = rasterizationDesc;
+			graphicsPipelineDesc.outputMerger = outputMergerDesc;
+			graphicsPipelineDesc.shaders = shaderStages;
+			graphicsPipelineDesc.shaderNum = helper::GetCountOf(shaderStages);
+
+			NRI_ABORT_ON_FAILURE(NRI.CreateGraphicsPipeline(
+					*m_Device, graphicsPipelineDesc, m_Pipelines[i]));
+		}
 	}
 
 	// SKyBox Pipeline
 	{
+		ALLOCATION_SCOPE(PIPELINE);
+
 		nri::DescriptorRangeDesc descriptorRangeConstant[1];
 		descriptorRangeConstant[0] = { 0, 1, nri::DescriptorType::CONSTANT_BUFFER,
 			nri::StageBits::ALL };
@@ -466,6 +673,8 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 
 	// Grid Pipeline
 	{
+		ALLOCATION_SCOPE(PIPELINE);
+
 		struct bindRoot {
 			glm::mat4 a;
 			vec4 b;
@@ -534,25 +743,27 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 
 	// Compute pipeline
 	{
-		nri::DescriptorRangeDesc descriptorRangeComp[2];
+		ALLOCATION_SCOPE(PIPELINE);
+
+		nri::DescriptorRangeDesc descriptorRangeComp[3];
 		descriptorRangeComp[0] = { 0, 1, nri::DescriptorType::STRUCTURED_BUFFER,
-			nri::StageBits::COMPUTE_SHADER };
-		descriptorRangeComp[1] = { 0, 1, nri::DescriptorType::STORAGE_BUFFER,
-			nri::StageBits::COMPUTE_SHADER };
+			nri::StageBits::COMPUTE_SHADER }; // transforms
+		descriptorRangeComp[1] = { 0, 2, nri::DescriptorType::STORAGE_BUFFER,
+			nri::StageBits::COMPUTE_SHADER }; // visible instances, indirect args
+		descriptorRangeComp[2] = { 1, 1, nri::DescriptorType::TEXTURE,
+			nri::StageBits::COMPUTE_SHADER }; // Hi-Z
 
-		nri::DescriptorSetDesc descriptorSetDesc = { 0, descriptorRangeComp, 2 };
+		nri::DescriptorSetDesc descriptorSetDesc = { 0, descriptorRangeComp, helper::GetCountOf(descriptorRangeComp) };
 
-		struct bindRoot {
-			vec4 a;
-		};
-		nri::RootConstantDesc rootConstant = { 0, sizeof(bindRoot),
+		// Culling constants, a per-frame view
+		nri::RootDescriptorDesc rootDescriptor = { 1, nri::DescriptorType::CONSTANT_BUFFER,
 			nri::StageBits::COMPUTE_SHADER };
 
 		nri::PipelineLayoutDesc pipelineLayoutDesc = {};
 		pipelineLayoutDesc.descriptorSetNum = 1;
 		pipelineLayoutDesc.descriptorSets = &descriptorSetDesc;
-		pipelineLayoutDesc.rootConstantNum = 1;
-		pipelineLayoutDesc.rootConstants = &rootConstant;
+		pipelineLayoutDesc.rootDescriptorNum = 1;
+		pipelineLayoutDesc.rootDescriptors = &rootDescriptor;
 		pipelineLayoutDesc.shaderStages = nri::StageBits::COMPUTE_SHADER;
 		NRI_ABORT_ON_FAILURE(NRI.CreatePipelineLayout(*m_Device, pipelineLayoutDesc, m_ComputePipelineLayout));
 		NRI.SetDebugName(m_ComputePipelineLayout, "Compute Pipeline Layout");
@@ -562,93 +773,160 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 		NRI_ABORT_ON_FAILURE(NRI.CreateComputePipeline(*m_Device, computePipelineDesc, m_ComputePipeline));
 	}
 
+	// Hi-Z pipeline (one mip per dispatch)
+	{
+		ALLOCATION_SCOPE(PIPELINE);
+
+		nri::DescriptorRangeDesc descriptorRanges[2];
+		descriptorRanges[0] = { 0, 1, nri::DescriptorType::TEXTURE,
+			nri::StageBits::COMPUTE_SHADER };
+		descriptorRanges[1] = { 0, 1, nri::DescriptorType::STORAGE_TEXTURE,
+			nri::StageBits::COMPUTE_SHADER };
+
+		nri::DescriptorSetDesc descriptorSetDesc = { 0, descriptorRanges, helper::GetCountOf(descriptorRanges) };
+
+		nri::PipelineLayoutDesc pipelineLayoutDesc = {};
+		pipelineLayoutDesc.descriptorSetNum = 1;
+		pipelineLayoutDesc.descriptorSets = &descriptorSetDesc;
+		pipelineLayoutDesc.shaderStages = nri::StageBits::COMPUTE_SHADER;
+		NRI_ABORT_ON_FAILURE(NRI.CreatePipelineLayout(*m_Device, pipelineLayoutDesc, m_HiZPipelineLayout));
+
+		nri::ComputePipelineDesc computePipelineDesc = {};
+		computePipelineDesc.pipelineLayout = m_HiZPipelineLayout;
+		computePipelineDesc.shader = utils::LoadShader(deviceDesc.graphicsAPI, "depthPyramid.cs", shaderCodeStorage);
+		NRI_ABORT_ON_FAILURE(NRI.CreateComputePipeline(*m_Device, computePipelineDesc, m_HiZPipeline));
+	}
+
+	// Instance update scatter pipeline
+	{
+		ALLOCATION_SCOPE(PIPELINE);
+
+		nri::DescriptorRangeDesc descriptorRanges[2];
+		descriptorRanges[0] = { 0, 1, nri::DescriptorType::STRUCTURED_BUFFER,
+			nri::StageBits::COMPUTE_SHADER }; // updates
+		descriptorRanges[1] = { 0, 1, nri::DescriptorType::STORAGE_BUFFER,
+			nri::StageBits::COMPUTE_SHADER }; // transforms
+
+		nri::DescriptorSetDesc descriptorSetDesc = { 0, descriptorRanges, helper::GetCountOf(descriptorRanges) };
+
+		nri::RootConstantDesc rootConstant = { 0, sizeof(uint32_t),
+			nri::StageBits::COMPUTE_SHADER };
+
+		nri::PipelineLayoutDesc pipelineLayoutDesc = {};
+		pipelineLayoutDesc.descriptorSetNum = 1;
+		pipelineLayoutDesc.descriptorSets = &descriptorSetDesc;
+		pipelineLayoutDesc.rootConstantNum = 1;
+		pipelineLayoutDesc.rootConstants = &rootConstant;
+		pipelineLayoutDesc.shaderStages = nri::StageBits::COMPUTE_SHADER;
+		NRI_ABORT_ON_FAILURE(NRI.CreatePipelineLayout(*m_Device, pipelineLayoutDesc, m_ScatterPipelineLayout));
+
+		nri::ComputePipelineDesc computePipelineDesc = {};
+		computePipelineDesc.pipelineLayout = m_ScatterPipelineLayout;
+		computePipelineDesc.shader = utils::LoadShader(deviceDesc.graphicsAPI, "instanceScatter.cs", shaderCodeStorage);
+		NRI_ABORT_ON_FAILURE(NRI.CreateComputePipeline(*m_Device, computePipelineDesc, m_ScatterPipeline));
+	}
+
+	m_HiZMipNum = utils::GetHiZMipNum(GetWindowResolution().first, GetWindowResolution().second);
+
 	{ // Descriptor pool
+		ALLOCATION_SCOPE(DESCRIPTOR_POOL);
+
 		nri::DescriptorPoolDesc descriptorPoolDesc = {};
-		descriptorPoolDesc.descriptorSetMaxNum = BUFFERED_FRAME_MAX_NUM + 5;
+		descriptorPoolDesc.descriptorSetMaxNum = BUFFERED_FRAME_MAX_NUM * 2 + 6 + m_HiZMipNum;
 		descriptorPoolDesc.constantBufferMaxNum = BUFFERED_FRAME_MAX_NUM;
-		descriptorPoolDesc.storageBufferMaxNum = 2;
-		descriptorPoolDesc.structuredBufferMaxNum = 2;
-		descriptorPoolDesc.textureMaxNum = 20;
+		descriptorPoolDesc.storageBufferMaxNum = 2 + BUFFERED_FRAME_MAX_NUM;
+		descriptorPoolDesc.structuredBufferMaxNum = 3 + BUFFERED_FRAME_MAX_NUM;
+		descriptorPoolDesc.textureMaxNum = 20 + 1 + m_HiZMipNum + TEXTURE_TABLE_SIZE;
+		descriptorPoolDesc.storageTextureMaxNum = m_HiZMipNum;
 		descriptorPoolDesc.samplerMaxNum = 10;
 
 		NRI_ABORT_ON_FAILURE(NRI.CreateDescriptorPool(*m_Device, descriptorPoolDesc,
 				m_DescriptorPool));
 	}
 
-	// Load Scene Mesh
-	const aiScene *scene =
-			aiImportFile("data/rubber_duck/scene.gltf",
-					aiProcess_Triangulate | aiProcess_MakeLeftHanded);
-	if (!scene || !scene->HasMeshes()) {
+	// Wait for assets
+	if (!assetLoader.Wait(sceneHandle)) {
 		printf("Unable to load data/rubber_duck/scene.gltf\n");
 		exit(255);
 	}
 
-	// Load texture
-	utils::Texture texture;
-	std::string path =
-			utils::GetFullPath("Duck_baseColor.png", utils::DataFolder::TEXTURES);
-	if (!utils::LoadTexture(path, texture)) {
-		return false;
-	}
-
-	utils::Texture cubemapHDRTex;
-	// path = utils::GetFullPath("piazza_bologni_1k.hdr", utils::DataFolder::TEXTURES);
-	path = utils::GetFullPath("barcelona.hdr", utils::DataFolder::TEXTURES);
-	if (!utils::LoadTexture(path, cubemapHDRTex)) {
+	if (!assetLoader.Wait(textureHandle) || !assetLoader.Wait(hdrHandle)) {
 		return false;
 	}
 
-	int comp;
-	int w, h;
-	const float *imgHDR = stbi_loadf(path.c_str(), &w, &h, &comp, 4);
-	cubemapHDRTex.width = w;
-	cubemapHDRTex.height = h;
-	cubemapHDRTex.format = nri::Format::RGBA32_SFLOAT;
-	cubemapHDRTex.mipNum = 1;
+	assetLoader.Wait(ddsHandle);
 
-	tinyddsloader::DDSFile ddsImage;
-	path = utils::GetFullPath("test.dds", utils::DataFolder::TEXTURES);
-	ddsImage.Load(path.c_str());
+	printf("Assets are ready in %.1f ms (%s loading)\n", m_Timer.GetTimeStamp() - loadingBegin,
+			m_SerialLoading ? "serial" : "parallel");
 
 	// Resources
 	const uint32_t constantBufferSize = helper::Align((uint32_t)sizeof(ConstantBufferLayout),
 			deviceDesc.constantBufferOffsetAlignment);
+	const uint32_t cullingConstantBufferSize = helper::Align((uint32_t)sizeof(utils::GpuCullingConstants),
+			deviceDesc.constantBufferOffsetAlignment);
+	const uint32_t frameConstantBufferSize = constantBufferSize + cullingConstantBufferSize;
 
-	const aiMesh *mesh = scene->mMeshes[0];
-	std::vector<Vertex> positions;
-	std::vector<uint32_t> indices;
-	for (unsigned int i = 0; i != mesh->mNumVertices; i++) {
-		const aiVector3D v = mesh->mVertices[i];
-		const aiVector3D uv0 = mesh->mTextureCoords[0][i];
-		const aiVector3D n = mesh->mNormals[i];
-		positions.push_back({ vec3(v.x, v.y, v.z), vec2(uv0.x, uv0.y), vec3(n.x, n.y, n.z) });
+	// Only the first mesh is drawn, it starts at offset 0
+	if (m_ForcedVertexFormat != utils::VertexFormat::MAX_NUM) {
+		for (utils::Mesh &sceneMesh : scene.meshes)
+			sceneMesh.vertexFormat = m_ForcedVertexFormat;
 	}
 
-	for (unsigned int i = 0; i != mesh->mNumFaces; i++) {
-		for (int j = 0; j != 3; j++) {
-			indices.push_back(mesh->mFaces[i].mIndices[j]);
-		}
+	const utils::SceneGeometry geometry = utils::GetSceneGeometry(scene, m_SceneCache);
+	const utils::Mesh &mesh = scene.meshes[0];
+	m_MeshVertexFormat = mesh.vertexFormat;
+
+	// LODs follow each other in the index buffer, the culling shader selects a LOD per instance
+	const uint32_t lodNum = std::min(std::max(mesh.lodNum, 1u), utils::GPU_CULLING_LOD_MAX_NUM);
+	m_MeshLods.resize(lodNum);
+
+	uint32_t lodIndexNum = 0;
+	for (uint32_t i = 0; i < lodNum; i++) {
+		const utils::MeshLod &lod = mesh.lodNum ? scene.meshLods[mesh.lodOffset + i] : utils::MeshLod{ mesh.indexOffset, mesh.indexNum, 0.0f };
+		m_MeshLods[i] = { lodIndexNum, lod.indexNum, lod.error };
+		lodIndexNum += lod.indexNum;
 	}
-	g_indexCount = indices.size();
-	const uint64_t indexDataSize = helper::GetByteSizeOf(indices);
+
+	g_indexCount = mesh.indexNum;
+	m_IndexType = utils::GetIndexType(mesh.vertexNum);
+	const uint64_t indexDataSize = uint64_t(lodIndexNum) * utils::GetIndexSize(m_IndexType);
 	const uint64_t indexDataAlignedSize = helper::Align(indexDataSize, 32);
-	const uint64_t vertexDataSize = helper::GetByteSizeOf(positions);
+
+	// Vertices are packed into the mesh format, the shader applies "m_VertexDecodeParams". The scene stores
+	// "UNPACKED" and "STANDARD" vertices, they go to the streamer from the scene (the mapped cache) as is. Indices are
+	// stored as 32-bit, smaller ones are converted. Converted data lives in "m_GeometryStaging"
+	const uint32_t vertexStride = utils::GetVertexStride(m_MeshVertexFormat);
+	const uint64_t vertexDataSize = uint64_t(mesh.vertexNum) * vertexStride;
+	const bool isIndexConversionNeeded = m_IndexType != nri::IndexType::UINT32;
+	const bool isPackingNeeded = m_MeshVertexFormat == utils::VertexFormat::COMPACT;
+	m_GeometryStaging.resize((isIndexConversionNeeded ? indexDataSize : 0) + (isPackingNeeded ? vertexDataSize : 0));
+
+	const utils::UnpackedVertex *unpackedVertices = geometry.unpackedVertices + mesh.vertexOffset;
+	const void *vertexData = m_MeshVertexFormat == utils::VertexFormat::STANDARD ? (const void *)(geometry.vertices + mesh.vertexOffset) : unpackedVertices;
+
+	const double packingBegin = m_Timer.GetTimeStamp();
+	if (isPackingNeeded) {
+		vertexData = m_GeometryStaging.data() + (isIndexConversionNeeded ? indexDataSize : 0);
+		m_VertexDecodeParams = utils::PackVertices(m_MeshVertexFormat, unpackedVertices, mesh.vertexNum, (void *)vertexData);
+	} else
+		m_VertexDecodeParams = utils::GetVertexDecodeParams(m_MeshVertexFormat, unpackedVertices, mesh.vertexNum);
+	const double packingTime = m_Timer.GetTimeStamp() - packingBegin;
+
+	const utils::VertexFetchStats vertexFetchStats = utils::EstimateVertexFetch(geometry.indices + mesh.indexOffset, mesh.indexNum, vertexStride);
+	printf("Vertex format: %s (%s), %u bytes per vertex, %.1f Kb (%s in %.3f ms), estimated fetch: %.1f Kb\n",
+			utils::GetVertexFormatName(m_MeshVertexFormat), m_ForcedVertexFormat == utils::VertexFormat::MAX_NUM ? "per mesh" : "forced", vertexStride, vertexDataSize / 1024.0, isPackingNeeded ? "packed" : "as is", packingTime,
+			vertexFetchStats.fetchedBytes / 1024.0);
 
 	const uint32_t kNumMeshes = 32 * 1024;
 
 	{
-		{ // Read-only texture
-			nri::TextureDesc textureDesc = {};
-			textureDesc.type = nri::TextureType::TEXTURE_2D;
-			textureDesc.usage = nri::TextureUsageBits::SHADER_RESOURCE;
-			textureDesc.format = texture.GetFormat();
-			textureDesc.width = texture.GetWidth();
-			textureDesc.height = texture.GetHeight();
-			textureDesc.mipNum = texture.GetMipNum();
+		{ // Streamed texture: created with the mip tail, higher mips are streamed on demand (PNGs come without mips)
+			utils::GenerateMips(texture);
 
-			NRI_ABORT_ON_FAILURE(
-					NRI.CreateTexture(*m_Device, textureDesc, m_Texture));
+			m_TextureResidency.Initialize(NRI, NRI, NRI, *m_Device, *m_Streamer, {});
+			m_TextureResidencyIndex = m_TextureResidency.AddTexture(texture);
+			if (m_TextureResidencyIndex == utils::InvalidIndex)
+				return false;
 		}
 
 		{
@@ -679,7 +957,7 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 		{
 			nri::TextureDesc textureDesc = {};
 			textureDesc.type = nri::TextureType::TEXTURE_2D;
-			textureDesc.usage = nri::TextureUsageBits::DEPTH_STENCIL_ATTACHMENT;
+			textureDesc.usage = nri::TextureUsageBits::DEPTH_STENCIL_ATTACHMENT | nri::TextureUsageBits::SHADER_RESOURCE;
 			textureDesc.format = nri::Format::D16_UNORM;
 			textureDesc.width = (uint16_t)GetWindowResolution().first;
 			textureDesc.height = (uint16_t)GetWindowResolution().second;
@@ -688,14 +966,60 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 					NRI.CreateTexture(*m_Device, textureDesc, m_DepthTexture));
 		}
 
-		{
+		{ // Hi-Z (max depth), mip 0 is half resolution
+			nri::TextureDesc textureDesc = {};
+			textureDesc.type = nri::TextureType::TEXTURE_2D;
+			textureDesc.usage = nri::TextureUsageBits::SHADER_RESOURCE | nri::TextureUsageBits::SHADER_RESOURCE_STORAGE;
+			textureDesc.format = nri::Format::R32_SFLOAT;
+			textureDesc.width = (uint16_t)std::max(GetWindowResolution().first >> 1, 1u);
+			textureDesc.height = (uint16_t)std::max(GetWindowResolution().second >> 1, 1u);
+			textureDesc.mipNum = (nri::Mip_t)m_HiZMipNum;
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateTexture(*m_Device, textureDesc, m_HiZTexture));
+			NRI.SetDebugName(m_HiZTexture, "m_HiZTexture");
+		}
+
+		{ // Common constants + culling constants per frame
 			nri::BufferDesc bufferDesc = {};
-			bufferDesc.size = constantBufferSize * BUFFERED_FRAME_MAX_NUM;
+			bufferDesc.size = frameConstantBufferSize * BUFFERED_FRAME_MAX_NUM;
 			bufferDesc.usage = nri::BufferUsageBits::CONSTANT_BUFFER;
 			NRI_ABORT_ON_FAILURE(
 					NRI.CreateBuffer(*m_Device, bufferDesc, m_ConstantBuffer));
 		}
 
+		{ // Visible instances (compacted by the culling shader), a region per LOD
+			nri::BufferDesc bufferDesc = {};
+			bufferDesc.size = sizeof(uint32_t) * kNumMeshes * lodNum;
+			bufferDesc.structureStride = sizeof(uint32_t);
+			bufferDesc.usage = nri::BufferUsageBits::SHADER_RESOURCE | nri::BufferUsageBits::SHADER_RESOURCE_STORAGE;
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateBuffer(*m_Device, bufferDesc, m_VisibleInstanceBuffer));
+			NRI.SetDebugName(m_VisibleInstanceBuffer, "m_VisibleInstanceBuffer");
+		}
+
+		{ // Indirect arguments: "DrawIndexedDesc" + draw count per LOD
+			nri::BufferDesc bufferDesc = {};
+			bufferDesc.size = sizeof(uint32_t) * utils::GPU_CULLING_ARGS_NUM * lodNum;
+			bufferDesc.structureStride = sizeof(uint32_t);
+			bufferDesc.usage = nri::BufferUsageBits::ARGUMENT_BUFFER | nri::BufferUsageBits::SHADER_RESOURCE_STORAGE;
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateBuffer(*m_Device, bufferDesc, m_IndirectBuffer));
+			NRI.SetDebugName(m_IndirectBuffer, "m_IndirectBuffer");
+
+			// Copied over the arguments every frame
+			bufferDesc.structureStride = 0;
+			bufferDesc.usage = nri::BufferUsageBits::NONE;
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateBuffer(*m_Device, bufferDesc, m_IndirectResetBuffer));
+		}
+
+		if (m_VerifyCulling) { // Visible instances + indirect arguments of the first frame
+			nri::BufferDesc bufferDesc = {};
+			bufferDesc.size = sizeof(uint32_t) * (kNumMeshes + utils::GPU_CULLING_ARGS_NUM) * lodNum;
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateBuffer(*m_Device, bufferDesc, m_ReadbackBuffer));
+		}
+
 		{ // Geometry buffer1（duck)
 			nri::BufferDesc bufferDesc = {};
 			bufferDesc.size = indexDataAlignedSize + vertexDataSize;
@@ -706,28 +1030,28 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 			m_GeometryOffset = indexDataAlignedSize;
 		}
 
-		// Storage Buffer(Pos)
+		// RW Storage Buffer(Matrix), 3x4 transforms written by the scatter shader
 		{
 			nri::BufferDesc bufferDesc = {};
-			bufferDesc.size = sizeof(vec4) * kNumMeshes;
-			bufferDesc.structureStride = 16;
-			bufferDesc.usage = nri::BufferUsageBits::SHADER_RESOURCE;
+			bufferDesc.size = sizeof(utils::InstanceTransform) * kNumMeshes;
+			bufferDesc.structureStride = sizeof(utils::InstanceTransform);
+			bufferDesc.usage = nri::BufferUsageBits::SHADER_RESOURCE | nri::BufferUsageBits::SHADER_RESOURCE_STORAGE;
 			NRI_ABORT_ON_FAILURE(
-					NRI.CreateBuffer(*m_Device, bufferDesc, m_PositionStorageBuffer));
+					NRI.CreateBuffer(*m_Device, bufferDesc, m_MatrixStorageBuffer));
 		}
 
-		// RW Storage Buffer(Matrix)
+		// Instance updates (per frame, worst case - all instances)
 		{
 			nri::BufferDesc bufferDesc = {};
-			bufferDesc.size = sizeof(mat4) * kNumMeshes;
-			bufferDesc.structureStride = 64;
-			bufferDesc.usage = nri::BufferUsageBits::SHADER_RESOURCE_STORAGE;
+			bufferDesc.size = sizeof(utils::InstanceUpdate) * kNumMeshes * BUFFERED_FRAME_MAX_NUM;
+			bufferDesc.structureStride = sizeof(utils::InstanceUpdate);
+			bufferDesc.usage = nri::BufferUsageBits::SHADER_RESOURCE;
 			NRI_ABORT_ON_FAILURE(
-					NRI.CreateBuffer(*m_Device, bufferDesc, m_MatrixStorageBuffer));
+					NRI.CreateBuffer(*m_Device, bufferDesc, m_InstanceUpdateBuffer));
 		}
 	}
 
-	std::vector<nri::Buffer *> constantBufferArray = { m_ConstantBuffer };
+	std::vector<nri::Buffer *> constantBufferArray = { m_ConstantBuffer, m_InstanceUpdateBuffer };
 
 	nri::ResourceGroupDesc resourceGroupDesc = {};
 	resourceGroupDesc.memoryLocation = nri::MemoryLocation::HOST_UPLOAD;
@@ -735,31 +1059,48 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 	resourceGroupDesc.buffers = constantBufferArray.data();
 
 	m_MemoryAllocations.resize(1, nullptr);
-	NRI_ABORT_ON_FAILURE(NRI.AllocateAndBindMemory(*m_Device, resourceGroupDesc,
+	NRI_ABORT_ON_FAILURE(m_MemoryGovernor.AllocateAndBindMemory(resourceGroupDesc, utils::MemoryCategory::TRANSIENT,
 			m_MemoryAllocations.data()));
 
-	std::vector<nri::Buffer *> bufferArray = { m_GeometryBuffer, m_PositionStorageBuffer, m_MatrixStorageBuffer };
-	std::vector<nri::Texture *> textureArray = { m_Texture, m_DepthTexture, m_HDRTexture, m_CubemapTexture };
-	resourceGroupDesc.memoryLocation = nri::MemoryLocation::DEVICE;
-	resourceGroupDesc.bufferNum = bufferArray.size();
-	resourceGroupDesc.buffers = bufferArray.data();
-	resourceGroupDesc.textureNum = textureArray.size();
-	resourceGroupDesc.textures = textureArray.data();
-
-	m_MemoryAllocations.resize(
-			1 + NRI.CalculateAllocationNumber(*m_Device, resourceGroupDesc), nullptr);
-	NRI_ABORT_ON_FAILURE(NRI.AllocateAndBindMemory(
-			*m_Device, resourceGroupDesc, m_MemoryAllocations.data() + 1));
+	// Grouped by governor categories
+	auto allocateDeviceMemory = [&](std::vector<nri::Buffer *> bufferArray, std::vector<nri::Texture *> textureArray,
+										utils::MemoryCategory category) {
+		nri::ResourceGroupDesc groupDesc = {};
+		groupDesc.memoryLocation = nri::MemoryLocation::DEVICE;
+		groupDesc.bufferNum = bufferArray.size();
+		groupDesc.buffers = bufferArray.data();
+		groupDesc.textureNum = textureArray.size();
+		groupDesc.textures = textureArray.data();
+
+		const size_t allocationOffset = m_MemoryAllocations.size();
+		m_MemoryAllocations.resize(
+				allocationOffset + NRI.CalculateAllocationNumber(*m_Device, groupDesc), nullptr);
+		NRI_ABORT_ON_FAILURE(m_MemoryGovernor.AllocateAndBindMemory(groupDesc, category,
+				m_MemoryAllocations.data() + allocationOffset));
+	};
+
+	allocateDeviceMemory({ m_GeometryBuffer, m_MatrixStorageBuffer, m_VisibleInstanceBuffer, m_IndirectBuffer, m_IndirectResetBuffer }, {},
+			utils::MemoryCategory::GEOMETRY);
+	allocateDeviceMemory({}, { m_DepthTexture, m_HiZTexture, m_HDRTexture }, utils::MemoryCategory::TRANSIENT);
+	allocateDeviceMemory({}, { m_CubemapTexture }, utils::MemoryCategory::TEXTURES);
+
+	// The streamed texture is allocated by the residency manager, tracked in "PrepareFrame"
+	m_TextureMemory = m_MemoryGovernor.Track(nri::MemoryLocation::DEVICE, utils::MemoryCategory::TEXTURES, 0);
+
+	if (m_ReadbackBuffer) {
+		resourceGroupDesc = {};
+		resourceGroupDesc.memoryLocation = nri::MemoryLocation::HOST_READBACK;
+		resourceGroupDesc.bufferNum = 1;
+		resourceGroupDesc.buffers = &m_ReadbackBuffer;
+
+		const size_t allocationOffset = m_MemoryAllocations.size();
+		m_MemoryAllocations.resize(allocationOffset + 1, nullptr);
+		NRI_ABORT_ON_FAILURE(m_MemoryGovernor.AllocateAndBindMemory(resourceGroupDesc, utils::MemoryCategory::TRANSIENT,
+				m_MemoryAllocations.data() + allocationOffset));
+	}
 
 	{ // Descriptors
-		{ // Read-only texture
-			nri::Texture2DViewDesc texture2DViewDesc = {
-				m_Texture, nri::Texture2DViewType::SHADER_RESOURCE_2D,
-				texture.GetFormat()
-			};
-			NRI_ABORT_ON_FAILURE(
-					NRI.CreateTexture2DView(texture2DViewDesc, m_TextureShaderResource));
-		}
+		ALLOCATION_SCOPE(RESOURCE);
 
 		{
 			nri::Texture2DViewDesc textureViewDesc = { .texture = m_HDRTexture, .viewType = nri::Texture2DViewType::SHADER_RESOURCE_2D, .format = cubemapHDRTex.format };
@@ -779,6 +1120,32 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 					NRI.CreateTexture2DView(textureViewDesc, m_DepthAttachment));
 		}
 
+		{
+			nri::Texture2DViewDesc textureViewDesc = { .texture = m_DepthTexture, .viewType = nri::Texture2DViewType::SHADER_RESOURCE_2D, .format = nri::Format::D16_UNORM };
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateTexture2DView(textureViewDesc, m_DepthShaderResource));
+		}
+
+		{ // Hi-Z: all mips for culling, one mip per view for downsampling
+			nri::Texture2DViewDesc textureViewDesc = { .texture = m_HiZTexture, .viewType = nri::Texture2DViewType::SHADER_RESOURCE_2D, .format = nri::Format::R32_SFLOAT };
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateTexture2DView(textureViewDesc, m_HiZShaderResource));
+
+			m_HiZMipShaderResources.resize(m_HiZMipNum);
+			m_HiZMipStorages.resize(m_HiZMipNum);
+			for (uint32_t i = 0; i < m_HiZMipNum; i++) {
+				textureViewDesc.viewType = nri::Texture2DViewType::SHADER_RESOURCE_2D;
+				textureViewDesc.mipOffset = (nri::Mip_t)i;
+				textureViewDesc.mipNum = 1;
+				NRI_ABORT_ON_FAILURE(
+						NRI.CreateTexture2DView(textureViewDesc, m_HiZMipShaderResources[i]));
+
+				textureViewDesc.viewType = nri::Texture2DViewType::SHADER_RESOURCE_STORAGE_2D;
+				NRI_ABORT_ON_FAILURE(
+						NRI.CreateTexture2DView(textureViewDesc, m_HiZMipStorages[i]));
+			}
+		}
+
 		{ // Sampler
 			nri::SamplerDesc samplerDesc = {};
 			samplerDesc.addressModes = { nri::AddressMode::REPEAT,
@@ -796,23 +1163,59 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 			nri::BufferViewDesc bufferViewDesc = {};
 			bufferViewDesc.buffer = m_ConstantBuffer;
 			bufferViewDesc.viewType = nri::BufferViewType::CONSTANT;
-			bufferViewDesc.offset = i * constantBufferSize;
+			bufferViewDesc.offset = i * frameConstantBufferSize;
 			bufferViewDesc.size = constantBufferSize;
 			NRI_ABORT_ON_FAILURE(
 					NRI.CreateBufferView(bufferViewDesc, m_Frames[i].constantBufferView));
 
 			m_Frames[i].constantBufferViewOffset = bufferViewDesc.offset;
+
+			bufferViewDesc.offset += constantBufferSize;
+			bufferViewDesc.size = cullingConstantBufferSize;
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateBufferView(bufferViewDesc, m_Frames[i].cullingConstantBufferView));
+
+			m_Frames[i].cullingConstantBufferViewOffset = bufferViewDesc.offset;
 		}
 
-		// Position Storage Buffer
+		// Visible instances
 		{
 			nri::BufferViewDesc bufferViewDesc = {};
-			bufferViewDesc.buffer = m_PositionStorageBuffer;
+			bufferViewDesc.buffer = m_VisibleInstanceBuffer;
+			bufferViewDesc.viewType = nri::BufferViewType::SHADER_RESOURCE_STORAGE;
+			bufferViewDesc.format = nri::Format::UNKNOWN;
+			bufferViewDesc.size = kNumMeshes * lodNum * sizeof(uint32_t);
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateBufferView(bufferViewDesc, m_VisibleInstanceStorage));
+
 			bufferViewDesc.viewType = nri::BufferViewType::SHADER_RESOURCE;
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateBufferView(bufferViewDesc, m_VisibleInstanceShaderResource));
+		}
+
+		// Indirect arguments
+		{
+			nri::BufferViewDesc bufferViewDesc = {};
+			bufferViewDesc.buffer = m_IndirectBuffer;
+			bufferViewDesc.viewType = nri::BufferViewType::SHADER_RESOURCE_STORAGE;
 			bufferViewDesc.format = nri::Format::UNKNOWN;
-			bufferViewDesc.size = kNumMeshes * sizeof(vec4);
+			bufferViewDesc.size = utils::GPU_CULLING_ARGS_NUM * lodNum * sizeof(uint32_t);
 			NRI_ABORT_ON_FAILURE(
-					NRI.CreateBufferView(bufferViewDesc, m_PosStorageShaderResource));
+					NRI.CreateBufferView(bufferViewDesc, m_IndirectArgsStorage));
+		}
+
+		// Instance updates
+		for (uint32_t i = 0; i < BUFFERED_FRAME_MAX_NUM; i++) {
+			nri::BufferViewDesc bufferViewDesc = {};
+			bufferViewDesc.buffer = m_InstanceUpdateBuffer;
+			bufferViewDesc.viewType = nri::BufferViewType::SHADER_RESOURCE;
+			bufferViewDesc.format = nri::Format::UNKNOWN;
+			bufferViewDesc.offset = i * kNumMeshes * sizeof(utils::InstanceUpdate);
+			bufferViewDesc.size = kNumMeshes * sizeof(utils::InstanceUpdate);
+			NRI_ABORT_ON_FAILURE(
+					NRI.CreateBufferView(bufferViewDesc, m_Frames[i].instanceUpdateView));
+
+			m_Frames[i].instanceUpdateViewOffset = bufferViewDesc.offset;
 		}
 
 		// Matrix Storage Buffer
@@ -821,7 +1224,7 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 			bufferViewDesc.buffer = m_MatrixStorageBuffer;
 			bufferViewDesc.viewType = nri::BufferViewType::SHADER_RESOURCE_STORAGE;
 			bufferViewDesc.format = nri::Format::UNKNOWN;
-			bufferViewDesc.size = kNumMeshes * sizeof(mat4);
+			bufferViewDesc.size = kNumMeshes * sizeof(utils::InstanceTransform);
 			NRI_ABORT_ON_FAILURE(
 					NRI.CreateBufferView(bufferViewDesc, m_MatrixStorageShaderResource));
 			NRI.SetDebugName(m_MatrixStorageBuffer, "m_MatrixStorageBuffer");
@@ -832,19 +1235,21 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 			bufferViewDesc.buffer = m_MatrixStorageBuffer;
 			bufferViewDesc.viewType = nri::BufferViewType::SHADER_RESOURCE;
 			bufferViewDesc.format = nri::Format::UNKNOWN;
-			bufferViewDesc.size = kNumMeshes * sizeof(mat4);
+			bufferViewDesc.size = kNumMeshes * sizeof(utils::InstanceTransform);
 			NRI_ABORT_ON_FAILURE(
 					NRI.CreateBufferView(bufferViewDesc, m_MatrixStorageBufferSRV));
 		}
 	}
 
 	{ // Descriptor sets
+		ALLOCATION_SCOPE(DESCRIPTOR_POOL);
+
 		// Texture
 		NRI_ABORT_ON_FAILURE(
 				NRI.AllocateDescriptorSets(*m_DescriptorPool, *m_PipelineLayout, 1,
 						&m_TextureDescriptorSet, 1, 0));
 
-		std::vector<nri::Descriptor *> shaderResoruceViewArray = { m_TextureShaderResource, m_CubemapTextureShaderResource };
+		std::vector<nri::Descriptor *> shaderResoruceViewArray = { m_CubemapTextureShaderResource };
 
 		nri::DescriptorRangeUpdateDesc descriptorRangeUpdateDescs[3] = {};
 		descriptorRangeUpdateDescs[0].descriptorNum = shaderResoruceViewArray.size();
@@ -853,8 +1258,9 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 		descriptorRangeUpdateDescs[1].descriptorNum = 1;
 		descriptorRangeUpdateDescs[1].descriptors = &m_Sampler;
 
-		descriptorRangeUpdateDescs[2].descriptorNum = 1;
-		descriptorRangeUpdateDescs[2].descriptors = &m_MatrixStorageBufferSRV;
+		nri::Descriptor *instanceBufferArray[] = { m_MatrixStorageBufferSRV, m_VisibleInstanceShaderResource };
+		descriptorRangeUpdateDescs[2].descriptorNum = helper::GetCountOf(instanceBufferArray);
+		descriptorRangeUpdateDescs[2].descriptors = instanceBufferArray;
 
 		NRI.UpdateDescriptorRanges(*m_TextureDescriptorSet, 0,
 				helper::GetCountOf(descriptorRangeUpdateDescs),
@@ -866,12 +1272,15 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 					NRI.AllocateDescriptorSets(*m_DescriptorPool, *m_PipelineLayout, 0,
 							&frame.constantBufferDescriptorSet, 1, 0));
 
-			nri::DescriptorRangeUpdateDesc descriptorRangeUpdateDesc = {
-				&frame.constantBufferView, 1
-			};
-			NRI.UpdateDescriptorRanges(*frame.constantBufferDescriptorSet, 0, 1,
-					&descriptorRangeUpdateDesc);
+			nri::DescriptorRangeUpdateDesc descriptorRangeUpdateDesc = { &frame.constantBufferView, 1 };
+			NRI.UpdateDescriptorRanges(*frame.constantBufferDescriptorSet, 0, 1, &descriptorRangeUpdateDesc);
 		}
+
+		// Bindless textures, written by "BindlessTextureTable::Update"
+		if (!m_TextureTable.CreateDescriptorSet(NRI, *m_DescriptorPool, *m_PipelineLayout, 2))
+			return false;
+
+		m_BaseColorTexture = m_TextureTable.Add(*m_TextureResidency.GetDescriptor(m_TextureResidencyIndex));
 	}
 
 	// SkyBox Descriptor Sets
@@ -901,35 +1310,87 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 				NRI.AllocateDescriptorSets(*m_DescriptorPool, *m_ComputePipelineLayout, 0,
 						&m_ComputeBufferDescriptorSet, 1, 0));
 
-		std::vector<nri::Descriptor *> shaderResoruceViewArray = { m_PosStorageShaderResource, m_MatrixStorageShaderResource };
+		std::vector<nri::Descriptor *> storageViewArray = { m_VisibleInstanceStorage, m_IndirectArgsStorage };
 
-		nri::DescriptorRangeUpdateDesc descriptorRangeUpdateDescs[2] = {};
-		descriptorRangeUpdateDescs[0].descriptorNum = 2;
-		descriptorRangeUpdateDescs[0].descriptors = shaderResoruceViewArray.data();
+		nri::DescriptorRangeUpdateDesc descriptorRangeUpdateDescs[3] = {};
+		descriptorRangeUpdateDescs[0].descriptorNum = 1;
+		descriptorRangeUpdateDescs[0].descriptors = &m_MatrixStorageBufferSRV;
+
+		descriptorRangeUpdateDescs[1].descriptorNum = storageViewArray.size();
+		descriptorRangeUpdateDescs[1].descriptors = storageViewArray.data();
+
+		descriptorRangeUpdateDescs[2].descriptorNum = 1;
+		descriptorRangeUpdateDescs[2].descriptors = &m_HiZShaderResource;
 
 		NRI.UpdateDescriptorRanges(*m_ComputeBufferDescriptorSet, 0,
-				1,
+				helper::GetCountOf(descriptorRangeUpdateDescs),
 				descriptorRangeUpdateDescs);
 	}
 
+	// Scatter Descriptor Sets
+	for (Frame &frame : m_Frames) {
+		NRI_ABORT_ON_FAILURE(
+				NRI.AllocateDescriptorSets(*m_DescriptorPool, *m_ScatterPipelineLayout, 0,
+						&frame.instanceUpdateDescriptorSet, 1, 0));
+
+		nri::DescriptorRangeUpdateDesc descriptorRangeUpdateDescs[] = {
+			{ &frame.instanceUpdateView, 1 },
+			{ &m_MatrixStorageShaderResource, 1 },
+		};
+		NRI.UpdateDescriptorRanges(*frame.instanceUpdateDescriptorSet, 0,
+				helper::GetCountOf(descriptorRangeUpdateDescs), descriptorRangeUpdateDescs);
+	}
+
+	// Hi-Z Descriptor Sets: mip 0 reads the depth buffer, others read the previous mip
+	{
+		m_HiZDescriptorSets.resize(m_HiZMipNum);
+		NRI_ABORT_ON_FAILURE(
+				NRI.AllocateDescriptorSets(*m_DescriptorPool, *m_HiZPipelineLayout, 0,
+						m_HiZDescriptorSets.data(), m_HiZMipNum, 0));
+
+		for (uint32_t i = 0; i < m_HiZMipNum; i++) {
+			nri::DescriptorRangeUpdateDesc descriptorRangeUpdateDescs[] = {
+				{ i ? &m_HiZMipShaderResources[i - 1] : &m_DepthShaderResource, 1 },
+				{ &m_HiZMipStorages[i], 1 },
+			};
+			NRI.UpdateDescriptorRanges(*m_HiZDescriptorSets[i], 0,
+					helper::GetCountOf(descriptorRangeUpdateDescs), descriptorRangeUpdateDescs);
+		}
+	}
+
 	{ // Upload data
-		std::vector<uint8_t> geometryBufferData(indexDataAlignedSize +
-				vertexDataSize);
-		memcpy(&geometryBufferData[0], indices.data(), indexDataSize);
-		memcpy(&geometryBufferData[indexDataAlignedSize], positions.data(),
-				vertexDataSize);
-
-		std::array<nri::TextureSubresourceUploadDesc, 16> subresources;
-		for (uint32_t mip = 0; mip < texture.GetMipNum(); mip++) {
-			texture.GetSubresource(subresources[mip], mip);
+		ALLOCATION_SCOPE(RESOURCE);
+
+		// Geometry goes through the streamer, "data" must stay valid until "CopyStreamerUpdateRequests" in the first
+		// "PrepareFrame", which releases the mapping and the staging
+		const uint32_t indexSize = utils::GetIndexSize(m_IndexType);
+		for (uint32_t i = 0; i < lodNum; i++) {
+			const uint32_t indexOffset = mesh.lodNum ? scene.meshLods[mesh.lodOffset + i].indexOffset : mesh.indexOffset;
+
+			nri::BufferUpdateRequestDesc indexRequest = {};
+			indexRequest.data = geometry.indices + indexOffset;
+			indexRequest.dataSize = uint64_t(m_MeshLods[i].indexNum) * indexSize;
+			indexRequest.dstBuffer = m_GeometryBuffer;
+			indexRequest.dstBufferOffset = uint64_t(m_MeshLods[i].indexOffset) * indexSize;
+
+			if (isIndexConversionNeeded) {
+				uint8_t *convertedIndices = m_GeometryStaging.data() + indexRequest.dstBufferOffset;
+				utils::ConvertIndices(geometry.indices + indexOffset, m_MeshLods[i].indexNum, m_IndexType, convertedIndices);
+				indexRequest.data = convertedIndices;
+			}
+
+			if (indexRequest.dataSize)
+				NRI.AddStreamerBufferUpdateRequest(*m_Streamer, indexRequest);
 		}
 
-		nri::TextureUploadDesc textureData;
-		textureData.subresources = subresources.data();
-		textureData.texture = m_Texture;
-		textureData.after = { nri::AccessBits::SHADER_RESOURCE,
-			nri::Layout::SHADER_RESOURCE };
-		textureData.planes = nri::PlaneBits::ALL;
+		nri::BufferUpdateRequestDesc vertexRequest = {};
+		vertexRequest.data = vertexData;
+		vertexRequest.dataSize = vertexDataSize;
+		vertexRequest.dstBuffer = m_GeometryBuffer;
+		vertexRequest.dstBufferOffset = indexDataAlignedSize;
+		NRI.AddStreamerBufferUpdateRequest(*m_Streamer, vertexRequest);
+
+		m_IsGeometryUploadPending = true;
 
 		nri::TextureUploadDesc textureData1;
 		textureData1.subresources = nullptr;
@@ -937,6 +1398,13 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 		textureData1.after = { nri::AccessBits::DEPTH_STENCIL_ATTACHMENT_WRITE, nri::Layout::DEPTH_STENCIL_ATTACHMENT };
 		textureData1.planes = nri::PlaneBits::DEPTH;
 
+		// Far plane everywhere until the first frame is rendered
+		nri::TextureUploadDesc hiZData;
+		hiZData.subresources = nullptr;
+		hiZData.texture = m_HiZTexture;
+		hiZData.after = { nri::AccessBits::SHADER_RESOURCE, nri::Layout::SHADER_RESOURCE };
+		hiZData.planes = nri::PlaneBits::ALL;
+
 		nri::TextureSubresourceUploadDesc hdrSubresources;
 		hdrSubresources.slices = imgHDR;
 		hdrSubresources.sliceNum = 1;
@@ -973,31 +1441,61 @@ bool Sample::Initialize(nri::GraphicsAPI graphicsAPI) {
 		textureData3.after = { nri::AccessBits::SHADER_RESOURCE, nri::Layout::SHADER_RESOURCE };
 		textureData3.planes = nri::PlaneBits::ALL;
 
-		nri::BufferUploadDesc bufferData = {};
-		bufferData.buffer = m_GeometryBuffer;
-		bufferData.data = &geometryBufferData[0];
-		bufferData.dataSize = geometryBufferData.size();
-		bufferData.after = { nri::AccessBits::INDEX_BUFFER |
-			nri::AccessBits::VERTEX_BUFFER };
-
 		std::vector<vec4> centers(kNumMeshes);
 		for (vec4 &p : centers) {
 			p = vec4(glm::linearRand(-vec3(500.0f), +vec3(500.0f)), glm::linearRand(0.0f, 3.14159f));
 		}
-		nri::BufferUploadDesc bufferData1 = {};
-		bufferData1.buffer = m_PositionStorageBuffer;
-		bufferData1.data = centers.data();
-		bufferData1.dataSize = centers.size() * sizeof(vec4);
-		bufferData1.after = { nri::AccessBits::SHADER_RESOURCE };
-		NRI.SetDebugName(m_PositionStorageBuffer, "m_PositionStorageBuffer");
-		std::vector<nri::BufferUploadDesc> uploadDescArray = { bufferData, bufferData1 };
-		std::vector<nri::TextureUploadDesc> texUploadDescArray = { textureData, textureData1, textureData2, textureData3 };
+
+		// Instances sit on the grid. All of them are dirty, so the first frame uploads everything
+		m_InstanceTracker.Initialize(kNumMeshes);
+		for (uint32_t i = 0; i < kNumMeshes; i++) {
+			centers[i].y = 0.2f;
+			m_InstanceTracker.SetTranslation(i, centers[i].x, centers[i].y, centers[i].z);
+		}
+
+		// "instanceNum" and the draw count are accumulated by the culling shader
+		const std::vector<uint32_t> indirectArgs = GetIndirectArgs(m_MeshLods);
+
+		nri::BufferUploadDesc indirectData = {};
+		indirectData.buffer = m_IndirectBuffer;
+		indirectData.data = indirectArgs.data();
+		indirectData.dataSize = indirectArgs.size() * sizeof(uint32_t);
+		indirectData.after = { nri::AccessBits::ARGUMENT_BUFFER };
+
+		nri::BufferUploadDesc indirectResetData = indirectData;
+		indirectResetData.buffer = m_IndirectResetBuffer;
+		indirectResetData.after = { nri::AccessBits::COPY_SOURCE };
+
+		std::vector<nri::BufferUploadDesc> uploadDescArray = { indirectData, indirectResetData };
+		std::vector<nri::TextureUploadDesc> texUploadDescArray = { textureData1, hiZData, textureData2, textureData3 };
 
 		NRI_ABORT_ON_FAILURE(NRI.UploadData(*m_GraphicsQueue, texUploadDescArray.data(), texUploadDescArray.size(),
 				uploadDescArray.data(),
 				uploadDescArray.size()));
+
+		// Texture streaming
+		float meshRadius = 0.0f;
+		for (uint32_t i = 0; i < mesh.vertexNum; i++) {
+			const float *pos = unpackedVertices[i].pos;
+			meshRadius = std::max(meshRadius, glm::length(vec3(pos[0], pos[1], pos[2])));
+		}
+
+		m_MemoryGovernor.AddPressureCallback(utils::MemorySegment::LOCAL, 100, ReleaseTextureMips, &m_TextureResidency, "Texture mips");
+		for (const vec4 &p : centers) {
+			m_TextureResidency.AddInstance(m_TextureResidencyIndex, vec3(p.x, p.y, p.z), meshRadius);
+		}
+
+		// GPU culling: the vertex shader only uses the instance translation
+		m_MeshRadius = meshRadius;
 	}
 
+	// GPU profilers, one per queue
+	if (!m_GpuProfiler.Initialize(NRI, NRI, *m_Device, BUFFERED_FRAME_MAX_NUM, "GPU"))
+		return false;
+
+	if (!m_GpuProfilerCompute.Initialize(NRI, NRI, *m_Device, BUFFERED_FRAME_MAX_NUM, "GPU compute"))
+		return false;
+
 	// User interface
 	bool initialized = InitUI(NRI, NRI, *m_Device, swapChainFormat);
 	m_Camera.Initialize(glm::vec3(0.0f, 0.0f, -3.5f), glm::vec3(0.0f, 0.0f, 0.0f));
@@ -1019,13 +1517,52 @@ void Sample::PrepareFrame(uint32_t frameIndex) {
 		ImGui::BeginDisabled(!deviceDesc.isFlexibleMultiviewSupported);
 		ImGui::Checkbox("Multiview", &m_Multiview);
 		ImGui::EndDisabled();
+
+		ImGui::Checkbox("Frustum culling", &m_FrustumCulling);
+		ImGui::Checkbox("Occlusion culling", &m_OcclusionCulling);
+		ImGui::SliderFloat("LOD error", &m_LodPixelError, 0.0f, 8.0f, "%.1f px");
+		ImGui::SliderFloat("Moving instances", &m_MovingInstancePercent, 0.0f, 10.0f, "%.1f%%");
+		ImGui::Text("Instance updates: %.0f per frame (%.1f Kb)", m_InstanceUpdateStats.gatherNum ? double(m_InstanceUpdateStats.updateNum) / m_InstanceUpdateStats.gatherNum : 0.0,
+				m_InstanceUpdateStats.GetBytesPerFrame() / 1024.0);
+		ImGui::Text("UI geometry: %.1f us per frame (%.1f Kb)", GetUiRepackStats().GetMicrosecondsPerFrame(), GetUiRepackStats().GetBytesPerFrame() / 1024.0);
+		ImGui::Checkbox("CPU profiler", &m_ShowCpuProfiler);
+
+		if (ImGui::CollapsingHeader("GPU time")) {
+			for (const utils::GpuProfiler *profiler : { &m_GpuProfilerCompute, &m_GpuProfiler }) {
+				for (const utils::GpuRangeStats &stats : profiler->GetStats())
+					ImGui::Text("%*s%s: %.3f ms (max %.3f)", stats.depth * 2, "", stats.name, stats.average, stats.max);
+			}
+		}
+
+		if (ImGui::CollapsingHeader("Commands"))
+			ShowFrameStatsUI(NRI, *m_Device);
+
+		if (ImGui::CollapsingHeader("Memory")) {
+			const char *segmentNames[] = { "Local", "System" };
+			for (uint32_t i = 0; i < (uint32_t)utils::MemorySegment::MAX_NUM; i++) {
+				const utils::MemorySegmentStats &stats = m_MemoryGovernor.GetStats((utils::MemorySegment)i);
+				ImGui::Text("%s: %.1f / %.1f Mb%s", segmentNames[i], stats.usageSize / (1024.0 * 1024.0), stats.budgetSize / (1024.0 * 1024.0),
+						stats.isOverBudget ? " (over budget)" : (stats.isUnderPressure ? " (pressure)" : ""));
+				if (stats.pendingReleaseSize)
+					ImGui::Text("  promised: %.1f Mb (not released yet)", stats.pendingReleaseSize / (1024.0 * 1024.0));
+				for (uint32_t j = 0; j < (uint32_t)utils::MemoryCategory::MAX_NUM; j++) {
+					if (stats.categorySizes[j])
+						ImGui::Text("  %s: %.1f Mb", utils::MemoryGovernor::GetCategoryName((utils::MemoryCategory)j), stats.categorySizes[j] / (1024.0 * 1024.0));
+				}
+			}
+			const TextureResidencyStats &residencyStats = m_TextureResidency.GetStats();
+			ImGui::Text("Texture budget: %.1f Mb (%.1f Mb allocated, %.1f Mb releasing)", m_TextureResidency.GetMemoryBudget() / (1024.0 * 1024.0),
+					residencyStats.allocatedSize / (1024.0 * 1024.0), residencyStats.releasingSize / (1024.0 * 1024.0));
+		}
 	}
 	ImGui::End();
 
+	if (m_ShowCpuProfiler)
+		utils::ShowCpuProfilerWindow(&m_ShowCpuProfiler);
+
 	ImGui::ShowDemoWindow();
 
 	EndUI(NRI, *m_Streamer);
-	NRI.CopyStreamerUpdateRequests(*m_Streamer);
 
 	CameraDesc desc = {};
 	desc.aspectRatio = float(GetWindowResolution().first) / float(GetWindowResolution().second);
@@ -1036,6 +1573,41 @@ void Sample::PrepareFrame(uint32_t frameIndex) {
 	GetCameraDescFromInputDevices(desc);
 
 	m_Camera.Update(desc, frameIndex);
+
+	// The ring of the streamer grows to fit "frameInFlightNum + 1" frames of the peak upload
+	nri::FrameStats frameStats = {};
+	NRI.GetFrameStats(*m_Device, frameStats);
+	m_StreamerPeakFrameSize = std::max(m_StreamerPeakFrameSize, frameStats.streamerSize);
+	m_MemoryGovernor.Resize(m_StreamerMemory, m_StreamerPeakFrameSize * (BUFFERED_FRAME_MAX_NUM + 1));
+
+	m_MemoryGovernor.Update();
+	m_TextureResidency.Update(m_Camera.state.globalPosition, GetViewToClip(), GetWindowResolution().second, frameIndex);
+	m_MemoryGovernor.Resize(m_TextureMemory, m_TextureResidency.GetStats().allocatedSize);
+
+	// A recreated texture goes to a new slot, the old one is still used by frames in flight
+	for (uint32_t textureIndex : m_TextureResidency.GetReplacedTextures()) {
+		if (textureIndex != m_TextureResidencyIndex)
+			continue;
+
+		const uint32_t slot = m_TextureTable.Add(*m_TextureResidency.GetDescriptor(textureIndex));
+		if (slot != utils::InvalidIndex) {
+			m_TextureTable.Remove(m_BaseColorTexture, frameIndex);
+			m_BaseColorTexture = slot;
+		}
+	}
+
+	const double streamerCopyBegin = m_Timer.GetTimeStamp();
+	{
+		ALLOCATION_SCOPE(STREAMER);
+		NRI.CopyStreamerUpdateRequests(*m_Streamer);
+	}
+
+	// The geometry is in the streamer ring now
+	if (m_IsGeometryUploadPending) {
+		m_SceneCache.Close();
+		std::vector<uint8_t>().swap(m_GeometryStaging);
+	}
+	m_FrameBenchmark.Add(utils::FrameStage::STREAMER_COPY, m_Timer.GetTimeStamp() - streamerCopyBegin);
 }
 
 void Sample::RenderFrame(uint32_t frameIndex) {
@@ -1047,21 +1619,30 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 	const uint32_t bufferedFrameIndex = frameIndex % BUFFERED_FRAME_MAX_NUM;
 	const Frame &frame = m_Frames[bufferedFrameIndex];
 
+	const bool isCaptureFrame = !m_CapturePath.empty() && frameIndex == m_CaptureFrame;
+	if (isCaptureFrame)
+		NRI.BeginCapture(*m_Device);
+
 	if (frameIndex >= BUFFERED_FRAME_MAX_NUM) {
+		PROFILE_SCOPE("WaitForFrame");
+
 		NRI.Wait(*m_FrameFence, 1 + frameIndex - BUFFERED_FRAME_MAX_NUM);
 		NRI.ResetCommandAllocator(*frame.commandAllocator);
 	}
 
+	// New and recycled slots only, in-flight frames don't reference them
+	m_TextureTable.Update(frameIndex);
+
 	const uint32_t currentTextureIndex =
 			NRI.AcquireNextSwapChainTexture(*m_SwapChain);
 	BackBuffer &currentBackBuffer = m_SwapChainBuffers[currentTextureIndex];
 
 	const glm::mat4 m1 = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f),
 			glm::vec3(1.0f, 0.f, 0.f));
-	const glm::mat4 m2 = glm::rotate(glm::mat4(1.0f), (float)glfwGetTime(),
+	const glm::mat4 m2 = glm::rotate(glm::mat4(1.0f), (float)GetTime(),
 			glm::vec3(0.0f, 1.f, 0.f));
 	glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.8f, 0.0f)) * m2 * m1;
-	const glm::mat4 p = glm::perspectiveLH_ZO(glm::radians(m_Fov), 900.f / 600.f, 0.1f, 100.0f);
+	const glm::mat4 p = GetViewToClip();
 	const glm::vec3 cameraPos = m_Camera.state.globalPosition;
 	glm::vec3 target = cameraPos + glm::vec3(m_Camera.state.mWorldToView[0][2], m_Camera.state.mWorldToView[1][2], m_Camera.state.mWorldToView[2][2]);
 	const glm::mat4 v = glm::lookAtLH(cameraPos, target, glm::vec3(0.0f, 1.0f, 0.0f));
@@ -1079,6 +1660,69 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 		commonConstants->modelMat = m;
 		commonConstants->viewMat = m_Camera.state.mWorldToView;
 		commonConstants->projectMat = p;
+		commonConstants->normalMat = glm::transpose(glm::inverse(m));
+		commonConstants->positionScale = glm::vec4(m_VertexDecodeParams.positionScale[0], m_VertexDecodeParams.positionScale[1],
+				m_VertexDecodeParams.positionScale[2], (float)m_VertexDecodeParams.normalEncoding);
+		commonConstants->positionBias = glm::vec4(m_VertexDecodeParams.positionBias[0], m_VertexDecodeParams.positionBias[1],
+				m_VertexDecodeParams.positionBias[2], 0.0f);
+		NRI.UnmapBuffer(*m_ConstantBuffer);
+	}
+
+	// Instance updates: only changed transforms are uploaded and scattered
+	{
+		PROFILE_SCOPE("MoveInstances");
+
+		const uint32_t movingNum = uint32_t(m_InstanceTracker.GetInstanceNum() * m_MovingInstancePercent * 0.01f);
+		const float time = (float)GetTime();
+		for (uint32_t i = 0; i < movingNum; i++) {
+			const utils::InstanceTransform &transform = m_InstanceTracker.GetTransform(i);
+			m_InstanceTracker.SetTranslation(i, transform.rows[0][3], 0.2f + 0.5f * sinf(time * 2.0f + float(i)), transform.rows[2][3]);
+		}
+
+		if (frameIndex % 64 == 0)
+			m_InstanceUpdateStats = {};
+	}
+
+	const uint32_t instanceNum = m_InstanceTracker.GetInstanceNum();
+	utils::InstanceUpdate *instanceUpdates = nullptr;
+	if (m_InstanceTracker.GetDirtyNum())
+		instanceUpdates = (utils::InstanceUpdate *)NRI.MapBuffer(*m_InstanceUpdateBuffer, frame.instanceUpdateViewOffset, instanceNum * sizeof(utils::InstanceUpdate));
+
+	const uint32_t instanceUpdateNum = m_InstanceTracker.GatherUpdates(instanceUpdates, instanceUpdates ? instanceNum : 0, m_InstanceUpdateStats);
+	if (instanceUpdates)
+		NRI.UnmapBuffer(*m_InstanceUpdateBuffer);
+
+	// Instance culling, planes must match the projection used by the vertex shader. Occlusion uses the Hi-Z of the
+	// previous frame, which doesn't exist yet in the first frame
+	const glm::mat4 clipFromWorld = p * m_Camera.state.mWorldToView;
+	const uint32_t hiZWidth = std::max(GetWindowResolution().first >> 1, 1u);
+	const uint32_t hiZHeight = std::max(GetWindowResolution().second >> 1, 1u);
+	const bool verifyCulling = m_VerifyCulling && frameIndex == 0;
+
+	utils::GpuCullingConstants cullingConstants = {};
+	utils::ExtractFrustumPlanes(clipFromWorld, cullingConstants.planes);
+	cullingConstants.prevClipFromWorld = m_PrevClipFromWorld;
+	cullingConstants.hiZScale[0] = float(GetWindowResolution().first) * 0.5f;
+	cullingConstants.hiZScale[1] = float(GetWindowResolution().second) * 0.5f;
+	cullingConstants.hiZSize[0] = hiZWidth;
+	cullingConstants.hiZSize[1] = hiZHeight;
+	cullingConstants.hiZMipNum = m_HiZMipNum;
+	cullingConstants.instanceNum = instanceNum;
+	cullingConstants.meshRadius = m_MeshRadius;
+	if (m_FrustumCulling)
+		cullingConstants.flags |= utils::GPU_CULLING_FRUSTUM;
+	if (m_OcclusionCulling && frameIndex)
+		cullingConstants.flags |= utils::GPU_CULLING_OCCLUSION;
+	memcpy(cullingConstants.cameraPosition, &cameraPos.x, sizeof(cullingConstants.cameraPosition));
+	cullingConstants.lodNum = (uint32_t)m_MeshLods.size();
+	utils::GetMeshLodDistancesSq(m_MeshLods.data(), cullingConstants.lodNum, p[1][1], float(GetWindowResolution().second), m_LodPixelError,
+			cullingConstants.lodDistancesSq);
+
+	m_PrevClipFromWorld = clipFromWorld;
+
+	void *cullingConstantsData = NRI.MapBuffer(*m_ConstantBuffer, frame.cullingConstantBufferViewOffset, sizeof(cullingConstants));
+	if (cullingConstantsData) {
+		memcpy(cullingConstantsData, &cullingConstants, sizeof(cullingConstants));
 		NRI.UnmapBuffer(*m_ConstantBuffer);
 	}
 
@@ -1087,17 +1731,113 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 	nri::CommandBuffer *commandBufferCompute = frame.commandBufferCompute;
 
 	NRI.BeginCommandBuffer(*commandBufferCompute, m_DescriptorPool);
+	m_GpuProfilerCompute.BeginFrame(NRI, *commandBufferCompute, frameIndex);
 	{
-		helper::Annotation annotation(NRI, *commandBufferCompute, "Compute Instance Buffer");
+		PROFILE_SCOPE("RecordCompute");
+		ALLOCATION_SCOPE(COMMAND_BUFFER);
+		utils::GpuProfilerScope gpuScope(NRI, *commandBufferCompute, m_GpuProfilerCompute, "Compute Instance Buffer");
+
+		if (instanceUpdateNum) {
+			// Read by the culling dispatch of the previous frame (the vertex shader reads are behind the frame fence)
+			nri::BufferBarrierDesc transformBarrier = {};
+			transformBarrier.buffer = m_MatrixStorageBuffer;
+			transformBarrier.before = { nri::AccessBits::SHADER_RESOURCE, nri::StageBits::COMPUTE_SHADER };
+			transformBarrier.after = { nri::AccessBits::SHADER_RESOURCE_STORAGE, nri::StageBits::COMPUTE_SHADER };
+
+			nri::BarrierGroupDesc barrierGroupDesc = {};
+			barrierGroupDesc.bufferNum = 1;
+			barrierGroupDesc.buffers = &transformBarrier;
+			NRI.CmdBarrier(*commandBufferCompute, barrierGroupDesc);
+
+			NRI.CmdSetPipelineLayout(*commandBufferCompute, *m_ScatterPipelineLayout);
+			NRI.CmdSetPipeline(*commandBufferCompute, *m_ScatterPipeline);
+			NRI.CmdSetDescriptorSet(*commandBufferCompute, 0, *frame.instanceUpdateDescriptorSet, nullptr);
+			NRI.CmdSetRootConstants(*commandBufferCompute, 0, &instanceUpdateNum, sizeof(instanceUpdateNum));
+			NRI.CmdDispatch(*commandBufferCompute, { (instanceUpdateNum + utils::INSTANCE_SCATTER_GROUP_SIZE - 1) / utils::INSTANCE_SCATTER_GROUP_SIZE, 1, 1 });
+
+			transformBarrier.before = transformBarrier.after;
+			transformBarrier.after = { nri::AccessBits::SHADER_RESOURCE, nri::StageBits::COMPUTE_SHADER };
+			NRI.CmdBarrier(*commandBufferCompute, barrierGroupDesc);
+		}
+
+		// Reset "instanceNum" and the draw count
+		const uint64_t indirectArgsSize = utils::GPU_CULLING_ARGS_NUM * cullingConstants.lodNum * sizeof(uint32_t);
+		NRI.CmdCopyBuffer(*commandBufferCompute, *m_IndirectBuffer, 0, *m_IndirectResetBuffer, 0, indirectArgsSize);
+
+		nri::BufferBarrierDesc bufferBarrier = {};
+		bufferBarrier.buffer = m_IndirectBuffer;
+		bufferBarrier.before = { nri::AccessBits::COPY_DESTINATION, nri::StageBits::COPY };
+		bufferBarrier.after = { nri::AccessBits::SHADER_RESOURCE_STORAGE, nri::StageBits::COMPUTE_SHADER };
+
+		nri::BarrierGroupDesc barrierGroupDesc = {};
+		barrierGroupDesc.bufferNum = 1;
+		barrierGroupDesc.buffers = &bufferBarrier;
+		NRI.CmdBarrier(*commandBufferCompute, barrierGroupDesc);
+
 		NRI.CmdSetPipelineLayout(*commandBufferCompute, *m_ComputePipelineLayout);
 		NRI.CmdSetPipeline(*commandBufferCompute, *m_ComputePipeline);
 		NRI.CmdSetDescriptorSet(*commandBufferCompute, 0, *m_ComputeBufferDescriptorSet, nullptr);
-		NRI.CmdDispatch(*commandBufferCompute, { 1024, 1, 1 });
+		NRI.CmdSetRootDescriptor(*commandBufferCompute, 0, *frame.cullingConstantBufferView);
+		NRI.CmdDispatch(*commandBufferCompute, { (cullingConstants.instanceNum + utils::GPU_CULLING_GROUP_SIZE - 1) / utils::GPU_CULLING_GROUP_SIZE, 1, 1 });
+
+		if (verifyCulling) {
+			nri::BufferBarrierDesc readbackBarriers[2] = {};
+			readbackBarriers[0].buffer = m_VisibleInstanceBuffer;
+			readbackBarriers[0].before = { nri::AccessBits::SHADER_RESOURCE_STORAGE, nri::StageBits::COMPUTE_SHADER };
+			readbackBarriers[0].after = { nri::AccessBits::COPY_SOURCE, nri::StageBits::COPY };
+			readbackBarriers[1] = readbackBarriers[0];
+			readbackBarriers[1].buffer = m_IndirectBuffer;
+
+			barrierGroupDesc.bufferNum = helper::GetCountOf(readbackBarriers);
+			barrierGroupDesc.buffers = readbackBarriers;
+			NRI.CmdBarrier(*commandBufferCompute, barrierGroupDesc);
+
+			const uint64_t visibleInstancesSize = cullingConstants.instanceNum * cullingConstants.lodNum * sizeof(uint32_t);
+			NRI.CmdCopyBuffer(*commandBufferCompute, *m_ReadbackBuffer, 0, *m_VisibleInstanceBuffer, 0, visibleInstancesSize);
+			NRI.CmdCopyBuffer(*commandBufferCompute, *m_ReadbackBuffer, visibleInstancesSize, *m_IndirectBuffer, 0, indirectArgsSize);
+		}
 	}
+	m_GpuProfilerCompute.EndFrame(NRI, *commandBufferCompute);
 	NRI.EndCommandBuffer(*commandBufferCompute);
 
 	NRI.BeginCommandBuffer(*commandBuffer, m_DescriptorPool);
+	m_GpuProfiler.BeginFrame(NRI, *commandBuffer, frameIndex);
 	{
+		PROFILE_SCOPE("RecordGraphics");
+		ALLOCATION_SCOPE(COMMAND_BUFFER);
+
+		{ // Texture streaming
+			utils::GpuProfilerScope gpuScope(NRI, *commandBuffer, m_GpuProfiler, "Streamer");
+
+			std::vector<nri::TextureBarrierDesc> toCopyDestination;
+			std::vector<nri::TextureBarrierDesc> toShaderResource;
+			m_TextureResidency.GatherUploadBarriers(toCopyDestination, toShaderResource);
+
+			// The first frame also uploads the geometry
+			nri::BufferBarrierDesc geometryBarrier = {};
+			geometryBarrier.buffer = m_GeometryBuffer;
+			geometryBarrier.after = { nri::AccessBits::COPY_DESTINATION, nri::StageBits::COPY };
+
+			nri::BarrierGroupDesc streamerBarriers = {};
+			streamerBarriers.textureNum = (uint32_t)toCopyDestination.size();
+			streamerBarriers.textures = toCopyDestination.data();
+			streamerBarriers.bufferNum = m_IsGeometryUploadPending ? 1 : 0;
+			streamerBarriers.buffers = &geometryBarrier;
+			if (streamerBarriers.textureNum || streamerBarriers.bufferNum)
+				NRI.CmdBarrier(*commandBuffer, streamerBarriers);
+
+			NRI.CmdUploadStreamerUpdateRequests(*commandBuffer, *m_Streamer);
+
+			geometryBarrier.before = geometryBarrier.after;
+			geometryBarrier.after = { nri::AccessBits::INDEX_BUFFER | nri::AccessBits::VERTEX_BUFFER, nri::StageBits::INDEX_INPUT | nri::StageBits::VERTEX_SHADER };
+
+			streamerBarriers.textures = toShaderResource.data();
+			if (streamerBarriers.textureNum || streamerBarriers.bufferNum)
+				NRI.CmdBarrier(*commandBuffer, streamerBarriers);
+
+			m_IsGeometryUploadPending = false;
+		}
+
 		nri::TextureBarrierDesc textureBarrierDescs = {};
 		textureBarrierDescs.texture = currentBackBuffer.texture;
 		textureBarrierDescs.after = { nri::AccessBits::COLOR_ATTACHMENT,
@@ -1119,7 +1859,7 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 		NRI.CmdBeginRendering(*commandBuffer, attachmentsDesc);
 		{
 			{
-				helper::Annotation annotation(NRI, *commandBuffer, "Clears");
+				utils::GpuProfilerScope gpuScope(NRI, *commandBuffer, m_GpuProfiler, "Clears");
 
 				nri::ClearDesc clearDesc = {};
 				clearDesc.planes = nri::PlaneBits::COLOR;
@@ -1135,7 +1875,7 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 			testRenderPtr->OnRender(info);
 
 			{
-				helper::Annotation annotation(NRI, *commandBuffer, "SkyBox");
+				utils::GpuProfilerScope gpuScope(NRI, *commandBuffer, m_GpuProfiler, "SkyBox");
 				NRI.CmdSetPipelineLayout(*commandBuffer, *m_SkyPipelineLayout);
 				NRI.CmdSetPipeline(*commandBuffer, *m_SkyPipeline);
 				NRI.CmdSetRootConstants(*commandBuffer, 0, &skyParams, sizeof(vec4));
@@ -1155,7 +1895,7 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 			}
 
 			{
-				helper::Annotation annotation(NRI, *commandBuffer, "Grid");
+				utils::GpuProfilerScope gpuScope(NRI, *commandBuffer, m_GpuProfiler, "Grid");
 				NRI.CmdSetPipelineLayout(*commandBuffer, *m_GridPipelineLayout);
 				NRI.CmdSetPipeline(*commandBuffer, *m_GridPipeline);
 				struct {
@@ -1180,19 +1920,21 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 			}
 
 			{
-				helper::Annotation annotation(NRI, *commandBuffer, "SimpleMesh");
+				utils::GpuProfilerScope gpuScope(NRI, *commandBuffer, m_GpuProfiler, "SimpleMesh");
 
 				NRI.CmdSetPipelineLayout(*commandBuffer, *m_PipelineLayout);
-				NRI.CmdSetPipeline(*commandBuffer, *m_Pipeline);
-				NRI.CmdSetRootConstants(*commandBuffer, 0, &cameraPos, sizeof(glm::vec4));
+				NRI.CmdSetPipeline(*commandBuffer, *m_Pipelines[(size_t)m_MeshVertexFormat]);
+				// "w" - unused
+				MeshRootConstants meshParams = { glm::vec4(cameraPos, 0.0f), 0, m_BaseColorTexture };
 				NRI.CmdSetIndexBuffer(*commandBuffer, *m_GeometryBuffer, 0,
-						nri::IndexType::UINT32);
+						m_IndexType);
 				NRI.CmdSetVertexBuffers(*commandBuffer, 0, 1, &m_GeometryBuffer,
 						&m_GeometryOffset);
 				NRI.CmdSetDescriptorSet(*commandBuffer, 0,
 						*frame.constantBufferDescriptorSet, nullptr);
 				NRI.CmdSetDescriptorSet(*commandBuffer, 1, *m_TextureDescriptorSet,
 						nullptr);
+				NRI.CmdSetDescriptorSet(*commandBuffer, 2, *m_TextureTable.GetDescriptorSet(), nullptr);
 				{
 					const nri::Viewport viewport = { 0.0f, 0.0f, (float)w,
 						(float)h, 0.0f, 1.0f };
@@ -1201,21 +1943,77 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 					nri::Rect scissor = { 0, 0, w, h };
 					NRI.CmdSetScissors(*commandBuffer, &scissor, 1);
 				}
-				uint32_t instanceCount = 1;
 #ifdef INSTANCE
-				instanceCount = 1024 * 32;
+				// A draw per LOD, arguments and the draw count (0 if no instance uses the LOD) come from the culling shader
+				for (uint32_t i = 0; i < cullingConstants.lodNum; i++) {
+					meshParams.visibleOffset = i * instanceNum;
+					NRI.CmdSetRootConstants(*commandBuffer, 0, &meshParams, sizeof(meshParams));
+
+					const uint64_t argsOffset = i * utils::GPU_CULLING_ARGS_NUM * sizeof(uint32_t);
+					NRI.CmdDrawIndexedIndirect(*commandBuffer, *m_IndirectBuffer, argsOffset, 1, sizeof(nri::DrawIndexedDesc), m_IndirectBuffer,
+							argsOffset + sizeof(nri::DrawIndexedDesc));
+				}
+#else
+				NRI.CmdSetRootConstants(*commandBuffer, 0, &meshParams, sizeof(meshParams));
+				NRI.CmdDrawIndexed(*commandBuffer, { g_indexCount, 1, 0, 0, 0 });
 #endif
-				NRI.CmdDrawIndexed(*commandBuffer, { g_indexCount, instanceCount, 0, 0, 0 });
 			}
 		}
 		NRI.CmdEndRendering(*commandBuffer);
 
+		{ // Hi-Z for the next frame
+			utils::GpuProfilerScope gpuScope(NRI, *commandBuffer, m_GpuProfiler, "Hi-Z");
+
+			nri::TextureBarrierDesc hiZBarriers[2] = {};
+			hiZBarriers[0].texture = m_DepthTexture;
+			hiZBarriers[0].before = { nri::AccessBits::DEPTH_STENCIL_ATTACHMENT_WRITE, nri::Layout::DEPTH_STENCIL_ATTACHMENT, nri::StageBits::DEPTH_STENCIL_ATTACHMENT };
+			hiZBarriers[0].after = { nri::AccessBits::SHADER_RESOURCE, nri::Layout::SHADER_RESOURCE, nri::StageBits::COMPUTE_SHADER };
+			hiZBarriers[0].planes = nri::PlaneBits::DEPTH;
+			hiZBarriers[1].texture = m_HiZTexture;
+			hiZBarriers[1].before = { nri::AccessBits::SHADER_RESOURCE, nri::Layout::SHADER_RESOURCE, nri::StageBits::COMPUTE_SHADER };
+			hiZBarriers[1].after = { nri::AccessBits::SHADER_RESOURCE_STORAGE, nri::Layout::SHADER_RESOURCE_STORAGE, nri::StageBits::COMPUTE_SHADER };
+
+			nri::BarrierGroupDesc hiZBarrierGroupDesc = {};
+			hiZBarrierGroupDesc.textureNum = helper::GetCountOf(hiZBarriers);
+			hiZBarrierGroupDesc.textures = hiZBarriers;
+			NRI.CmdBarrier(*commandBuffer, hiZBarrierGroupDesc);
+
+			NRI.CmdSetPipelineLayout(*commandBuffer, *m_HiZPipelineLayout);
+			NRI.CmdSetPipeline(*commandBuffer, *m_HiZPipeline);
+
+			// Each mip reads the previous one
+			nri::TextureBarrierDesc mipBarrier = {};
+			mipBarrier.texture = m_HiZTexture;
+			mipBarrier.before = hiZBarriers[1].after;
+			mipBarrier.after = hiZBarriers[1].before;
+			mipBarrier.mipNum = 1;
+
+			hiZBarrierGroupDesc.textureNum = 1;
+			hiZBarrierGroupDesc.textures = &mipBarrier;
+
+			for (uint32_t i = 0; i < m_HiZMipNum; i++) {
+				const uint32_t mipWidth = std::max(hiZWidth >> i, 1u);
+				const uint32_t mipHeight = std::max(hiZHeight >> i, 1u);
+
+				NRI.CmdSetDescriptorSet(*commandBuffer, 0, *m_HiZDescriptorSets[i], nullptr);
+				NRI.CmdDispatch(*commandBuffer, { (mipWidth + utils::HIZ_GROUP_SIZE - 1) / utils::HIZ_GROUP_SIZE, (mipHeight + utils::HIZ_GROUP_SIZE - 1) / utils::HIZ_GROUP_SIZE, 1 });
+
+				mipBarrier.mipOffset = (nri::Mip_t)i;
+				NRI.CmdBarrier(*commandBuffer, hiZBarrierGroupDesc);
+			}
+
+			std::swap(hiZBarriers[0].before, hiZBarriers[0].after);
+			hiZBarrierGroupDesc.textureNum = 1;
+			hiZBarrierGroupDesc.textures = hiZBarriers;
+			NRI.CmdBarrier(*commandBuffer, hiZBarrierGroupDesc);
+		}
+
 		// Singleview
 		attachmentsDesc.viewMask = 0;
 
 		NRI.CmdBeginRendering(*commandBuffer, attachmentsDesc);
 		{
-			helper::Annotation annotation(NRI, *commandBuffer, "UI");
+			utils::GpuProfilerScope gpuScope(NRI, *commandBuffer, m_GpuProfiler, "UI");
 
 			RenderUI(NRI, NRI, *m_Streamer, *commandBuffer, 1.0f, true);
 		}
@@ -1227,6 +2025,7 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 
 		NRI.CmdBarrier(*commandBuffer, barrierGroupDesc);
 	}
+	m_GpuProfiler.EndFrame(NRI, *commandBuffer);
 	NRI.EndCommandBuffer(*commandBuffer);
 
 	nri::FenceSubmitDesc computeFinishedFence = {};
@@ -1250,6 +2049,42 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 		NRI.QueueSubmit(*m_ComputeQueue, computeTask);
 	}
 
+	if (verifyCulling) {
+		// Frustum culling and LOD selection are bit exact, the order of groups is arbitrary on the GPU
+		NRI.Wait(*m_ComputeFence, computeFinishedFence.value);
+
+		const uint32_t lodNum = cullingConstants.lodNum;
+		std::vector<uint32_t> visibleInstances(instanceNum * lodNum);
+		std::vector<uint32_t> indirectArgs = GetIndirectArgs(m_MeshLods);
+		utils::CullInstancesReference(cullingConstants, m_InstanceTracker.GetTransforms(), nullptr, visibleInstances.data(), indirectArgs.data());
+
+		const uint32_t *readback = (const uint32_t *)NRI.MapBuffer(*m_ReadbackBuffer, 0, nri::WHOLE_SIZE);
+		if (readback) {
+			const uint32_t *gpuIndirectArgs = readback + instanceNum * lodNum;
+			bool isMatching = memcmp(indirectArgs.data(), gpuIndirectArgs, indirectArgs.size() * sizeof(uint32_t)) == 0;
+
+			uint32_t visibleNum = 0;
+			uint32_t gpuVisibleNum = 0;
+			for (uint32_t i = 0; i < lodNum; i++) {
+				const uint32_t *lodArgs = indirectArgs.data() + i * utils::GPU_CULLING_ARGS_NUM;
+				const uint32_t *gpuLodArgs = gpuIndirectArgs + i * utils::GPU_CULLING_ARGS_NUM;
+				const uint32_t *gpuLodInstances = readback + i * instanceNum;
+
+				std::vector<uint32_t> lodInstances(visibleInstances.begin() + i * instanceNum, visibleInstances.begin() + i * instanceNum + lodArgs[1]);
+				std::vector<uint32_t> gpuInstances(gpuLodInstances, gpuLodInstances + std::min(gpuLodArgs[1], instanceNum));
+				std::sort(lodInstances.begin(), lodInstances.end());
+				std::sort(gpuInstances.begin(), gpuInstances.end());
+
+				isMatching = isMatching && lodInstances == gpuInstances;
+				visibleNum += lodArgs[1];
+				gpuVisibleNum += gpuLodArgs[1];
+			}
+			NRI.UnmapBuffer(*m_ReadbackBuffer);
+
+			printf("GPU culling: %u / %u visible (%u LODs), reference %u - %s\n", gpuVisibleNum, instanceNum, lodNum, visibleNum, isMatching ? "match" : "MISMATCH");
+		}
+	}
+
 	// Submit Graphics CommandBuffer
 	{
 		nri::FenceSubmitDesc graphicsWaitFence = {};
@@ -1266,7 +2101,12 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 	}
 
 	// Present
-	NRI.QueuePresent(*m_SwapChain);
+	{
+		PROFILE_SCOPE("Present");
+		ALLOCATION_SCOPE(SWAP_CHAIN);
+
+		NRI.QueuePresent(*m_SwapChain);
+	}
 
 	{ // Signaling after "Present" improves D3D11 performance a bit
 		nri::FenceSubmitDesc signalFence = {};
@@ -1279,6 +2119,11 @@ void Sample::RenderFrame(uint32_t frameIndex) {
 
 		NRI.QueueSubmit(*m_GraphicsQueue, queueSubmitDesc);
 	}
+
+	NRI.EndStatsFrame(*m_Device);
+
+	if (isCaptureFrame && NRI.EndCapture(*m_Device, m_CapturePath.c_str()) == nri::Result::SUCCESS)
+		printf("Frame %u captured to '%s'\n", frameIndex, m_CapturePath.c_str());
 }
 
 SAMPLE_MAIN(Sample, 0);
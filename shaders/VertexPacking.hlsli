@@ -0,0 +1,33 @@
+// Decoding of "utils::VertexFormat" attributes (see "VertexPacking.h"). UNORM / SNORM / FLOAT16 expansion is done by
+// the input assembler, only the per mesh "VertexDecodeParams" and normal encodings are applied here
+
+// Must match "utils::VertexNormalEncoding"
+#define VERTEX_NORMAL_FLOAT                 0
+#define VERTEX_NORMAL_UNORM_10_10_10_2      1
+#define VERTEX_NORMAL_OCTAHEDRAL            2
+
+float3 DecodePosition(float3 position, float3 scale, float3 bias)
+{
+    return position * scale + bias;
+}
+
+float3 DecodeOctahedral(float2 e)
+{
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+
+    return normalize(n);
+}
+
+float3 DecodeNormal(float4 n, uint encoding)
+{
+    if (encoding == VERTEX_NORMAL_OCTAHEDRAL)
+        return DecodeOctahedral(n.xy);
+
+    if (encoding == VERTEX_NORMAL_UNORM_10_10_10_2)
+        return n.xyz * 2.0 - 1.0;
+
+    return n.xyz;
+}
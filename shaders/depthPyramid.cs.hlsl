@@ -0,0 +1,32 @@
+#include "NRICompatibility.hlsli"
+
+// One Hi-Z mip from the previous one (or from the depth buffer), a C++ reference lives in "GpuCulling.cpp"
+NRI_RESOURCE(Texture2D<float>, gSrc, t, 0, 0);
+NRI_RESOURCE(RWTexture2D<float>, gDst, u, 0, 0);
+
+[numthreads(8, 8, 1)] // HIZ_GROUP_SIZE
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+    uint2 srcSize;
+    uint2 dstSize;
+    gSrc.GetDimensions(srcSize.x, srcSize.y);
+    gDst.GetDimensions(dstSize.x, dstSize.y);
+
+    if (DTid.x >= dstSize.x || DTid.y >= dstSize.y)
+        return;
+
+    // Odd dimensions: the last texel also covers the remaining row / column
+    uint2 begin = DTid.xy * 2;
+    uint2 end;
+    end.x = DTid.x == dstSize.x - 1 ? srcSize.x - 1 : begin.x + 1;
+    end.y = DTid.y == dstSize.y - 1 ? srcSize.y - 1 : begin.y + 1;
+
+    float depth = 0.0;
+    for (uint y = begin.y; y <= end.y; y++)
+    {
+        for (uint x = begin.x; x <= end.x; x++)
+            depth = max(depth, gSrc.Load(int3(x, y, 0)));
+    }
+
+    gDst[DTid.xy] = depth;
+}
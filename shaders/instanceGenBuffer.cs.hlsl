@@ -1,93 +1,158 @@
 #include "NRICompatibility.hlsli"
 
 
-// 只读缓冲区，存储位置和初始角度
-StructuredBuffer<float4> Positions : register(t0); // 绑定到 SRV 槽位 t0
+// Instance transforms, kept up to date by "instanceScatter.cs.hlsl"
+struct InstanceTransform
+{
+    float4 rows[3]; // ".w" - translation
+};
+
+StructuredBuffer<InstanceTransform> Transforms : register(t0);
 
-// 只写缓冲区，存储变换矩阵
-RWStructuredBuffer<float4x4> Matrices : register(u0); // 绑定到 UAV 槽位 u0
+// Culling: a C++ reference lives in "GpuCulling.cpp", keep them in sync
+#define GROUP_SIZE 64 // GPU_CULLING_GROUP_SIZE
+#define CULLING_FRUSTUM 0x1
+#define CULLING_OCCLUSION 0x2
+#define ARGS_NUM 6 // GPU_CULLING_ARGS_NUM
+#define LOD_MAX_NUM 8 // GPU_CULLING_LOD_MAX_NUM
 
-struct PushConstants
+RWStructuredBuffer<uint> VisibleInstances : register(u0); // "gInstanceNum" per LOD
+RWStructuredBuffer<uint> IndirectArgs : register(u1); // per LOD: "DrawIndexedDesc" (see NRI_FILL_DRAW_INDEXED_DESC) + draw count, reset every frame
+Texture2D<float> HiZ : register(t1); // previous frame
+
+cbuffer CullingConstants : register(b1)
 {
-    float4 time;
+    float4 gPlanes[6];
+    float4x4 gPrevClipFromWorld;
+    float2 gHiZScale;
+    uint2 gHiZSize;
+    uint gHiZMipNum;
+    uint gInstanceNum;
+    float gMeshRadius;
+    uint gFlags;
+    float3 gCameraPosition;
+    uint gLodNum;
+    float4 gLodDistancesSq[LOD_MAX_NUM / 4];
 };
-NRI_ROOT_CONSTANTS( PushConstants, g_PushConstants, 0, 0 ); 
-
- 
-// 平移函数
-float4x4 translate(float4x4 m, float3 v) {
-    float4x4 Result = m;
-    Result[3] = m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3];
-    return Result;
-}
 
+// "precise" keeps the operation order of the reference (no "mad" contraction)
+bool IsInsideFrustum(float3 center, float radius)
+{
+    bool isInside = true;
+    for (uint i = 0; i < 6; i++)
+    {
+        precise float d = gPlanes[i].x * center.x + gPlanes[i].y * center.y + gPlanes[i].z * center.z + gPlanes[i].w;
+        isInside = isInside && d >= -radius;
+    }
+
+    return isInside;
+}
 
-float4x4 translate1(float4x4 m, float3 v) 
+// The bounding box of the sphere is projected with the previous frame camera and compared against the Hi-Z texels covering it
+bool IsOccluded(float3 center, float radius)
 {
-    float4x4 Result = m;
-    Result[3].x = m[3].x + v.x;
-    Result[3].y = m[3].y + v.y;
-    Result[3].z = m[3].z + v.z;
-    return Result;
+    float4x4 m = transpose(gPrevClipFromWorld); // columns
+
+    float2 uvMin = 1.0;
+    float2 uvMax = 0.0;
+    float zMin = 1.0;
+    for (uint i = 0; i < 8; i++)
+    {
+        precise float3 corner = center + float3((i & 1) ? radius : -radius, (i & 2) ? radius : -radius, (i & 4) ? radius : -radius);
+        precise float4 clip = m[0] * corner.x + m[1] * corner.y + m[2] * corner.z + m[3];
+        if (clip.z < 0.0) // crosses the near plane
+            return false;
+
+        precise float3 ndc = clip.xyz / clip.w;
+        precise float2 uv = ndc.xy * float2(0.5, -0.5) + 0.5;
+        uvMin = min(uvMin, uv);
+        uvMax = max(uvMax, uv);
+        zMin = min(zMin, ndc.z);
+    }
+
+    uint2 texelMin = min(uint2(saturate(uvMin) * gHiZScale), gHiZSize - 1);
+    uint2 texelMax = min(uint2(saturate(uvMax) * gHiZScale), gHiZSize - 1);
+
+    // The finest mip where the footprint fits into 2x2 texels
+    uint mip = 0;
+    while (mip + 1 < gHiZMipNum && any((texelMax >> mip) - (texelMin >> mip) > 1))
+        mip++;
+
+    uint2 mipSize = max(gHiZSize >> mip, 1);
+    uint2 p0 = min(texelMin >> mip, mipSize - 1);
+    uint2 p1 = min(texelMax >> mip, mipSize - 1);
+
+    float depth = max(max(HiZ.Load(int3(p0.x, p0.y, mip)), HiZ.Load(int3(p1.x, p0.y, mip))),
+        max(HiZ.Load(int3(p0.x, p1.y, mip)), HiZ.Load(int3(p1.x, p1.y, mip))));
+
+    return zMin > depth;
 }
 
-// 旋转函数（基于轴和角度）
-float4x4 rotate(float4x4 m, float angle, float3 v) { 
-    float a = angle;
-    float c = cos(a);
-    float s = sin(a); 
-
-    float3 axis = normalize(v);
-    float3 temp = (1.0f - c) * axis;
-
-    float4x4 r;
-    r[0][0] = c + temp.x * axis.x;
-    r[0][1] = temp.x * axis.y + s * axis.z;
-    r[0][2] = temp.x * axis.z - s * axis.y;
-    r[0][3] = 0.0f;
-
-    r[1][0] = temp.y * axis.x - s * axis.z;
-    r[1][1] = c + temp.y * axis.y;
-    r[1][2] = temp.y * axis.z + s * axis.x;
-    r[1][3] = 0.0f;
-
-    r[2][0] = temp.z * axis.x + s * axis.y;
-    r[2][1] = temp.z * axis.y - s * axis.x;
-    r[2][2] = c + temp.z * axis.z;
-    r[2][3] = 0.0f;
-
-    r[3] = float4(0.0f, 0.0f, 0.0f, 1.0f);
-
-    float4x4 res;
-    res[0] = m[0] * r[0][0] + m[1] * r[0][1] + m[2] * r[0][2];
-    res[1] = m[0] * r[1][0] + m[1] * r[1][1] + m[2] * r[1][2];
-    res[2] = m[0] * r[2][0] + m[1] * r[2][1] + m[2] * r[2][2];
-    res[3] = m[3];
-    return res;
+// Squared distances avoid "sqrt", which is not exact
+uint SelectLod(uint lodNum, float3 center)
+{
+    precise float3 d = center - gCameraPosition;
+    precise float distanceSq = d.x * d.x + d.y * d.y + d.z * d.z;
+
+    uint lod = 0;
+    for (uint i = 1; i < lodNum; i++)
+    {
+        if (distanceSq >= gLodDistancesSq[i >> 2][i & 3])
+            lod = i;
+    }
+
+    return lod;
 }
 
+groupshared uint s_VisibleMask[LOD_MAX_NUM][2];
+groupshared uint s_VisibleOffset[LOD_MAX_NUM];
 
-[numthreads(32, 1, 1)]
-void main(uint3 DTid : SV_DispatchThreadID) {
+[numthreads(GROUP_SIZE, 1, 1)]
+void main(uint3 DTid : SV_DispatchThreadID, uint groupIndex : SV_GroupIndex) {
     uint idx = DTid.x;
-
-    // 从 Positions 缓冲区读取中心位置和初始角度
-    float4 center = Positions[idx];
-
-    // 计算模型矩阵：先平移到 center.xyz，再绕 (1,1,1) 轴旋转
-    // float4x4 model = rotate(translate(float4x4(1.0f, 0.0f, 0.0f, 0.0f,
-    //                                           0.0f, 1.0f, 0.0f, 0.0f,
-    //                                           0.0f, 0.0f, 1.0f, 0.0f,
-    //                                           0.0f, 0.0f, 0.0f, 1.0f), 
-    //                                  float3(center.x, 0.2, center.z)), 
-    //                        g_PushConstants.time.x + center.w, 
-    //                        float3(1.0f, 1.0f, 1.0f));
-    float4x4 model = translate1(float4x4(1.0f, 0.0f, 0.0f, 0.0f,
-                        0.0f, 1.0f, 0.0f, 0.0f,
-                        0.0f, 0.0f, 1.0f, 0.0f,
-                        0.0f, 0.0f, 0.0f, 1.0f), 
-                float3(center.x, 0.2, center.z));
-
-    // 将结果写入 Matrices 缓冲区
-    Matrices[idx] = model; 
-}
\ No newline at end of file
+    uint lodNum = clamp(gLodNum, 1, LOD_MAX_NUM);
+
+    if (groupIndex < LOD_MAX_NUM * 2)
+        s_VisibleMask[groupIndex >> 1][groupIndex & 1] = 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    bool isVisible = false;
+    uint lod = 0;
+    if (idx < gInstanceNum)
+    {
+        InstanceTransform transform = Transforms[idx];
+        float3 position = float3(transform.rows[0].w, transform.rows[1].w, transform.rows[2].w);
+        isVisible = true;
+        if (gFlags & CULLING_FRUSTUM)
+            isVisible = IsInsideFrustum(position, gMeshRadius);
+        if (isVisible && (gFlags & CULLING_OCCLUSION))
+            isVisible = !IsOccluded(position, gMeshRadius);
+        if (isVisible)
+            lod = SelectLod(lodNum, position);
+    }
+
+    // Compaction: a prefix over the group visibility mask of the LOD keeps the instance order within the group
+    if (isVisible)
+        InterlockedOr(s_VisibleMask[lod][groupIndex >> 5], 1u << (groupIndex & 31));
+    GroupMemoryBarrierWithGroupSync();
+
+    if (groupIndex < lodNum)
+    {
+        uint visibleNum = countbits(s_VisibleMask[groupIndex][0]) + countbits(s_VisibleMask[groupIndex][1]);
+        if (visibleNum != 0)
+        {
+            InterlockedAdd(IndirectArgs[groupIndex * ARGS_NUM + 1], visibleNum, s_VisibleOffset[groupIndex]);
+            InterlockedOr(IndirectArgs[groupIndex * ARGS_NUM + 5], 1);
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if (isVisible)
+    {
+        uint offset = countbits(s_VisibleMask[lod][groupIndex >> 5] & ((1u << (groupIndex & 31)) - 1));
+        if (groupIndex >= 32)
+            offset += countbits(s_VisibleMask[lod][0]);
+
+        VisibleInstances[lod * gInstanceNum + s_VisibleOffset[lod] + offset] = idx;
+    }
+}
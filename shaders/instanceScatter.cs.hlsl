@@ -0,0 +1,32 @@
+#include "NRICompatibility.hlsli"
+
+// Writes changed instance transforms gathered by "utils::DirtyInstanceTracker"
+struct InstanceTransform
+{
+    float4 rows[3]; // ".w" - translation
+};
+
+struct InstanceUpdate
+{
+    InstanceTransform transform;
+    uint index;
+};
+
+NRI_RESOURCE(StructuredBuffer<InstanceUpdate>, gUpdates, t, 0, 0);
+NRI_RESOURCE(RWStructuredBuffer<InstanceTransform>, gTransforms, u, 0, 0);
+
+struct ScatterConstants
+{
+    uint updateNum;
+};
+NRI_ROOT_CONSTANTS(ScatterConstants, gScatterConstants, 0, 0);
+
+[numthreads(64, 1, 1)] // INSTANCE_SCATTER_GROUP_SIZE
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+    if (DTid.x >= gScatterConstants.updateNum)
+        return;
+
+    InstanceUpdate update = gUpdates[DTid.x];
+    gTransforms[update.index] = update.transform;
+}
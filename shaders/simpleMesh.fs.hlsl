@@ -8,14 +8,16 @@ struct InputPS
     float3 normal : NORMAL;
 };
 
-NRI_RESOURCE(Texture2D, g_DiffuseTexture, t, 0, 1);
+NRI_RESOURCE(TextureCube, g_cubeTexture, t, 0, 1 );
 NRI_RESOURCE(SamplerState, g_Sampler, s, 0, 1 );
-NRI_RESOURCE(TextureCube, g_cubeTexture, t, 1, 1 );
+NRI_RESOURCE(Texture2D, g_Textures[], t, 0, 2); // bindless texture table
 
 
 struct PushConstants
 {
-    float4 camPos;
+    float4 camPos; // w - unused
+    uint visibleOffset; // used by the vertex shader
+    uint baseColorTexture; // in "g_Textures"
 };
 NRI_ROOT_CONSTANTS( PushConstants, g_PushConstants, 1, 0 );
 
@@ -24,7 +26,7 @@ float4 main(InputPS input) : SV_Target
 {
     float2 newUV = input.uv;
     newUV.y = 1.0 - newUV.y;
-    float4 color = g_DiffuseTexture.Sample( g_Sampler, newUV);
+    float4 color = g_Textures[g_PushConstants.baseColorTexture].Sample( g_Sampler, newUV ); // resident mips only
     
     float3 n = normalize(input.normal);
 	float3 v = normalize(g_PushConstants.camPos.xyz - input.posWS);
@@ -1,25 +1,39 @@
 // © 2021 NVIDIA Corporation
 
 #include "NRICompatibility.hlsli"
+#include "VertexPacking.hlsli"
+
 NRI_RESOURCE( cbuffer, CommonConstants, b, 0, 0 )
 {
     float4x4 modelMat;
 	float4x4 viewMat;
 	float4x4 projectMat;
+    float4x4 normalMat; // transpose(inverse(modelMat)), computed on the CPU
+    float4 positionScale; // .w - normal encoding
+    float4 positionBias;
 };
 
 struct InstanceData
 {
-    float4x4 modelMat;
+    float4 rows[3]; // 3x4 transform, ".w" - translation
 };
 NRI_RESOURCE(StructuredBuffer<InstanceData>, gInstanceData, t, 0, 1);
+NRI_RESOURCE(StructuredBuffer<uint>, gVisibleInstances, t, 1, 1); // compacted by GPU culling
+
+struct PushConstants
+{
+    float4 camPos; // used by the pixel shader
+    uint visibleOffset; // LOD region in "gVisibleInstances"
+    uint baseColorTexture; // used by the pixel shader
+};
+NRI_ROOT_CONSTANTS( PushConstants, g_PushConstants, 1, 0 );
 // #endif
 
 struct inputVS
 {
     float3 in_position : POSITION0;
     float2 in_texcoord : TEXCOORD0;
-    float3 in_normal : NORMAL;
+    float4 in_normal : NORMAL;
     uint instanceID : SV_InstanceID;
 };
 
@@ -31,63 +45,24 @@ struct outputVS
     float3 normal : NORMAL;
 };
 
-float4x4 inverse(float4x4 m) {
-    float n11 = m[0][0], n12 = m[1][0], n13 = m[2][0], n14 = m[3][0];
-    float n21 = m[0][1], n22 = m[1][1], n23 = m[2][1], n24 = m[3][1];
-    float n31 = m[0][2], n32 = m[1][2], n33 = m[2][2], n34 = m[3][2];
-    float n41 = m[0][3], n42 = m[1][3], n43 = m[2][3], n44 = m[3][3];
-
-    float t11 = n23 * n34 * n42 - n24 * n33 * n42 + n24 * n32 * n43 - n22 * n34 * n43 - n23 * n32 * n44 + n22 * n33 * n44;
-    float t12 = n14 * n33 * n42 - n13 * n34 * n42 - n14 * n32 * n43 + n12 * n34 * n43 + n13 * n32 * n44 - n12 * n33 * n44;
-    float t13 = n13 * n24 * n42 - n14 * n23 * n42 + n14 * n22 * n43 - n12 * n24 * n43 - n13 * n22 * n44 + n12 * n23 * n44;
-    float t14 = n14 * n23 * n32 - n13 * n24 * n32 - n14 * n22 * n33 + n12 * n24 * n33 + n13 * n22 * n34 - n12 * n23 * n34;
-
-    float det = n11 * t11 + n21 * t12 + n31 * t13 + n41 * t14;
-    float idet = 1.0f / det;
-
-    float4x4 ret;
-
-    ret[0][0] = t11 * idet;
-    ret[0][1] = (n24 * n33 * n41 - n23 * n34 * n41 - n24 * n31 * n43 + n21 * n34 * n43 + n23 * n31 * n44 - n21 * n33 * n44) * idet;
-    ret[0][2] = (n22 * n34 * n41 - n24 * n32 * n41 + n24 * n31 * n42 - n21 * n34 * n42 - n22 * n31 * n44 + n21 * n32 * n44) * idet;
-    ret[0][3] = (n23 * n32 * n41 - n22 * n33 * n41 - n23 * n31 * n42 + n21 * n33 * n42 + n22 * n31 * n43 - n21 * n32 * n43) * idet;
-
-    ret[1][0] = t12 * idet;
-    ret[1][1] = (n13 * n34 * n41 - n14 * n33 * n41 + n14 * n31 * n43 - n11 * n34 * n43 - n13 * n31 * n44 + n11 * n33 * n44) * idet;
-    ret[1][2] = (n14 * n32 * n41 - n12 * n34 * n41 - n14 * n31 * n42 + n11 * n34 * n42 + n12 * n31 * n44 - n11 * n32 * n44) * idet;
-    ret[1][3] = (n12 * n33 * n41 - n13 * n32 * n41 + n13 * n31 * n42 - n11 * n33 * n42 - n12 * n31 * n43 + n11 * n32 * n43) * idet;
-
-    ret[2][0] = t13 * idet;
-    ret[2][1] = (n14 * n23 * n41 - n13 * n24 * n41 - n14 * n21 * n43 + n11 * n24 * n43 + n13 * n21 * n44 - n11 * n23 * n44) * idet;
-    ret[2][2] = (n12 * n24 * n41 - n14 * n22 * n41 + n14 * n21 * n42 - n11 * n24 * n42 - n12 * n21 * n44 + n11 * n22 * n44) * idet;
-    ret[2][3] = (n13 * n22 * n41 - n12 * n23 * n41 - n13 * n21 * n42 + n11 * n23 * n42 + n12 * n21 * n43 - n11 * n22 * n43) * idet;
-
-    ret[3][0] = t14 * idet;
-    ret[3][1] = (n13 * n24 * n31 - n14 * n23 * n31 + n14 * n21 * n33 - n11 * n24 * n33 - n13 * n21 * n34 + n11 * n23 * n34) * idet;
-    ret[3][2] = (n14 * n22 * n31 - n12 * n24 * n31 - n14 * n21 * n32 + n11 * n24 * n32 + n12 * n21 * n34 - n11 * n22 * n34) * idet;
-    ret[3][3] = (n12 * n23 * n31 - n13 * n22 * n31 + n13 * n21 * n32 - n11 * n23 * n32 - n12 * n21 * n33 + n11 * n22 * n33) * idet;
-
-    return ret;
-}
-
 outputVS main(inputVS input)
 {
     outputVS output;
-    float4x4 newModelMat = gInstanceData[input.instanceID].modelMat;
-    // newModelMat = inverse(newModelMat);
+    uint instanceID = gVisibleInstances[g_PushConstants.visibleOffset + input.instanceID];
+    InstanceData instance = gInstanceData[instanceID];
     float4x4 testMat = {
-        float4(1.0, 0.0, 0.0, gInstanceData[input.instanceID].modelMat[3].x), 
-        float4(0.0, 1.0, 0.0, gInstanceData[input.instanceID].modelMat[3].y), 
-        float4(0.0, 0.0, 1.0, gInstanceData[input.instanceID].modelMat[3].z), 
+        float4(1.0, 0.0, 0.0, instance.rows[0].w), 
+        float4(0.0, 1.0, 0.0, instance.rows[1].w), 
+        float4(0.0, 0.0, 1.0, instance.rows[2].w), 
         float4(0.0, 0.0, 0.0, 1.0)
     };
+    float3 position = DecodePosition(input.in_position, positionScale.xyz, positionBias.xyz);
     float4x4 vpMat = mul(viewMat, testMat);
 	float4x4 mvpMat = mul(projectMat, vpMat);
-	output.position = mul(mvpMat, float4(input.in_position.xyz, 1.0));
+	output.position = mul(mvpMat, float4(position, 1.0));
     output.texCoord = input.in_texcoord;
-    float4x4 normalMatrix = transpose(inverse(modelMat));
-    output.normal  = mul(normalMatrix, float4(input.in_normal, 1.0)).xyz;
-    output.positionWS = mul(testMat, float4(input.in_position, 1.0)).xyz; 
-    // output.positionWS = gInstanceData[input.instanceID].modelMat[3].xyz;
+    float3 normal = DecodeNormal(input.in_normal, (uint)positionScale.w);
+    output.normal  = mul((float3x3)normalMat, normal);
+    output.positionWS = mul(testMat, float4(position, 1.0)).xyz; 
     return output;
 }
@@ -0,0 +1,1305 @@
+// © 2025 NVIDIA Corporation
+
+// Headless CPU benchmarks of the framework, kept out of the sample ("DemoApp" only renders):
+//  Benchmarks <benchmark>... [--scene <path>]
+// Run without arguments to list benchmarks
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <random>
+#include <thread>
+
+#include "NRIFramework.h"
+#include "detex.h"
+
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "glm/gtc/random.hpp"
+#include "imgui.h"
+
+constexpr uint32_t SAMPLE_INSTANCE_NUM = 32 * 1024; // as in the sample
+
+// C++ allocations of the calling thread, counted by "operator new" (Detex allocates with "malloc")
+static thread_local uint32_t t_NewNum = 0;
+
+void *operator new(size_t size) {
+	t_NewNum++;
+
+	if (void *memory = malloc(size ? size : 1))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+	free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+	free(memory);
+}
+
+struct BenchmarkOptions {
+	const char *scenePath = "data/rubber_duck/scene.gltf";
+};
+
+// The instance field of the sample: "SAMPLE_INSTANCE_NUM" instances in a 1 km cube, flattened to the ground plane
+static std::vector<vec4> GenerateInstancePositions(uint32_t instanceNum) {
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+
+	std::vector<vec4> positions(instanceNum);
+	for (vec4 &p : positions)
+		p = vec4(position(rng), 0.2f, position(rng), 0.0f);
+
+	return positions;
+}
+
+// The camera flies a circle through the instance field
+static void GenerateCameraPath(uint32_t frameNum, std::vector<glm::mat4> &clipFromWorld, std::vector<glm::vec3> &cameraPositions) {
+	const glm::mat4 viewToClip = glm::perspectiveLH_ZO(glm::radians(45.0f), 900.0f / 600.0f, 0.1f, 100.0f);
+
+	clipFromWorld.resize(frameNum);
+	cameraPositions.resize(frameNum);
+	for (uint32_t i = 0; i < frameNum; i++) {
+		const float angle = 2.0f * 3.14159f * float(i) / float(frameNum);
+		cameraPositions[i] = glm::vec3(cosf(angle) * 250.0f, 0.0f, sinf(angle) * 250.0f);
+		const glm::vec3 direction = glm::vec3(-sinf(angle), 0.0f, cosf(angle));
+		clipFromWorld[i] = viewToClip * glm::lookAtLH(cameraPositions[i], cameraPositions[i] + direction, glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+}
+
+static bool MeshletCulling(const BenchmarkOptions &options) {
+	utils::Scene scene;
+	if (!utils::LoadScene(options.scenePath, scene, false) || scene.meshes.empty()) {
+		printf("Unable to load %s\n", options.scenePath);
+		return false;
+	}
+
+	const uint32_t instanceNum = SAMPLE_INSTANCE_NUM;
+	const uint32_t frameNum = 64;
+	const std::vector<vec4> instancePositions = GenerateInstancePositions(instanceNum);
+
+	std::vector<glm::mat4> clipFromWorld;
+	std::vector<glm::vec3> cameraPositions;
+	GenerateCameraPath(frameNum, clipFromWorld, cameraPositions);
+
+	const utils::MeshletCullingStats stats = utils::SimulateMeshletCulling(scene, 0, instancePositions.data(), instanceNum, clipFromWorld.data(), cameraPositions.data(), frameNum);
+
+	printf("Meshlet culling: %u meshlets x %u instances x %u frames, culled %.1f%% (frustum %.1f%%, cone %.1f%%), %.1f ms (%.1f Mtests/s)\n",
+			scene.meshes[0].meshletNum, instanceNum, frameNum, stats.GetCulledFraction() * 100.0,
+			100.0 * stats.frustumCulledNum / std::max(stats.testedNum, uint64_t(1)), 100.0 * stats.coneCulledNum / std::max(stats.testedNum, uint64_t(1)),
+			stats.time, stats.testedNum / std::max(stats.time * 1000.0, 1e-3));
+
+	return true;
+}
+
+static bool InstanceUpdates(const BenchmarkOptions &) {
+	// Random instances change every frame, regenerating all matrices is the reference
+	Timer timer;
+	const uint32_t frameNum = 64;
+
+	for (uint32_t instanceNum : { SAMPLE_INSTANCE_NUM, 1024u * 1024u }) {
+		utils::DirtyInstanceTracker tracker;
+		tracker.Initialize(instanceNum);
+		std::vector<utils::InstanceUpdate> updates(instanceNum);
+
+		for (double fraction : { 0.001, 0.01, 0.1 }) {
+			const uint32_t changedNum = std::max(uint32_t(instanceNum * fraction), 1u);
+
+			utils::InstanceUpdateStats stats = {};
+			double markingTime = 0.0;
+			for (uint32_t i = 0; i < frameNum; i++) {
+				const double markingBegin = timer.GetTimeStamp();
+				for (uint32_t j = 0; j < changedNum; j++) {
+					const uint32_t index = glm::linearRand(0u, instanceNum - 1);
+					const utils::InstanceTransform &transform = tracker.GetTransform(index);
+					tracker.SetTranslation(index, transform.rows[0][3], transform.rows[1][3] + 0.01f, transform.rows[2][3]);
+				}
+				markingTime += timer.GetTimeStamp() - markingBegin;
+
+				tracker.GatherUpdates(updates.data(), instanceNum, stats);
+			}
+
+			const double fullBytes = double(instanceNum) * sizeof(mat4);
+			printf("Instance updates (%.1f%% of %u): %.0f updates, %.1f Kb per frame (full regeneration %.1f Kb, %.2f%%), CPU %.3f ms per frame (marking %.3f ms)\n",
+					fraction * 100.0, instanceNum, double(stats.updateNum) / frameNum, stats.GetBytesPerFrame() / 1024.0, fullBytes / 1024.0,
+					100.0 * stats.GetBytesPerFrame() / fullBytes, stats.GetTimePerFrame() + markingTime / frameNum, markingTime / frameNum);
+		}
+	}
+
+	return true;
+}
+
+static bool Hierarchy(const BenchmarkOptions &) {
+	// Random trees (a parent is any earlier node), the recursive pointer tree walk is the reference
+	Timer timer;
+	const uint32_t frameNum = 16;
+	const mat4 sceneToWorld = mat4(1.0f);
+
+	for (uint32_t nodeNum : { 10u * 1024u, 1024u * 1024u }) {
+		std::vector<utils::SceneNode> nodes(nodeNum);
+		for (uint32_t i = 0; i < nodeNum; i++) {
+			utils::SceneNode &node = nodes[i];
+			node.translation = glm::linearRand(vec3(-10.0f), vec3(10.0f));
+			node.rotation = vec4(glm::normalize(glm::linearRand(vec3(-1.0f), vec3(1.0f))) * 0.38268f, 0.92388f);
+			node.scale = vec3(glm::linearRand(0.9f, 1.1f));
+
+			if (i) {
+				node.parent = &nodes[glm::linearRand(0u, i - 1)];
+				node.parent->children.push_back(&node);
+			}
+		}
+
+		double referenceTime = timer.GetTimeStamp();
+		for (uint32_t i = 0; i < frameNum; i++)
+			utils::UpdateSceneNodeTransforms(nodes[0], sceneToWorld);
+		referenceTime = (timer.GetTimeStamp() - referenceTime) / frameNum;
+
+		utils::SceneNode *root = &nodes[0];
+		utils::TransformHierarchy hierarchy;
+		hierarchy.Build(&root, 1);
+
+		utils::TransformHierarchyStats warmup = {};
+		hierarchy.Update(sceneToWorld, warmup);
+
+		for (double fraction : { 1.0, 0.01 }) {
+			const uint32_t dirtyNum = std::max(uint32_t(nodeNum * fraction), 1u);
+
+			utils::TransformHierarchyStats stats = {};
+			for (uint32_t i = 0; i < frameNum; i++) {
+				for (uint32_t j = 0; j < dirtyNum; j++) {
+					const uint32_t node = fraction == 1.0 ? j : glm::linearRand(0u, nodeNum - 1);
+					hierarchy.SetTranslation(node, vec3(0.0f, 0.01f * i, 0.0f));
+				}
+
+				hierarchy.Update(sceneToWorld, stats);
+			}
+
+			printf("Scene graph (%u nodes, %u levels, %.0f%% dirty): %.3f ms per frame, %.1f M nodes/s, %.1f%% updated (recursive walk %.3f ms, %.1f M nodes/s)\n",
+					nodeNum, hierarchy.GetLevelNum(), fraction * 100.0, stats.time / frameNum, stats.GetNodesPerSecond() / 1e6,
+					100.0 * stats.GetUpdatedFraction(), referenceTime, nodeNum / (referenceTime * 1000.0));
+		}
+	}
+
+	return true;
+}
+
+static bool Animation(const BenchmarkOptions &) {
+	// Every node has translation and rotation tracks, every other node - a scale track, 2 s at 60 keys
+	// per second. Playback at 60 fps and random scrubbing, the original reverse linear key search is the reference
+	Timer timer;
+	const uint32_t frameNum = 240;
+	const uint32_t keyNum = 120;
+
+	for (uint32_t nodeNum : { 1024u, 16u * 1024u }) {
+		std::vector<utils::SceneNode> nodes(nodeNum);
+		for (uint32_t i = 1; i < nodeNum; i++) {
+			nodes[i].parent = &nodes[(i - 1) / 4];
+			nodes[i].parent->children.push_back(&nodes[i]);
+		}
+
+		utils::Animation animation;
+		std::vector<float> keys(keyNum);
+		for (uint32_t i = 0; i < keyNum; i++)
+			keys[i] = i / 60.0f;
+
+		for (uint32_t i = 0; i < nodeNum; i++) {
+			utils::VectorAnimationTrack &positionTrack = animation.positionTracks.emplace_back();
+			utils::QuatAnimationTrack &rotationTrack = animation.rotationTracks.emplace_back();
+			positionTrack.node = rotationTrack.node = &nodes[i];
+			positionTrack.keys = rotationTrack.keys = keys;
+			positionTrack.frameCount = rotationTrack.frameCount = keyNum;
+
+			for (uint32_t j = 0; j < keyNum; j++) {
+				positionTrack.values.push_back(glm::linearRand(vec3(-1.0f), vec3(1.0f)));
+				rotationTrack.values.push_back(vec4(glm::normalize(glm::linearRand(vec3(-1.0f), vec3(1.0f))) * 0.38268f, 0.92388f));
+			}
+
+			if (i % 2) {
+				utils::VectorAnimationTrack &scaleTrack = animation.scaleTracks.emplace_back();
+				scaleTrack.node = &nodes[i];
+				scaleTrack.keys = keys;
+				scaleTrack.frameCount = keyNum;
+				for (uint32_t j = 0; j < keyNum; j++)
+					scaleTrack.values.push_back(vec3(glm::linearRand(0.9f, 1.1f)));
+			}
+		}
+
+		utils::SceneNode *root = &nodes[0];
+		utils::TransformHierarchy hierarchy;
+		hierarchy.Build(&root, 1);
+
+		utils::AnimationSampler sampler;
+		sampler.Build(animation, hierarchy);
+		const uint32_t trackNum = sampler.GetTrackNum();
+
+		double referenceTime = timer.GetTimeStamp();
+		for (uint32_t i = 0; i < frameNum; i++)
+			utils::SampleAnimationReference(animation, i / 60.0f);
+		referenceTime = timer.GetTimeStamp() - referenceTime;
+
+		utils::AnimationSamplerStats playback = {};
+		for (uint32_t i = 0; i < frameNum; i++)
+			sampler.Sample(i / 60.0f, hierarchy, playback);
+
+		utils::AnimationSamplerStats scrubbing = {};
+		for (uint32_t i = 0; i < frameNum; i++)
+			sampler.Sample(glm::linearRand(0.0f, keys.back()), hierarchy, scrubbing);
+
+		printf("Animation (%u tracks, %u keys): playback %.1f M tracks/s (%.1f%% searches), scrubbing %.1f M tracks/s (%.1f%% searches), reference %.1f M tracks/s\n",
+				trackNum, keyNum, playback.GetTracksPerSecond() / 1e6, 100.0 * playback.GetSearchFraction(), scrubbing.GetTracksPerSecond() / 1e6,
+				100.0 * scrubbing.GetSearchFraction(), double(trackNum) * frameNum / (referenceTime * 1000.0));
+	}
+
+	return true;
+}
+
+static bool UiRepacking(const BenchmarkOptions &) {
+	// A separate ImGui context, the demo window alone and with 16 extra windows (~256K vertices)
+	const uint32_t frameNum = 256;
+
+	ImGuiContext *previousContext = ImGui::GetCurrentContext();
+	ImGuiContext *context = ImGui::CreateContext();
+	ImGuiIO &io = ImGui::GetIO();
+	io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+	io.DeltaTime = 1.0f / 60.0f;
+	io.IniFilename = nullptr;
+
+	uint8_t *fontPixels = nullptr;
+	int32_t fontWidth = 0;
+	int32_t fontHeight = 0;
+	io.Fonts->GetTexDataAsAlpha8(&fontPixels, &fontWidth, &fontHeight);
+
+	std::vector<uint8_t> geometry;
+	for (uint32_t extraWindowNum : { 0u, 16u }) {
+		utils::UiRepackStats scalar = {};
+		utils::UiRepackStats simd = {};
+		utils::UiRepackStats parallel = {};
+
+		for (uint32_t i = 0; i < frameNum + 4; i++) {
+			ImGui::NewFrame();
+			ImGui::ShowDemoWindow();
+
+			for (uint32_t j = 0; j < extraWindowNum; j++) {
+				char name[32];
+				snprintf(name, sizeof(name), "Extra %u", j);
+				ImGui::SetNextWindowPos(ImVec2(float(j % 4) * 480.0f, float(j / 4) * 270.0f));
+				ImGui::SetNextWindowSize(ImVec2(480.0f, 270.0f));
+				ImGui::Begin(name);
+				ImDrawList *drawList = ImGui::GetWindowDrawList();
+				for (uint32_t k = 0; k < 4096; k++) {
+					ImVec2 p = ImVec2(float(j % 4) * 480.0f + float(k % 64) * 7.0f, float(j / 4) * 270.0f + float(k / 64) * 4.0f);
+					drawList->AddRectFilled(p, ImVec2(p.x + 5.0f, p.y + 3.0f), IM_COL32(k & 255, j * 16, 255 - (k & 255), 255));
+				}
+				ImGui::End();
+			}
+
+			ImGui::Render();
+
+			// The first frames settle window sizes
+			if (i < 4)
+				continue;
+
+			const ImDrawData &drawData = *ImGui::GetDrawData();
+			uint32_t indexDataSize = 0;
+			uint32_t vertexDataSize = 0;
+			utils::GetUiGeometrySize(drawData, indexDataSize, vertexDataSize);
+			geometry.resize(std::max(geometry.size(), size_t(indexDataSize + vertexDataSize)));
+
+			utils::RepackUiGeometry(drawData, geometry.data(), scalar, true, 1);
+			utils::RepackUiGeometry(drawData, geometry.data(), simd, false, 1);
+			utils::RepackUiGeometry(drawData, geometry.data(), parallel);
+		}
+
+		printf("UI repacking (%.0f vertices, %.1f Kb uploaded per frame): scalar %.1f us, SSE2 %.1f us, SSE2 + threads %.1f us per frame\n",
+				double(simd.vertexNum) / simd.frameNum, simd.GetBytesPerFrame() / 1024.0, scalar.GetMicrosecondsPerFrame(),
+				simd.GetMicrosecondsPerFrame(), parallel.GetMicrosecondsPerFrame());
+	}
+
+	ImGui::DestroyContext(context);
+	ImGui::SetCurrentContext(previousContext);
+
+	return true;
+}
+
+static bool CpuProfiler(const BenchmarkOptions &) {
+	// Empty scopes, i.e. the cost of the profiler itself. Rings wrap many times (the steady state)
+	const uint32_t scopeNum = 10000000;
+	const bool isEnabled = utils::IsCpuProfilerEnabled();
+
+	auto MeasureScopes = [scopeNum]() {
+		Timer timer;
+		const double begin = timer.GetTimeStamp();
+		for (uint32_t i = 0; i < scopeNum; i++) {
+			PROFILE_SCOPE("Benchmark");
+		}
+
+		return (timer.GetTimeStamp() - begin) * 1e6 / scopeNum;
+	};
+
+	utils::EnableCpuProfiler(false);
+	const double disabledTime = MeasureScopes();
+
+	utils::EnableCpuProfiler(true);
+	MeasureScopes(); // warm up (thread registration, page faults)
+	const double enabledTime = MeasureScopes();
+
+	// All threads at once, buffers are per thread
+	const uint32_t threadNum = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<double> threadTimes(threadNum);
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < threadNum; i++)
+		threads.emplace_back([&threadTimes, &MeasureScopes, i]() { threadTimes[i] = MeasureScopes(); });
+	for (std::thread &thread : threads)
+		thread.join();
+
+	utils::EnableCpuProfiler(isEnabled);
+
+	const double parallelTime = *std::max_element(threadTimes.begin(), threadTimes.end());
+	printf("CPU profiler: %.1f ns per scope, %.1f ns on %u threads at once, %.2f ns disabled - %s (budget 50 ns)\n",
+			enabledTime, parallelTime, threadNum, disabledTime, std::max(enabledTime, parallelTime) < 50.0 ? "OK" : "EXCEEDED");
+
+	return std::max(enabledTime, parallelTime) < 50.0;
+}
+
+static bool TimerAccuracy(const BenchmarkOptions &) {
+	const uint32_t callNum = 1000000;
+	Timer timer;
+
+	double begin = timer.GetTimeStamp();
+	for (uint32_t i = 0; i < callNum; i++)
+		timer.GetTimeStamp();
+	const double timeStampTime = (timer.GetTimeStamp() - begin) * 1e6 / callNum;
+
+	begin = timer.GetTimeStamp();
+	for (uint32_t i = 0; i < callNum; i++)
+		timer.UpdateFrameTime();
+	const double updateTime = (timer.GetTimeStamp() - begin) * 1e6 / callNum;
+
+	begin = timer.GetTimeStamp();
+	for (uint32_t i = 0; i < 1000; i++)
+		timer.GetFrameTimeStats();
+	const double statsTime = (timer.GetTimeStamp() - begin) * 1e3 / 1000;
+
+	printf("Timer: %.1f ns per time stamp, %.1f ns per frame update, %.2f us per statistics\n", timeStampTime, updateTime, statsTime);
+
+	// Histogram percentiles vs exact (sorted) ones: long tailed frame times, 60 fps with hitches
+	Timer histogramTimer;
+	std::vector<float> frameTimes(100000);
+	for (float &frameTime : frameTimes) {
+		const float r = glm::linearRand(0.0f, 1.0f);
+		frameTime = 16.6f + glm::linearRand(-2.0f, 2.0f) + (r > 0.98f ? 100.0f * (r - 0.98f) / 0.02f : 0.0f);
+		histogramTimer.AddFrameTime(frameTime);
+	}
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	const FrameTimeStats stats = histogramTimer.GetFrameTimeStats();
+	double maxError = 0.0;
+	for (auto [percentile, value] : { std::pair(0.5, stats.p50), std::pair(0.9, stats.p90), std::pair(0.99, stats.p99), std::pair(0.999, stats.p999) }) {
+		const double exact = frameTimes[std::max((size_t)ceil(percentile * frameTimes.size()), (size_t)1) - 1];
+		maxError = std::max(maxError, fabs(value - exact) / exact);
+	}
+	printf("  Histogram: p50 %.3f, p99 %.3f ms, %.2f%% max error - %s (budget 3%%)\n", stats.p50, stats.p99, maxError * 100.0, maxError < 0.03 ? "OK" : "EXCEEDED");
+
+	// Lateness of "SleepUntil" (the OS sleep + spinning tail)
+	for (double sleepTime : { 0.5, 1.0, 2.0, 4.0 }) {
+		const uint32_t sleepNum = 50;
+		double lateSum = 0.0;
+		double lateMax = 0.0;
+		for (uint32_t i = 0; i < sleepNum; i++) {
+			const double target = timer.GetTimeStamp() + sleepTime;
+			timer.SleepUntil(target);
+
+			const double late = timer.GetTimeStamp() - target;
+			lateSum += late;
+			lateMax = std::max(lateMax, late);
+		}
+		printf("  Sleep %.1f ms: %.1f us late on average, %.1f us max\n", sleepTime, lateSum * 1000.0 / sleepNum, lateMax * 1000.0);
+	}
+
+	return true;
+}
+
+static bool AllocationProfiler(const BenchmarkOptions &) {
+	// Allocate + free pairs of small blocks (the hot path case) through the debug allocator
+	const uint32_t pairNum = 1000000;
+	nri::AllocationCallbacks allocationCallbacks = {};
+	CreateDebugAllocator(allocationCallbacks);
+
+	auto MeasurePairs = [&allocationCallbacks, pairNum]() {
+		ALLOCATION_SCOPE(STREAMER);
+
+		Timer timer;
+		const double begin = timer.GetTimeStamp();
+		for (uint32_t i = 0; i < pairNum; i++) {
+			void *memory = allocationCallbacks.Allocate(allocationCallbacks.userArg, 16 + (i & 255), 16);
+			allocationCallbacks.Free(allocationCallbacks.userArg, memory);
+		}
+
+		return (timer.GetTimeStamp() - begin) * 1e6 / pairNum;
+	};
+
+	MeasurePairs(); // warm up
+	const double plainTime = MeasurePairs();
+
+	utils::EnableAllocationProfiler(allocationCallbacks);
+	MeasurePairs(); // call sites
+	const double profiledTime = MeasurePairs();
+
+	utils::EnableAllocationProfiler(allocationCallbacks, 1);
+	const double worstTime = MeasurePairs();
+
+	DestroyDebugAllocator(allocationCallbacks);
+
+	const double overhead = profiledTime - plainTime;
+	printf("Allocation profiler: %.1f ns per allocation + free, %.1f ns profiled (+%.1f ns, every %u-th call stack), %.1f ns with every call stack - %s (budget 50 ns)\n",
+			plainTime, profiledTime, overhead, utils::ALLOCATION_PROFILER_SAMPLE_INTERVAL, worstTime, overhead < 50.0 ? "OK" : "EXCEEDED");
+
+	return overhead < 50.0;
+}
+
+static bool InstanceCulling(const BenchmarkOptions &) {
+	// The camera flies a circle through a field of the same density
+	const uint32_t frameNum = 16;
+	const glm::mat4 p = glm::perspectiveLH_ZO(glm::radians(45.0f), 900.f / 600.f, 0.1f, 100.0f);
+
+	for (uint32_t instanceNum : { 32u * 1024u, 1024u * 1024u, 10u * 1024u * 1024u }) {
+		const float fieldSize = 500.0f * cbrtf(float(instanceNum) / float(SAMPLE_INSTANCE_NUM));
+
+		utils::InstanceBounds bounds;
+		bounds.Resize(instanceNum, true);
+		for (uint32_t i = 0; i < instanceNum; i++) {
+			const vec3 center = glm::linearRand(-vec3(fieldSize), +vec3(fieldSize));
+			const vec3 extent = glm::linearRand(vec3(0.5f), vec3(2.0f));
+			bounds.SetBox(i, &center.x, &extent.x);
+		}
+
+		std::vector<uint32_t> visibleInstances(instanceNum);
+		for (bool useBoxes : { false, true }) {
+			utils::InstanceCullingStats stats = {};
+			for (uint32_t i = 0; i < frameNum; i++) {
+				const float angle = 2.0f * 3.14159f * float(i) / float(frameNum);
+				const glm::vec3 position = glm::vec3(cosf(angle), 0.0f, sinf(angle)) * fieldSize * 0.5f;
+				const glm::vec3 direction = glm::vec3(-sinf(angle), 0.0f, cosf(angle));
+
+				utils::InstanceCullingDesc instanceCullingDesc = {};
+				instanceCullingDesc.bounds = &bounds;
+				instanceCullingDesc.clipFromWorld = p * glm::lookAtLH(position, position + direction, glm::vec3(0.0f, 1.0f, 0.0f));
+				instanceCullingDesc.visibleInstances = visibleInstances.data();
+				instanceCullingDesc.useBoxes = useBoxes;
+				utils::CullInstances(instanceCullingDesc, stats);
+			}
+
+			printf("Instance culling (%s, %s): %u instances x %u frames, %.2f%% visible, %.2f ms per frame (%.1f M instances/s)\n",
+					useBoxes ? "boxes" : "spheres", utils::IsInstanceCullingSimd() ? "AVX2" : "scalar", instanceNum, frameNum,
+					stats.GetVisibleFraction() * 100.0, stats.time / frameNum, stats.GetInstancesPerSecond() / 1e6);
+		}
+	}
+
+	return true;
+}
+
+static bool PixelConversion(const BenchmarkOptions &) {
+	// Detex conversions with all SIMD paths disabled vs the dispatched kernels, on the same data (larger than caches)
+	const uint32_t pixelNum = 4 * 1024 * 1024;
+	const uint32_t passNum = 8;
+
+	struct ConversionPair {
+		const char *name;
+		uint32_t srcFormat;
+		uint32_t dstFormat;
+	};
+
+	const ConversionPair pairs[] = {
+		{ "RGB8 => RGBX8", DETEX_PIXEL_FORMAT_RGB8, DETEX_PIXEL_FORMAT_RGBX8 },
+		{ "RGBX8 => RGB8", DETEX_PIXEL_FORMAT_RGBX8, DETEX_PIXEL_FORMAT_RGB8 },
+		{ "RGBX8 => BGRX8", DETEX_PIXEL_FORMAT_RGBX8, DETEX_PIXEL_FORMAT_BGRX8 },
+		{ "RGBX32F => RGBX16F", DETEX_PIXEL_FORMAT_FLOAT_RGBX32, DETEX_PIXEL_FORMAT_FLOAT_RGBX16 },
+		{ "RGBX16F => RGBX32F", DETEX_PIXEL_FORMAT_FLOAT_RGBX16, DETEX_PIXEL_FORMAT_FLOAT_RGBX32 },
+	};
+
+	// Bytes for 8-bit formats, HDR-like values for floats (halves are converted from them)
+	std::mt19937 rng(1);
+	std::vector<uint8_t> bytes(pixelNum * 16);
+	for (uint8_t &b : bytes)
+		b = (uint8_t)rng();
+
+	std::vector<float> floats(pixelNum * 4);
+	std::uniform_real_distribution<float> hdr(0.0f, 64.0f);
+	for (float &f : floats)
+		f = hdr(rng);
+
+	std::vector<uint8_t> halves(pixelNum * 8);
+	detexConvertPixels((uint8_t *)floats.data(), pixelNum, DETEX_PIXEL_FORMAT_FLOAT_RGBX32, halves.data(), DETEX_PIXEL_FORMAT_FLOAT_RGBX16);
+
+	const uint32_t simdSupport = detexGetSIMDSupport();
+	printf("Pixel conversion: %u pixels x %u passes, SIMD:%s%s%s\n", pixelNum, passNum, simdSupport & DETEX_SIMD_SSE4 ? " SSE4" : "",
+			simdSupport & DETEX_SIMD_AVX2 ? " AVX2" : "", simdSupport & DETEX_SIMD_F16C ? " F16C" : "");
+
+	Timer timer;
+	bool isExact = true;
+	for (const ConversionPair &pair : pairs) {
+		uint8_t *src = pair.srcFormat == DETEX_PIXEL_FORMAT_FLOAT_RGBX32 ? (uint8_t *)floats.data() : (pair.srcFormat == DETEX_PIXEL_FORMAT_FLOAT_RGBX16 ? halves.data() : bytes.data());
+		const uint32_t srcSize = detexGetPixelSize(pair.srcFormat) * pixelNum;
+		const uint32_t dstSize = detexGetPixelSize(pair.dstFormat) * pixelNum;
+
+		std::vector<uint8_t> dst[2];
+		double bandwidth[2] = {};
+		for (uint32_t mode = 0; mode < 2; mode++) {
+			detexSetSIMDSupport(mode ? simdSupport : 0);
+			dst[mode].resize(dstSize);
+
+			// The first pass warms up pages
+			double time = 0.0;
+			for (uint32_t i = 0; i <= passNum; i++) {
+				const double begin = timer.GetTimeStamp();
+				detexConvertPixels(src, pixelNum, pair.srcFormat, dst[mode].data(), pair.dstFormat);
+				if (i)
+					time += timer.GetTimeStamp() - begin;
+			}
+
+			bandwidth[mode] = double(srcSize) * passNum / (time * 1e-3) / (1024.0 * 1024.0);
+		}
+
+		// F16C rounds ties to even, the scalar code rounds them away from zero
+		uint32_t mismatchNum = 0;
+		for (uint32_t i = 0; i < dstSize; i++)
+			mismatchNum += dst[0][i] != dst[1][i] ? 1 : 0;
+
+		isExact = isExact && (mismatchNum == 0 || pair.dstFormat == DETEX_PIXEL_FORMAT_FLOAT_RGBX16);
+
+		printf("  %-20s scalar %7.0f MB/s, SIMD %7.0f MB/s (x%.1f), %u bytes differ\n", pair.name, bandwidth[0], bandwidth[1],
+				bandwidth[1] / bandwidth[0], mismatchNum);
+	}
+
+	detexSetSIMDSupport(simdSupport);
+
+	// sRGB: lookup tables vs the exact curve
+	std::vector<float> linear(pixelNum * 4);
+	std::vector<uint8_t> srgb(pixelNum * 4);
+	const int componentNum = int(pixelNum * 4);
+
+	double lutTime = timer.GetTimeStamp();
+	detexConvertSRGB8ToLinearFloat(bytes.data(), componentNum, linear.data());
+	lutTime = timer.GetTimeStamp() - lutTime;
+
+	double curveTime = timer.GetTimeStamp();
+	float maxError = 0.0f;
+	for (int i = 0; i < componentNum; i++) {
+		const float c = bytes[i] / 255.0f;
+		const float l = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+		maxError = std::max(maxError, fabsf(l - linear[i]));
+	}
+	curveTime = timer.GetTimeStamp() - curveTime;
+
+	double encodeTime = timer.GetTimeStamp();
+	detexConvertLinearFloatToSRGB8(linear.data(), componentNum, srgb.data());
+	encodeTime = timer.GetTimeStamp() - encodeTime;
+
+	const bool isRoundTrip = !memcmp(srgb.data(), bytes.data(), srgb.size());
+	printf("  %-20s LUT %7.0f MB/s (curve %.0f MB/s), max error %.1e; linear => sRGB8 %.0f MB/s, round trip %s\n", "sRGB8 => linear",
+			componentNum / (lutTime * 1e-3) / (1024.0 * 1024.0), componentNum / (curveTime * 1e-3) / (1024.0 * 1024.0), maxError,
+			componentNum * sizeof(float) / (encodeTime * 1e-3) / (1024.0 * 1024.0), isRoundTrip ? "exact" : "FAILED");
+
+	return isExact && isRoundTrip;
+}
+
+static uint32_t g_NriErrorNum = 0;
+
+static void NriMessageCallback(nri::Message messageType, const char *, uint32_t, const char *message, void *) {
+	if (messageType == nri::Message::ERROR)
+		g_NriErrorNum++;
+
+	if (messageType != nri::Message::INFO)
+		printf("  NRI: %s\n", message);
+}
+
+static void NriAbortExecution(void *) {
+}
+
+// NRI validation errors are counted in "g_NriErrorNum"
+static nri::Device *CreateNoneDevice() {
+	nri::DeviceCreationDesc deviceCreationDesc = {};
+	deviceCreationDesc.graphicsAPI = nri::GraphicsAPI::NONE;
+	deviceCreationDesc.enableNRIValidation = true;
+	deviceCreationDesc.callbackInterface.MessageCallback = NriMessageCallback;
+	deviceCreationDesc.callbackInterface.AbortExecution = NriAbortExecution;
+
+	g_NriErrorNum = 0;
+
+	nri::Device *device = nullptr;
+	if (nri::nriCreateDevice(deviceCreationDesc, device) != nri::Result::SUCCESS) {
+		printf("Can't create a NONE device\n");
+		return nullptr;
+	}
+
+	return device;
+}
+
+static bool GpuProfilerCheck(const BenchmarkOptions &) {
+	// The NONE backend records nothing and has no readback: validation checks the query calls, timestamps are synthetic
+	nri::Device *device = CreateNoneDevice();
+	if (!device)
+		return false;
+
+	nri::CoreInterface NRI = {};
+	nri::HelperInterface helperInterface = {};
+	nri::Queue *queue = nullptr;
+	nri::CommandAllocator *commandAllocator = nullptr;
+	nri::CommandBuffer *commandBuffer = nullptr;
+	utils::GpuProfiler profiler;
+
+	bool isOk = nri::nriGetInterface(*device, NRI_INTERFACE(nri::CoreInterface), &NRI) == nri::Result::SUCCESS &&
+			nri::nriGetInterface(*device, NRI_INTERFACE(nri::HelperInterface), &helperInterface) == nri::Result::SUCCESS &&
+			NRI.GetQueue(*device, nri::QueueType::GRAPHICS, 0, queue) == nri::Result::SUCCESS &&
+			NRI.CreateCommandAllocator(*queue, commandAllocator) == nri::Result::SUCCESS &&
+			NRI.CreateCommandBuffer(*commandAllocator, commandBuffer) == nri::Result::SUCCESS &&
+			profiler.Initialize(NRI, helperInterface, *device, BUFFERED_FRAME_MAX_NUM);
+
+	// Pre-order, the depth of the next range tells where the previous ones end
+	struct TreeRange {
+		const char *name;
+		uint32_t depth;
+	};
+
+	const TreeRange tree[] = {
+		{ "Frame", 0 },
+		{ "Culling", 1 },
+		{ "HiZ", 2 },
+		{ "Instances", 2 },
+		{ "Opaque", 1 },
+		{ "Post", 1 },
+		{ "Bloom", 2 },
+		{ "Downsample", 3 },
+		{ "Tonemap", 2 },
+		{ "UI", 0 },
+	};
+
+	const uint32_t treeRangeNum = helper::GetCountOf(tree);
+	const uint32_t frameNum = 16;
+	const uint32_t overflowFrame = 7; // gets extra ranges above "GPU_PROFILER_RANGE_MAX_NUM"
+	const uint32_t overflowRangeNum = utils::GPU_PROFILER_RANGE_MAX_NUM + 22;
+	const double frequencyHz = 1e6; // 1 tick = 1 us
+
+	// The clock advances by a frame-dependent step per recorded begin / end, durations differ between frames
+	std::vector<std::vector<uint64_t>> timestamps(frameNum);
+	uint32_t resolvedNum = 0;
+
+	for (uint32_t frameIndex = 0; frameIndex < frameNum && isOk; frameIndex++) {
+		std::vector<uint64_t> &frameTimestamps = timestamps[frameIndex];
+		uint64_t clock = 1000000 * uint64_t(frameIndex + 1);
+		const uint64_t step = 10 + frameIndex;
+
+		NRI.BeginCommandBuffer(*commandBuffer, nullptr);
+		profiler.BeginFrame(NRI, *commandBuffer, frameIndex);
+
+		std::vector<uint32_t> openRanges; // recording order indices, "uint32_t(-1)" above the limit
+		std::vector<uint32_t> openIndices;
+		auto EndRanges = [&](uint32_t depth) {
+			while (openRanges.size() > depth) {
+				profiler.EndRange(NRI, *commandBuffer, openRanges.back());
+				if (openIndices.back() < utils::GPU_PROFILER_RANGE_MAX_NUM)
+					frameTimestamps[openIndices.back() * 2 + 1] = clock;
+
+				clock += step;
+				openRanges.pop_back();
+				openIndices.pop_back();
+			}
+		};
+
+		uint32_t rangeNum = treeRangeNum + (frameIndex == overflowFrame ? overflowRangeNum : 0);
+		frameTimestamps.resize(std::min(rangeNum, utils::GPU_PROFILER_RANGE_MAX_NUM) * 2);
+
+		for (uint32_t i = 0; i < rangeNum; i++) {
+			const TreeRange &range = i < treeRangeNum ? tree[i] : TreeRange{ "Overflow", 1 };
+			EndRanges(range.depth);
+
+			openRanges.push_back(profiler.BeginRange(NRI, *commandBuffer, range.name));
+			openIndices.push_back(i);
+			if (i < utils::GPU_PROFILER_RANGE_MAX_NUM)
+				frameTimestamps[i * 2] = clock;
+
+			clock += step;
+
+			// Overflow ranges are children of "UI", ranges above the limit are not measured
+			isOk = isOk && (openRanges.back() == (i < utils::GPU_PROFILER_RANGE_MAX_NUM ? i : uint32_t(-1)));
+		}
+		EndRanges(0);
+
+		profiler.EndFrame(NRI, *commandBuffer);
+		NRI.EndCommandBuffer(*commandBuffer);
+
+		// Readback latency: the oldest frame in flight completes right before its slot is reused by the next "BeginFrame"
+		if (frameIndex + 1 >= BUFFERED_FRAME_MAX_NUM) {
+			const uint32_t completedFrame = frameIndex + 1 - BUFFERED_FRAME_MAX_NUM;
+			profiler.ResolveFrame(completedFrame, timestamps[completedFrame].data(), frequencyHz);
+			resolvedNum++;
+
+			// A second resolve of the same frame is ignored
+			profiler.ResolveFrame(completedFrame, timestamps[completedFrame].data(), frequencyHz);
+		}
+
+		// A frame whose slot has been reused can't be resolved
+		if (frameIndex >= BUFFERED_FRAME_MAX_NUM)
+			profiler.ResolveFrame(frameIndex - BUFFERED_FRAME_MAX_NUM, timestamps[frameIndex - BUFFERED_FRAME_MAX_NUM].data(), frequencyHz);
+	}
+
+	// Expected: the tree in the order of first appearance (overflow ranges last), times of the last resolved frame
+	const uint32_t lastResolvedFrame = frameNum - BUFFERED_FRAME_MAX_NUM;
+	const std::vector<utils::GpuRangeStats> &stats = profiler.GetStats();
+	uint32_t treeErrorNum = 0;
+
+	isOk = isOk && profiler.GetResolvedFrameNum() == resolvedNum && stats.size() == treeRangeNum + 1;
+	for (uint32_t i = 0; i < treeRangeNum && isOk; i++) {
+		const utils::GpuRangeStats &rangeStats = stats[i];
+		const std::vector<uint64_t> &lastTimestamps = timestamps[lastResolvedFrame];
+		const double expectedTime = double(lastTimestamps[i * 2 + 1] - lastTimestamps[i * 2]) * 1000.0 / frequencyHz;
+
+		double expectedMax = 0.0;
+		for (uint32_t j = 0; j <= lastResolvedFrame; j++)
+			expectedMax = std::max(expectedMax, double(timestamps[j][i * 2 + 1] - timestamps[j][i * 2]) * 1000.0 / frequencyHz);
+
+		const bool isRangeOk = !strcmp(rangeStats.name, tree[i].name) && rangeStats.depth == tree[i].depth &&
+				fabs(rangeStats.time - expectedTime) < 1e-9 && fabs(rangeStats.max - expectedMax) < 1e-9;
+
+		printf("  %*s%-*s %.3f ms (avg %.3f, max %.3f)%s\n", rangeStats.depth * 2, "", 16 - rangeStats.depth * 2, rangeStats.name,
+				rangeStats.time, rangeStats.average, rangeStats.max, isRangeOk ? "" : " - MISMATCH");
+
+		treeErrorNum += isRangeOk ? 0 : 1;
+	}
+
+	printf("GPU profiler: %u frames, %u in flight, %u resolved (%u expected), %u / %u ranges measured in the overflow frame, %u tree errors, %u NRI errors\n",
+			frameNum, BUFFERED_FRAME_MAX_NUM, profiler.GetResolvedFrameNum(), resolvedNum, utils::GPU_PROFILER_RANGE_MAX_NUM,
+			treeRangeNum + overflowRangeNum, treeErrorNum, g_NriErrorNum);
+
+	profiler.Destroy(NRI);
+	if (commandBuffer)
+		NRI.DestroyCommandBuffer(*commandBuffer);
+	if (commandAllocator)
+		NRI.DestroyCommandAllocator(*commandAllocator);
+	nri::nriDestroyDevice(*device);
+
+	return isOk && !treeErrorNum && !g_NriErrorNum;
+}
+
+// A "size x size" RGBA8 texture with mips, allocated the detex way ("~Texture" frees it)
+static void GenerateStreamedTexture(uint32_t size, uint32_t seed, utils::Texture &texture) {
+	detexTexture **mips = (detexTexture **)malloc(sizeof(detexTexture *));
+	mips[0] = (detexTexture *)malloc(sizeof(detexTexture));
+	mips[0]->format = DETEX_PIXEL_FORMAT_RGBA8;
+	mips[0]->width = (int)size;
+	mips[0]->height = (int)size;
+	mips[0]->width_in_blocks = (int)size;
+	mips[0]->height_in_blocks = (int)size;
+	mips[0]->data = (uint8_t *)malloc(size_t(size) * size * 4);
+
+	for (uint32_t i = 0; i < size * size; i++)
+		((uint32_t *)mips[0]->data)[i] = ((i % size) ^ (i / size)) * 0x01010101u + seed;
+
+	texture.name = "streamed";
+	texture.mips = (utils::Mip *)mips;
+	texture.format = nri::Format::RGBA8_UNORM;
+	texture.width = (uint16_t)size;
+	texture.height = (uint16_t)size;
+	texture.depth = 1;
+	texture.mipNum = 1;
+	texture.layerNum = 1;
+
+	utils::GenerateMips(texture);
+}
+
+// As "ReleaseTextureMips" in the sample: the returned size is a promise, kept until the replaced textures are released
+static uint64_t ReleaseTextureMips(const utils::MemoryPressure &pressure, void *userArg) {
+	TextureResidencyManager &textureResidency = *(TextureResidencyManager *)userArg;
+
+	if (!pressure.releaseSize) {
+		textureResidency.SetMemoryBudget(TextureResidencyDesc().memoryBudget);
+		return 0;
+	}
+
+	const uint64_t residentSize = std::min(textureResidency.GetStats().residentSize, textureResidency.GetMemoryBudget());
+	const uint64_t releaseSize = std::min(pressure.releaseSize, residentSize);
+	textureResidency.SetMemoryBudget(residentSize - releaseSize);
+
+	return releaseSize;
+}
+
+static bool TextureStreaming(const BenchmarkOptions &) {
+	// Textures are placed along a corridor, the camera flies through it and back, then stops and the (simulated) device
+	// budget drops to a half of the allocated size: the memory governor asks for mips as in the sample. The NONE backend
+	// doesn't execute uploads, but textures, memory and streamer requests are real (and validated)
+	const uint32_t textureNum = 32;
+	const uint32_t textureSize = 1024;
+	const uint32_t forwardFrameNum = 480;
+	const uint32_t backwardFrameNum = 240;
+	const uint32_t settleFrameNum = 60;
+	const uint32_t viewportHeight = 1080;
+	const float spacing = 32.0f;
+
+	TextureResidencyDesc textureResidencyDesc = {};
+	textureResidencyDesc.memoryBudget = 32 * 1024 * 1024;
+	textureResidencyDesc.uploadBudgetPerFrame = 4 * 1024 * 1024;
+
+	nri::Device *device = CreateNoneDevice();
+	if (!device)
+		return false;
+
+	nri::CoreInterface NRI = {};
+	nri::HelperInterface helperInterface = {};
+	nri::StreamerInterface streamerInterface = {};
+	nri::Streamer *streamer = nullptr;
+	nri::Queue *queue = nullptr;
+	nri::CommandAllocator *commandAllocator = nullptr;
+	nri::CommandBuffer *commandBuffer = nullptr;
+
+	nri::StreamerDesc streamerDesc = {};
+	streamerDesc.dynamicBufferMemoryLocation = nri::MemoryLocation::HOST_UPLOAD;
+	streamerDesc.dynamicBufferUsageBits = nri::BufferUsageBits::SHADER_RESOURCE;
+	streamerDesc.constantBufferMemoryLocation = nri::MemoryLocation::HOST_UPLOAD;
+	streamerDesc.frameInFlightNum = BUFFERED_FRAME_MAX_NUM;
+
+	bool isOk = nri::nriGetInterface(*device, NRI_INTERFACE(nri::CoreInterface), &NRI) == nri::Result::SUCCESS &&
+			nri::nriGetInterface(*device, NRI_INTERFACE(nri::HelperInterface), &helperInterface) == nri::Result::SUCCESS &&
+			nri::nriGetInterface(*device, NRI_INTERFACE(nri::StreamerInterface), &streamerInterface) == nri::Result::SUCCESS &&
+			streamerInterface.CreateStreamer(*device, streamerDesc, streamer) == nri::Result::SUCCESS &&
+			NRI.GetQueue(*device, nri::QueueType::GRAPHICS, 0, queue) == nri::Result::SUCCESS &&
+			NRI.CreateCommandAllocator(*queue, commandAllocator) == nri::Result::SUCCESS &&
+			NRI.CreateCommandBuffer(*commandAllocator, commandBuffer) == nri::Result::SUCCESS;
+
+	if (!isOk) {
+		printf("Can't initialize NRI\n");
+		nri::nriDestroyDevice(*device);
+		return false;
+	}
+
+	std::vector<utils::Texture> textures(textureNum); // never reallocated, the manager keeps pointers
+	uint64_t textureDataSize = 0;
+	for (uint32_t i = 0; i < textureNum; i++) {
+		GenerateStreamedTexture(textureSize, i, textures[i]);
+
+		for (uint32_t mip = 0; mip < textures[i].GetMipNum(); mip++) {
+			nri::TextureSubresourceUploadDesc subresource = {};
+			textures[i].GetSubresource(subresource, mip);
+			textureDataSize += subresource.slicePitch;
+		}
+	}
+
+	TextureResidencyManager textureResidency;
+	textureResidency.Initialize(NRI, helperInterface, streamerInterface, *device, *streamer, textureResidencyDesc);
+
+	// Polled every frame to catch repeated callbacks while evicted mips are waiting for frames in flight
+	utils::MemoryGovernorDesc memoryGovernorDesc = {};
+	memoryGovernorDesc.pollInterval = 1;
+
+	utils::MemoryGovernor memoryGovernor;
+	memoryGovernor.Initialize(NRI, helperInterface, *device, memoryGovernorDesc);
+	memoryGovernor.AddPressureCallback(utils::MemorySegment::LOCAL, 100, ReleaseTextureMips, &textureResidency, "Texture mips");
+
+	const uint32_t textureMemory = memoryGovernor.Track(nri::MemoryLocation::DEVICE, utils::MemoryCategory::TEXTURES, 0);
+
+	// 4 instances per texture, on both sides of the corridor
+	for (uint32_t i = 0; i < textureNum && isOk; i++) {
+		const uint32_t textureIndex = textureResidency.AddTexture(textures[i]);
+		isOk = textureIndex != utils::InvalidIndex;
+
+		for (uint32_t j = 0; j < 4 && isOk; j++)
+			textureResidency.AddInstance(textureIndex, vec3(float(i) * spacing + float(j % 2) * 4.0f, 1.0f, j < 2 ? -6.0f : 6.0f), 1.5f);
+	}
+
+	CameraState cameraState = {};
+	cameraState.mViewToClip = glm::perspectiveLH_ZO(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+
+	const float pathBegin = -spacing;
+	const float pathEnd = float(textureNum) * spacing;
+	const uint32_t budgetDropFrame = forwardFrameNum + backwardFrameNum + settleFrameNum;
+	const uint32_t frameNum = budgetDropFrame + BUFFERED_FRAME_MAX_NUM + 2; // + a check after the release
+
+	Timer timer;
+	double updateTimeSum = 0.0;
+	double updateTimeMax = 0.0;
+	uint64_t uploadedSize = 0;
+	uint64_t uploadedSizeMax = 0;
+	uint64_t releasedSize = 0;
+	uint64_t residentSizeMax = 0;
+	uint64_t allocatedSizeMax = 0;
+	uint64_t allocatedSizeBeforeDrop = 0;
+	uint32_t uploadedMipNum = 0;
+	uint32_t evictedMipNum = 0;
+	uint32_t replacedTextureNum = 0;
+	uint32_t overBudgetFrameNum = 0;
+	uint32_t pendingMipNumAfterSettle = 0;
+	uint32_t underTrackedFrameNum = 0;
+
+	for (uint32_t frameIndex = 0; frameIndex < frameNum && isOk; frameIndex++) {
+		float x = pathEnd;
+		if (frameIndex < forwardFrameNum)
+			x = glm::mix(pathBegin, pathEnd, float(frameIndex) / float(forwardFrameNum));
+		else if (frameIndex < forwardFrameNum + backwardFrameNum)
+			x = glm::mix(pathEnd, pathBegin, float(frameIndex - forwardFrameNum) / float(backwardFrameNum));
+		else
+			x = pathBegin;
+
+		cameraState.globalPosition = vec3(x, 2.0f, 0.0f);
+
+		if (frameIndex == budgetDropFrame) {
+			pendingMipNumAfterSettle = textureResidency.GetStats().pendingMipNum;
+			allocatedSizeBeforeDrop = textureResidency.GetStats().allocatedSize;
+			memoryGovernor.SetSimulatedBudget(utils::MemorySegment::LOCAL, allocatedSizeBeforeDrop / 2);
+		}
+
+		// As in "PrepareFrame"
+		memoryGovernor.Update();
+
+		const double updateBegin = timer.GetTimeStamp();
+		textureResidency.Update(cameraState.globalPosition, cameraState.mViewToClip, viewportHeight, frameIndex);
+		const double updateTime = timer.GetTimeStamp() - updateBegin;
+
+		memoryGovernor.Resize(textureMemory, textureResidency.GetStats().allocatedSize);
+
+		streamerInterface.CopyStreamerUpdateRequests(*streamer);
+
+		// Recording as in the sample
+		std::vector<nri::TextureBarrierDesc> toCopyDestination;
+		std::vector<nri::TextureBarrierDesc> toShaderResource;
+		textureResidency.GatherUploadBarriers(toCopyDestination, toShaderResource);
+
+		NRI.ResetCommandAllocator(*commandAllocator);
+		NRI.BeginCommandBuffer(*commandBuffer, nullptr);
+		{
+			nri::BarrierGroupDesc barrierGroupDesc = {};
+			barrierGroupDesc.textureNum = (uint32_t)toCopyDestination.size();
+			barrierGroupDesc.textures = toCopyDestination.data();
+			if (barrierGroupDesc.textureNum)
+				NRI.CmdBarrier(*commandBuffer, barrierGroupDesc);
+
+			streamerInterface.CmdUploadStreamerUpdateRequests(*commandBuffer, *streamer);
+
+			barrierGroupDesc.textures = toShaderResource.data();
+			if (barrierGroupDesc.textureNum)
+				NRI.CmdBarrier(*commandBuffer, barrierGroupDesc);
+		}
+		NRI.EndCommandBuffer(*commandBuffer);
+
+		const TextureResidencyStats &stats = textureResidency.GetStats();
+		const uint64_t memoryBudget = textureResidency.GetMemoryBudget();
+
+		updateTimeSum += updateTime;
+		updateTimeMax = std::max(updateTimeMax, updateTime);
+		uploadedSize += stats.uploadedSize;
+		uploadedSizeMax = std::max(uploadedSizeMax, stats.uploadedSize);
+		releasedSize += stats.releasedSize;
+		residentSizeMax = std::max(residentSizeMax, stats.residentSize);
+		allocatedSizeMax = std::max(allocatedSizeMax, stats.allocatedSize);
+		uploadedMipNum += stats.uploadedMipNum;
+		evictedMipNum += stats.evictedMipNum;
+		replacedTextureNum += stats.replacedTextureNum;
+		overBudgetFrameNum += stats.residentSize > memoryBudget ? 1 : 0;
+
+		// Usage must not drop before the memory is released
+		const utils::MemorySegmentStats &memoryStats = memoryGovernor.GetStats(utils::MemorySegment::LOCAL);
+		underTrackedFrameNum += memoryStats.usageSize < stats.allocatedSize ? 1 : 0;
+	}
+
+	const TextureResidencyStats &stats = textureResidency.GetStats();
+	const utils::MemorySegmentStats &memoryStats = memoryGovernor.GetStats(utils::MemorySegment::LOCAL);
+	const uint64_t targetSize = uint64_t(double(memoryStats.budgetSize) * memoryGovernorDesc.targetUsage);
+	const double mb = 1.0 / (1024.0 * 1024.0);
+
+	printf("Texture streaming: %u textures %ux%u (%.1f Mb with mips), budget %.1f Mb, %.1f Mb per frame, %u frames\n",
+			textureNum, textureSize, textureSize, textureDataSize * mb, textureResidencyDesc.memoryBudget * mb,
+			textureResidencyDesc.uploadBudgetPerFrame * mb, frameNum);
+	printf("  update: %.1f us per frame (max %.1f us)\n", updateTimeSum * 1000.0 / frameNum, updateTimeMax * 1000.0);
+	printf("  streamed: %u mips, %.1f Mb uploaded (max %.1f Mb per frame, resident mips re-uploaded), %u evicted, %u textures recreated\n",
+			uploadedMipNum, uploadedSize * mb, uploadedSizeMax * mb, evictedMipNum, replacedTextureNum);
+	printf("  resident: max %.1f Mb, %u frames over budget, %u mips pending after the path\n",
+			residentSizeMax * mb, overBudgetFrameNum, pendingMipNumAfterSettle);
+	printf("  device memory: max %.1f Mb allocated, %.1f Mb released; budget %.1f Mb (target %.1f Mb): %.1f => %.1f Mb allocated (%.1f Mb resident, %.1f Mb releasing)\n",
+			allocatedSizeMax * mb, releasedSize * mb, memoryStats.budgetSize * mb, targetSize * mb, allocatedSizeBeforeDrop * mb,
+			stats.allocatedSize * mb, stats.residentSize * mb, stats.releasingSize * mb);
+	printf("  governor: %.1f Mb usage, %u pressure callbacks, %.1f Mb promised, %.1f Mb pending, %u frames under the allocated size\n",
+			memoryStats.usageSize * mb, memoryStats.pressureNum, memoryStats.releasedSize * mb, memoryStats.pendingReleaseSize * mb,
+			underTrackedFrameNum);
+	printf("  %u NRI errors\n", g_NriErrorNum);
+
+	// After the budget drop, the callback fires once, replaced textures are released once frames in flight are done and
+	// only then the usage gets under the target
+	isOk = isOk && !overBudgetFrameNum && !pendingMipNumAfterSettle && !stats.releasingSize && !underTrackedFrameNum &&
+			memoryStats.pressureNum == 1 && !memoryStats.pendingReleaseSize && memoryStats.usageSize <= targetSize && !g_NriErrorNum;
+
+	textureResidency.Destroy();
+	NRI.DestroyCommandBuffer(*commandBuffer);
+	NRI.DestroyCommandAllocator(*commandAllocator);
+	streamerInterface.DestroyStreamer(*streamer);
+	nri::nriDestroyDevice(*device);
+
+	return isOk;
+}
+
+static bool AssetLoading(const BenchmarkOptions &options) {
+	// The sample's assets (the scene is imported without the cache), a few copies of each to have more jobs than threads.
+	// Loading on the calling thread ("isSerial") is the reference, results must match. The parallel loader must be faster
+	// if the shared job system has workers, otherwise its overhead must stay within 10%
+	const uint32_t copyNum = 4;
+	const char *texturePaths[] = { "Duck_baseColor.png", "test.dds", "barcelona.dds" };
+	const uint32_t textureNum = copyNum * helper::GetCountOf(texturePaths);
+
+	struct Result {
+		double time;
+		uint32_t failedNum;
+		std::vector<uint32_t> signature; // mesh and index numbers, texture dimensions and formats
+	};
+
+	auto Load = [&](bool isSerial) {
+		std::vector<utils::Scene> scenes(copyNum);
+		std::vector<utils::Texture> textures(textureNum);
+
+		Timer timer;
+		const double begin = timer.GetTimeStamp();
+
+		AssetLoaderDesc assetLoaderDesc = {};
+		assetLoaderDesc.isSerial = isSerial;
+
+		AssetLoader assetLoader;
+		assetLoader.Initialize(assetLoaderDesc);
+
+		std::vector<AssetHandle> handles;
+		for (uint32_t i = 0; i < copyNum; i++) {
+			utils::Scene &scene = scenes[i];
+			handles.push_back(assetLoader.Run([&options, &scene]() { return utils::LoadScene(options.scenePath, scene, false); }));
+
+			for (uint32_t j = 0; j < helper::GetCountOf(texturePaths); j++) {
+				utils::Texture &texture = textures[i * helper::GetCountOf(texturePaths) + j];
+				handles.push_back(assetLoader.LoadTexture(utils::GetFullPath(texturePaths[j], utils::DataFolder::TEXTURES), texture));
+			}
+		}
+
+		Result result = {};
+		for (const AssetHandle &handle : handles)
+			result.failedNum += assetLoader.Wait(handle) ? 0 : 1;
+
+		assetLoader.Shutdown();
+		result.time = timer.GetTimeStamp() - begin;
+
+		for (const utils::Scene &scene : scenes)
+			result.signature.insert(result.signature.end(), { (uint32_t)scene.meshes.size(), (uint32_t)scene.indices.size() });
+		for (const utils::Texture &texture : textures)
+			result.signature.insert(result.signature.end(), { texture.width, texture.height, texture.mipNum, (uint32_t)texture.format });
+
+		return result;
+	};
+
+	Load(true); // warm up (file cache)
+	const Result serial = Load(true);
+	const Result parallel = Load(false);
+
+	const uint32_t threadNum = utils::JobSystem::GetShared().GetThreadNum();
+	const bool isFaster = threadNum > 1 ? parallel.time < serial.time : parallel.time <= serial.time * 1.1;
+	const bool isMatching = parallel.signature == serial.signature;
+
+	printf("Asset loading: %u scenes + %u textures, serial %.1f ms, parallel %.1f ms (x%.2f, %u threads), %u + %u failed, results %s - %s\n",
+			copyNum, textureNum, serial.time, parallel.time, serial.time / std::max(parallel.time, 1e-3), threadNum,
+			serial.failedNum, parallel.failedNum, isMatching ? "match" : "DIFFER", isFaster ? "OK" : "SLOWER");
+
+	return isFaster && isMatching && !serial.failedNum && !parallel.failedNum;
+}
+
+// Writes "texture" as KTX2 without supercompression, the smallest mip first (no DFD, "Ktx2Texture" doesn't need it)
+static bool WriteKtx2(const std::string &path, const utils::Texture &texture) {
+	const uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+	const uint32_t mipNum = texture.GetMipNum();
+
+	// "nriConvertNRIFormatToVK" returns 0 without VK support, the reverse mapping is always there (core formats are below 185)
+	uint32_t vkFormat = 1;
+	while (vkFormat < 185 && nri::nriConvertVKFormatToNRI(vkFormat) != texture.GetFormat())
+		vkFormat++;
+
+	if (vkFormat == 185)
+		return false;
+
+	// vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth, layerCount, faceCount, levelCount, supercompressionScheme,
+	// DFD and KVD offsets and sizes, SGD offset and size (64-bit)
+	uint32_t header[13] = { vkFormat, 1, texture.GetWidth(), texture.GetHeight(), 0, 0, 1, mipNum };
+	uint64_t supercompressionGlobalData[2] = {};
+
+	// byteOffset, byteLength, uncompressedByteLength
+	std::vector<uint64_t> levelIndex(mipNum * 3);
+	uint64_t offset = sizeof(identifier) + sizeof(header) + sizeof(supercompressionGlobalData) + levelIndex.size() * sizeof(uint64_t);
+	for (uint32_t mip = mipNum; mip-- > 0;) {
+		nri::TextureSubresourceUploadDesc subresource = {};
+		texture.GetSubresource(subresource, mip);
+
+		levelIndex[mip * 3] = offset;
+		levelIndex[mip * 3 + 1] = subresource.slicePitch;
+		levelIndex[mip * 3 + 2] = subresource.slicePitch;
+		offset += subresource.slicePitch;
+	}
+
+	FILE *file = fopen(path.c_str(), "wb");
+	if (!file)
+		return false;
+
+	bool isOk = fwrite(identifier, sizeof(identifier), 1, file) == 1 && fwrite(header, sizeof(header), 1, file) == 1 &&
+			fwrite(supercompressionGlobalData, sizeof(supercompressionGlobalData), 1, file) == 1 &&
+			fwrite(levelIndex.data(), levelIndex.size() * sizeof(uint64_t), 1, file) == 1;
+
+	for (uint32_t mip = mipNum; mip-- > 0 && isOk;) {
+		nri::TextureSubresourceUploadDesc subresource = {};
+		texture.GetSubresource(subresource, mip);
+
+		isOk = fwrite(subresource.slices, subresource.slicePitch, 1, file) == 1;
+	}
+
+	fclose(file);
+
+	return isOk;
+}
+
+static bool KtxLoading(const BenchmarkOptions &) {
+	// "data/*.ktx" (KTX1) through Detex vs the same payload rewritten as KTX2 through "Ktx2Texture". Detex reads the first
+	// face of cubemaps only, the KTX2 copy has the same payload. The results must match byte to byte
+	const uint32_t loadNum = 100;
+	bool isOk = true;
+
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator("data")) {
+		if (entry.path().extension() != ".ktx")
+			continue;
+
+		const std::string path = entry.path().string();
+		const std::string ktx2Path = (std::filesystem::temp_directory_path() / (entry.path().filename().string() + "2")).string();
+
+		utils::Texture reference;
+		if (!utils::LoadTexture(path, reference) || !WriteKtx2(ktx2Path, reference)) {
+			printf("Can't convert '%s' to KTX2\n", path.c_str());
+			isOk = false;
+			continue;
+		}
+
+		uint64_t dataSize = 0;
+		for (uint32_t mip = 0; mip < reference.GetMipNum(); mip++) {
+			nri::TextureSubresourceUploadDesc subresource = {};
+			reference.GetSubresource(subresource, mip);
+			dataSize += subresource.slicePitch;
+		}
+
+		Timer timer;
+		uint32_t failedNum = 0;
+
+		double begin = timer.GetTimeStamp();
+		for (uint32_t i = 0; i < loadNum; i++) {
+			detexTexture **mips = nullptr;
+			int mipNum = 0;
+			if (detexLoadKTXFileWithMipmaps(path.c_str(), 32, &mips, &mipNum))
+				detexFreeTexture(mips, mipNum);
+			else
+				failedNum++;
+		}
+		const double ktx1Time = (timer.GetTimeStamp() - begin) / loadNum;
+
+		// Detex: the mip array + a "detexTexture" and its data per level (+ key / value data, if any)
+		const uint32_t ktx1AllocationNum = 1 + 2 * reference.GetMipNum();
+
+		t_NewNum = 0;
+		begin = timer.GetTimeStamp();
+		for (uint32_t i = 0; i < loadNum; i++) {
+			utils::Ktx2Texture ktx2;
+			if (!ktx2.Open(ktx2Path) || !ktx2.Read())
+				failedNum++;
+		}
+		const double ktx2Time = (timer.GetTimeStamp() - begin) / loadNum;
+		const double ktx2AllocationNum = double(t_NewNum) / loadNum;
+
+		uint32_t mismatchNum = 0;
+		utils::Ktx2Texture ktx2;
+		if (ktx2.Open(ktx2Path) && ktx2.Read() && ktx2.GetMipNum() == reference.GetMipNum()) {
+			for (uint32_t mip = 0; mip < reference.GetMipNum(); mip++) {
+				nri::TextureSubresourceUploadDesc expected = {};
+				reference.GetSubresource(expected, mip);
+
+				nri::TextureSubresourceUploadDesc subresource = {};
+				ktx2.GetSubresource(subresource, mip);
+
+				mismatchNum += subresource.slicePitch != expected.slicePitch || memcmp(subresource.slices, expected.slices, expected.slicePitch) ? 1 : 0;
+			}
+		} else
+			mismatchNum++;
+
+		ktx2.Close();
+		std::filesystem::remove(ktx2Path);
+
+		const double mb = dataSize / (1024.0 * 1024.0);
+		printf("KTX loading '%s' (%ux%u, %u mips, %.1f Kb): KTX1 %.3f ms (%.0f Mb/s), %u allocations (malloc, by Detex's ownership); KTX2 %.3f ms (%.0f Mb/s), %.1f allocations (counted); %u failed, %u mismatching mips\n",
+				entry.path().filename().string().c_str(), reference.GetWidth(), reference.GetHeight(), reference.GetMipNum(), dataSize / 1024.0,
+				ktx1Time, mb * 1000.0 / ktx1Time, ktx1AllocationNum, ktx2Time, mb * 1000.0 / ktx2Time, ktx2AllocationNum, failedNum, mismatchNum);
+
+		isOk = isOk && !failedNum && !mismatchNum;
+	}
+
+	return isOk;
+}
+
+struct Benchmark {
+	const char *name;
+	const char *description;
+	bool (*run)(const BenchmarkOptions &options);
+};
+
+static const Benchmark g_Benchmarks[] = {
+	{ "culling", "measure CPU instance culling throughput for 32K, 1M and 10M instances", InstanceCulling },
+	{ "instanceUpdate", "measure dirty instance updates for 0.1%, 1% and 10% of instances changing per frame", InstanceUpdates },
+	{ "hierarchy", "measure scene graph transform updates for 10K and 1M nodes", Hierarchy },
+	{ "animation", "measure keyframe sampling throughput for 1K and 16K animated nodes", Animation },
+	{ "ui", "measure UI geometry repacking with the ImGui demo window open", UiRepacking },
+	{ "profiler", "measure the CPU profiler overhead per scope (budget 50 ns)", CpuProfiler },
+	{ "timer", "measure the timer overhead, histogram and sleep accuracy", TimerAccuracy },
+	{ "allocation", "measure the allocation profiler overhead per allocation (budget 50 ns)", AllocationProfiler },
+	{ "meshletCulling", "simulate meshlet culling on the CPU for a camera path and print stats", MeshletCulling },
+	{ "gpuProfiler", "check GPU profiler query slot reuse, range overflow and the range tree on the NONE backend", GpuProfilerCheck },
+	{ "textureStreaming", "fly a camera path through streamed textures on the NONE backend, check budgets and memory release", TextureStreaming },
+	{ "assetLoading", "load the sample's assets serially and on the asset loader, check that parallel loading is faster", AssetLoading },
+	{ "ktxLoading", "load data/*.ktx with Detex and as KTX2 with Ktx2Texture, compare time and allocations", KtxLoading },
+	{ "pixelConversion", "compare scalar and SIMD Detex pixel conversions (MB/s) and check that the results match", PixelConversion },
+};
+
+int main(int argc, char **argv) {
+	BenchmarkOptions options = {};
+	std::vector<const Benchmark *> benchmarks;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--scene") && i + 1 < argc) {
+			options.scenePath = argv[++i];
+			continue;
+		}
+
+		const Benchmark *benchmark = nullptr;
+		for (const Benchmark &b : g_Benchmarks) {
+			if (!strcmp(argv[i], b.name) || (argv[i][0] == '-' && argv[i][1] == '-' && !strcmp(argv[i] + 2, b.name)))
+				benchmark = &b;
+		}
+
+		if (!benchmark) {
+			printf("Unknown benchmark '%s'\n", argv[i]);
+			return 1;
+		}
+
+		benchmarks.push_back(benchmark);
+	}
+
+	if (benchmarks.empty()) {
+		printf("Usage: Benchmarks <benchmark>... [--scene <path>]\n");
+		for (const Benchmark &b : g_Benchmarks)
+			printf("  %-24s %s\n", b.name, b.description);
+
+		return 1;
+	}
+
+	bool isOk = true;
+	for (const Benchmark *benchmark : benchmarks)
+		isOk = benchmark->run(options) && isOk;
+
+	return isOk ? 0 : 1;
+}
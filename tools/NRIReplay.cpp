@@ -0,0 +1,133 @@
+// © 2025 NVIDIA Corporation
+
+// Replays a capture made with "--capture" on the NONE backend in a loop, measuring the CPU cost of NRI layers only:
+//  NRIReplay <capture> [iterations] [--stats] [--validation] [--light <sample rate>]
+// "--validation" enables full NRI validation, "--light" enables light NRI validation (see "nriValidationSampleRate")
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "NRI.h"
+
+#include "Extensions/NRICapture.h"
+#include "Extensions/NRIDeviceCreation.h"
+#include "Extensions/NRIStats.h"
+
+static double GetTimeStamp() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t g_ErrorNum = 0;
+static uint32_t g_WarningNum = 0;
+
+// Only print (the first few), a broken capture is not a reason to break into the debugger
+static void MessageCallback(nri::Message messageType, const char *, uint32_t, const char *message, void *) {
+	uint32_t &num = messageType == nri::Message::ERROR ? g_ErrorNum : g_WarningNum;
+	if (messageType != nri::Message::INFO)
+		num++;
+
+	if (g_ErrorNum + g_WarningNum <= 10)
+		printf("%s\n", message);
+}
+
+static void AbortExecution(void *) {
+}
+
+int main(int argc, char **argv) {
+	const char *path = nullptr;
+	uint32_t iterationNum = 1000;
+	uint32_t validationSampleRate = 0;
+	bool enableStats = false;
+	bool enableValidation = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--stats"))
+			enableStats = true;
+		else if (!strcmp(argv[i], "--validation"))
+			enableValidation = true;
+		else if (!strcmp(argv[i], "--light") && i + 1 < argc) {
+			enableValidation = true;
+			validationSampleRate = (uint32_t)atoi(argv[++i]);
+		} else if (!path)
+			path = argv[i];
+		else
+			iterationNum = (uint32_t)atoi(argv[i]);
+	}
+
+	if (!path || !iterationNum) {
+		printf("Usage: NRIReplay <capture> [iterations] [--stats] [--validation] [--light <sample rate>]\n");
+		return 1;
+	}
+
+	nri::DeviceCreationDesc deviceCreationDesc = {};
+	deviceCreationDesc.graphicsAPI = nri::GraphicsAPI::NONE;
+	deviceCreationDesc.nriValidationSampleRate = validationSampleRate;
+	deviceCreationDesc.enableNRIStats = enableStats;
+	deviceCreationDesc.enableNRIValidation = enableValidation;
+	deviceCreationDesc.callbackInterface.MessageCallback = MessageCallback;
+	deviceCreationDesc.callbackInterface.AbortExecution = AbortExecution;
+
+	nri::Device *device = nullptr;
+	if (nri::nriCreateDevice(deviceCreationDesc, device) != nri::Result::SUCCESS) {
+		printf("Can't create a device\n");
+		return 1;
+	}
+
+	nri::CaptureInterface captureInterface = {};
+	nri::Capture *capture = nullptr;
+	if (nri::nriGetInterface(*device, NRI_INTERFACE(nri::CaptureInterface), &captureInterface) != nri::Result::SUCCESS ||
+			captureInterface.CreateCapture(*device, path, capture) != nri::Result::SUCCESS) {
+		printf("Can't load '%s'\n", path);
+		nri::nriDestroyDevice(*device);
+		return 1;
+	}
+
+	// Warm up caches and lazily allocated storage
+	const uint64_t callNum = captureInterface.ReplayCapture(*capture);
+	for (uint32_t i = 0; i < 10; i++)
+		captureInterface.ReplayCapture(*capture);
+
+	double best = 1e30;
+	const double begin = GetTimeStamp();
+	for (uint32_t i = 0; i < iterationNum; i++) {
+		const double t = GetTimeStamp();
+		captureInterface.ReplayCapture(*capture);
+		const double dt = GetTimeStamp() - t;
+		best = dt < best ? dt : best;
+	}
+	const double average = (GetTimeStamp() - begin) / iterationNum;
+
+	const char *validation = !enableValidation ? "off" : (validationSampleRate ? "light" : "full");
+
+	printf("'%s': %llu calls, %u replays, validation %s\n", path, (unsigned long long)callNum, iterationNum, validation);
+
+	// Not restorable objects (descriptor sets, pipeline layouts, pipelines) and calls needing them
+	const uint64_t skippedCallNum = captureInterface.GetCaptureSkippedCallNum(*capture);
+	if (skippedCallNum)
+		printf("  %llu calls skipped (not restorable objects)\n", (unsigned long long)skippedCallNum);
+	printf("  average %.4f ms (%.1f ns per call), best %.4f ms\n", average, average * 1e6 / (callNum ? callNum : 1), best);
+	if (g_ErrorNum + g_WarningNum)
+		printf("  %u errors, %u warnings\n", g_ErrorNum, g_WarningNum);
+
+	if (enableStats) {
+		nri::StatsInterface statsInterface = {};
+		if (nri::nriGetInterface(*device, NRI_INTERFACE(nri::StatsInterface), &statsInterface) == nri::Result::SUCCESS) {
+			statsInterface.EndStatsFrame(*device);
+			captureInterface.ReplayCapture(*capture);
+			statsInterface.EndStatsFrame(*device);
+
+			nri::FrameStats frameStats = {};
+			statsInterface.GetFrameStats(*device, frameStats);
+			printf("  per replay: %llu command buffers, %llu draws, %llu dispatches, %llu barriers, %llu submits\n",
+					(unsigned long long)frameStats.commandBufferNum, (unsigned long long)frameStats.commandBufferTotals.drawNum,
+					(unsigned long long)frameStats.commandBufferTotals.dispatchNum, (unsigned long long)frameStats.commandBufferTotals.barrierNum,
+					(unsigned long long)frameStats.submitNum);
+		}
+	}
+
+	captureInterface.DestroyCapture(*capture);
+	nri::nriDestroyDevice(*device);
+
+	return 0;
+}
@@ -1,7 +1,7 @@
 add_rules("mode.debug", "mode.release")
 set_languages("c++20")
 
-add_requires("glfw", "glm", "assimp")
+add_requires("glfw", "glm", "assimp", "zstd")
 
 
 target("Detex")
@@ -23,7 +23,7 @@ target("ImGUI")
 target("NRI")
     set_kind("static")
     add_deps("D3D12Ma")
-    add_defines("NOMINMAX", "NRI_ENABLE_D3D12_SUPPORT")
+    add_defines("NOMINMAX", "NRI_ENABLE_D3D12_SUPPORT", "NRI_ENABLE_NONE_SUPPORT", "NRI_ENABLE_VALIDATION_SUPPORT")
     if is_mode("debug") then
         add_defines("NRI_ENABLE_DEBUG_NAMES_AND_ANNOTATIONS")
     end
@@ -48,7 +48,8 @@ target("NRIFramework")
     add_includedirs("3rd/tinyddsLoader/", {public = true})
     add_includedirs("3rd/", {public = true})
     add_files("3rd/NRI_Framework/Source/*.cpp")
-    add_packages("glfw", "glm")
+    add_packages("glfw", "glm", "assimp", "zstd")
+    add_defines("NRI_FRAMEWORK_ZSTD")
 
 target("DemoApp")
     set_kind("binary")
@@ -59,6 +60,17 @@ target("DemoApp")
     add_packages("glfw", "glm", "assimp")
     add_files("main.cpp", "source/**.cpp")
 
+target("NRIReplay")
+    set_kind("binary")
+    add_deps("NRI")
+    add_files("tools/NRIReplay.cpp")
+
+target("Benchmarks")
+    set_kind("binary")
+    add_deps("NRIFramework", "Detex", "NRI", "ImGUI")
+    add_packages("glfw", "glm", "assimp")
+    add_files("tools/Benchmarks.cpp")
+
 target("ShaderCompiler")
     set_kind("phony") -- 这里可以是 phony，避免 xmake 生成实际的二进制文件
     set_default(false) -- 让它不在默认 `xmake build` 触发